@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_ASYNCINIT_HH_
+#define IGNITION_PLUGIN_ASYNCINIT_HH_
+
+#include <exception>
+#include <functional>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief AsyncInit is an optional interface for plugins whose
+    /// initialization waits on I/O, like loading a model or opening
+    /// connections. Loader::InstantiateAsync() constructs the plugin, starts
+    /// its initialization, and hands the instance out once the plugin reports
+    /// that it has finished, so that a single thread can bring up many such
+    /// plugins at once.
+    ///
+    /// Like any other interface, it needs to be listed when the plugin is
+    /// registered:
+    ///
+    /// \code
+    /// IGNITION_ADD_PLUGIN(MyModel, Model, ignition::plugin::AsyncInit)
+    /// \endcode
+    class AsyncInit
+    {
+      /// \brief The function which a plugin calls when its initialization has
+      /// finished. It receives nullptr on success, or the exception which
+      /// made the initialization fail.
+      public: using Completion = std::function<void(std::exception_ptr)>;
+
+      /// \brief Destructor
+      public: virtual ~AsyncInit() = default;
+
+      /// \brief Start initializing this instance, and return without waiting
+      /// for it to finish. The work can be driven by an event loop, an I/O
+      /// completion, or a thread of the plugin's own.
+      ///
+      /// \param[in] _done
+      ///   Must be called exactly once, from any thread, when the
+      ///   initialization has finished. Until then, it keeps the instance
+      ///   alive. Throwing from InitAsync() has the same effect as passing
+      ///   the exception to _done.
+      public: virtual void InitAsync(Completion _done) = 0;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_BORROWEDINTERFACE_HH_
+#define IGNITION_PLUGIN_BORROWEDINTERFACE_HH_
+
+#include <cassert>
+#include <cstddef>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    // Forward declaration
+    template <typename> class TemplatePluginPtr;
+
+    /// \brief An interface of a plugin instance which is borrowed from a
+    /// PluginPtr for the duration of a scope, as returned by
+    /// TemplatePluginPtr::Borrow().
+    ///
+    /// Borrowing an interface does not touch the reference count of the
+    /// plugin instance, unlike QueryInterfaceSharedPtr(), so many threads can
+    /// borrow interfaces of the same instance at once without contending for
+    /// its control block. Instead, the borrow relies on the PluginPtr that it
+    /// came from, which the compiler holds it to as far as it can:
+    ///   - An interface can only be borrowed from a PluginPtr which is an
+    ///     lvalue, never from a temporary that is about to be destroyed.
+    ///   - A borrowed interface can be neither copied nor moved, nor
+    ///     allocated with new, so it cannot escape the scope which borrowed it
+    ///     (e.g. into a member variable or a container).
+    ///
+    /// The PluginPtr must not be destroyed, cleared or reassigned while the
+    /// interface is borrowed. Unless NDEBUG is defined, every access asserts
+    /// that the PluginPtr still holds the same plugin instance. To keep an
+    /// interface beyond a scope, use QueryInterfaceSharedPtr() instead.
+    ///
+    /// \code
+    /// void Update(const PluginPtr &_plugin)
+    /// {
+    ///   const auto sensor = _plugin.Borrow<Sensor>();
+    ///   if (sensor)
+    ///     sensor->Read(42.0);
+    /// }
+    /// \endcode
+    template <class Interface>
+    class BorrowedInterface final
+    {
+      /// \brief Borrowed interfaces cannot be copied
+      public: BorrowedInterface(const BorrowedInterface &) = delete;
+
+      /// \brief Borrowed interfaces cannot be moved
+      public: BorrowedInterface(BorrowedInterface &&) = delete;
+
+      /// \brief Borrowed interfaces cannot be assigned
+      public: BorrowedInterface &operator=(const BorrowedInterface &) = delete;
+
+      /// \brief Borrowed interfaces cannot be assigned
+      public: BorrowedInterface &operator=(BorrowedInterface &&) = delete;
+
+      /// \brief Borrowed interfaces cannot be allocated on the heap
+      public: static void *operator new(std::size_t) = delete;
+
+      /// \brief Borrowed interfaces cannot be allocated on the heap
+      public: static void *operator new[](std::size_t) = delete;
+
+      /// \brief Get the interface
+      /// \return A pointer to the interface, or nullptr if the plugin does
+      /// not provide it
+      public: Interface *Get() const
+      {
+        assert(this->instance == this->instanceOf(this->owner) &&
+               "The PluginPtr of a BorrowedInterface has been changed");
+        return this->ptr;
+      }
+
+      /// \brief Access a member of the interface
+      public: Interface *operator->() const
+      {
+        return this->Get();
+      }
+
+      /// \brief Dereference the interface
+      public: Interface &operator*() const
+      {
+        return *this->Get();
+      }
+
+      /// \brief Check whether the plugin provides the interface
+      /// \return True if the interface is available
+      public: explicit operator bool() const
+      {
+        return nullptr != this->ptr;
+      }
+
+      /// \brief A function which gets the address of the plugin instance of
+      /// a PluginPtr
+      private: using InstanceOf = const void *(*)(const void *);
+
+      /// \brief Constructor which is used by TemplatePluginPtr::Borrow()
+      /// \param[in] _ptr The interface
+      /// \param[in] _owner The PluginPtr which the interface is borrowed from
+      /// \param[in] _instanceOf Gets the plugin instance of _owner
+      private: BorrowedInterface(
+          Interface *_ptr, const void *_owner, InstanceOf _instanceOf)
+        : ptr(_ptr),
+          owner(_owner),
+          instanceOf(_instanceOf),
+          instance(_instanceOf(_owner))
+      {
+      }
+
+      /// \brief The interface
+      private: Interface *const ptr;
+
+      /// \brief The PluginPtr which the interface is borrowed from
+      private: const void *const owner;
+
+      /// \brief Gets the plugin instance of `owner`, for checking that it
+      /// has not changed
+      private: const InstanceOf instanceOf;
+
+      /// \brief The plugin instance of `owner` when the interface was
+      /// borrowed
+      private: const void *const instance;
+
+      // The PluginPtrs lend the interfaces
+      template <typename> friend class TemplatePluginPtr;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_CALLPROFILE_HH_
+#define IGNITION_PLUGIN_CALLPROFILE_HH_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <ignition/plugin/Export.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief The calls which were made to one method of an interface of a
+    /// plugin, see CallProfile()
+    struct MethodProfile
+    {
+      /// \brief The number of buckets of the histogram
+      static constexpr std::size_t BucketCount = 40;
+
+      /// \brief The name of the plugin
+      std::string plugin;
+
+      /// \brief The demangled name of the interface
+      std::string interface;
+
+      /// \brief The name of the method, as it was given to
+      /// IGNITION_PLUGIN_PROFILE_INTERFACE
+      std::string method;
+
+      /// \brief The number of calls
+      std::uint64_t calls = 0;
+
+      /// \brief The time that the calls took altogether, in nanoseconds
+      std::uint64_t totalNanoseconds = 0;
+
+      /// \brief The time that the slowest call took, in nanoseconds
+      std::uint64_t maxNanoseconds = 0;
+
+      /// \brief The number of calls by how long they took. Bucket 0 counts
+      /// the calls which took less than a nanosecond, and bucket i > 0 counts
+      /// the calls which took at least 2^(i-1) and less than 2^i nanoseconds.
+      /// The last bucket also counts every call that took even longer.
+      std::array<std::uint64_t, BucketCount> histogram{};
+    };
+
+    /// \brief Start or stop profiling the calls into plugins. There is one
+    /// switch for the whole process.
+    ///
+    /// Only the interfaces which have a proxy, registered with
+    /// IGNITION_PLUGIN_PROFILE_INTERFACE, can be profiled, and only in the
+    /// plugin instances which are created while profiling is on: when such
+    /// an instance is asked for one of those interfaces, it hands out the
+    /// proxy, which times each call before it passes it on. Instances which
+    /// were created while profiling was off hand out their interfaces
+    /// directly, so they cost nothing. Stopping the profiling leaves the
+    /// proxies in place, but they stop timing the calls.
+    ///
+    /// The calls are timed with the timestamp counter of the CPU where there
+    /// is one, which is calibrated the first time that profiling is started,
+    /// and counted in buffers of each thread, so threads which call plugins
+    /// at the same time do not contend with each other.
+    ///
+    /// \param[in] _enabled True to start profiling, false to stop
+    void IGNITION_PLUGIN_VISIBLE SetCallProfiling(bool _enabled);
+
+    /// \brief Check whether calls into plugins are being profiled
+    /// \return True if SetCallProfiling() has started the profiling
+    bool IGNITION_PLUGIN_VISIBLE CallProfiling();
+
+    /// \brief Collect the calls which have been profiled since the start of
+    /// the program or the last ResetCallProfile(), from every thread.
+    /// \return One entry per method of a plugin which has been called, the
+    /// one which took the most time altogether first
+    std::vector<MethodProfile> IGNITION_PLUGIN_VISIBLE CallProfile();
+
+    /// \brief Forget the calls which have been profiled so far
+    void IGNITION_PLUGIN_VISIBLE ResetCallProfile();
+
+    namespace detail
+    {
+      /// \brief The switch of SetCallProfiling()
+      extern IGNITION_PLUGIN_VISIBLE std::atomic<bool> callProfiling;
+
+      /// \brief Creates a proxy for an interface
+      /// \param[in] _target The interface of the plugin instance
+      /// \param[in] _sites The profiling sites of the methods of the proxy
+      /// \return The proxy, pointing at its interface
+      using ProxyFactory = std::shared_ptr<void> (*)(
+          void *_target, std::vector<std::size_t> _sites);
+
+      /// \brief Register the proxy of an interface
+      /// \param[in] _interface The mangled name of the interface
+      /// \param[in] _methods The names of the methods of the proxy
+      /// \param[in] _factory Creates the proxy
+      void IGNITION_PLUGIN_VISIBLE RegisterProxy(
+          const char *_interface,
+          std::vector<std::string> _methods,
+          ProxyFactory _factory);
+
+      /// \brief Undo RegisterProxy(), unless the interface has been given
+      /// another proxy since
+      /// \param[in] _interface The mangled name of the interface
+      /// \param[in] _factory The factory that was registered
+      void IGNITION_PLUGIN_VISIBLE UnregisterProxy(
+          const char *_interface,
+          ProxyFactory _factory);
+
+      /// \brief Count a call
+      /// \param[in] _site The profiling site of the method
+      /// \param[in] _ticks How long the call took, in ticks of
+      /// ProfileTicks()
+      void IGNITION_PLUGIN_VISIBLE RecordCall(
+          std::size_t _site, std::uint64_t _ticks);
+
+      /// \brief Read the clock which calls are timed with
+      /// \return The timestamp counter of the CPU, or nanoseconds on the
+      /// clock of std::chrono::steady_clock if the CPU has none
+      inline std::uint64_t ProfileTicks()
+      {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+      }
+
+      /// \brief Times the scope that it lives in, while profiling is on
+      class CallTimer
+      {
+        /// \brief Constructor
+        /// \param[in] _site The profiling site of the method
+        public: explicit CallTimer(const std::size_t _site)
+          : site(_site),
+            start(callProfiling.load(std::memory_order_relaxed) ?
+                  ProfileTicks() : 0)
+        {
+        }
+
+        /// \brief Destructor. Counts the call.
+        public: ~CallTimer()
+        {
+          if (0 != this->start)
+            RecordCall(this->site, ProfileTicks() - this->start);
+        }
+
+        public: CallTimer(const CallTimer &) = delete;
+        public: CallTimer &operator=(const CallTimer &) = delete;
+
+        /// \brief The profiling site of the method
+        private: const std::size_t site;
+
+        /// \brief When the call started, or 0 if it is not being timed
+        private: const std::uint64_t start;
+      };
+
+      /// \brief Registers a proxy for as long as it exists. See
+      /// IGNITION_PLUGIN_PROFILE_INTERFACE.
+      template <class Interface, class Proxy>
+      class ProxyRegistration
+      {
+        /// \brief Constructor
+        /// \param[in] _methods The names of the methods of the proxy
+        public: explicit ProxyRegistration(
+            std::initializer_list<const char *> _methods)
+        {
+          RegisterProxy(typeid(Interface).name(),
+                        std::vector<std::string>(
+                          _methods.begin(), _methods.end()),
+                        &ProxyRegistration::Create);
+        }
+
+        /// \brief Destructor
+        public: ~ProxyRegistration()
+        {
+          UnregisterProxy(typeid(Interface).name(),
+                          &ProxyRegistration::Create);
+        }
+
+        /// \brief Create a proxy
+        /// \param[in] _target The interface of the plugin instance
+        /// \param[in] _sites The profiling sites of the methods
+        /// \return The proxy, pointing at its interface
+        private: static std::shared_ptr<void> Create(
+            void *_target, std::vector<std::size_t> _sites)
+        {
+          std::shared_ptr<Proxy> proxy = std::make_shared<Proxy>(
+                static_cast<Interface*>(_target), std::move(_sites));
+          return std::shared_ptr<void>(
+                proxy, static_cast<Interface*>(proxy.get()));
+        }
+      };
+    }
+
+    /// \brief The base class of a proxy which profiles the calls to an
+    /// interface. A proxy overrides every method of the interface, and
+    /// passes each call on to the plugin with Profile():
+    ///
+    /// \code
+    /// class ProfiledController
+    ///     : public ignition::plugin::ProfiledInterface<Controller>
+    /// {
+    ///   public: using ProfiledInterface::ProfiledInterface;
+    ///
+    ///   public: double Update(double _dt) override
+    ///   {
+    ///     return this->Profile(0, [&]{ return this->Target()->Update(_dt); });
+    ///   }
+    ///
+    ///   public: void Reset() override
+    ///   {
+    ///     this->Profile(1, [&]{ this->Target()->Reset(); });
+    ///   }
+    /// };
+    ///
+    /// IGNITION_PLUGIN_PROFILE_INTERFACE(
+    ///     Controller, ProfiledController, "Update", "Reset")
+    /// \endcode
+    ///
+    /// The interface must be default constructible, which is the case for
+    /// most interfaces.
+    template <class Interface>
+    class ProfiledInterface : public Interface
+    {
+      /// \brief Constructor
+      /// \param[in] _target The interface of the plugin instance
+      /// \param[in] _sites The profiling sites of the methods
+      public: ProfiledInterface(Interface *_target,
+                                std::vector<std::size_t> _sites)
+        : target(_target),
+          sites(std::move(_sites))
+      {
+      }
+
+      /// \brief Get the interface of the plugin instance
+      /// \return The interface which the calls are passed on to
+      protected: Interface *Target() const
+      {
+        return this->target;
+      }
+
+      /// \brief Make a call, timing it while profiling is on
+      /// \param[in] _method The position of the method in the list that was
+      /// given to IGNITION_PLUGIN_PROFILE_INTERFACE
+      /// \param[in] _call Makes the call
+      /// \return What _call returns
+      protected: template <typename Call>
+      decltype(auto) Profile(const std::size_t _method, Call &&_call) const
+      {
+        const detail::CallTimer timer(this->sites[_method]);
+        return std::forward<Call>(_call)();
+      }
+
+      /// \brief The interface of the plugin instance
+      private: Interface *const target;
+
+      /// \brief The profiling sites of the methods
+      private: const std::vector<std::size_t> sites;
+    };
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Give an interface a proxy which profiles the calls to it, see
+/// ProfiledInterface. The remaining arguments name the methods of the proxy,
+/// in the order of the positions which it passes to
+/// ProfiledInterface::Profile(). The proxy stays registered as long as the
+/// library that registers it is loaded, so proxies are best registered by
+/// the application.
+#define IGNITION_PLUGIN_PROFILE_INTERFACE(Interface, Proxy, ...) \
+  DETAIL_IGNITION_PLUGIN_PROFILE_INTERFACE_WITH_COUNTER( \
+    __COUNTER__, Interface, Proxy, __VA_ARGS__)
+
+//////////////////////////////////////////////////
+/// This macro is needed to force the __COUNTER__ macro to expand to a value
+/// before being passed to the *_HELPER macro.
+#define DETAIL_IGNITION_PLUGIN_PROFILE_INTERFACE_WITH_COUNTER( \
+  UniqueID, Interface, Proxy, ...) \
+  DETAIL_IGNITION_PLUGIN_PROFILE_INTERFACE_HELPER( \
+    UniqueID, Interface, Proxy, __VA_ARGS__)
+
+//////////////////////////////////////////////////
+#define DETAIL_IGNITION_PLUGIN_PROFILE_INTERFACE_HELPER( \
+  UniqueID, Interface, Proxy, ...) \
+  namespace \
+  { \
+    const ::ignition::plugin::detail::ProxyRegistration<Interface, Proxy> \
+        IgnitionPluginProxyRegistration##UniqueID({__VA_ARGS__}); \
+  }
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_CPUFEATURES_HH_
+#define IGNITION_PLUGIN_CPUFEATURES_HH_
+
+#include <string_view>
+
+#include <ignition/plugin/Export.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Check whether the CPU that this process runs on supports a
+    /// feature. These are the names of the known features:
+    ///   - x86: "sse2", "sse3", "ssse3", "sse4.1", "sse4.2", "popcnt", "avx",
+    ///     "fma", "avx2", "bmi", "bmi2", "avx512f", "avx512cd", "avx512bw",
+    ///     "avx512dq", "avx512vl"
+    ///   - ARM: "neon" (or "asimd"), "sve", "sve2"
+    ///
+    /// The features of the other architecture are never supported. The CPU
+    /// is only inspected once, so this is cheap to call.
+    ///
+    /// \param[in] _feature
+    ///   The name of the feature, in lower case
+    ///
+    /// \return True if the feature is known and supported
+    IGNITION_PLUGIN_VISIBLE
+    bool CpuSupports(std::string_view _feature);
+
+    /// \brief Get a rough rank of how fast the code is which a feature
+    /// enables, relative to the other features of the same architecture,
+    /// e.g. "avx2" ranks above "sse4.2", which ranks above "sse2". Features
+    /// of the same generation, like "avx2" and "fma", have the same rank.
+    /// This is what Loader::LookupPlugin() uses to choose between plugins
+    /// that require different features.
+    ///
+    /// \param[in] _feature
+    ///   The name of the feature, see CpuSupports()
+    ///
+    /// \return The rank of the feature, starting from 1, or 0 if the
+    /// feature is not known
+    IGNITION_PLUGIN_VISIBLE
+    int CpuFeatureRank(std::string_view _feature);
+  }
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_DESCRIPTOR_HH_
+#define IGNITION_PLUGIN_DESCRIPTOR_HH_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <ignition/plugin/Info.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief sentinel value to check if a plugin library was built with the
+    /// same version of the PluginDescriptor layout
+    ///
+    /// This must be incremented whenever a field of PluginDescriptor or
+    /// InterfaceDescriptor changes or moves. Appending a field to the end of
+    /// PluginDescriptor does not require it, because every PluginDescriptor
+    /// records its own size.
+    const int DESCRIPTOR_API_VERSION = 2;
+
+    /// \brief A function that returns the (mangled) name of a type. The name
+    /// has static storage duration.
+    using NameFunction = const char *(*)();
+
+    /// \brief Describes one interface that a plugin provides.
+    struct InterfaceDescriptor
+    {
+      /// \brief The mangled name of the interface
+      NameFunction name;
+
+      /// \brief Casts an instance of the plugin to this interface
+      Info::InterfaceCaster cast;
+
+      /// \brief The stable ID of the interface, see InterfaceId()
+      std::uint64_t id;
+    };
+
+    /// \brief A plain description of a plugin which can be constant
+    /// initialized, so that registering a plugin with
+    /// IGNITION_ADD_STATIC_PLUGIN does not run any code when the library that
+    /// provides it gets loaded. The Loader turns each PluginDescriptor into
+    /// an Info when it loads the library.
+    ///
+    /// Every pointer in a PluginDescriptor refers to data with static storage
+    /// duration inside of the library that provides the plugin, and the
+    /// descriptor only consists of pointers and integers. Unlike Info, whose
+    /// layout depends on the standard library implementation, a Loader can
+    /// therefore read the descriptors of a library in place even if it was
+    /// built by a different compiler.
+    struct PluginDescriptor
+    {
+      /// \brief The size of this PluginDescriptor, in bytes. A Loader ignores
+      /// any fields beyond the ones that it knows of.
+      std::size_t size;
+
+      /// \brief The mangled name of the plugin
+      NameFunction name;
+
+      /// \brief The interfaces that the plugin provides. This does not include
+      /// EnablePluginFromThis, which is described by enablePluginFromThis.
+      const InterfaceDescriptor *interfaces;
+
+      /// \brief The number of entries in interfaces
+      std::size_t interfaceCount;
+
+      /// \brief Alternative names that may be used to instantiate the plugin
+      const char * const *aliases;
+
+      /// \brief The number of entries in aliases
+      std::size_t aliasCount;
+
+      /// \brief See Info::factory
+      Info::FactoryFunction factory;
+
+      /// \brief See Info::deleter
+      Info::DeleterFunction deleter;
+
+      /// \brief See Info::instanceSize
+      std::size_t instanceSize;
+
+      /// \brief See Info::instanceAlignment
+      std::size_t instanceAlignment;
+
+      /// \brief See Info::construct
+      Info::ConstructFunction construct;
+
+      /// \brief See Info::destruct
+      Info::DestructFunction destruct;
+
+      /// \brief See Info::enablePluginFromThis. When this is set, the Loader
+      /// also lists EnablePluginFromThis among the interfaces of the plugin.
+      Info::InterfaceCaster enablePluginFromThis;
+    };
+
+    /// \brief sentinel value to check if the metadata records of a plugin
+    /// library were written with the same layout that the Loader expects
+    ///
+    /// Besides its descriptors, every plugin registration places a metadata
+    /// record into the METADATA_SECTION of the library. A record only holds
+    /// characters, so the Loader can parse it straight from the library file
+    /// without opening the library. Each record is aligned to 8 bytes and is
+    /// laid out as:
+    ///
+    /// - the 4 characters of METADATA_MAGIC
+    /// - the size of the whole record as a 32-bit little endian integer,
+    ///   which is a multiple of 8
+    /// - 1 byte with METADATA_API_VERSION
+    /// - 1 byte of METADATA_* flags
+    /// - a sequence of entries, each made of a tag character and a null
+    ///   terminated string: first the demangled name of the plugin with the
+    ///   tag 'P', then any number of demangled interface names with the tag
+    ///   'I' and aliases with the tag 'A'
+    /// - a 0 tag, followed by zero padding up to the size of the record
+    const int METADATA_API_VERSION = 1;
+
+    /// \brief The name of the section which holds the metadata records
+    const char * const METADATA_SECTION = "ign_plugin_metadata";
+
+    /// \brief The characters that every metadata record starts with
+    const char * const METADATA_MAGIC = "IGNP";
+
+    /// \brief The size of the fixed part of a metadata record, in bytes
+    const std::size_t METADATA_HEADER_SIZE = 10;
+
+    /// \brief Flag of a metadata record whose plugin was (also) registered by
+    /// code that runs when the library is loaded, e.g. with
+    /// IGNITION_ADD_PLUGIN_ALIAS, IGNITION_ADD_PLUGIN_FEATURES or
+    /// IGNITION_ADD_PLUGIN_DEPENDENCIES. The records of such a library do not
+    /// describe everything that it provides.
+    const unsigned char METADATA_INCOMPLETE = 1;
+
+    /// \brief Flag of a metadata record whose plugin inherits
+    /// EnablePluginFromThis
+    const unsigned char METADATA_ENABLE_PLUGIN_FROM_THIS = 2;
+  }
+}
+
+#endif
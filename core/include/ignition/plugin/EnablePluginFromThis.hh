@@ -19,6 +19,7 @@
 #define IGNITION_PLUGIN_ENABLEPLUGINFROMTHIS_HH_
 
 #include <memory>
+#include <memory_resource>
 
 #include <ignition/plugin/PluginPtr.hh>
 
@@ -28,6 +29,7 @@ namespace ignition
   {
     // Forward declaration
     class Loader;
+    class PluginHandle;
 
     /// \brief EnablePluginFromThis is an optional base class which can be
     /// inherited by Plugin classes. When a Plugin class inherits it and that
@@ -67,14 +69,30 @@ namespace ignition
       /// \return shared_ptr to the Plugin instance.
       protected: std::shared_ptr<void> PluginInstancePtrFromThis() const;
 
+      /// \brief Get the memory resource which the Loader has assigned to the
+      /// library of this plugin, so that memory which is allocated on behalf
+      /// of the plugin can be attributed to its library. See
+      /// Loader::SetAllocationAccounting(). Factory plugins use this for
+      /// products which are constructed without a memory resource.
+      ///
+      /// \return The memory resource, or nullptr if the plugin was not
+      /// instantiated by a Loader which accounts for allocations.
+      protected: std::pmr::memory_resource *MemoryResourceFromThis() const;
+
       // Declare friendship so that the internal WeakPluginPtr can be set by
-      // the Loader class.
+      // the Loader and PluginHandle classes.
       friend class Loader;
+      friend class PluginHandle;
 
       /// \brief This function is called by the Loader class whenever a plugin
       /// containing this interface gets instantiated.
       private: void PrivateSetPluginFromThis(const PluginPtr &_ptr);
 
+      /// \brief This function is called by the Loader class to assign the
+      /// memory resource of the library of the plugin.
+      private: void PrivateSetMemoryResource(
+          std::pmr::memory_resource *_resource);
+
       private: class Implementation;
       IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
       private: std::unique_ptr<Implementation> pimpl;
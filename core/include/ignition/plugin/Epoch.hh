@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_EPOCH_HH_
+#define IGNITION_PLUGIN_EPOCH_HH_
+
+#include <cstddef>
+#include <functional>
+
+#include <ignition/plugin/Export.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      // Forward declaration
+      struct EpochRecord;
+    }
+
+    /// \brief Marks the calling thread as running plugin code for as long as
+    /// the guard exists. A plugin library is never unloaded while a thread
+    /// which might be executing its code is inside an EpochGuard: every
+    /// library whose last reference is dropped in the meantime, e.g. by a
+    /// plugin which releases itself or by a hot reload, stays mapped until
+    /// all the guards which were entered before have been left. The same
+    /// goes for the factories of lost products, see CleanupLostProducts().
+    ///
+    /// Entering and leaving a guard only touches memory of the calling
+    /// thread, so it is cheap enough to wrap every call into a plugin:
+    ///
+    /// \code
+    /// {
+    ///   ignition::plugin::EpochGuard guard;
+    ///   plugin->QueryInterface<Controller>()->Update(dt);
+    /// }
+    /// \endcode
+    ///
+    /// Guards can be nested. Only the outermost guard of a thread counts.
+    class IGNITION_PLUGIN_VISIBLE EpochGuard
+    {
+      /// \brief Enter the current epoch
+      public: EpochGuard();
+
+      /// \brief Leave the epoch. If this is the last guard which holds back
+      /// a retired action, the action is run here.
+      public: ~EpochGuard();
+
+      /// \brief Guards belong to the thread that made them, so they cannot be
+      /// copied
+      public: EpochGuard(const EpochGuard &) = delete;
+
+      /// \brief Guards cannot be copied
+      public: EpochGuard &operator=(const EpochGuard &) = delete;
+
+      /// \brief The record of the calling thread
+      private: detail::EpochRecord *record;
+
+      /// \brief True if the record was taken for this guard alone, because
+      /// the thread is exiting and no longer has a record of its own
+      private: bool ownsRecord;
+    };
+
+    /// \brief Run an action once no thread can be executing code which the
+    /// action is about to remove, e.g. unmapping a library. If no thread is
+    /// inside an EpochGuard which was entered before this call, the action
+    /// runs right away on the calling thread. Otherwise it runs when the
+    /// last of those guards is left, on the thread which leaves it.
+    ///
+    /// The action must not throw.
+    ///
+    /// \param[in] _action
+    ///   The action to run
+    void IGNITION_PLUGIN_VISIBLE RetireAfterEpoch(
+        std::function<void()> _action);
+
+    /// \brief Run the retired actions which have become safe to run. This
+    /// happens automatically when guards are left, so it only needs to be
+    /// called by an application that wants to be sure that nothing is left
+    /// over, e.g. before it checks whether a library has been unloaded.
+    /// \return The number of actions which were run
+    std::size_t IGNITION_PLUGIN_VISIBLE ReclaimRetired();
+
+    /// \brief Get the number of retired actions which are still waiting for
+    /// threads to leave their guards
+    /// \return The number of waiting actions
+    std::size_t IGNITION_PLUGIN_VISIBLE RetiredCount();
+  }
+}
+
+#endif
@@ -18,12 +18,21 @@
 #ifndef IGNITION_PLUGIN_FACTORY_HH_
 #define IGNITION_PLUGIN_FACTORY_HH_
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include <ignition/plugin/EnablePluginFromThis.hh>
+#include <ignition/plugin/Epoch.hh>
 
 namespace ignition
 {
@@ -35,6 +44,124 @@ namespace ignition
     /// then this just performs a normal delete.
     template <typename Interface> class ProductDeleter;
 
+    namespace detail
+    {
+      class FactoryCounter;
+      class ProductReferenceShards;
+    }
+
+    /// \brief A snapshot of the statistics of a Factory. See
+    /// Factory::Statistics().
+    struct FactoryStatistics
+    {
+      /// \brief The number of buckets in constructLatency
+      public: static constexpr std::size_t kLatencyBuckets = 32;
+
+      /// \brief The number of products which have been constructed
+      public: std::uint64_t constructed = 0;
+
+      /// \brief The number of products which have been destroyed
+      public: std::uint64_t destroyed = 0;
+
+      /// \brief The number of products which are currently alive. A product
+      /// which stays alive for a long time keeps the library of its factory
+      /// loaded.
+      public: std::uint64_t live = 0;
+
+      /// \brief The number of products which were destroyed without a
+      /// ProductDeleter, i.e. which were handed to the lost product manager.
+      /// Until CleanupLostProducts() is called, each of these keeps the
+      /// library of the factory loaded.
+      public: std::uint64_t lost = 0;
+
+      /// \brief A histogram of how long it took to construct each product.
+      /// Bucket 0 counts the products that took at most 1ns, and bucket i
+      /// counts the ones that took more than 2^(i-1)ns and at most 2^i ns.
+      /// The last bucket also counts everything slower than that. The time
+      /// of a ConstructMany() call is split evenly among its products.
+      public: std::array<std::uint64_t, kLatencyBuckets> constructLatency{};
+    };
+
+    namespace detail
+    {
+      /// \brief The live statistics of a factory. These are only updated with
+      /// relaxed atomic operations, so they cost very little to keep.
+      struct FactoryStatisticsCounters
+      {
+        /// \brief The number of products which have been constructed
+        public: std::atomic<std::uint64_t> constructed{0};
+
+        /// \brief The number of products which have been destroyed
+        public: std::atomic<std::uint64_t> destroyed{0};
+
+        /// \brief The number of products which were destroyed without a
+        /// ProductDeleter
+        public: std::atomic<std::uint64_t> lost{0};
+
+        /// \brief The histogram of construction latencies. See
+        /// FactoryStatistics::constructLatency.
+        public: std::array<std::atomic<std::uint64_t>,
+                           FactoryStatistics::kLatencyBuckets>
+            constructLatency{};
+
+        /// \brief Record that some products have been constructed
+        /// \param[in] _count The number of products
+        /// \param[in] _elapsed How long it took to construct all of them
+        public: void RecordConstruct(
+          const std::uint64_t _count,
+          const std::chrono::steady_clock::duration _elapsed)
+        {
+          if (0 == _count)
+            return;
+
+          this->constructed.fetch_add(_count, std::memory_order_relaxed);
+
+          const auto elapsed = std::chrono::duration_cast<
+              std::chrono::nanoseconds>(_elapsed).count();
+          const std::uint64_t each =
+              elapsed > 0 ? static_cast<std::uint64_t>(elapsed) / _count : 0;
+
+          // The bucket is the number of bits needed for (each - 1)
+          const std::size_t lastBucket = this->constructLatency.size() - 1;
+          std::size_t bucket = 0;
+          for (std::uint64_t ns = each > 0 ? each - 1 : 0;
+               ns > 0 && bucket < lastBucket; ns >>= 1)
+          {
+            ++bucket;
+          }
+
+          this->constructLatency[bucket].fetch_add(
+                _count, std::memory_order_relaxed);
+        }
+
+        /// \brief Take a snapshot of the counters
+        /// \return The current values of the counters
+        public: FactoryStatistics Snapshot() const
+        {
+          FactoryStatistics statistics;
+          statistics.constructed =
+              this->constructed.load(std::memory_order_relaxed);
+          statistics.destroyed =
+              this->destroyed.load(std::memory_order_relaxed);
+          statistics.lost = this->lost.load(std::memory_order_relaxed);
+
+          // The counters are read one at a time, so a product that gets
+          // destroyed in between could make it look like more products were
+          // destroyed than constructed.
+          statistics.live = statistics.constructed > statistics.destroyed ?
+                statistics.constructed - statistics.destroyed : 0;
+
+          for (std::size_t i = 0; i < this->constructLatency.size(); ++i)
+          {
+            statistics.constructLatency[i] =
+                this->constructLatency[i].load(std::memory_order_relaxed);
+          }
+
+          return statistics;
+        }
+      };
+    }
+
     /// \brief ProductPtr is a derivative of std::unique_ptr that can safely
     /// manage the products that come out of a plugin factory. It is strongly
     /// recommended that factory products use a ProductPtr to manage the
@@ -47,8 +174,30 @@ namespace ignition
     /// will experience memory leaks, and your factory plugin libraries will
     /// never get unloaded.
     template <typename Interface>
-    using ProductPtr =
-        std::unique_ptr<Interface, ProductDeleter<Interface>>;
+    class ProductPtr
+        : public std::unique_ptr<Interface, ProductDeleter<Interface>>
+    {
+      /// \brief The std::unique_ptr that this derives from
+      public: using Base =
+          std::unique_ptr<Interface, ProductDeleter<Interface>>;
+
+      // Inherit all the constructors of std::unique_ptr
+      public: using Base::Base;
+
+      /// \brief Default constructor
+      public: ProductPtr() = default;
+
+      /// \brief Take over the product of a std::unique_ptr
+      /// \param[in] _other The std::unique_ptr to take the product from
+      public: ProductPtr(Base &&_other) noexcept;
+
+      /// \brief Release the product without deleting it. Unlike
+      /// std::unique_ptr::release(), this also makes the deleter forget the
+      /// product, so a different product which later gets placed at the same
+      /// address with reset() is never mistaken for it.
+      /// \return The product, which the caller is now responsible for
+      public: Interface *release() noexcept;
+    };
 
     /// \brief The Factory class defines a plugin factory that can be used by
     /// the Loader class to produce products that implement an interface.
@@ -84,12 +233,195 @@ namespace ignition
       /// the template parameters.
       public: ProductPtrType Construct(Args&&... _args);
 
+      /// \brief Construct a product whose storage comes from a memory
+      /// resource. The storage is returned to the same resource when the
+      /// product is deleted, whether or not that happens through a
+      /// ProductDeleter.
+      /// \param[in] _resource
+      ///   The memory resource for the storage of the product. This must
+      ///   outlive the product. If this is nullptr, the storage comes from the
+      ///   product pool of this factory if UseProductPool(true) was called,
+      ///   else from the account of the library of this factory if its Loader
+      ///   accounts for allocations (see Loader::SetAllocationAccounting()),
+      ///   or else from the heap.
+      /// \param[in] _args
+      ///   The arguments as defined by the template parameters.
+      /// \return an RAII-managed reference to the interface type as defined by
+      /// the template parameters.
+      public: ProductPtrType Construct(
+        std::pmr::memory_resource *_resource, Args&&... _args);
+
+      /// \brief Construct a product which is managed by a std::shared_ptr.
+      /// The product and the control block of the std::shared_ptr share a
+      /// single allocation, so this is cheaper than converting a ProductPtr,
+      /// which needs a second allocation for the control block. The product
+      /// keeps this factory, and therefore its library, alive until the
+      /// product has been destroyed and its storage has been released.
+      /// \param[in] _args
+      ///   The arguments as defined by the template parameters.
+      /// \return The product
+      public: std::shared_ptr<Interface> ConstructShared(Args&&... _args);
+
+      /// \brief Construct a product which is managed by a std::shared_ptr,
+      /// whose storage comes from a memory resource. See ConstructShared() and
+      /// Construct(std::pmr::memory_resource*, Args&&...).
+      /// \param[in] _resource
+      ///   The memory resource for the storage of the product and its control
+      ///   block, or nullptr to choose it like Construct() does.
+      /// \param[in] _args
+      ///   The arguments as defined by the template parameters.
+      /// \return The product
+      public: std::shared_ptr<Interface> ConstructShared(
+        std::pmr::memory_resource *_resource, Args&&... _args);
+
+      /// \brief Construct many products at once. Their storage is allocated
+      /// as one contiguous block, and they share a single reference to this
+      /// factory, so this costs far less than calling Construct() _count
+      /// times. The block is freed once every one of its products has been
+      /// deleted.
+      /// \param[in] _count The number of products to construct
+      /// \param[in] _args
+      ///   The arguments as defined by the template parameters. Each product
+      ///   is constructed with its own copy of them.
+      /// \return The products, in the order that they were constructed
+      public: std::vector<ProductPtrType> ConstructMany(
+        std::size_t _count, const std::remove_reference_t<Args>&... _args);
+
+      /// \brief Construct a product in storage that is provided by the caller,
+      /// e.g. one element of a contiguous array of components. The storage
+      /// must be at least ProductSize() bytes long and aligned to
+      /// ProductAlignment().
+      ///
+      /// The product does not keep this factory alive. The caller is
+      /// responsible for keeping this factory (and therefore its library)
+      /// alive until the product has been destroyed with DestroyAt(). The
+      /// product must never be given to a ProductPtr or a ProductDeleter.
+      /// \param[in] _storage The storage for the product
+      /// \param[in] _args
+      ///   The arguments as defined by the template parameters.
+      /// \return The product, or nullptr if _storage is null or is not
+      /// correctly aligned.
+      public: Interface *ConstructAt(void *_storage, Args&&... _args);
+
+      /// \brief Destroy a product which was made by ConstructAt(). Its
+      /// storage is left alone, so it can be reused.
+      /// \param[in] _product The product to destroy
+      public: static void DestroyAt(Interface *_product);
+
+      /// \brief Get the number of bytes that ConstructAt() needs.
+      /// \return The size of the products of this factory
+      public: std::size_t ProductSize() const;
+
+      /// \brief Get the alignment that ConstructAt() needs.
+      /// \return The alignment of the products of this factory
+      public: std::size_t ProductAlignment() const;
+
+      /// \brief Get the statistics of this factory. These are always being
+      /// collected, with relaxed atomic operations so they are cheap to keep.
+      /// \return A snapshot of the statistics
+      public: FactoryStatistics Statistics() const;
+
+      /// \brief Choose whether products constructed without a memory resource
+      /// should get their storage from a pool which belongs to this factory.
+      /// The pool recycles the storage of deleted products, which makes it
+      /// much cheaper to construct and delete many small products. It is
+      /// thread-safe, and it stays alive for as long as any of its products
+      /// are alive.
+      /// \param[in] _use True to use the pool, false to use the heap.
+      public: void UseProductPool(bool _use = true);
+
+      /// \brief Check whether this factory constructs its products in its
+      /// product pool.
+      /// \return True if UseProductPool(true) has been called.
+      public: bool UsesProductPool() const;
+
+      /// \brief Choose whether products should keep this factory alive through
+      /// references which the factory shares out itself, instead of each
+      /// product taking its own reference to the plugin.
+      ///
+      /// Normally every product takes a reference to the plugin instance of
+      /// its factory, so threads that construct from one popular factory all
+      /// contend on the same reference count. With this enabled, the factory
+      /// spreads its products over a few shards, picked by the thread that
+      /// constructs them. Each shard takes a single reference to the plugin
+      /// while it has any products alive, and releases it after the last of
+      /// those products is deleted.
+      /// \param[in] _use True to share references, false to have each product
+      /// take its own reference to the plugin.
+      public: void ShareProductReferences(bool _use = true);
+
+      /// \brief Check whether the products of this factory share references.
+      /// \return True if ShareProductReferences(true) has been called.
+      public: bool SharesProductReferences() const;
+
+      /// \internal \brief Get the reference which keeps this factory alive
+      /// for a new product
+      /// \return A reference to this factory
+      private: std::shared_ptr<void> ProductReference();
+
       /// \internal \brief This function gets implemented by Producing<Product>
       /// to manufacture the product instance.
+      /// \param[in] _resource
+      ///   The memory resource for the storage of the product, or nullptr to
+      ///   use the heap
+      /// \param[in] _factory
+      ///   The reference which keeps this factory alive for the product
+      /// \param[in] _args
+      ///   The arguments as defined by the template parameters
+      /// \return a raw pointer to the product
+      private: virtual Interface *ImplConstruct(
+        std::pmr::memory_resource *_resource,
+        std::shared_ptr<void> _factory,
+        Args&&... _args) = 0;
+
+      /// \internal \brief This function gets implemented by Producing<Product>
+      /// to manufacture a product in storage which is managed elsewhere.
+      /// \param[in] _storage
+      ///   Storage of at least productSize bytes, aligned to productAlignment
       /// \param[in] _args
       ///   The arguments as defined by the template parameters
       /// \return a raw pointer to the product
-      private: virtual Interface *ImplConstruct(Args&&... _args) = 0;
+      private: virtual Interface *ImplConstructAt(
+        void *_storage, Args&&... _args) = 0;
+
+      /// \internal \brief The statistics of this factory
+      private: detail::FactoryStatisticsCounters statistics;
+
+      /// \internal \brief Protects the creation of productPool and
+      /// referenceShards
+      private: mutable std::mutex productPoolMutex;
+
+      /// \internal \brief The pool which the products of this factory use
+      /// when UseProductPool(true) has been called. Every product keeps a
+      /// reference to its factory, so the pool outlives all of its products.
+      private: std::unique_ptr<std::pmr::synchronized_pool_resource>
+          productPool;
+
+      /// \internal \brief The pool that Construct should use, or nullptr
+      private: std::atomic<std::pmr::memory_resource*> activePool{nullptr};
+
+      /// \internal \brief The shards of the references of this factory. Once
+      /// created, these live as long as the factory.
+      private: std::unique_ptr<detail::ProductReferenceShards>
+          referenceShards;
+
+      /// \internal \brief The shards that Construct should use, or nullptr
+      private: std::atomic<detail::ProductReferenceShards*> activeShards{
+          nullptr};
+
+      /// \internal \brief Finds the counters of the products of
+      /// ImplConstruct. This gets set by Producing<Product> so that a
+      /// ProductPtr can delete its product without a dynamic_cast.
+      private: typename ProductDeleter<Interface>::CounterFunction
+          productCounter = nullptr;
+
+      /// \internal \brief The size of the products of ImplConstruct. This
+      /// gets set by Producing<Product>.
+      private: std::size_t productSize = 0;
+
+      /// \internal \brief The alignment of the products of ImplConstruct.
+      /// This gets set by Producing<Product>.
+      private: std::size_t productAlignment = 0;
 
       /// \private This nested class is used to implement the plugin factory.
       /// It is not intended for external use.
@@ -106,18 +438,14 @@ namespace ignition
     /// If you never call the .release() function on a ProductPtr, then you will
     /// never need to call this function.
     ///
-    /// \warning Note that this function should be called ONLY while there are
-    /// no Products that are actively destructing, or else there is a miniscule
-    /// probability of causing a segmentation fault. This is never an issue in a
-    /// single-threaded application.
-    ///
-    /// \warning If you have a multi-threaded application where you have
-    /// absolutely no control over the lifecycle of the products, and you cannot
-    /// reliably predict a safe window in which you know that no products are
-    /// being actively deleted, then you can specify a short safety wait to the
-    /// cleanup call. If any products were being deleted while this function is
-    /// called, this wait can give them time to fully exit their destructors
-    /// before we unload their libraries.
+    /// \warning The threads which delete such Products should do it inside an
+    /// EpochGuard. The factories are then only released once every thread
+    /// that was inside a guard when this function was called has left it, so
+    /// no Product can still be exiting its destructor when its library gets
+    /// unloaded. If a Product is deleted outside of any EpochGuard while this
+    /// function runs, there is a miniscule probability of causing a
+    /// segmentation fault. This is never an issue in a single-threaded
+    /// application.
     ///
     /// \note For some applications, it might not be important if there are tiny
     /// memory leaks or if plugin libraries remain loaded until the application
@@ -125,16 +453,36 @@ namespace ignition
     /// function at all.
     ///
     /// \param[in] _safetyWait
-    ///   For multi-threaded applications, this short waiting window gives time
-    ///   for products that are currently being deleted to exit their
-    ///   destructors before we unload their libraries. If you can reliably
-    ///   predict a window of time in which no products are actively being
-    ///   destructed (or if you have a single-threaded application), then it is
-    ///   okay to set this waiting time to 0. Note that any threads which are
-    ///   about to destruct a product will be blocked until this wait is over.
+    ///   For multi-threaded applications which delete Products outside of an
+    ///   EpochGuard, this waiting window gives time for products that are
+    ///   currently being deleted to exit their destructors before we unload
+    ///   their libraries. Applications which use EpochGuard, or which are
+    ///   single-threaded, do not need it. Threads which destruct products
+    ///   during this wait are not blocked by it, and the wait is skipped when
+    ///   there are no lost products.
     void IGNITION_PLUGIN_VISIBLE CleanupLostProducts(
         const std::chrono::nanoseconds &_safetyWait =
-            std::chrono::nanoseconds(5));
+            std::chrono::nanoseconds(0));
+
+    /// \brief Start a background thread which calls CleanupLostProducts()
+    /// periodically, so that the thread which owns the main loop of an
+    /// application never has to pay for unloading libraries. If a reaper is
+    /// already running, it is stopped and replaced by the new one.
+    ///
+    /// The reaper is stopped automatically when the program exits.
+    ///
+    /// \param[in] _period
+    ///   How long the reaper waits between cleanups.
+    /// \param[in] _safetyWait
+    ///   The safety wait of each cleanup. See CleanupLostProducts().
+    void IGNITION_PLUGIN_VISIBLE StartLostProductReaper(
+        const std::chrono::nanoseconds &_period,
+        const std::chrono::nanoseconds &_safetyWait =
+            std::chrono::nanoseconds(0));
+
+    /// \brief Stop the background thread started by StartLostProductReaper()
+    /// and wait for it to finish. This does nothing if no reaper is running.
+    void IGNITION_PLUGIN_VISIBLE StopLostProductReaper();
 
     /// \brief Get the number of lost products that have currently accumulated
     /// since the last time CleanupLostProducts() was called (or since the
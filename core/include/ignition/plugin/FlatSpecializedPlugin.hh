@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_FLATSPECIALIZEDPLUGIN_HH_
+#define IGNITION_PLUGIN_FLATSPECIALIZEDPLUGIN_HH_
+
+#include <array>
+#include <memory>
+#include "ignition/plugin/Plugin.hh"
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief This class provides the same high-speed access to interfaces
+    /// that can be anticipated at compile time as SpecializedPlugin, but
+    /// without composing one base class per specialized interface.
+    ///
+    /// The locations of the specialized interfaces are kept in a single
+    /// array, and each interface is found at the position of its type in the
+    /// template argument list, which is computed at compile time. Accessing a
+    /// specialized interface is a single array load, no matter how many
+    /// interfaces are specialized or where an interface appears in the list,
+    /// and the size of the object only grows by one pointer per interface.
+    ///
+    /// Usage example:
+    ///
+    /// \code
+    ///     using MyFlatPluginPtr = FlatSpecializedPluginPtr<
+    ///         MyInterface1, FooInterface, MyInterface2, BarInterface>;
+    ///
+    ///     MyFlatPluginPtr plugin = loader->Instantiate(pluginName);
+    ///     plugin->QueryInterface<FooInterface>();
+    /// \endcode
+    ///
+    /// Unlike SpecializedPlugin, a FlatSpecializedPlugin only specializes for
+    /// interface types which are exactly the ones that were listed, e.g.
+    /// `QueryInterface<const FooInterface>()` takes the normal path.
+    template <class... SpecInterfaces>
+    class FlatSpecializedPlugin : public Plugin
+    {
+      // -------------------- Public API ---------------------
+
+      // Inherit function overloads
+      public: using Plugin::QueryInterface;
+      public: using Plugin::QueryInterfaceSharedPtr;
+      public: using Plugin::HasInterface;
+
+      // Documentation inherited
+      public: template <class Interface>
+              Interface *QueryInterface();
+
+      // Documentation inherited
+      public: template <class Interface>
+              const Interface *QueryInterface() const;
+
+      // Documentation inherited
+      public: template <class Interface>
+              std::shared_ptr<Interface> QueryInterfaceSharedPtr();
+
+      // Documentation inherited
+      public: template <class Interface>
+              std::shared_ptr<const Interface> QueryInterfaceSharedPtr() const;
+
+      // Documentation inherited
+      public: template <class Interface>
+              bool HasInterface() const;
+
+      /// \brief Virtual destructor
+      public: virtual ~FlatSpecializedPlugin();
+
+      // -------------------- Private API ---------------------
+
+      // Declare friendship
+      template <class> friend class TemplatePluginPtr;
+
+      /// \brief The number of specialized interfaces
+      private: static constexpr std::size_t SlotCount =
+          sizeof...(SpecInterfaces);
+
+      /// \brief Get the position of an interface within the slots
+      /// \return The position of Interface, or SlotCount if Interface is not
+      /// one of the specialized interfaces
+      private: template <class Interface>
+               static constexpr std::size_t SlotOf();
+
+      // Dev note: The slots must be available to the user during their compile
+      // time, so they cannot be hidden using PIMPL. The Plugin base class
+      // updates them whenever this wrapper is given a different instance.
+      /// \brief The locations of the specialized interfaces within the plugin
+      /// instance, or nullptr for each one that the plugin does not provide
+      private: std::array<void*, SlotCount> slots;
+
+      /// \brief Default constructor
+      protected: FlatSpecializedPlugin();
+    };
+  }
+}
+
+#include "ignition/plugin/detail/FlatSpecializedPlugin.hh"
+
+#endif
@@ -19,6 +19,8 @@
 #ifndef IGNITION_PLUGIN_INFO_HH_
 #define IGNITION_PLUGIN_INFO_HH_
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <set>
@@ -37,15 +39,13 @@ namespace ignition
     /// version of the Info struct
     //
     /// This must be incremented when the Info struct changes
-    const int INFO_API_VERSION = 1;
-
-    // We use an inline namespace to assist in forward-compatibility. Eventually
-    // we may want to support a version-2 of the Info API, in which case
-    // we will remove the "inline" declaration here, and create a new inline
-    // namespace called "v2". This original Info object will continue to
-    // be accessible for backwards compatibility, and even its symbol name in
-    // the ABI should remain the same.
-    inline namespace v1
+    const int INFO_API_VERSION = 2;
+
+    // This is the original version of the Info API, which stores its factory,
+    // deleter and interface casters in std::function objects. It remains
+    // accessible for backwards compatibility, and its symbol names in the ABI
+    // remain the same, but plugins are now registered with the v2 Info below.
+    namespace v1
     {
       /// \brief Holds info required to construct a plugin
       struct IGNITION_PLUGIN_VISIBLE Info
@@ -95,6 +95,160 @@ namespace ignition
       };
     }
 
+    // Version 2 of the Info API stores plain function pointers instead of
+    // std::function objects. Every function that gets registered for a plugin
+    // is a captureless lambda, so there is nothing to type-erase, and copying
+    // an Info or casting a plugin instance to its interfaces no longer pays
+    // for the indirection (or potential allocations) of std::function.
+    inline namespace v2
+    {
+      /// \brief Holds info required to construct a plugin
+      struct IGNITION_PLUGIN_VISIBLE Info
+      {
+        /// \brief Clear out all information contained in this Info object
+        void Clear();
+
+        /// \brief The name of the plugin
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        std::string name;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        /// \brief Alternative names that may be used to instantiate the plugin
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        std::set<std::string> aliases;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        /// \brief A function that converts a void pointer (which actually
+        /// points to the plugin instance) to another void pointer (which
+        /// actually points to the location of an interface within the plugin
+        /// instance).
+        using InterfaceCaster = void *(*)(void *);
+
+        /// \brief A function that instantiates a new instance of a plugin
+        using FactoryFunction = void *(*)();
+
+        /// \brief A function that deletes an instance of a plugin
+        using DeleterFunction = void (*)(void *);
+
+        /// \brief A function that constructs a new instance of a plugin in the
+        /// storage that it is given, and returns a pointer to the instance.
+        using ConstructFunction = void *(*)(void *);
+
+        /// \brief A function that destructs an instance of a plugin which was
+        /// made by a ConstructFunction, without releasing its storage
+        using DestructFunction = void (*)(void *);
+
+        /// \brief A function that instantiates a new instance of a plugin,
+        /// passing arguments on to one of its constructors. It is given a
+        /// pointer to a std::tuple of references to the arguments, which it
+        /// forwards to the constructor. An instance that it returns is deleted
+        /// by the DeleterFunction of the plugin.
+        using ArgumentConstructor = void *(*)(void *);
+
+        /// \brief A table of plain functions, e.g. batched compute kernels,
+        /// which a plugin exports alongside its interfaces, as registered with
+        /// IGNITION_ADD_PLUGIN_KERNELS(). The functions can be called without
+        /// creating an instance of the plugin.
+        struct KernelTable
+        {
+          /// \brief The table, which has static storage duration within the
+          /// library of the plugin
+          const void *table = nullptr;
+
+          /// \brief The version of the layout of the table, as declared by
+          /// the kAbiVersion member of its type
+          std::uint32_t abiVersion = 0;
+        };
+
+        /// \brief The keys are the names of the types of interfaces that this
+        /// plugin provides. The values are the functions that cast a plugin
+        /// instance to each of those interfaces.
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        using InterfaceCastingMap =
+            std::unordered_map<std::string, InterfaceCaster>;
+        InterfaceCastingMap interfaces;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        /// \brief The stable IDs of the interfaces, see InterfaceId(). The
+        /// keys are the same mangled names as in `interfaces`. Plugin
+        /// instances look their interfaces up by these IDs, so the mangled
+        /// names only matter to the string-based API. An interface without an
+        /// ID, e.g. from a library that was built before the IDs existed, is
+        /// still found by its mangled name.
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        using InterfaceIdMap = std::unordered_map<std::string, std::uint64_t>;
+        InterfaceIdMap interfaceIds;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        /// \brief This is a set containing the demangled versions of the names
+        /// of the interfaces provided by this plugin. This gets filled in by
+        /// the Loader after receiving the Info. It is only used by
+        /// the user-facing API. Internally, when looking up Interfaces, the
+        /// mangled `interfaces` map will still be used. The set is ordered
+        /// with std::less<> so that it can be searched with a
+        /// std::string_view.
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        std::set<std::string, std::less<>> demangledInterfaces;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        /// \brief A method that instantiates a new instance of a plugin
+        FactoryFunction factory = nullptr;
+
+        /// \brief A method that safely deletes an instance of the plugin
+        DeleterFunction deleter = nullptr;
+
+        /// \brief The size of an instance of the plugin, in bytes
+        std::size_t instanceSize = 0;
+
+        /// \brief The alignment of an instance of the plugin, in bytes
+        std::size_t instanceAlignment = 0;
+
+        /// \brief A method that constructs a new instance of the plugin in
+        /// storage of at least `instanceSize` bytes, aligned to
+        /// `instanceAlignment`. This lets the instance share one allocation
+        /// with the objects that keep it alive.
+        ConstructFunction construct = nullptr;
+
+        /// \brief A method that destructs an instance of the plugin which was
+        /// made by `construct`
+        DestructFunction destruct = nullptr;
+
+        /// \brief A method that casts an instance of the plugin to its
+        /// EnablePluginFromThis base, or nullptr if the plugin does not
+        /// inherit EnablePluginFromThis. This lets a Loader set up
+        /// EnablePluginFromThis without searching through `interfaces`.
+        InterfaceCaster enablePluginFromThis = nullptr;
+
+        /// \brief The CPU features, e.g. "avx2", that the plugin needs in
+        /// order to run, as registered with IGNITION_ADD_PLUGIN_FEATURES().
+        /// See CpuSupports() for the names of the features.
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        std::set<std::string> requiredFeatures;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        /// \brief The names or aliases of the plugins which need to be
+        /// constructed before this one, as registered with
+        /// IGNITION_ADD_PLUGIN_DEPENDENCIES(). See Loader::InstantiateAll().
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        std::set<std::string> dependencies;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        /// \brief The constructors of the plugin which take arguments, as
+        /// registered with IGNITION_ADD_PLUGIN_CONSTRUCTOR(). The keys are the
+        /// mangled names of the signatures, i.e. typeid(void(Args...)).name().
+        /// See Loader::InstantiateWith().
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        std::unordered_map<std::string, ArgumentConstructor> constructors;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        /// \brief The kernel tables of the plugin. The keys are the mangled
+        /// names of the types of the tables. See Loader::QueryKernelTable().
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        std::unordered_map<std::string, KernelTable> kernelTables;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+      };
+    }
+
     /// This typedef is used simultaneously by detail/Register.hh and Loader.cc,
     /// so we store it in a location that is visible to both of them.
     using InfoMap = std::unordered_map<std::string, Info>;
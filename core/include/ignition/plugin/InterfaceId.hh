@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_INTERFACEID_HH_
+#define IGNITION_PLUGIN_INTERFACEID_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      //////////////////////////////////////////////////
+      /// \brief Get the name of a type as the compiler spells it, at compile
+      /// time. GCC renders __PRETTY_FUNCTION__ as "... [with T = ns::Type;
+      /// ...]", Clang as "... [T = ns::Type]", and MSVC renders __FUNCSIG__
+      /// as "... PrettyTypeName<class ns::Type>(void)".
+      template <typename T>
+      constexpr std::string_view PrettyTypeName()
+      {
+#if defined(_MSC_VER) && !defined(__clang__)
+        const std::string_view function = __FUNCSIG__;
+        const std::size_t begin = function.find("PrettyTypeName<") + 15;
+        return function.substr(begin, function.rfind(">(void)") - begin);
+#else
+        const std::string_view function = __PRETTY_FUNCTION__;
+        const std::size_t begin = function.find("T = ") + 4;
+        return function.substr(
+              begin, function.find_first_of(";]", begin) - begin);
+#endif
+      }
+
+      //////////////////////////////////////////////////
+      /// \brief Check whether a character can be part of an identifier
+      constexpr bool IsIdentifierChar(const char _c)
+      {
+        return ('a' <= _c && _c <= 'z') || ('A' <= _c && _c <= 'Z')
+            || ('0' <= _c && _c <= '9') || '_' == _c;
+      }
+
+      //////////////////////////////////////////////////
+      /// \brief Compute the 64-bit FNV-1a hash of an interface name, skipping
+      /// what compilers disagree on: spaces, and the keywords which MSVC puts
+      /// in front of class types. This way "ns::A<int, ns::B>",
+      /// "ns::A<int,ns::B>" and "ns::A<int,class ns::B>" all get the same
+      /// hash.
+      /// \param[in] _name The name of the interface
+      /// \return The hash of the canonical form of the name
+      constexpr std::uint64_t HashCanonicalName(const std::string_view _name)
+      {
+        constexpr std::string_view keywords[] =
+            {"class ", "struct ", "union ", "enum "};
+
+        std::uint64_t hash = 14695981039346656037ull;
+        std::size_t i = 0;
+        while (i < _name.size())
+        {
+          if (0 == i || !IsIdentifierChar(_name[i - 1]))
+          {
+            bool skipped = false;
+            for (const std::string_view keyword : keywords)
+            {
+              if (_name.substr(i, keyword.size()) == keyword)
+              {
+                i += keyword.size();
+                skipped = true;
+                break;
+              }
+            }
+
+            if (skipped)
+              continue;
+          }
+
+          const char c = _name[i++];
+          if (' ' == c)
+            continue;
+
+          hash ^= static_cast<unsigned char>(c);
+          hash *= 1099511628211ull;
+        }
+
+        return hash;
+      }
+    }
+
+    //////////////////////////////////////////////////
+    /// \brief The canonical name of an interface, from which InterfaceId()
+    /// is computed. By default this is the name of the type as the compiler
+    /// spells it, which agrees between compilers for plain classes, but not
+    /// necessarily for templates whose arguments have defaults, like
+    /// std::string. Use IGNITION_PLUGIN_INTERFACE_NAME to give such an
+    /// interface a name of its own.
+    template <typename Interface>
+    struct InterfaceIdentity
+    {
+      static constexpr std::string_view name =
+          detail::PrettyTypeName<Interface>();
+    };
+
+    //////////////////////////////////////////////////
+    /// \brief Get the stable 64-bit ID of an interface. Unlike the name of
+    /// its std::type_info, the ID is a compile time constant, and it is the
+    /// same for every toolchain, so plugins and the Loader use it to look up
+    /// the interfaces of a plugin instance. The mangled names are only kept
+    /// for diagnostics and for the string-based API.
+    /// \return The hash of the canonical name of the interface
+    template <typename Interface>
+    constexpr std::uint64_t InterfaceId()
+    {
+      // The hash is forced to be computed at compile time. Otherwise the name
+      // could be emitted into the library as a unique global symbol, which
+      // prevents GCC from ever unloading the library.
+      return std::integral_constant<std::uint64_t, detail::HashCanonicalName(
+            InterfaceIdentity<std::remove_cv_t<Interface>>::name)>::value;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Give an interface a canonical name of its own, which
+/// InterfaceId() hashes instead of the name that the compiler spells out.
+/// This must be used at global scope, right after the definition of the
+/// interface, so that every library which uses the interface sees it.
+///
+/// \code
+/// IGNITION_PLUGIN_INTERFACE_NAME(ns::Get<std::string>, "ns::Get<string>")
+/// \endcode
+#define IGNITION_PLUGIN_INTERFACE_NAME(InterfaceType, Name) \
+  namespace ignition \
+  { \
+    namespace plugin \
+    { \
+      template <> \
+      struct InterfaceIdentity<InterfaceType> \
+      { \
+        static constexpr std::string_view name = Name; \
+      }; \
+    } \
+  }
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_INTERFACEREF_HH_
+#define IGNITION_PLUGIN_INTERFACEREF_HH_
+
+#include <cassert>
+#include <memory>
+#include <utility>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    // Forward declaration
+    class Plugin;
+
+    /// \brief A non-owning reference to an interface of a plugin instance, as
+    /// returned by Plugin::QueryInterfaceRef().
+    ///
+    /// The interface gets looked up once, when the reference is made, and
+    /// every access afterwards is a plain pointer dereference, so a hot loop
+    /// can hold on to an InterfaceRef instead of calling QueryInterface() on
+    /// every iteration. Unlike the std::shared_ptr of
+    /// QueryInterfaceSharedPtr(), an InterfaceRef does not keep the plugin
+    /// instance alive, so copying it does not touch any reference count.
+    ///
+    /// The caller must keep a PluginPtr to the instance alive for as long as
+    /// the reference gets used. Unless NDEBUG is defined, every access
+    /// asserts that the instance is still alive, which catches references
+    /// that outlive their plugin. The layout of this class is the same either
+    /// way.
+    template <class Interface>
+    class InterfaceRef
+    {
+      /// \brief Make an empty reference
+      public: InterfaceRef() = default;
+
+      /// \brief Get the interface
+      /// \return A pointer to the interface, or nullptr if this reference is
+      /// empty
+      public: Interface *Get() const
+      {
+        assert((nullptr == this->ptr || !this->instance.expired()) &&
+               "The plugin instance of an InterfaceRef has been deleted");
+        return this->ptr;
+      }
+
+      /// \brief Access a member of the interface
+      public: Interface *operator->() const
+      {
+        return this->Get();
+      }
+
+      /// \brief Dereference the interface
+      public: Interface &operator*() const
+      {
+        return *this->Get();
+      }
+
+      /// \brief Check whether this refers to an interface
+      /// \return True if the plugin provided the interface when this
+      /// reference was made
+      public: explicit operator bool() const
+      {
+        return nullptr != this->ptr;
+      }
+
+      /// \brief Check whether the plugin instance of this reference has been
+      /// deleted, so that the interface must no longer be accessed. This is
+      /// what the assertions of Get() check.
+      /// \return True if the instance has been deleted, or if this reference
+      /// is empty
+      public: bool Expired() const
+      {
+        return this->instance.expired();
+      }
+
+      /// \brief Constructor which is used by Plugin::QueryInterfaceRef()
+      /// \param[in] _ptr The interface
+      /// \param[in] _instance The plugin instance which provides it
+      private: InterfaceRef(Interface *_ptr, std::weak_ptr<void> _instance)
+        : ptr(_ptr),
+          instance(std::move(_instance))
+      {
+      }
+
+      /// \brief The interface
+      private: Interface *ptr = nullptr;
+
+      /// \brief Tracks the plugin instance without keeping it alive
+      private: std::weak_ptr<void> instance;
+
+      // Plugin makes the references
+      friend class Plugin;
+    };
+  }
+}
+
+#endif
@@ -19,14 +19,20 @@
 #ifndef IGNITION_PLUGIN_PLUGIN_HH_
 #define IGNITION_PLUGIN_PLUGIN_HH_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
-#include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 #include <ignition/utilities/SuppressWarning.hh>
 
 #include <ignition/plugin/Export.hh>
 #include <ignition/plugin/Info.hh>
+#include <ignition/plugin/InterfaceId.hh>
+#include <ignition/plugin/InterfaceRef.hh>
 
 namespace ignition
 {
@@ -36,9 +42,33 @@ namespace ignition
     namespace detail {
       template <class, class> class ComposePlugin;
       template <class> class SelectSpecializers;
+
+      /// \brief The location of a specialized interface, which a
+      /// SpecializedPlugin keeps within itself so that it can reach the
+      /// interface without a lookup. A Plugin links the slots of all of its
+      /// specialized interfaces together, and keeps them up to date whenever
+      /// its plugin instance changes.
+      struct InterfaceSlot
+      {
+        /// \brief The location of the interface, or nullptr if the plugin
+        /// instance does not provide it
+        public: void *location;
+
+        /// \brief The value of InterfaceId<Interface>()
+        public: std::uint64_t id;
+
+        /// \brief The mangled name of the interface
+        public: std::string_view name;
+
+        /// \brief The next slot of the same Plugin
+        public: InterfaceSlot *next;
+      };
     }
     class EnablePluginFromThis;
+    class Loader;
+    class PluginHandle;
     class WeakPluginPtr;
+    template <class...> class FlatSpecializedPlugin;
 
     class IGNITION_PLUGIN_VISIBLE Plugin
     {
@@ -120,6 +150,22 @@ namespace ignition
               std::shared_ptr<const Interface> QueryInterfaceSharedPtr(
                   const std::string &/*_interfaceName*/) const;
 
+      /// \brief Get a non-owning reference to an interface of this plugin,
+      /// for calling the interface many times, e.g. in a control loop. The
+      /// interface is looked up once, and the reference neither keeps the
+      /// plugin instance alive nor touches its reference count. Unless NDEBUG
+      /// is defined, each access through the reference asserts that the
+      /// instance is still alive. See InterfaceRef.
+      ///
+      /// \return A reference to the specified interface, which is empty if
+      /// this Plugin does not provide the interface.
+      public: template <class Interface>
+              InterfaceRef<Interface> QueryInterfaceRef();
+
+      /// \brief const-qualified version of QueryInterfaceRef<Interface>()
+      public: template <class Interface>
+              InterfaceRef<const Interface> QueryInterfaceRef() const;
+
       /// \brief Checks if this Plugin has the specified type of interface.
       /// \return Returns true if this Plugin has the specified type of
       /// interface, and false otherwise.
@@ -132,14 +178,15 @@ namespace ignition
       /// interface name. If you want to use a mangled version of the name,
       /// set the `demangled` argument to false.
       ///
-      /// \param[in] _interfaceName The name of the desired interface, as a
-      /// std::string. Note that this expects the name to be mangled.
+      /// \param[in] _interfaceName The name of the desired interface. Note
+      /// that this expects the name to be demangled, unless _demangled is set
+      /// to false.
       /// \param[in] _demangled If _interfaceName is demangled, set this to
       /// true. If you are instead using the raw mangled name that gets provided
       /// by typeid(T).name(), then set _demangled to false.
       /// \return Returns true if this Plugin has the specified type of
       /// interface, and false otherwise.
-      public: bool HasInterface(const std::string &_interfaceName,
+      public: bool HasInterface(std::string_view _interfaceName,
                                 const bool _demangled = true) const;
 
       /// \brief Gets the name of this Plugin.
@@ -151,10 +198,13 @@ namespace ignition
 
       template <class> friend class TemplatePluginPtr;
       template <class...> friend class SpecializedPlugin;
+      template <class...> friend class FlatSpecializedPlugin;
       template <class, class> friend class detail::ComposePlugin;
       template <class> friend class detail::SelectSpecializers;
       friend class EnablePluginFromThis;
       friend class WeakPluginPtr;
+      friend class Loader;
+      friend class PluginHandle;
 
       /// \brief Default constructor. This is kept protected to discourage users
       /// from instantiating them directly. They should instead only be
@@ -163,7 +213,21 @@ namespace ignition
 
       /// \brief Type-agnostic retriever for interfaces
       private: void *PrivateQueryInterface(
-                  const std::string &_interfaceName) const;
+                  std::string_view _interfaceName) const;
+
+      /// \brief Type-agnostic retriever for interfaces, for callers which
+      /// know the type of the interface. This finds the interface by its ID
+      /// instead of comparing strings.
+      /// \param[in] _id
+      ///   The value of InterfaceId<Interface>()
+      /// \param[in] _interfaceName
+      ///   The mangled name of the interface, which is only used if the
+      ///   plugin was registered without interface IDs
+      /// \return A pointer to the interface, or nullptr if this plugin does
+      /// not provide it.
+      private: void *PrivateQueryInterface(
+                  std::uint64_t _id,
+                  std::string_view _interfaceName) const;
 
       /// \brief Copy the plugin instance from another Plugin object
       private: void PrivateCopyPluginInstance(const Plugin &_other) const;
@@ -173,9 +237,13 @@ namespace ignition
       ///   Pointer to the Info for this plugin
       /// \param[in] _instancePtr
       ///   Pointer to an already-existing abstract plugin instance pointer
+      /// \param[in] _table
+      ///   The interface table of the instance, as returned by
+      ///   PrivateGetSharedInterfaceTable(), or nullptr to build a new one
       private: void PrivateCopyPluginInstance(
                   const ConstInfoPtr &_info,
-                  const std::shared_ptr<void> &_instancePtr) const;
+                  const std::shared_ptr<void> &_instancePtr,
+                  const void *_table = nullptr) const;
 
       /// \brief Create a new plugin instance based on the info provided
       /// \param[in] _info
@@ -186,6 +254,39 @@ namespace ignition
                   const ConstInfoPtr &_info,
                   const std::shared_ptr<void> &_dlHandlePtr) const;
 
+      /// \brief Create a new plugin instance based on the info provided, using
+      /// storage from a memory resource
+      /// \param[in] _info
+      ///   Pointer to the Info for this plugin
+      /// \param[in] _dlHandlePtr
+      ///   Reference counter for the dl handle of this Plugin
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage of the plugin
+      ///   instance and its reference count. If this is nullptr, the default
+      ///   heap is used.
+      private: void PrivateCreatePluginInstance(
+                  const ConstInfoPtr &_info,
+                  const std::shared_ptr<void> &_dlHandlePtr,
+                  std::pmr::memory_resource *_resource) const;
+
+      /// \brief Take ownership of a plugin instance which has been made by
+      /// one of the Info::constructors of the plugin
+      /// \param[in] _info
+      ///   Pointer to the Info for this plugin
+      /// \param[in] _dlHandlePtr
+      ///   Reference counter for the dl handle of this Plugin
+      /// \param[in] _instance
+      ///   The plugin instance, which gets deleted by the Info::deleter of the
+      ///   plugin
+      /// \param[in] _resource
+      ///   The memory resource which provides the reference count of the
+      ///   plugin instance. If this is nullptr, the default heap is used.
+      private: void PrivateAdoptPluginInstance(
+                  const ConstInfoPtr &_info,
+                  const std::shared_ptr<void> &_dlHandlePtr,
+                  void *_instance,
+                  std::pmr::memory_resource *_resource) const;
+
       /// \brief Get a reference to the abstract instance being managed by this
       /// wrapper
       private: const std::shared_ptr<void> &PrivateGetInstancePtr() const;
@@ -193,17 +294,41 @@ namespace ignition
       /// \brief Get a reference to the Info being used by this wrapper
       private: const ConstInfoPtr &PrivateGetInfoPtr() const;
 
-      /// \brief The InterfaceMap type needs to get used in several places, like
-      /// Plugin::Implementation and SpecializedPlugin<T>. We make the typedef
-      /// public so that those other classes can use it without needing to be
-      /// friends of Plugin. End-users should not have any need for this
-      /// typedef.
-      public: using InterfaceMap = std::map<std::string, void*>;
-
-      /// \brief Get or create an iterator to the std::map that holds pointers
-      /// to the various interfaces provided by this plugin instance.
-      private: InterfaceMap::iterator PrivateGetOrCreateIterator(
-          const std::string &_interfaceName);
+      /// \brief Get the interface table of the plugin instance, if it is
+      /// owned by the same control block as the instance, so that a Plugin
+      /// which is copied from the instance later on can share it.
+      /// \return The interface table, or nullptr if it is owned separately
+      private: const void *PrivateGetSharedInterfaceTable() const;
+
+      /// \brief Get the EnablePluginFromThis base of the plugin instance. This
+      /// uses the caster in the Info of the plugin, so it does not need to
+      /// search the interfaces of the plugin.
+      /// \return The EnablePluginFromThis base, or nullptr if the plugin does
+      /// not inherit EnablePluginFromThis or this Plugin is empty.
+      private: EnablePluginFromThis *PrivateGetEnablePluginFromThis() const;
+
+      /// \brief Add the slot of a specialized interface to this plugin, which
+      /// will keep it up to date with the location of the interface within the
+      /// plugin instance. SpecializedPlugin keeps such a slot for its
+      /// interface, so the slot must outlive every change of the instance.
+      /// \param[in] _slot The slot, whose `id` and `name` have been set
+      private: void PrivateAddInterfaceSlot(detail::InterfaceSlot *_slot);
+
+      /// \brief Give this plugin an array of interface slots which it will
+      /// keep up to date with the locations of the interfaces within the plugin
+      /// instance. FlatSpecializedPlugin keeps its specialized interfaces in
+      /// such an array. Pass a nullptr _slots to stop updating the array.
+      /// \param[in] _slots The array of slots
+      /// \param[in] _ids The IDs of the interfaces that belong in each slot.
+      /// This must outlive the Plugin.
+      /// \param[in] _names The mangled names of the interfaces that belong in
+      /// each slot. This must outlive the Plugin.
+      /// \param[in] _count The number of slots
+      private: void PrivateSetInterfaceSlots(
+          void **_slots,
+          const std::uint64_t *_ids,
+          const std::string_view *_names,
+          std::size_t _count);
 
       class Implementation;
       IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
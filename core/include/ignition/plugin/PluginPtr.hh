@@ -22,7 +22,9 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <type_traits>
 
+#include <ignition/plugin/BorrowedInterface.hh>
 #include <ignition/plugin/Plugin.hh>
 
 namespace ignition
@@ -67,11 +69,11 @@ namespace ignition
       public: TemplatePluginPtr(const TemplatePluginPtr &_other);
 
       /// \brief Move constructor. This PluginPtr will take ownership of the
-      /// plugin instance held by _other. If this PluginPtr was holding an
-      /// instance to another plugin, that instance will be deleted if no other
-      /// PluginPtr is referencing which is being moved.
+      /// plugin instance held by _other. _other is left empty, and it remains
+      /// safe to use. Moving never allocates, so containers of PluginPtrs can
+      /// move their elements instead of copying them.
       /// \param[in] _other Plugin being moved.
-      public: TemplatePluginPtr(TemplatePluginPtr &&_other);
+      public: TemplatePluginPtr(TemplatePluginPtr &&_other) noexcept;
 
       /// \brief Casting constructor. This PluginPtr will now point at the same
       /// plugin instance as _other, and they will share ownership. This
@@ -106,10 +108,11 @@ namespace ignition
       /// \brief Move assignment operator. This PluginPtr will take ownership
       /// of the plugin instance held by _other. If this PluginPtr was holding
       /// an instance to another plugin, that instance will be deleted if no
-      /// other PluginPtr is referencing it.
+      /// other PluginPtr is referencing it. _other is left empty, and it
+      /// remains safe to use.
       /// \param[in] _other Plugin being moved.
       /// \return A reference to this object.
-      public: TemplatePluginPtr &operator=(TemplatePluginPtr &&_other);
+      public: TemplatePluginPtr &operator=(TemplatePluginPtr &&_other) noexcept;
 
       /// \brief nullptr assignment operator. Same as calling Clear()
       /// \param[in] A nullptr object.
@@ -127,6 +130,30 @@ namespace ignition
       /// \return A reference to the underlying Plugin object.
       public: PluginType &operator*() const;
 
+      /// \brief The type of the interfaces which are borrowed from this
+      /// PluginPtr. They are const-qualified if the plugin wrapper is.
+      public: template <class Interface>
+              using Borrowed = BorrowedInterface<std::conditional_t<
+                  std::is_const<PluginType>::value,
+                  const Interface, Interface>>;
+
+      /// \brief Borrow an interface of the plugin instance for the duration
+      /// of a scope, without touching the reference count of the instance.
+      /// Specialized interfaces are looked up through their fast path. The
+      /// PluginPtr must outlive the borrowed interface, and must not be
+      /// cleared or reassigned in the meantime. See BorrowedInterface.
+      /// \return The borrowed interface, which is empty if the plugin does
+      /// not provide it
+      public: template <class Interface>
+              Borrowed<Interface> Borrow() const &;
+
+      /// \brief Interfaces cannot be borrowed from a temporary PluginPtr,
+      /// since the plugin instance could be deleted at the end of the
+      /// statement. Keep the PluginPtr in a variable, or use
+      /// QueryInterfaceSharedPtr() instead.
+      public: template <class Interface>
+              void Borrow() const && = delete;
+
       /// \brief Comparison operator.
       /// \param[in] _other Plugin to compare to.
       /// \returns True if this Plugin is holding the same plugin
@@ -189,11 +216,39 @@ namespace ignition
       /// available any longer.
       public: void Clear();
 
+      /// \brief Get the address of the plugin instance of a PluginPtr, for
+      /// the checks of BorrowedInterface
+      /// \param[in] _self The PluginPtr
+      /// \return The address of the instance, or nullptr if it is empty
+      private: static const void *PrivateInstanceOf(const void *_self);
+
+      /// \brief Create a new plugin wrapper which does not refer to any
+      /// plugin instance
+      /// \return The new wrapper
+      private: static std::shared_ptr<PluginType> PrivateMakeWrapper();
+
+      /// \brief Get the wrapper which is shared by every empty PluginPtr of
+      /// this type. This lets empty and moved-from PluginPtrs be created
+      /// without any allocation.
+      /// \return The empty wrapper
+      private: static const std::shared_ptr<PluginType> &PrivateEmptyWrapper();
+
+      /// \brief Get a plugin wrapper which can be given a different plugin
+      /// instance. The current wrapper is reused unless another PluginPtr
+      /// shares it, in which case this PluginPtr gets a new wrapper.
+      /// \return The wrapper of this PluginPtr
+      private: PluginType &PrivateUniqueWrapper();
+
       /// \brief Pointer to the plugin wrapper that this PluginPtr is managing.
-      private: std::unique_ptr<PluginType> dataPtr;
+      /// A wrapper never changes while it is shared, so copies of a PluginPtr
+      /// of the same type share one wrapper, and copying only needs to update
+      /// a reference count.
+      private: std::shared_ptr<PluginType> dataPtr;
 
       // Declare friendship
       friend class Loader;
+      friend class PluginHandle;
+      friend class WeakPluginPtr;
       template <class> friend class TemplatePluginPtr;
 
       /// \brief Private constructor. Creates a plugin instance based on the
@@ -203,9 +258,12 @@ namespace ignition
       /// Loader. Alternatively, this can take a nullptr to create an
       /// empty PluginPtr.
       /// \param[in] _dlHandlePtr A reference count for the DL handle.
+      /// \param[in] _resource The memory resource which provides the storage
+      /// of the plugin instance, or nullptr to use the default heap.
       private: explicit TemplatePluginPtr(
           const ConstInfoPtr &_info,
-          const std::shared_ptr<void> &_dlHandlePtr);
+          const std::shared_ptr<void> &_dlHandlePtr,
+          std::pmr::memory_resource *_resource = nullptr);
     };
 
     /// \brief Typical usage for TemplatePluginPtr is to just hold a generic
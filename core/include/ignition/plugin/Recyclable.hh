@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_RECYCLABLE_HH_
+#define IGNITION_PLUGIN_RECYCLABLE_HH_
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Recyclable is an optional interface which lets the instances of
+    /// a plugin be reused instead of being deleted, for plugins which are
+    /// expensive to construct. Once Loader::SetInstancePool() has given the
+    /// plugin a pool, an instance whose last PluginPtr is dropped gets Reset()
+    /// and kept in the pool, and the next Loader::Instantiate() of the plugin
+    /// hands it out again without calling the factory of the plugin.
+    ///
+    /// Like any other interface, it needs to be listed when the plugin is
+    /// registered:
+    ///
+    /// \code
+    /// IGNITION_ADD_PLUGIN(MyDetector, Detector,
+    ///                     ignition::plugin::Recyclable)
+    /// \endcode
+    class Recyclable
+    {
+      /// \brief Destructor
+      public: virtual ~Recyclable() = default;
+
+      /// \brief Bring this instance back into the state of a newly
+      /// constructed one, so that it can be handed out again. Anything that
+      /// is expensive to set up, like buffers or caches, may be kept. This is
+      /// called by the thread which drops the last PluginPtr to the instance.
+      public: virtual void Reset() = 0;
+    };
+  }
+}
+
+#endif
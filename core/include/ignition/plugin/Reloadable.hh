@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_RELOADABLE_HH_
+#define IGNITION_PLUGIN_RELOADABLE_HH_
+
+#include <string>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Reloadable is an optional interface which lets the instances of
+    /// a plugin hand their state over to a new instance when the library of
+    /// the plugin gets reloaded with Loader::ReloadLib(). Loader::Reinstantiate
+    /// saves the state of the old instance and restores it into the new one.
+    ///
+    /// Like any other interface, it needs to be listed when the plugin is
+    /// registered:
+    ///
+    /// \code
+    /// IGNITION_ADD_PLUGIN(MyController, Controller,
+    ///                     ignition::plugin::Reloadable)
+    /// \endcode
+    ///
+    /// The old and the new instance may come from different builds of the
+    /// library, so the state should be encoded in a format that both of them
+    /// understand.
+    class Reloadable
+    {
+      /// \brief Destructor
+      public: virtual ~Reloadable() = default;
+
+      /// \brief Produce the state that a new instance should continue from
+      /// \return The encoded state of this instance
+      public: virtual std::string SaveState() const = 0;
+
+      /// \brief Continue from the state of an instance of an older version of
+      /// the plugin
+      /// \param[in] _state The state which that instance produced with
+      /// SaveState()
+      public: virtual void RestoreState(const std::string &_state) = 0;
+    };
+  }
+}
+
+#endif
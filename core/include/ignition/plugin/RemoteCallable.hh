@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_REMOTECALLABLE_HH_
+#define IGNITION_PLUGIN_REMOTECALLABLE_HH_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief RemoteCallable is an optional interface for plugins which can
+    /// be hosted in a separate process, so that a crash of the plugin does
+    /// not take the application down with it. See Loader::InstantiateRemote()
+    /// and RemotePlugin.
+    ///
+    /// The application calls the plugin by method numbers which the two
+    /// agree on. The arguments and the results are passed through memory
+    /// which both processes share, so HandleCall() reads its input and writes
+    /// its output in place, without any serialization. This suits plain
+    /// structs and arrays of them; anything that holds pointers cannot cross
+    /// the process boundary.
+    ///
+    /// Like any other interface, it needs to be listed when the plugin is
+    /// registered:
+    ///
+    /// \code
+    /// IGNITION_ADD_PLUGIN(MyController, Controller,
+    ///                     ignition::plugin::RemoteCallable)
+    /// \endcode
+    class RemoteCallable
+    {
+      /// \brief Destructor
+      public: virtual ~RemoteCallable() = default;
+
+      /// \brief Handle one call from the application. This runs in the
+      /// process which hosts the plugin, and calls are handled one at a time,
+      /// in the order in which they were made.
+      /// \param[in] _method The method number that the caller chose
+      /// \param[in] _input The arguments of the call, in shared memory
+      /// \param[in] _inputSize The number of bytes in _input
+      /// \param[out] _output Where the results of the call go, in shared
+      /// memory
+      /// \param[in] _outputCapacity The number of bytes that _output can hold
+      /// \return The number of bytes written to _output, or a negative number
+      /// if the method is not known or the call failed
+      public: virtual std::int64_t HandleCall(
+          std::uint32_t _method,
+          const void *_input, std::size_t _inputSize,
+          void *_output, std::size_t _outputCapacity) = 0;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_SHAREDPLUGINPTR_HH_
+#define IGNITION_PLUGIN_SHAREDPLUGINPTR_HH_
+
+#include <cstddef>
+
+#include <ignition/plugin/PluginPtr.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief SharedPluginPtr shares a plugin instance between many threads
+    /// which copy and drop their references all the time, like a physics
+    /// engine which is handed to every worker task of a simulation step.
+    ///
+    /// Every copy of a PluginPtr changes one reference count, so when dozens
+    /// of threads copy the same PluginPtr, the cache line of that count keeps
+    /// moving between their cores. SharedPluginPtr splits its reference count
+    /// into shards which each sit on a cache line of their own. A copy counts
+    /// itself in the shard of the thread which makes it, and a central count
+    /// only changes when a shard becomes empty or stops being empty. As long
+    /// as a thread destroys the copies that it made, it only touches its own
+    /// shard.
+    ///
+    /// All the SharedPluginPtrs which are made from one another hold a single
+    /// PluginPtr to the instance, which is released when the last of them is
+    /// gone. Use it like a PluginPtr:
+    ///
+    /// \code
+    /// const SharedPluginPtr engine = loader.Instantiate("MyPhysics");
+    /// // In each worker task:
+    /// const SharedPluginPtr local = engine;
+    /// local->QueryInterface<Physics>()->Step(dt);
+    /// \endcode
+    ///
+    /// Like with PluginPtr, different SharedPluginPtr objects may be copied
+    /// and destroyed by different threads at the same time, but one object
+    /// must not be changed by one thread while others use it.
+    ///
+    /// The shards make a SharedPluginPtr more expensive to create from a
+    /// PluginPtr, so it only pays off for instances which are copied a lot.
+    class IGNITION_PLUGIN_VISIBLE SharedPluginPtr
+    {
+      /// \brief Default constructor. Makes an empty SharedPluginPtr.
+      public: SharedPluginPtr();
+
+      /// \brief Share the instance of a PluginPtr
+      /// \param[in] _plugin
+      ///   The instance to share. If this is empty, so is the
+      ///   SharedPluginPtr.
+      // cppcheck-suppress noExplicitConstructor
+      public: SharedPluginPtr(const PluginPtr &_plugin);
+
+      /// \brief Copy constructor. The new reference is counted in the shard
+      /// of the calling thread.
+      /// \param[in] _other
+      ///   Another SharedPluginPtr to copy
+      public: SharedPluginPtr(const SharedPluginPtr &_other);
+
+      /// \brief Move constructor. This keeps the shard of _other, without
+      /// touching any count. _other is left empty.
+      /// \param[in] _other
+      ///   Another SharedPluginPtr to move from
+      public: SharedPluginPtr(SharedPluginPtr &&_other) noexcept;
+
+      /// \brief Copy assignment operator
+      /// \param[in] _other
+      ///   Another SharedPluginPtr to copy
+      /// \return reference to this
+      public: SharedPluginPtr &operator=(const SharedPluginPtr &_other);
+
+      /// \brief Move assignment operator
+      /// \param[in] _other
+      ///   Another SharedPluginPtr to move from
+      /// \return reference to this
+      public: SharedPluginPtr &operator=(SharedPluginPtr &&_other) noexcept;
+
+      /// \brief Destructor. Releases the instance if this is the last
+      /// SharedPluginPtr which refers to it.
+      public: ~SharedPluginPtr();
+
+      /// \brief Access the plugin. Just like with an empty PluginPtr, this
+      /// is safe to call on an empty SharedPluginPtr, whose plugin does not
+      /// provide any interfaces.
+      /// \return A pointer to the plugin
+      public: Plugin *operator->() const
+      {
+        return this->plugin;
+      }
+
+      /// \brief Access the plugin
+      /// \return A reference to the plugin
+      public: Plugin &operator*() const
+      {
+        return *this->plugin;
+      }
+
+      /// \brief Get the PluginPtr which is shared, e.g. to pass it to an API
+      /// which takes a PluginPtr. Copying it changes the reference count of
+      /// the PluginPtr, not the shards.
+      /// \return The PluginPtr, which is empty if this SharedPluginPtr is
+      /// empty
+      public: const PluginPtr &Get() const;
+
+      /// \brief Check whether this refers to an instance
+      /// \return true if this SharedPluginPtr is empty
+      public: bool IsEmpty() const
+      {
+        return nullptr == this->block;
+      }
+
+      /// \brief Convert to a boolean
+      /// \return true if this refers to an instance
+      public: explicit operator bool() const
+      {
+        return nullptr != this->block;
+      }
+
+      /// \brief Drop the reference of this SharedPluginPtr, which becomes
+      /// empty
+      public: void Clear();
+
+      /// \brief Get the number of shards that each shared instance has. This
+      /// depends on the number of hardware threads.
+      /// \return The number of shards
+      public: static std::size_t ShardCount();
+
+      /// \brief The PluginPtr and the reference counts which are shared
+      private: class Block;
+
+      /// \brief Count a reference to a block in the shard of the calling
+      /// thread, and refer to the block
+      /// \param[in] _block The block, which may be nullptr
+      private: void PrivateAcquire(Block *_block);
+
+      /// \brief Release the reference of this SharedPluginPtr, and become
+      /// empty
+      private: void PrivateRelease();
+
+      /// \brief The block of the instance, or nullptr if this is empty
+      private: Block *block;
+
+      /// \brief The plugin of the instance, cached so that access does not
+      /// need to go through the block
+      private: Plugin *plugin;
+
+      /// \brief The shard in which this reference is counted
+      private: std::size_t shard;
+    };
+  }
+}
+
+#endif
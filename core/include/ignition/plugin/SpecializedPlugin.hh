@@ -146,13 +146,12 @@ namespace ignition
       /// \return True if the interface is present.
       private: bool PrivateHasInterface(type<SpecInterface>) const;
 
-      // Dev note (MXG): The privateSpecializedInterfaceIterator object must be
+      // Dev note (MXG): The privateSpecializedInterfaceSlot object must be
       // available to the user during their compile time, so it cannot be hidden
-      // using PIMPL. The iterator is const because it must always point to the
-      // same entry throughout its entire lifecycle.
-      /// \brief Iterator that points to the entry of the specialized interface
-      private:
-      const Plugin::InterfaceMap::iterator privateSpecializedInterfaceIterator;
+      // using PIMPL. The Plugin base refers to the slot for as long as this
+      // object exists, so it never moves.
+      /// \brief The location of the specialized interface
+      private: detail::InterfaceSlot privateSpecializedInterfaceSlot;
 
       /// \brief Default constructor
       protected: SpecializedPlugin();
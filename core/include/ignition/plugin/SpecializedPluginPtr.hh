@@ -19,6 +19,7 @@
 #ifndef IGNITION_PLUGIN_SPECIALIZEDPLUGINPTR_HH_
 #define IGNITION_PLUGIN_SPECIALIZEDPLUGINPTR_HH_
 
+#include "ignition/plugin/FlatSpecializedPlugin.hh"
 #include "ignition/plugin/PluginPtr.hh"
 #include "ignition/plugin/SpecializedPlugin.hh"
 
@@ -69,6 +70,20 @@ namespace ignition
     template <typename... SpecInterfaces>
     using ConstSpecializedPluginPtr =
               TemplatePluginPtr< const SpecializedPlugin<SpecInterfaces...> >;
+
+    /// \brief This alias provides the same high-speed access to interfaces as
+    /// SpecializedPluginPtr, using a FlatSpecializedPlugin. Its access time
+    /// and size do not depend on the number of specialized interfaces, so it
+    /// is preferable when many interfaces are specialized.
+    template <typename... SpecInterfaces>
+    using FlatSpecializedPluginPtr =
+              TemplatePluginPtr< FlatSpecializedPlugin<SpecInterfaces...> >;
+
+    /// \brief This alias creates a flat specialized PluginPtr whose interfaces
+    /// are all const-qualified.
+    template <typename... SpecInterfaces>
+    using ConstFlatSpecializedPluginPtr =
+        TemplatePluginPtr< const FlatSpecializedPlugin<SpecInterfaces...> >;
   }
 }
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_STATICREGISTRY_HH_
+#define IGNITION_PLUGIN_STATICREGISTRY_HH_
+
+#include <ignition/plugin/Export.hh>
+#include <ignition/plugin/Info.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      /// \private Add the Info of a plugin to the process-wide registry of
+      /// plugins which are linked into the program statically.
+      ///
+      /// When a translation unit is compiled with IGN_PLUGIN_STATIC_REGISTRY
+      /// defined, the registration macros of ignition/plugin/Register.hh feed
+      /// this registry instead of the IgnitionPluginHook of a shared library,
+      /// so any number of plugin libraries can be linked into one program.
+      /// Loader::LoadStaticPlugins() then makes the plugins available.
+      ///
+      /// DO NOT CALL THIS FUNCTION DIRECTLY. It is used by the Registrar.
+      ///
+      /// \param[in] _info The (mangled) Info of the plugin. If the registry
+      /// already has an entry with the same name, the interfaces and aliases
+      /// of _info are merged into it.
+      void IGNITION_PLUGIN_VISIBLE RegisterStaticPlugin(const Info &_info);
+
+      /// \private Get a copy of the registry of statically linked plugins.
+      /// \return The (mangled) Info of every plugin that has been registered
+      /// with RegisterStaticPlugin(~) so far.
+      InfoMap IGNITION_PLUGIN_VISIBLE StaticPlugins();
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_TRACE_HH_
+#define IGNITION_PLUGIN_TRACE_HH_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string_view>
+
+#include <ignition/utilities/SuppressWarning.hh>
+
+#include <ignition/plugin/Export.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief A span of time that was spent on one step of loading a library,
+    /// instantiating a plugin, or forgetting a library. See TraceObserver.
+    struct TraceEvent
+    {
+      /// \brief The name of the step, e.g. "dlopen" or "Instantiate". This
+      /// is a string literal, so it remains valid forever.
+      const char *name;
+
+      /// \brief What the step worked on, i.e. the path of a library or the
+      /// name of a plugin. This is only valid while the event is being
+      /// observed.
+      std::string_view detail;
+
+      /// \brief When the step started, in nanoseconds on the clock of
+      /// std::chrono::steady_clock
+      std::int64_t start;
+
+      /// \brief How long the step took, in nanoseconds
+      std::int64_t duration;
+    };
+
+    /// \brief Receives trace events from every Loader and plugin instance of
+    /// the process, once it has been passed to SetTraceObserver().
+    ///
+    /// The following steps are traced:
+    ///   - LoadLib: the whole of Loader::LoadLib(), per library
+    ///   - dlopen: opening a library
+    ///   - RemapHugePages: moving the code of a library onto huge pages, see
+    ///     LoadOptions::hugePageText
+    ///   - LoadPlugins: retrieving the plugins of a library
+    ///   - IgnitionPluginHook: running the registration hook of a library
+    ///   - CopyInfo: copying the Info that the hook provided
+    ///   - LoadDescriptors: reading the plugin descriptors of a library
+    ///   - Demangle: demangling the names of the plugins of a library
+    ///   - CommitLib: inserting the plugins of a library into the registry
+    ///   - ForgetLibrary: forgetting a library
+    ///   - Instantiate: the whole of Loader::Instantiate(), per plugin
+    ///   - Create: constructing a plugin instance
+    ///   - Construct: Factory::Construct() and Factory::ConstructShared(),
+    ///     per product. The detail is the mangled name of the class of the
+    ///     factory.
+    class IGNITION_PLUGIN_VISIBLE TraceObserver
+    {
+      /// \brief Destructor
+      public: virtual ~TraceObserver();
+
+      /// \brief Called whenever a step finishes. This may be called from any
+      /// thread, and from several threads at once. It must not call into
+      /// ign-plugin.
+      /// \param[in] _event The step that finished
+      public: virtual void OnTraceEvent(const TraceEvent &_event) = 0;
+    };
+
+    /// \brief Start or stop tracing. There is one observer for the whole
+    /// process. While there is none, every trace point costs a single atomic
+    /// load.
+    ///
+    /// Steps which were already underway when the observer is changed may
+    /// still be reported to the previous observer, so an observer needs to
+    /// outlive the work that it has been observing.
+    ///
+    /// \param[in] _observer The observer, or nullptr to stop tracing
+    void IGNITION_PLUGIN_VISIBLE SetTraceObserver(TraceObserver *_observer);
+
+    /// \brief A TraceObserver which collects the events and writes them in
+    /// the Chrome trace event format, which can be opened with
+    /// chrome://tracing or with the Perfetto UI.
+    class IGNITION_PLUGIN_VISIBLE ChromeTraceWriter : public TraceObserver
+    {
+      /// \brief Constructor
+      public: ChromeTraceWriter();
+
+      /// \brief Destructor
+      public: ~ChromeTraceWriter() override;
+
+      // Documentation inherited
+      public: void OnTraceEvent(const TraceEvent &_event) override;
+
+      /// \brief Get the number of events that have been collected
+      /// \return The number of events
+      public: std::size_t EventCount() const;
+
+      /// \brief Write the collected events as a JSON trace
+      /// \param[out] _out The stream to write to
+      public: void Write(std::ostream &_out) const;
+
+      /// \brief Forget the events that have been collected
+      public: void Clear();
+
+      /// \brief Private data
+      private: class Implementation;
+      IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+      private: std::unique_ptr<Implementation> dataPtr;
+      IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+    };
+
+    /// \brief The latencies of one kind of step, as measured by a
+    /// LatencyMonitor. The times are in nanoseconds, and are accurate to
+    /// within 1/8 of their value.
+    struct LatencySummary
+    {
+      /// \brief The number of steps that were measured
+      std::uint64_t count = 0;
+
+      /// \brief Half of the steps took at most this long
+      std::int64_t p50 = 0;
+
+      /// \brief 99% of the steps took at most this long
+      std::int64_t p99 = 0;
+
+      /// \brief How long the slowest step took
+      std::int64_t max = 0;
+    };
+
+    /// \brief A TraceObserver which keeps a histogram of the latencies of
+    /// each of the steps LoadLib, Instantiate, Construct and ForgetLibrary,
+    /// and calls a function whenever one of them takes longer than its
+    /// threshold. This tells a program with deadlines right away whether
+    /// loading or instantiating a plugin made it miss one.
+    ///
+    /// Recording a step does not lock anything, so it is cheap enough to
+    /// leave running in production. Like every TraceObserver, a monitor
+    /// sees the steps of every Loader in the process, once it has been
+    /// passed to SetTraceObserver().
+    class IGNITION_PLUGIN_VISIBLE LatencyMonitor : public TraceObserver
+    {
+      /// \brief A function which is called with each step that took longer
+      /// than its threshold. The detail of the event names the library or
+      /// plugin involved. It is called on the thread that performed the
+      /// step, and must not call into ign-plugin.
+      public: using SlowStepCallback =
+          std::function<void(const TraceEvent &_event)>;
+
+      /// \brief Constructor
+      /// \param[in] _onSlowStep The function to call with slow steps, if any
+      /// \param[in] _next Another observer which receives every event after
+      /// this monitor, e.g. a ChromeTraceWriter, or nullptr. It must outlive
+      /// the monitor.
+      public: explicit LatencyMonitor(
+          SlowStepCallback _onSlowStep = nullptr,
+          TraceObserver *_next = nullptr);
+
+      /// \brief Destructor
+      public: ~LatencyMonitor() override;
+
+      // Documentation inherited
+      public: void OnTraceEvent(const TraceEvent &_event) override;
+
+      /// \brief Set how long a step may take before it is reported to the
+      /// SlowStepCallback. This may be called while steps are being
+      /// recorded.
+      /// \param[in] _step The name of the step, e.g. "Instantiate"
+      /// \param[in] _threshold The threshold, or zero to never report the
+      /// step, which is the default
+      /// \return False if the monitor does not measure the step
+      public: bool SetThreshold(
+          std::string_view _step, std::chrono::nanoseconds _threshold);
+
+      /// \brief Get the latencies of a step
+      /// \param[in] _step The name of the step, e.g. "LoadLib"
+      /// \return The latencies, which are all zero if the step has not been
+      /// measured
+      public: LatencySummary Summary(std::string_view _step) const;
+
+      /// \brief Forget the latencies that have been measured. The
+      /// thresholds are kept.
+      public: void Reset();
+
+      /// \brief Private data
+      private: class Implementation;
+      IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+      private: std::unique_ptr<Implementation> dataPtr;
+      IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+    };
+
+    namespace detail
+    {
+      /// \brief The observer of SetTraceObserver(), or nullptr while tracing
+      /// is off
+      extern IGNITION_PLUGIN_VISIBLE std::atomic<TraceObserver*> traceObserver;
+
+      /// \brief Measures the scope that it lives in and reports it to the
+      /// trace observer. While there is no observer, this does nothing
+      /// besides loading the observer pointer.
+      class TraceScope
+      {
+        /// \brief Constructor
+        /// \param[in] _name The name of the step. This must be a string
+        /// literal.
+        /// \param[in] _detail What the step works on. This must outlive the
+        /// scope.
+        public: TraceScope(const char *_name, std::string_view _detail)
+          : observer(traceObserver.load(std::memory_order_acquire))
+        {
+          if (this->observer)
+          {
+            this->name = _name;
+            this->detail = _detail;
+            this->start = Now();
+          }
+        }
+
+        /// \brief Destructor. Reports the event.
+        public: ~TraceScope()
+        {
+          if (this->observer)
+          {
+            this->observer->OnTraceEvent(TraceEvent{
+                this->name, this->detail, this->start,
+                Now() - this->start});
+          }
+        }
+
+        public: TraceScope(const TraceScope &) = delete;
+        public: TraceScope &operator=(const TraceScope &) = delete;
+
+        /// \brief Get the current time
+        /// \return Nanoseconds on the clock of std::chrono::steady_clock
+        private: static std::int64_t Now()
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /// \brief The observer at the time when the scope was entered
+        private: TraceObserver *const observer;
+
+        /// \brief The name of the step
+        private: const char *name = nullptr;
+
+        /// \brief What the step works on
+        private: std::string_view detail;
+
+        /// \brief When the scope was entered
+        private: std::int64_t start = 0;
+      };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_TYPEDPLUGINPTR_HH_
+#define IGNITION_PLUGIN_TYPEDPLUGINPTR_HH_
+
+#include <cassert>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+
+#include <ignition/plugin/PluginPtr.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief A plugin instance which is known to provide every one of a
+    /// fixed list of interfaces. This is a stricter sibling of
+    /// SpecializedPluginPtr for hosts which share the interface headers with
+    /// their plugins, so that the interfaces they need are known at compile
+    /// time.
+    ///
+    /// Every interface is looked up once, when the TypedPluginPtr is made,
+    /// and its pointer is kept next to the instance. Get() is then a plain
+    /// load from this object: there is no map lookup, no check for nullptr,
+    /// and asking for an interface that is not listed does not compile. If
+    /// the plugin does not provide one of the interfaces, the TypedPluginPtr
+    /// is left empty instead of holding an instance that is only partly
+    /// usable.
+    ///
+    /// Loader::Instantiate<TypedPluginPtr<...>>() checks the interfaces
+    /// against the Info of the plugin before it creates an instance, and
+    /// reports the interfaces which are missing.
+    ///
+    /// \code
+    /// using Device = TypedPluginPtr<Sensor, Calibrated>;
+    /// const Device device = loader.Instantiate<Device>("MySensor");
+    /// if (device)
+    ///   device.Get<Calibrated>().Calibrate(device.Get<Sensor>().Read());
+    /// \endcode
+    template <class... Interfaces>
+    class TypedPluginPtr
+    {
+      static_assert(sizeof...(Interfaces) > 0,
+                    "A TypedPluginPtr needs at least one interface");
+
+      /// \brief Make an empty TypedPluginPtr
+      public: TypedPluginPtr() = default;
+
+      /// \brief Take a plugin instance, if it provides every interface. This
+      /// is implicit, just like the conversions between the other plugin
+      /// pointer types.
+      /// \param[in] _plugin
+      ///   The instance. If it is empty or does not provide one of the
+      ///   interfaces, this TypedPluginPtr is left empty.
+      public: TypedPluginPtr(const PluginPtr &_plugin)
+      {
+        if (!_plugin)
+          return;
+
+        this->interfaces = std::make_tuple(
+            _plugin->template QueryInterface<Interfaces>()...);
+
+        if (((nullptr != std::get<Interfaces *>(this->interfaces)) && ...))
+          this->plugin = _plugin;
+        else
+          this->interfaces = std::tuple<Interfaces *...>();
+      }
+
+      /// \brief Get one of the interfaces. This TypedPluginPtr must not be
+      /// empty.
+      /// \return A reference to the interface
+      public: template <class Interface>
+      Interface &Get() const
+      {
+        static_assert((std::is_same_v<Interface, Interfaces> || ...),
+                      "The interface is not listed in this TypedPluginPtr");
+
+        assert(this->plugin && "Get() was called on an empty TypedPluginPtr");
+        return *std::get<Interface *>(this->interfaces);
+      }
+
+      /// \brief Get the instance as a PluginPtr, e.g. to query interfaces
+      /// that are not listed
+      /// \return The instance, or an empty PluginPtr if this is empty
+      public: const PluginPtr &Untyped() const
+      {
+        return this->plugin;
+      }
+
+      /// \brief Check whether this holds an instance
+      /// \return True if this TypedPluginPtr is empty
+      public: bool IsEmpty() const
+      {
+        return !this->plugin;
+      }
+
+      /// \brief Convert this TypedPluginPtr to a boolean
+      /// \return True if this holds an instance
+      public: explicit operator bool() const
+      {
+        return static_cast<bool>(this->plugin);
+      }
+
+      /// \brief Release the instance. This TypedPluginPtr becomes empty.
+      public: void Clear()
+      {
+        this->plugin.Clear();
+        this->interfaces = std::tuple<Interfaces *...>();
+      }
+
+      /// \brief The instance, which keeps the interfaces alive
+      private: PluginPtr plugin;
+
+      /// \brief The interfaces of the instance
+      private: std::tuple<Interfaces *...> interfaces;
+    };
+
+    namespace detail
+    {
+      /// \brief Tells whether T is a TypedPluginPtr
+      template <class T>
+      struct TypedPluginPtrTraits
+      {
+        static constexpr bool isTyped = false;
+      };
+
+      template <class... Interfaces>
+      struct TypedPluginPtrTraits<TypedPluginPtr<Interfaces...>>
+      {
+        static constexpr bool isTyped = true;
+
+        /// \brief The mangled names of the interfaces, which are the keys of
+        /// Info::interfaces
+        inline static const char *const interfaceNames[] =
+            {typeid(Interfaces).name()...};
+      };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_WARMUP_HH_
+#define IGNITION_PLUGIN_WARMUP_HH_
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Warmup is an optional interface for plugins whose first calls
+    /// are much slower than the ones that follow, e.g. because the symbols
+    /// that they call still need to be bound by the dynamic linker, or
+    /// because their tables have not been touched yet. Loader::Prewarm()
+    /// calls WarmUp() on a new instance ahead of a phase in which latency
+    /// matters.
+    ///
+    /// Just like EnablePluginFromThis, this interface is detected when the
+    /// plugin is registered, so it does not need to be listed among the
+    /// interfaces of the plugin.
+    class Warmup
+    {
+      /// \brief Destructor
+      public: virtual ~Warmup() = default;
+
+      /// \brief Run through the code paths that the plugin is going to use,
+      /// without side effects that anyone else can observe. This is called
+      /// once per instance that Loader::Prewarm() creates.
+      public: virtual void WarmUp() = 0;
+    };
+  }
+}
+
+#endif
@@ -49,7 +49,7 @@ namespace ignition
       /// \brief Move constructor
       /// \param[in] _other
       ///   Another WeakPluginPtr to move from
-      public: WeakPluginPtr(WeakPluginPtr &&_other);
+      public: WeakPluginPtr(WeakPluginPtr &&_other) noexcept;
 
       /// \brief Construct from a live PluginPtr
       /// \param[in] _ptr
@@ -69,7 +69,7 @@ namespace ignition
       /// \param[in] _other
       ///   Another WeakPluginPtr to move from
       /// \return reference to this
-      public: WeakPluginPtr &operator=(WeakPluginPtr &&_other);
+      public: WeakPluginPtr &operator=(WeakPluginPtr &&_other) noexcept;
 
       /// \brief Assign from a live PluginPtr
       /// \param[in] _ptr
@@ -83,18 +83,32 @@ namespace ignition
       /// \return The PluginPtr that this WeakPluginPtr refers to.
       public: PluginPtr Lock() const;
 
-      /// \brief Check whether the referenced Plugin has already expired.
+      /// \brief Check whether the referenced Plugin has already expired. This
+      /// is a single atomic load, so it is cheap enough to call frequently.
       /// \return true if this PluginPtr is expired, false otherwise.
       public: bool IsExpired() const;
 
       /// \brief Destructor
       public: ~WeakPluginPtr();
 
-      private: class Implementation;
       IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
-      /// \brief PIMPL pointer to the implementation of this class
-      private: std::unique_ptr<Implementation> pimpl;
+      /// \brief The plugin instance. The control block of the instance also
+      /// keeps the Info of the plugin alive, so this is the only reference
+      /// that we need to track.
+      private: std::weak_ptr<void> instance;
       IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+      /// \brief The Info of the plugin. This may only be used while the
+      /// instance is locked.
+      private: const Info *info = nullptr;
+
+      /// \brief The interface table of the plugin instance, if it is owned by
+      /// the control block of the instance, so that Lock() does not need to
+      /// build a new one. This may only be used while the instance is locked.
+      private: const void *table = nullptr;
+
+      // EnablePluginFromThis locks the instance directly
+      friend class EnablePluginFromThis;
     };
   }
 }
@@ -18,12 +18,26 @@
 #ifndef IGNITION_PLUGIN_DETAIL_FACTORY_HH_
 #define IGNITION_PLUGIN_DETAIL_FACTORY_HH_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 #include <ignition/utilities/SuppressWarning.hh>
 
 #include <ignition/plugin/Factory.hh>
+#include <ignition/plugin/Trace.hh>
 
 namespace ignition
 {
@@ -45,6 +59,10 @@ namespace ignition
         private: std::shared_ptr<void> factoryPluginInstancePtr;
         IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
 
+        /// \brief The statistics of the factory that created this product.
+        /// The factory outlives its products, so this is always safe to use.
+        private: FactoryStatisticsCounters *statistics = nullptr;
+
         /// \brief A special destructor that ensures the shared library remains
         /// loaded throughout the destruction process of this product.
         public: virtual ~FactoryCounter();
@@ -53,11 +71,293 @@ namespace ignition
         template <typename, typename...> friend class ignition::plugin::Factory;
         template <typename> friend class ignition::plugin::ProductDeleter;
       };
+
+      /// \brief Allocate the storage of a product. The storage is preceded by a
+      /// small header which remembers where it came from, so that the storage
+      /// can be deallocated without knowing anything other than its address.
+      /// \param[in] _size The size of the product
+      /// \param[in] _alignment The alignment of the product
+      /// \param[in] _resource The memory resource to allocate the storage
+      /// from, or nullptr to allocate it from the heap
+      /// \return The storage for the product
+      IGNITION_PLUGIN_VISIBLE void *AllocateProduct(
+        std::size_t _size, std::size_t _alignment,
+        std::pmr::memory_resource *_resource);
+
+      /// \brief Deallocate storage which was returned by AllocateProduct
+      /// \param[in] _ptr The storage of the product
+      IGNITION_PLUGIN_VISIBLE void DeallocateProduct(void *_ptr);
+
+      /// \brief Get the number of bytes that AllocateProduct takes up for a
+      /// product, including its header and padding
+      /// \param[in] _size The size of the product
+      /// \param[in] _alignment The alignment of the product
+      /// \return The number of bytes needed for the product
+      IGNITION_PLUGIN_VISIBLE std::size_t ProductFootprint(
+        std::size_t _size, std::size_t _alignment);
+
+      /// \brief A contiguous block of storage for a batch of products made by
+      /// Factory::ConstructMany. The block holds the one reference to the
+      /// factory which all of its products share, and it is released once the
+      /// last of its products is gone.
+      ///
+      /// Dev note: This class is compiled into the core library rather
+      /// than being a template, because releasing the block may release the
+      /// last reference to the factory and unload the plugin library.
+      class IGNITION_PLUGIN_VISIBLE ProductBlock
+          : public std::pmr::memory_resource
+      {
+        /// \brief Constructor
+        /// \param[in] _size The number of bytes in the block
+        /// \param[in] _alignment The alignment of the block
+        /// \param[in] _factory The reference to the factory of the products
+        public: ProductBlock(std::size_t _size, std::size_t _alignment,
+                             std::shared_ptr<void> _factory);
+
+        /// \brief Destructor
+        public: ~ProductBlock() override;
+
+        // Documentation inherited
+        private: void *do_allocate(
+          std::size_t _bytes, std::size_t _alignment) override;
+
+        // Documentation inherited
+        private: void do_deallocate(
+          void *_p, std::size_t _bytes, std::size_t _alignment) override;
+
+        // Documentation inherited
+        private: bool do_is_equal(
+          const std::pmr::memory_resource &_other) const noexcept override;
+
+        /// \brief The start of the block
+        private: unsigned char *storage;
+
+        /// \brief The number of bytes in the block
+        private: std::size_t size;
+
+        /// \brief The alignment of the block
+        private: std::size_t alignment;
+
+        /// \brief The number of bytes which have been handed out
+        private: std::size_t used = 0;
+
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        /// \brief The reference to the factory. CRUCIAL DEV NOTE: This
+        /// must be declared last so that the storage is freed before the
+        /// factory, and its library, might be released.
+        private: std::shared_ptr<void> factory;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+      };
+
+      /// \brief A few references to a factory, which its products share
+      /// instead of each taking a reference to the plugin instance of the
+      /// factory. See Factory::ShareProductReferences().
+      class IGNITION_PLUGIN_VISIBLE ProductReferenceShards
+      {
+        /// \brief Constructor
+        public: ProductReferenceShards();
+
+        /// \brief Destructor
+        public: ~ProductReferenceShards();
+
+        /// \brief Get the reference of the shard of the calling thread.
+        /// \return The reference, or nullptr if the shard does not currently
+        /// have any products alive. In that case, call Install().
+        public: std::shared_ptr<void> Acquire();
+
+        /// \brief Give the shard of the calling thread a reference to the
+        /// plugin. If another thread has installed one in the meantime, that
+        /// one is used instead.
+        /// \param[in] _plugin A reference to the plugin instance of the
+        /// factory
+        /// \return The reference of the shard
+        public: std::shared_ptr<void> Install(std::shared_ptr<void> _plugin);
+
+        /// \brief Private data
+        private: class Implementation;
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        private: std::unique_ptr<Implementation> dataPtr;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+      };
+
+      /// \brief The object which a std::shared_ptr from
+      /// Factory::ConstructShared() manages. The product itself lives in the
+      /// storage behind it, see SharedProductAllocator.
+      template <typename Interface>
+      struct SharedProduct
+      {
+        /// \brief Destroy the product. Its storage, and the reference to its
+        /// factory, are released afterwards by the control block.
+        public: ~SharedProduct()
+        {
+          if (this->product)
+            this->product->~Interface();
+        }
+
+        /// \brief The product, or nullptr if its constructor threw
+        public: Interface *product = nullptr;
+      };
+
+      /// \brief An allocator for std::allocate_shared which reserves storage
+      /// for a product behind the object that it allocates, so that the
+      /// product, the SharedProduct and the control block of the
+      /// std::shared_ptr live in a single allocation.
+      ///
+      /// Dev note: The allocator holds the reference to the factory. The
+      /// control block keeps a copy of it until after the storage has been
+      /// deallocated, so the factory, its product pool and its library all
+      /// outlive the product. The code of the control block belongs to the
+      /// caller of ConstructShared(), so none of it runs from the library.
+      template <typename T>
+      struct SharedProductAllocator
+      {
+        public: using value_type = T;
+
+        /// \brief Constructor
+        /// \param[in] _size The size of the product
+        /// \param[in] _alignment The alignment of the product
+        /// \param[out] _storage Receives the location of the storage for the
+        /// product when the allocation is made
+        /// \param[in] _resource The memory resource to allocate from, or
+        /// nullptr to use the heap
+        /// \param[in] _factory The reference to the factory of the product
+        public: SharedProductAllocator(
+          const std::size_t _size,
+          const std::size_t _alignment,
+          void **_storage,
+          std::pmr::memory_resource *_resource,
+          std::shared_ptr<void> _factory)
+          : size(_size),
+            alignment(std::max(_alignment, alignof(std::max_align_t))),
+            storage(_storage),
+            resource(_resource),
+            factory(std::move(_factory))
+        {
+          // Do nothing
+        }
+
+        /// \brief Rebinding constructor
+        public: template <typename U>
+        SharedProductAllocator(const SharedProductAllocator<U> &_other)
+          : size(_other.size),
+            alignment(_other.alignment),
+            storage(_other.storage),
+            resource(_other.resource),
+            factory(_other.factory)
+        {
+          // Do nothing
+        }
+
+        /// \brief Allocate the objects together with the product storage
+        public: T *allocate(const std::size_t _n)
+        {
+          const std::size_t bytes = this->Offset(_n) + this->size;
+          unsigned char *block = static_cast<unsigned char*>(this->resource ?
+                this->resource->allocate(bytes, this->alignment) :
+                ::operator new(bytes, std::align_val_t(this->alignment)));
+          *this->storage = block + this->Offset(_n);
+          return reinterpret_cast<T*>(block);
+        }
+
+        /// \brief Release an allocation made by allocate()
+        public: void deallocate(T *_p, const std::size_t _n)
+        {
+          if (this->resource)
+          {
+            this->resource->deallocate(
+                  _p, this->Offset(_n) + this->size, this->alignment);
+          }
+          else
+          {
+            ::operator delete(_p, std::align_val_t(this->alignment));
+          }
+        }
+
+        /// \brief The offset of the product storage within the allocation
+        private: std::size_t Offset(const std::size_t _n) const
+        {
+          const std::size_t bytes = _n * sizeof(T);
+          return (bytes + this->alignment - 1) / this->alignment
+              * this->alignment;
+        }
+
+        public: std::size_t size;
+        public: std::size_t alignment;
+        public: void **storage;
+        public: std::pmr::memory_resource *resource;
+        public: std::shared_ptr<void> factory;
+      };
+
+      template <typename T, typename U>
+      bool operator==(const SharedProductAllocator<T> &_lhs,
+                      const SharedProductAllocator<U> &_rhs)
+      {
+        return _lhs.size == _rhs.size && _lhs.alignment == _rhs.alignment
+            && _lhs.resource == _rhs.resource;
+      }
+
+      template <typename T, typename U>
+      bool operator!=(const SharedProductAllocator<T> &_lhs,
+                      const SharedProductAllocator<U> &_rhs)
+      {
+        return !(_lhs == _rhs);
+      }
+
+      /// \brief Cast a pointer to an interface of a product into a pointer to
+      /// the product itself. This is a static_cast whenever the interface is a
+      /// non-virtual base of the product, and a dynamic_cast when it is a
+      /// virtual base (where a static_cast is not allowed).
+      template <typename Product, typename Interface, typename = void>
+      struct DowncastProduct
+      {
+        static Product *Cast(Interface *_ptr)
+        {
+          return dynamic_cast<Product*>(_ptr);
+        }
+      };
+
+      template <typename Product, typename Interface>
+      struct DowncastProduct<Product, Interface, std::void_t<decltype(
+          static_cast<Product*>(std::declval<Interface*>()))>>
+      {
+        static Product *Cast(Interface *_ptr)
+        {
+          return static_cast<Product*>(_ptr);
+        }
+      };
     }
 
     template <typename Interface>
     class ProductDeleter
     {
+      /// \brief A function that finds the factory counter of a product whose
+      /// type is known
+      public: using CounterFunction =
+          detail::FactoryCounter *(*)(Interface *_ptr);
+
+      /// \brief Create a deleter which can delete any product. The type of
+      /// the product will be identified when it is deleted.
+      public: ProductDeleter() = default;
+
+      /// \brief Create a deleter which finds the factory counter of _product
+      /// with _counter instead of a dynamic_cast. Any other pointer is deleted
+      /// as if by a default-constructed ProductDeleter.
+      ///
+      /// The binding is forgotten the first time the deleter is invoked, or
+      /// when the product is released from its ProductPtr, so a product which
+      /// is later placed at the recycled address of _product is never cast as
+      /// if it were _product. A std::unique_ptr does not forget the binding
+      /// on release(), so give it a fresh deleter before handing it another
+      /// product with reset().
+      /// \param[in] _product The product that _counter was generated for
+      /// \param[in] _counter The function which finds the counter of _product
+      public: ProductDeleter(Interface *_product, CounterFunction _counter);
+
+      /// \brief Forget the product that this deleter was created for, if
+      /// any. Every pointer is then deleted as if by a default-constructed
+      /// ProductDeleter.
+      public: void Unbind();
+
       /// \brief This is a unary function for deleting product pointers. It
       /// keeps the factory reference alive while the product is being deleted,
       /// and then cleans up the factory reference immediately afterwards.
@@ -65,8 +365,17 @@ namespace ignition
       /// This is the recommended method for deleting product pointers.
       public: void operator()(Interface *_ptr)
       {
+        // If this is the product that the deleter was created for, then we
+        // know exactly where its counter is. Otherwise we need to look for it.
+        // Either way the binding is used up now, since the address of the
+        // product may be recycled for an unrelated product after this.
+        const CounterFunction findCounter =
+            (_ptr == this->boundProduct) ? this->boundCounter : nullptr;
+        this->Unbind();
+
         detail::FactoryCounter *counter =
-            dynamic_cast<detail::FactoryCounter*>(_ptr);
+            findCounter ? findCounter(_ptr) :
+              dynamic_cast<detail::FactoryCounter*>(_ptr);
 
         std::shared_ptr<void> factoryPluginInstancePtr;
         if (counter)
@@ -83,13 +392,272 @@ namespace ignition
 
         delete _ptr;
       }
+
+      /// \brief The product which the counter function was generated for
+      private: Interface *boundProduct = nullptr;
+
+      /// \brief A function which finds the counter of the product without
+      /// needing to look up its type at runtime
+      private: CounterFunction boundCounter = nullptr;
     };
 
+    template <typename Interface>
+    ProductDeleter<Interface>::ProductDeleter(
+        Interface *_product, CounterFunction _counter)
+      : boundProduct(_product),
+        boundCounter(_counter)
+    {
+      // Do nothing
+    }
+
+    template <typename Interface>
+    void ProductDeleter<Interface>::Unbind()
+    {
+      this->boundProduct = nullptr;
+      this->boundCounter = nullptr;
+    }
+
+    template <typename Interface>
+    ProductPtr<Interface>::ProductPtr(Base &&_other) noexcept
+      : Base(std::move(_other))
+    {
+      // Do nothing
+    }
+
+    template <typename Interface>
+    Interface *ProductPtr<Interface>::release() noexcept
+    {
+      this->get_deleter().Unbind();
+      return this->Base::release();
+    }
+
     template <typename Interface, typename... Args>
     auto Factory<Interface, Args...>::Construct(Args&&... _args)
         -> ProductPtrType
     {
-      return ProductPtrType(this->ImplConstruct(std::forward<Args>(_args)...));
+      return this->Construct(nullptr, std::forward<Args>(_args)...);
+    }
+
+    template <typename Interface, typename... Args>
+    auto Factory<Interface, Args...>::Construct(
+        std::pmr::memory_resource *_resource, Args&&... _args)
+        -> ProductPtrType
+    {
+      if (!_resource)
+        _resource = this->activePool.load(std::memory_order_acquire);
+      if (!_resource)
+        _resource = this->MemoryResourceFromThis();
+
+      detail::TraceScope trace("Construct", typeid(*this).name());
+      const auto start = std::chrono::steady_clock::now();
+      Interface *const product = this->ImplConstruct(
+            _resource, this->ProductReference(),
+            std::forward<Args>(_args)...);
+      this->statistics.RecordConstruct(
+            1, std::chrono::steady_clock::now() - start);
+
+      return ProductPtrType(
+            product, ProductDeleter<Interface>(product, this->productCounter));
+    }
+
+    template <typename Interface, typename... Args>
+    std::shared_ptr<Interface> Factory<Interface, Args...>::ConstructShared(
+        Args&&... _args)
+    {
+      return this->ConstructShared(nullptr, std::forward<Args>(_args)...);
+    }
+
+    template <typename Interface, typename... Args>
+    std::shared_ptr<Interface> Factory<Interface, Args...>::ConstructShared(
+        std::pmr::memory_resource *_resource, Args&&... _args)
+    {
+      if (!_resource)
+        _resource = this->activePool.load(std::memory_order_acquire);
+      if (!_resource)
+        _resource = this->MemoryResourceFromThis();
+
+      using Shared = detail::SharedProduct<Interface>;
+
+      detail::TraceScope trace("Construct", typeid(*this).name());
+      const auto start = std::chrono::steady_clock::now();
+      void *storage = nullptr;
+      const std::shared_ptr<Shared> shared = std::allocate_shared<Shared>(
+            detail::SharedProductAllocator<Shared>(
+              this->productSize, this->productAlignment, &storage, _resource,
+              this->ProductReference()));
+
+      // The product is constructed in place, without a reference of its own,
+      // so it is never mistaken for a lost product when it gets destroyed.
+      shared->product =
+          this->ImplConstructAt(storage, std::forward<Args>(_args)...);
+      this->statistics.RecordConstruct(
+            1, std::chrono::steady_clock::now() - start);
+
+      return std::shared_ptr<Interface>(shared, shared->product);
+    }
+
+    template <typename Interface, typename... Args>
+    auto Factory<Interface, Args...>::ConstructMany(
+        const std::size_t _count,
+        const std::remove_reference_t<Args>&... _args)
+        -> std::vector<ProductPtrType>
+    {
+      std::vector<ProductPtrType> products;
+      if (0 == _count)
+        return products;
+
+      products.reserve(_count);
+
+      const auto start = std::chrono::steady_clock::now();
+      const std::size_t footprint = detail::ProductFootprint(
+            this->productSize, this->productAlignment);
+
+      // The block takes the only reference to this factory. Each product
+      // then shares the block, so we never go back to the plugin for another
+      // reference.
+      const std::shared_ptr<detail::ProductBlock> block =
+          std::make_shared<detail::ProductBlock>(
+            footprint * _count, this->productAlignment,
+            this->PluginInstancePtrFromThis());
+
+      for (std::size_t i = 0; i < _count; ++i)
+      {
+        // Every product gets its own copy of the arguments
+        std::tuple<std::decay_t<Args>...> arguments(_args...);
+        Interface *const product = std::apply(
+              [&](auto&... _copies)
+              {
+                return this->ImplConstruct(
+                      block.get(), block, static_cast<Args&&>(_copies)...);
+              }, arguments);
+
+        products.emplace_back(
+              product,
+              ProductDeleter<Interface>(product, this->productCounter));
+      }
+
+      this->statistics.RecordConstruct(
+            _count, std::chrono::steady_clock::now() - start);
+
+      return products;
+    }
+
+    template <typename Interface, typename... Args>
+    Interface *Factory<Interface, Args...>::ConstructAt(
+        void *_storage, Args&&... _args)
+    {
+      if (!_storage ||
+          0 != reinterpret_cast<std::uintptr_t>(_storage)
+                 % this->productAlignment)
+      {
+        return nullptr;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      Interface *const product =
+          this->ImplConstructAt(_storage, std::forward<Args>(_args)...);
+      this->statistics.RecordConstruct(
+            1, std::chrono::steady_clock::now() - start);
+
+      return product;
+    }
+
+    template <typename Interface, typename... Args>
+    FactoryStatistics Factory<Interface, Args...>::Statistics() const
+    {
+      return this->statistics.Snapshot();
+    }
+
+    template <typename Interface, typename... Args>
+    void Factory<Interface, Args...>::DestroyAt(Interface *_product)
+    {
+      if (_product)
+        _product->~Interface();
+    }
+
+    template <typename Interface, typename... Args>
+    std::size_t Factory<Interface, Args...>::ProductSize() const
+    {
+      return this->productSize;
+    }
+
+    template <typename Interface, typename... Args>
+    std::size_t Factory<Interface, Args...>::ProductAlignment() const
+    {
+      return this->productAlignment;
+    }
+
+    template <typename Interface, typename... Args>
+    void Factory<Interface, Args...>::UseProductPool(const bool _use)
+    {
+      std::unique_lock<std::mutex> lock(this->productPoolMutex);
+      if (_use && !this->productPool)
+      {
+        // The pool gets its chunks from the memory resource of the library,
+        // if there is one, so that they count towards the library.
+        std::pmr::memory_resource *const upstream =
+            this->MemoryResourceFromThis();
+        this->productPool =
+            std::make_unique<std::pmr::synchronized_pool_resource>(
+              upstream ? upstream : std::pmr::get_default_resource());
+      }
+
+      // The pool itself is never destroyed before the factory, because
+      // products which were constructed in it might still be alive.
+      this->activePool.store(
+            _use ? this->productPool.get() : nullptr,
+            std::memory_order_release);
+    }
+
+    template <typename Interface, typename... Args>
+    bool Factory<Interface, Args...>::UsesProductPool() const
+    {
+      return nullptr != this->activePool.load(std::memory_order_acquire);
+    }
+
+    template <typename Interface, typename... Args>
+    void Factory<Interface, Args...>::ShareProductReferences(const bool _use)
+    {
+      std::unique_lock<std::mutex> lock(this->productPoolMutex);
+      if (_use && !this->referenceShards)
+      {
+        this->referenceShards =
+            std::make_unique<detail::ProductReferenceShards>();
+      }
+
+      // Products which were constructed while sharing was on keep holding
+      // their shared references, so the shards stay with the factory.
+      this->activeShards.store(
+            _use ? this->referenceShards.get() : nullptr,
+            std::memory_order_release);
+    }
+
+    template <typename Interface, typename... Args>
+    bool Factory<Interface, Args...>::SharesProductReferences() const
+    {
+      return nullptr != this->activeShards.load(std::memory_order_acquire);
+    }
+
+    template <typename Interface, typename... Args>
+    std::shared_ptr<void> Factory<Interface, Args...>::ProductReference()
+    {
+      detail::ProductReferenceShards *const shards =
+          this->activeShards.load(std::memory_order_acquire);
+
+      if (!shards)
+        return this->PluginInstancePtrFromThis();
+
+      std::shared_ptr<void> reference = shards->Acquire();
+      if (reference)
+        return reference;
+
+      // This shard has no products alive, so it needs to take a reference to
+      // the plugin.
+      std::shared_ptr<void> plugin = this->PluginInstancePtrFromThis();
+      if (!plugin)
+        return nullptr;
+
+      return shards->Install(std::move(plugin));
     }
 
     /// \brief Producing provides the implementation of Factory for a specific
@@ -116,8 +684,9 @@ namespace ignition
       /// lostProductManager and the time that the call stack leaves the
       /// destructor of this symbol entirely. This makes it less risky to call
       /// CleanupLostProducts() in a multi-threaded application. Combined with
-      /// giving CleanupLostProducts() a brief waiting period, this should allow
-      /// even completely reckless multi-threaded applications to be able to
+      /// deleting the products inside an EpochGuard, or giving
+      /// CleanupLostProducts() a brief waiting period, this should allow even
+      /// completely reckless multi-threaded applications to be able to
       /// cleanup its lost products safely.
       class ProductWithFactoryCounter
           : public detail::FactoryCounter,
@@ -129,15 +698,87 @@ namespace ignition
         {
           // Do nothing
         }
+
+        /// \brief Allocate a product from the heap
+        public: static void *operator new(std::size_t _size)
+        {
+          return detail::AllocateProduct(
+                _size, alignof(ProductWithFactoryCounter), nullptr);
+        }
+
+        /// \brief Allocate a product from a memory resource
+        public: static void *operator new(
+          std::size_t _size, std::pmr::memory_resource *_resource)
+        {
+          return detail::AllocateProduct(
+                _size, alignof(ProductWithFactoryCounter), _resource);
+        }
+
+        /// \brief Return the storage of a product to wherever it came from.
+        /// Since this is used by the destructor, it also does the right thing
+        /// for products which are deleted without a ProductDeleter.
+        public: static void operator delete(void *_ptr)
+        {
+          detail::DeallocateProduct(_ptr);
+        }
+
+        /// \brief Return the storage of a product whose constructor threw
+        public: static void operator delete(
+          void *_ptr, std::pmr::memory_resource * /*_resource*/)
+        {
+          detail::DeallocateProduct(_ptr);
+        }
       };
 
+      /// \brief Default constructor
+      public: Producing()
+      {
+        this->productCounter = &Producing::ProductCounter;
+        this->productSize = sizeof(ProductWithFactoryCounter);
+        this->productAlignment = alignof(ProductWithFactoryCounter);
+      }
+
+      /// \brief Find the counter of a product of this factory without looking
+      /// up its type at runtime.
+      ///
+      /// Dev note: This only finds the counter and leaves the deletion to
+      /// ProductDeleter. This function is a symbol of the plugin library, so
+      /// the factory reference must not be released until the call stack has
+      /// left it.
+      /// \param[in] _ptr A product which was created by ImplConstruct
+      /// \return The counter of the product
+      private: static detail::FactoryCounter *ProductCounter(Interface *_ptr)
+      {
+        return detail::DowncastProduct<ProductWithFactoryCounter, Interface>
+            ::Cast(_ptr);
+      }
+
+      // Documentation inherited
+      private: Interface *ImplConstruct(
+        std::pmr::memory_resource *_resource,
+        std::shared_ptr<void> _factory,
+        Args&&... _args) override
+      {
+        auto *product = new (_resource)
+            ProductWithFactoryCounter(std::forward<Args>(_args)...);
+
+        product->factoryPluginInstancePtr = std::move(_factory);
+        product->statistics = &this->statistics;
+
+        return product;
+      }
+
       // Documentation inherited
-      private: Interface *ImplConstruct(Args&&... _args) override
+      private: Interface *ImplConstructAt(
+        void *_storage, Args&&... _args) override
       {
-        auto *product =
-            new ProductWithFactoryCounter(std::forward<Args>(_args)...);
+        // The product is left without a factory reference, because the
+        // caller keeps the factory alive. That also means its FactoryCounter
+        // will not treat it as lost when it gets destroyed.
+        auto *product = ::new (_storage)
+            ProductWithFactoryCounter(std::forward<Args>(_args)...);
 
-        product->factoryPluginInstancePtr = this->PluginInstancePtrFromThis();
+        product->statistics = &this->statistics;
 
         return product;
       }
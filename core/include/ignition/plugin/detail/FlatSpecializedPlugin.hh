@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_DETAIL_FLATSPECIALIZEDPLUGIN_HH_
+#define IGNITION_PLUGIN_DETAIL_FLATSPECIALIZEDPLUGIN_HH_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+
+#include "ignition/plugin/FlatSpecializedPlugin.hh"
+#include "ignition/plugin/utility.hh"
+
+#ifdef IGNITION_UNITTEST_SPECIALIZED_PLUGIN_ACCESS
+// The unit test flag, usedSpecializedInterfaceAccess, is defined here
+#include "ignition/plugin/SpecializedPlugin.hh"
+#endif
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      /// \brief The IDs and mangled names of a list of interfaces, in the
+      /// order in which they are listed
+      template <class... Interfaces>
+      struct InterfaceSlotKeys
+      {
+        /// \brief Get the IDs of the interfaces
+        static const std::uint64_t *Ids()
+        {
+          static constexpr std::array<std::uint64_t, sizeof...(Interfaces)>
+              ids = {{InterfaceId<Interfaces>()...}};
+          return ids.data();
+        }
+
+        /// \brief Get the mangled names of the interfaces
+        static const std::string_view *Names()
+        {
+          static const std::array<std::string_view, sizeof...(Interfaces)>
+              names = {{std::string_view(typeid(Interfaces).name())...}};
+          return names.data();
+        }
+      };
+    }
+
+    /////////////////////////////////////////////////
+    template <class... SpecInterfaces>
+    template <class Interface>
+    constexpr std::size_t FlatSpecializedPlugin<SpecInterfaces...>::SlotOf()
+    {
+      constexpr bool matches[] =
+          {std::is_same<Interface, SpecInterfaces>::value..., false};
+
+      for (std::size_t i = 0; i < SlotCount; ++i)
+      {
+        if (matches[i])
+          return i;
+      }
+
+      return SlotCount;
+    }
+
+    /////////////////////////////////////////////////
+    template <class... SpecInterfaces>
+    template <class Interface>
+    Interface *FlatSpecializedPlugin<SpecInterfaces...>::QueryInterface()
+    {
+      constexpr std::size_t slot = SlotOf<Interface>();
+      if constexpr (slot < SlotCount)
+      {
+        #ifdef IGNITION_UNITTEST_SPECIALIZED_PLUGIN_ACCESS
+        usedSpecializedInterfaceAccess = true;
+        #endif
+        return static_cast<Interface*>(this->slots[slot]);
+      }
+      else
+      {
+        return this->Plugin::QueryInterface<Interface>();
+      }
+    }
+
+    /////////////////////////////////////////////////
+    template <class... SpecInterfaces>
+    template <class Interface>
+    const Interface *FlatSpecializedPlugin<SpecInterfaces...>::QueryInterface()
+    const
+    {
+      constexpr std::size_t slot = SlotOf<Interface>();
+      if constexpr (slot < SlotCount)
+      {
+        #ifdef IGNITION_UNITTEST_SPECIALIZED_PLUGIN_ACCESS
+        usedSpecializedInterfaceAccess = true;
+        #endif
+        return static_cast<const Interface*>(this->slots[slot]);
+      }
+      else
+      {
+        return this->Plugin::QueryInterface<Interface>();
+      }
+    }
+
+    /////////////////////////////////////////////////
+    template <class... SpecInterfaces>
+    template <class Interface>
+    std::shared_ptr<Interface>
+    FlatSpecializedPlugin<SpecInterfaces...>::QueryInterfaceSharedPtr()
+    {
+      Interface *ptr = this->QueryInterface<Interface>();
+      if (ptr)
+        return std::shared_ptr<Interface>(this->PrivateGetInstancePtr(), ptr);
+
+      return nullptr;
+    }
+
+    /////////////////////////////////////////////////
+    template <class... SpecInterfaces>
+    template <class Interface>
+    std::shared_ptr<const Interface>
+    FlatSpecializedPlugin<SpecInterfaces...>::QueryInterfaceSharedPtr() const
+    {
+      const Interface *ptr = this->QueryInterface<Interface>();
+      if (ptr)
+      {
+        return std::shared_ptr<const Interface>(
+              this->PrivateGetInstancePtr(), ptr);
+      }
+
+      return nullptr;
+    }
+
+    /////////////////////////////////////////////////
+    template <class... SpecInterfaces>
+    template <class Interface>
+    bool FlatSpecializedPlugin<SpecInterfaces...>::HasInterface() const
+    {
+      constexpr std::size_t slot = SlotOf<Interface>();
+      if constexpr (slot < SlotCount)
+      {
+        #ifdef IGNITION_UNITTEST_SPECIALIZED_PLUGIN_ACCESS
+        usedSpecializedInterfaceAccess = true;
+        #endif
+        return (nullptr != this->slots[slot]);
+      }
+      else
+      {
+        return this->Plugin::HasInterface<Interface>();
+      }
+    }
+
+    /////////////////////////////////////////////////
+    template <class... SpecInterfaces>
+    FlatSpecializedPlugin<SpecInterfaces...>::FlatSpecializedPlugin()
+      : slots()
+    {
+      using Keys = detail::InterfaceSlotKeys<SpecInterfaces...>;
+      this->PrivateSetInterfaceSlots(
+            this->slots.data(), Keys::Ids(), Keys::Names(), SlotCount);
+    }
+
+    /////////////////////////////////////////////////
+    template <class... SpecInterfaces>
+    FlatSpecializedPlugin<SpecInterfaces...>::~FlatSpecializedPlugin()
+    {
+      // The slots are about to be destroyed, so the Plugin must stop updating
+      // them.
+      this->PrivateSetInterfaceSlots(nullptr, nullptr, nullptr, 0);
+    }
+  }
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include <memory>
 #include <string>
 #include <ignition/plugin/Plugin.hh>
+#include <ignition/plugin/utility.hh>
 
 namespace ignition
 {
@@ -32,7 +33,8 @@ namespace ignition
     Interface *Plugin::QueryInterface()
     {
       return static_cast<Interface*>(
-            this->PrivateQueryInterface(typeid(Interface).name()));
+            this->PrivateQueryInterface(
+              InterfaceId<Interface>(), typeid(Interface).name()));
     }
 
     //////////////////////////////////////////////////
@@ -40,7 +42,8 @@ namespace ignition
     const Interface *Plugin::QueryInterface() const
     {
       return static_cast<const Interface*>(
-            this->PrivateQueryInterface(typeid(Interface).name()));
+            this->PrivateQueryInterface(
+              InterfaceId<Interface>(), typeid(Interface).name()));
     }
 
     //////////////////////////////////////////////////
@@ -99,11 +102,37 @@ namespace ignition
       return this->template QueryInterfaceSharedPtr<Interface>();
     }
 
+    //////////////////////////////////////////////////
+    template <class Interface>
+    InterfaceRef<Interface> Plugin::QueryInterfaceRef()
+    {
+      Interface *ptr = this->Plugin::QueryInterface<Interface>();
+      if (ptr)
+        return InterfaceRef<Interface>(ptr, this->PrivateGetInstancePtr());
+
+      return InterfaceRef<Interface>();
+    }
+
+    //////////////////////////////////////////////////
+    template <class Interface>
+    InterfaceRef<const Interface> Plugin::QueryInterfaceRef() const
+    {
+      const Interface *ptr = this->Plugin::QueryInterface<Interface>();
+      if (ptr)
+      {
+        return InterfaceRef<const Interface>(
+              ptr, this->PrivateGetInstancePtr());
+      }
+
+      return InterfaceRef<const Interface>();
+    }
+
     //////////////////////////////////////////////////
     template <class Interface>
     bool Plugin::HasInterface() const
     {
-      return this->HasInterface(typeid(Interface).name(), false);
+      return nullptr != this->PrivateQueryInterface(
+            InterfaceId<Interface>(), typeid(Interface).name());
     }
   }
 }
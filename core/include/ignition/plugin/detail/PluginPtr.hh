@@ -20,6 +20,7 @@
 #define IGNITION_PLUGIN_DETAIL_PLUGINPTR_HH_
 
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <ignition/plugin/PluginPtr.hh>
 #include <ignition/plugin/utility.hh>
@@ -28,10 +29,21 @@ namespace ignition
 {
   namespace plugin
   {
+    namespace detail
+    {
+      /// \brief The constructors of the plugin wrappers are protected. This
+      /// gives std::make_shared access to them, so that a wrapper can share
+      /// an allocation with its reference count.
+      template <typename PluginType>
+      struct SharedPluginWrapper final : public std::remove_const_t<PluginType>
+      {
+      };
+    }
+
     //////////////////////////////////////////////////
     template <typename PluginType>
     TemplatePluginPtr<PluginType>::TemplatePluginPtr()
-      : dataPtr(new PluginType)
+      : dataPtr(PrivateEmptyWrapper())
     {
       // Do nothing
     }
@@ -40,9 +52,9 @@ namespace ignition
     template <typename PluginType>
     TemplatePluginPtr<PluginType>::TemplatePluginPtr(
         const TemplatePluginPtr &_other)
-      : dataPtr(new PluginType)
+      : dataPtr(_other.dataPtr)
     {
-      this->dataPtr->PrivateCopyPluginInstance(*_other.dataPtr);
+      // Do nothing
     }
 
     //////////////////////////////////////////////////
@@ -52,7 +64,7 @@ namespace ignition
     template <typename OtherPluginType>
     TemplatePluginPtr<PluginType>::TemplatePluginPtr(
         const TemplatePluginPtr<OtherPluginType> &_other)
-      : dataPtr(new PluginType)
+      : dataPtr(PrivateMakeWrapper())
     {
       static_assert(ConstCompatible<PluginType, OtherPluginType>::value,
                 "The requested PluginPtr cast would discard const qualifiers");
@@ -64,7 +76,7 @@ namespace ignition
     TemplatePluginPtr<PluginType>& TemplatePluginPtr<PluginType>::operator =(
         const TemplatePluginPtr &_other)
     {
-      this->dataPtr->PrivateCopyPluginInstance(*_other.dataPtr);
+      this->dataPtr = _other.dataPtr;
       return *this;
     }
 
@@ -76,25 +88,29 @@ namespace ignition
     {
       static_assert(ConstCompatible<PluginType, OtherPluginType>::value,
                 "The requested PluginPtr cast would discard const qualifiers");
-      this->dataPtr->PrivateCopyPluginInstance(*_other.dataPtr);
+      this->PrivateUniqueWrapper().PrivateCopyPluginInstance(*_other.dataPtr);
       return *this;
     }
 
     //////////////////////////////////////////////////
     template <typename PluginType>
     TemplatePluginPtr<PluginType>::TemplatePluginPtr(
-        TemplatePluginPtr &&_other)
+        TemplatePluginPtr &&_other) noexcept
       : dataPtr(std::move(_other.dataPtr))
     {
-      // Do nothing
+      _other.dataPtr = PrivateEmptyWrapper();
     }
 
     //////////////////////////////////////////////////
     template <typename PluginType>
     TemplatePluginPtr<PluginType>& TemplatePluginPtr<PluginType>::operator =(
-        TemplatePluginPtr &&_other)
+        TemplatePluginPtr &&_other) noexcept
     {
-      this->dataPtr = std::move(_other.dataPtr);
+      if (this != &_other)
+      {
+        this->dataPtr = std::move(_other.dataPtr);
+        _other.dataPtr = PrivateEmptyWrapper();
+      }
       return *this;
     }
 
@@ -160,21 +176,74 @@ namespace ignition
       return !this->IsEmpty();
     }
 
+    //////////////////////////////////////////////////
+    template <typename PluginType>
+    template <class Interface>
+    auto TemplatePluginPtr<PluginType>::Borrow() const &
+        -> Borrowed<Interface>
+    {
+      return Borrowed<Interface>(
+            this->dataPtr->template QueryInterface<Interface>(),
+            this, &TemplatePluginPtr::PrivateInstanceOf);
+    }
+
+    //////////////////////////////////////////////////
+    template <typename PluginType>
+    const void *TemplatePluginPtr<PluginType>::PrivateInstanceOf(
+        const void *_self)
+    {
+      return static_cast<const TemplatePluginPtr*>(_self)
+          ->dataPtr->PrivateGetInstancePtr().get();
+    }
+
     //////////////////////////////////////////////////
     template <typename PluginType>
     void TemplatePluginPtr<PluginType>::Clear()
     {
-      this->dataPtr->PrivateCreatePluginInstance(nullptr, nullptr);
+      this->dataPtr = PrivateEmptyWrapper();
+    }
+
+    //////////////////////////////////////////////////
+    template <typename PluginType>
+    std::shared_ptr<PluginType> TemplatePluginPtr<PluginType>::
+    PrivateMakeWrapper()
+    {
+      return std::make_shared<detail::SharedPluginWrapper<PluginType>>();
+    }
+
+    //////////////////////////////////////////////////
+    template <typename PluginType>
+    const std::shared_ptr<PluginType> &TemplatePluginPtr<PluginType>::
+    PrivateEmptyWrapper()
+    {
+      // This wrapper is always shared with this static reference, so
+      // PrivateUniqueWrapper() will never change it.
+      static const std::shared_ptr<PluginType> empty = PrivateMakeWrapper();
+      return empty;
+    }
+
+    //////////////////////////////////////////////////
+    template <typename PluginType>
+    PluginType &TemplatePluginPtr<PluginType>::PrivateUniqueWrapper()
+    {
+      // The wrapper may only be changed while no other PluginPtr shares it. If
+      // this PluginPtr is the only owner, then no other thread can be copying
+      // the wrapper right now, so it is safe to reuse it.
+      if (this->dataPtr.use_count() > 1)
+        this->dataPtr = PrivateMakeWrapper();
+
+      return *this->dataPtr;
     }
 
     //////////////////////////////////////////////////
     template <typename PluginType>
     TemplatePluginPtr<PluginType>::TemplatePluginPtr(
         const ConstInfoPtr &_info,
-        const std::shared_ptr<void> &_dlHandlePtr)
-      : dataPtr(new PluginType)
+        const std::shared_ptr<void> &_dlHandlePtr,
+        std::pmr::memory_resource *_resource)
+      : dataPtr(PrivateMakeWrapper())
     {
-      dataPtr->PrivateCreatePluginInstance(_info, _dlHandlePtr);
+      dataPtr->PrivateCreatePluginInstance(_info, _dlHandlePtr, _resource);
     }
   }
 }
@@ -109,7 +109,7 @@ namespace ignition
       usedSpecializedInterfaceAccess = true;
       #endif
       return static_cast<SpecInterface*>(
-            this->privateSpecializedInterfaceIterator->second);
+            this->privateSpecializedInterfaceSlot.location);
     }
 
     /////////////////////////////////////////////////
@@ -130,7 +130,7 @@ namespace ignition
       usedSpecializedInterfaceAccess = true;
       #endif
       return static_cast<SpecInterface*>(
-            this->privateSpecializedInterfaceIterator->second);
+            this->privateSpecializedInterfaceSlot.location);
     }
 
     /////////////////////////////////////////////////
@@ -150,17 +150,17 @@ namespace ignition
       #ifdef IGNITION_UNITTEST_SPECIALIZED_PLUGIN_ACCESS
       usedSpecializedInterfaceAccess = true;
       #endif
-      return (nullptr != this->privateSpecializedInterfaceIterator->second);
+      return (nullptr != this->privateSpecializedInterfaceSlot.location);
     }
 
     /////////////////////////////////////////////////
     template <class SpecInterface>
     SpecializedPlugin<SpecInterface>::SpecializedPlugin()
-      : privateSpecializedInterfaceIterator(
-          this->PrivateGetOrCreateIterator(
-            typeid(SpecInterface).name()))
+      : privateSpecializedInterfaceSlot{
+          nullptr, InterfaceId<SpecInterface>(),
+          typeid(SpecInterface).name(), nullptr}
     {
-      // Do nothing
+      this->PrivateAddInterfaceSlot(&this->privateSpecializedInterfaceSlot);
     }
 
     namespace detail
@@ -19,8 +19,10 @@
 #ifndef IGNITION_PLUGIN_DETAIL_UTILITY_HH_
 #define IGNITION_PLUGIN_DETAIL_UTILITY_HH_
 
-
+#include <cstdint>
+#include <string_view>
 #include <type_traits>
+#include <typeinfo>
 
 namespace ignition
 {
@@ -40,6 +42,25 @@ namespace ignition
           : std::integral_constant<bool, std::is_const<To>::value>
       {
       };
+
+      //////////////////////////////////////////////////
+      /// \brief Compute the 64-bit FNV-1a hash of an interface name. This is
+      /// deterministic, so every library that refers to an interface computes
+      /// the same hash for it, even if their copies of its std::type_info are
+      /// distinct objects.
+      /// \param[in] _name The (mangled) name of the interface
+      /// \return The hash of the name
+      constexpr std::uint64_t HashInterfaceName(std::string_view _name)
+      {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const char c : _name)
+        {
+          hash ^= static_cast<unsigned char>(c);
+          hash *= 1099511628211ull;
+        }
+
+        return hash;
+      }
     }
   }
 }
@@ -58,6 +58,18 @@ namespace ignition
     /// \return The demangled (human-readable) version of the symbol name
     std::string IGNITION_PLUGIN_VISIBLE DemangleSymbol(
         const std::string &_symbol);
+
+    /////////////////////////////////////////////////
+    /// \brief Like DemangleSymbol(), but the result is remembered in a
+    /// process-wide cache, so each symbol only gets demangled once. It is
+    /// safe to call this from several threads at once. Unlike
+    /// DemangleSymbol(), a symbol that cannot be demangled is not reported;
+    /// it is returned as it was passed in.
+    /// \param[in] _symbol
+    ///   Pass in the result of typeid(T).name()
+    /// \return The demangled (human-readable) version of the symbol name
+    std::string IGNITION_PLUGIN_VISIBLE CachedDemangleSymbol(
+        const std::string &_symbol);
   }
 }
 
@@ -0,0 +1,495 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/plugin/CallProfile.hh>
+#include <ignition/plugin/utility.hh>
+
+#include "ProxyRegistry.hh"
+
+namespace
+{
+  using ignition::plugin::MethodProfile;
+
+  /// \brief The counters of one profiling site in the buffer of a thread.
+  /// Only the thread writes to them, so they are updated without
+  /// read-modify-write instructions; they are atomic so that CallProfile()
+  /// can read them at any time.
+  struct Counters
+  {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> totalNanoseconds{0};
+    std::atomic<std::uint64_t> maxNanoseconds{0};
+    std::array<std::atomic<std::uint64_t>, MethodProfile::BucketCount>
+        histogram{};
+  };
+
+  /// \brief The number of sites per chunk of a buffer
+  constexpr std::size_t kChunkSize = 256;
+
+  /// \brief The number of chunks of a buffer, which limits the number of
+  /// profiling sites
+  constexpr std::size_t kChunks = 256;
+
+  /// \brief The counters of one thread. They are allocated in chunks as the
+  /// thread reaches new sites, so that the chunks never move while other
+  /// threads read them.
+  struct ThreadBuffer
+  {
+    /// \brief Destructor
+    ~ThreadBuffer()
+    {
+      for (std::atomic<Counters*> &chunk : this->chunks)
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    /// \brief Add a call
+    /// \param[in] _site The profiling site
+    /// \param[in] _nanoseconds How long the call took
+    void Add(const std::size_t _site, const std::uint64_t _nanoseconds)
+    {
+      std::atomic<Counters*> &slot = this->chunks[_site / kChunkSize];
+      Counters *chunk = slot.load(std::memory_order_relaxed);
+      if (!chunk)
+      {
+        chunk = new Counters[kChunkSize];
+        slot.store(chunk, std::memory_order_release);
+      }
+
+      Counters &counters = chunk[_site % kChunkSize];
+      const auto bump = [](std::atomic<std::uint64_t> &_counter,
+                           const std::uint64_t _amount)
+      {
+        _counter.store(_counter.load(std::memory_order_relaxed) + _amount,
+                       std::memory_order_relaxed);
+      };
+
+      bump(counters.calls, 1);
+      bump(counters.totalNanoseconds, _nanoseconds);
+      if (_nanoseconds > counters.maxNanoseconds.load(
+            std::memory_order_relaxed))
+      {
+        counters.maxNanoseconds.store(_nanoseconds, std::memory_order_relaxed);
+      }
+
+      std::size_t bucket = 0;
+      for (std::uint64_t rest = _nanoseconds; rest > 0; rest >>= 1)
+        ++bucket;
+      bump(counters.histogram[
+            std::min(bucket, MethodProfile::BucketCount - 1)], 1);
+    }
+
+    /// \brief Zero every counter. Only the thread of the buffer does this.
+    void Clear()
+    {
+      for (std::atomic<Counters*> &slot : this->chunks)
+      {
+        Counters *const chunk = slot.load(std::memory_order_relaxed);
+        if (!chunk)
+          continue;
+
+        for (std::size_t i = 0; i < kChunkSize; ++i)
+        {
+          chunk[i].calls.store(0, std::memory_order_relaxed);
+          chunk[i].totalNanoseconds.store(0, std::memory_order_relaxed);
+          chunk[i].maxNanoseconds.store(0, std::memory_order_relaxed);
+          for (std::atomic<std::uint64_t> &count : chunk[i].histogram)
+            count.store(0, std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// \brief Add the counters of this buffer to a profile
+    /// \param[in,out] _profile The profile, indexed by profiling site
+    void CollectInto(std::vector<MethodProfile> &_profile) const
+    {
+      for (std::size_t c = 0; c < kChunks; ++c)
+      {
+        const Counters *const chunk =
+            this->chunks[c].load(std::memory_order_acquire);
+        if (!chunk)
+          continue;
+
+        for (std::size_t i = 0; i < kChunkSize; ++i)
+        {
+          const std::size_t site = c * kChunkSize + i;
+          if (site >= _profile.size())
+            return;
+
+          const Counters &counters = chunk[i];
+          MethodProfile &method = _profile[site];
+          method.calls += counters.calls.load(std::memory_order_relaxed);
+          method.totalNanoseconds +=
+              counters.totalNanoseconds.load(std::memory_order_relaxed);
+          method.maxNanoseconds = std::max(
+                method.maxNanoseconds,
+                counters.maxNanoseconds.load(std::memory_order_relaxed));
+          for (std::size_t b = 0; b < MethodProfile::BucketCount; ++b)
+          {
+            method.histogram[b] +=
+                counters.histogram[b].load(std::memory_order_relaxed);
+          }
+        }
+      }
+    }
+
+    /// \brief The chunks of counters, or nullptr for the chunks which the
+    /// thread has not needed yet
+    std::array<std::atomic<Counters*>, kChunks> chunks{};
+
+    /// \brief The generation of the profile that the counters belong to, see
+    /// Profiler::generation. Only the thread of the buffer changes it, after
+    /// it has cleared the counters.
+    std::atomic<std::uint64_t> generation{0};
+  };
+
+  /// \brief A proxy which has been registered
+  struct Proxy
+  {
+    /// \brief The demangled name of the interface
+    std::string interface;
+
+    /// \brief The names of the methods
+    std::vector<std::string> methods;
+
+    /// \brief Creates the proxy
+    ignition::plugin::detail::ProxyFactory factory = nullptr;
+  };
+
+  /// \brief The state of the profiling of the process. It is never
+  /// destroyed, so that threads can still hand in their counters while the
+  /// program exits.
+  class Profiler
+  {
+    /// \brief Get the profiler
+    /// \return The profiler
+    public: static Profiler &Get()
+    {
+      static Profiler *profiler = new Profiler;
+      return *profiler;
+    }
+
+    /// \brief Get the profiling site of a method, adding it if it is new
+    /// \param[in] _plugin The name of the plugin
+    /// \param[in] _interface The demangled name of the interface
+    /// \param[in] _method The name of the method
+    /// \return The site. This expects `mutex` to be locked.
+    public: std::size_t Site(const std::string &_plugin,
+                             const std::string &_interface,
+                             const std::string &_method)
+    {
+      const auto inserted = this->siteIds.emplace(
+            std::make_tuple(_plugin, _interface, _method),
+            this->sites.size());
+      if (inserted.second)
+      {
+        MethodProfile site;
+        site.plugin = _plugin;
+        site.interface = _interface;
+        site.method = _method;
+        this->sites.push_back(std::move(site));
+        this->retired.emplace_back();
+      }
+
+      return inserted.first->second;
+    }
+
+    /// \brief Hand in the counters of a thread which exits
+    /// \param[in] _buffer The buffer of the thread
+    public: void Retire(ThreadBuffer *_buffer)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (_buffer->generation.load(std::memory_order_relaxed) ==
+          this->generation.load(std::memory_order_relaxed))
+      {
+        _buffer->CollectInto(this->retired);
+      }
+
+      this->threads.erase(
+            std::remove(this->threads.begin(), this->threads.end(), _buffer),
+            this->threads.end());
+      delete _buffer;
+    }
+
+    /// \brief Guards every member except for the atomic ones
+    public: std::mutex mutex;
+
+    /// \brief The registered proxies, keyed by the mangled names of their
+    /// interfaces
+    public: std::unordered_map<std::string, Proxy> proxies;
+
+    /// \brief The number of entries in `proxies`, which can be read without
+    /// locking `mutex`
+    public: std::atomic<std::size_t> proxyCount{0};
+
+    /// \brief The sites, keyed by plugin, interface and method
+    public: std::map<std::tuple<std::string, std::string, std::string>,
+                     std::size_t> siteIds;
+
+    /// \brief The names of each site, with empty counters
+    public: std::vector<MethodProfile> sites;
+
+    /// \brief The counters of the threads which have exited, by site
+    public: std::vector<MethodProfile> retired;
+
+    /// \brief The buffers of the threads which have profiled calls
+    public: std::vector<ThreadBuffer*> threads;
+
+    /// \brief Incremented by ResetCallProfile(). Buffers of an older
+    /// generation are left out of the profile, and cleared by their threads
+    /// before they count the next call.
+    public: std::atomic<std::uint64_t> generation{0};
+
+    /// \brief The length of a tick of ProfileTicks() in nanoseconds
+    public: std::atomic<double> nanosecondsPerTick{1.0};
+
+    /// \brief Makes sure that the clock is only calibrated once
+    public: std::once_flag calibrated;
+  };
+
+  /// \brief The buffer of the current thread, which it hands in when it
+  /// exits
+  struct ThreadSlot
+  {
+    ~ThreadSlot()
+    {
+      if (this->buffer)
+        Profiler::Get().Retire(this->buffer);
+    }
+
+    ThreadBuffer *buffer = nullptr;
+  };
+
+  thread_local ThreadSlot threadSlot;
+
+  /////////////////////////////////////////////////
+  /// \brief Measure the length of a tick of ProfileTicks()
+  /// \return The length of a tick in nanoseconds
+  double CalibrateTicks()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point startTime = Clock::now();
+    const std::uint64_t startTicks = ignition::plugin::detail::ProfileTicks();
+
+    Clock::time_point endTime = startTime;
+    while (endTime - startTime < std::chrono::milliseconds(2))
+      endTime = Clock::now();
+    const std::uint64_t endTicks = ignition::plugin::detail::ProfileTicks();
+
+    if (endTicks <= startTicks)
+      return 1.0;
+
+    return static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            endTime - startTime).count()) /
+        static_cast<double>(endTicks - startTicks);
+#else
+    return 1.0;
+#endif
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      std::atomic<bool> callProfiling{false};
+
+      /////////////////////////////////////////////////
+      void RegisterProxy(const char *_interface,
+                         std::vector<std::string> _methods,
+                         const ProxyFactory _factory)
+      {
+        Profiler &profiler = Profiler::Get();
+        std::lock_guard<std::mutex> lock(profiler.mutex);
+        profiler.proxies[_interface] =
+            Proxy{DemangleSymbol(_interface), std::move(_methods), _factory};
+        profiler.proxyCount.store(profiler.proxies.size());
+      }
+
+      /////////////////////////////////////////////////
+      void UnregisterProxy(const char *_interface,
+                           const ProxyFactory _factory)
+      {
+        Profiler &profiler = Profiler::Get();
+        std::lock_guard<std::mutex> lock(profiler.mutex);
+        const auto it = profiler.proxies.find(_interface);
+        if (profiler.proxies.end() != it && it->second.factory == _factory)
+          profiler.proxies.erase(it);
+        profiler.proxyCount.store(profiler.proxies.size());
+      }
+
+      /////////////////////////////////////////////////
+      void RecordCall(const std::size_t _site, const std::uint64_t _ticks)
+      {
+        if (_site >= kChunks * kChunkSize)
+          return;
+
+        Profiler &profiler = Profiler::Get();
+        ThreadBuffer *buffer = threadSlot.buffer;
+        if (!buffer)
+        {
+          buffer = new ThreadBuffer;
+          buffer->generation.store(
+                profiler.generation.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+
+          std::lock_guard<std::mutex> lock(profiler.mutex);
+          profiler.threads.push_back(buffer);
+          threadSlot.buffer = buffer;
+        }
+
+        const std::uint64_t generation =
+            profiler.generation.load(std::memory_order_acquire);
+        if (buffer->generation.load(std::memory_order_relaxed) != generation)
+        {
+          buffer->Clear();
+          buffer->generation.store(generation, std::memory_order_release);
+        }
+
+        buffer->Add(_site, static_cast<std::uint64_t>(
+              static_cast<double>(_ticks) *
+              profiler.nanosecondsPerTick.load(std::memory_order_relaxed)));
+      }
+
+      /////////////////////////////////////////////////
+      bool ProfileNewInstances()
+      {
+        return callProfiling.load(std::memory_order_relaxed) &&
+            Profiler::Get().proxyCount.load(std::memory_order_relaxed) > 0;
+      }
+
+      /////////////////////////////////////////////////
+      std::shared_ptr<void> MakeProxy(
+          const std::string &_plugin,
+          std::string_view _interface,
+          void *_target)
+      {
+        Profiler &profiler = Profiler::Get();
+        ProxyFactory factory = nullptr;
+        std::vector<std::size_t> sites;
+        {
+          std::lock_guard<std::mutex> lock(profiler.mutex);
+          const auto it = profiler.proxies.find(std::string(_interface));
+          if (profiler.proxies.end() == it)
+            return nullptr;
+
+          factory = it->second.factory;
+          sites.reserve(it->second.methods.size());
+          for (const std::string &method : it->second.methods)
+          {
+            sites.push_back(
+                  profiler.Site(_plugin, it->second.interface, method));
+          }
+        }
+
+        return factory(_target, std::move(sites));
+      }
+    }
+
+    /////////////////////////////////////////////////
+    void SetCallProfiling(const bool _enabled)
+    {
+      Profiler &profiler = Profiler::Get();
+      if (_enabled)
+      {
+        std::call_once(profiler.calibrated, [&profiler]()
+        {
+          profiler.nanosecondsPerTick.store(CalibrateTicks());
+        });
+      }
+
+      detail::callProfiling.store(_enabled, std::memory_order_release);
+    }
+
+    /////////////////////////////////////////////////
+    bool CallProfiling()
+    {
+      return detail::callProfiling.load(std::memory_order_acquire);
+    }
+
+    /////////////////////////////////////////////////
+    std::vector<MethodProfile> CallProfile()
+    {
+      Profiler &profiler = Profiler::Get();
+      std::vector<MethodProfile> profile;
+      {
+        std::lock_guard<std::mutex> lock(profiler.mutex);
+        profile = profiler.sites;
+        for (std::size_t i = 0; i < profile.size(); ++i)
+        {
+          const MethodProfile &retired = profiler.retired[i];
+          profile[i].calls = retired.calls;
+          profile[i].totalNanoseconds = retired.totalNanoseconds;
+          profile[i].maxNanoseconds = retired.maxNanoseconds;
+          profile[i].histogram = retired.histogram;
+        }
+
+        const std::uint64_t generation =
+            profiler.generation.load(std::memory_order_relaxed);
+        for (const ThreadBuffer *buffer : profiler.threads)
+        {
+          if (buffer->generation.load(std::memory_order_acquire) ==
+              generation)
+          {
+            buffer->CollectInto(profile);
+          }
+        }
+      }
+
+      profile.erase(std::remove_if(profile.begin(), profile.end(),
+            [](const MethodProfile &_method) { return 0 == _method.calls; }),
+            profile.end());
+
+      std::stable_sort(profile.begin(), profile.end(),
+            [](const MethodProfile &_a, const MethodProfile &_b)
+            { return _a.totalNanoseconds > _b.totalNanoseconds; });
+
+      return profile;
+    }
+
+    /////////////////////////////////////////////////
+    void ResetCallProfile()
+    {
+      Profiler &profiler = Profiler::Get();
+      std::lock_guard<std::mutex> lock(profiler.mutex);
+      for (MethodProfile &retired : profiler.retired)
+      {
+        retired.calls = 0;
+        retired.totalNanoseconds = 0;
+        retired.maxNanoseconds = 0;
+        retired.histogram.fill(0);
+      }
+
+      profiler.generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+  }
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <vector>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+#include <ignition/plugin/CpuFeatures.hh>
+
+namespace
+{
+  /// \brief A feature of a CPU architecture
+  struct Feature
+  {
+    /// \brief The name of the feature
+    std::string_view name;
+
+    /// \brief The rank of the feature, see CpuFeatureRank()
+    int rank;
+
+    /// \brief Whether the CPU of this process supports the feature
+    bool supported;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Inspect the CPU of this process
+  /// \return Every known feature of both architectures
+  std::vector<Feature> DetectFeatures()
+  {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    // This may run while other libraries are still being initialized, so
+    // the CPU information of the compiler runtime might not be ready yet.
+    __builtin_cpu_init();
+#define DETAIL_IGN_PLUGIN_X86(name) (__builtin_cpu_supports(name) != 0)
+#else
+#define DETAIL_IGN_PLUGIN_X86(name) false
+#endif
+
+#if defined(__aarch64__)
+    // Advanced SIMD is part of every 64-bit ARM CPU
+    const bool neon = true;
+#if defined(__linux__) && defined(HWCAP_SVE)
+    const bool sve = (getauxval(AT_HWCAP) & HWCAP_SVE) != 0;
+#else
+    const bool sve = false;
+#endif
+#if defined(__linux__) && defined(HWCAP2_SVE2)
+    const bool sve2 = (getauxval(AT_HWCAP2) & HWCAP2_SVE2) != 0;
+#else
+    const bool sve2 = false;
+#endif
+#else
+    const bool neon = false;
+    const bool sve = false;
+    const bool sve2 = false;
+#endif
+
+    return {
+      {"sse2", 1, DETAIL_IGN_PLUGIN_X86("sse2")},
+      {"sse3", 2, DETAIL_IGN_PLUGIN_X86("sse3")},
+      {"ssse3", 3, DETAIL_IGN_PLUGIN_X86("ssse3")},
+      {"sse4.1", 4, DETAIL_IGN_PLUGIN_X86("sse4.1")},
+      {"sse4.2", 5, DETAIL_IGN_PLUGIN_X86("sse4.2")},
+      {"popcnt", 5, DETAIL_IGN_PLUGIN_X86("popcnt")},
+      {"avx", 6, DETAIL_IGN_PLUGIN_X86("avx")},
+      {"fma", 7, DETAIL_IGN_PLUGIN_X86("fma")},
+      {"avx2", 7, DETAIL_IGN_PLUGIN_X86("avx2")},
+      {"bmi", 7, DETAIL_IGN_PLUGIN_X86("bmi")},
+      {"bmi2", 7, DETAIL_IGN_PLUGIN_X86("bmi2")},
+      {"avx512f", 8, DETAIL_IGN_PLUGIN_X86("avx512f")},
+      {"avx512cd", 8, DETAIL_IGN_PLUGIN_X86("avx512cd")},
+      {"avx512bw", 8, DETAIL_IGN_PLUGIN_X86("avx512bw")},
+      {"avx512dq", 8, DETAIL_IGN_PLUGIN_X86("avx512dq")},
+      {"avx512vl", 8, DETAIL_IGN_PLUGIN_X86("avx512vl")},
+      {"neon", 1, neon},
+      {"asimd", 1, neon},
+      {"sve", 2, sve},
+      {"sve2", 3, sve2}
+    };
+
+#undef DETAIL_IGN_PLUGIN_X86
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Find a feature by its name
+  /// \param[in] _name The name of the feature
+  /// \return The feature, or nullptr if it is not known
+  const Feature *FindFeature(const std::string_view _name)
+  {
+    static const std::vector<Feature> features = DetectFeatures();
+
+    for (const Feature &feature : features)
+    {
+      if (feature.name == _name)
+        return &feature;
+    }
+
+    return nullptr;
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    bool CpuSupports(const std::string_view _feature)
+    {
+      const Feature *feature = FindFeature(_feature);
+      return feature && feature->supported;
+    }
+
+    /////////////////////////////////////////////////
+    int CpuFeatureRank(const std::string_view _feature)
+    {
+      const Feature *feature = FindFeature(_feature);
+      return feature ? feature->rank : 0;
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/plugin/CpuFeatures.hh>
+
+using namespace ignition::plugin;
+
+/////////////////////////////////////////////////
+TEST(CpuFeatures, UnknownFeatures)
+{
+  EXPECT_FALSE(CpuSupports(""));
+  EXPECT_FALSE(CpuSupports("not-a-feature"));
+  EXPECT_FALSE(CpuSupports("AVX"));
+  EXPECT_EQ(0, CpuFeatureRank("not-a-feature"));
+}
+
+/////////////////////////////////////////////////
+TEST(CpuFeatures, Architecture)
+{
+#if defined(__x86_64__)
+  // Every 64-bit x86 CPU has SSE2, and no x86 CPU has NEON
+  EXPECT_TRUE(CpuSupports("sse2"));
+  EXPECT_FALSE(CpuSupports("neon"));
+#elif defined(__aarch64__)
+  EXPECT_TRUE(CpuSupports("neon"));
+  EXPECT_TRUE(CpuSupports("asimd"));
+  EXPECT_FALSE(CpuSupports("sse2"));
+#endif
+
+  // The newer generations of a feature always imply the older ones
+  if (CpuSupports("avx2"))
+  {
+    EXPECT_TRUE(CpuSupports("avx"));
+  }
+
+  if (CpuSupports("avx"))
+  {
+    EXPECT_TRUE(CpuSupports("sse4.2"));
+  }
+
+  if (CpuSupports("sve2"))
+  {
+    EXPECT_TRUE(CpuSupports("sve"));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(CpuFeatures, Rank)
+{
+  EXPECT_LT(CpuFeatureRank("sse2"), CpuFeatureRank("sse4.2"));
+  EXPECT_LT(CpuFeatureRank("sse4.2"), CpuFeatureRank("avx"));
+  EXPECT_LT(CpuFeatureRank("avx"), CpuFeatureRank("avx2"));
+  EXPECT_LT(CpuFeatureRank("avx2"), CpuFeatureRank("avx512f"));
+  EXPECT_EQ(CpuFeatureRank("avx2"), CpuFeatureRank("fma"));
+  EXPECT_LT(CpuFeatureRank("neon"), CpuFeatureRank("sve"));
+  EXPECT_EQ(CpuFeatureRank("neon"), CpuFeatureRank("asimd"));
+  EXPECT_LT(0, CpuFeatureRank("sse2"));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -25,6 +25,8 @@ namespace ignition
     class EnablePluginFromThis::Implementation
     {
       public: WeakPluginPtr weak;
+
+      public: std::pmr::memory_resource *resource = nullptr;
     };
 
     EnablePluginFromThis::EnablePluginFromThis()
@@ -51,12 +53,26 @@ namespace ignition
     std::shared_ptr<void>
     EnablePluginFromThis::PluginInstancePtrFromThis() const
     {
-      return this->pimpl->weak.Lock()->PrivateGetInstancePtr();
+      // This only needs the instance, so there is no need to build a whole
+      // PluginPtr around it.
+      return this->pimpl->weak.instance.lock();
+    }
+
+    std::pmr::memory_resource *
+    EnablePluginFromThis::MemoryResourceFromThis() const
+    {
+      return this->pimpl->resource;
     }
 
     void EnablePluginFromThis::PrivateSetPluginFromThis(const PluginPtr &_ptr)
     {
       this->pimpl->weak = _ptr;
     }
+
+    void EnablePluginFromThis::PrivateSetMemoryResource(
+        std::pmr::memory_resource *_resource)
+    {
+      this->pimpl->resource = _resource;
+    }
   }
 }
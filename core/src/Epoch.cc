@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <ignition/plugin/Epoch.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      /// \brief What the epoch domain knows about one thread. Records are
+      /// never deleted, so that the domain can read them without locking,
+      /// but the record of a thread which has exited is reused by the next
+      /// thread which needs one.
+      struct alignas(64) EpochRecord
+      {
+        /// \brief The epoch which the thread entered, or 0 while the thread
+        /// is outside of any guard
+        std::atomic<std::uint64_t> active{0};
+
+        /// \brief True while a thread owns this record
+        std::atomic<bool> inUse{true};
+
+        /// \brief The number of guards which the thread is inside. This is
+        /// only touched by the thread which owns the record.
+        std::size_t depth = 0;
+
+        /// \brief The record which was created before this one. This never
+        /// changes once the record has been published.
+        EpochRecord *next = nullptr;
+      };
+    }
+  }
+}
+
+namespace
+{
+  using ignition::plugin::detail::EpochRecord;
+
+  /// \brief An action which waits for its epoch to pass
+  struct Retired
+  {
+    /// \brief The epoch which ended when the action was retired. Threads
+    /// which entered this epoch or an earlier one might still need whatever
+    /// the action removes.
+    std::uint64_t epoch;
+
+    /// \brief The action
+    std::function<void()> action;
+  };
+
+  /// \brief The threads and the retired actions of the process. There is a
+  /// single domain, since a library may be used by threads of any Loader.
+  class EpochDomain
+  {
+    /// \brief Get the domain of this process. It is never destroyed, so that
+    /// threads can still use it while the program exits.
+    public: static EpochDomain &Get()
+    {
+      static EpochDomain *domain = new EpochDomain;
+      return *domain;
+    }
+
+    /// \brief Take a record for a thread, reusing the record of a thread
+    /// which has exited if there is one
+    /// \return The record
+    public: EpochRecord *AcquireRecord()
+    {
+      for (EpochRecord *record = this->records.load(std::memory_order_acquire);
+           record; record = record->next)
+      {
+        bool inUse = false;
+        if (!record->inUse.load(std::memory_order_relaxed) &&
+            record->inUse.compare_exchange_strong(
+              inUse, true, std::memory_order_acquire))
+        {
+          return record;
+        }
+      }
+
+      EpochRecord *const record = new EpochRecord;
+      record->next = this->records.load(std::memory_order_relaxed);
+      while (!this->records.compare_exchange_weak(
+               record->next, record,
+               std::memory_order_release, std::memory_order_relaxed))
+      {
+        // compare_exchange_weak has updated record->next, so try again
+      }
+
+      return record;
+    }
+
+    /// \brief Give a record back, once its thread does not need it anymore
+    /// \param[in] _record The record
+    public: void ReleaseRecord(EpochRecord *_record)
+    {
+      _record->inUse.store(false, std::memory_order_release);
+    }
+
+    /// \brief Enter the current epoch, unless the thread is already inside
+    /// a guard
+    /// \param[in] _record The record of the calling thread
+    public: void Enter(EpochRecord &_record)
+    {
+      if (0 != _record.depth++)
+        return;
+
+      _record.active.store(
+            this->epoch.load(std::memory_order_acquire),
+            std::memory_order_relaxed);
+
+      // Either RetireAfterEpoch() sees that this thread is active, or this
+      // thread sees everything that happened before the action was retired,
+      // so it cannot find its way into what the action removes.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    /// \brief Leave the epoch, if this is the outermost guard of the thread
+    /// \param[in] _record The record of the calling thread
+    public: void Leave(EpochRecord &_record)
+    {
+      if (0 != --_record.depth)
+        return;
+
+      _record.active.store(0, std::memory_order_release);
+
+      if (0 != this->retiredCount.load(std::memory_order_relaxed))
+        this->Reclaim();
+    }
+
+    /// \brief Retire an action, and run it if it is already safe
+    /// \param[in] _action The action
+    public: void Retire(std::function<void()> _action)
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        const std::uint64_t ended =
+            this->epoch.fetch_add(1, std::memory_order_seq_cst);
+        this->retired.push_back(Retired{ended, std::move(_action)});
+        this->retiredCount.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      this->Reclaim();
+    }
+
+    /// \brief Run the actions whose epochs every active thread has left
+    /// \return The number of actions which were run
+    public: std::size_t Reclaim()
+    {
+      std::vector<std::function<void()>> ready;
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->retired.empty())
+          return 0;
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        for (const EpochRecord *record =
+               this->records.load(std::memory_order_acquire);
+             record; record = record->next)
+        {
+          const std::uint64_t active =
+              record->active.load(std::memory_order_acquire);
+          if (0 != active && active < oldest)
+            oldest = active;
+        }
+
+        // The actions are retired in the order of their epochs, so the ones
+        // that are ready are all at the front.
+        std::size_t count = 0;
+        while (count < this->retired.size()
+               && this->retired[count].epoch < oldest)
+        {
+          ready.push_back(std::move(this->retired[count].action));
+          ++count;
+        }
+
+        this->retired.erase(this->retired.begin(),
+                            this->retired.begin() + count);
+        this->retiredCount.fetch_sub(count, std::memory_order_relaxed);
+      }
+
+      // Run the actions without holding the lock, since unloading a library
+      // destroys its static objects, which may retire actions of their own.
+      for (const std::function<void()> &action : ready)
+        action();
+
+      return ready.size();
+    }
+
+    /// \brief Get the number of retired actions which have not run yet
+    /// \return The number of waiting actions
+    public: std::size_t RetiredCount() const
+    {
+      return this->retiredCount.load(std::memory_order_relaxed);
+    }
+
+    /// \brief The current epoch. It starts at 1, since 0 marks the records
+    /// of threads which are not inside a guard.
+    private: std::atomic<std::uint64_t> epoch{1};
+
+    /// \brief The most recently created record. The records form a list
+    /// which only ever grows.
+    private: std::atomic<EpochRecord*> records{nullptr};
+
+    /// \brief Protects retired, and keeps the epochs of the retired actions
+    /// in order
+    private: std::mutex mutex;
+
+    /// \brief The actions which are waiting for their epochs to pass
+    private: std::vector<Retired> retired;
+
+    /// \brief The size of retired, which can be read without locking
+    private: std::atomic<std::size_t> retiredCount{0};
+  };
+
+  /// \brief Set once the record of the current thread has been given back,
+  /// since guards may still be used by destructors which run at thread
+  /// exit. This is trivially destructible, so it can still be read then.
+  thread_local bool threadRecordReleased = false;
+
+  /// \brief Owns the record of a thread, and gives it back at thread exit
+  struct ThreadRecord
+  {
+    /// \brief The record
+    EpochRecord *const record = EpochDomain::Get().AcquireRecord();
+
+    /// \brief Destructor
+    ~ThreadRecord()
+    {
+      threadRecordReleased = true;
+      EpochDomain::Get().ReleaseRecord(this->record);
+    }
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Get the record of the calling thread
+  /// \return The record, or nullptr if the thread is exiting
+  EpochRecord *CurrentThreadRecord()
+  {
+    if (threadRecordReleased)
+      return nullptr;
+
+    thread_local ThreadRecord owner;
+    return owner.record;
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    EpochGuard::EpochGuard()
+      : record(CurrentThreadRecord()),
+        ownsRecord(false)
+    {
+      if (!this->record)
+      {
+        this->record = EpochDomain::Get().AcquireRecord();
+        this->ownsRecord = true;
+      }
+
+      EpochDomain::Get().Enter(*this->record);
+    }
+
+    /////////////////////////////////////////////////
+    EpochGuard::~EpochGuard()
+    {
+      EpochDomain::Get().Leave(*this->record);
+
+      if (this->ownsRecord)
+        EpochDomain::Get().ReleaseRecord(this->record);
+    }
+
+    /////////////////////////////////////////////////
+    void RetireAfterEpoch(std::function<void()> _action)
+    {
+      EpochDomain::Get().Retire(std::move(_action));
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t ReclaimRetired()
+    {
+      return EpochDomain::Get().Reclaim();
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t RetiredCount()
+    {
+      return EpochDomain::Get().RetiredCount();
+    }
+  }
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ignition/plugin/Epoch.hh>
+
+using namespace ignition::plugin;
+
+/////////////////////////////////////////////////
+/// \brief Keeps a thread inside an EpochGuard until it is told to leave
+class GuardedThread
+{
+  public: GuardedThread()
+  {
+    this->thread = std::thread([this]()
+    {
+      EpochGuard guard;
+
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->entered = true;
+      this->condition.notify_all();
+      this->condition.wait(lock, [this]() { return this->leave; });
+    });
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->condition.wait(lock, [this]() { return this->entered; });
+  }
+
+  /// \brief Make the thread leave its guard, and wait for it to finish
+  public: void Leave()
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->leave = true;
+    }
+    this->condition.notify_all();
+    this->thread.join();
+  }
+
+  private: std::mutex mutex;
+  private: std::condition_variable condition;
+  private: bool entered = false;
+  private: bool leave = false;
+  private: std::thread thread;
+};
+
+/////////////////////////////////////////////////
+TEST(Epoch, RunsRightAwayWithoutGuards)
+{
+  int runs = 0;
+  RetireAfterEpoch([&runs]() { ++runs; });
+  EXPECT_EQ(1, runs);
+  EXPECT_EQ(0u, RetiredCount());
+}
+
+/////////////////////////////////////////////////
+TEST(Epoch, WaitsForEarlierGuards)
+{
+  GuardedThread guarded;
+
+  std::atomic<int> runs{0};
+  RetireAfterEpoch([&runs]() { ++runs; });
+  EXPECT_EQ(0, runs);
+  EXPECT_EQ(1u, RetiredCount());
+
+  // Guards entered after the action was retired do not hold it back, but
+  // they do not release it either
+  {
+    EpochGuard later;
+  }
+  EXPECT_EQ(0u, ReclaimRetired());
+  EXPECT_EQ(0, runs);
+
+  // The last of the earlier guards runs the action when it is left
+  guarded.Leave();
+  EXPECT_EQ(1, runs);
+  EXPECT_EQ(0u, RetiredCount());
+}
+
+/////////////////////////////////////////////////
+TEST(Epoch, OwnGuard)
+{
+  int runs = 0;
+  {
+    EpochGuard outer;
+    {
+      EpochGuard inner;
+      RetireAfterEpoch([&runs]() { ++runs; });
+    }
+
+    // Only the outermost guard counts
+    EXPECT_EQ(0, runs);
+    EXPECT_EQ(1u, RetiredCount());
+  }
+
+  EXPECT_EQ(1, runs);
+  EXPECT_EQ(0u, RetiredCount());
+}
+
+/////////////////////////////////////////////////
+TEST(Epoch, RetireFromAction)
+{
+  // Actions may retire more actions, like libraries whose static objects
+  // release other libraries
+  std::vector<int> order;
+  {
+    EpochGuard guard;
+    RetireAfterEpoch([&order]()
+    {
+      order.push_back(1);
+      RetireAfterEpoch([&order]() { order.push_back(2); });
+    });
+  }
+
+  ASSERT_EQ(2u, order.size());
+  EXPECT_EQ(1, order[0]);
+  EXPECT_EQ(2, order[1]);
+}
+
+/////////////////////////////////////////////////
+TEST(Epoch, ManyThreads)
+{
+  std::atomic<int> runs{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t)
+  {
+    threads.emplace_back([&runs]()
+    {
+      for (int i = 0; i < 1000; ++i)
+      {
+        EpochGuard guard;
+        if (0 == i % 10)
+          RetireAfterEpoch([&runs]() { ++runs; });
+      }
+    });
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  ReclaimRetired();
+  EXPECT_EQ(800, runs);
+  EXPECT_EQ(0u, RetiredCount());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
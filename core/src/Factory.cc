@@ -15,15 +15,45 @@
  *
 */
 
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <new>
 #include <thread>
-#include <vector>
 
+#include <ignition/plugin/Epoch.hh>
 #include <ignition/plugin/Factory.hh>
 
 namespace
 {
+  /// \brief A factory reference that was handed off by a lost product
+  struct LostProduct
+  {
+    /// \brief The reference to the factory of the lost product
+    public: std::shared_ptr<void> factoryPluginInstancePtr;
+
+    /// \brief The lost product that was handed off before this one
+    public: LostProduct *next;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Delete a list of lost products, releasing their factories
+  void DeleteLostProducts(LostProduct *_head)
+  {
+    while (_head)
+    {
+      LostProduct *const next = _head->next;
+      delete _head;
+      _head = next;
+    }
+  }
+
   struct LostProductManager
   {
     /// \brief This class is designed to handle situations where users have lost
@@ -31,19 +61,169 @@ namespace
     /// it's possible for plugin objects to be getting destructed and/or cleaned
     /// up across different threads at the same time.
     ///
-    /// To guard against race conditions, we should use a mutex when modifying
-    /// this object with a static lifetime.
-    public: std::mutex mutex;
-
-    /// \brief This is a collection of references to the factories of products
-    /// that did not get properly deleted by a ProductDeleter. We will store
-    /// their factory references here to ensure that their libraries remain
-    /// loaded so the products can be deleted safely.
-    ///
-    /// If a user knows that they are losing control of their products, they can
-    /// call CleanupLostProducts() to clear out this vector and clean up any
-    /// potential memory leaks.
-    public: std::vector<std::shared_ptr<void>> lostProducts;
+    /// Products may be destructed from many threads at once, so handing off a
+    /// factory reference must never block. The references are kept in an
+    /// intrusive singly linked list which producers push onto with a
+    /// compare-and-swap, and which CleanupLostProducts() takes in its entirety
+    /// with a single exchange.
+    public: std::atomic<LostProduct*> head{nullptr};
+
+    /// \brief The number of lost products which are currently in the list
+    public: std::atomic<std::size_t> count{0};
+
+    /// \brief Serializes starting and stopping the reaper thread, so that
+    /// concurrent callers never replace a thread which is still joinable.
+    /// The reaper thread itself never locks this.
+    public: std::mutex reaperControlMutex;
+
+    /// \brief Protects the state of the reaper thread. This is never locked
+    /// by a product which is being destructed.
+    public: std::mutex reaperMutex;
+
+    /// \brief Wakes up the reaper thread when it is asked to stop
+    public: std::condition_variable reaperCondition;
+
+    /// \brief True while the reaper thread should keep running
+    public: bool reaperRunning = false;
+
+    /// \brief A thread which periodically cleans up the lost products
+    public: std::thread reaper;
+
+    /// \brief Push a factory reference onto the list
+    /// \param[in] _factory The reference to keep alive
+    public: void Push(const std::shared_ptr<void> &_factory)
+    {
+      // Count the product before it becomes visible, so that the count never
+      // drops below zero while CleanupLostProducts() is releasing it.
+      this->count.fetch_add(1, std::memory_order_relaxed);
+
+      LostProduct *const product =
+          new LostProduct{_factory, this->head.load(std::memory_order_relaxed)};
+
+      while (!this->head.compare_exchange_weak(
+               product->next, product,
+               std::memory_order_release, std::memory_order_relaxed))
+      {
+        // compare_exchange_weak has updated product->next, so try again
+      }
+    }
+
+    /// \brief Take every factory reference that is currently in the list
+    /// \return The head of the list that was taken
+    public: LostProduct *TakeAll()
+    {
+      return this->head.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    /// \brief Release the lost products which are currently in the list
+    /// \param[in] _safetyWait How long to wait before releasing them
+    public: void Cleanup(const std::chrono::nanoseconds &_safetyWait)
+    {
+      // Take the products before waiting, so that every product we release
+      // has had at least the full safety wait to exit its destructor. Products
+      // which are lost while we wait stay in the list for the next cleanup.
+      LostProduct *const taken = this->TakeAll();
+      if (!taken)
+        return;
+
+      // Threads which delete products outside of an EpochGuard can only be
+      // given some time to leave the destructor.
+      if (_safetyWait.count() > 0)
+        std::this_thread::sleep_for(_safetyWait);
+
+      std::size_t released = 0;
+      for (const LostProduct *p = taken; p; p = p->next)
+        ++released;
+
+      this->count.fetch_sub(released, std::memory_order_relaxed);
+
+      // A product might be in-between handing off its factory reference and
+      // exiting its destructor, which is code of the library that we are
+      // about to unload. If the thread deleting it is inside an EpochGuard,
+      // the references are only released once it has left the guard.
+      ignition::plugin::RetireAfterEpoch([taken]()
+      {
+        DeleteLostProducts(taken);
+      });
+    }
+
+    /// \brief Start the reaper thread, replacing any reaper that is running
+    /// \param[in] _period How often the reaper cleans up
+    /// \param[in] _safetyWait The safety wait of each cleanup
+    public: void StartReaper(const std::chrono::nanoseconds &_period,
+                             const std::chrono::nanoseconds &_safetyWait)
+    {
+      std::lock_guard<std::mutex> control(this->reaperControlMutex);
+      this->JoinReaper();
+
+      std::unique_lock<std::mutex> lock(this->reaperMutex);
+      this->reaperRunning = true;
+      this->reaper = std::thread([this, _period, _safetyWait]()
+      {
+        std::unique_lock<std::mutex> reaperLock(this->reaperMutex);
+        while (this->reaperRunning)
+        {
+          this->reaperCondition.wait_for(
+                reaperLock, _period, [this]() { return !this->reaperRunning; });
+
+          if (!this->reaperRunning)
+            break;
+
+          // Never wait or unload a library while holding the lock
+          reaperLock.unlock();
+          this->Cleanup(_safetyWait);
+          reaperLock.lock();
+        }
+      });
+    }
+
+    /// \brief Stop the reaper thread, if one is running, and wait for it to
+    /// finish
+    public: void StopReaper()
+    {
+      std::lock_guard<std::mutex> control(this->reaperControlMutex);
+      this->JoinReaper();
+    }
+
+    /// \brief Implementation of StopReaper(). reaperControlMutex must be
+    /// locked.
+    private: void JoinReaper()
+    {
+      std::thread finished;
+      {
+        std::unique_lock<std::mutex> lock(this->reaperMutex);
+        this->reaperRunning = false;
+        finished.swap(this->reaper);
+      }
+
+      this->reaperCondition.notify_all();
+      if (finished.joinable())
+        finished.join();
+    }
+
+    /// \brief Release anything which is left over when the program exits
+    public: ~LostProductManager()
+    {
+      this->StopReaper();
+      DeleteLostProducts(this->TakeAll());
+    }
+  };
+
+  /// \brief This is placed right in front of the storage of every product
+  struct ProductHeader
+  {
+    /// \brief The resource which the storage came from, or nullptr if it
+    /// came from the heap
+    public: std::pmr::memory_resource *resource;
+
+    /// \brief The number of bytes which were allocated
+    public: std::size_t size;
+
+    /// \brief The alignment which the bytes were allocated with
+    public: std::size_t alignment;
+
+    /// \brief The distance from the start of the allocation to the product
+    public: std::size_t offset;
   };
 
   /// static instance of the lost product manager that will be used to store the
@@ -57,8 +237,209 @@ namespace ignition
   {
     namespace detail
     {
+      /////////////////////////////////////////////////
+      void *AllocateProduct(
+          const std::size_t _size, std::size_t _alignment,
+          std::pmr::memory_resource *_resource)
+      {
+        if (_alignment < alignof(ProductHeader))
+          _alignment = alignof(ProductHeader);
+
+        // Round the header up to the alignment of the product, so that the
+        // product which follows it is correctly aligned.
+        const std::size_t offset =
+            (sizeof(ProductHeader) + _alignment - 1) / _alignment * _alignment;
+        const std::size_t size = offset + _size;
+
+        void *const allocation = _resource ?
+              _resource->allocate(size, _alignment) :
+              ::operator new(size, std::align_val_t(_alignment));
+
+        unsigned char *const product =
+            static_cast<unsigned char*>(allocation) + offset;
+
+        new (product - sizeof(ProductHeader))
+            ProductHeader{_resource, size, _alignment, offset};
+
+        return product;
+      }
+
+      /////////////////////////////////////////////////
+      std::size_t ProductFootprint(
+          const std::size_t _size, std::size_t _alignment)
+      {
+        if (_alignment < alignof(ProductHeader))
+          _alignment = alignof(ProductHeader);
+
+        const std::size_t offset =
+            (sizeof(ProductHeader) + _alignment - 1) / _alignment * _alignment;
+
+        // Round up the end as well, so that the next product in a block is
+        // also correctly aligned.
+        return (offset + _size + _alignment - 1) / _alignment * _alignment;
+      }
+
+      /////////////////////////////////////////////////
+      ProductBlock::ProductBlock(
+          const std::size_t _size, const std::size_t _alignment,
+          std::shared_ptr<void> _factory)
+        : storage(static_cast<unsigned char*>(
+                    ::operator new(_size, std::align_val_t(
+                      _alignment < alignof(ProductHeader) ?
+                        alignof(ProductHeader) : _alignment)))),
+          size(_size),
+          alignment(_alignment < alignof(ProductHeader) ?
+                      alignof(ProductHeader) : _alignment),
+          factory(std::move(_factory))
+      {
+        // Do nothing
+      }
+
+      /////////////////////////////////////////////////
+      ProductBlock::~ProductBlock()
+      {
+        ::operator delete(this->storage, std::align_val_t(this->alignment));
+      }
+
+      /////////////////////////////////////////////////
+      void *ProductBlock::do_allocate(
+          const std::size_t _bytes, const std::size_t _alignment)
+      {
+        const std::size_t start =
+            (this->used + _alignment - 1) / _alignment * _alignment;
+
+        if (_alignment > this->alignment || start + _bytes > this->size)
+        {
+          // LCOV_EXCL_START
+          // ConstructMany sizes the block for exactly the products it makes,
+          // so this should never happen.
+          std::cerr << "[ignition::plugin::detail::ProductBlock] A block ran "
+                    << "out of storage. Please report this bug!\n";
+          assert(false);
+          throw std::bad_alloc();
+          // LCOV_EXCL_STOP
+        }
+
+        this->used = start + _bytes;
+        return this->storage + start;
+      }
+
+      /////////////////////////////////////////////////
+      void ProductBlock::do_deallocate(
+          void * /*_p*/, std::size_t /*_bytes*/, std::size_t /*_alignment*/)
+      {
+        // The storage is freed all at once when the block is destroyed
+      }
+
+      /////////////////////////////////////////////////
+      bool ProductBlock::do_is_equal(
+          const std::pmr::memory_resource &_other) const noexcept
+      {
+        return this == &_other;
+      }
+
+      /////////////////////////////////////////////////
+      class ProductReferenceShards::Implementation
+      {
+        /// \brief One shard. Each shard is on its own cache line so that
+        /// threads which use different shards do not contend.
+        public: struct alignas(64) Shard
+        {
+          /// \brief Protects the reference of the shard
+          public: std::mutex mutex;
+
+          /// \brief The reference which the products of this shard share.
+          /// This expires when the last of those products is deleted.
+          public: std::weak_ptr<void> reference;
+        };
+
+        /// \brief The number of shards
+        public: static constexpr std::size_t kShardCount = 16;
+
+        /// \brief Get the shard of the calling thread
+        /// \return The shard of the calling thread
+        public: Shard &ShardOfThisThread()
+        {
+          return this->shards[
+              std::hash<std::thread::id>()(std::this_thread::get_id())
+              % kShardCount];
+        }
+
+        /// \brief The shards
+        public: Shard shards[kShardCount];
+      };
+
+      /////////////////////////////////////////////////
+      ProductReferenceShards::ProductReferenceShards()
+        : dataPtr(new Implementation)
+      {
+        // Do nothing
+      }
+
+      /////////////////////////////////////////////////
+      ProductReferenceShards::~ProductReferenceShards() = default;
+
+      /////////////////////////////////////////////////
+      std::shared_ptr<void> ProductReferenceShards::Acquire()
+      {
+        Implementation::Shard &shard = this->dataPtr->ShardOfThisThread();
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        return shard.reference.lock();
+      }
+
+      /////////////////////////////////////////////////
+      std::shared_ptr<void> ProductReferenceShards::Install(
+          std::shared_ptr<void> _plugin)
+      {
+        Implementation::Shard &shard = this->dataPtr->ShardOfThisThread();
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        std::shared_ptr<void> reference = shard.reference.lock();
+        if (!reference)
+        {
+          // The shared reference is created here in the core library. When
+          // the last product of the shard lets go of it, releasing the plugin
+          // might unload the plugin library, so that must not happen inside
+          // one of the library's own symbols.
+          reference = std::make_shared<std::shared_ptr<void>>(
+                std::move(_plugin));
+          shard.reference = reference;
+        }
+
+        return reference;
+      }
+
+      /////////////////////////////////////////////////
+      void DeallocateProduct(void *_ptr)
+      {
+        if (!_ptr)
+          return;
+
+        unsigned char *const product = static_cast<unsigned char*>(_ptr);
+        const ProductHeader header = *reinterpret_cast<const ProductHeader*>(
+              product - sizeof(ProductHeader));
+
+        void *const allocation = product - header.offset;
+        if (header.resource)
+        {
+          header.resource->deallocate(
+                allocation, header.size, header.alignment);
+        }
+        else
+        {
+          ::operator delete(allocation, std::align_val_t(header.alignment));
+        }
+      }
+
       FactoryCounter::~FactoryCounter()
       {
+        if (this->statistics)
+        {
+          this->statistics->destroyed.fetch_add(1, std::memory_order_relaxed);
+          if (this->factoryPluginInstancePtr)
+            this->statistics->lost.fetch_add(1, std::memory_order_relaxed);
+        }
+
         if (this->factoryPluginInstancePtr)
         {
           // If the reference to the factory plugin is still a valid pointer,
@@ -74,29 +455,30 @@ namespace ignition
           // will hand off a copy of the factory reference to the
           // lostProductManager which will keep it alive until the user
           // explicitly calls CleanupLostProducts().
-          std::unique_lock<std::mutex> lock(lostProductManager.mutex);
-          lostProductManager.lostProducts.push_back(
-                this->factoryPluginInstancePtr);
+          lostProductManager.Push(this->factoryPluginInstancePtr);
         }
       }
     }
 
     void CleanupLostProducts(const std::chrono::nanoseconds &_safetyWait)
     {
-      std::unique_lock<std::mutex> lock(lostProductManager.mutex);
+      lostProductManager.Cleanup(_safetyWait);
+    }
 
-      // In case any products are in-between handing off their factory reference
-      // and exiting their destructor, wait for a short while so that the call
-      // stack can fully exit the destructor before we unload its library.
-      std::this_thread::sleep_for(_safetyWait);
+    void StartLostProductReaper(const std::chrono::nanoseconds &_period,
+                                const std::chrono::nanoseconds &_safetyWait)
+    {
+      lostProductManager.StartReaper(_period, _safetyWait);
+    }
 
-      lostProductManager.lostProducts.clear();
+    void StopLostProductReaper()
+    {
+      lostProductManager.StopReaper();
     }
 
     std::size_t LostProductCount()
     {
-      std::unique_lock<std::mutex> lock(lostProductManager.mutex);
-      return lostProductManager.lostProducts.size();
+      return lostProductManager.count.load(std::memory_order_relaxed);
     }
   }
 }
@@ -17,6 +17,8 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -82,6 +84,58 @@ TEST(Factory, ProducerWithVector)
   EXPECT_NE(nullptr, producer.Construct(std::vector<double>()));
 }
 
+/////////////////////////////////////////////////
+TEST(Factory, ProducerStatistics)
+{
+  DoubleIntProducer producer;
+  {
+    auto first = producer.Construct(0.0, 1u);
+    auto second = producer.Construct(0.0, 1u);
+
+    const ignition::plugin::FactoryStatistics statistics =
+        producer.Statistics();
+    EXPECT_EQ(2u, statistics.constructed);
+    EXPECT_EQ(0u, statistics.destroyed);
+    EXPECT_EQ(2u, statistics.live);
+  }
+
+  const ignition::plugin::FactoryStatistics statistics = producer.Statistics();
+  EXPECT_EQ(2u, statistics.constructed);
+  EXPECT_EQ(2u, statistics.destroyed);
+  EXPECT_EQ(0u, statistics.live);
+
+  std::uint64_t histogramTotal = 0;
+  for (const std::uint64_t count : statistics.constructLatency)
+    histogramTotal += count;
+  EXPECT_EQ(2u, histogramTotal);
+}
+
+/////////////////////////////////////////////////
+TEST(FactoryStatistics, LatencyBuckets)
+{
+  ignition::plugin::detail::FactoryStatisticsCounters counters;
+  counters.RecordConstruct(1, std::chrono::nanoseconds(0));
+  counters.RecordConstruct(1, std::chrono::nanoseconds(1));
+  counters.RecordConstruct(1, std::chrono::nanoseconds(2));
+  counters.RecordConstruct(1, std::chrono::nanoseconds(3));
+  counters.RecordConstruct(1, std::chrono::nanoseconds(4));
+  counters.RecordConstruct(1, std::chrono::nanoseconds(1000));
+
+  // The time of a batch is split among its products
+  counters.RecordConstruct(4, std::chrono::nanoseconds(8));
+
+  // Anything too slow for the histogram goes into the last bucket
+  counters.RecordConstruct(1, std::chrono::hours(1000));
+
+  const ignition::plugin::FactoryStatistics statistics = counters.Snapshot();
+  EXPECT_EQ(11u, statistics.constructed);
+  EXPECT_EQ(2u, statistics.constructLatency[0]);
+  EXPECT_EQ(5u, statistics.constructLatency[1]);
+  EXPECT_EQ(2u, statistics.constructLatency[2]);
+  EXPECT_EQ(1u, statistics.constructLatency[10]);
+  EXPECT_EQ(1u, statistics.constructLatency.back());
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
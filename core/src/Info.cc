@@ -21,14 +21,36 @@ namespace ignition
 {
   namespace plugin
   {
+    /////////////////////////////////////////////////
+    void v1::Info::Clear()
+    {
+      name.clear();
+      aliases.clear();
+      interfaces.clear();
+      demangledInterfaces.clear();
+      factory = nullptr;
+      deleter = nullptr;
+    }
+
+    /////////////////////////////////////////////////
     void Info::Clear()
     {
       name.clear();
       aliases.clear();
       interfaces.clear();
+      interfaceIds.clear();
       demangledInterfaces.clear();
       factory = nullptr;
       deleter = nullptr;
+      instanceSize = 0;
+      instanceAlignment = 0;
+      construct = nullptr;
+      destruct = nullptr;
+      enablePluginFromThis = nullptr;
+      requiredFeatures.clear();
+      dependencies.clear();
+      constructors.clear();
+      kernelTables.clear();
     }
   }
 }
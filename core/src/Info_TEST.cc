@@ -17,6 +17,8 @@
 
 #include <gtest/gtest.h>
 
+#include <new>
+
 #include <ignition/plugin/Info.hh>
 
 struct SomeInterface
@@ -32,27 +34,61 @@ TEST(Info, Clear)
   ignition::plugin::Info info;
   info.name = typeid(SomePlugin).name();
 
-  info.factory = [=]()
+  info.factory = []()
   {
     return static_cast<void*>(new SomePlugin);
   };
 
-  info.deleter = [=](void *ptr)
+  info.deleter = [](void *ptr)
   {
     delete static_cast<SomePlugin*>(ptr);
   };
 
+  info.instanceSize = sizeof(SomePlugin);
+  info.instanceAlignment = alignof(SomePlugin);
+  info.construct = [](void *storage) -> void*
+  {
+    return static_cast<void*>(new (storage) SomePlugin);
+  };
+
+  info.destruct = [](void *ptr)
+  {
+    static_cast<SomePlugin*>(ptr)->~SomePlugin();
+  };
+
+  info.enablePluginFromThis = [](void *ptr) -> void*
+  {
+    return ptr;
+  };
+
   info.interfaces.insert(
       std::make_pair(
         typeid(SomeInterface).name(),
-        [=](void *v_ptr)
+        [](void *v_ptr) -> void*
   {
     SomePlugin *d_ptr = static_cast<SomePlugin*>(v_ptr);
     return static_cast<SomeInterface*>(d_ptr);
   }));
 
+  info.interfaceIds.insert(
+      std::make_pair(typeid(SomeInterface).name(), 1u));
+
   info.aliases.insert("some alias");
   info.aliases.insert("another alias");
+  info.requiredFeatures.insert("avx2");
+  info.dependencies.insert("some plugin");
+  info.constructors.insert(
+      std::make_pair(
+        typeid(void()).name(),
+        [](void * /*_arguments*/) -> void*
+  {
+    return static_cast<void*>(new SomePlugin);
+  }));
+  static const int someTable = 0;
+  info.kernelTables.insert(
+      std::make_pair(
+        typeid(int).name(),
+        ignition::plugin::Info::KernelTable{&someTable, 1}));
 
   for (const auto &interfaceName : info.interfaces)
   {
@@ -61,19 +97,39 @@ TEST(Info, Clear)
 
   EXPECT_FALSE(info.name.empty());
   EXPECT_FALSE(info.aliases.empty());
+  EXPECT_FALSE(info.requiredFeatures.empty());
+  EXPECT_FALSE(info.dependencies.empty());
+  EXPECT_FALSE(info.constructors.empty());
+  EXPECT_FALSE(info.kernelTables.empty());
   EXPECT_FALSE(info.interfaces.empty());
+  EXPECT_FALSE(info.interfaceIds.empty());
   EXPECT_FALSE(info.demangledInterfaces.empty());
   EXPECT_TRUE(static_cast<bool>(info.factory));
   EXPECT_TRUE(static_cast<bool>(info.deleter));
+  EXPECT_NE(0u, info.instanceSize);
+  EXPECT_NE(0u, info.instanceAlignment);
+  EXPECT_TRUE(static_cast<bool>(info.construct));
+  EXPECT_TRUE(static_cast<bool>(info.destruct));
+  EXPECT_TRUE(static_cast<bool>(info.enablePluginFromThis));
 
   info.Clear();
 
   EXPECT_TRUE(info.name.empty());
   EXPECT_TRUE(info.aliases.empty());
+  EXPECT_TRUE(info.requiredFeatures.empty());
+  EXPECT_TRUE(info.dependencies.empty());
+  EXPECT_TRUE(info.constructors.empty());
+  EXPECT_TRUE(info.kernelTables.empty());
   EXPECT_TRUE(info.interfaces.empty());
+  EXPECT_TRUE(info.interfaceIds.empty());
   EXPECT_TRUE(info.demangledInterfaces.empty());
   EXPECT_FALSE(static_cast<bool>(info.factory));
   EXPECT_FALSE(static_cast<bool>(info.deleter));
+  EXPECT_EQ(0u, info.instanceSize);
+  EXPECT_EQ(0u, info.instanceAlignment);
+  EXPECT_FALSE(static_cast<bool>(info.construct));
+  EXPECT_FALSE(static_cast<bool>(info.destruct));
+  EXPECT_FALSE(static_cast<bool>(info.enablePluginFromThis));
 }
 
 int main(int argc, char **argv)
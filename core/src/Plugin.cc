@@ -16,16 +16,516 @@
  */
 
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "ignition/plugin/Plugin.hh"
 #include "ignition/plugin/Info.hh"
+#include "ignition/plugin/Trace.hh"
+#include "ignition/plugin/utility.hh"
+
+#include "ProxyRegistry.hh"
 
 namespace ignition
 {
   namespace plugin
   {
+    /// \brief Where to find the interfaces of a plugin, which is the same
+    /// for every instance of the plugin. A layout is shared by all the
+    /// instances of a plugin that are alive at the same time, so that
+    /// instantiating a plugin does not need to walk through its interfaces.
+    ///
+    /// The interfaces are indexed twice: by their stable IDs (see
+    /// InterfaceId()), which is how every typed query finds them with a
+    /// single integer comparison, and by the hashes of their mangled names,
+    /// for the string-based API and for interfaces that were registered
+    /// without an ID.
+    struct InterfaceLayout
+    {
+      /// \brief An interface of the plugin
+      public: struct Entry
+      {
+        /// \brief The key of the interface within its index, i.e. either its
+        /// ID or the hash of its mangled name
+        std::uint64_t key = 0;
+
+        /// \brief The mangled name of the interface. This views a key of
+        /// Info::interfaces, so it is only valid while the Info of the plugin
+        /// is alive.
+        std::string_view name;
+
+        /// \brief One more than the position of the interface in `casts`.
+        /// Empty slots of an index have a position of 0.
+        std::size_t position = 0;
+      };
+
+      /// \brief An open addressing table of interfaces, whose layout is
+      /// chosen when it is built: Layout() searches for a multiplier which
+      /// sends the key of every interface to a distinct slot, so that finding
+      /// an interface takes a single probe. If no such multiplier turns up,
+      /// which is only likely for plugins with a great many interfaces, the
+      /// index falls back to linear probing.
+      public: class Index
+      {
+        /// \brief Find an interface
+        /// \param[in] _key The key of the interface
+        /// \param[in] _matches Tells whether an entry whose key matches is
+        /// the one that is wanted
+        /// \return The position of the interface plus one, or 0 if the index
+        /// does not contain it
+        public: template <typename Matches>
+        std::size_t Find(const std::uint64_t _key,
+                         const Matches &_matches) const
+        {
+          if (this->slots.empty())
+            return 0;
+
+          // The index is never more than half full, so the probe always
+          // reaches an empty slot eventually.
+          const std::size_t mask = this->slots.size() - 1;
+          for (std::size_t i = this->Home(_key); ; i = (i + 1) & mask)
+          {
+            const Entry &slot = this->slots[i];
+            if (0 == slot.position)
+              return 0;
+
+            if (slot.key == _key && _matches(slot))
+              return slot.position;
+
+            // With a perfect layout, every interface is in its home slot.
+            if (this->perfect)
+              return 0;
+          }
+        }
+
+        /// \brief Choose the layout of the index and place the interfaces
+        /// into it.
+        /// \param[in] _interfaces The interfaces of the plugin
+        public: void Layout(const std::vector<Entry> &_interfaces)
+        {
+          this->slots.clear();
+          this->perfect = false;
+          if (_interfaces.empty())
+            return;
+
+          // Start with an index that is at most half full
+          unsigned int bits = 1;
+          while ((std::size_t(1) << bits) < 2 * _interfaces.size())
+            ++bits;
+
+          // The number of multipliers that are tried for each index size,
+          // and the number of times that the index size may be doubled
+          const unsigned int attempts = 32;
+          const unsigned int growth = 2;
+
+          std::vector<bool> taken;
+          for (unsigned int extra = 0;
+               extra <= growth && !this->perfect; ++extra)
+          {
+            taken.assign(std::size_t(1) << (bits + extra), false);
+            this->shift = 64 - (bits + extra);
+
+            for (unsigned int i = 0; i < attempts && !this->perfect; ++i)
+            {
+              // Odd multiples of the golden ratio are good multipliers for
+              // multiplicative hashing.
+              this->multiplier = 0x9e3779b97f4a7c15ull * (2 * i + 1);
+
+              std::fill(taken.begin(), taken.end(), false);
+              this->perfect = true;
+              for (const Entry &entry : _interfaces)
+              {
+                const std::size_t home = this->Home(entry.key);
+                if (taken[home])
+                {
+                  this->perfect = false;
+                  break;
+                }
+
+                taken[home] = true;
+              }
+            }
+          }
+
+          if (!this->perfect)
+          {
+            // LCOV_EXCL_START
+            this->shift = 64 - bits;
+            this->multiplier = 0x9e3779b97f4a7c15ull;
+            // LCOV_EXCL_STOP
+          }
+
+          this->slots.assign(std::size_t(1) << (64 - this->shift), Entry());
+          const std::size_t mask = this->slots.size() - 1;
+          for (const Entry &entry : _interfaces)
+          {
+            std::size_t i = this->Home(entry.key);
+            while (0 != this->slots[i].position)
+              i = (i + 1) & mask;
+
+            this->slots[i] = entry;
+          }
+        }
+
+        /// \brief Get the slot which an interface is placed into, unless
+        /// the slot was already taken.
+        /// \param[in] _key The key of the interface
+        /// \return The index of the slot
+        private: std::size_t Home(const std::uint64_t _key) const
+        {
+          return static_cast<std::size_t>((_key * this->multiplier)
+                                          >> this->shift);
+        }
+
+        /// \brief The slots of the index. Its size is a power of two.
+        private: std::vector<Entry> slots;
+
+        /// \brief The multiplier which maps a key to its home slot
+        private: std::uint64_t multiplier = 0;
+
+        /// \brief 64 minus the number of bits of a slot index
+        private: unsigned int shift = 63;
+
+        /// \brief True if every interface is in its home slot
+        private: bool perfect = false;
+      };
+
+      /// \brief Constructor. This lays out the interfaces that an Info lists,
+      /// without casting anything.
+      /// \param[in] _info The Info of the plugin
+      public: explicit InterfaceLayout(const Info &_info)
+      {
+        std::vector<Entry> byId;
+        std::vector<Entry> byName;
+        byId.reserve(_info.interfaces.size());
+        byName.reserve(_info.interfaces.size());
+        this->casts.reserve(_info.interfaces.size());
+
+        for (const auto &interface : _info.interfaces)
+        {
+          // interface.first:  name of the interface
+          // interface.second: function which casts the instance pointer to
+          //                   the correct location of the interface within the
+          //                   plugin
+          this->casts.push_back(interface.second);
+          this->interfaceNames.push_back(interface.first);
+          const std::size_t position = this->casts.size();
+
+          byName.push_back(
+                Entry{detail::HashInterfaceName(interface.first),
+                      interface.first, position});
+
+          const auto id = _info.interfaceIds.find(interface.first);
+          if (_info.interfaceIds.end() == id)
+          {
+            this->unidentified = true;
+            continue;
+          }
+
+          byId.push_back(Entry{id->second, interface.first, position});
+        }
+
+        this->ids.Layout(byId);
+        this->names.Layout(byName);
+      }
+
+      /// \brief Get the layout of a plugin. The layout is only made when no
+      /// instance of the plugin which is still alive has made it already.
+      /// \param[in] _info The Info of the plugin
+      /// \return The layout
+      public: static std::shared_ptr<const InterfaceLayout> Of(
+          const Info &_info)
+      {
+        // A layout which has not expired belongs to the Info that is at the
+        // same address, since every instance which keeps the layout alive
+        // also keeps its Info alive. The cache is never destroyed, so that
+        // plugins can still be instantiated while the program exits.
+        struct Cache
+        {
+          std::shared_mutex mutex;
+          std::unordered_map<
+              const Info*, std::weak_ptr<const InterfaceLayout>> layouts;
+          std::size_t pruneAt = 64;
+        };
+        static Cache *const cache = new Cache;
+
+        // The same reasoning holds for the layouts that each thread has used
+        // most recently, so a thread which keeps instantiating the same few
+        // plugins finds their layouts without taking the lock of the cache.
+        struct Recent
+        {
+          const Info *info = nullptr;
+          std::weak_ptr<const InterfaceLayout> layout;
+        };
+        thread_local std::array<Recent, 8> recent;
+        Recent &mine = recent[
+            (reinterpret_cast<std::uintptr_t>(&_info) / alignof(Info)) %
+            recent.size()];
+
+        if (mine.info == &_info)
+        {
+          if (auto layout = mine.layout.lock())
+            return layout;
+        }
+
+        {
+          std::shared_lock<std::shared_mutex> lock(cache->mutex);
+          const auto it = cache->layouts.find(&_info);
+          if (cache->layouts.end() != it)
+          {
+            if (auto layout = it->second.lock())
+            {
+              mine = Recent{&_info, layout};
+              return layout;
+            }
+          }
+        }
+
+        auto layout = std::make_shared<const InterfaceLayout>(_info);
+
+        std::unique_lock<std::shared_mutex> lock(cache->mutex);
+        std::weak_ptr<const InterfaceLayout> &entry = cache->layouts[&_info];
+        if (auto existing = entry.lock())
+        {
+          mine = Recent{&_info, existing};
+          return existing;
+        }
+
+        entry = layout;
+        mine = Recent{&_info, layout};
+
+        // Drop the entries of plugins which have no instances anymore,
+        // whenever the map has doubled in size since it was last pruned
+        if (cache->layouts.size() >= cache->pruneAt)
+        {
+          for (auto it = cache->layouts.begin(); it != cache->layouts.end();)
+          {
+            if (it->second.expired())
+              it = cache->layouts.erase(it);
+            else
+              ++it;
+          }
+
+          cache->pruneAt = std::max<std::size_t>(
+                64, 2 * cache->layouts.size());
+        }
+
+        return layout;
+      }
+
+      /// \brief Find an interface by its ID
+      /// \param[in] _id The ID of the interface
+      /// \param[in] _name The mangled name of the interface. This is only
+      /// used if the plugin has interfaces which were registered without an
+      /// ID.
+      /// \return The position of the interface plus one, or 0 if the plugin
+      /// does not provide it
+      public: std::size_t Find(const std::uint64_t _id,
+                               std::string_view _name) const
+      {
+        if (const std::size_t position = this->ids.Find(
+              _id, [](const Entry &) { return true; }))
+        {
+          return position;
+        }
+
+        if (!this->unidentified)
+          return 0;
+
+        return this->FindByName(_name);
+      }
+
+      /// \brief Find an interface by its mangled name
+      /// \param[in] _name The mangled name of the interface
+      /// \return The position of the interface plus one, or 0 if the plugin
+      /// does not provide it
+      public: std::size_t FindByName(std::string_view _name) const
+      {
+        return this->names.Find(
+              detail::HashInterfaceName(_name),
+              [_name](const Entry &_entry) { return _entry.name == _name; });
+      }
+
+      /// \brief The functions which cast an instance to each interface
+      public: std::vector<Info::InterfaceCaster> casts;
+
+      /// \brief The mangled names of the interfaces, in the order of `casts`.
+      /// These view the keys of Info::interfaces, like Entry::name.
+      public: std::vector<std::string_view> interfaceNames;
+
+      /// \brief The interfaces which have an ID, indexed by it
+      private: Index ids;
+
+      /// \brief Every interface, indexed by the hash of its mangled name
+      private: Index names;
+
+      /// \brief True if some interfaces of the plugin have no ID
+      private: bool unidentified = false;
+    };
+
+    /// \brief The locations of the interfaces within a plugin instance. All
+    /// copies of a Plugin that refer to the same plugin instance share one
+    /// table. The instance is only cast to an interface when the interface
+    /// is first looked up, and the location is remembered for every later
+    /// lookup, so a plugin with many interfaces costs no more to instantiate
+    /// than one with a single interface.
+    ///
+    /// A table which is built while calls are being profiled hands out the
+    /// proxies of IGNITION_PLUGIN_PROFILE_INTERFACE in place of the
+    /// interfaces that have one, see SetCallProfiling().
+    struct InterfaceTable
+    {
+      /// \brief Prepare the table for a plugin instance, in storage which
+      /// lives exactly as long as the table
+      /// \param[in] _info The Info of the plugin
+      /// \param[in] _layout The layout of the plugin, see InterfaceLayout::Of
+      /// \param[in] _instance The plugin instance
+      /// \param[in] _storage Room for one location per interface of the
+      /// plugin, i.e. _layout->casts.size() of them
+      public: void Build(const Info &_info,
+                         std::shared_ptr<const InterfaceLayout> _layout,
+                         void *_instance,
+                         void *_storage)
+      {
+        this->layout = std::move(_layout);
+        this->instance = _instance;
+        this->locations = static_cast<std::atomic<void*>*>(_storage);
+        for (std::size_t i = 0; i < this->layout->casts.size(); ++i)
+          new (&this->locations[i]) std::atomic<void*>(nullptr);
+
+        if (detail::ProfileNewInstances())
+        {
+          this->pluginName = &_info.name;
+          this->proxies.reset(
+                new std::shared_ptr<void>[this->layout->casts.size()]);
+        }
+      }
+
+      /// \brief Prepare the table for a plugin instance, allocating its own
+      /// storage for the locations of the interfaces
+      /// \param[in] _info The Info of the plugin
+      /// \param[in] _instance The plugin instance
+      public: void Build(const Info &_info, void *_instance)
+      {
+        std::shared_ptr<const InterfaceLayout> layoutOfInfo =
+            InterfaceLayout::Of(_info);
+        this->ownedLocations.reset(
+              new std::atomic<void*>[layoutOfInfo->casts.size()]());
+        this->Build(_info, std::move(layoutOfInfo), _instance,
+                    this->ownedLocations.get());
+      }
+
+      /// \brief Find an interface by its ID
+      /// \param[in] _id The ID of the interface
+      /// \param[in] _name The mangled name of the interface. This is only
+      /// used if the plugin has interfaces which were registered without an
+      /// ID.
+      /// \return The location of the interface, or nullptr if the plugin does
+      /// not provide it
+      public: void *Find(const std::uint64_t _id,
+                         std::string_view _name) const
+      {
+        return this->Locate(this->layout->Find(_id, _name));
+      }
+
+      /// \brief Find an interface by its mangled name
+      /// \param[in] _name The mangled name of the interface
+      /// \return The location of the interface, or nullptr if the plugin does
+      /// not provide it
+      public: void *FindByName(std::string_view _name) const
+      {
+        return this->Locate(this->layout->FindByName(_name));
+      }
+
+      /// \brief Get the location of an interface, casting the instance to it
+      /// if this is the first time that it is needed
+      /// \param[in] _position The position of the interface plus one, or 0
+      /// \return The location of the interface, or nullptr if _position is 0
+      private: void *Locate(const std::size_t _position) const
+      {
+        if (0 == _position)
+          return nullptr;
+
+        std::atomic<void*> &location = this->locations[_position - 1];
+        void *interface = location.load(std::memory_order_acquire);
+        if (!interface)
+        {
+          // Casting always gives the same location, so it does not matter
+          // if several threads happen to do it at once.
+          interface = this->layout->casts[_position - 1](this->instance);
+          if (this->proxies)
+            return this->Proxy(_position, interface);
+
+          location.store(interface, std::memory_order_release);
+        }
+
+        return interface;
+      }
+
+      /// \brief Put the proxy of an interface in place of the interface, if
+      /// it has one
+      /// \param[in] _position The position of the interface plus one
+      /// \param[in] _interface The location of the interface
+      /// \return The location which the table hands out for the interface
+      private: void *Proxy(const std::size_t _position,
+                           void *_interface) const
+      {
+        std::shared_ptr<void> proxy = detail::MakeProxy(
+              *this->pluginName, this->layout->interfaceNames[_position - 1],
+              _interface);
+        void *const handedOut = proxy ? proxy.get() : _interface;
+
+        // Unlike the interface itself, each proxy is a new object, so only
+        // the first one that is made gets handed out.
+        void *expected = nullptr;
+        if (!this->locations[_position - 1].compare_exchange_strong(
+              expected, handedOut, std::memory_order_acq_rel))
+        {
+          return expected;
+        }
+
+        this->proxies[_position - 1] = std::move(proxy);
+        return handedOut;
+      }
+
+      /// \brief Where to find the interfaces of the plugin
+      private: std::shared_ptr<const InterfaceLayout> layout;
+
+      /// \brief The plugin instance
+      private: void *instance = nullptr;
+
+      /// \brief The locations of the interfaces which have been looked up so
+      /// far, in the order of InterfaceLayout::casts. The rest are nullptr.
+      /// These usually live in the same allocation as the plugin instance.
+      private: std::atomic<void*> *locations = nullptr;
+
+      /// \brief The storage of `locations`, if the table had to allocate it
+      /// by itself
+      private: std::unique_ptr<std::atomic<void*>[]> ownedLocations;
+
+      /// \brief The name of the plugin, if the table hands out proxies
+      private: const std::string *pluginName = nullptr;
+
+      /// \brief The proxies which the table has handed out, in the order of
+      /// InterfaceLayout::casts, or nullptr if it hands out no proxies
+      private: std::unique_ptr<std::shared_ptr<void>[]> proxies;
+    };
+
     /// \brief Struct which wraps a plugin instance together with a
     /// std::shared_ptr to its shared library handle. Instantiating plugin
     /// instances into this struct ensures that the shared library will remain
@@ -35,21 +535,50 @@ namespace ignition
       /// \brief Constructor
       public: PluginWithDlHandle(
         void *_loadedInstance,
-        const std::function<void(void*)> &_deleter,
+        const Info::DeleterFunction _deleter,
+        const ConstInfoPtr &_info,
         const std::shared_ptr<void> &_dlHandlePtr)
         : dlHandlePtr(_dlHandlePtr),
+          info(_info),
           loadedInstance(_loadedInstance),
           deleter(_deleter)
       {
         // Do nothing
       }
 
+      /// \brief Constructor which constructs the plugin instance in storage
+      /// that has already been allocated for it.
+      /// \param[in] _info The Info of the plugin
+      /// \param[in] _storage Points to the location of the storage. This is
+      /// read when the constructor runs, which is after std::allocate_shared
+      /// has allocated the storage.
+      /// \param[in] _dlHandlePtr The handle of the library of the plugin
+      public: PluginWithDlHandle(
+        const ConstInfoPtr &_info,
+        void *const *_storage,
+        const std::shared_ptr<void> &_dlHandlePtr)
+        : dlHandlePtr(_dlHandlePtr),
+          info(_info),
+          loadedInstance(_info->construct(*_storage)),
+          deleter(nullptr),
+          destruct(_info->destruct)
+      {
+        // Do nothing
+      }
+
       /// \brief Destructor. We call the deleter on the loadedInstance while the
       /// deleter and dlHandlePtr are still valid and available.
       public: ~PluginWithDlHandle()
       {
         if (loadedInstance)
         {
+          if (destruct)
+          {
+            // The storage of the instance is released along with this object
+            destruct(loadedInstance);
+            return;
+          }
+
           if (!deleter)
           {
             // LCOV_EXCL_START
@@ -78,18 +607,27 @@ namespace ignition
       /// \brief A reference counting handle for the shared library that this
       /// plugin depends on.
       ///
-      /// CRUCIAL DEV NOTE (MXG): `dlHandlePtr` MUST come BEFORE `deleter` in
-      /// this class definition to ensure that `deleter` gets deleted first
-      /// (member variables get destructed in the reverse order of their
-      /// appearance in the class definition). The destructor of `deleter`
-      /// depends on the shared library still being available, so this reference
-      /// counting handle must be destroyed after `deleter` to ensure that the
-      /// library is still loaded when `deleter` needs it.
+      /// CRUCIAL DEV NOTE (MXG): `dlHandlePtr` MUST come BEFORE `deleter` and
+      /// `destruct` in this class definition to ensure that they get deleted
+      /// first (member variables get destructed in the reverse order of their
+      /// appearance in the class definition). `deleter` and `destruct` point
+      /// into the shared library, so this reference counting handle must be
+      /// destroyed after them to ensure that the library is still loaded when
+      /// they are needed.
       ///
       /// If you change this class definition for ANY reason, be sure to
       /// maintain the ordering of these member variables.
       public: std::shared_ptr<void> dlHandlePtr;
 
+      /// \brief The Info of the plugin. Keeping it here means that anything
+      /// which keeps the instance alive, e.g. a std::weak_ptr to it that has
+      /// been locked, also keeps its Info alive.
+      ///
+      /// CRUCIAL DEV NOTE: `info` MUST come AFTER `dlHandlePtr` in this
+      /// class definition, because the destructor of Info depends on the
+      /// library. See the comment on `dlHandlePtr` for an explanation.
+      public: ConstInfoPtr info;
+
       /// \brief Pointer to the plugin instance
       public: void *loadedInstance;
 
@@ -101,26 +639,164 @@ namespace ignition
       ///
       /// If you change this class definition for ANY reason, be sure to
       /// maintain the ordering of these member variables.
-      public: std::function<void(void*)> deleter;
+      public: Info::DeleterFunction deleter;
+
+      /// \brief Destructor function for a plugin instance which lives in the
+      /// same allocation as this object. This is null when the instance was
+      /// made by the factory of the plugin instead.
+      ///
+      /// CRUCIAL DEV NOTE: `destruct` MUST come AFTER `dlHandlePtr` in
+      /// this class definition. See the comment on `dlHandlePtr` for an
+      /// explanation.
+      ///
+      /// If you change this class definition for ANY reason, be sure to
+      /// maintain the ordering of these member variables.
+      public: Info::DestructFunction destruct = nullptr;
+
+      /// \brief The interfaces of the plugin instance. Keeping the table in
+      /// the same block of memory as the instance lets every copy of a Plugin
+      /// share it without an extra allocation.
+      public: InterfaceTable interfaces;
     };
 
+    /// \brief An allocator for std::allocate_shared which reserves storage
+    /// for a plugin instance and for the locations of its interfaces behind
+    /// the object that it allocates. This lets the plugin instance, its
+    /// PluginWithDlHandle, its interface table and the control block of the
+    /// std::shared_ptr live in a single allocation.
+    template <typename T>
+    struct InstanceStorageAllocator
+    {
+      public: using value_type = T;
+
+      /// \brief Constructor
+      /// \param[in] _size The size of the plugin instance, or 0 if the
+      /// instance is made somewhere else
+      /// \param[in] _alignment The alignment of the plugin instance
+      /// \param[in] _interfaces The number of interfaces of the plugin
+      /// \param[out] _storage Receives the location of the storage for the
+      /// plugin instance when the allocation is made
+      /// \param[out] _locations Receives the location of the storage for the
+      /// locations of the interfaces when the allocation is made
+      /// \param[in] _resource The memory resource to allocate from, or
+      /// nullptr to use the default heap
+      public: InstanceStorageAllocator(
+        const std::size_t _size,
+        const std::size_t _alignment,
+        const std::size_t _interfaces,
+        void **_storage,
+        void **_locations,
+        std::pmr::memory_resource *_resource)
+        : size(_size),
+          alignment(std::max(_alignment, alignof(std::max_align_t))),
+          interfaces(_interfaces),
+          storage(_storage),
+          locations(_locations),
+          resource(_resource)
+      {
+        // Do nothing
+      }
+
+      /// \brief Rebinding constructor
+      public: template <typename U>
+      InstanceStorageAllocator(const InstanceStorageAllocator<U> &_other)
+        : size(_other.size),
+          alignment(_other.alignment),
+          interfaces(_other.interfaces),
+          storage(_other.storage),
+          locations(_other.locations),
+          resource(_other.resource)
+      {
+        // Do nothing
+      }
+
+      /// \brief Allocate the objects together with the instance storage
+      public: T *allocate(const std::size_t _n)
+      {
+        const std::size_t bytes = this->Bytes(_n);
+        char *block = static_cast<char*>(this->resource ?
+              this->resource->allocate(bytes, this->alignment) :
+              ::operator new(bytes, std::align_val_t(this->alignment)));
+        *this->storage = block + this->Offset(_n);
+        *this->locations = block + this->LocationsOffset(_n);
+        return reinterpret_cast<T*>(block);
+      }
+
+      /// \brief Release an allocation made by allocate()
+      public: void deallocate(T *_p, const std::size_t _n)
+      {
+        if (this->resource)
+        {
+          this->resource->deallocate(_p, this->Bytes(_n), this->alignment);
+        }
+        else
+        {
+          ::operator delete(_p, std::align_val_t(this->alignment));
+        }
+      }
+
+      /// \brief The offset of the instance storage within the allocation
+      private: std::size_t Offset(const std::size_t _n) const
+      {
+        const std::size_t bytes = _n * sizeof(T);
+        return (bytes + this->alignment - 1) / this->alignment
+            * this->alignment;
+      }
+
+      /// \brief The offset of the locations of the interfaces within the
+      /// allocation, which follow the instance storage
+      private: std::size_t LocationsOffset(const std::size_t _n) const
+      {
+        constexpr std::size_t locationAlignment = alignof(std::atomic<void*>);
+        return (this->Offset(_n) + this->size + locationAlignment - 1)
+            / locationAlignment * locationAlignment;
+      }
+
+      /// \brief The size of the whole allocation
+      private: std::size_t Bytes(const std::size_t _n) const
+      {
+        return this->LocationsOffset(_n)
+            + this->interfaces * sizeof(std::atomic<void*>);
+      }
+
+      public: std::size_t size;
+      public: std::size_t alignment;
+      public: std::size_t interfaces;
+      public: void **storage;
+      public: void **locations;
+      public: std::pmr::memory_resource *resource;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const InstanceStorageAllocator<T> &_lhs,
+                    const InstanceStorageAllocator<U> &_rhs)
+    {
+      return _lhs.size == _rhs.size && _lhs.alignment == _rhs.alignment
+          && _lhs.interfaces == _rhs.interfaces
+          && _lhs.resource == _rhs.resource;
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const InstanceStorageAllocator<T> &_lhs,
+                    const InstanceStorageAllocator<U> &_rhs)
+    {
+      return !(_lhs == _rhs);
+    }
+
     class Plugin::Implementation
     {
-      /// \brief Clear this object without invaliding any map entry
-      /// iterators.
+      /// \brief Clear this object without forgetting any of its interface
+      /// slots.
       public: void Clear()
       {
         this->loadedInstancePtr.reset();
+        this->table.reset();
         this->info.reset();
 
-        // Dev note (MXG): We must NOT call clear() on the InterfaceMap or
-        // remove ANY of the map entries, because that would potentially
-        // invalidate all of the iterators that are pointing to map entries.
-        // This would break any specialized plugins that provide instant access
-        // to specialized interfaces. Instead, we simply overwrite the map
-        // entries with a nullptr.
-        for (auto &entry : this->interfaces)
-          entry.second = nullptr;
+        // The slots belong to the specialized plugins which are built on top
+        // of this object, so they stay linked, and only their locations are
+        // overwritten with a nullptr.
+        this->RefreshInterfaces();
       }
 
       /// \brief Initialize this object by creating a new plugin instance from
@@ -128,15 +804,25 @@ namespace ignition
       /// \param[in] _info Information describing the plugin to initialize
       /// \param[in] _dlHandlePtr A reference to the dl handle that manages the
       ///            lifecycle of the plugin library.
+      /// \param[in] _resource The memory resource which provides the storage
+      ///            of the plugin instance, or nullptr to use the default heap.
+      ///            A plugin which cannot be constructed into provided storage
+      ///            only gets its reference count from the resource.
+      /// \param[in] _instance An instance of the plugin which has already been
+      ///            made by one of its Info::constructors, or nullptr to make
+      ///            a new one. This object takes ownership of the instance.
       public: void Create(
           const ConstInfoPtr &_info,
-          const std::shared_ptr<void> &_dlHandlePtr)
+          const std::shared_ptr<void> &_dlHandlePtr,
+          std::pmr::memory_resource *_resource = nullptr,
+          void *_instance = nullptr)
       {
         this->Clear();
 
         if (!_info)
           return;
 
+        detail::TraceScope trace("Create", _info->name);
         this->info = _info;
 
         if (!_dlHandlePtr)
@@ -152,10 +838,38 @@ namespace ignition
 
         // Create a std::shared_ptr to a struct which ensures that the
         // _dlHandlePtr will remain alive for as long as this plugin instance
-        // exists.
-        std::shared_ptr<PluginWithDlHandle> pluginWithDlHandle =
-            std::make_shared<PluginWithDlHandle>(
-              _info->factory(), _info->deleter, _dlHandlePtr);
+        // exists. When the plugin can be constructed into storage that we
+        // provide, the instance goes into the same allocation as that struct
+        // and the control block of the std::shared_ptr. The locations of its
+        // interfaces always go into that allocation.
+        std::shared_ptr<const InterfaceLayout> layout =
+            InterfaceLayout::Of(*_info);
+        void *locations = nullptr;
+
+        std::shared_ptr<PluginWithDlHandle> pluginWithDlHandle;
+        if (!_instance && _info->construct && _info->destruct)
+        {
+          void *storage = nullptr;
+          pluginWithDlHandle = std::allocate_shared<PluginWithDlHandle>(
+                InstanceStorageAllocator<PluginWithDlHandle>(
+                  _info->instanceSize, _info->instanceAlignment,
+                  layout->casts.size(), &storage, &locations, _resource),
+                _info, &storage, _dlHandlePtr);
+        }
+        else
+        {
+          void *unused = nullptr;
+          pluginWithDlHandle = std::allocate_shared<PluginWithDlHandle>(
+                InstanceStorageAllocator<PluginWithDlHandle>(
+                  0, alignof(PluginWithDlHandle), layout->casts.size(),
+                  &unused, &locations, _resource),
+                _instance ? _instance : _info->factory(), _info->deleter,
+                _info, _dlHandlePtr);
+        }
+
+        pluginWithDlHandle->interfaces.Build(
+              *_info, std::move(layout), pluginWithDlHandle->loadedInstance,
+              locations);
 
         // Use the aliasing constructor of std::shared_ptr to disguise
         // pluginWithDlHandle as just a simple std::shared_ptr<void> which
@@ -167,23 +881,20 @@ namespace ignition
               pluginWithDlHandle,
               pluginWithDlHandle->loadedInstance);
 
-        for (const auto &entry : _info->interfaces)
-        {
-          // entry.first:  name of the interface
-          // entry.second: function which casts the loadedInstance pointer to
-          //               the correct location of the interface within the
-          //               plugin
-          this->interfaces[entry.first] =
-              entry.second(this->loadedInstancePtr.get());
-        }
+        // The interface table is disguised in the same way, so it stays alive
+        // for as long as the plugin instance does.
+        this->table =
+            std::shared_ptr<const InterfaceTable>(
+              pluginWithDlHandle,
+              &pluginWithDlHandle->interfaces);
+
+        this->RefreshInterfaces();
       }
 
       /// \brief Initialize this object using another instance
       /// \param[in] _other Another instance of a Plugin::Implementation object
       public: void Copy(const Implementation *_other)
       {
-        this->Clear();
-
         if (!_other)
         {
           // LCOV_EXCL_START
@@ -192,23 +903,19 @@ namespace ignition
                     << "should not be possible! Please report this bug."
                     << std::endl;
           assert(false);
+          this->Clear();
           return;
           // LCOV_EXCL_STOP
         }
 
         this->loadedInstancePtr = _other->loadedInstancePtr;
+        this->table = _other->table;
         this->info = _other->info;
 
-        if (this->loadedInstancePtr)
-        {
-          for (const auto &entry : _other->interfaces)
-          {
-            // entry.first:  name of the interface
-            // entry.second: pointer to the location of that interface within
-            //               the plugin instance
-            this->interfaces[entry.first] = entry.second;
-          }
-        }
+        // The table is shared with _other, so we only need to update the
+        // slots of the specialized interfaces, and any slot which _other has
+        // as well already holds the right location.
+        this->RefreshInterfaces(_other);
       }
 
       /// \brief Initialize this object using another instance
@@ -216,12 +923,27 @@ namespace ignition
       ///   A reference to the plugin's Info
       /// \param[in] _instance
       ///   A reference to the plugin's abstact instance
+      /// \param[in] _table
+      ///   The interface table of the instance, which must be owned by the
+      ///   control block of _instance, or nullptr to build a new table
       public: void Copy(const ConstInfoPtr &_info,
-                        const std::shared_ptr<void> &_instance)
+                        const std::shared_ptr<void> &_instance,
+                        const InterfaceTable *_table = nullptr)
       {
         this->loadedInstancePtr = _instance;
+        this->table.reset();
         this->info = _info;
 
+        if (this->loadedInstancePtr && _table)
+        {
+          // The table lives as long as the instance does, so it can be shared
+          // instead of casting the instance to each interface again.
+          this->table = std::shared_ptr<const InterfaceTable>(
+                this->loadedInstancePtr, _table);
+          this->RefreshInterfaces();
+          return;
+        }
+
         if (this->loadedInstancePtr)
         {
           if (!this->info)
@@ -237,36 +959,111 @@ namespace ignition
             // LCOV_EXCL_STOP
           }
 
-          // We need to construct the interface map for this Plugin
-          for (const auto &entry : this->info->interfaces)
+          // We do not have access to the table of the plugin instance, so we
+          // need to construct a new one for this Plugin.
+          std::shared_ptr<InterfaceTable> newTable =
+              std::make_shared<InterfaceTable>();
+          newTable->Build(*this->info, this->loadedInstancePtr.get());
+          this->table = std::move(newTable);
+        }
+
+        this->RefreshInterfaces();
+      }
+
+      /// \brief Find an interface of the plugin instance
+      /// \param[in] _id The ID of the interface
+      /// \param[in] _interfaceName The mangled name of the interface
+      /// \return A pointer to the interface, or nullptr if this object does
+      /// not hold a plugin instance which provides it
+      public: void *Find(const std::uint64_t _id,
+                         std::string_view _interfaceName) const
+      {
+        if (!this->table)
+          return nullptr;
+
+        return this->table->Find(_id, _interfaceName);
+      }
+
+      /// \brief Find an interface of the plugin instance by its name alone
+      /// \param[in] _interfaceName The mangled name of the interface
+      /// \return A pointer to the interface, or nullptr if this object does
+      /// not hold a plugin instance which provides it
+      public: void *FindByName(std::string_view _interfaceName) const
+      {
+        if (!this->table)
+          return nullptr;
+
+        return this->table->FindByName(_interfaceName);
+      }
+
+      /// \brief Update the slots of the specialized interfaces to match the
+      /// current interface table.
+      /// \param[in] _source Another object which shares the interface table
+      /// of this one, whose slots are reused where they are for the same
+      /// interfaces, or nullptr to look every interface up in the table.
+      public: void RefreshInterfaces(const Implementation *_source = nullptr)
+      {
+        for (detail::InterfaceSlot *slot = this->interfaceSlots; slot;
+             slot = slot->next)
+        {
+          if (!_source || !_source->Known(slot->id, slot->location))
+            slot->location = this->Find(slot->id, slot->name);
+        }
+
+        for (std::size_t i = 0; i < this->slotCount; ++i)
+        {
+          if (!_source || !_source->Known(this->slotIds[i], this->slots[i]))
+            this->slots[i] = this->Find(this->slotIds[i], this->slotNames[i]);
+        }
+      }
+
+      /// \brief Get the location of an interface from the slots of this
+      /// object, if it has a slot for the interface
+      /// \param[in] _id The ID of the interface
+      /// \param[out] _location Receives the location of the interface
+      /// \return True if this object has a slot for the interface
+      public: bool Known(const std::uint64_t _id, void *&_location) const
+      {
+        for (const detail::InterfaceSlot *slot = this->interfaceSlots; slot;
+             slot = slot->next)
+        {
+          if (slot->id == _id)
+          {
+            _location = slot->location;
+            return true;
+          }
+        }
+
+        for (std::size_t i = 0; i < this->slotCount; ++i)
+        {
+          if (this->slotIds[i] == _id)
           {
-            // entry.first:  name of the interface
-            // entry.second: function which casts the loadedInstance pointer to
-            //               the correct location of the interface within the
-            //               plugin
-            this->interfaces[entry.first] =
-                entry.second(this->loadedInstancePtr.get());
+            _location = this->slots[i];
+            return true;
           }
         }
+
+        return false;
       }
 
-      /// \brief Map from interface names to their locations within the plugin
-      /// instance
-      //
-      // Dev Note (MXG): We use std::map here instead of std::unordered_map
-      // because iterators to a std::map are not invalidated by the insertion
-      // operation (whereas all iterators to a std::unordered_map are
-      // potentially invalidated each time an insertion is performed on the
-      // std::unordered_map). Holding onto valid iterators allows us to do
-      // optimizations with template magic to provide direct access to
-      // interfaces whose availability we can anticipate at run time.
-      //
-      // It is also worth noting that ordered vs unordered lookup time is very
-      // similar on sets where the strings have relatively small lengths (5-20
-      // characters) and a relatively small number of entries in the set (5-20
-      // entries). Those conditions match our expected use case here. In fact,
-      // ordered lookup can sometimes outperform unordered in these conditions.
-      public: Plugin::InterfaceMap interfaces;
+      /// \brief The slots of the specialized interfaces of a SpecializedPlugin,
+      /// which are linked through InterfaceSlot::next. The slots live inside
+      /// the SpecializedPlugin itself, so adding one never allocates, and
+      /// each of them gives instant access to its interface.
+      public: detail::InterfaceSlot *interfaceSlots = nullptr;
+
+      /// \brief An array of the interfaces of a FlatSpecializedPlugin, which
+      /// is refreshed together with `interfaces`
+      public: void **slots = nullptr;
+
+      /// \brief The IDs of the interfaces in `slots`
+      public: const std::uint64_t *slotIds = nullptr;
+
+      /// \brief The mangled names of the interfaces in `slots`
+      public: const std::string_view *slotNames = nullptr;
+
+      /// \brief The number of entries in `slots`
+      public: std::size_t slotCount = 0;
 
       /// \brief shared_ptr which manages the lifecycle of the plugin instance.
       ///
@@ -282,6 +1079,14 @@ namespace ignition
       /// maintain the ordering of these member variables.
       public: std::shared_ptr<void> loadedInstancePtr;
 
+      /// \brief The interfaces of the plugin instance, shared by every Plugin
+      /// that refers to the same instance. This usually shares ownership of
+      /// the plugin instance with `loadedInstancePtr`.
+      ///
+      /// CRUCIAL DEV NOTE: `table` must come BEFORE `info` in this class
+      /// definition, for the same reason as `loadedInstancePtr`.
+      public: std::shared_ptr<const InterfaceTable> table;
+
       /// \brief A copy of the Info that was used to create the Plugin
       ///
       /// CRUCIAL DEV NOTE (MXG): `info` must come AFTER `loadedInstancePtr` in
@@ -295,7 +1100,7 @@ namespace ignition
 
     //////////////////////////////////////////////////
     bool Plugin::HasInterface(
-        const std::string &_interfaceName,
+        std::string_view _interfaceName,
         const bool _demangled) const
     {
       const ConstInfoPtr &info = this->dataPtr->info;
@@ -304,10 +1109,11 @@ namespace ignition
 
       if (_demangled)
       {
-        return (info->demangledInterfaces.count(_interfaceName) != 0);
+        return (info->demangledInterfaces.end() !=
+                info->demangledInterfaces.find(_interfaceName));
       }
 
-      return (this->dataPtr->interfaces.count(_interfaceName) != 0);
+      return (nullptr != this->PrivateQueryInterface(_interfaceName));
     }
 
     //////////////////////////////////////////////////
@@ -328,13 +1134,17 @@ namespace ignition
 
     //////////////////////////////////////////////////
     void *Plugin::PrivateQueryInterface(
-        const std::string &_interfaceName) const
+        std::string_view _interfaceName) const
     {
-      const auto &it = this->dataPtr->interfaces.find(_interfaceName);
-      if (this->dataPtr->interfaces.end() == it)
-        return nullptr;
+      return this->dataPtr->FindByName(_interfaceName);
+    }
 
-      return it->second;
+    //////////////////////////////////////////////////
+    void *Plugin::PrivateQueryInterface(
+        const std::uint64_t _id,
+        std::string_view _interfaceName) const
+    {
+      return this->dataPtr->Find(_id, _interfaceName);
     }
 
     //////////////////////////////////////////////////
@@ -346,9 +1156,11 @@ namespace ignition
     //////////////////////////////////////////////////
     void Plugin::PrivateCopyPluginInstance(
         const ConstInfoPtr &_info,
-        const std::shared_ptr<void> &_instancePtr) const
+        const std::shared_ptr<void> &_instancePtr,
+        const void *_table) const
     {
-      this->dataPtr->Copy(_info, _instancePtr);
+      this->dataPtr->Copy(
+            _info, _instancePtr, static_cast<const InterfaceTable*>(_table));
     }
 
     //////////////////////////////////////////////////
@@ -359,6 +1171,42 @@ namespace ignition
       this->dataPtr->Create(_info, _dlHandlePtr);
     }
 
+    //////////////////////////////////////////////////
+    void Plugin::PrivateCreatePluginInstance(
+        const ConstInfoPtr &_info,
+        const std::shared_ptr<void> &_dlHandlePtr,
+        std::pmr::memory_resource *_resource) const
+    {
+      this->dataPtr->Create(_info, _dlHandlePtr, _resource);
+    }
+
+    //////////////////////////////////////////////////
+    void Plugin::PrivateAdoptPluginInstance(
+        const ConstInfoPtr &_info,
+        const std::shared_ptr<void> &_dlHandlePtr,
+        void *_instance,
+        std::pmr::memory_resource *_resource) const
+    {
+      this->dataPtr->Create(_info, _dlHandlePtr, _resource, _instance);
+    }
+
+    //////////////////////////////////////////////////
+    const void *Plugin::PrivateGetSharedInterfaceTable() const
+    {
+      const std::shared_ptr<const InterfaceTable> &table =
+          this->dataPtr->table;
+      const std::shared_ptr<void> &instance = this->dataPtr->loadedInstancePtr;
+
+      // Neither owner precedes the other only if they share a control block
+      if (!table || table.owner_before(instance) ||
+          instance.owner_before(table))
+      {
+        return nullptr;
+      }
+
+      return table.get();
+    }
+
     //////////////////////////////////////////////////
     const std::shared_ptr<void> &Plugin::PrivateGetInstancePtr() const
     {
@@ -372,13 +1220,37 @@ namespace ignition
     }
 
     //////////////////////////////////////////////////
-    Plugin::InterfaceMap::iterator Plugin::PrivateGetOrCreateIterator(
-        const std::string &_interfaceName)
+    EnablePluginFromThis *Plugin::PrivateGetEnablePluginFromThis() const
+    {
+      const ConstInfoPtr &info = this->dataPtr->info;
+      void *const instance = this->dataPtr->loadedInstancePtr.get();
+      if (!info || !info->enablePluginFromThis || !instance)
+        return nullptr;
+
+      return static_cast<EnablePluginFromThis*>(
+            info->enablePluginFromThis(instance));
+    }
+
+    //////////////////////////////////////////////////
+    void Plugin::PrivateAddInterfaceSlot(detail::InterfaceSlot *_slot)
+    {
+      _slot->location = this->dataPtr->Find(_slot->id, _slot->name);
+      _slot->next = this->dataPtr->interfaceSlots;
+      this->dataPtr->interfaceSlots = _slot;
+    }
+
+    //////////////////////////////////////////////////
+    void Plugin::PrivateSetInterfaceSlots(
+        void **_slots,
+        const std::uint64_t *_ids,
+        const std::string_view *_names,
+        const std::size_t _count)
     {
-      // We want to use the insert function here to avoid accidentally
-      // overwriting a value which might exist at the desired map key.
-      return this->dataPtr->interfaces.insert(
-            std::make_pair(_interfaceName, nullptr)).first;
+      this->dataPtr->slots = _slots;
+      this->dataPtr->slotIds = _ids;
+      this->dataPtr->slotNames = _names;
+      this->dataPtr->slotCount = _slots ? _count : 0;
+      this->dataPtr->RefreshInterfaces();
     }
 
     //////////////////////////////////////////////////
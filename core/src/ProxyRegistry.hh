@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_SRC_PROXYREGISTRY_HH_
+#define IGNITION_PLUGIN_SRC_PROXYREGISTRY_HH_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      /// \brief Check whether plugin instances which are being created should
+      /// hand out the proxies of IGNITION_PLUGIN_PROFILE_INTERFACE, i.e.
+      /// whether profiling is on and any proxy is registered
+      /// \return True if new instances should hand out proxies
+      bool ProfileNewInstances();
+
+      /// \brief Create the proxy of an interface of a plugin instance
+      /// \param[in] _plugin The name of the plugin
+      /// \param[in] _interface The mangled name of the interface
+      /// \param[in] _target The interface of the plugin instance
+      /// \return The proxy, pointing at its interface, or nullptr if the
+      /// interface has no proxy
+      std::shared_ptr<void> MakeProxy(
+          const std::string &_plugin,
+          std::string_view _interface,
+          void *_target);
+    }
+  }
+}
+
+#endif
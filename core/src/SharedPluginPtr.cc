@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <ignition/plugin/SharedPluginPtr.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace
+    {
+      /// \brief The most shards that an instance gets, to bound the memory
+      /// of each block on machines with very many hardware threads
+      constexpr std::size_t kMaxShards = 256;
+
+      /// \brief The size of a cache line, which is not the same as
+      /// std::hardware_destructive_interference_size on every toolchain, but
+      /// is right for the common ones
+      constexpr std::size_t kCacheLineSize = 64;
+
+      /// \brief One part of the reference count of an instance. Each shard
+      /// has a cache line of its own, so that threads which count in
+      /// different shards never contend.
+      struct alignas(kCacheLineSize) Shard
+      {
+        std::atomic<std::size_t> count{0};
+      };
+
+      /////////////////////////////////////////////////
+      /// \brief Compute the number of shards, which is the smallest power of
+      /// two that gives every hardware thread a shard of its own
+      std::size_t ComputeShardCount()
+      {
+        const std::size_t threads =
+            std::max(1u, std::thread::hardware_concurrency());
+
+        std::size_t count = 1;
+        while (count < threads && count < kMaxShards)
+          count *= 2;
+
+        return count;
+      }
+
+      /////////////////////////////////////////////////
+      /// \brief Get the shard of the calling thread. Threads are numbered in
+      /// the order in which they first copy a SharedPluginPtr, so that the
+      /// first ShardCount() threads get distinct shards.
+      std::size_t CurrentThreadShard()
+      {
+        static std::atomic<std::size_t> nextThread{0};
+        thread_local const std::size_t thread =
+            nextThread.fetch_add(1, std::memory_order_relaxed);
+
+        return thread & (SharedPluginPtr::ShardCount() - 1);
+      }
+
+      /////////////////////////////////////////////////
+      /// \brief The PluginPtr of an empty SharedPluginPtr
+      const PluginPtr &EmptyPluginPtr()
+      {
+        static const PluginPtr empty;
+        return empty;
+      }
+    }
+
+    /////////////////////////////////////////////////
+    class SharedPluginPtr::Block
+    {
+      /// \brief Constructor
+      /// \param[in] _plugin The instance to share
+      public: explicit Block(const PluginPtr &_plugin)
+        : plugin(_plugin),
+          shards(new Shard[ShardCount()])
+      {
+        // Do nothing
+      }
+
+      /// \brief The single reference to the instance
+      public: const PluginPtr plugin;
+
+      /// \brief The number of shards whose count is not zero. The block is
+      /// deleted when this drops to zero.
+      ///
+      /// A shard which stops being empty adds itself here before the copy
+      /// which made it non-empty is finished, and the copy was made from a
+      /// live reference, whose own shard is still counted. So this cannot
+      /// drop to zero while any SharedPluginPtr refers to the block.
+      public: std::atomic<std::size_t> activeShards{0};
+
+      /// \brief The shards of the reference count
+      public: const std::unique_ptr<Shard[]> shards;
+    };
+
+    /////////////////////////////////////////////////
+    SharedPluginPtr::SharedPluginPtr()
+      : block(nullptr),
+        plugin(EmptyPluginPtr().operator->()),
+        shard(0)
+    {
+      // Do nothing
+    }
+
+    /////////////////////////////////////////////////
+    SharedPluginPtr::SharedPluginPtr(const PluginPtr &_plugin)
+      : SharedPluginPtr()
+    {
+      if (_plugin)
+        this->PrivateAcquire(new Block(_plugin));
+    }
+
+    /////////////////////////////////////////////////
+    SharedPluginPtr::SharedPluginPtr(const SharedPluginPtr &_other)
+      : SharedPluginPtr()
+    {
+      this->PrivateAcquire(_other.block);
+    }
+
+    /////////////////////////////////////////////////
+    SharedPluginPtr::SharedPluginPtr(SharedPluginPtr &&_other) noexcept
+      : block(_other.block),
+        plugin(_other.plugin),
+        shard(_other.shard)
+    {
+      _other.block = nullptr;
+      _other.plugin = EmptyPluginPtr().operator->();
+    }
+
+    /////////////////////////////////////////////////
+    SharedPluginPtr &SharedPluginPtr::operator=(const SharedPluginPtr &_other)
+    {
+      if (this->block != _other.block)
+      {
+        // Hold on to the old reference until the new one is counted, in
+        // case _other is only kept alive by the old one
+        Block *const newBlock = _other.block;
+        SharedPluginPtr old(std::move(*this));
+        this->PrivateAcquire(newBlock);
+      }
+
+      return *this;
+    }
+
+    /////////////////////////////////////////////////
+    SharedPluginPtr &SharedPluginPtr::operator=(
+        SharedPluginPtr &&_other) noexcept
+    {
+      if (this != &_other)
+      {
+        this->PrivateRelease();
+        std::swap(this->block, _other.block);
+        std::swap(this->plugin, _other.plugin);
+        std::swap(this->shard, _other.shard);
+      }
+
+      return *this;
+    }
+
+    /////////////////////////////////////////////////
+    SharedPluginPtr::~SharedPluginPtr()
+    {
+      this->PrivateRelease();
+    }
+
+    /////////////////////////////////////////////////
+    const PluginPtr &SharedPluginPtr::Get() const
+    {
+      return this->block ? this->block->plugin : EmptyPluginPtr();
+    }
+
+    /////////////////////////////////////////////////
+    void SharedPluginPtr::Clear()
+    {
+      this->PrivateRelease();
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t SharedPluginPtr::ShardCount()
+    {
+      static const std::size_t count = ComputeShardCount();
+      return count;
+    }
+
+    /////////////////////////////////////////////////
+    void SharedPluginPtr::PrivateAcquire(Block *_block)
+    {
+      if (!_block)
+        return;
+
+      const std::size_t index = CurrentThreadShard();
+      if (0 == _block->shards[index].count.fetch_add(
+            1, std::memory_order_acq_rel))
+      {
+        _block->activeShards.fetch_add(1, std::memory_order_acq_rel);
+      }
+
+      this->block = _block;
+      this->plugin = _block->plugin.operator->();
+      this->shard = index;
+    }
+
+    /////////////////////////////////////////////////
+    void SharedPluginPtr::PrivateRelease()
+    {
+      Block *const oldBlock = this->block;
+      if (!oldBlock)
+        return;
+
+      this->block = nullptr;
+      this->plugin = EmptyPluginPtr().operator->();
+
+      if (1 == oldBlock->shards[this->shard].count.fetch_sub(
+            1, std::memory_order_acq_rel)
+          && 1 == oldBlock->activeShards.fetch_sub(
+            1, std::memory_order_acq_rel))
+      {
+        delete oldBlock;
+      }
+    }
+  }
+}
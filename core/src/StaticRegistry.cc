@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+#include <ignition/plugin/StaticRegistry.hh>
+
+namespace
+{
+  /// \brief The registry and the mutex that guards it. Libraries which are
+  /// opened at run time may feed the registry too, so it can be modified
+  /// while a Loader is reading it.
+  struct Registry
+  {
+    std::mutex mutex;
+    ignition::plugin::InfoMap plugins;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Get the registry. It is created on first use, because plugins
+  /// register themselves during static initialization, in no particular
+  /// order relative to the static variables of this library.
+  Registry &GetRegistry()
+  {
+    static Registry registry;
+    return registry;
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      /////////////////////////////////////////////////
+      void RegisterStaticPlugin(const Info &_info)
+      {
+        Registry &registry = GetRegistry();
+        std::unique_lock<std::mutex> lock(registry.mutex);
+
+        InfoMap::iterator it;
+        bool inserted;
+        std::tie(it, inserted) =
+            registry.plugins.insert(std::make_pair(_info.name, _info));
+
+        if (inserted)
+          return;
+
+        // The same plugin may be registered with different interfaces and
+        // aliases in different places, just like in a shared library.
+        Info &entry = it->second;
+
+        for (const auto &interfaceMapEntry : _info.interfaces)
+          entry.interfaces.insert(interfaceMapEntry);
+
+        for (const auto &interfaceIdEntry : _info.interfaceIds)
+          entry.interfaceIds.insert(interfaceIdEntry);
+
+        for (const auto &aliasSetEntry : _info.aliases)
+          entry.aliases.insert(aliasSetEntry);
+
+        entry.dependencies.insert(
+              _info.dependencies.begin(), _info.dependencies.end());
+
+        entry.constructors.insert(
+              _info.constructors.begin(), _info.constructors.end());
+
+        entry.kernelTables.insert(
+              _info.kernelTables.begin(), _info.kernelTables.end());
+      }
+
+      /////////////////////////////////////////////////
+      InfoMap StaticPlugins()
+      {
+        Registry &registry = GetRegistry();
+        std::unique_lock<std::mutex> lock(registry.mutex);
+        return registry.plugins;
+      }
+    }
+  }
+}
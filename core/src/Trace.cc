@@ -0,0 +1,397 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/plugin/Trace.hh>
+
+namespace
+{
+  /////////////////////////////////////////////////
+  /// \brief Write a string as a JSON string literal
+  /// \param[out] _out The stream to write to
+  /// \param[in] _text The string
+  void WriteJsonString(std::ostream &_out, const std::string &_text)
+  {
+    _out << '"';
+    for (const char c : _text)
+    {
+      switch (c)
+      {
+        case '"': _out << "\\\""; break;
+        case '\\': _out << "\\\\"; break;
+        case '\n': _out << "\\n"; break;
+        case '\t': _out << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20)
+          {
+            _out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                 << static_cast<int>(c) << std::dec << std::setfill(' ');
+          }
+          else
+          {
+            _out << c;
+          }
+      }
+    }
+    _out << '"';
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace detail
+    {
+      std::atomic<TraceObserver*> traceObserver{nullptr};
+    }
+
+    /////////////////////////////////////////////////
+    TraceObserver::~TraceObserver() = default;
+
+    /////////////////////////////////////////////////
+    void SetTraceObserver(TraceObserver *_observer)
+    {
+      detail::traceObserver.store(_observer, std::memory_order_release);
+    }
+
+    /////////////////////////////////////////////////
+    class ChromeTraceWriter::Implementation
+    {
+      /// \brief An event, with a copy of its detail
+      public: struct Event
+      {
+        /// \brief The name of the step
+        const char *name;
+
+        /// \brief What the step worked on
+        std::string detail;
+
+        /// \brief When the step started, in nanoseconds
+        std::int64_t start;
+
+        /// \brief How long the step took, in nanoseconds
+        std::int64_t duration;
+
+        /// \brief The thread which performed the step
+        std::size_t thread;
+      };
+
+      /// \brief Protects the fields below
+      public: mutable std::mutex mutex;
+
+      /// \brief The events in the order in which they finished
+      public: std::vector<Event> events;
+
+      /// \brief Small numbers for the threads that have produced events,
+      /// which are easier to read in a trace viewer than thread ids
+      public: std::unordered_map<std::thread::id, std::size_t> threads;
+    };
+
+    /////////////////////////////////////////////////
+    ChromeTraceWriter::ChromeTraceWriter()
+      : dataPtr(new Implementation)
+    {
+      // Do nothing
+    }
+
+    /////////////////////////////////////////////////
+    ChromeTraceWriter::~ChromeTraceWriter() = default;
+
+    /////////////////////////////////////////////////
+    void ChromeTraceWriter::OnTraceEvent(const TraceEvent &_event)
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      const std::size_t thread = this->dataPtr->threads.emplace(
+            std::this_thread::get_id(),
+            this->dataPtr->threads.size() + 1).first->second;
+
+      this->dataPtr->events.push_back(Implementation::Event{
+          _event.name, std::string(_event.detail),
+          _event.start, _event.duration, thread});
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t ChromeTraceWriter::EventCount() const
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->events.size();
+    }
+
+    /////////////////////////////////////////////////
+    void ChromeTraceWriter::Write(std::ostream &_out) const
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+      // Chrome traces are in microseconds
+      const std::ios::fmtflags flags = _out.flags();
+      const std::streamsize precision = _out.precision();
+      _out << std::fixed << std::setprecision(3);
+
+      _out << "{\"traceEvents\":[";
+      bool first = true;
+      for (const Implementation::Event &event : this->dataPtr->events)
+      {
+        if (!first)
+          _out << ',';
+        first = false;
+
+        _out << "\n{\"name\":\"" << event.name << "\",\"cat\":\"ign-plugin\","
+             << "\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+             << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+             << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0
+             << ",\"args\":{\"detail\":";
+        WriteJsonString(_out, event.detail);
+        _out << "}}";
+      }
+      _out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+      _out.flags(flags);
+      _out.precision(precision);
+    }
+
+    /////////////////////////////////////////////////
+    void ChromeTraceWriter::Clear()
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      this->dataPtr->events.clear();
+    }
+
+    /////////////////////////////////////////////////
+    class LatencyMonitor::Implementation
+    {
+      /// \brief Each power of two is split into this many buckets, so a
+      /// bucket is at most 1/8 as wide as the values that it holds
+      public: static constexpr std::size_t kSubBuckets = 8;
+
+      /// \brief The number of buckets that it takes to hold every
+      /// nonnegative std::int64_t
+      public: static constexpr std::size_t kBucketCount = 62 * kSubBuckets;
+
+      /// \brief The steps which are measured
+      public: static constexpr std::array<std::string_view, 4> kSteps{{
+          "LoadLib", "Instantiate", "Construct", "ForgetLibrary"}};
+
+      /// \brief The latencies of one step. Values smaller than kSubBuckets
+      /// each have their own bucket. Beyond that, each power of two gets
+      /// kSubBuckets buckets of equal width, like in an HDR histogram.
+      public: struct Histogram
+      {
+        /// \brief The number of steps in each bucket
+        std::array<std::atomic<std::uint64_t>, kBucketCount> buckets{};
+
+        /// \brief The latency of the slowest step
+        std::atomic<std::int64_t> max{0};
+
+        /// \brief The threshold of the step, or zero if it has none
+        std::atomic<std::int64_t> threshold{0};
+      };
+
+      /// \brief Constructor
+      /// \param[in] _onSlowStep The function to call with slow steps
+      /// \param[in] _next The observer which receives the events next
+      public: Implementation(SlowStepCallback _onSlowStep,
+                             TraceObserver *_next)
+        : onSlowStep(std::move(_onSlowStep)),
+          next(_next)
+      {
+        // Do nothing
+      }
+
+      /// \brief Find the histogram of a step
+      /// \param[in] _step The name of the step
+      /// \return The histogram, or nullptr if the step is not measured
+      public: Histogram *Find(const std::string_view _step)
+      {
+        for (std::size_t i = 0; i < kSteps.size(); ++i)
+        {
+          if (kSteps[i] == _step)
+            return &this->histograms[i];
+        }
+
+        return nullptr;
+      }
+
+      /// \brief Get the bucket of a latency
+      /// \param[in] _value The latency, which is not negative
+      /// \return The index of the bucket
+      public: static std::size_t Bucket(const std::uint64_t _value)
+      {
+        if (_value < kSubBuckets)
+          return static_cast<std::size_t>(_value);
+
+        // The position of the highest bit, which is at least 3 here
+        std::size_t exponent = 0;
+        for (std::uint64_t v = _value; v > 1; v >>= 1)
+          ++exponent;
+
+        return (exponent - 2) * kSubBuckets +
+            static_cast<std::size_t>((_value >> (exponent - 3)) & 7);
+      }
+
+      /// \brief Get the largest latency that falls into a bucket
+      /// \param[in] _bucket The index of the bucket
+      /// \return The largest latency of the bucket
+      public: static std::uint64_t Highest(const std::size_t _bucket)
+      {
+        if (_bucket < kSubBuckets)
+          return _bucket;
+
+        const std::size_t shift = _bucket / kSubBuckets - 1;
+        const std::uint64_t lowest =
+            static_cast<std::uint64_t>(kSubBuckets + _bucket % kSubBuckets)
+            << shift;
+        return lowest + ((std::uint64_t{1} << shift) - 1);
+      }
+
+      /// \brief The function to call with slow steps
+      public: const SlowStepCallback onSlowStep;
+
+      /// \brief The observer which receives the events next
+      public: TraceObserver *const next;
+
+      /// \brief The histograms of the steps, in the order of kSteps
+      public: std::array<Histogram, kSteps.size()> histograms;
+    };
+
+    /////////////////////////////////////////////////
+    LatencyMonitor::LatencyMonitor(
+        SlowStepCallback _onSlowStep, TraceObserver *_next)
+      : dataPtr(new Implementation(std::move(_onSlowStep), _next))
+    {
+      // Do nothing
+    }
+
+    /////////////////////////////////////////////////
+    LatencyMonitor::~LatencyMonitor() = default;
+
+    /////////////////////////////////////////////////
+    void LatencyMonitor::OnTraceEvent(const TraceEvent &_event)
+    {
+      Implementation::Histogram *histogram =
+          this->dataPtr->Find(_event.name);
+      if (histogram)
+      {
+        const std::int64_t duration = std::max<std::int64_t>(
+              0, _event.duration);
+
+        histogram->buckets[Implementation::Bucket(
+              static_cast<std::uint64_t>(duration))].fetch_add(
+                1, std::memory_order_relaxed);
+
+        std::int64_t max = histogram->max.load(std::memory_order_relaxed);
+        while (duration > max &&
+               !histogram->max.compare_exchange_weak(
+                 max, duration, std::memory_order_relaxed))
+        {
+          // Try again with the new maximum
+        }
+
+        const std::int64_t threshold =
+            histogram->threshold.load(std::memory_order_relaxed);
+        if (threshold > 0 && duration > threshold && this->dataPtr->onSlowStep)
+          this->dataPtr->onSlowStep(_event);
+      }
+
+      if (this->dataPtr->next)
+        this->dataPtr->next->OnTraceEvent(_event);
+    }
+
+    /////////////////////////////////////////////////
+    bool LatencyMonitor::SetThreshold(
+        const std::string_view _step,
+        const std::chrono::nanoseconds _threshold)
+    {
+      Implementation::Histogram *histogram = this->dataPtr->Find(_step);
+      if (!histogram)
+        return false;
+
+      histogram->threshold.store(
+            std::max<std::int64_t>(0, _threshold.count()),
+            std::memory_order_relaxed);
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    LatencySummary LatencyMonitor::Summary(const std::string_view _step) const
+    {
+      LatencySummary summary;
+      const Implementation::Histogram *histogram = this->dataPtr->Find(_step);
+      if (!histogram)
+        return summary;
+
+      // Steps which finish while the buckets are being read may or may not
+      // be counted, so the counts are copied first to keep them consistent.
+      std::array<std::uint64_t, Implementation::kBucketCount> counts;
+      for (std::size_t i = 0; i < counts.size(); ++i)
+      {
+        counts[i] = histogram->buckets[i].load(std::memory_order_relaxed);
+        summary.count += counts[i];
+      }
+
+      summary.max = histogram->max.load(std::memory_order_relaxed);
+      if (0 == summary.count)
+        return summary;
+
+      const auto percentile = [&](const std::uint64_t _percent)
+      {
+        const std::uint64_t rank =
+            std::max<std::uint64_t>(1, (summary.count * _percent + 99) / 100);
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts.size(); ++i)
+        {
+          seen += counts[i];
+          if (seen >= rank)
+          {
+            return static_cast<std::int64_t>(std::min<std::uint64_t>(
+                  Implementation::Highest(i),
+                  static_cast<std::uint64_t>(summary.max)));
+          }
+        }
+
+        return summary.max;
+      };
+
+      summary.p50 = percentile(50);
+      summary.p99 = percentile(99);
+      return summary;
+    }
+
+    /////////////////////////////////////////////////
+    void LatencyMonitor::Reset()
+    {
+      for (Implementation::Histogram &histogram : this->dataPtr->histograms)
+      {
+        for (std::atomic<std::uint64_t> &bucket : histogram.buckets)
+          bucket.store(0, std::memory_order_relaxed);
+
+        histogram.max.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include <ignition/plugin/Trace.hh>
+
+using namespace ignition::plugin;
+
+/////////////////////////////////////////////////
+TEST(Trace, ScopesReachTheObserver)
+{
+  ChromeTraceWriter writer;
+
+  {
+    detail::TraceScope scope("Untraced", "nobody is listening");
+  }
+  EXPECT_EQ(0u, writer.EventCount());
+
+  SetTraceObserver(&writer);
+  {
+    detail::TraceScope outer("Outer", "some \"quoted\"\\path");
+    detail::TraceScope inner("Inner", "");
+  }
+  SetTraceObserver(nullptr);
+
+  {
+    detail::TraceScope scope("Untraced", "nobody is listening");
+  }
+  EXPECT_EQ(2u, writer.EventCount());
+
+  std::stringstream json;
+  writer.Write(json);
+  const std::string trace = json.str();
+
+  EXPECT_EQ(0u, trace.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"Outer\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"Inner\""));
+  EXPECT_NE(std::string::npos, trace.find("\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos,
+            trace.find("\"detail\":\"some \\\"quoted\\\"\\\\path\""));
+  EXPECT_EQ(std::string::npos, trace.find("Untraced"));
+
+  writer.Clear();
+  EXPECT_EQ(0u, writer.EventCount());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -22,79 +22,76 @@ namespace ignition
   namespace plugin
   {
     /////////////////////////////////////////////////
-    class WeakPluginPtr::Implementation
-    {
-      public: std::weak_ptr<void> instance;
-      public: std::weak_ptr<const Info> info;
-    };
-
-    /////////////////////////////////////////////////
-    WeakPluginPtr::WeakPluginPtr()
-      : pimpl(new Implementation())
-    {
-      // Do nothing
-    }
+    WeakPluginPtr::WeakPluginPtr() = default;
 
     /////////////////////////////////////////////////
-    WeakPluginPtr::WeakPluginPtr(const WeakPluginPtr &_other)
-      : pimpl(new Implementation())
-    {
-      *this->pimpl = *_other.pimpl;
-    }
+    WeakPluginPtr::WeakPluginPtr(const WeakPluginPtr &_other) = default;
 
     /////////////////////////////////////////////////
-    WeakPluginPtr::WeakPluginPtr(WeakPluginPtr &&_other)
-      : pimpl(new Implementation())
+    WeakPluginPtr::WeakPluginPtr(WeakPluginPtr &&_other) noexcept
+      : instance(std::move(_other.instance)),
+        info(_other.info),
+        table(_other.table)
     {
-      this->pimpl = std::move(_other.pimpl);
+      _other.info = nullptr;
+      _other.table = nullptr;
     }
 
     /////////////////////////////////////////////////
     WeakPluginPtr::WeakPluginPtr(const PluginPtr &_ptr)
-      : pimpl(new Implementation())
     {
       *this = _ptr;
     }
 
     /////////////////////////////////////////////////
-    WeakPluginPtr &WeakPluginPtr::operator=(const WeakPluginPtr &_other)
-    {
-      *this->pimpl = *_other.pimpl;
-      return *this;
-    }
+    WeakPluginPtr &WeakPluginPtr::operator=(
+        const WeakPluginPtr &_other) = default;
 
     /////////////////////////////////////////////////
-    WeakPluginPtr &WeakPluginPtr::operator=(WeakPluginPtr &&_other)
+    WeakPluginPtr &WeakPluginPtr::operator=(WeakPluginPtr &&_other) noexcept
     {
-      this->pimpl = std::move(_other.pimpl);
+      this->instance = std::move(_other.instance);
+      this->info = _other.info;
+      this->table = _other.table;
+      _other.info = nullptr;
+      _other.table = nullptr;
       return *this;
     }
 
     /////////////////////////////////////////////////
     WeakPluginPtr &WeakPluginPtr::operator=(const PluginPtr &_ptr)
     {
-      this->pimpl->instance = _ptr->PrivateGetInstancePtr();
-      this->pimpl->info = _ptr->PrivateGetInfoPtr();
+      this->instance = _ptr->PrivateGetInstancePtr();
+      this->info = _ptr->PrivateGetInfoPtr().get();
+      this->table = _ptr->PrivateGetSharedInterfaceTable();
       return *this;
     }
 
     /////////////////////////////////////////////////
     PluginPtr WeakPluginPtr::Lock() const
     {
-      // CRUCIAL DEV NOTE (MXG): We must lock the instance before the info.
-      // We must never allow info to get deleted before the plugin instance,
-      // because otherwise the library might get unloaded before the info is
-      // destructed, but the Info's destructor depends on the library.
-      // TODO(MXG): Consider ways to make this less fragile.
-      std::shared_ptr<void> instance = this->pimpl->instance.lock();
-      ConstInfoPtr info = this->pimpl->info.lock();
-
       PluginPtr ptr;
+
+      std::shared_ptr<void> locked = this->instance.lock();
+      if (!locked)
+        return ptr;
+
+      // CRUCIAL DEV NOTE: The Info of the plugin is owned by the same
+      // control block as the instance, so we share that control block instead
+      // of locking a separate reference to the Info. This also guarantees that
+      // the Info never gets deleted before the plugin instance, which matters
+      // because the Info's destructor depends on the library.
+      ConstInfoPtr lockedInfo(locked, this->info);
+
       // NOTE(MXG): We do not want to make a PluginPtr constructor overload for
       // this, because its signature would be too easily confused with the
       // constructor that takes a ConstInfoPtr and a std::shared_ptr<void> to a
       // dl handle. Using an explicitly named function avoids any ambiguity.
-      ptr->PrivateCopyPluginInstance(info, instance);
+      //
+      // A default-constructed PluginPtr shares the empty wrapper, so we must
+      // give it a wrapper of its own before changing it.
+      ptr.PrivateUniqueWrapper().PrivateCopyPluginInstance(
+            lockedInfo, locked, this->table);
 
       return ptr;
     }
@@ -102,15 +99,7 @@ namespace ignition
     /////////////////////////////////////////////////
     bool WeakPluginPtr::IsExpired() const
     {
-      // CRUCIAL DEV NOTE (MXG): We must lock the instance before the info.
-      // We must never allow info to get deleted before the plugin instance,
-      // because otherwise the library might get unloaded before the info is
-      // destructed, but the Info's destructor depends on the library.
-      // TODO(MXG): Consider ways to make this less fragile.
-      std::shared_ptr<void> instance = this->pimpl->instance.lock();
-      ConstInfoPtr info = this->pimpl->info.lock();
-
-      return !(instance && info);
+      return this->instance.expired();
     }
 
     /////////////////////////////////////////////////
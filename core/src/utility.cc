@@ -17,8 +17,11 @@
 
 #include <cassert>
 #include <iostream>
+#include <mutex>
 #include <regex>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 
 #if defined(__GNUC__) || defined(__clang__)
 // This header is used for name demangling on GCC and Clang
@@ -27,6 +30,71 @@
 
 #include <ignition/plugin/utility.hh>
 
+namespace
+{
+  /////////////////////////////////////////////////
+  /// \brief Demangle a symbol name without reporting failures.
+  /// \param[in] _name The name to demangle
+  /// \param[out] _demangled Receives the demangled name, or _name itself if
+  /// it could not be demangled
+  /// \return The status of __cxa_demangle, i.e. 0 on success. This is always
+  /// 0 for compilers that do not use __cxa_demangle.
+  int TryDemangle(const std::string &_name, std::string &_demangled)
+  {
+  #if defined(__GNUC__) || defined(__clang__)
+    int status;
+    char *demangled_cstr = abi::__cxa_demangle(
+          _name.c_str(), nullptr, nullptr, &status);
+
+    if (0 != status)
+    {
+      _demangled = _name;
+      return status;
+    }
+
+    _demangled = demangled_cstr;
+    free(demangled_cstr);
+
+    return 0;
+  #elif _MSC_VER
+    // Visual Studio's typeid(~).name() does not mangle the name, except that
+    // it prefixes the normal name of the class with the character sequence
+    // "class ". So to get the "demangled" name, all we have to do is remove
+    // "class " from each place where it appears.
+    static const std::regex classRegex("class ");
+    _demangled = std::regex_replace(_name, classRegex, "");
+    return 0;
+  #else
+    // If we don't know the compiler, then we can't perform name demangling.
+    // The tests will probably fail in this situation, and the class names
+    // will probably look gross to users. Plugin name aliasing can be used
+    // to make plugins robust to this situation.
+    _demangled = _name;
+    return 0;
+  #endif
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief The names which CachedDemangleSymbol has demangled so far
+  struct DemangleCache
+  {
+    /// \brief Protects names
+    std::shared_mutex mutex;
+
+    /// \brief The demangled names, keyed by their mangled names
+    std::unordered_map<std::string, std::string> names;
+  };
+
+  /////////////////////////////////////////////////
+  DemangleCache &GetDemangleCache()
+  {
+    // The cache is deliberately leaked, so that it remains usable while
+    // other static objects are being destroyed.
+    static DemangleCache *cache = new DemangleCache;
+    return *cache;
+  }
+}
+
 namespace ignition
 {
   namespace plugin
@@ -34,42 +102,43 @@ namespace ignition
     /////////////////////////////////////////////////
     std::string DemangleSymbol(const std::string &_name)
     {
-    #if defined(__GNUC__) || defined(__clang__)
-      int status;
-      char *demangled_cstr = abi::__cxa_demangle(
-            _name.c_str(), nullptr, nullptr, &status);
+    #ifdef _MSC_VER
+      assert(_name.substr(0, 6) == "class ");
+    #endif
 
+      std::string demangled;
+      const int status = TryDemangle(_name, demangled);
       if (0 != status)
       {
         // LCOV_EXCL_START
         std::cerr << "[Demangle] Failed to demangle the symbol name [" << _name
                   << "]. Error code: " << status << "\n";
         assert(false);
-        return _name;
         // LCOV_EXCL_STOP
       }
 
-      const std::string demangled(demangled_cstr);
-      free(demangled_cstr);
-
       return demangled;
-    #elif _MSC_VER
+    }
 
-      assert(_name.substr(0, 6) == "class ");
+    /////////////////////////////////////////////////
+    std::string CachedDemangleSymbol(const std::string &_name)
+    {
+      DemangleCache &cache = GetDemangleCache();
 
-      // Visual Studio's typeid(~).name() does not mangle the name, except that
-      // it prefixes the normal name of the class with the character sequence
-      // "class ". So to get the "demangled" name, all we have to do is remove
-      // "class " from each place where it appears.
-      const std::regex classRegex("class ");
-      return std::regex_replace(_name, classRegex, "");
-    #else
-      // If we don't know the compiler, then we can't perform name demangling.
-      // The tests will probably fail in this situation, and the class names
-      // will probably look gross to users. Plugin name aliasing can be used
-      // to make plugins robust to this situation.
-      return _name;
-    #endif
+      {
+        std::shared_lock<std::shared_mutex> lock(cache.mutex);
+        const auto it = cache.names.find(_name);
+        if (cache.names.end() != it)
+          return it->second;
+      }
+
+      // Demangle outside of the lock. If another thread raced us to the same
+      // name, both results are identical and the first one is kept.
+      std::string demangled;
+      TryDemangle(_name, demangled);
+
+      std::unique_lock<std::shared_mutex> lock(cache.mutex);
+      return cache.names.emplace(_name, std::move(demangled)).first->second;
     }
   }
 }
@@ -17,12 +17,20 @@
 
 #include <gtest/gtest.h>
 
+#include <ignition/plugin/InterfaceId.hh>
 #include <ignition/plugin/utility.hh>
 
 using namespace ignition::plugin;
 
 struct SomeType { };
 
+namespace ns
+{
+  template <typename T> struct Named { };
+}
+
+IGNITION_PLUGIN_INTERFACE_NAME(ns::Named<SomeType>, "ns::Named<some type>")
+
 /////////////////////////////////////////////////
 TEST(TemplateHelpers, ConstCompatible)
 {
@@ -81,6 +89,57 @@ TEST(Demangle, FakeSymbol)
 #endif
 }
 
+/////////////////////////////////////////////////
+TEST(Demangle, CachedSymbol)
+{
+  const std::string mangled = typeid(SomeTemplate<SomeSymbol>).name();
+  EXPECT_EQ(DemangleSymbol(mangled), CachedDemangleSymbol(mangled));
+  EXPECT_EQ(DemangleSymbol(mangled), CachedDemangleSymbol(mangled));
+
+  // Unlike DemangleSymbol, a fake symbol is returned as it was provided, even
+  // when NDEBUG is not defined.
+  EXPECT_EQ("NotReallyASymbol!@#$",
+            CachedDemangleSymbol("NotReallyASymbol!@#$"));
+}
+
+/////////////////////////////////////////////////
+TEST(InterfaceHash, MatchesName)
+{
+  // Reference values of the 64-bit FNV-1a hash
+  static_assert(detail::HashInterfaceName("") == 0xcbf29ce484222325ull,
+                "The hash of an empty name must be the FNV offset basis");
+  EXPECT_EQ(0xaf63dc4c8601ec8cull, detail::HashInterfaceName("a"));
+}
+
+/////////////////////////////////////////////////
+TEST(InterfaceId, Canonical)
+{
+  // The ID is a compile time constant, which ignores cv-qualifiers
+  static_assert(InterfaceId<SomeType>() == InterfaceId<const SomeType>(),
+                "The ID of an interface must not depend on its constness");
+  EXPECT_EQ("SomeType", InterfaceIdentity<SomeType>::name);
+  EXPECT_EQ(detail::HashCanonicalName("SomeType"), InterfaceId<SomeType>());
+  EXPECT_NE(InterfaceId<SomeType>(), InterfaceId<SomeSymbol>());
+
+  // The spellings of different compilers get the same ID
+  static_assert(detail::HashCanonicalName("ns::A<int, ns::B>")
+                == detail::HashCanonicalName("ns::A<int,class ns::B>"),
+                "Spaces and elaborated type specifiers must be ignored");
+  EXPECT_EQ(detail::HashCanonicalName("struct ns::A<unsigned int>"),
+            detail::HashCanonicalName("ns::A<unsignedint>"));
+
+  // Keywords are only skipped when they stand on their own
+  EXPECT_NE(detail::HashCanonicalName("ns::Subclass B"),
+            detail::HashCanonicalName("ns::SubB"));
+
+  // Interfaces may be given names of their own
+  EXPECT_EQ("ns::Named<some type>",
+            InterfaceIdentity<ns::Named<SomeType>>::name);
+  EXPECT_EQ(detail::HashCanonicalName("ns::Named<some type>"),
+            InterfaceId<ns::Named<SomeType>>());
+  EXPECT_NE(InterfaceId<ns::Named<SomeType>>(), InterfaceId<ns::Named<int>>());
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
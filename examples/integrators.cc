@@ -15,17 +15,35 @@
  *
 */
 
-#include <iostream>
-#include <iomanip>
-#include <chrono>
+// The integrators example is a benchmark harness for numerical integrator
+// plugins. It runs every NumericalIntegrator plugin against every system that
+// the ODESystemFactory plugins provide. The system x integrator pairs run in
+// parallel on a pool of worker threads. Each pair gets its own instance of
+// the integrator, runs a few warmup trials which are not measured, and then
+// the measured trials. The runtime of the trials is summarized by its mean,
+// standard deviation and percentiles, and the accuracy by the error of the
+// final state compared to the exact solution of the system. For each system,
+// the integrators are then ranked by their accuracy per unit of CPU time.
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <map>
 #include <set>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <ignition/plugin/Loader.hh>
 #include <ignition/common/SystemPaths.hh>
 
 #include "plugins/integrators.hh"
+#include "plugins/simd.hh"
 
 #ifdef HAVE_BOOST_PROGRAM_OPTIONS
 #include <boost/program_options.hpp>
@@ -33,6 +51,12 @@ namespace bpo = boost::program_options;
 #endif
 
 using NumericalIntegrator = ignition::plugin::examples::NumericalIntegrator;
+using InPlaceNumericalIntegrator =
+    ignition::plugin::examples::InPlaceNumericalIntegrator;
+using BatchNumericalIntegrator =
+    ignition::plugin::examples::BatchNumericalIntegrator;
+using AdaptiveNumericalIntegrator =
+    ignition::plugin::examples::AdaptiveNumericalIntegrator;
 using ODESystem = ignition::plugin::examples::ODESystem;
 using ODESystemFactory = ignition::plugin::examples::ODESystemFactory;
 
@@ -40,6 +64,56 @@ using ODESystemFactory = ignition::plugin::examples::ODESystemFactory;
 // examples/CMakeLists.txt file.
 const std::string PluginLibDir = IGN_PLUGIN_EXAMPLES_LIBDIR;
 
+/// \brief Parameters of the benchmark
+struct BenchmarkSettings
+{
+  /// \brief Size of the time step to integrate with
+  public: double timeStep = 0.01;
+
+  /// \brief Number of time steps that each trial takes
+  public: unsigned int numSteps = 10000;
+
+  /// \brief Number of trials which are run before measuring
+  public: unsigned int warmupTrials = 2;
+
+  /// \brief Number of trials which are measured
+  public: unsigned int trials = 10;
+
+  /// \brief Number of pairs which run at the same time
+  public: unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+
+  /// \brief Whether to use the InPlaceNumericalIntegrator interface of the
+  /// plugins which provide it
+  public: bool inPlace = true;
+
+  /// \brief If this is not 0, every trial integrates this many copies of the
+  /// initial state of the system. They are integrated as a block by the
+  /// plugins which provide the BatchNumericalIntegrator interface, and one
+  /// at a time by the others.
+  public: unsigned int batchSize = 0;
+
+  /// \brief Whether to test only the fastest variant that this CPU can run
+  /// of the integrators which come in several SIMD variants
+  public: bool fastestOnly = false;
+
+  /// \brief The relative tolerance of the integrators which adapt their
+  /// step size, see AdaptiveNumericalIntegrator. The absolute tolerance is a
+  /// thousandth of it.
+  public: double tolerance = 1e-6;
+};
+
+/// \brief Summary of the runtime of the trials of a pair, in microseconds
+struct RuntimeStatistics
+{
+  public: double mean = 0.0;
+  public: double stddev = 0.0;
+  public: double min = 0.0;
+  public: double p50 = 0.0;
+  public: double p90 = 0.0;
+  public: double p99 = 0.0;
+  public: double max = 0.0;
+};
+
 /// \brief Return structure for numerical integration test results. If the name
 /// is blank, that means the test was not run.
 struct TestResult
@@ -47,20 +121,43 @@ struct TestResult
   /// \brief Name of the test run
   public: std::string name;
 
-  /// \brief Name of the actual time spent computing
-  public: long timeSpent_us;
+  /// \brief How the states were integrated, e.g. "in place"
+  public: std::string method;
+
+  /// \brief The runtime of the measured trials
+  public: RuntimeStatistics runtime;
 
   /// \brief The percent error in each component of the state when compared to
   /// an exact solution.
   public: std::vector<double> percentError;
+
+  /// \brief The mean CPU time of the measured trials, in microseconds
+  public: double cpuTime = 0.0;
+
+  /// \brief The number of correct decimal digits of the least accurate
+  /// component of the final state
+  public: double digits = 0.0;
+
+  /// \brief Whether the integrator adapts its step size, in which case the
+  /// counts below are set
+  public: bool adaptive = false;
+
+  /// \brief The mean number of accepted internal steps per trial
+  public: double acceptedSteps = 0.0;
+
+  /// \brief The mean number of rejected internal steps per trial
+  public: double rejectedSteps = 0.0;
+
+  /// \brief The mean number of evaluations of the system per trial
+  public: double evaluations = 0.0;
 };
 
-/// \brief A simple container to hold a plugin and the name that it was
-/// instantiated from.
-struct PluginHolder
+/// \brief A system of differential equations, along with the name of the
+/// factory plugin that provided it
+struct SystemHolder
 {
-  std::string name;
-  ignition::plugin::PluginPtr plugin;
+  std::string factory;
+  ODESystem system;
 };
 
 /// \brief Compute the component-wise percent error of the estimate produced by
@@ -79,48 +176,298 @@ std::vector<double> ComputeError(
   return result;
 }
 
-/// \brief Pass in a plugin that provides the numerical integration interface.
-/// The numerical integration results of the plugin will be tested against the
-/// results of the _exactFunction.
+/// \brief Get the number of correct decimal digits of the least accurate
+/// component of an estimate, given its component-wise percent error. An
+/// exact estimate gets the precision of a double.
+double CorrectDigits(const std::vector<double> &_percentError)
+{
+  double worst = 0.0;
+  for (const double error : _percentError)
+    worst = std::max(worst, std::abs(error) / 100.0);
+
+  if (worst <= 0.0)
+    return 16.0;
+
+  return std::min(16.0, std::max(0.0, -std::log10(worst)));
+}
+
+/// \brief Get the CPU time that the calling thread has used. The pairs run
+/// in parallel, so the CPU time of the process would mix them up.
+/// \return The CPU time in microseconds, or the wall clock time if the
+/// platform cannot tell the CPU time of a thread
+double ThreadCpuMicroseconds()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return static_cast<double>(now.tv_sec) * 1e6
+      + static_cast<double>(now.tv_nsec) / 1e3;
+#else
+  return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/// \brief Get a percentile of sorted samples, using the nearest rank
+double Percentile(const std::vector<double> &_sorted, const double _percent)
+{
+  const std::size_t rank = static_cast<std::size_t>(
+        std::ceil(_percent / 100.0 * static_cast<double>(_sorted.size())));
+  return _sorted[std::min(std::max<std::size_t>(rank, 1), _sorted.size()) - 1];
+}
+
+/// \brief Summarize the runtime of a set of trials
+RuntimeStatistics Summarize(std::vector<double> _samples)
+{
+  RuntimeStatistics stats;
+  if (_samples.empty())
+    return stats;
+
+  std::sort(_samples.begin(), _samples.end());
+
+  double sum = 0.0;
+  for (const double sample : _samples)
+    sum += sample;
+  stats.mean = sum / static_cast<double>(_samples.size());
+
+  double squares = 0.0;
+  for (const double sample : _samples)
+    squares += (sample - stats.mean) * (sample - stats.mean);
+  if (_samples.size() > 1)
+  {
+    stats.stddev = std::sqrt(
+          squares / static_cast<double>(_samples.size() - 1));
+  }
+
+  stats.min = _samples.front();
+  stats.p50 = Percentile(_samples, 50.0);
+  stats.p90 = Percentile(_samples, 90.0);
+  stats.p99 = Percentile(_samples, 99.0);
+  stats.max = _samples.back();
+
+  return stats;
+}
+
+/// \brief Run one trial of an integrator against a system
+/// \param[out] _finalTime The time at the end of the trial
+/// \return The state at the end of the trial
+NumericalIntegrator::State RunTrial(
+    NumericalIntegrator &_integrator,
+    const ODESystem &_system,
+    const unsigned int _numSteps,
+    double &_finalTime)
+{
+  double time = _system.initialTime;
+  NumericalIntegrator::State state = _system.initialState;
+
+  for(std::size_t i=0; i < _numSteps; ++i)
+  {
+    state = _integrator.Integrate(time, state);
+    time += _integrator.GetTimeStep();
+  }
+
+  _finalTime = time;
+  return state;
+}
+
+/// \brief Run one trial of an integrator against a system, in place
+/// \param[in,out] _state Receives the state at the end of the trial. This
+/// must already have the dimension of the system, so that nothing gets
+/// allocated.
+/// \param[out] _finalTime The time at the end of the trial
+void RunTrialInPlace(
+    InPlaceNumericalIntegrator &_integrator,
+    const ODESystem &_system,
+    const unsigned int _numSteps,
+    NumericalIntegrator::State &_state,
+    double &_finalTime)
+{
+  double time = _system.initialTime;
+  std::copy(_system.initialState.begin(), _system.initialState.end(),
+            _state.begin());
+
+  for(std::size_t i=0; i < _numSteps; ++i)
+  {
+    _integrator.Integrate(time, _state.data(), _state.data());
+    time += _integrator.GetTimeStep();
+  }
+
+  _finalTime = time;
+}
+
+/// \brief Run one trial of an integrator against a block of copies of the
+/// initial state of a system
+/// \param[in,out] _block Receives the states at the end of the trial, as a
+/// structure-of-arrays block. This must already have the size of _count
+/// states, so that nothing gets allocated.
+/// \param[out] _finalTime The time at the end of the trial
+void RunTrialBatch(
+    BatchNumericalIntegrator &_integrator,
+    const ODESystem &_system,
+    const unsigned int _numSteps,
+    const std::size_t _count,
+    std::vector<double> &_block,
+    double &_finalTime)
+{
+  double time = _system.initialTime;
+  for (std::size_t d = 0; d < _system.initialState.size(); ++d)
+  {
+    std::fill(_block.begin() + d * _count, _block.begin() + (d + 1) * _count,
+              _system.initialState[d]);
+  }
+
+  for(std::size_t i=0; i < _numSteps; ++i)
+  {
+    _integrator.BatchIntegrate(time, _block.data(), _count);
+    time += _integrator.GetTimeStep();
+  }
+
+  _finalTime = time;
+}
+
+/// \brief Instantiate the integrator plugin with the given name, and test it
+/// against the system. The numerical integration results of the plugin will
+/// be tested against the exact solution of the system.
 TestResult TestIntegrator(
-    const PluginHolder &_pluginHolder,
+    const ignition::plugin::Loader &_loader,
+    const std::string &_integratorName,
     const ODESystem &_system,
-    const double _timeStep,
-    const unsigned int _numSteps)
+    const BenchmarkSettings &_settings)
 {
-  const ignition::plugin::PluginPtr &plugin = _pluginHolder.plugin;
+  // Every pair gets an instance of its own, since integrators keep the
+  // function and the time step that they were given
+  const ignition::plugin::PluginPtr plugin =
+      _loader.Instantiate(_integratorName);
+
+  BatchNumericalIntegrator *batch =
+      plugin && _settings.batchSize > 0 && _system.batchOde ?
+        plugin->QueryInterface<BatchNumericalIntegrator>() : nullptr;
+  InPlaceNumericalIntegrator *inPlace =
+      plugin && !batch && _settings.inPlace && _system.inPlaceOde ?
+        plugin->QueryInterface<InPlaceNumericalIntegrator>() : nullptr;
   NumericalIntegrator* integrator =
-      plugin->QueryInterface<NumericalIntegrator>();
+      plugin && !batch && !inPlace ?
+        plugin->QueryInterface<NumericalIntegrator>() : nullptr;
+  AdaptiveNumericalIntegrator *adaptive =
+      plugin ? plugin->QueryInterface<AdaptiveNumericalIntegrator>() : nullptr;
 
-  if(!integrator)
+  if(!batch && !inPlace && !integrator)
   {
-    std::cout << "The plugin named [" << _pluginHolder.name << "] does not "
-              << "provide a NumericalIntegrator interface. It will not be "
-              << "tested." << std::endl;
+    std::cerr << "The plugin named [" << _integratorName << "] could not be "
+              << "instantiated as an integrator which supports system ["
+              << _system.name << "]. It will not be tested." << std::endl;
     return TestResult();
   }
 
   TestResult result;
-  result.name = _pluginHolder.name;
+  result.name = _integratorName;
 
-  integrator->SetFunction(_system.ode);
-  integrator->SetTimeStep(_timeStep);
+  const std::size_t dimension = _system.initialState.size();
+  const std::size_t statesPerTrial = std::max(1u, _settings.batchSize);
 
-  double time = _system.initialTime;
-  NumericalIntegrator::State state = _system.initialState;
+  if (batch)
+  {
+    batch->SetFunction(_system.batchOde, dimension, statesPerTrial);
+    batch->SetTimeStep(_settings.timeStep);
+    result.method = "batch of " + std::to_string(statesPerTrial);
+  }
+  else if (inPlace)
+  {
+    inPlace->SetFunction(_system.inPlaceOde, dimension);
+    inPlace->SetTimeStep(_settings.timeStep);
+    result.method = "in place";
+  }
+  else
+  {
+    integrator->SetFunction(_system.ode);
+    integrator->SetTimeStep(_settings.timeStep);
+    result.method = "allocating";
+  }
 
-  auto performanceStart = std::chrono::high_resolution_clock::now();
-  for(std::size_t i=0; i < _numSteps; ++i)
+  if (adaptive)
+  {
+    adaptive->SetTolerances(_settings.tolerance, _settings.tolerance * 1e-3);
+    result.adaptive = true;
+    result.method += ", adaptive";
+  }
+
+  if (!batch && _settings.batchSize > 0)
+  {
+    result.method += ", batch of " + std::to_string(statesPerTrial)
+        + " one state at a time";
+  }
+
+  double time = 0.0;
+  NumericalIntegrator::State state(dimension);
+  std::vector<double> block(batch ? dimension * statesPerTrial : 0);
+  auto runTrial = [&]()
+  {
+    if (batch)
+    {
+      RunTrialBatch(*batch, _system, _settings.numSteps, statesPerTrial,
+                    block, time);
+
+      // Every state of the block started out the same, so the first one
+      // tells the accuracy of all of them
+      for (std::size_t d = 0; d < dimension; ++d)
+        state[d] = block[d * statesPerTrial];
+      return;
+    }
+
+    for (std::size_t n = 0; n < statesPerTrial; ++n)
+    {
+      if (inPlace)
+        RunTrialInPlace(*inPlace, _system, _settings.numSteps, state, time);
+      else
+        state = RunTrial(*integrator, _system, _settings.numSteps, time);
+    }
+  };
+
+  for (unsigned int i = 0; i < _settings.warmupTrials; ++i)
+    runTrial();
+
+  if (adaptive)
+    adaptive->ResetStepCounts();
+
+  std::vector<double> samples;
+  samples.reserve(_settings.trials);
+  double cpuTime = 0.0;
+  for (unsigned int i = 0; i < _settings.trials; ++i)
   {
-    state = integrator->Integrate(time, state);
-    time += integrator->GetTimeStep();
+    const double cpuStart = ThreadCpuMicroseconds();
+    const auto start = std::chrono::steady_clock::now();
+    runTrial();
+    const auto stop = std::chrono::steady_clock::now();
+    cpuTime += ThreadCpuMicroseconds() - cpuStart;
+
+    samples.push_back(std::chrono::duration<double, std::micro>(
+          stop - start).count());
   }
-  auto performanceStop = std::chrono::high_resolution_clock::now();
 
-  result.timeSpent_us = std::chrono::duration_cast<std::chrono::microseconds>(
-        performanceStop - performanceStart).count();
+  result.runtime = Summarize(std::move(samples));
+
+  if (_settings.trials > 0)
+  {
+    const double trials = static_cast<double>(_settings.trials);
+    result.cpuTime = cpuTime / trials;
+    if (adaptive)
+    {
+      result.acceptedSteps =
+          static_cast<double>(adaptive->AcceptedSteps()) / trials;
+      result.rejectedSteps =
+          static_cast<double>(adaptive->RejectedSteps()) / trials;
+      result.evaluations =
+          static_cast<double>(adaptive->FunctionEvaluations()) / trials;
+    }
+  }
 
-  result.percentError = ComputeError(state, _system.exact(time));
+  // Every trial integrates the same way, so the accuracy of the last one
+  // holds for all of them
+  if (_settings.warmupTrials + _settings.trials > 0)
+  {
+    result.percentError = ComputeError(state, _system.exact(time));
+    result.digits = CorrectDigits(result.percentError);
+  }
 
   return result;
 }
@@ -134,12 +481,19 @@ void PrintResult(const TestResult &_result)
     return;
   }
 
-  std::cout << "\nMethod: " << _result.name << "\n";
+  const RuntimeStatistics &runtime = _result.runtime;
 
-  std::cout << "Runtime(us): " << std::setfill(' ') << std::setw(8)
-            << std::right << _result.timeSpent_us << "\n";
+  std::cout << "\nMethod: " << _result.name
+            << " (" << _result.method << ")\n";
 
-  std::cout << std::setw(0);
+  std::cout << std::setprecision(1) << std::fixed
+            << "Runtime(us): mean " << runtime.mean
+            << " | stddev " << runtime.stddev
+            << " | min " << runtime.min
+            << " | p50 " << runtime.p50
+            << " | p90 " << runtime.p90
+            << " | p99 " << runtime.p99
+            << " | max " << runtime.max << "\n";
 
   std::cout << "Component-wise error: ";
   for (const double result : _result.percentError)
@@ -151,18 +505,60 @@ void PrintResult(const TestResult &_result)
   }
 
   std::cout << "\n";
+
+  std::cout << std::setprecision(1) << std::fixed
+            << "Accuracy: " << _result.digits << " correct digit(s) in "
+            << _result.cpuTime << " us of CPU time per trial\n";
+
+  if (_result.adaptive)
+  {
+    std::cout << std::setprecision(1) << std::fixed
+              << "Steps per trial: " << _result.acceptedSteps
+              << " accepted | " << _result.rejectedSteps << " rejected | "
+              << _result.evaluations << " evaluations of the system\n";
+  }
+}
+
+/// \brief Print the integrators which were tested against a system, ranked
+/// by their accuracy per unit of CPU time, i.e. the number of correct digits
+/// that they reach per millisecond of CPU time.
+void PrintRanking(const std::vector<const TestResult*> &_results)
+{
+  std::vector<std::pair<double, const TestResult*>> ranking;
+  for (const TestResult *result : _results)
+  {
+    if (result->name.empty() || result->cpuTime <= 0.0)
+      continue;
+
+    ranking.emplace_back(result->digits / (result->cpuTime / 1000.0), result);
+  }
+
+  if (ranking.empty())
+    return;
+
+  std::sort(ranking.begin(), ranking.end(),
+            [](const auto &_a, const auto &_b) { return _a.first > _b.first; });
+
+  std::cout << "\nAccuracy per CPU time (correct digits per ms):\n";
+  for (const auto &entry : ranking)
+  {
+    std::cout << std::setfill(' ') << std::setw(12) << std::right
+              << std::setprecision(3) << std::fixed << entry.first
+              << "  " << entry.second->name
+              << " (" << entry.second->method << ")\n";
+  }
 }
 
-/// \brief Test a set of plugins against each system, using the specified
-/// parameters.
+/// \brief Test every integrator against every system. The pairs are spread
+/// over _settings.jobs threads.
 void TestPlugins(
-    const std::vector<PluginHolder> &_factories,
-    const std::vector<PluginHolder> &_integrators,
-    const double _timeStep,
-    const unsigned int _numSteps)
+    const ignition::plugin::Loader &_loader,
+    const std::vector<SystemHolder> &_systems,
+    const std::vector<std::string> &_integrators,
+    const BenchmarkSettings &_settings)
 {
   bool quit = false;
-  if (_factories.empty())
+  if (_systems.empty())
   {
     std::cout << "You did not specify any ODE System plugins to test against!"
 #ifdef HAVE_BOOST_PROGRAM_OPTIONS
@@ -186,68 +582,183 @@ void TestPlugins(
   if(quit)
     return;
 
-  for (const PluginHolder &factory : _factories)
-  {
-    const std::vector<ODESystem> systems =
-        factory.plugin->QueryInterface<ODESystemFactory>()->CreateSystems();
+  // Pair i tests integrator (i % number of integrators) against system
+  // (i / number of integrators). Each worker keeps taking the next pair that
+  // nobody has taken yet.
+  const std::size_t numPairs = _systems.size() * _integrators.size();
+  std::vector<TestResult> results(numPairs);
+  std::atomic<std::size_t> nextPair{0};
 
-    for (const ODESystem &system : systems)
+  auto worker = [&]()
+  {
+    for (std::size_t i = nextPair++; i < numPairs; i = nextPair++)
     {
-      std::cout << "\n\n ================================================== \n";
-      std::cout << "System [" << system.name << "] from factory ["
-                << factory.name << "]\n";
+      results[i] = TestIntegrator(
+            _loader,
+            _integrators[i % _integrators.size()],
+            _systems[i / _integrators.size()].system,
+            _settings);
+    }
+  };
+
+  const std::size_t numWorkers =
+      std::min<std::size_t>(std::max(1u, _settings.jobs), numPairs);
+  std::vector<std::thread> workers;
+  for (std::size_t i = 1; i < numWorkers; ++i)
+    workers.emplace_back(worker);
+  worker();
+  for (std::thread &thread : workers)
+    thread.join();
+
+  std::cout << "Ran " << numPairs << " system x integrator pair(s) on "
+            << numWorkers << " thread(s), with " << _settings.warmupTrials
+            << " warmup trial(s) and " << _settings.trials
+            << " measured trial(s) of " << _settings.numSteps
+            << " steps each";
+  if (_settings.batchSize > 0)
+    std::cout << ", integrating " << _settings.batchSize << " states per trial";
+  std::cout << "\n";
 
-      for (const PluginHolder &integrator : _integrators)
-      {
-        const TestResult result = TestIntegrator(
-              integrator, system, _timeStep, _numSteps);
+  for (std::size_t s = 0; s < _systems.size(); ++s)
+  {
+    std::cout << "\n\n ================================================== \n";
+    std::cout << "System [" << _systems[s].system.name << "] from factory ["
+              << _systems[s].factory << "]\n";
 
-        PrintResult(result);
-      }
+    std::vector<const TestResult*> systemResults;
+    for (std::size_t i = 0; i < _integrators.size(); ++i)
+    {
+      PrintResult(results[s * _integrators.size() + i]);
+      systemResults.push_back(&results[s * _integrators.size() + i]);
     }
+
+    PrintRanking(systemResults);
   }
 }
 
-/// \brief Load all the plugins that implement _interface.
-std::vector<PluginHolder> LoadPlugins(
+/// \brief Find out which SIMD variant of an integrator a plugin is, from its
+/// "<Integrator>/<instruction set>" alias (see plugins/simd.hh)
+/// \param[out] _integrator The name of the integrator, e.g. "RungeKutta4"
+/// \param[out] _instructionSet The instruction set, e.g. "avx"
+/// \return False if the plugin has no such alias
+bool FindSimdVariant(
     const ignition::plugin::Loader &_loader,
-    const std::string &_interface)
+    const std::string &_pluginName,
+    std::string &_integrator,
+    std::string &_instructionSet)
 {
-  // Fill in the holders object with each plugin.
-  std::vector<PluginHolder> holders;
+  for (const std::string &alias : _loader.AliasesOfPlugin(_pluginName))
+  {
+    const std::size_t slash = alias.rfind('/');
+    if (slash == std::string::npos)
+      continue;
+
+    _integrator = alias.substr(0, slash);
+    _instructionSet = alias.substr(slash + 1);
+    return true;
+  }
+
+  return false;
+}
 
-  const auto pluginNames = _loader.PluginsImplementing(_interface);
+/// \brief Get the names of all plugins that implement the NumericalIntegrator
+/// or the InPlaceNumericalIntegrator interface, in a stable order. SIMD
+/// variants which this CPU cannot run are left out, and so are all but the
+/// fastest variant of each integrator if _fastestOnly is true.
+std::vector<std::string> FindIntegratorPlugins(
+    const ignition::plugin::Loader &_loader,
+    const bool _fastestOnly)
+{
+  std::set<std::string> sorted;
+  for (const std::string &name :
+       _loader.PluginsImplementing<NumericalIntegrator>())
+  {
+    sorted.insert(name);
+  }
 
-  for (const std::string &name : pluginNames)
+  for (const std::string &name :
+       _loader.PluginsImplementing<InPlaceNumericalIntegrator>())
   {
-    ignition::plugin::PluginPtr plugin = _loader.Instantiate(name);
-    if (!plugin)
+    sorted.insert(name);
+  }
+
+  // The instruction sets that this CPU can run, from the fastest
+  const std::vector<std::string> fastest =
+      ignition::plugin::examples::simd::Fastest();
+
+  // The fastest variant of each integrator so far, with the rank of its
+  // instruction set in the list above
+  std::map<std::string, std::pair<std::size_t, std::string>> best;
+
+  std::vector<std::string> integrators;
+  for (const std::string &name : sorted)
+  {
+    std::string integrator;
+    std::string instructionSet;
+    if (!FindSimdVariant(_loader, name, integrator, instructionSet))
     {
-      std::cout << "Failed to load [" << name << "] as a class"
-                << std::endl;
+      integrators.push_back(name);
       continue;
     }
 
-    holders.push_back({name, plugin});
+    const std::size_t rank = static_cast<std::size_t>(
+          std::find(fastest.begin(), fastest.end(), instructionSet)
+          - fastest.begin());
+    if (rank == fastest.size())
+    {
+      std::cout << "Skipping [" << integrator << "/" << instructionSet
+                << "], because this CPU does not support ["
+                << instructionSet << "]" << std::endl;
+      continue;
+    }
+
+    if (!_fastestOnly)
+    {
+      integrators.push_back(name);
+      continue;
+    }
+
+    auto it = best.find(integrator);
+    if (it == best.end() || rank < it->second.first)
+      best[integrator] = {rank, name};
   }
 
-  return holders;
-}
+  for (const auto &variant : best)
+  {
+    std::cout << "Using the [" << fastest[variant.second.first]
+              << "] variant of [" << variant.first << "]" << std::endl;
+    integrators.push_back(variant.second.second);
+  }
 
-/// \brief Load all plugins that implement the NumericalIntegrator interface.
-std::vector<PluginHolder> LoadIntegratorPlugins(
-    const ignition::plugin::Loader &_loader)
-{
-  return LoadPlugins(
-        _loader, "ignition::plugin::examples::NumericalIntegrator");
+  return integrators;
 }
 
-/// \brief Load all plugins that implement the ODESystemFactory interface
-std::vector<PluginHolder> LoadSystemFactoryPlugins(
+/// \brief Get the systems of all plugins that implement the ODESystemFactory
+/// interface.
+std::vector<SystemHolder> CreateSystems(
     const ignition::plugin::Loader &_loader)
 {
-  return LoadPlugins(
-        _loader, "ignition::plugin::examples::ODESystemFactory");
+  const auto names = _loader.PluginsImplementing<ODESystemFactory>();
+  std::set<std::string> sorted(names.begin(), names.end());
+
+  std::vector<SystemHolder> systems;
+  for (const std::string &name : sorted)
+  {
+    ignition::plugin::PluginPtr plugin = _loader.Instantiate(name);
+    ODESystemFactory *factory =
+        plugin ? plugin->QueryInterface<ODESystemFactory>() : nullptr;
+    if (!factory)
+    {
+      std::cout << "Failed to load [" << name << "] as a class"
+                << std::endl;
+      continue;
+    }
+
+    for (ODESystem &system : factory->CreateSystems())
+      systems.push_back({name, std::move(system)});
+  }
+
+  return systems;
 }
 
 /// \brief Prime the plugin loader with the paths and library names that it
@@ -295,20 +806,21 @@ int main(int argc, char *argv[])
 
   // Add the default plugins
   std::set<std::string> pluginNames = {
-    "ForwardEuler", "RungeKutta4",
+    "ForwardEuler", "RungeKutta4", "DormandPrince45",
     "PolynomialODE", "ExponentialODE"
   };
 
-#ifdef HAVE_BOOST_PROGRAM_OPTIONS
+  BenchmarkSettings settings;
 
-  double timeStep;
-  unsigned int numSteps;
+#ifdef HAVE_BOOST_PROGRAM_OPTIONS
 
   std::string usage;
   usage +=
       "The 'integrators' example performs benchmark tests on numerical\n"
       "integrator plugins, testing them against differential equation plugins."
-      "\nNumerical integrator plugins must inherit the NumericalIntegrator \n"
+      "\nThe system x integrator pairs run in parallel, and each pair runs a\n"
+      "number of warmup trials followed by the measured trials.\n"
+      "Numerical integrator plugins must inherit the NumericalIntegrator \n"
       "interface, and differential equation plugins must inherit the \n"
       "ODESystemFactory interface. Both interfaces can be found in the header\n"
       "ign-plugin/examples/plugins/Interfaces.hh.\n\n"
@@ -330,11 +842,46 @@ int main(int argc, char *argv[])
       ("include-dirs,I", bpo::value<std::vector<std::string>>()->multitoken(),
        "Additional directories that may contain plugin libraries")
 
-      ("timestep,s", bpo::value<double>(&timeStep)->default_value(0.01),
+      ("timestep,s", bpo::value<double>(&settings.timeStep)
+         ->default_value(settings.timeStep),
        "Size of the time step (s) to take")
 
-      ("numsteps,n", bpo::value<unsigned int>(&numSteps)->default_value(10000),
-       "Number of time steps to take")
+      ("numsteps,n", bpo::value<unsigned int>(&settings.numSteps)
+         ->default_value(settings.numSteps),
+       "Number of time steps to take in each trial")
+
+      ("trials,t", bpo::value<unsigned int>(&settings.trials)
+         ->default_value(settings.trials),
+       "Number of measured trials of each pair")
+
+      ("warmup,w", bpo::value<unsigned int>(&settings.warmupTrials)
+         ->default_value(settings.warmupTrials),
+       "Number of trials of each pair to run before measuring")
+
+      ("jobs,j", bpo::value<unsigned int>(&settings.jobs)
+         ->default_value(settings.jobs),
+       "Number of pairs to run in parallel")
+
+      ("allocating",
+       "Use the NumericalIntegrator interface even for the plugins which "
+       "provide the InPlaceNumericalIntegrator interface")
+
+      ("batch,b", bpo::value<unsigned int>(&settings.batchSize)
+         ->default_value(settings.batchSize),
+       "Integrate this many copies of the initial state of each system in "
+       "every trial, using the BatchNumericalIntegrator interface where "
+       "available. 0 integrates a single state without batching.")
+
+      ("fastest",
+       "Of the integrators which come in several SIMD variants, only test "
+       "the fastest variant that this CPU supports")
+
+      ("tolerance", bpo::value<double>(&settings.tolerance)
+         ->default_value(settings.tolerance),
+       "Relative tolerance of the integrators which adapt their step size. "
+       "Their absolute tolerance is a thousandth of it. For these "
+       "integrators, the time step is the interval between the states that "
+       "they report.")
       ;
 
   bpo::positional_options_description p;
@@ -351,6 +898,12 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  if (vm.count("allocating") > 0)
+    settings.inPlace = false;
+
+  if (vm.count("fastest") > 0)
+    settings.fastestOnly = true;
+
   if (vm.count("all") == 0)
   {
     pluginNames.clear();
@@ -381,24 +934,27 @@ int main(int argc, char *argv[])
 
 #else
 
-  const double timeStep = 0.01;
-  const unsigned int numSteps = 10000;
-
   std::cout
       << "boost::program_options was not found when this example was\n"
       << "compiled, so we will default to using all the plugin libraries\n"
       << "that came with this example program. We will also default to:\n"
-      << " -- time step = " << timeStep << "\n"
-      << " -- num steps = " << numSteps << "\n"
+      << " -- time step = " << settings.timeStep << "\n"
+      << " -- num steps = " << settings.numSteps << "\n"
+      << " -- trials = " << settings.trials << "\n"
+      << " -- warmup trials = " << settings.warmupTrials << "\n"
+      << " -- jobs = " << settings.jobs << "\n"
+      << " -- batch size = " << settings.batchSize << "\n"
+      << " -- tolerance = " << settings.tolerance << "\n"
       << std::endl;
 
 #endif
 
   PrimeTheLoader(paths, loader, pluginNames);
 
-  // Load the plugins
-  const std::vector<PluginHolder> integrators = LoadIntegratorPlugins(loader);
-  const std::vector<PluginHolder> systems = LoadSystemFactoryPlugins(loader);
+  // Find the plugins
+  const std::vector<std::string> integrators =
+      FindIntegratorPlugins(loader, settings.fastestOnly);
+  const std::vector<SystemHolder> systems = CreateSystems(loader);
 
-  TestPlugins(systems, integrators, timeStep, numSteps);
+  TestPlugins(loader, systems, integrators, settings);
 }
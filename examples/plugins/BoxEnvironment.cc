@@ -20,9 +20,25 @@
 namespace BoxEnvironment {
 
 /// \brief A plugin that creates a box environment
-class Plugin : public virtual ignition::plugin::examples::Environment
+class Plugin
+    : public virtual ignition::plugin::examples::Environment,
+      public virtual ignition::plugin::examples::SharedEnvironment
 {
+  // Documentation inherited
   public: ignition::plugin::examples::Layout GenerateLayout() const override
+  {
+    return *this->layout;
+  }
+
+  // Documentation inherited
+  public: std::shared_ptr<const ignition::plugin::examples::Layout>
+  SharedLayout() const override
+  {
+    return this->layout;
+  }
+
+  /// \brief Create the walls of the box
+  private: static ignition::plugin::examples::Layout CreateLayout()
   {
     ignition::plugin::examples::Layout layout;
     const double L = 5.0;
@@ -36,10 +52,16 @@ class Plugin : public virtual ignition::plugin::examples::Environment
 
     return layout;
   }
+
+  /// \brief The layout, which every consumer shares
+  private: const std::shared_ptr<const ignition::plugin::examples::Layout>
+      layout = std::make_shared<const ignition::plugin::examples::Layout>(
+        CreateLayout());
 };
 
 }
 
 IGNITION_ADD_PLUGIN(
     BoxEnvironment::Plugin,
-    ignition::plugin::examples::Environment)
+    ignition::plugin::examples::Environment,
+    ignition::plugin::examples::SharedEnvironment)
@@ -0,0 +1,388 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <ignition/plugin/Register.hh>
+
+#include "integrators.hh"
+
+namespace ignition{
+namespace plugin {
+namespace examples {
+namespace DormandPrince45 {
+
+/// \brief The Butcher tableau of the Dormand-Prince method. The weights of
+/// the fifth order solution are the last row of the matrix, so the last
+/// stage of a step is the first stage of the next one.
+namespace tableau
+{
+  constexpr double c2 = 1.0/5.0;
+  constexpr double c3 = 3.0/10.0;
+  constexpr double c4 = 4.0/5.0;
+  constexpr double c5 = 8.0/9.0;
+
+  constexpr double a21 = 1.0/5.0;
+
+  constexpr double a31 = 3.0/40.0;
+  constexpr double a32 = 9.0/40.0;
+
+  constexpr double a41 = 44.0/45.0;
+  constexpr double a42 = -56.0/15.0;
+  constexpr double a43 = 32.0/9.0;
+
+  constexpr double a51 = 19372.0/6561.0;
+  constexpr double a52 = -25360.0/2187.0;
+  constexpr double a53 = 64448.0/6561.0;
+  constexpr double a54 = -212.0/729.0;
+
+  constexpr double a61 = 9017.0/3168.0;
+  constexpr double a62 = -355.0/33.0;
+  constexpr double a63 = 46732.0/5247.0;
+  constexpr double a64 = 49.0/176.0;
+  constexpr double a65 = -5103.0/18656.0;
+
+  constexpr double a71 = 35.0/384.0;
+  constexpr double a73 = 500.0/1113.0;
+  constexpr double a74 = 125.0/192.0;
+  constexpr double a75 = -2187.0/6784.0;
+  constexpr double a76 = 11.0/84.0;
+
+  // The difference between the weights of the fifth and the fourth order
+  // solutions, which estimates the error of a step
+  constexpr double e1 = 71.0/57600.0;
+  constexpr double e3 = -71.0/16695.0;
+  constexpr double e4 = 71.0/1920.0;
+  constexpr double e5 = -17253.0/339200.0;
+  constexpr double e6 = 22.0/525.0;
+  constexpr double e7 = -1.0/40.0;
+}
+
+/// \brief Dormand-Prince implementation of a numerical integrator, which
+/// estimates the error of each step from an embedded fourth order solution
+/// and adapts the size of its steps to keep that error within tolerances.
+class Integrator
+    : public ignition::plugin::examples::NumericalIntegrator,
+      public ignition::plugin::examples::InPlaceNumericalIntegrator,
+      public ignition::plugin::examples::AdaptiveNumericalIntegrator
+{
+  public: using Time = NumericalIntegrator::Time;
+  public: using TimeStep = NumericalIntegrator::TimeStep;
+
+  // Documentation inherited
+  public: void SetFunction(
+    const std::function<Derivative(Time, const State&)> &_func) override
+  {
+    function = _func;
+    inPlaceFunction = nullptr;
+    continuable = false;
+  }
+
+  // Documentation inherited
+  public: void SetFunction(
+    const InPlaceNumericalIntegrator::SystemODE &_func,
+    const std::size_t _dimension) override
+  {
+    inPlaceFunction = _func;
+    function = nullptr;
+    Resize(_dimension);
+  }
+
+  // Documentation inherited
+  public: bool SetTimeStep(TimeStep _step) override
+  {
+    if(_step <= 0.0)
+      return false;
+
+    timeStep = _step;
+    stepSize = 0.0;
+    continuable = false;
+    return true;
+  }
+
+  // Documentation inherited
+  public: TimeStep GetTimeStep() const override
+  {
+    return timeStep;
+  }
+
+  // Documentation inherited
+  public: bool SetTolerances(
+    const double _relative, const double _absolute) override
+  {
+    if(_relative <= 0.0 || _absolute <= 0.0)
+      return false;
+
+    relativeTolerance = _relative;
+    absoluteTolerance = _absolute;
+    return true;
+  }
+
+  // Documentation inherited
+  public: std::size_t AcceptedSteps() const override
+  {
+    return accepted;
+  }
+
+  // Documentation inherited
+  public: std::size_t RejectedSteps() const override
+  {
+    return rejected;
+  }
+
+  // Documentation inherited
+  public: std::size_t FunctionEvaluations() const override
+  {
+    return evaluations;
+  }
+
+  // Documentation inherited
+  public: void ResetStepCounts() override
+  {
+    accepted = 0;
+    rejected = 0;
+    evaluations = 0;
+  }
+
+  // Documentation inherited
+  public: State Integrate(Time _currentTime, const State &_state) const override
+  {
+    // The allocating interface does not say the dimension in advance
+    if(_state.size() != dimension)
+      Resize(_state.size());
+
+    State result = _state;
+    Advance(_currentTime, result.data());
+    return result;
+  }
+
+  // Documentation inherited
+  public: void Integrate(
+    Time _currentTime, const double *_in, double *_out) override
+  {
+    if(_out != _in)
+      std::copy(_in, _in + dimension, _out);
+
+    Advance(_currentTime, _out);
+  }
+
+  /// \brief Size the scratch space for a system
+  /// \param[in] _dimension The dimension of the system
+  private: void Resize(const std::size_t _dimension) const
+  {
+    dimension = _dimension;
+    scratch.assign(9 * _dimension, 0.0);
+    continuable = false;
+  }
+
+  /// \brief Evaluate the system of differential equations
+  /// \param[in] _time The time
+  /// \param[in] _state The state
+  /// \param[out] _derivative Receives the derivative
+  private: void Evaluate(
+    const Time _time, const double *_state, double *_derivative) const
+  {
+    ++evaluations;
+    if(inPlaceFunction)
+    {
+      inPlaceFunction(_time, _state, _derivative);
+      return;
+    }
+
+    const Derivative derivative =
+        function(_time, State(_state, _state + dimension));
+    std::copy(derivative.begin(), derivative.end(), _derivative);
+  }
+
+  /// \brief Integrate a state over one interval of GetTimeStep(), with as
+  /// many steps as the tolerances need
+  /// \param[in] _time The time of the state
+  /// \param[in,out] _y The state
+  private: void Advance(const Time _time, double *_y) const
+  {
+    using namespace tableau;
+
+    const std::size_t n = dimension;
+    double *const k1 = scratch.data();
+    double *const k2 = k1 + n;
+    double *const k3 = k2 + n;
+    double *const k4 = k3 + n;
+    double *const k5 = k4 + n;
+    double *const k6 = k5 + n;
+    double *const k7 = k6 + n;
+    double *const y = k7 + n;
+    double *const next = y + n;
+
+    const Time end = _time + timeStep;
+    Time t = _time;
+    double h = stepSize > 0.0 ? stepSize : timeStep;
+
+    // When this interval continues from the end of the last one, the
+    // derivative at its start is still in the first stage. It only continues
+    // if the time and the state are bit for bit the ones that the last
+    // interval ended with.
+    const bool continues = continuable
+        && 0 == std::memcmp(&_time, &lastEnd, sizeof(Time))
+        && 0 == std::memcmp(_y, next, n * sizeof(double));
+    if(!continues)
+      Evaluate(t, _y, k1);
+
+    while(t < end)
+    {
+      // Do not step past the end of the interval. The step size which the
+      // error control asked for is kept for the next interval.
+      const bool last = t + h >= end;
+      const double step = last ? end - t : h;
+
+      for(std::size_t i = 0; i < n; ++i)
+        y[i] = _y[i] + step*a21*k1[i];
+      Evaluate(t + c2*step, y, k2);
+
+      for(std::size_t i = 0; i < n; ++i)
+        y[i] = _y[i] + step*(a31*k1[i] + a32*k2[i]);
+      Evaluate(t + c3*step, y, k3);
+
+      for(std::size_t i = 0; i < n; ++i)
+        y[i] = _y[i] + step*(a41*k1[i] + a42*k2[i] + a43*k3[i]);
+      Evaluate(t + c4*step, y, k4);
+
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        y[i] = _y[i] + step*(a51*k1[i] + a52*k2[i] + a53*k3[i]
+                             + a54*k4[i]);
+      }
+      Evaluate(t + c5*step, y, k5);
+
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        y[i] = _y[i] + step*(a61*k1[i] + a62*k2[i] + a63*k3[i]
+                             + a64*k4[i] + a65*k5[i]);
+      }
+      Evaluate(t + step, y, k6);
+
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        next[i] = _y[i] + step*(a71*k1[i] + a73*k3[i] + a74*k4[i]
+                                + a75*k5[i] + a76*k6[i]);
+      }
+      Evaluate(t + step, next, k7);
+
+      // The root mean square of the error of each component, relative to
+      // its tolerance
+      double sum = 0.0;
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        const double error = step*(e1*k1[i] + e3*k3[i] + e4*k4[i]
+                                   + e5*k5[i] + e6*k6[i] + e7*k7[i]);
+        const double scale = absoluteTolerance + relativeTolerance
+            * std::max(std::abs(_y[i]), std::abs(next[i]));
+        sum += (error/scale) * (error/scale);
+      }
+      const double error = n > 0 ? std::sqrt(sum / n) : 0.0;
+
+      // Grow or shrink the step towards the size which would just meet the
+      // tolerances, with a safety factor, but never by too much at once
+      const double factor = error > 0.0 ?
+          std::min(5.0, std::max(0.2, 0.9 * std::pow(error, -0.2))) : 5.0;
+
+      // A step which cannot shrink any further is accepted anyway, so that
+      // the integration always makes progress
+      const bool tiny = step <= 1e-12 * std::max(1.0, std::abs(t));
+      if(error <= 1.0 || tiny)
+      {
+        ++accepted;
+        t = last ? end : t + step;
+        std::copy(next, next + n, _y);
+
+        // First same as last: the derivative at the new state is the first
+        // stage of the next step
+        std::swap_ranges(k1, k1 + n, k7);
+        if(!last)
+          h = step * factor;
+        else
+          h = std::max(h, step * factor);
+      }
+      else
+      {
+        ++rejected;
+        h = step * std::min(1.0, factor);
+      }
+    }
+
+    stepSize = h;
+    lastEnd = end;
+    continuable = true;
+  }
+
+  /// \brief The interval that each call to Integrate() covers
+  private: TimeStep timeStep = 0.01;
+
+  /// \brief The size of the next internal step, or 0 if the next interval
+  /// should start with a step as large as the interval
+  private: mutable TimeStep stepSize = 0.0;
+
+  /// \brief The end of the last interval, whose final state and derivative
+  /// are still in the scratch space if `continuable` is true
+  private: mutable Time lastEnd = 0.0;
+
+  /// \brief Whether the next interval may reuse the derivative at the end of
+  /// the last one
+  private: mutable bool continuable = false;
+
+  /// \brief The relative tolerance of the error of a step
+  private: double relativeTolerance = 1e-6;
+
+  /// \brief The absolute tolerance of the error of a step
+  private: double absoluteTolerance = 1e-9;
+
+  /// \brief The function that represents the system of ordinary differential
+  /// equations.
+  private: NumericalIntegrator::SystemODE function;
+
+  /// \brief The function that represents the system of ordinary differential
+  /// equations, for integrating in place.
+  private: InPlaceNumericalIntegrator::SystemODE inPlaceFunction;
+
+  /// \brief The dimension of the system
+  private: mutable std::size_t dimension = 0;
+
+  /// \brief Scratch space for the seven stages, the intermediate state and
+  /// the next state, sized by SetFunction() or by the first Integrate()
+  private: mutable std::vector<double> scratch;
+
+  /// \brief The number of accepted steps
+  private: mutable std::size_t accepted = 0;
+
+  /// \brief The number of rejected steps
+  private: mutable std::size_t rejected = 0;
+
+  /// \brief The number of evaluations of the system
+  private: mutable std::size_t evaluations = 0;
+};
+
+IGNITION_ADD_PLUGIN(Integrator,
+                    NumericalIntegrator,
+                    InPlaceNumericalIntegrator,
+                    AdaptiveNumericalIntegrator)
+
+}
+}
+}
+}
@@ -55,6 +55,25 @@ ODESystem CreateExponentialODE(
     return { x0*lambda * std::pow(_state[0], lambda/ln_base) * ln_base };
   };
 
+  exponential.inPlaceOde = [=](const NumericalIntegrator::Time /*_t*/,
+                               const double *_state, double *_derivative)
+  {
+    const double ln_base = std::log(base);
+    _derivative[0] = x0*lambda * std::pow(_state[0], lambda/ln_base) * ln_base;
+  };
+
+  exponential.batchOde = [=](const NumericalIntegrator::Time /*_t*/,
+                             const double *_states, double *_derivatives,
+                             const std::size_t _count)
+  {
+    const double ln_base = std::log(base);
+    for (std::size_t n = 0; n < _count; ++n)
+    {
+      _derivatives[n] =
+          x0*lambda * std::pow(_states[n], lambda/ln_base) * ln_base;
+    }
+  };
+
   return exponential;
 }
 
@@ -85,6 +104,26 @@ ODESystem CreateCircularSystem(
     return { -w * _state[1], w * _state[0] };
   };
 
+  circular.inPlaceOde = [=](const NumericalIntegrator::Time /*_t*/,
+                            const double *_state, double *_derivative)
+  {
+    _derivative[0] = -w * _state[1];
+    _derivative[1] = w * _state[0];
+  };
+
+  circular.batchOde = [=](const NumericalIntegrator::Time /*_t*/,
+                          const double *_states, double *_derivatives,
+                          const std::size_t _count)
+  {
+    const double *x = _states;
+    const double *y = _states + _count;
+    for (std::size_t n = 0; n < _count; ++n)
+    {
+      _derivatives[n] = -w * y[n];
+      _derivatives[_count + n] = w * x[n];
+    }
+  };
+
   return circular;
 }
 
@@ -120,6 +159,26 @@ ODESystem CreateSpiralSystem(
              lambda * _state[1] + w * _state[0] };
   };
 
+  spiral.inPlaceOde = [=](const NumericalIntegrator::Time /*_t*/,
+                          const double *_state, double *_derivative)
+  {
+    _derivative[0] = lambda * _state[0] - w * _state[1];
+    _derivative[1] = lambda * _state[1] + w * _state[0];
+  };
+
+  spiral.batchOde = [=](const NumericalIntegrator::Time /*_t*/,
+                        const double *_states, double *_derivatives,
+                        const std::size_t _count)
+  {
+    const double *x = _states;
+    const double *y = _states + _count;
+    for (std::size_t n = 0; n < _count; ++n)
+    {
+      _derivatives[n] = lambda * x[n] - w * y[n];
+      _derivatives[_count + n] = lambda * y[n] + w * x[n];
+    }
+  };
+
   return spiral;
 }
 
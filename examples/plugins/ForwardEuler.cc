@@ -20,6 +20,7 @@
 #include <ignition/plugin/Register.hh>
 
 #include "integrators.hh"
+#include "simd.hh"
 
 namespace ignition{
 namespace plugin {
@@ -52,9 +53,18 @@ std::vector<double> times(const double s,
   return result;
 }
 
-/// \brief Forward Euler implementation of a numerical integrator
-class Integrator : public ignition::plugin::examples::NumericalIntegrator
+/// \brief Forward Euler implementation of a numerical integrator. The
+/// in-place and batch interfaces update the states with the kernels of an
+/// instruction set, see simd.hh.
+template <typename Kernels>
+class Integrator
+    : public ignition::plugin::examples::NumericalIntegrator,
+      public ignition::plugin::examples::InPlaceNumericalIntegrator,
+      public ignition::plugin::examples::BatchNumericalIntegrator
 {
+  public: using Time = NumericalIntegrator::Time;
+  public: using TimeStep = NumericalIntegrator::TimeStep;
+
   // Documentation inherited
   public: void SetFunction(
     const std::function<Derivative(Time, const State&)> &_func) override
@@ -62,6 +72,26 @@ class Integrator : public ignition::plugin::examples::NumericalIntegrator
     function = _func;
   }
 
+  // Documentation inherited
+  public: void SetFunction(
+    const InPlaceNumericalIntegrator::SystemODE &_func,
+    const std::size_t _dimension) override
+  {
+    inPlaceFunction = _func;
+    derivative.assign(_dimension, 0.0);
+  }
+
+  // Documentation inherited
+  public: void SetFunction(
+    const BatchNumericalIntegrator::SystemODE &_func,
+    const std::size_t _dimension,
+    const std::size_t _maxCount) override
+  {
+    batchFunction = _func;
+    batchDimension = _dimension;
+    batchDerivatives.assign(_dimension * _maxCount, 0.0);
+  }
+
   // Documentation inherited
   public: bool SetTimeStep(TimeStep _step) override
   {
@@ -88,16 +118,78 @@ class Integrator : public ignition::plugin::examples::NumericalIntegrator
     return add(yn, times(h, function(tn, yn)));
   }
 
+  // Documentation inherited
+  public: void Integrate(
+    Time _currentTime, const double *_in, double *_out) override
+  {
+    const TimeStep h = timeStep;
+    double *const k = derivative.data();
+
+    inPlaceFunction(_currentTime, _in, k);
+    Kernels::Axpy(derivative.size(), h, _in, k, _out);
+  }
+
+  // Documentation inherited
+  public: void BatchIntegrate(
+    Time _currentTime, double *_states, const std::size_t _count) override
+  {
+    const TimeStep h = timeStep;
+    const std::size_t size = batchDimension * _count;
+    double *const k = batchDerivatives.data();
+
+    batchFunction(_currentTime, _states, k, _count);
+
+    // The block is contiguous, so every component of every state gets
+    // updated by a single kernel
+    Kernels::Axpy(size, h, _states, k, _states);
+  }
+
   /// \brief The time step that will be used when integrating
   private: TimeStep timeStep;
 
   /// \brief The function that represents the system of ordinary differential
   /// equations.
-  private: SystemODE function;
+  private: NumericalIntegrator::SystemODE function;
+
+  /// \brief The function that represents the system of ordinary differential
+  /// equations, for integrating in place.
+  private: InPlaceNumericalIntegrator::SystemODE inPlaceFunction;
+
+  /// \brief Scratch space for the derivative, sized by SetFunction()
+  private: std::vector<double> derivative;
+
+  /// \brief The function that represents the system of ordinary differential
+  /// equations, for integrating blocks of states.
+  private: BatchNumericalIntegrator::SystemODE batchFunction;
+
+  /// \brief The dimension of each state of a block
+  private: std::size_t batchDimension = 0;
+
+  /// \brief Scratch space for the derivatives of a block of states, sized
+  /// by SetFunction()
+  private: std::vector<double> batchDerivatives;
 
 };
 
-IGNITION_ADD_PLUGIN(Integrator, NumericalIntegrator)
+IGNITION_ADD_PLUGIN(Integrator<simd::Scalar>,
+                    NumericalIntegrator,
+                    InPlaceNumericalIntegrator,
+                    BatchNumericalIntegrator)
+IGNITION_ADD_PLUGIN_ALIAS(Integrator<simd::Scalar>, "ForwardEuler/scalar")
+
+#ifdef IGN_PLUGIN_EXAMPLES_HAVE_X86_SIMD
+IGNITION_ADD_PLUGIN(Integrator<simd::SSE2>,
+                    NumericalIntegrator,
+                    InPlaceNumericalIntegrator,
+                    BatchNumericalIntegrator)
+IGNITION_ADD_PLUGIN_ALIAS(Integrator<simd::SSE2>, "ForwardEuler/sse2")
+
+IGNITION_ADD_PLUGIN(Integrator<simd::AVX>,
+                    NumericalIntegrator,
+                    InPlaceNumericalIntegrator,
+                    BatchNumericalIntegrator)
+IGNITION_ADD_PLUGIN_ALIAS(Integrator<simd::AVX>, "ForwardEuler/avx")
+#endif
 
 }
 }
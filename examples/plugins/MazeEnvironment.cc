@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "robot.hh"
+
+namespace MazeEnvironment {
+
+/// \brief A plugin that creates a large maze of 1 meter cells, for measuring
+/// how the simulation copes with many walls. Every wall of a cell is a wall
+/// of its own in the layout, which gives about 40 thousand walls. The maze is
+/// always the same, and the robot starts in the middle of its central cell.
+class Plugin
+    : public virtual ignition::plugin::examples::Environment,
+      public virtual ignition::plugin::examples::SharedEnvironment
+{
+  // Documentation inherited
+  public: ignition::plugin::examples::Layout GenerateLayout() const override
+  {
+    return *this->layout;
+  }
+
+  // Documentation inherited
+  public: std::shared_ptr<const ignition::plugin::examples::Layout>
+  SharedLayout() const override
+  {
+    return this->layout;
+  }
+
+  /// \brief Generate the walls of the maze
+  private: static ignition::plugin::examples::Layout CreateLayout()
+  {
+    // The number of cells along each side. This is odd, so that the origin
+    // is the center of a cell.
+    const int N = 201;
+    const double offset = static_cast<double>(N / 2);
+
+    // Whether each cell still has its east and its north wall
+    std::vector<bool> east(N * N, true);
+    std::vector<bool> north(N * N, true);
+    std::vector<bool> visited(N * N, false);
+
+    // Carve the passages with a depth-first search, which leaves exactly one
+    // path between any two cells
+    std::mt19937 random(42);
+    std::vector<int> stack = {0};
+    visited[0] = true;
+    while (!stack.empty())
+    {
+      const int cell = stack.back();
+      const int i = cell % N;
+      const int j = cell / N;
+
+      int neighbors[4];
+      int numNeighbors = 0;
+      if (i + 1 < N && !visited[cell + 1])
+        neighbors[numNeighbors++] = cell + 1;
+      if (i > 0 && !visited[cell - 1])
+        neighbors[numNeighbors++] = cell - 1;
+      if (j + 1 < N && !visited[cell + N])
+        neighbors[numNeighbors++] = cell + N;
+      if (j > 0 && !visited[cell - N])
+        neighbors[numNeighbors++] = cell - N;
+
+      if (numNeighbors == 0)
+      {
+        stack.pop_back();
+        continue;
+      }
+
+      const int next = neighbors[
+          std::uniform_int_distribution<int>(0, numNeighbors - 1)(random)];
+
+      if (next == cell + 1)
+        east[cell] = false;
+      else if (next == cell - 1)
+        east[next] = false;
+      else if (next == cell + N)
+        north[cell] = false;
+      else
+        north[next] = false;
+
+      visited[next] = true;
+      stack.push_back(next);
+    }
+
+    using ignition::math::Vector2d;
+
+    ignition::plugin::examples::Layout layout;
+    for (int j = 0; j < N; ++j)
+    {
+      for (int i = 0; i < N; ++i)
+      {
+        const double x0 = i - offset - 0.5;
+        const double y0 = j - offset - 0.5;
+        const double x1 = x0 + 1.0;
+        const double y1 = y0 + 1.0;
+
+        if (i == 0)
+          layout.push_back(std::make_pair(Vector2d(x0, y0), Vector2d(x0, y1)));
+        if (j == 0)
+          layout.push_back(std::make_pair(Vector2d(x0, y0), Vector2d(x1, y0)));
+        if (east[j * N + i])
+          layout.push_back(std::make_pair(Vector2d(x1, y0), Vector2d(x1, y1)));
+        if (north[j * N + i])
+          layout.push_back(std::make_pair(Vector2d(x0, y1), Vector2d(x1, y1)));
+      }
+    }
+
+    return layout;
+  }
+
+  /// \brief The layout, which is generated once when the plugin is
+  /// instantiated, and which every consumer shares
+  private: const std::shared_ptr<const ignition::plugin::examples::Layout>
+      layout = std::make_shared<const ignition::plugin::examples::Layout>(
+        CreateLayout());
+};
+
+}
+
+IGNITION_ADD_PLUGIN(
+    MazeEnvironment::Plugin,
+    ignition::plugin::examples::Environment,
+    ignition::plugin::examples::SharedEnvironment)
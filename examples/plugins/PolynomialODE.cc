@@ -56,6 +56,20 @@ ODESystem CreateParabolicODE(
     return {a*(_t+t0) + v0};
   };
 
+  parabola.inPlaceOde = [=](const NumericalIntegrator::Time _t,
+                            const double * /*_state*/, double *_derivative)
+  {
+    _derivative[0] = a*(_t+t0) + v0;
+  };
+
+  parabola.batchOde = [=](const NumericalIntegrator::Time _t,
+                          const double * /*_states*/, double *_derivatives,
+                          const std::size_t _count)
+  {
+    for (std::size_t n = 0; n < _count; ++n)
+      _derivatives[n] = a*(_t+t0) + v0;
+  };
+
   return parabola;
 }
 
@@ -89,6 +103,24 @@ ODESystem CreateParabolicSystem(
     return {_state[1], a};
   };
 
+  parabola.inPlaceOde = [=](const NumericalIntegrator::Time /*_t*/,
+                            const double *_state, double *_derivative)
+  {
+    _derivative[0] = _state[1];
+    _derivative[1] = a;
+  };
+
+  parabola.batchOde = [=](const NumericalIntegrator::Time /*_t*/,
+                          const double *_states, double *_derivatives,
+                          const std::size_t _count)
+  {
+    for (std::size_t n = 0; n < _count; ++n)
+    {
+      _derivatives[n] = _states[_count + n];
+      _derivatives[_count + n] = a;
+    }
+  };
+
   return parabola;
 }
 
@@ -126,6 +158,25 @@ ODESystem CreateCubicODE(
             +          v0*std::pow(_t+t0, 0) };
   };
 
+  cubic.inPlaceOde = [=](const NumericalIntegrator::Time _t,
+                         const double * /*_state*/, double *_derivative)
+  {
+    _derivative[0] = 1.0/2.0*jerk*std::pow(_t+t0, 2)
+                   +          a0*std::pow(_t+t0, 1)
+                   +          v0*std::pow(_t+t0, 0);
+  };
+
+  cubic.batchOde = [=](const NumericalIntegrator::Time _t,
+                       const double * /*_states*/, double *_derivatives,
+                       const std::size_t _count)
+  {
+    const double derivative = 1.0/2.0*jerk*std::pow(_t+t0, 2)
+                            +          a0*std::pow(_t+t0, 1)
+                            +          v0*std::pow(_t+t0, 0);
+    for (std::size_t n = 0; n < _count; ++n)
+      _derivatives[n] = derivative;
+  };
+
   return cubic;
 }
 
@@ -168,6 +219,26 @@ ODESystem CreateCubicSystem(
     return { _state[1], _state[2], jerk };
   };
 
+  cubic.inPlaceOde = [=](const NumericalIntegrator::Time /*_t*/,
+                         const double *_state, double *_derivative)
+  {
+    _derivative[0] = _state[1];
+    _derivative[1] = _state[2];
+    _derivative[2] = jerk;
+  };
+
+  cubic.batchOde = [=](const NumericalIntegrator::Time /*_t*/,
+                       const double *_states, double *_derivatives,
+                       const std::size_t _count)
+  {
+    for (std::size_t n = 0; n < _count; ++n)
+    {
+      _derivatives[n] = _states[_count + n];
+      _derivatives[_count + n] = _states[2*_count + n];
+      _derivatives[2*_count + n] = jerk;
+    }
+  };
+
   return cubic;
 }
 
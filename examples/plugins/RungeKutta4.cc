@@ -20,6 +20,7 @@
 #include <ignition/plugin/Register.hh>
 
 #include "integrators.hh"
+#include "simd.hh"
 
 namespace ignition{
 namespace plugin {
@@ -52,9 +53,18 @@ std::vector<double> times(const double s,
   return result;
 }
 
-/// \brief RK4 implementation of a numerical integrator
-class Integrator : public ignition::plugin::examples::NumericalIntegrator
+/// \brief RK4 implementation of a numerical integrator. The in-place and
+/// batch interfaces update the states with the kernels of an instruction set,
+/// see simd.hh.
+template <typename Kernels>
+class Integrator
+    : public ignition::plugin::examples::NumericalIntegrator,
+      public ignition::plugin::examples::InPlaceNumericalIntegrator,
+      public ignition::plugin::examples::BatchNumericalIntegrator
 {
+  public: using Time = NumericalIntegrator::Time;
+  public: using TimeStep = NumericalIntegrator::TimeStep;
+
   // Documentation inherited
   public: void SetFunction(
     const std::function<Derivative(Time, const State&)> &_func) override
@@ -62,6 +72,27 @@ class Integrator : public ignition::plugin::examples::NumericalIntegrator
     function = _func;
   }
 
+  // Documentation inherited
+  public: void SetFunction(
+    const InPlaceNumericalIntegrator::SystemODE &_func,
+    const std::size_t _dimension) override
+  {
+    inPlaceFunction = _func;
+    scratch.assign(5 * _dimension, 0.0);
+    dimension = _dimension;
+  }
+
+  // Documentation inherited
+  public: void SetFunction(
+    const BatchNumericalIntegrator::SystemODE &_func,
+    const std::size_t _dimension,
+    const std::size_t _maxCount) override
+  {
+    batchFunction = _func;
+    batchDimension = _dimension;
+    batchScratch.assign(5 * _dimension * _maxCount, 0.0);
+  }
+
   // Documentation inherited
   public: bool SetTimeStep(TimeStep _step) override
   {
@@ -96,16 +127,114 @@ class Integrator : public ignition::plugin::examples::NumericalIntegrator
                                             add(times(2.0, k3), k4)))));
   }
 
+  // Documentation inherited
+  public: void Integrate(
+    Time _currentTime, const double *_in, double *_out) override
+  {
+    const Time tn = _currentTime;
+    const TimeStep h = timeStep;
+    const std::size_t n = dimension;
+
+    double *const k1 = scratch.data();
+    double *const k2 = k1 + n;
+    double *const k3 = k2 + n;
+    double *const k4 = k3 + n;
+    double *const y = k4 + n;
+
+    inPlaceFunction(tn, _in, k1);
+
+    Kernels::Axpy(n, h/2.0, _in, k1, y);
+    inPlaceFunction(tn + h/2.0, y, k2);
+
+    Kernels::Axpy(n, h/2.0, _in, k2, y);
+    inPlaceFunction(tn + h/2.0, y, k3);
+
+    Kernels::Axpy(n, h, _in, k3, y);
+    inPlaceFunction(tn + h, y, k4);
+
+    Kernels::CombineRK4(n, h/6.0, _in, k1, k2, k3, k4, _out);
+  }
+
+  // Documentation inherited
+  public: void BatchIntegrate(
+    Time _currentTime, double *_states, const std::size_t _count) override
+  {
+    const Time tn = _currentTime;
+    const TimeStep h = timeStep;
+    const std::size_t size = batchDimension * _count;
+
+    // The blocks are contiguous, so each stage is a single kernel over every
+    // component of every state
+    double *const k1 = batchScratch.data();
+    double *const k2 = k1 + size;
+    double *const k3 = k2 + size;
+    double *const k4 = k3 + size;
+    double *const y = k4 + size;
+
+    batchFunction(tn, _states, k1, _count);
+
+    Kernels::Axpy(size, h/2.0, _states, k1, y);
+    batchFunction(tn + h/2.0, y, k2, _count);
+
+    Kernels::Axpy(size, h/2.0, _states, k2, y);
+    batchFunction(tn + h/2.0, y, k3, _count);
+
+    Kernels::Axpy(size, h, _states, k3, y);
+    batchFunction(tn + h, y, k4, _count);
+
+    Kernels::CombineRK4(size, h/6.0, _states, k1, k2, k3, k4, _states);
+  }
+
   /// \brief The time step that will be used when integrating
   private: TimeStep timeStep;
 
   /// \brief The function that represents the system of ordinary differential
   /// equations.
-  private: SystemODE function;
+  private: NumericalIntegrator::SystemODE function;
+
+  /// \brief The function that represents the system of ordinary differential
+  /// equations, for integrating in place.
+  private: InPlaceNumericalIntegrator::SystemODE inPlaceFunction;
+
+  /// \brief The dimension of the system
+  private: std::size_t dimension = 0;
+
+  /// \brief Scratch space for the four slopes and the intermediate state,
+  /// sized by SetFunction()
+  private: std::vector<double> scratch;
+
+  /// \brief The function that represents the system of ordinary differential
+  /// equations, for integrating blocks of states.
+  private: BatchNumericalIntegrator::SystemODE batchFunction;
+
+  /// \brief The dimension of each state of a block
+  private: std::size_t batchDimension = 0;
+
+  /// \brief Scratch space for the four slopes and the intermediate states of
+  /// a block of states, sized by SetFunction()
+  private: std::vector<double> batchScratch;
 
 };
 
-IGNITION_ADD_PLUGIN(Integrator, NumericalIntegrator)
+IGNITION_ADD_PLUGIN(Integrator<simd::Scalar>,
+                    NumericalIntegrator,
+                    InPlaceNumericalIntegrator,
+                    BatchNumericalIntegrator)
+IGNITION_ADD_PLUGIN_ALIAS(Integrator<simd::Scalar>, "RungeKutta4/scalar")
+
+#ifdef IGN_PLUGIN_EXAMPLES_HAVE_X86_SIMD
+IGNITION_ADD_PLUGIN(Integrator<simd::SSE2>,
+                    NumericalIntegrator,
+                    InPlaceNumericalIntegrator,
+                    BatchNumericalIntegrator)
+IGNITION_ADD_PLUGIN_ALIAS(Integrator<simd::SSE2>, "RungeKutta4/sse2")
+
+IGNITION_ADD_PLUGIN(Integrator<simd::AVX>,
+                    NumericalIntegrator,
+                    InPlaceNumericalIntegrator,
+                    BatchNumericalIntegrator)
+IGNITION_ADD_PLUGIN_ALIAS(Integrator<simd::AVX>, "RungeKutta4/avx")
+#endif
 
 }
 }
@@ -18,8 +18,10 @@
 #ifndef IGNITION_PLUGIN_EXAMPLES_PLUGINS_INTEGRATORS_HH_
 #define IGNITION_PLUGIN_EXAMPLES_PLUGINS_INTEGRATORS_HH_
 
-#include <vector>
+#include <cstddef>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace ignition
 {
@@ -72,6 +74,153 @@ namespace ignition
         public: virtual ~NumericalIntegrator() = default;
       };
 
+      /// \brief A revision of the NumericalIntegrator interface which works
+      /// on arrays that the caller owns, instead of returning a new State for
+      /// each step. An implementation allocates whatever it needs in
+      /// SetFunction(), so that Integrate() never touches the allocator.
+      ///
+      /// A plugin may provide both interfaces.
+      class InPlaceNumericalIntegrator
+      {
+        public: using Time = NumericalIntegrator::Time;
+        public: using TimeStep = NumericalIntegrator::TimeStep;
+
+        /// \brief A system of ordinary differential equations which writes
+        /// the derivative of _state at _time into _derivative. These are
+        /// separate arrays, which both have the dimension of the system.
+        public: using SystemODE = std::function<void(
+            Time _time, const double *_state, double *_derivative)>;
+
+        /// \brief Set the function that defines the system of ordinary
+        /// differential equations that this integrator should operate on.
+        /// \param[in] _func The system of ordinary differential equations
+        /// \param[in] _dimension The number of components of the state of
+        /// the system
+        public: virtual void SetFunction(
+            const SystemODE &_func, std::size_t _dimension) = 0;
+
+        /// \brief Set the amount of time that this integrator should step each
+        /// time the Integrate() function is called.
+        /// \param[in] The desired size of the step, in units of seconds.
+        /// \return False if the integrator does not support the requested step
+        /// size.
+        public: virtual bool SetTimeStep(TimeStep _step) = 0;
+
+        /// \brief Get the time step size that the integrator is currently set
+        /// to use.
+        /// \return Current time step size.
+        public: virtual TimeStep GetTimeStep() const = 0;
+
+        /// \brief Integrate a state forward in time by GetTimeStep().
+        /// \param[in] _currentTime The time of _in
+        /// \param[in] _in The current state
+        /// \param[out] _out Receives the integrated state. This may be the
+        /// same array as _in.
+        public: virtual void Integrate(
+            Time _currentTime, const double *_in, double *_out) = 0;
+
+        /// \brief Virtual destructor
+        public: virtual ~InPlaceNumericalIntegrator() = default;
+      };
+
+      /// \brief An optional capability of integrators, for integrating many
+      /// independent states of the same system at once. The states are kept
+      /// in a structure-of-arrays block: with N states of dimension D, the
+      /// block holds D rows of N values, so component d of state n is at
+      /// index d * N + n. This lets an implementation run each step as a
+      /// few long loops over contiguous memory, which the compiler can
+      /// vectorize, instead of making a virtual call per state.
+      ///
+      /// Callers should fall back to integrating the states one by one when
+      /// a plugin does not provide this interface.
+      class BatchNumericalIntegrator
+      {
+        public: using Time = NumericalIntegrator::Time;
+        public: using TimeStep = NumericalIntegrator::TimeStep;
+
+        /// \brief A system of ordinary differential equations which writes
+        /// the derivatives of a block of _count states at _time into a block
+        /// of the same layout. These are separate blocks.
+        public: using SystemODE = std::function<void(
+            Time _time, const double *_states, double *_derivatives,
+            std::size_t _count)>;
+
+        /// \brief Set the function that defines the system of ordinary
+        /// differential equations that this integrator should operate on.
+        /// \param[in] _func The system of ordinary differential equations
+        /// \param[in] _dimension The number of components of each state
+        /// \param[in] _maxCount The largest number of states that will be
+        /// integrated at once
+        public: virtual void SetFunction(
+            const SystemODE &_func,
+            std::size_t _dimension,
+            std::size_t _maxCount) = 0;
+
+        /// \brief Set the amount of time that this integrator should step each
+        /// time the Integrate() function is called.
+        /// \param[in] The desired size of the step, in units of seconds.
+        /// \return False if the integrator does not support the requested step
+        /// size.
+        public: virtual bool SetTimeStep(TimeStep _step) = 0;
+
+        /// \brief Get the time step size that the integrator is currently set
+        /// to use.
+        /// \return Current time step size.
+        public: virtual TimeStep GetTimeStep() const = 0;
+
+        /// \brief Integrate a block of states forward in time by
+        /// GetTimeStep(), in place.
+        /// \param[in] _currentTime The time of the states
+        /// \param[in,out] _states The block of states
+        /// \param[in] _count The number of states in the block. This must
+        /// not be more than the _maxCount that was passed to SetFunction().
+        public: virtual void BatchIntegrate(
+            Time _currentTime, double *_states, std::size_t _count) = 0;
+
+        /// \brief Virtual destructor
+        public: virtual ~BatchNumericalIntegrator() = default;
+      };
+
+      /// \brief An optional capability of integrators which adapt the size
+      /// of their steps to the error that they make. For such an integrator,
+      /// GetTimeStep() is the interval that each call to Integrate() covers,
+      /// and it takes as many internal steps within that interval as it needs
+      /// to keep the estimated error of each step within the tolerances.
+      class AdaptiveNumericalIntegrator
+      {
+        /// \brief Set how much error each internal step may make. A step is
+        /// accepted if the estimated error of each component of the state is
+        /// within _absolute + _relative * |component|, and taken again with
+        /// a smaller size otherwise.
+        /// \param[in] _relative The relative tolerance
+        /// \param[in] _absolute The absolute tolerance
+        /// \return False if the tolerances are not positive
+        public: virtual bool SetTolerances(
+            double _relative, double _absolute) = 0;
+
+        /// \brief Get the number of internal steps which were accepted since
+        /// the last call to ResetStepCounts()
+        /// \return The number of accepted steps
+        public: virtual std::size_t AcceptedSteps() const = 0;
+
+        /// \brief Get the number of internal steps which were rejected, and
+        /// taken again with a smaller size, since the last call to
+        /// ResetStepCounts()
+        /// \return The number of rejected steps
+        public: virtual std::size_t RejectedSteps() const = 0;
+
+        /// \brief Get the number of times that the system of differential
+        /// equations was evaluated since the last call to ResetStepCounts()
+        /// \return The number of evaluations
+        public: virtual std::size_t FunctionEvaluations() const = 0;
+
+        /// \brief Start counting the steps and evaluations from zero
+        public: virtual void ResetStepCounts() = 0;
+
+        /// \brief Virtual destructor
+        public: virtual ~AdaptiveNumericalIntegrator() = default;
+      };
+
       /// \brief A system of ordinary differential equations that each
       /// NumericalIntegrator implementation can be tested against.
       struct ODESystem
@@ -83,6 +232,15 @@ namespace ignition
         /// numerical integrators.
         public: NumericalIntegrator::SystemODE ode;
 
+        /// \brief The same system of Ordinary Differential Equations, for
+        /// testing the InPlaceNumericalIntegrators. This may be empty, in
+        /// which case only the NumericalIntegrators get tested.
+        public: InPlaceNumericalIntegrator::SystemODE inPlaceOde;
+
+        /// \brief The same system of Ordinary Differential Equations, for
+        /// testing the BatchNumericalIntegrators. This may be empty.
+        public: BatchNumericalIntegrator::SystemODE batchOde;
+
         /// \brief The initial time of the system.
         public: NumericalIntegrator::Time initialTime;
 
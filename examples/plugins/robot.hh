@@ -18,7 +18,9 @@
 #ifndef IGNITION_PLUGIN_EXAMPLES_PLUGINS_ROBOT_HH_
 #define IGNITION_PLUGIN_EXAMPLES_PLUGINS_ROBOT_HH_
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include <ignition/math/Vector2.hh>
 #include <ignition/math/Vector3.hh>
@@ -130,6 +132,38 @@ namespace ignition
         /// \brief Virtual destructor
         public: virtual ~Environment() = default;
       };
+
+      /////////////////////////////////////////////////
+      /// \brief Revision of the Environment interface, for large layouts that
+      /// many consumers use at once. Instead of handing out a copy of the
+      /// layout to every caller, the environment keeps one immutable copy,
+      /// and every caller shares it.
+      class SharedEnvironment
+      {
+        /// \brief Get the layout of the environment.
+        /// \return The layout, which never changes. Every call returns the
+        /// same copy of it.
+        public: virtual std::shared_ptr<const Layout> SharedLayout() const = 0;
+
+        /// \brief Virtual destructor
+        public: virtual ~SharedEnvironment() = default;
+      };
+
+      /////////////////////////////////////////////////
+      /// \brief Revision of the MapDatabase interface, for robots that keep
+      /// the map. They get to share the layout of the SharedEnvironment,
+      /// instead of copying it.
+      class SharedMapDatabase
+      {
+        /// \brief Get a complete map reading.
+        /// \param[in] _map The complete map of the environment, which never
+        /// changes. It may be kept for as long as needed.
+        public: virtual void ReadSharedMap(
+          std::shared_ptr<const Layout> _map) = 0;
+
+        /// \brief Virtual destructor
+        public: virtual ~SharedMapDatabase() = default;
+      };
     }
   }
 }
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_PLUGIN_EXAMPLES_PLUGINS_SIMD_HH_
+#define IGNITION_PLUGIN_EXAMPLES_PLUGINS_SIMD_HH_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// The vectorized kernels use x86 intrinsics, and the target attribute of GCC
+// and Clang, so that they can be compiled without -mavx and only get called
+// when the CPU supports them. Anywhere else, only the scalar kernels exist.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define IGN_PLUGIN_EXAMPLES_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace ignition
+{
+  namespace plugin
+  {
+    namespace examples
+    {
+      /// \brief Kernels for the state updates of the integrator plugins, one
+      /// struct per instruction set. The integrators are templates on these
+      /// structs, and each instantiation is registered as a plugin of its own
+      /// with the alias "<Integrator>/<name>", e.g. "RungeKutta4/avx". A host
+      /// calls simd::Fastest() to pick the best variant that the CPU can run.
+      ///
+      /// The vectorized kernels do the same operations in the same order as
+      /// the scalar ones, without fusing multiplies and adds, so the variants
+      /// agree unless the compiler fuses the scalar loops (e.g. with -mfma).
+      namespace simd
+      {
+        /// \brief Plain loops, which work everywhere
+        struct Scalar
+        {
+          /// \brief The name of the instruction set, as used in the aliases
+          public: static constexpr const char *name = "scalar";
+
+          /// \brief Whether the CPU can run these kernels
+          public: static bool Supported()
+          {
+            return true;
+          }
+
+          /// \brief Compute _out = _x + _a * _y. _out may alias _x or _y.
+          public: static void Axpy(
+            const std::size_t _n, const double _a,
+            const double *_x, const double *_y, double *_out)
+          {
+            for (std::size_t i = 0; i < _n; ++i)
+              _out[i] = _x[i] + _a * _y[i];
+          }
+
+          /// \brief Compute the final update of an RK4 step,
+          /// _out = _x + _a * (_k1 + 2*_k2 + 2*_k3 + _k4). _out may alias _x.
+          public: static void CombineRK4(
+            const std::size_t _n, const double _a, const double *_x,
+            const double *_k1, const double *_k2,
+            const double *_k3, const double *_k4,
+            double *_out)
+          {
+            for (std::size_t i = 0; i < _n; ++i)
+            {
+              _out[i] =
+                  _x[i] + _a * (_k1[i] + 2.0*_k2[i] + 2.0*_k3[i] + _k4[i]);
+            }
+          }
+        };
+
+#ifdef IGN_PLUGIN_EXAMPLES_HAVE_X86_SIMD
+        /// \brief 128-bit vectors of 2 doubles
+        struct SSE2
+        {
+          /// \brief The name of the instruction set, as used in the aliases
+          public: static constexpr const char *name = "sse2";
+
+          /// \brief Whether the CPU can run these kernels
+          public: static bool Supported()
+          {
+            return __builtin_cpu_supports("sse2");
+          }
+
+          /// \brief Compute _out = _x + _a * _y. _out may alias _x or _y.
+          public: __attribute__((target("sse2"))) static void Axpy(
+            const std::size_t _n, const double _a,
+            const double *_x, const double *_y, double *_out)
+          {
+            const __m128d a = _mm_set1_pd(_a);
+
+            std::size_t i = 0;
+            for (; i + 2 <= _n; i += 2)
+            {
+              const __m128d ay = _mm_mul_pd(a, _mm_loadu_pd(_y + i));
+              _mm_storeu_pd(_out + i, _mm_add_pd(_mm_loadu_pd(_x + i), ay));
+            }
+
+            Scalar::Axpy(_n - i, _a, _x + i, _y + i, _out + i);
+          }
+
+          /// \brief Compute the final update of an RK4 step,
+          /// _out = _x + _a * (_k1 + 2*_k2 + 2*_k3 + _k4). _out may alias _x.
+          public: __attribute__((target("sse2"))) static void CombineRK4(
+            const std::size_t _n, const double _a, const double *_x,
+            const double *_k1, const double *_k2,
+            const double *_k3, const double *_k4,
+            double *_out)
+          {
+            const __m128d a = _mm_set1_pd(_a);
+            const __m128d two = _mm_set1_pd(2.0);
+
+            std::size_t i = 0;
+            for (; i + 2 <= _n; i += 2)
+            {
+              __m128d sum = _mm_loadu_pd(_k1 + i);
+              sum = _mm_add_pd(sum, _mm_mul_pd(two, _mm_loadu_pd(_k2 + i)));
+              sum = _mm_add_pd(sum, _mm_mul_pd(two, _mm_loadu_pd(_k3 + i)));
+              sum = _mm_add_pd(sum, _mm_loadu_pd(_k4 + i));
+              _mm_storeu_pd(_out + i, _mm_add_pd(
+                    _mm_loadu_pd(_x + i), _mm_mul_pd(a, sum)));
+            }
+
+            Scalar::CombineRK4(_n - i, _a, _x + i, _k1 + i, _k2 + i, _k3 + i,
+                               _k4 + i, _out + i);
+          }
+        };
+
+        /// \brief 256-bit vectors of 4 doubles
+        struct AVX
+        {
+          /// \brief The name of the instruction set, as used in the aliases
+          public: static constexpr const char *name = "avx";
+
+          /// \brief Whether the CPU can run these kernels
+          public: static bool Supported()
+          {
+            return __builtin_cpu_supports("avx");
+          }
+
+          /// \brief Compute _out = _x + _a * _y. _out may alias _x or _y.
+          public: __attribute__((target("avx"))) static void Axpy(
+            const std::size_t _n, const double _a,
+            const double *_x, const double *_y, double *_out)
+          {
+            const __m256d a = _mm256_set1_pd(_a);
+
+            std::size_t i = 0;
+            for (; i + 4 <= _n; i += 4)
+            {
+              const __m256d ay = _mm256_mul_pd(a, _mm256_loadu_pd(_y + i));
+              _mm256_storeu_pd(_out + i,
+                               _mm256_add_pd(_mm256_loadu_pd(_x + i), ay));
+            }
+
+            Scalar::Axpy(_n - i, _a, _x + i, _y + i, _out + i);
+          }
+
+          /// \brief Compute the final update of an RK4 step,
+          /// _out = _x + _a * (_k1 + 2*_k2 + 2*_k3 + _k4). _out may alias _x.
+          public: __attribute__((target("avx"))) static void CombineRK4(
+            const std::size_t _n, const double _a, const double *_x,
+            const double *_k1, const double *_k2,
+            const double *_k3, const double *_k4,
+            double *_out)
+          {
+            const __m256d a = _mm256_set1_pd(_a);
+            const __m256d two = _mm256_set1_pd(2.0);
+
+            std::size_t i = 0;
+            for (; i + 4 <= _n; i += 4)
+            {
+              __m256d sum = _mm256_loadu_pd(_k1 + i);
+              sum = _mm256_add_pd(
+                    sum, _mm256_mul_pd(two, _mm256_loadu_pd(_k2 + i)));
+              sum = _mm256_add_pd(
+                    sum, _mm256_mul_pd(two, _mm256_loadu_pd(_k3 + i)));
+              sum = _mm256_add_pd(sum, _mm256_loadu_pd(_k4 + i));
+              _mm256_storeu_pd(_out + i, _mm256_add_pd(
+                    _mm256_loadu_pd(_x + i), _mm256_mul_pd(a, sum)));
+            }
+
+            Scalar::CombineRK4(_n - i, _a, _x + i, _k1 + i, _k2 + i, _k3 + i,
+                               _k4 + i, _out + i);
+          }
+        };
+#endif
+
+        /// \brief Check whether the CPU can run an instruction set
+        /// \param[in] _name The name of the instruction set, e.g. "avx"
+        /// \return True if the instruction set is known and supported
+        inline bool Supported(const std::string &_name)
+        {
+          if (_name == Scalar::name)
+            return Scalar::Supported();
+#ifdef IGN_PLUGIN_EXAMPLES_HAVE_X86_SIMD
+          if (_name == SSE2::name)
+            return SSE2::Supported();
+          if (_name == AVX::name)
+            return AVX::Supported();
+#endif
+          return false;
+        }
+
+        /// \brief Get the names of the instruction sets that the CPU can run,
+        /// from the fastest to the slowest
+        inline std::vector<std::string> Fastest()
+        {
+          std::vector<std::string> names;
+#ifdef IGN_PLUGIN_EXAMPLES_HAVE_X86_SIMD
+          if (AVX::Supported())
+            names.push_back(AVX::name);
+          if (SSE2::Supported())
+            names.push_back(SSE2::name);
+#endif
+          names.push_back(Scalar::name);
+          return names;
+        }
+      }
+    }
+  }
+}
+
+#endif
@@ -15,9 +15,17 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
 #include <set>
+#include <thread>
+#include <vector>
 
 #include "plugins/robot.hh"
 
@@ -40,11 +48,12 @@ using namespace ignition::plugin::examples;
 
 /////////////////////////////////////////////////
 using RobotPluginPtr = ignition::plugin::SpecializedPluginPtr<
-    Drive, ProximitySensor, GPSSensor, Compass, MapDatabase>;
+    Drive, ProximitySensor, GPSSensor, Compass, MapDatabase,
+    SharedMapDatabase>;
 
 /////////////////////////////////////////////////
 using EnvironmentPluginPtr =
-    ignition::plugin::SpecializedPluginPtr<Environment>;
+    ignition::plugin::SpecializedPluginPtr<Environment, SharedEnvironment>;
 
 using PointPair = std::pair<ignition::math::Vector2d, ignition::math::Vector2d>;
 
@@ -83,12 +92,23 @@ IntersectionResult CheckIntersection(
   const double x = (B[1]*C[0] - B[0]*C[1])/det;
   const double y = (A[0]*C[1] - A[1]*C[0])/det;
 
+  // The intersection of the lines must lie on both segments. Both
+  // coordinates are checked, since one of them is constant along vertical
+  // or horizontal segments. The tolerance makes up for the rounding of x
+  // and y.
+  const double tolerance = 1e-9;
   for (const PointPair &p : {_points, _wall})
   {
-    if (x < std::min(p.first.X(), p.second.X()))
+    if (x < std::min(p.first.X(), p.second.X()) - tolerance)
       return NoIntersection;
 
-    if (std::max(p.first.X(), p.second.X() ) < x)
+    if (std::max(p.first.X(), p.second.X()) + tolerance < x)
+      return NoIntersection;
+
+    if (y < std::min(p.first.Y(), p.second.Y()) - tolerance)
+      return NoIntersection;
+
+    if (std::max(p.first.Y(), p.second.Y()) + tolerance < y)
       return NoIntersection;
   }
 
@@ -114,106 +134,580 @@ IntersectionResult CheckCollisions(
 }
 
 /////////////////////////////////////////////////
-void Simulate(const EnvironmentPluginPtr &_environment,
-              const RobotPluginPtr &_robot,
-              const double _duration,
-              const bool _printState)
+/// \brief A uniform grid over the walls of a layout. Each cell lists the
+/// walls whose bounding box overlaps it, so a collision check only needs to
+/// test the walls in the cells that the bounding box of the segment covers,
+/// instead of every wall of the layout.
+///
+/// Queries do not modify the grid, so threads can share it, as long as each
+/// thread queries with a Scratch of its own.
+class WallGrid
 {
-  Environment *env = _environment->QueryInterface<Environment>();
-  assert(env && "Environment interface is missing!");
+  /// \brief Working memory of the queries of one thread
+  public: class Scratch
+  {
+    /// \brief The number of the last query which tested each wall
+    private: std::vector<std::size_t> lastQuery;
 
-  const Drive *drive = _robot->QueryInterface<Drive>();
-  assert(drive && "The robot cannot drive!");
+    /// \brief The number of the last query
+    private: std::size_t query = 0;
 
-  // Get the layout from the environment.
-  const Layout &layout = env->GenerateLayout();
+    friend class WallGrid;
+  };
 
-  // If the robot has a MapUplink interface, send it the layout of the
-  // environment.
-  if (MapDatabase *uplink = _robot->QueryInterface<MapDatabase>())
-    uplink->ReadMap(layout);
+  /// \brief Build the grid
+  /// \param[in] _layout The layout of the environment. It must outlive the
+  /// grid.
+  public: explicit WallGrid(const Layout &_layout)
+    : layout(_layout)
+  {
+    if (layout.empty())
+      return;
 
-  double time = 0.0;
-  ignition::math::Vector2d x;
-  double theta = 0.0;
+    ignition::math::Vector2d lower = layout.front().first;
+    ignition::math::Vector2d upper = lower;
+    double totalLength = 0.0;
+    for (const Wall &wall : layout)
+    {
+      for (const ignition::math::Vector2d &p : {wall.first, wall.second})
+      {
+        lower.Set(std::min(lower.X(), p.X()), std::min(lower.Y(), p.Y()));
+        upper.Set(std::max(upper.X(), p.X()), std::max(upper.Y(), p.Y()));
+      }
+      totalLength += (wall.second - wall.first).Length();
+    }
 
-  while (time < _duration)
-  {
-    // Update the proximity sensor.
-    if (ProximitySensor *proximity = _robot->QueryInterface<ProximitySensor>())
+    // Cells about as large as the average wall keep the number of walls per
+    // cell small. Cells are never so small that there are more than about 4
+    // of them per wall, which bounds the memory of the grid.
+    const ignition::math::Vector2d extent = upper - lower;
+    this->cellSize = std::max(
+          totalLength / static_cast<double>(layout.size()),
+          std::sqrt(extent.X() * extent.Y()
+                    / (4.0 * static_cast<double>(layout.size()))));
+    if (!(this->cellSize > 0.0))
+      this->cellSize = 1.0;
+
+    this->origin = lower;
+    this->columns = static_cast<std::size_t>(extent.X() / this->cellSize) + 1;
+    this->rows = static_cast<std::size_t>(extent.Y() / this->cellSize) + 1;
+
+    // Count the walls of each cell, and then fill in the walls, so that the
+    // lists of all the cells share one vector
+    this->cellStart.assign(this->columns * this->rows + 1, 0);
+    for (int pass = 0; pass < 2; ++pass)
     {
-      const double range = proximity->MaxRange();
-      const ignition::math::Vector2d x_far = x + ignition::math::Vector2d(
-            range*cos(theta), range*sin(theta));
-      IntersectionResult result = CheckCollisions(x, x_far, layout);
+      for (std::size_t w = 0; w < layout.size(); ++w)
+      {
+        this->ForEachCell(layout[w], 0.0, [&](const std::size_t _cell)
+        {
+          if (pass == 0)
+            ++this->cellStart[_cell + 1];
+          else
+            this->walls[this->cellStart[_cell]++] = w;
+        });
+      }
 
-      if (result.first)
+      if (pass == 0)
       {
-        proximity->ReadProximity( (x-result.second).Length() );
+        for (std::size_t c = 1; c < this->cellStart.size(); ++c)
+          this->cellStart[c] += this->cellStart[c - 1];
+        this->walls.resize(this->cellStart.back());
       }
       else
       {
-        proximity->ReadProximity(std::numeric_limits<double>::infinity());
+        // Filling in moved each start to the end of its cell, which is the
+        // start of the next one
+        for (std::size_t c = this->cellStart.size() - 1; c > 0; --c)
+          this->cellStart[c] = this->cellStart[c - 1];
+        this->cellStart[0] = 0;
       }
     }
+  }
+
+  /// \brief Check whether a segment intersects any wall of the layout
+  /// \return The same result as CheckCollisions() with the whole layout,
+  /// i.e. the intersection with the first wall of the layout that the
+  /// segment intersects
+  public: IntersectionResult CheckCollisions(
+    const ignition::math::Vector2d &_x1,
+    const ignition::math::Vector2d &_x0,
+    Scratch &_scratch) const
+  {
+    if (this->layout.empty())
+      return NoIntersection;
+
+    const PointPair points = std::make_pair(_x1, _x0);
+
+    // A wall can be in several cells, so the walls which were already tested
+    // by this query are marked with its number
+    _scratch.lastQuery.resize(this->layout.size(), 0);
+    const std::size_t query = ++_scratch.query;
+
+    std::size_t first = this->layout.size();
+    IntersectionResult result = NoIntersection;
+
+    // Grow the box by the tolerance of CheckIntersection(), so that the
+    // walls that it would still accept are not missed
+    this->ForEachCell(points, 1e-9, [&](const std::size_t _cell)
+    {
+      for (std::size_t i = this->cellStart[_cell];
+           i < this->cellStart[_cell + 1]; ++i)
+      {
+        const std::size_t w = this->walls[i];
+        if (w >= first || _scratch.lastQuery[w] == query)
+          continue;
+
+        _scratch.lastQuery[w] = query;
+        const IntersectionResult intersection =
+            CheckIntersection(points, this->layout[w]);
+        if (intersection.first)
+        {
+          first = w;
+          result = intersection;
+        }
+      }
+    });
+
+    return result;
+  }
 
-    // Update the GPS sensor
-    if (GPSSensor *gps = _robot->QueryInterface<GPSSensor>())
+  /// \brief Call a function with the index of every cell that the bounding
+  /// box of a segment overlaps. Parts of the box outside of the grid are
+  /// clamped to its border cells.
+  /// \param[in] _points The segment
+  /// \param[in] _margin How much to grow the box by on every side
+  /// \param[in] _func The function to call
+  private: template <typename Function>
+  void ForEachCell(const PointPair &_points, const double _margin,
+                   const Function &_func) const
+  {
+    const auto cellOf = [&](const double _value, const double _origin,
+                            const std::size_t _count)
+    {
+      const double cell = std::floor((_value - _origin) / this->cellSize);
+      return static_cast<std::size_t>(std::min(
+            std::max(cell, 0.0), static_cast<double>(_count - 1)));
+    };
+
+    const std::size_t minColumn = cellOf(
+          std::min(_points.first.X(), _points.second.X()) - _margin,
+          this->origin.X(), this->columns);
+    const std::size_t maxColumn = cellOf(
+          std::max(_points.first.X(), _points.second.X()) + _margin,
+          this->origin.X(), this->columns);
+    const std::size_t minRow = cellOf(
+          std::min(_points.first.Y(), _points.second.Y()) - _margin,
+          this->origin.Y(), this->rows);
+    const std::size_t maxRow = cellOf(
+          std::max(_points.first.Y(), _points.second.Y()) + _margin,
+          this->origin.Y(), this->rows);
+
+    for (std::size_t row = minRow; row <= maxRow; ++row)
     {
-      gps->ReadGPS(x);
+      for (std::size_t column = minColumn; column <= maxColumn; ++column)
+        _func(row * this->columns + column);
     }
+  }
+
+  /// \brief The layout of the environment
+  private: const Layout &layout;
+
+  /// \brief The lower corner of the grid
+  private: ignition::math::Vector2d origin;
+
+  /// \brief The length of the sides of the cells
+  private: double cellSize = 1.0;
+
+  /// \brief The number of cells along x
+  private: std::size_t columns = 1;
+
+  /// \brief The number of cells along y
+  private: std::size_t rows = 1;
+
+  /// \brief The walls of cell c are walls[cellStart[c]] up to
+  /// walls[cellStart[c+1]]
+  private: std::vector<std::size_t> cellStart;
+
+  /// \brief The indices of the walls of every cell, one cell after another
+  private: std::vector<std::size_t> walls;
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the layout of an environment. Environments with the
+/// SharedEnvironment interface hand out the copy that they keep, so every
+/// simulation of the environment shares it. The layout of the others gets
+/// generated into a copy of its own.
+std::shared_ptr<const Layout> GetLayout(
+    const EnvironmentPluginPtr &_environment)
+{
+  if (SharedEnvironment *shared =
+          _environment->QueryInterface<SharedEnvironment>())
+  {
+    return shared->SharedLayout();
+  }
+
+  Environment *env = _environment->QueryInterface<Environment>();
+  assert(env && "Environment interface is missing!");
+  return std::make_shared<const Layout>(env->GenerateLayout());
+}
+
+/////////////////////////////////////////////////
+/// \brief If the robot has a map database, send it the layout of the
+/// environment. Robots with the SharedMapDatabase interface share the layout
+/// instead of copying it.
+void SendMap(
+    const RobotPluginPtr &_robot,
+    const std::shared_ptr<const Layout> &_layout)
+{
+  if (SharedMapDatabase *shared = _robot->QueryInterface<SharedMapDatabase>())
+    shared->ReadSharedMap(_layout);
+  else if (MapDatabase *uplink = _robot->QueryInterface<MapDatabase>())
+    uplink->ReadMap(*_layout);
+}
+
+/////////////////////////////////////////////////
+/// \brief The state of a robot in the simulation
+struct RobotState
+{
+  /// \brief Location of the robot
+  ignition::math::Vector2d x;
+
+  /// \brief Yaw of the robot
+  double theta = 0.0;
+
+  /// \brief Simulation time of the robot
+  double time = 0.0;
+
+  /// \brief The velocity output of the last step
+  ignition::math::Vector3d velocity;
+
+  /// \brief Whether the robot has crashed into a wall
+  bool crashed = false;
+};
+
+/////////////////////////////////////////////////
+/// \brief The interfaces of a robot which get used on every step. They are
+/// looked up once, so the control loop only dereferences plain pointers. The
+/// robot plugin must outlive them.
+struct RobotInterfaces
+{
+  /// \brief Look up the interfaces of a robot
+  /// \param[in] _robot The robot
+  explicit RobotInterfaces(const RobotPluginPtr &_robot)
+    : proximity(_robot->QueryInterfaceRef<ProximitySensor>()),
+      gps(_robot->QueryInterfaceRef<GPSSensor>()),
+      compass(_robot->QueryInterfaceRef<Compass>()),
+      drive(_robot->QueryInterfaceRef<Drive>())
+  {
+  }
 
-    // Update the compass sensor
-    if (Compass *compass = _robot->QueryInterface<Compass>())
+  /// \brief The proximity sensor, if the robot has one
+  ignition::plugin::InterfaceRef<ProximitySensor> proximity;
+
+  /// \brief The GPS sensor, if the robot has one
+  ignition::plugin::InterfaceRef<GPSSensor> gps;
+
+  /// \brief The compass, if the robot has one
+  ignition::plugin::InterfaceRef<Compass> compass;
+
+  /// \brief The drive, which every robot has
+  ignition::plugin::InterfaceRef<Drive> drive;
+};
+
+/////////////////////////////////////////////////
+/// \brief Give the robot its sensor readings, and move it by one step of its
+/// control loop. If it crashes, it stays where it hit the wall, and its time
+/// does not advance.
+/// \param[in] _robot The interfaces of the robot
+/// \param[in] _checkCollisions Function which returns the intersection of a
+/// segment with the layout
+/// \return The collision, if the robot crashed during the step
+template <typename CheckFunction>
+IntersectionResult StepRobot(
+    const RobotInterfaces &_robot,
+    const CheckFunction &_checkCollisions,
+    RobotState &_state)
+{
+  ignition::math::Vector2d &x = _state.x;
+  double &theta = _state.theta;
+
+  // Update the proximity sensor.
+  if (ProximitySensor *proximity = _robot.proximity.Get())
+  {
+    const double range = proximity->MaxRange();
+    const ignition::math::Vector2d x_far = x + ignition::math::Vector2d(
+          range*cos(theta), range*sin(theta));
+    IntersectionResult result = _checkCollisions(x, x_far);
+
+    if (result.first)
     {
-      compass->ReadCompass(theta);
+      proximity->ReadProximity( (x-result.second).Length() );
     }
+    else
+    {
+      proximity->ReadProximity(std::numeric_limits<double>::infinity());
+    }
+  }
+
+  // Update the GPS sensor
+  if (GPSSensor *gps = _robot.gps.Get())
+  {
+    gps->ReadGPS(x);
+  }
+
+  // Update the compass sensor
+  if (Compass *compass = _robot.compass.Get())
+  {
+    compass->ReadCompass(theta);
+  }
 
-    // Save the last state
-    ignition::math::Vector2d x_last = x;
+  // Save the last state
+  ignition::math::Vector2d x_last = x;
 
-    // Get the driving information
-    const double dt = 1.0/drive->Frequency();
-    const ignition::math::Vector3d &vel = drive->Velocity();
+  // Get the driving information
+  const Drive *drive = _robot.drive.Get();
+  const double dt = 1.0/drive->Frequency();
+  const ignition::math::Vector3d &vel = drive->Velocity();
+  _state.velocity = vel;
 
-    // We integrate the position components with a half-step taken in the angle,
-    // which should smooth out the behavior of sharp turns.
-    const double halfAngle = theta + 0.5*vel[2]*dt;
-    const double dx = vel[0]*cos(halfAngle)*dt + vel[1]*sin(halfAngle)*dt;
-    const double dy = - vel[0]*sin(halfAngle)*dt + vel[1]*cos(halfAngle)*dt;
+  // We integrate the position components with a half-step taken in the angle,
+  // which should smooth out the behavior of sharp turns.
+  const double halfAngle = theta + 0.5*vel[2]*dt;
+  const double dx = vel[0]*cos(halfAngle)*dt + vel[1]*sin(halfAngle)*dt;
+  const double dy = - vel[0]*sin(halfAngle)*dt + vel[1]*cos(halfAngle)*dt;
 
-    x[0] += dx;
-    x[1] += dy;
-    theta += vel[2]*dt;
+  x[0] += dx;
+  x[1] += dy;
+  theta += vel[2]*dt;
 
-    const IntersectionResult collision = CheckCollisions(x, x_last, layout);
+  const IntersectionResult collision = _checkCollisions(x, x_last);
+  if (collision.first)
+  {
+    x[0] = collision.second.X();
+    x[1] = collision.second.Y();
+    _state.crashed = true;
+    return collision;
+  }
+
+  _state.time += dt;
+  return NoIntersection;
+}
+
+/////////////////////////////////////////////////
+void Simulate(const EnvironmentPluginPtr &_environment,
+              const RobotPluginPtr &_robot,
+              const double _duration,
+              const bool _printState,
+              const bool _linearScan)
+{
+  assert(_robot->QueryInterface<Drive>() && "The robot cannot drive!");
+
+  // Get the layout from the environment.
+  const std::shared_ptr<const Layout> sharedLayout = GetLayout(_environment);
+  const Layout &layout = *sharedLayout;
+
+  // If the robot has a map database, send it the layout of the environment.
+  SendMap(_robot, sharedLayout);
+
+  // Build the grid once, so that the collision checks of every step only
+  // test the walls near the robot
+  const WallGrid grid(layout);
+  WallGrid::Scratch scratch;
+
+  // Time spent on collision checks, which grows with the number of walls if
+  // every wall gets tested
+  std::chrono::steady_clock::duration collisionTime{0};
+  auto checkCollisions = [&](const ignition::math::Vector2d &_x1,
+                             const ignition::math::Vector2d &_x0)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    const IntersectionResult result = _linearScan ?
+          CheckCollisions(_x1, _x0, layout) :
+          grid.CheckCollisions(_x1, _x0, scratch);
+    collisionTime += std::chrono::steady_clock::now() - start;
+    return result;
+  };
+
+  const RobotInterfaces interfaces(_robot);
+  RobotState state;
+  const ignition::math::Vector2d &x = state.x;
+  const double &theta = state.theta;
+  const double &time = state.time;
+
+  while (time < _duration)
+  {
+    const IntersectionResult collision =
+        StepRobot(interfaces, checkCollisions, state);
     if (collision.first)
     {
       std::cout << "The robot has crashed at ("
                 << collision.second.X() << "m, "
                 << collision.second.Y() << "m)! Time: "
                 << time << "s  |==|  Velocity output: "
-                << vel << "\n" << std::endl;
-
-      x[0] = collision.second.X();
-      x[1] = collision.second.Y();
+                << state.velocity << "\n" << std::endl;
 
       break;
     }
 
-    time += dt;
-
     if (_printState)
     {
       std::cout << "Location: (" << x[0] << "m, " << x[1] << "m) | Yaw: "
                 << 180.0*theta/M_PI << "-degrees | Time: " << time
-                << "s  |==|  Velocity output: " << vel << std::endl;
+                << "s  |==|  Velocity output: " << state.velocity
+                << std::endl;
     }
   }
 
   std::cout << "The simulation has finished (time: " << time << "s).\n"
             << " -- Final robot location: (" << x[0] << "m, " << x[1] << "m)\n"
-            << " -- Yaw: " << 180.0*theta/M_PI << "-degrees\n" << std::endl;
+            << " -- Yaw: " << 180.0*theta/M_PI << "-degrees\n"
+            << " -- Collision checks against " << layout.size() << " walls "
+            << (_linearScan ? "(linear scan)" : "(grid)") << " took "
+            << std::chrono::duration<double, std::milli>(collisionTime).count()
+            << "ms\n" << std::endl;
+}
+
+/////////////////////////////////////////////////
+/// \brief Simulate many instances of a robot plugin at once. They share one
+/// copy of the layout, and its grid, which are only read. The robots are
+/// split evenly over a number of threads, and each thread steps its own
+/// robots, feeding their sensor interfaces itself. This is repeated with 1,
+/// 2, 4, ... and finally _maxThreads threads, to show how the steps per
+/// second scale.
+void SimulateMany(
+    const ignition::plugin::Loader &_loader,
+    const std::string &_robotPlugin,
+    const EnvironmentPluginPtr &_environment,
+    const std::size_t _numRobots,
+    const unsigned int _maxThreads,
+    const double _duration,
+    const bool _linearScan)
+{
+  // Every robot shares this copy of the layout
+  const std::shared_ptr<const Layout> sharedLayout = GetLayout(_environment);
+  const Layout &layout = *sharedLayout;
+  const WallGrid grid(layout);
+
+  std::vector<unsigned int> threadCounts;
+  for (unsigned int t = 1; t < _maxThreads; t *= 2)
+    threadCounts.push_back(t);
+  threadCounts.push_back(std::max(1u, _maxThreads));
+
+  std::cout << "Simulating " << _numRobots << " instances of ["
+            << _robotPlugin << "] for " << _duration << "s against "
+            << layout.size() << " walls "
+            << (_linearScan ? "(linear scan)" : "(grid)") << "\n\n"
+            << std::setw(8) << "threads"
+            << std::setw(18) << "instantiate(ms)"
+            << std::setw(12) << "steps"
+            << std::setw(10) << "time(s)"
+            << std::setw(14) << "steps/s"
+            << std::setw(10) << "speedup"
+            << std::setw(10) << "crashed" << std::endl;
+
+  double baseline = 0.0;
+  for (const unsigned int numThreads : threadCounts)
+  {
+    // Every run gets new robots, so that every run simulates the same thing
+    std::vector<RobotPluginPtr> robots;
+    robots.reserve(_numRobots);
+
+    const auto instantiateStart = std::chrono::steady_clock::now();
+    const std::size_t created =
+        _loader.Instantiate(_robotPlugin, _numRobots, robots);
+    const double instantiateMs = std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - instantiateStart).count();
+
+    if (created != _numRobots)
+    {
+      std::cerr << "Could only instantiate " << created << " of "
+                << _numRobots << " robots" << std::endl;
+      return;
+    }
+
+    std::vector<RobotState> states(_numRobots);
+    std::vector<RobotInterfaces> interfaces;
+    interfaces.reserve(_numRobots);
+    for (std::size_t i = 0; i < _numRobots; ++i)
+    {
+      interfaces.emplace_back(robots[i]);
+
+      // Spread out the headings, so that the robots do not all do the same
+      states[i].theta = 2.0 * M_PI * static_cast<double>(i)
+          / static_cast<double>(_numRobots);
+
+      SendMap(robots[i], sharedLayout);
+    }
+
+    std::atomic<std::uint64_t> totalSteps{0};
+    auto worker = [&](const std::size_t _begin, const std::size_t _end)
+    {
+      WallGrid::Scratch scratch;
+      auto checkCollisions = [&](const ignition::math::Vector2d &_x1,
+                                 const ignition::math::Vector2d &_x0)
+      {
+        return _linearScan ? CheckCollisions(_x1, _x0, layout) :
+                             grid.CheckCollisions(_x1, _x0, scratch);
+      };
+
+      // Every robot of the thread takes a step before any of them takes the
+      // next one, until they have all crashed or run out of time
+      std::uint64_t steps = 0;
+      bool running = true;
+      while (running)
+      {
+        running = false;
+        for (std::size_t i = _begin; i < _end; ++i)
+        {
+          RobotState &state = states[i];
+          if (state.crashed || state.time >= _duration)
+            continue;
+
+          StepRobot(interfaces[i], checkCollisions, state);
+          ++steps;
+          running = true;
+        }
+      }
+
+      totalSteps += steps;
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < numThreads; ++t)
+    {
+      threads.emplace_back(worker, t * _numRobots / numThreads,
+                           (t + 1) * _numRobots / numThreads);
+    }
+    worker(0, _numRobots / numThreads);
+    for (std::thread &thread : threads)
+      thread.join();
+    const double seconds = std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count();
+
+    std::size_t crashed = 0;
+    for (const RobotState &state : states)
+      crashed += state.crashed ? 1 : 0;
+
+    const double stepsPerSecond =
+        static_cast<double>(totalSteps.load()) / seconds;
+    if (numThreads == 1)
+      baseline = stepsPerSecond;
+
+    std::cout << std::fixed
+              << std::setw(8) << numThreads
+              << std::setw(18) << std::setprecision(2) << instantiateMs
+              << std::setw(12) << totalSteps.load()
+              << std::setw(10) << std::setprecision(3) << seconds
+              << std::setw(14) << std::setprecision(0) << stepsPerSecond
+              << std::setw(9) << std::setprecision(2)
+              << stepsPerSecond / baseline << "x"
+              << std::setw(10) << crashed << std::endl;
+    std::cout.unsetf(std::ios_base::floatfield);
+  }
+
+  std::cout << std::endl;
 }
 
 /////////////////////////////////////////////////
@@ -230,12 +724,16 @@ int main(int argc, char *argv[])
   paths.AddPluginPaths(PluginLibDir);
 
   std::vector<std::string> knownRobotPlugins = { "CrashBot", "CautiousBot" };
-  std::vector<std::string> knownEnvPlugins = { "BoxEnvironment" };
+  std::vector<std::string> knownEnvPlugins = {
+    "BoxEnvironment", "MazeEnvironment" };
 
   std::string robotLib = knownRobotPlugins.front();
   std::string envLib = knownEnvPlugins.front();
   double duration = 300;
   bool printState = false;
+  bool linearScan = false;
+  std::size_t numRobots = 1;
+  unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
 
 #ifdef HAVE_BOOST_PROGRAM_OPTIONS
 
@@ -281,6 +779,18 @@ int main(int argc, char *argv[])
                    +std::to_string(duration)+")").c_str())
 
       ("print,p", "Print out the state during each iteration")
+
+      ("linear-scan", "Test every wall in the collision checks, instead of "
+       "only the walls near the robot. This is for measuring the speedup of "
+       "the grid.")
+
+      ("robots,n", bpo::value<std::size_t>(&numRobots),
+       "Simulate this many instances of the robot at once, and report how "
+       "the steps per second scale with the number of threads (default: 1)")
+
+      ("jobs,j", bpo::value<unsigned int>(&jobs),
+       std::string("The largest number of threads to simulate many robots "
+                   "with (default: "+std::to_string(jobs)+")").c_str())
       ;
 
   bpo::variables_map vm;
@@ -298,6 +808,11 @@ int main(int argc, char *argv[])
     printState = true;
   }
 
+  if (vm.count("linear-scan") > 0)
+  {
+    linearScan = true;
+  }
+
   if (vm.count("include-dirs"))
   {
     const std::vector<std::string> inputDirs =
@@ -329,6 +844,7 @@ int main(int argc, char *argv[])
       loader.PluginsImplementing("ignition::plugin::examples::Drive");
 
   RobotPluginPtr robot;
+  std::string robotPlugin;
   // Get the first plugin from the robotLib library that provides a Drive
   // interface
   for (const std::string &plugin : robotPlugins)
@@ -336,6 +852,7 @@ int main(int argc, char *argv[])
     if (drivePlugins.find(plugin) != drivePlugins.end())
     {
       robot = loader.Instantiate(plugin);
+      robotPlugin = plugin;
       break;
     }
   }
@@ -354,9 +871,15 @@ int main(int argc, char *argv[])
   std::unordered_set<std::string> envInterfacePlugins =
       loader.PluginsImplementing("ignition::plugin::examples::Environment");
 
+  for (const std::string &plugin : loader.PluginsImplementing(
+         "ignition::plugin::examples::SharedEnvironment"))
+  {
+    envInterfacePlugins.insert(plugin);
+  }
+
   EnvironmentPluginPtr environment;
   // Get the first plugin from the envLib library that provides an Environment
-  // interface.
+  // or a SharedEnvironment interface.
   for (const std::string &plugin : envPlugins)
   {
     if (envInterfacePlugins.find(plugin) != envInterfacePlugins.end())
@@ -369,10 +892,18 @@ int main(int argc, char *argv[])
   if (environment.IsEmpty())
   {
     std::cerr << "The plugin library specified for the environment does not "
-              << "provide an Environment interface, which is required for the "
-              << "environment to be generated.\n" << std::endl;
+              << "provide an Environment or a SharedEnvironment interface, "
+              << "which is required for the environment to be generated.\n"
+              << std::endl;
     return 3;
   }
 
-  Simulate(environment, robot, duration, printState);
+  if (numRobots > 1)
+  {
+    SimulateMany(loader, robotPlugin, environment, numRobots, jobs, duration,
+                 linearScan);
+    return 0;
+  }
+
+  Simulate(environment, robot, duration, printState, linearScan);
 }
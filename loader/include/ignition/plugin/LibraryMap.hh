@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_LIBRARYMAP_HH_
+#define IGNITION_PLUGIN_LIBRARYMAP_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/utilities/SuppressWarning.hh>
+
+#include <ignition/plugin/loader/Export.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Where a plugin library is mapped into the memory of the
+    /// process. See LibraryMapObserver.
+    struct LibraryMapping
+    {
+      /// \brief One loadable segment of the library
+      struct Segment
+      {
+        /// \brief The first address of the segment
+        std::uintptr_t begin = 0;
+
+        /// \brief The address just past the end of the segment
+        std::uintptr_t end = 0;
+
+        /// \brief The offset of the segment in the file of the library
+        std::uint64_t fileOffset = 0;
+
+        /// \brief True if the segment holds code
+        bool executable = false;
+      };
+
+      /// \brief The path that the dynamic linker opened the library from
+      std::string path;
+
+      /// \brief The GNU build-id of the library, as a lowercase hex string,
+      /// or empty if the library was linked without one. Together with the
+      /// path, this identifies the exact file that the samples of a profiler
+      /// need to be symbolized against, even after the file has been
+      /// replaced, e.g. by a hot reload.
+      std::string buildId;
+
+      /// \brief The difference between the addresses of the library in
+      /// memory and the virtual addresses in its file
+      std::uintptr_t loadBias = 0;
+
+      /// \brief The loadable segments of the library
+      std::vector<Segment> segments;
+    };
+
+    /// \brief Receives the address ranges of the plugin libraries which the
+    /// Loaders of the process open and close, once it has been passed to
+    /// SetLibraryMapObserver(). This lets a profiler attribute samples to a
+    /// library after the library has been unloaded, e.g. by
+    /// Loader::ForgetLibrary(), by Loader::ReloadLib() or by
+    /// CleanupLostProducts().
+    class IGNITION_PLUGIN_LOADER_VISIBLE LibraryMapObserver
+    {
+      /// \brief Destructor
+      public: virtual ~LibraryMapObserver();
+
+      /// \brief Called when a library has been opened for the first time,
+      /// i.e. when no Loader of the process had it open before. This may be
+      /// called from any thread, but never from several threads at once. It
+      /// must not call into ign-plugin.
+      /// \param[in] _mapping Where the library is mapped
+      public: virtual void OnLibraryMapped(const LibraryMapping &_mapping) = 0;
+
+      /// \brief Called right before the last handle that ign-plugin holds
+      /// on a library gets closed, at which point the library is normally
+      /// unmapped. It stays mapped if something else has opened it too, or if
+      /// it was loaded with LoadOptions::noDelete. The same rules apply as
+      /// for OnLibraryMapped().
+      /// \param[in] _mapping Where the library was mapped, the same as when
+      /// it was reported to OnLibraryMapped()
+      public: virtual void OnLibraryUnmapped(
+          const LibraryMapping &_mapping) = 0;
+    };
+
+    /// \brief Start or stop reporting the address ranges of plugin libraries.
+    /// There is one observer for the whole process. A new observer is told
+    /// about every library which is open at the time when it is set, so that
+    /// it can be set at any point. Once this returns, the previous observer
+    /// is not called anymore.
+    ///
+    /// \param[in] _observer The observer, or nullptr to stop reporting
+    void IGNITION_PLUGIN_LOADER_VISIBLE SetLibraryMapObserver(
+        LibraryMapObserver *_observer);
+
+    /// \brief A LibraryMapObserver which appends the code segments of the
+    /// libraries to a perf map file, i.e. lines of the form
+    /// "<start> <size> <name>" with the start and size in hex. By default,
+    /// this is /tmp/perf-<pid>.map, which `perf report` reads to attribute
+    /// samples that it cannot find a mapped file for. The name of each
+    /// range is the path of its library, followed by its build-id.
+    ///
+    /// Lines are never removed, since samples which were taken while a
+    /// library was mapped still need them after it has been unloaded. If a
+    /// later library gets mapped over the same addresses, a profiler can no
+    /// longer tell the two apart by address alone; the build-ids in the
+    /// names tell which file each range belonged to.
+    class IGNITION_PLUGIN_LOADER_VISIBLE PerfMapWriter
+        : public LibraryMapObserver
+    {
+      /// \brief Constructor. The file is opened for appending.
+      /// \param[in] _path The path of the file, or empty for
+      /// /tmp/perf-<pid>.map
+      public: explicit PerfMapWriter(const std::string &_path = "");
+
+      /// \brief Destructor
+      public: ~PerfMapWriter() override;
+
+      /// \brief Get the path of the file
+      /// \return The path
+      public: const std::string &Path() const;
+
+      /// \brief Check whether the file could be opened
+      /// \return True if the file is open
+      public: bool IsOpen() const;
+
+      // Documentation inherited
+      public: void OnLibraryMapped(const LibraryMapping &_mapping) override;
+
+      // Documentation inherited
+      public: void OnLibraryUnmapped(const LibraryMapping &_mapping) override;
+
+      /// \brief Private data
+      private: class Implementation;
+      IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+      private: std::unique_ptr<Implementation> dataPtr;
+      IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+    };
+  }
+}
+
+#endif
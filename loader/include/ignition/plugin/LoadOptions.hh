@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_LOADOPTIONS_HH_
+#define IGNITION_PLUGIN_LOADOPTIONS_HH_
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Options which control how a Loader opens plugin libraries.
+    ///
+    /// The default values match the behavior of a Loader which has not been
+    /// given any options: lazy symbol binding and local symbol visibility,
+    /// i.e. `RTLD_LAZY | RTLD_LOCAL`.
+    struct LoadOptions
+    {
+      /// \brief When the undefined symbols of a library get resolved
+      enum class Binding
+      {
+        /// \brief Resolve function symbols the first time that they are
+        /// called (RTLD_LAZY)
+        LAZY,
+
+        /// \brief Resolve every symbol while the library is being opened
+        /// (RTLD_NOW). Use this if the first call into a plugin must not pay
+        /// for symbol resolution, e.g. when it happens on a real-time thread.
+        NOW
+      };
+
+      /// \brief Whether the symbols of a library are made available to
+      /// libraries that are opened afterwards
+      enum class Visibility
+      {
+        /// \brief Keep the symbols of the library to itself (RTLD_LOCAL).
+        /// This prevents the symbols of different plugin libraries from
+        /// clashing with each other.
+        LOCAL,
+
+        /// \brief Make the symbols of the library available for resolving
+        /// the symbols of libraries that are opened later (RTLD_GLOBAL)
+        GLOBAL
+      };
+
+      /// \brief The symbol binding mode
+      Binding binding = Binding::LAZY;
+
+      /// \brief The symbol visibility
+      Visibility visibility = Visibility::LOCAL;
+
+      /// \brief Never unload the library, even after every reference to it
+      /// has been released (RTLD_NODELETE). This is ignored on platforms that
+      /// do not support it.
+      bool noDelete = false;
+
+      /// \brief Prefer the symbols of the library itself over global symbols
+      /// with the same name (RTLD_DEEPBIND). This is only supported by glibc
+      /// and is ignored elsewhere.
+      bool deepBind = false;
+
+      /// \brief Do not close the library on whichever thread releases the
+      /// last reference to it. Instead, the library is posted to a queue and
+      /// closed by Loader::FlushUnloadQueue() or by the thread that
+      /// Loader::SetBackgroundUnloading() starts. Use this if the last
+      /// PluginPtr of a library may be deleted on a real-time thread, since
+      /// closing a library runs its destructors and takes the lock of the
+      /// dynamic linker.
+      ///
+      /// A library which is already open, e.g. through another Loader, keeps
+      /// the way of unloading that it was first opened with.
+      bool deferUnload = false;
+
+      /// \brief Move the code of the library onto transparent huge pages
+      /// right after it has been opened, so that calls into it need fewer
+      /// entries of the instruction TLB. This helps libraries with a lot of
+      /// hot code, such as physics or rendering engines. Only the part of the
+      /// code which spans whole huge pages (usually 2 MiB each) can be moved,
+      /// so small libraries stay as they are. The code keeps its addresses,
+      /// but it no longer shares its pages with other processes, and tools
+      /// that read the code from /proc/<pid>/maps see anonymous memory
+      /// instead of the file; see SetLibraryMapObserver() for profilers.
+      ///
+      /// This is best effort: if the system does not support transparent
+      /// huge pages, the failure is reported and the library is used as it
+      /// is. Like deferUnload, this only takes effect for a library which is
+      /// not open yet, since code which may be running cannot be moved.
+      bool hugePageText = false;
+
+      /// \brief Any additional platform-specific flags that should be passed
+      /// to dlopen
+      int additionalFlags = 0;
+    };
+  }
+}
+
+#endif
@@ -19,24 +19,229 @@
 #ifndef IGNITION_PLUGIN_LOADER_HH_
 #define IGNITION_PLUGIN_LOADER_HH_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <future>
 #include <memory>
+#include <memory_resource>
 #include <set>
 #include <string>
+#include <string_view>
 #include <typeinfo>
 #include <unordered_set>
+#include <vector>
 
 #include <ignition/utilities/SuppressWarning.hh>
 
 #include <ignition/plugin/loader/Export.hh>
+#include <ignition/plugin/LoadOptions.hh>
+#include <ignition/plugin/NameView.hh>
+#include <ignition/plugin/PluginHandle.hh>
 #include <ignition/plugin/PluginPtr.hh>
+#include <ignition/plugin/RemotePlugin.hh>
+#include <ignition/plugin/ThreadLocalPlugin.hh>
+#include <ignition/plugin/TypedPluginPtr.hh>
 
 namespace ignition
 {
   namespace plugin
   {
+    /// \brief A snapshot of what keeps a library open. See
+    /// Loader::Libraries().
+    struct LibraryStatistics
+    {
+      /// \brief The canonical path that the library was loaded from. This is
+      /// empty for the plugins which are linked into the program.
+      std::string path;
+
+      /// \brief The number of plugins that the Loader knows from the library.
+      /// This is zero once the library has been forgotten.
+      std::size_t plugins = 0;
+
+      /// \brief The number of references to the library which are held
+      /// outside of the Loader, i.e. by plugin instances and PluginHandles.
+      /// A factory whose products are still alive is counted as one instance,
+      /// since its products keep it alive.
+      std::size_t references = 0;
+
+      /// \brief True if the Loader has forgotten the library, but references
+      /// to it keep it open
+      bool forgotten = false;
+
+      /// \brief The number of allocations which have been attributed to the
+      /// library so far. Together with `allocatedBytes`, sampling this twice
+      /// gives the rate at which the library allocates. This stays zero
+      /// unless a Loader accounts for allocations, see
+      /// Loader::SetAllocationAccounting().
+      std::uint64_t allocations = 0;
+
+      /// \brief The number of bytes which have been attributed to the
+      /// library so far, including the ones that have been freed since
+      std::uint64_t allocatedBytes = 0;
+
+      /// \brief The number of bytes which are attributed to the library and
+      /// are still allocated
+      std::uint64_t liveBytes = 0;
+    };
+
+    /// \brief Limits on the libraries that a Loader keeps open. See
+    /// Loader::SetEvictionPolicy().
+    struct EvictionPolicy
+    {
+      /// \brief The largest number of libraries to keep open, or zero for no
+      /// limit
+      std::size_t maxLibraries = 0;
+
+      /// \brief The largest total size of the files of the open libraries, in
+      /// bytes, or zero for no limit
+      std::uint64_t maxBytes = 0;
+    };
+
     /// \brief Class for loading plugins
+    ///
+    /// A Loader may be shared between threads. Looking up and instantiating
+    /// plugins only takes a shared lock on the Loader's registry, so any number
+    /// of threads can do so at the same time, while LoadLib and ForgetLibrary
+    /// take an exclusive lock only for the brief moment when they update the
+    /// registry. The references returned by InterfacesImplemented() and
+    /// AllPlugins() are the exception: their contents are not synchronized,
+    /// so they must not be read while another thread might be loading or
+    /// forgetting libraries. Hot paths which only need to look at names can
+    /// use the functions that return a NameView instead of a set, e.g.
+    /// PluginsImplementingView(). These copy nothing, and keep the registry
+    /// locked in shared mode for as long as the NameView exists.
+    ///
+    /// Every Loader keeps its own registry of the libraries that it has loaded,
+    /// but a library that several Loaders load is only inspected once while
+    /// it stays open. Loaders which load it later share the plugin
+    /// descriptions that the first Loader found, so creating many Loaders for
+    /// the same libraries is cheap.
+    ///
+    /// Functions which look up plugins, aliases, or interfaces by name take
+    /// std::string_view, so they can be called with a std::string, a string
+    /// literal, or a slice of a larger buffer. None of these lookups allocate
+    /// memory for the name being looked up.
+    ///
+    /// Problems are reported as diagnostic messages, which are written to
+    /// std::cerr unless a different destination is given to SetLogger().
+    ///
+    /// Processes which fork workers should load their libraries before they
+    /// fork. The workers then inherit the registry and the opened libraries
+    /// at the same addresses, and share their memory with the parent until
+    /// they modify it, so they can instantiate plugins right away. Do not
+    /// fork while another thread is loading or forgetting libraries, since
+    /// the registry would stay locked in the child. Workers which are started
+    /// as new programs can pick up the registry with SaveManifest() and
+    /// LoadManifest() instead.
     class IGNITION_PLUGIN_LOADER_VISIBLE Loader
     {
+      /// \brief The outcome of looking up a plugin by its name or alias
+      public: enum class LookupStatus
+      {
+        /// \brief The name or alias refers to exactly one plugin
+        FOUND,
+
+        /// \brief No known plugin has this name or alias
+        NOT_FOUND,
+
+        /// \brief The alias refers to more than one plugin, so it cannot be
+        /// used to identify any of them
+        AMBIGUOUS_ALIAS,
+
+        /// \brief The plugin is known, but the library that provides it could
+        /// not be opened
+        LIBRARY_UNAVAILABLE,
+
+        /// \brief The plugin is known, but it requires CPU features which
+        /// this CPU does not support, see IGNITION_ADD_PLUGIN_FEATURES(). For
+        /// an alias, none of the plugins that it refers to can run here.
+        UNSUPPORTED_CPU
+      };
+
+      /// \brief How LookupPlugin() chooses between the plugins that an alias
+      /// refers to
+      public: enum class Preference
+      {
+        /// \brief The alias must refer to exactly one plugin
+        UNIQUE,
+
+        /// \brief Choose the plugin whose required CPU features are the
+        /// fastest among the plugins that this CPU can run. See
+        /// IGNITION_ADD_PLUGIN_FEATURES().
+        FASTEST
+      };
+
+      /// \brief A function which receives the diagnostic messages of a
+      /// Loader. Each message is a complete line of text, including its
+      /// trailing newline.
+      public: using Logger = std::function<void(const std::string &_message)>;
+
+      /// \brief A batch of changes to the libraries of a Loader, which get
+      /// applied together by Commit(). Get one with Loader::BeginTransaction().
+      ///
+      /// Nothing happens to the Loader until the transaction is committed.
+      /// The libraries which the transaction loads are then opened and
+      /// inspected concurrently, the same way as LoadLibs() does, and all of
+      /// the changes are made to the registry of the Loader in one step.
+      /// Other threads therefore see either none or all of the changes, and
+      /// the alias collisions which the changes cause are only reported once.
+      ///
+      /// A transaction which is destroyed without being committed is
+      /// discarded. The Loader must outlive its transactions.
+      public: class IGNITION_PLUGIN_LOADER_VISIBLE Transaction
+      {
+        /// \brief Move constructor
+        public: Transaction(Transaction &&) = default;
+
+        /// \brief Move assignment
+        public: Transaction &operator=(Transaction &&) = default;
+
+        /// \brief Load a library when the transaction is committed, with the
+        /// default load options of the Loader. See Loader::LoadLib().
+        /// \param[in] _pathToLibrary The path to the library
+        /// \return This transaction
+        public: Transaction &LoadLib(const std::string &_pathToLibrary);
+
+        /// \brief Forget a library when the transaction is committed. See
+        /// Loader::ForgetLibrary().
+        /// \param[in] _pathToLibrary The path to the library
+        /// \return This transaction
+        public: Transaction &ForgetLibrary(const std::string &_pathToLibrary);
+
+        /// \brief Apply the changes of the transaction, in the order in which
+        /// they were added. The transaction is empty afterwards, so it can be
+        /// reused for another batch of changes.
+        /// \return The set of plugins that the loads of the transaction have
+        /// registered
+        public: std::unordered_set<std::string> Commit();
+
+        /// \brief Constructor, used by Loader::BeginTransaction()
+        /// \param[in] _loader The Loader that the transaction changes
+        private: explicit Transaction(Loader &_loader);
+
+        /// \brief A change which the transaction makes
+        private: struct Change
+        {
+          /// \brief The path to the library
+          std::string path;
+
+          /// \brief True to forget the library, false to load it
+          bool forget;
+        };
+
+        /// \brief The Loader that the transaction changes
+        private: Loader *loader;
+
+        IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        /// \brief The changes, in the order in which they were added
+        private: std::vector<Change> changes;
+        IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+        friend class Loader;
+      };
+
       /// \brief Constructor
       public: Loader();
 
@@ -48,16 +253,51 @@ namespace ignition
       /// \returns A pretty string
       public: std::string PrettyStr() const;
 
+      /// \brief Write the same text as PrettyStr() to a stream, without
+      /// building the whole of it in memory first.
+      ///
+      /// \param[out] _out The stream to write to
+      public: void PrettyPrint(std::ostream &_out) const;
+
+      /// \brief Write the registry of this Loader to a stream as a JSON
+      /// object, straight from the registry and without building any
+      /// intermediate containers. The object has the following members:
+      ///   - "interfaces": the demangled names of the known interfaces
+      ///   - "plugins": an array with an object for each known plugin, with
+      ///     its "name", its "aliases", the demangled names of its
+      ///     "interfaces", its "requiredFeatures", and the "library" that
+      ///     provides it, or null if the
+      ///     plugin is linked into the program or its library has not been
+      ///     opened yet
+      ///   - "aliasCollisions": an object which maps each alias that refers to
+      ///     more than one plugin to the names of those plugins
+      ///
+      /// The registry stays locked against loading and forgetting libraries
+      /// while this writes, so a slow stream delays those, but not lookups or
+      /// instantiation.
+      ///
+      /// \param[out] _out The stream to write to
+      public: void WriteJson(std::ostream &_out) const;
+
       /// \brief Get demangled names of interfaces that the loader has plugins
       /// for.
       ///
+      /// The set is maintained by the Loader as libraries are loaded and
+      /// forgotten, so calling this function does not allocate anything. The
+      /// returned reference remains valid for the lifetime of this Loader,
+      /// but its contents will change whenever LoadLib or ForgetLibrary is
+      /// called. Make a copy of it if you need a stable snapshot.
+      ///
       /// \returns Demangled names of the interfaces that are implemented
-      public: std::unordered_set<std::string> InterfacesImplemented() const;
+      public: const std::unordered_set<std::string> &InterfacesImplemented()
+          const;
 
-      /// \brief Get plugin names that implement the specified interface
+      /// \brief Get plugin names that implement the specified interfaces.
+      /// When more than one interface is given, only the plugins which
+      /// implement all of them are returned, see PluginsImplementingAll().
       ///
-      /// \return names of plugins that implement the interface.
-      public: template <typename Interface>
+      /// \return names of plugins that implement the interfaces.
+      public: template <typename Interface, typename... Interfaces>
       std::unordered_set<std::string> PluginsImplementing() const;
 
       /// \brief Get plugin names that implement the specified interface string.
@@ -80,13 +320,156 @@ namespace ignition
       ///
       /// \returns Names of plugins that implement the interface
       public: std::unordered_set<std::string> PluginsImplementing(
-          const std::string &_interface,
+          std::string_view _interface,
           const bool demangled = true) const;
 
+      /// \brief Get a view of the names of the plugins that implement an
+      /// interface. This is the same as PluginsImplementing(), except that
+      /// nothing is copied: the view refers to the index which the Loader
+      /// keeps, and holds it still until the view is gone. See NameView.
+      ///
+      /// \param[in] _interface
+      ///   Name of an interface
+      ///
+      /// \param[in] _demangled
+      ///   Specify whether the _interface string is demangled (default, true)
+      ///   or mangled (false).
+      ///
+      /// \returns Names of plugins that implement the interface
+      public: NameView PluginsImplementingView(
+          std::string_view _interface,
+          const bool _demangled = true) const;
+
+      /// \brief Get a view of the names of the plugins that implement the
+      /// specified interface. See PluginsImplementingView(std::string_view,
+      /// bool).
+      ///
+      /// \returns Names of plugins that implement the interface
+      public: template <typename Interface>
+      NameView PluginsImplementingView() const;
+
+      /// \brief Get the names of the plugins that implement every one of
+      /// several interfaces. The Loader gives each interface a dense ID and
+      /// keeps a bitset of the interfaces of each plugin, so this tests whole
+      /// words of bits per plugin instead of intersecting the sets of
+      /// PluginsImplementing().
+      ///
+      /// \param[in] _interfaces
+      ///   Names of the interfaces
+      ///
+      /// \param[in] _demangled
+      ///   Specify whether the _interfaces strings are demangled (default,
+      ///   true) or mangled (false).
+      ///
+      /// \returns Names of plugins that implement all of the interfaces, or
+      /// every known plugin if _interfaces is empty
+      public: std::unordered_set<std::string> PluginsImplementingAll(
+          const std::vector<std::string_view> &_interfaces,
+          const bool _demangled = true) const;
+
+      /// \brief Get the names of the plugins that implement any of several
+      /// interfaces, in a single pass over the interface bitsets of the
+      /// plugins.
+      ///
+      /// \param[in] _interfaces
+      ///   Names of the interfaces
+      ///
+      /// \param[in] _demangled
+      ///   Specify whether the _interfaces strings are demangled (default,
+      ///   true) or mangled (false).
+      ///
+      /// \returns Names of plugins that implement at least one of the
+      /// interfaces
+      public: std::unordered_set<std::string> PluginsImplementingAny(
+          const std::vector<std::string_view> &_interfaces,
+          const bool _demangled = true) const;
+
+      /// \brief Get the names of the plugins that implement all of the
+      /// specified interfaces. This is the same as PluginsImplementing() with
+      /// several interfaces.
+      ///
+      /// \return names of plugins that implement every interface.
+      public: template <typename Interface, typename... Interfaces>
+      std::unordered_set<std::string> PluginsImplementingAll() const;
+
+      /// \brief Get the names of the plugins that implement any of the
+      /// specified interfaces.
+      ///
+      /// \return names of plugins that implement at least one interface.
+      public: template <typename Interface, typename... Interfaces>
+      std::unordered_set<std::string> PluginsImplementingAny() const;
+
+      /// \brief Check whether a plugin implements an interface without
+      /// instantiating it. This tests a single bit of the plugin's interface
+      /// bitset.
+      ///
+      /// \param[in] _plugin
+      ///   The name of the plugin. Aliases are not resolved.
+      ///
+      /// \param[in] _interface
+      ///   Name of an interface
+      ///
+      /// \param[in] _demangled
+      ///   Specify whether the _interface string is demangled (default, true)
+      ///   or mangled (false).
+      ///
+      /// \returns True if the plugin is known and implements the interface
+      public: bool PluginImplements(
+          std::string_view _plugin,
+          std::string_view _interface,
+          const bool _demangled = true) const;
+
       /// \brief Get a set of the names of all plugins that are currently known
       /// to this Loader.
+      ///
+      /// Like InterfacesImplemented(), the returned reference remains valid
+      /// for the lifetime of this Loader, and its contents are updated as
+      /// libraries are loaded and forgotten.
+      ///
       /// \return A set of all plugin names known to this Loader.
-      public: std::set<std::string> AllPlugins() const;
+      public: const std::set<std::string> &AllPlugins() const;
+
+      /// \brief Get statistics about each library that this Loader keeps
+      /// open. This includes the libraries that have been forgotten, for as
+      /// long as plugin instances or PluginHandles keep them open, so it shows
+      /// what is pinning the code of a library in memory. Once a forgotten
+      /// library is no longer listed, this Loader has released it, although
+      /// the operating system may still keep it mapped, e.g. because of
+      /// LoadOptions::noDelete or because something else has opened it.
+      ///
+      /// \return The statistics of each library
+      public: std::vector<LibraryStatistics> Libraries() const;
+
+      /// \brief Choose whether to attribute the memory that plugins allocate
+      /// to the libraries which provide them, so that Libraries() can tell
+      /// which library is responsible for heap growth. While this is on,
+      ///   - plugin instances which this Loader creates without a memory
+      ///     resource get their storage from an account of their library,
+      ///   - factories which this Loader instantiates construct their products
+      ///     in the account of their library, when Factory::Construct() is
+      ///     not given a memory resource, and so does the product pool of a
+      ///     factory which is turned on afterwards.
+      ///
+      /// Allocations which plugins make by themselves, e.g. with new or
+      /// through containers, are not seen, and neither are instances and
+      /// products whose memory resource is chosen by the caller, nor the
+      /// blocks of Factory::ConstructMany(). Memory that was allocated before
+      /// this is turned on is not counted either, and memory that was
+      /// allocated while it was on keeps counting until it is freed.
+      ///
+      /// An account belongs to the path of its library and is shared by every
+      /// Loader in the process, so a library which is reloaded keeps adding to
+      /// the same account. Accounting is off by default.
+      ///
+      /// \param[in] _enabled
+      ///   True to account for allocations, false to stop
+      public: void SetAllocationAccounting(bool _enabled);
+
+      /// \brief Check whether this Loader attributes the memory of plugins to
+      /// their libraries. See SetAllocationAccounting().
+      ///
+      /// \return True if allocations are accounted for
+      public: bool AllocationAccounting() const;
 
       /// \brief Get plugin names that correspond to the specified alias string.
       ///
@@ -98,11 +481,30 @@ namespace ignition
       /// plugin, no matter how many other plugins use the alias.
       ///
       /// \param[in] _alias
-      ///   The std::string of the alias
+      ///   The name of the alias
       ///
       /// \return A set of plugins that correspond to the desired alias
       public: std::set<std::string> PluginsWithAlias(
-          const std::string &_alias) const;
+          std::string_view _alias) const;
+
+      /// \brief Get a view of the names of the plugins that correspond to an
+      /// alias. This is the same as PluginsWithAlias(), except that nothing
+      /// is copied. See NameView.
+      ///
+      /// \param[in] _alias
+      ///   The name of the alias
+      ///
+      /// \return The plugins that correspond to the alias
+      public: NameView PluginsWithAliasView(std::string_view _alias) const;
+
+      /// \brief Get the aliases which refer to more than one plugin, and so
+      /// cannot be used to instantiate any of them. The collisions are found
+      /// once, when the plugins are loaded, and each one is reported then, so
+      /// this only copies the list. Use PluginsWithAlias() to find out which
+      /// plugins an alias refers to.
+      ///
+      /// \return The aliases which refer to more than one plugin
+      public: std::set<std::string> AmbiguousAliases() const;
 
       /// \brief Get the aliases of the plugin with the given name
       ///
@@ -111,7 +513,17 @@ namespace ignition
       ///
       /// \return A set of aliases corresponding to the desired plugin
       public: std::set<std::string> AliasesOfPlugin(
-          const std::string &_pluginName) const;
+          std::string_view _pluginName) const;
+
+      /// \brief Get a view of the aliases of the plugin with the given name.
+      /// This is the same as AliasesOfPlugin(), except that nothing is
+      /// copied. See NameView.
+      ///
+      /// \param[in] _pluginName
+      ///   The name of the desired plugin
+      ///
+      /// \return The aliases of the plugin
+      public: NameView AliasesOfPluginView(std::string_view _pluginName) const;
 
       /// \brief Resolve the plugin name or alias into the name of the plugin
       /// that it maps to. If this is a name or alias that does not uniquely map
@@ -122,17 +534,580 @@ namespace ignition
       ///
       /// \return The name of the plugin being referred to, or an empty string
       /// if no such plugin is known.
-      public: std::string LookupPlugin(const std::string &_nameOrAlias) const;
+      public: std::string LookupPlugin(std::string_view _nameOrAlias) const;
+
+      /// \brief Resolve the plugin name or alias into the name of the plugin
+      /// that it maps to, choosing between the plugins of an alias according
+      /// to a preference. With Preference::UNIQUE, this is the same as
+      /// LookupPlugin(_nameOrAlias).
+      ///
+      /// With Preference::FASTEST, plugins whose required CPU features are
+      /// not all supported by this CPU are skipped, and of the rest, the one
+      /// whose fastest feature ranks highest (see CpuFeatureRank()) is chosen.
+      /// A plugin which requires no features ranks lowest, so it serves as
+      /// the fallback. Ties go to the plugin that requires more features, and
+      /// then to the plugin whose name comes first. A name always refers to
+      /// its own plugin, which must be supported by this CPU. No library gets
+      /// opened to make the choice.
+      ///
+      /// \param[in] _nameOrAlias
+      ///   The name or alias of the plugin of interest.
+      ///
+      /// \param[in] _preference
+      ///   How to choose between the plugins of an alias
+      ///
+      /// \return The name of the chosen plugin, or an empty string if no
+      /// suitable plugin is known.
+      public: std::string LookupPlugin(std::string_view _nameOrAlias,
+                                       Preference _preference) const;
+
+      /// \brief Get the CPU features that a plugin requires, as registered
+      /// with IGNITION_ADD_PLUGIN_FEATURES()
+      ///
+      /// \param[in] _pluginName
+      ///   The name of the desired plugin
+      ///
+      /// \return The names of the features, which is empty if the plugin
+      /// runs on any CPU or is not known
+      public: std::set<std::string> RequiredFeatures(
+          std::string_view _pluginName) const;
+
+      /// \brief Get the plugins that a plugin needs to be constructed after,
+      /// as registered with IGNITION_ADD_PLUGIN_DEPENDENCIES(). See
+      /// InstantiateAll().
+      ///
+      /// \param[in] _pluginName
+      ///   The name of the desired plugin
+      ///
+      /// \return The names or aliases of the dependencies, as they were
+      /// registered. This is empty if the plugin has no dependencies or is
+      /// not known. If the library of the plugin was deferred by the manifest
+      /// cache, its dependencies are only known once it has been opened.
+      public: std::set<std::string> Dependencies(
+          std::string_view _pluginName) const;
+
+      /// \brief Same as LookupPlugin(), except that no diagnostic message is
+      /// produced when the name or alias cannot be resolved. Use this to check
+      /// for plugins which are optional.
+      ///
+      /// \param[in] _nameOrAlias
+      ///   The name or alias of the plugin of interest.
+      ///
+      /// \param[out] _pluginName
+      ///   If this is not a nullptr and the plugin is found, this receives the
+      ///   name of the plugin. It is left untouched otherwise.
+      ///
+      /// \return FOUND, NOT_FOUND, or AMBIGUOUS_ALIAS.
+      public: LookupStatus TryLookupPlugin(
+          std::string_view _nameOrAlias,
+          std::string *_pluginName = nullptr) const;
+
+      /// \brief Send the diagnostic messages of this Loader to a function
+      /// instead of std::cerr.
+      ///
+      /// The logger may be called from any thread that is using this Loader,
+      /// but never by two threads at once. It must not call any function of
+      /// this Loader.
+      ///
+      /// \param[in] _logger
+      ///   The function which will receive the messages. Pass in a nullptr to
+      ///   go back to writing them to std::cerr.
+      ///
+      /// \param[in] _maxMessagesPerSecond
+      ///   If this is greater than zero, at most this many messages will be
+      ///   produced each second. The rest are dropped, and their number is
+      ///   reported with the first message of the next second. Messages which
+      ///   get dropped are never formatted, so a flood of failed lookups stays
+      ///   cheap.
+      public: void SetLogger(
+          Logger _logger,
+          std::size_t _maxMessagesPerSecond = 0);
 
       /// \brief Load a library at the given path
       ///
+      /// If a manifest cache is being used (see SetManifestCache()) and it has
+      /// an up-to-date entry for this library, the library will not actually
+      /// be opened until one of its plugins is instantiated.
+      ///
+      /// \param[in] _pathToLibrary
+      ///   The path to a library
+      ///
+      /// \returns The set of plugins that have been loaded from the library
+      public: std::unordered_set<std::string> LoadLib(
+                  const std::string &_pathToLibrary);
+
+      /// \brief Load a library at the given path, using specific options
+      /// instead of the default options of this Loader.
+      ///
+      /// Note that the options only take effect if the library is not already
+      /// open in this process. If a library gets deferred by the manifest
+      /// cache, the options will be used when it is eventually opened.
+      ///
       /// \param[in] _pathToLibrary
       ///   The path to a library
       ///
+      /// \param[in] _options
+      ///   Options for opening the library
+      ///
       /// \returns The set of plugins that have been loaded from the library
       public: std::unordered_set<std::string> LoadLib(
+                  const std::string &_pathToLibrary,
+                  const LoadOptions &_options);
+
+      /// \brief Register the plugins of a library from the metadata that the
+      /// registration macros embed in it, without opening the library. The
+      /// library file is only parsed, so none of its code runs and none of
+      /// its dependencies get loaded while it is being scanned. The library
+      /// is opened once one of its plugins gets instantiated.
+      ///
+      /// The embedded metadata describes a library completely on ELF
+      /// platforms, as long as its plugins and interfaces are plain classes
+      /// (not templates, and not inside of an anonymous namespace) which are
+      /// registered with IGNITION_ADD_PLUGIN() or
+      /// IGNITION_ADD_STATIC_PLUGIN(), optionally with aliases from
+      /// IGNITION_ADD_STATIC_PLUGIN_ALIAS(). Aliases, factories and features
+      /// which are added by IGNITION_ADD_PLUGIN_ALIAS(), IGNITION_ADD_FACTORY()
+      /// or IGNITION_ADD_PLUGIN_FEATURES() are only known once the library
+      /// runs. Any library that is not described
+      /// completely gets loaded by LoadLib() instead.
+      ///
+      /// \param[in] _pathToLibrary
+      ///   The path to a library
+      ///
+      /// \returns The set of plugins that have been loaded from the library
+      public: std::unordered_set<std::string> ScanLib(
+                  const std::string &_pathToLibrary);
+
+      /// \brief Set the options which this Loader uses to open libraries
+      /// whenever no options are specified. This affects LoadLib(),
+      /// LoadLibs(), LoadDirectory(), LoadLibAsync(), and LoadManifest().
+      ///
+      /// \param[in] _options
+      ///   The new default options
+      public: void SetDefaultLoadOptions(const LoadOptions &_options);
+
+      /// \brief Keep the libraries that this Loader has open within a budget.
+      /// Whenever a library is opened while the budget is exceeded, the
+      /// libraries which no plugin instance or PluginHandle is using get
+      /// evicted, least recently instantiated first, until the budget is met
+      /// again. An evicted library is forgotten, but its plugins stay known,
+      /// and it is opened again the next time that one of them gets
+      /// instantiated.
+      ///
+      /// Libraries which are in use are never evicted, so the budget may be
+      /// exceeded for as long as they are. Use EvictIdleLibraries() to apply
+      /// the budget again once they are no longer in use. Plugins which are
+      /// linked into the program are not counted.
+      ///
+      /// \param[in] _policy
+      ///   The budget. The default EvictionPolicy turns eviction off.
+      public: void SetEvictionPolicy(const EvictionPolicy &_policy);
+
+      /// \brief Evict idle libraries until the budget of the eviction policy
+      /// is met. This does nothing unless SetEvictionPolicy() has been given
+      /// a budget.
+      ///
+      /// \returns The number of libraries that were evicted
+      public: std::size_t EvictIdleLibraries();
+
+      /// \brief Get the options which this Loader uses to open libraries
+      /// whenever no options are specified.
+      ///
+      /// \return The default options
+      public: LoadOptions DefaultLoadOptions() const;
+
+      /// \brief Register the plugins of every library that is described by a
+      /// manifest file, without opening the libraries.
+      ///
+      /// A manifest can be produced ahead of time (for example, when the
+      /// plugin libraries are built or installed) with WriteManifest(). The
+      /// plugins that it describes can be queried right away, and each library
+      /// will be opened the first time that one of its plugins is
+      /// instantiated. Libraries whose files have changed since the manifest
+      /// was written are loaded immediately with LoadLibs() instead. A manifest
+      /// cache file (see SetManifestCache()) can also be passed in here.
+      ///
+      /// A manifest records the build-id of each library that has one, so a
+      /// library whose file has the same build-id is described correctly even
+      /// if its modification time differs, e.g. because the same build was
+      /// installed on many machines.
+      ///
+      /// \param[in] _manifestFile
+      ///   Path to the manifest file
+      ///
+      /// \returns The set of plugins that are provided by the libraries of
+      /// the manifest
+      public: std::unordered_set<std::string> LoadManifest(
+                  const std::string &_manifestFile);
+
+      /// \brief Register the plugins of the given libraries from a manifest,
+      /// without opening the libraries.
+      ///
+      /// Each library is looked up in the manifest by its path, or else by
+      /// its build-id, so one merged manifest (see MergeManifests()) can be
+      /// written once for a set of libraries and then be shared by every
+      /// machine which has the same builds of them, wherever they are
+      /// installed. Reading the build-id of a library only takes its headers,
+      /// so no machine needs to open its libraries to find out what they
+      /// provide. Libraries which the manifest does not describe are loaded
+      /// immediately with LoadLibs().
+      ///
+      /// \param[in] _manifestFile
+      ///   Path to the manifest file, e.g. on a shared file system
+      ///
+      /// \param[in] _pathsToLibraries
+      ///   The libraries on this machine. If this is empty, every library of
+      ///   the manifest is taken from the path that the manifest records,
+      ///   just like LoadManifest(const std::string&).
+      ///
+      /// \returns The set of plugins that are provided by the libraries
+      public: std::unordered_set<std::string> LoadManifest(
+                  const std::string &_manifestFile,
+                  const std::vector<std::string> &_pathsToLibraries);
+
+      /// \brief Same as LoadManifest(), for the contents of a manifest file
+      /// which are already in memory, e.g. because they were fetched from a
+      /// service. Relative library paths in the manifest are relative to the
+      /// current working directory.
+      ///
+      /// \param[in] _contents
+      ///   The contents of a manifest file
+      ///
+      /// \param[in] _pathsToLibraries
+      ///   The libraries on this machine, or an empty list to take every
+      ///   library of the manifest from the path that it records
+      ///
+      /// \returns The set of plugins that are provided by the libraries
+      public: std::unordered_set<std::string> LoadManifestData(
+                  const std::string &_contents,
+                  const std::vector<std::string> &_pathsToLibraries = {});
+
+      /// \brief Write a manifest file which describes the plugins of the
+      /// given libraries, so that it can later be passed to LoadManifest().
+      /// Each library gets opened in order to inspect it, and is closed again
+      /// before this function returns.
+      ///
+      /// \param[in] _manifestFile
+      ///   Path to the manifest file that should be written
+      ///
+      /// \param[in] _pathsToLibraries
+      ///   The libraries to describe
+      ///
+      /// \returns True if every library could be described and the file was
+      /// written. If some of the libraries could not be loaded, the rest of
+      /// them are still written to the file, but false is returned.
+      public: static bool WriteManifest(
+                  const std::string &_manifestFile,
+                  const std::vector<std::string> &_pathsToLibraries);
+
+      /// \brief Write a manifest file which combines the contents of several
+      /// manifest files, e.g. to turn the sidecar manifests of a set of
+      /// installed libraries into a single index for LoadManifest().
+      ///
+      /// \param[in] _manifestFile
+      ///   Path to the manifest file that should be written
+      ///
+      /// \param[in] _manifestFiles
+      ///   The manifest files to combine. If several of them describe the
+      ///   same library, the last one wins.
+      ///
+      /// \returns True if every manifest could be read and the file was
+      /// written. Manifests which cannot be read are skipped, but then false
+      /// is returned.
+      public: static bool MergeManifests(
+                  const std::string &_manifestFile,
+                  const std::vector<std::string> &_manifestFiles);
+
+      /// \brief Write a manifest file which describes every library that this
+      /// Loader knows about, whether it has been opened or not, so that
+      /// another Loader, e.g. in a freshly started worker process, can pick up
+      /// the same plugins with LoadManifest() without opening any of the
+      /// libraries until their plugins get instantiated. Unlike
+      /// WriteManifest(), this does not open any library.
+      ///
+      /// The manifest does not record the LoadOptions of the libraries, so the
+      /// Loader which reads it will open them with its own default options.
+      /// Plugins which are linked into the program are not included.
+      ///
+      /// \param[in] _manifestFile
+      ///   Path to the manifest file that should be written
+      ///
+      /// \returns True if the file was written
+      public: bool SaveManifest(const std::string &_manifestFile) const;
+
+      /// \brief Use a manifest cache file to remember which plugins each
+      /// library provides.
+      ///
+      /// Once a library has been recorded in the cache, calling LoadLib on it
+      /// again (from this or any other Loader that uses the same cache file)
+      /// will register its plugins without opening the library. All the
+      /// functions which query plugin names, aliases, and interfaces will work
+      /// as usual, and the library will only be opened the first time that
+      /// one of its plugins gets instantiated. A cache entry is ignored if the
+      /// library file has been modified since the entry was recorded.
+      ///
+      /// The cache is read when this function is called. New entries are only
+      /// written to the file when SaveManifestCache() is called.
+      ///
+      /// \param[in] _cacheFile
+      ///   Path to the cache file. It does not need to exist yet. Pass in an
+      ///   empty string to stop using a cache.
+      public: void SetManifestCache(const std::string &_cacheFile);
+
+      /// \brief Write any new entries of the manifest cache to its file.
+      ///
+      /// \return True if the cache file is up to date, false if no cache is
+      /// being used or the file could not be written.
+      public: bool SaveManifestCache() const;
+
+      /// \brief Load a library at the given path on a separate thread.
+      ///
+      /// Opening the library, invoking its plugin hook, and demangling the
+      /// plugin names all happen on the other thread. Once that is done, the
+      /// new plugins are committed to this Loader in one step, and the future
+      /// becomes ready. Until then, this Loader can keep being used normally.
+      ///
+      /// If this Loader is destroyed while the library is still being loaded,
+      /// the destructor will wait for the load to finish.
+      ///
+      /// \param[in] _pathToLibrary
+      ///   The path to a library
+      ///
+      /// \returns A future for the set of plugins that have been loaded from
+      /// the library
+      public: std::future<std::unordered_set<std::string>> LoadLibAsync(
                   const std::string &_pathToLibrary);
 
+      /// \brief Load several libraries at once.
+      ///
+      /// The libraries are opened, and their plugin information is extracted,
+      /// concurrently on a set of worker threads. The results are then
+      /// committed to this Loader in one step, so other threads will either
+      /// see none or all of the new plugins. The outcome is the same as
+      /// calling LoadLib on each path in order.
+      ///
+      /// \param[in] _pathsToLibraries
+      ///   The paths to the libraries
+      ///
+      /// \returns The set of plugins that have been loaded from all of the
+      /// libraries
+      public: std::unordered_set<std::string> LoadLibs(
+                  const std::vector<std::string> &_pathsToLibraries);
+
+      /// \brief Begin a batch of loads and forgets which get applied to this
+      /// Loader all at once. See Transaction.
+      ///
+      /// \returns An empty transaction
+      public: Transaction BeginTransaction();
+
+      /// \brief Load every shared library that is found directly inside of the
+      /// given directory (subdirectories are not searched). Only files with
+      /// the native shared library extension of the platform (.so, .dylib, or
+      /// .dll) are considered. The libraries are loaded using LoadLibs.
+      ///
+      /// If a library has an up to date sidecar manifest, i.e. a manifest
+      /// file named like the library followed by `.ignplugin` (see
+      /// WriteManifest() and the ign_plugin_add_manifest CMake function), then
+      /// its plugins are registered from the manifest and the library is only
+      /// opened once one of them gets instantiated, just like LoadManifest().
+      /// Otherwise, libraries whose embedded metadata describes all of their
+      /// plugins are registered the same way as ScanLib() does.
+      ///
+      /// \param[in] _directory
+      ///   The path to a directory containing plugin libraries
+      ///
+      /// \returns The set of plugins that have been loaded from the libraries
+      /// in the directory
+      public: std::unordered_set<std::string> LoadDirectory(
+                  const std::string &_directory);
+
+      /// \brief Add a directory to the search path of this Loader, which
+      /// FindLib() and LoadSearchPath() look in. Libraries in the directories
+      /// which were added earlier take precedence.
+      ///
+      /// The directory is listed once, when it is added. After that, it is
+      /// only listed again when files get added to it or removed from it,
+      /// which is reported by inotify on Linux. On other platforms, and if
+      /// inotify is not available, the modification time of the directory is
+      /// checked by each lookup instead.
+      ///
+      /// \param[in] _directory
+      ///   The path to a directory containing plugin libraries
+      ///
+      /// \returns True if the directory was added, false if it does not exist
+      /// or is already in the search path
+      public: bool AddSearchPath(const std::string &_directory);
+
+      /// \brief Find a library in the search path (see AddSearchPath()) by
+      /// its short name, i.e. its file name (e.g. "libMyPlugins.so"), its
+      /// file name without the extension ("libMyPlugins"), or its file name
+      /// without the extension and the "lib" prefix ("MyPlugins"). Unless the
+      /// search path has changed, this is a single lookup in an index and does
+      /// not touch the file system.
+      ///
+      /// \param[in] _libraryName
+      ///   The short name of the library
+      ///
+      /// \returns The path to the library, which can be passed to LoadLib(),
+      /// or an empty string if the search path has no such library
+      public: std::string FindLib(std::string_view _libraryName) const;
+
+      /// \brief Load every library in the search path (see AddSearchPath()),
+      /// the same way as LoadDirectory() does, so that the plugins of all of
+      /// them can be looked up and instantiated by their names. Libraries
+      /// which describe their plugins with a sidecar manifest or with
+      /// embedded metadata are not opened until one of their plugins gets
+      /// instantiated.
+      ///
+      /// \returns The set of plugins that have been loaded from the libraries
+      /// in the search path
+      public: std::unordered_set<std::string> LoadSearchPath();
+
+      /// \brief Load the plugins which are linked into this program
+      /// statically, i.e. the ones that were registered by translation units
+      /// compiled with IGN_PLUGIN_STATIC_REGISTRY defined (see
+      /// ignition/plugin/Register.hh). No library gets opened for them, but
+      /// they are instantiated and queried the same way as the plugins of
+      /// shared libraries.
+      ///
+      /// Calling this again picks up plugins that have been registered since
+      /// then. ForgetLibraryOfPlugin() on any of the static plugins forgets
+      /// all of them.
+      ///
+      /// \returns The set of plugins that have been loaded
+      public: std::unordered_set<std::string> LoadStaticPlugins();
+
+      /// \brief Reload a library whose file has changed since this Loader
+      /// loaded it, e.g. because it was rebuilt. The new version is opened
+      /// alongside the old one, from a private copy of the file, and then
+      /// replaces the plugins of the old version in one step. Plugins that are
+      /// instantiated afterwards come from the new version.
+      ///
+      /// Instances of the old version remain valid, and they keep the old
+      /// version of the library open until they are deleted. Use
+      /// Reinstantiate() to replace them with instances of the new version.
+      ///
+      /// The library is opened with the options that it was loaded with. If
+      /// those make its symbols GLOBAL, the new version may end up using
+      /// functions of the old one, unless deepBind is set as well.
+      ///
+      /// \param[in] _pathToLibrary
+      ///   The path that the library was loaded from
+      ///
+      /// \returns The set of plugins that the new version provides. This is
+      /// empty if the library was not loaded by this Loader, if its file has
+      /// not changed, or if the new version could not be opened, in which
+      /// case the old version stays in place.
+      public: std::unordered_set<std::string> ReloadLib(
+          const std::string &_pathToLibrary);
+
+      /// \brief Close the libraries which were loaded with
+      /// LoadOptions::deferUnload and have been released since, i.e. the
+      /// ones waiting in the unload queue. Call this at a point where it is
+      /// safe to run the destructors of the libraries. The queue is shared by
+      /// every Loader in the process.
+      ///
+      /// \returns The number of libraries that were closed
+      public: static std::size_t FlushUnloadQueue();
+
+      /// \brief Start or stop a background thread which closes the libraries
+      /// in the unload queue as soon as they get posted to it. Stopping the
+      /// thread leaves any libraries that are posted afterwards in the queue
+      /// until FlushUnloadQueue() is called.
+      ///
+      /// The thread is not inherited by the child of a fork. Call this again
+      /// in the child to start a thread of its own.
+      ///
+      /// \param[in] _enabled
+      ///   True to start the thread, false to stop it
+      public: static void SetBackgroundUnloading(bool _enabled);
+
+      /// \brief Hand over a plugin instance to be destroyed later, off the
+      /// calling thread. This is meant for tearing down many instances at
+      /// once, where destroying them inline would stall the caller: the
+      /// instances are moved into a queue which belongs to this Loader, and
+      /// they are destroyed by the threads of SetDestructionWorkers(), by
+      /// FlushDestructionQueue(), or when this Loader is destroyed, whichever
+      /// comes first.
+      ///
+      /// The queue only drops the reference that it was given. If another
+      /// PluginPtr still refers to the same instance, the instance lives on.
+      ///
+      /// Libraries which lose their last instance while the queue is being
+      /// drained are not closed one at a time: they stay open until the
+      /// drain has emptied the queue and are then closed together, see
+      /// EpochGuard.
+      ///
+      /// \param[in] _plugin
+      ///   The instance. It is left empty.
+      public: void Discard(PluginPtr &&_plugin) const;
+
+      /// \brief Hand over a batch of plugin instances to be destroyed later,
+      /// off the calling thread. This takes the lock of the queue only once
+      /// for the whole batch. See Discard(PluginPtr&&).
+      ///
+      /// \param[in] _plugins
+      ///   The instances. The vector is left empty.
+      public: void Discard(std::vector<PluginPtr> &&_plugins) const;
+
+      /// \brief Destroy every instance which has been handed to Discard() and
+      /// is still waiting in the queue. The background threads, if any, help
+      /// with this, and the call returns once they are done with the
+      /// instances that they had already taken.
+      ///
+      /// \returns The number of instances which were destroyed by the
+      /// calling thread. Instances which the background threads destroyed in
+      /// the meantime are not counted.
+      public: std::size_t FlushDestructionQueue() const;
+
+      /// \brief Set the number of background threads which destroy the
+      /// instances that are handed to Discard(). The threads take the
+      /// instances from the queue in chunks, so a large batch gets spread
+      /// across all of them. With no threads, which is the default, the
+      /// instances wait in the queue until FlushDestructionQueue() is called
+      /// or this Loader is destroyed.
+      ///
+      /// The threads belong to this Loader and are stopped when it is
+      /// destroyed. They are not inherited by the child of a fork.
+      ///
+      /// \param[in] _count
+      ///   The number of threads, or 0 to stop all of them
+      public: void SetDestructionWorkers(std::size_t _count);
+
+      /// \brief Get the number of background threads which destroy the
+      /// instances that are handed to Discard()
+      ///
+      /// \returns The number of threads
+      public: std::size_t DestructionWorkers() const;
+
+      /// \brief Resolve the name or alias of a plugin once, so that it can
+      /// be instantiated repeatedly without looking it up again. If the
+      /// library of the plugin was deferred by the manifest cache, it gets
+      /// opened now.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to resolve.
+      ///
+      /// \returns A handle to the plugin, or an invalid handle if the plugin
+      /// is not available. The reason is reported just like for
+      /// Instantiate().
+      public: PluginHandle Resolve(
+          std::string_view _pluginNameOrAlias) const;
+
+      /// \brief Resolve the name or alias of a plugin once, and hand out one
+      /// instance of it per thread. Each thread which calls Get() on the
+      /// result receives its own instance, which is created on its first
+      /// call and deleted when the thread exits. See ThreadLocalPlugin.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to instantiate.
+      ///
+      /// \returns The per-thread instances of the plugin, or an invalid
+      /// ThreadLocalPlugin if the plugin is not available. The reason is
+      /// reported just like for Instantiate().
+      public: ThreadLocalPlugin ThreadLocal(
+          std::string_view _pluginNameOrAlias) const;
+
       /// \brief Instantiates a plugin for the given plugin name
       ///
       /// \param[in] _pluginNameOrAlias
@@ -140,21 +1115,367 @@ namespace ignition
       ///
       /// \returns Pointer to instantiated plugin
       public: PluginPtr Instantiate(
-          const std::string &_pluginNameOrAlias) const;
+          std::string_view _pluginNameOrAlias) const;
+
+      /// \brief Instantiate a plugin by passing arguments straight to one of
+      /// its constructors, which has been registered with
+      /// IGNITION_ADD_PLUGIN_CONSTRUCTOR(). This spares plugins which need
+      /// their arguments up front from being default constructed and then
+      /// initialized in a second step.
+      ///
+      /// The constructor is looked up by the exact types in Args, so they have
+      /// to be spelled out when they differ from the deduced types, e.g.:
+      ///
+      /// \code
+      /// // Registered as IGNITION_ADD_PLUGIN_CONSTRUCTOR(Camera, int,
+      /// //                                            const std::string&)
+      /// loader.InstantiateWith<int, const std::string&>("Camera", 5, name);
+      /// \endcode
+      ///
+      /// Arguments which are taken by value are moved into the constructor,
+      /// and references are passed on as they are. The instance does not come
+      /// from the instance pool of the plugin, see SetInstancePool().
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to instantiate.
+      /// \param[in] _args
+      ///   The arguments of the constructor
+      ///
+      /// \returns Pointer to the instantiated plugin, or an empty PluginPtr if
+      /// the plugin is not available or has no constructor which takes Args.
+      /// The reason is reported just like for Instantiate().
+      public: template <typename... Args>
+      PluginPtr InstantiateWith(
+          std::string_view _pluginNameOrAlias, Args... _args) const;
+
+      /// \brief Get a table of kernels that a plugin exports with
+      /// IGNITION_ADD_PLUGIN_KERNELS(), without instantiating the plugin. The
+      /// library of the plugin is opened if it has not been opened yet, and
+      /// it stays open for as long as the returned pointer exists. For
+      /// example:
+      ///
+      /// \code
+      /// std::shared_ptr<const VectorKernels> kernels =
+      ///     loader.QueryKernelTable<VectorKernels>("Avx2Math");
+      /// if (kernels)
+      ///   kernels->add(a, b, out, n);
+      /// \endcode
+      ///
+      /// \tparam Table The type of the table
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin
+      ///
+      /// \returns The table, or nullptr if the plugin is not available, does
+      /// not export a table of this type, or exports it with an ABI version
+      /// other than Table::kAbiVersion. The reason is reported to the logger.
+      public: template <typename Table>
+      std::shared_ptr<const Table> QueryKernelTable(
+          std::string_view _pluginNameOrAlias) const;
+
+      /// \brief Instantiate the plugin of an existing instance again, from the
+      /// library that currently provides the plugin. This is meant to replace
+      /// instances after ReloadLib(). If both instances provide the Reloadable
+      /// interface, the state of the existing instance is handed over to the
+      /// new one.
+      ///
+      /// \param[in] _plugin
+      ///   The existing instance. It is not modified.
+      ///
+      /// \returns Pointer to the new instance, or an empty PluginPtr if
+      /// _plugin is empty or its plugin is no longer known.
+      public: PluginPtr Reinstantiate(const PluginPtr &_plugin) const;
+
+      /// \brief Keep the instances of a plugin in a pool, so that they get
+      /// reused instead of deleted. The plugin must provide the Recyclable
+      /// interface. While the plugin has a pool, an instance whose last
+      /// PluginPtr is dropped gets Recyclable::Reset() and is kept in the
+      /// pool, as long as the pool holds fewer than _capacity instances.
+      /// Instantiate() and TryInstantiate() take an instance from the pool
+      /// whenever it has one, which skips the factory of the plugin and the
+      /// lookup of its interfaces.
+      ///
+      /// Instances are only pooled when they are instantiated by this Loader
+      /// without a memory resource. The instances in a pool keep the library
+      /// of the plugin open, and they are deleted when the capacity of the
+      /// pool is reduced, when the plugin is forgotten, and when this Loader
+      /// is destroyed.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin
+      /// \param[in] _capacity
+      ///   The largest number of idle instances to keep, or 0 to remove the
+      ///   pool of the plugin
+      ///
+      /// \returns True if the pool was set, false if the plugin is not known
+      /// or does not provide the Recyclable interface
+      public: bool SetInstancePool(
+          std::string_view _pluginNameOrAlias,
+          std::size_t _capacity);
+
+      /// \brief Get the number of idle instances in the pool of a plugin.
+      /// See SetInstancePool().
+      ///
+      /// \param[in] _pluginName
+      ///   The name of the plugin. Aliases are not resolved.
+      ///
+      /// \returns The number of instances that are waiting in the pool, or 0
+      /// if the plugin has no pool
+      public: std::size_t PooledInstances(std::string_view _pluginName) const;
+
+      /// \brief Get plugins ready ahead of a phase in which the first calls
+      /// into them must not be slow. For each plugin, this
+      ///   - opens its library, if it was deferred by the manifest cache,
+      ///   - advises the kernel to read the pages of the library into memory,
+      ///     and optionally locks its code pages into memory,
+      ///   - creates an instance and, if the plugin inherits the Warmup
+      ///     interface, calls Warmup::WarmUp() on it.
+      ///
+      /// The instances are returned, so that they can be used right away.
+      /// Dropping them still leaves the library and its pages warm, and if
+      /// the plugin has an instance pool (see SetInstancePool()), the
+      /// instance goes back into the pool. Symbols which are only bound when
+      /// they are first called stay unbound unless WarmUp() calls them, so
+      /// latency-critical libraries should also be loaded with
+      /// LoadOptions::Binding::NOW.
+      ///
+      /// \param[in] _pluginNamesOrAliases
+      ///   Names or aliases of the plugins to prepare.
+      /// \param[in] _lockCode
+      ///   Lock the executable pages of the libraries into memory with
+      ///   mlock(), so that they cannot be paged out. This needs permission to
+      ///   lock memory, and a failure is reported but does not prevent the
+      ///   plugins from being instantiated. The pages stay locked until the
+      ///   libraries are unloaded.
+      ///
+      /// \returns One instance per entry of _pluginNamesOrAliases, in the same
+      /// order. The instance is empty if the plugin could not be found, in
+      /// which case the reason is reported just like for Instantiate().
+      public: std::vector<PluginPtr> Prewarm(
+          const std::vector<std::string_view> &_pluginNamesOrAliases,
+          bool _lockCode = false) const;
+
+      /// \brief Instantiate a plugin without waiting for its initialization.
+      /// The plugin is constructed on the calling thread, just like with
+      /// Instantiate(). If it provides the AsyncInit interface,
+      /// AsyncInit::InitAsync() is called next, and the future becomes ready
+      /// once the plugin reports that its initialization has finished.
+      /// Otherwise the future is ready right away.
+      ///
+      /// No thread is set aside for the initialization, so an event loop can
+      /// start any number of plugins and pick up their futures as they
+      /// become ready.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to instantiate.
+      ///
+      /// \returns A future for the initialized instance. It holds an empty
+      /// PluginPtr if the plugin could not be found, in which case the reason
+      /// is reported just like for Instantiate(). If the constructor or the
+      /// initialization of the plugin fails with an exception, the future
+      /// holds that exception, and the instance is deleted.
+      public: std::future<PluginPtr> InstantiateAsync(
+          std::string_view _pluginNameOrAlias) const;
+
+      /// \brief Instantiate a plugin in a process of its own, so that a crash
+      /// of the plugin does not take this process down with it. The plugin
+      /// must implement the RemoteCallable interface, and it is called
+      /// through the returned RemotePlugin.
+      ///
+      /// The process is forked from this one, so it inherits this Loader
+      /// along with every library that is loaded, and instantiates the plugin
+      /// from its library. The plugin is resolved before the fork, so the
+      /// new process never touches the locks of this Loader. It still
+      /// inherits the locks of the plugins and of the allocator, which
+      /// another thread may hold at the moment of the fork and which would
+      /// never be released in the new process, so this function must not
+      /// race with other use of this Loader or of its plugins. A process
+      /// which hangs that way is killed once RemoteOptions::startTimeout has
+      /// passed. RemotePlugin::Restart() forks from the same resolved plugin
+      /// and does not need the Loader anymore.
+      ///
+      /// Remote plugins are only supported on Linux. On other platforms the
+      /// returned RemotePlugin never runs.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to instantiate.
+      /// \param[in] _options
+      ///   The size of the shared memory and the timeout of the calls.
+      ///
+      /// \returns The plugin. It is not running if the plugin could not be
+      /// found, does not implement RemoteCallable, or failed to start. A
+      /// plugin which cannot be found is reported just like for
+      /// Instantiate().
+      public: RemotePlugin InstantiateRemote(
+          std::string_view _pluginNameOrAlias,
+          const RemoteOptions &_options = RemoteOptions()) const;
 
       /// \brief Instantiates a plugin of PluginType for the given plugin name.
       /// This can be used to create a specialized PluginPtr.
       ///
+      /// If PluginPtrType is a TypedPluginPtr, the interfaces that it lists
+      /// are checked against the Info of the plugin before an instance gets
+      /// created. When any of them is missing, nothing is instantiated, the
+      /// missing interfaces are reported, and an empty TypedPluginPtr is
+      /// returned.
+      ///
+      /// \tparam PluginPtrType
+      ///   The specialized type of PluginPtrPtr that you
+      ///   want to construct.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin that you want to instantiate.
+      ///
+      /// \returns pointer for the instantiated PluginPtr
+      public: template <typename PluginPtrType>
+      PluginPtrType Instantiate(std::string_view _pluginNameOrAlias) const;
+
+      /// \brief Instantiates a plugin for the given plugin name, taking the
+      /// storage of the plugin instance and of its reference count from a
+      /// memory resource. This lets many short-lived instances come from an
+      /// arena, such as a std::pmr::monotonic_buffer_resource that is released
+      /// all at once.
+      ///
+      /// The memory resource must outlive the plugin instance, i.e. every
+      /// PluginPtr, WeakPluginPtr and interface std::shared_ptr which refers
+      /// to it. The PluginPtr object itself still uses the default heap.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to instantiate.
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage. If this is nullptr,
+      ///   the default heap is used, just like Instantiate(_pluginNameOrAlias).
+      ///
+      /// \returns Pointer to instantiated plugin
+      public: PluginPtr Instantiate(
+          std::string_view _pluginNameOrAlias,
+          std::pmr::memory_resource *_resource) const;
+
+      /// \brief Same as Instantiate(_pluginNameOrAlias, _resource), but
+      /// creates a specialized PluginPtr.
+      ///
       /// \tparam PluginPtrType
       ///   The specialized type of PluginPtrPtr that you
       ///   want to construct.
       ///
       /// \param[in] _pluginNameOrAlias
       ///   Name or alias of the plugin that you want to instantiate.
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage.
       ///
       /// \returns pointer for the instantiated PluginPtr
       public: template <typename PluginPtrType>
-      PluginPtrType Instantiate(const std::string &_pluginNameOrAlias) const;
+      PluginPtrType Instantiate(
+          std::string_view _pluginNameOrAlias,
+          std::pmr::memory_resource *_resource) const;
+
+      /// \brief Instantiates several instances of the same plugin. The name or
+      /// alias is only resolved once, so this is much cheaper than calling
+      /// Instantiate(_pluginNameOrAlias) in a loop.
+      ///
+      /// To place the instances next to each other in memory, pass a memory
+      /// resource which hands out contiguous storage, such as a
+      /// std::pmr::monotonic_buffer_resource. The memory resource must outlive
+      /// all of the instances.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to instantiate.
+      /// \param[in] _count
+      ///   The number of instances to create.
+      /// \param[out] _plugins
+      ///   The new instances are appended to this vector.
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage of the instances, or
+      ///   nullptr to use the default heap.
+      ///
+      /// \returns The number of instances that were appended to _plugins. This
+      /// is 0 if the plugin could not be found.
+      public: std::size_t Instantiate(
+          std::string_view _pluginNameOrAlias,
+          std::size_t _count,
+          std::vector<PluginPtr> &_plugins,
+          std::pmr::memory_resource *_resource = nullptr) const;
+
+      /// \brief Instantiate many different plugins at once, such as all the
+      /// plugins of an application at startup. Plugins which do not depend on
+      /// each other are constructed concurrently, on a set of worker threads
+      /// which includes the calling thread. A plugin is only constructed once
+      /// every plugin of the list that it depends on has been constructed,
+      /// see IGNITION_ADD_PLUGIN_DEPENDENCIES().
+      ///
+      /// Dependencies which are not in the list are ignored, so they do not
+      /// get instantiated. A dependency cycle is reported, and none of the
+      /// plugins that take part in it or depend on it are instantiated. If
+      /// the constructor of a plugin throws an exception, no further plugins
+      /// are started, and the exception is rethrown by this function once the
+      /// workers have finished.
+      ///
+      /// The constructors of the plugins may run on any of the worker
+      /// threads, so they must not rely on running on the calling thread.
+      ///
+      /// \param[in] _pluginNamesOrAliases
+      ///   Names or aliases of the plugins to instantiate. A plugin may be
+      ///   listed more than once, in which case the plugins which depend on
+      ///   it wait for all of its instances.
+      /// \param[in] _threads
+      ///   The largest number of threads to construct plugins on, including
+      ///   the calling thread. If this is 0, the number of hardware threads
+      ///   is used.
+      ///
+      /// \returns One instance per entry of _pluginNamesOrAliases, in the same
+      /// order. The instance is empty if the plugin could not be found or was
+      /// part of a dependency cycle, and the reason is reported.
+      public: std::vector<PluginPtr> InstantiateAll(
+          const std::vector<std::string_view> &_pluginNamesOrAliases,
+          std::size_t _threads = 0) const;
+
+      /// \brief Same as Instantiate(_pluginNameOrAlias, _count, _plugins,
+      /// _resource), but creates specialized PluginPtrs.
+      ///
+      /// \tparam PluginPtrType
+      ///   The specialized type of PluginPtrPtr that you
+      ///   want to construct.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to instantiate.
+      /// \param[in] _count
+      ///   The number of instances to create.
+      /// \param[out] _plugins
+      ///   The new instances are appended to this vector.
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage of the instances, or
+      ///   nullptr to use the default heap.
+      ///
+      /// \returns The number of instances that were appended to _plugins.
+      public: template <typename PluginPtrType>
+      std::size_t Instantiate(
+          std::string_view _pluginNameOrAlias,
+          std::size_t _count,
+          std::vector<PluginPtrType> &_plugins,
+          std::pmr::memory_resource *_resource = nullptr) const;
+
+      /// \brief Same as Instantiate(), except that no diagnostic message is
+      /// produced when the name or alias cannot be resolved, and the reason
+      /// why the plugin could not be instantiated is returned instead. Errors
+      /// from opening a library that was deferred by the manifest cache are
+      /// still reported.
+      ///
+      /// \tparam PluginPtrType
+      ///   The type of PluginPtr to instantiate into. This can be deduced
+      ///   from _plugin.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin that you want to instantiate.
+      ///
+      /// \param[out] _plugin
+      ///   Receives the new plugin instance if the return value is FOUND. It is
+      ///   left untouched otherwise.
+      ///
+      /// \return FOUND if the plugin was instantiated, otherwise the reason
+      /// why it was not.
+      public: template <typename PluginPtrType>
+      LookupStatus TryInstantiate(
+          std::string_view _pluginNameOrAlias,
+          PluginPtrType &_plugin) const;
 
       /// \brief Instantiates a plugin for the given plugin name, and then
       /// returns a reference-counting interface corresponding to InterfaceType.
@@ -163,7 +1484,8 @@ namespace ignition
       /// Construct(...) on the returned interface, as long as the returned
       /// interface is not a nullptr.
       ///
-      /// \remark This function is identical to:
+      /// \remark Unless SetFactoryCaching() has been turned on, this function
+      /// is identical to:
       ///
       /// \code
       /// loader->Instantiate(_pluginNameOrAlias)
@@ -181,7 +1503,30 @@ namespace ignition
       /// requested plugin.
       public: template <typename InterfaceType>
       std::shared_ptr<InterfaceType> Factory(
-          const std::string &_pluginNameOrAlias) const;
+          std::string_view _pluginNameOrAlias) const;
+
+      /// \brief Let Factory() keep one instance of each plugin that it is
+      /// asked for, and hand out that instance again the next time, instead
+      /// of instantiating the plugin on every call. Factory plugins are
+      /// normally stateless, so that repeated calls like
+      /// `loader.Factory<MyFactory>("MyPlugin")->Construct(...)` then only pay
+      /// for a lookup. Every name and alias of a plugin shares its instance.
+      ///
+      /// The cached instances keep their libraries loaded. An instance is
+      /// dropped when its plugin is forgotten, e.g. by ForgetLibrary() or
+      /// ReloadLib(), so the next call makes a new one. Since the instance is
+      /// shared by every caller, possibly on different threads, only turn this
+      /// on for plugins whose interfaces are safe to share that way.
+      ///
+      /// \param[in] _enabled
+      ///   True to cache instances. False to stop caching and drop the
+      ///   instances which are cached.
+      public: void SetFactoryCaching(bool _enabled);
+
+      /// \brief Check whether Factory() caches its instances. See
+      /// SetFactoryCaching().
+      /// \return True if the instances are cached
+      public: bool FactoryCaching() const;
 
       /// \brief This loader will forget about the library at the given path
       /// location. If you want to instantiate a plugin from this library using
@@ -217,9 +1562,141 @@ namespace ignition
       ///   Name or alias of the plugin whose library you want to forget.
       ///
       /// \sa bool ForgetLibrary(const std::string &_pathToLibrary)
-      public: bool ForgetLibraryOfPlugin(const std::string &_pluginNameOrAlias);
+      public: bool ForgetLibraryOfPlugin(std::string_view _pluginNameOrAlias);
+
+      /// \brief Resolve a plugin name or alias and get both the Info and the
+      /// library handle of the plugin that it refers to. This is done in one
+      /// step so that the result is consistent even if another thread is
+      /// loading or forgetting libraries at the same time.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin
+      ///
+      /// \param[out] _info
+      ///   Receives the Info of the plugin
+      ///
+      /// \param[out] _dlHandle
+      ///   Receives the handle of the library that provides the plugin
+      ///
+      /// \param[in] _report
+      ///   If true, a diagnostic message is produced when the plugin cannot be
+      ///   resolved.
+      ///
+      /// \return FOUND if the plugin could be resolved, otherwise the reason
+      /// why it could not.
+      private: LookupStatus PrivateGetInfoAndDlHandle(
+          std::string_view _pluginNameOrAlias,
+          ConstInfoPtr &_info,
+          std::shared_ptr<void> &_dlHandle,
+          bool _report) const;
+
+      /// \brief Create a plugin instance, or take one from the pool of the
+      /// plugin if it has one and no memory resource is given.
+      ///
+      /// \param[in] _info
+      ///   The Info of the plugin
+      /// \param[in] _dlHandle
+      ///   The handle of the library that provides the plugin
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage of the instance, or
+      ///   nullptr to use the default heap
+      ///
+      /// \return The instance
+      private: template <typename PluginPtrType>
+      PluginPtrType PrivateInstantiate(
+          const ConstInfoPtr &_info,
+          const std::shared_ptr<void> &_dlHandle,
+          std::pmr::memory_resource *_resource) const;
+
+      /// \brief Implementation of InstantiateWith()
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin to instantiate
+      /// \param[in] _signature
+      ///   The mangled name of the signature of the constructor, i.e.
+      ///   typeid(void(Args...)).name()
+      /// \param[in] _arguments
+      ///   Pointer to a std::tuple<Args&&...> of the arguments
+      ///
+      /// \return The instance, or an empty PluginPtr
+      private: PluginPtr PrivateInstantiateWith(
+          std::string_view _pluginNameOrAlias,
+          const char *_signature,
+          void *_arguments) const;
+
+      /// \brief Implementation of QueryKernelTable()
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin
+      /// \param[in] _table
+      ///   The mangled name of the type of the table
+      /// \param[in] _abiVersion
+      ///   The ABI version that the caller expects the table to have
+      ///
+      /// \return The table, which keeps the library of the plugin open, or
+      /// nullptr
+      private: std::shared_ptr<const void> PrivateQueryKernelTable(
+          std::string_view _pluginNameOrAlias,
+          const char *_table,
+          std::uint32_t _abiVersion) const;
+
+      /// \brief Get the account of the library of a plugin, if this Loader
+      /// accounts for allocations. See SetAllocationAccounting().
+      ///
+      /// \param[in] _dlHandle
+      ///   The handle of the library that provides the plugin
+      ///
+      /// \return The account, or nullptr
+      private: std::pmr::memory_resource *PrivateAllocationAccount(
+          const std::shared_ptr<void> &_dlHandle) const;
+
+      /// \brief Check that a plugin provides every interface that a
+      /// TypedPluginPtr needs, and report the ones which it does not provide.
+      ///
+      /// \param[in] _info
+      ///   The Info of the plugin
+      /// \param[in] _interfaces
+      ///   The mangled names of the interfaces
+      /// \param[in] _count
+      ///   The number of interfaces
+      ///
+      /// \return True if the plugin provides all of the interfaces
+      private: bool PrivateProvidesInterfaces(
+          const ConstInfoPtr &_info,
+          const char *const *_interfaces,
+          std::size_t _count) const;
+
+      /// \brief Get the instance which Factory() uses, which is the cached
+      /// instance of the plugin if SetFactoryCaching() has been turned on.
+      ///
+      /// \param[in] _pluginNameOrAlias
+      ///   Name or alias of the plugin
+      ///
+      /// \return The instance, or an empty PluginPtr if the plugin could not
+      /// be instantiated
+      private: PluginPtr PrivateFactoryInstance(
+          std::string_view _pluginNameOrAlias) const;
+
+      /// \brief Take an instance of a plugin from its pool.
+      ///
+      /// \param[in] _info
+      ///   The Info of the plugin
+      /// \param[in] _dlHandle
+      ///   The handle of the library that provides the plugin, for making a
+      ///   new instance when the pool is empty
+      /// \param[out] _table
+      ///   Receives the interface table of the instance, see
+      ///   Plugin::PrivateGetSharedInterfaceTable()
+      ///
+      /// \return The instance, or nullptr if the plugin has no pool
+      private: std::shared_ptr<void> PrivateCheckOutPooled(
+          const ConstInfoPtr &_info,
+          const std::shared_ptr<void> &_dlHandle,
+          const void *&_table) const;
 
       /// \brief Get a pointer to the Info corresponding to _pluginName.
+      /// If the library of the plugin has not been opened yet, it will be
+      /// opened.
       ///
       /// \param[in] _resolvedName
       ///   The resolved name, i.e. the demangled class symbol name as returned
@@ -228,10 +1705,11 @@ namespace ignition
       /// \return Pointer to the corresponding Info, or nullptr if there
       /// is no info for the requested _pluginName.
       private: ConstInfoPtr PrivateGetInfo(
-          const std::string &_resolvedName) const;
+          std::string_view _resolvedName) const;
 
       /// \brief Get a std::shared_ptr that manages the lifecycle of the shared
-      /// library handle which provides the specified plugin.
+      /// library handle which provides the specified plugin. If the library
+      /// has not been opened yet, it will be opened.
       ///
       /// \param[in] _resolvedName
       ///   The resolved name, i.e. the demangled class symbol name as returned
@@ -240,13 +1718,37 @@ namespace ignition
       /// \return Reference-counting pointer to a library handle, or else a
       /// nullptr if the plugin is not available.
       private: std::shared_ptr<void> PrivateGetPluginDlHandlePtr(
-          const std::string &_resolvedName) const;
+          std::string_view _resolvedName) const;
+
+      /// \brief Load a list of libraries, registering the ones which are
+      /// described by a sidecar manifest or by embedded metadata without
+      /// opening them. See LoadDirectory().
+      ///
+      /// \param[in] _libraries
+      ///   The paths to the libraries
+      ///
+      /// \return The set of plugins that have been loaded from the libraries
+      private: std::unordered_set<std::string> LoadListedLibs(
+          const std::vector<std::string> &_libraries);
+
+      /// \brief Open the libraries which a batch of changes loads, then apply
+      /// all of the changes to the registry in one step. This implements
+      /// LoadLibs() and Transaction::Commit().
+      ///
+      /// \param[in] _changes
+      ///   The changes, in the order in which they get applied
+      ///
+      /// \return The set of plugins that the loads have registered
+      private: std::unordered_set<std::string> CommitChanges(
+          const std::vector<Transaction::Change> &_changes);
 
       class Implementation;
       IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
       /// \brief PIMPL pointer to class implementation
       private: std::unique_ptr<Implementation> dataPtr;
       IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+      friend class PluginHandle;
     };
   }
 }
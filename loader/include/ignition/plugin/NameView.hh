@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_NAMEVIEW_HH_
+#define IGNITION_PLUGIN_NAMEVIEW_HH_
+
+#include <cstddef>
+#include <iterator>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    // Forward declaration
+    class Loader;
+
+    /// \brief A read-only view of names which are stored in the registry of a
+    /// Loader, e.g. the names of the plugins which implement an interface.
+    /// Getting a view does not copy any of the names, so it does not allocate
+    /// any memory.
+    ///
+    /// A view holds a shared lock on the registry of its Loader, which makes it
+    /// a snapshot: its names stay valid and unchanged for as long as the view
+    /// exists, no matter what other threads do with the Loader. Functions
+    /// which change the registry, like Loader::LoadLib() and
+    /// Loader::ForgetLibrary(), wait until every view of the registry is gone.
+    /// So a thread must never change a Loader while it holds one of its views,
+    /// and views should be dropped as soon as they are no longer needed.
+    ///
+    /// The order of the names is unspecified.
+    class NameView
+    {
+      /// \brief Iterates over the names of a view
+      public: class const_iterator
+      {
+        public: using iterator_category = std::forward_iterator_tag;
+        public: using value_type = std::string_view;
+        public: using difference_type = std::ptrdiff_t;
+        public: using pointer = const std::string_view *;
+        public: using reference = const std::string_view &;
+
+        /// \brief Default constructor
+        public: const_iterator() = default;
+
+        /// \brief Get the current name
+        /// \return The name
+        public: reference operator*() const
+        {
+          return this->index < this->view->count ?
+                this->view->names[this->index] : this->view->extra;
+        }
+
+        /// \brief Get the current name
+        /// \return A pointer to the name
+        public: pointer operator->() const
+        {
+          return &**this;
+        }
+
+        /// \brief Move to the next name
+        /// \return This iterator
+        public: const_iterator &operator++()
+        {
+          ++this->index;
+          return *this;
+        }
+
+        /// \brief Move to the next name
+        /// \return A copy of this iterator from before it was moved
+        public: const_iterator operator++(int)
+        {
+          const_iterator previous = *this;
+          ++this->index;
+          return previous;
+        }
+
+        /// \brief Check whether two iterators point at the same name
+        /// \param[in] _other Another iterator of the same view
+        /// \return True if both point at the same name
+        public: bool operator==(const const_iterator &_other) const
+        {
+          return this->index == _other.index;
+        }
+
+        /// \brief Check whether two iterators point at different names
+        /// \param[in] _other Another iterator of the same view
+        /// \return True if they point at different names
+        public: bool operator!=(const const_iterator &_other) const
+        {
+          return this->index != _other.index;
+        }
+
+        /// \brief Constructor
+        /// \param[in] _view The view
+        /// \param[in] _index The position of the name in the view
+        private: const_iterator(const NameView *_view, std::size_t _index)
+          : view(_view),
+            index(_index)
+        {
+        }
+
+        /// \brief The view
+        private: const NameView *view = nullptr;
+
+        /// \brief The position of the name in the view
+        private: std::size_t index = 0;
+
+        friend class NameView;
+      };
+
+      /// \brief Construct an empty view, which does not lock anything
+      public: NameView() = default;
+
+      /// \brief Move constructor. The lock moves along with the names.
+      public: NameView(NameView &&) = default;
+
+      /// \brief Move assignment. The lock of this view is released first.
+      public: NameView &operator=(NameView &&) = default;
+
+      /// \brief Get the first name
+      /// \return An iterator to the first name
+      public: const_iterator begin() const
+      {
+        return const_iterator(this, 0);
+      }
+
+      /// \brief Get the end of the names
+      /// \return An iterator past the last name
+      public: const_iterator end() const
+      {
+        return const_iterator(this, this->size());
+      }
+
+      /// \brief Get the number of names
+      /// \return The number of names
+      public: std::size_t size() const
+      {
+        return this->count + (nullptr == this->extra.data() ? 0 : 1);
+      }
+
+      /// \brief Check whether there are no names
+      /// \return True if there are no names
+      public: bool empty() const
+      {
+        return 0 == this->size();
+      }
+
+      /// \brief Check whether the view contains a name
+      /// \param[in] _name The name
+      /// \return True if the name is in the view
+      public: bool Contains(std::string_view _name) const
+      {
+        for (const std::string_view name : *this)
+        {
+          if (name == _name)
+            return true;
+        }
+
+        return false;
+      }
+
+      /// \brief Constructor, used by Loader
+      /// \param[in] _lock The lock on the registry
+      /// \param[in] _names The names, which the registry stores contiguously
+      /// \param[in] _count The number of names in _names
+      /// \param[in] _extra One more name which the registry stores somewhere
+      /// else, or a view with a nullptr data() if there is none
+      private: NameView(std::shared_lock<std::shared_mutex> &&_lock,
+                        const std::string_view *_names,
+                        const std::size_t _count,
+                        const std::string_view _extra = std::string_view())
+        : lock(std::move(_lock)),
+          names(_names),
+          count(_count),
+          extra(_extra)
+      {
+      }
+
+      /// \brief Keeps the registry from changing while the view exists
+      private: std::shared_lock<std::shared_mutex> lock;
+
+      /// \brief The names which the registry stores contiguously
+      private: const std::string_view *names = nullptr;
+
+      /// \brief The number of names in `names`
+      private: std::size_t count = 0;
+
+      /// \brief A name which comes after `names`, if its data() is not nullptr
+      private: std::string_view extra;
+
+      friend class Loader;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_PLUGINHANDLE_HH_
+#define IGNITION_PLUGIN_PLUGINHANDLE_HH_
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+
+#include <ignition/utilities/SuppressWarning.hh>
+
+#include <ignition/plugin/loader/Export.hh>
+#include <ignition/plugin/Info.hh>
+#include <ignition/plugin/PluginPtr.hh>
+#include <ignition/plugin/TypedPluginPtr.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    // Forward declaration
+    class Loader;
+
+    /// \brief A plugin whose name or alias has already been resolved by a
+    /// Loader. Instantiating a plugin through its handle skips the name
+    /// lookup, the alias disambiguation, and the search for the library of
+    /// the plugin, so it is much cheaper than calling Loader::Instantiate()
+    /// whenever the same plugin gets instantiated over and over.
+    ///
+    /// A handle keeps the library of its plugin loaded for as long as the
+    /// handle exists, even if the Loader which made it has forgotten the
+    /// library or has been destroyed.
+    ///
+    /// While the Loader which made the handle exists, the instances go through
+    /// it exactly like the ones of Loader::Instantiate(), so they are taken
+    /// from the instance pool of the plugin and are accounted to its library.
+    /// Once the Loader is gone, they are plainly constructed. Destroying the
+    /// Loader while another thread instantiates through one of its handles is
+    /// not allowed, just like any other use of a Loader during its
+    /// destruction.
+    class IGNITION_PLUGIN_LOADER_VISIBLE PluginHandle
+    {
+      /// \brief Default constructor. Creates a handle which does not refer to
+      /// any plugin.
+      public: PluginHandle() = default;
+
+      /// \brief Check whether this handle refers to a plugin
+      /// \return True if this handle refers to a plugin, otherwise false.
+      public: bool IsValid() const;
+
+      /// \brief Implicitly convert this handle to a boolean
+      /// \return The same value as IsValid()
+      public: operator bool() const;
+
+      /// \brief Get the name of the plugin that this handle refers to
+      /// \return A pointer to the name of the plugin, or nullptr if this
+      /// handle does not refer to a plugin.
+      public: const std::string *Name() const;
+
+      /// \brief Instantiate the plugin that this handle refers to
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage of the instance, or
+      ///   nullptr to use the default heap. The memory resource must outlive
+      ///   the instance.
+      /// \return Pointer to the instantiated plugin, or an empty PluginPtr if
+      /// this handle does not refer to a plugin.
+      public: PluginPtr Instantiate(
+          std::pmr::memory_resource *_resource = nullptr) const;
+
+      /// \brief Instantiate the plugin that this handle refers to as a
+      /// specialized PluginPtr
+      /// \tparam PluginPtrType
+      ///   The specialized type of PluginPtr that you want to construct.
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage of the instance, or
+      ///   nullptr to use the default heap.
+      /// \return Pointer to the instantiated plugin, or an empty PluginPtr if
+      /// this handle does not refer to a plugin.
+      public: template <typename PluginPtrType>
+      PluginPtrType Instantiate(
+          std::pmr::memory_resource *_resource = nullptr) const;
+
+      /// \brief Instantiate the plugin that this handle refers to, and then
+      /// return a reference-counting interface corresponding to InterfaceType.
+      /// This is the equivalent of Loader::Factory<InterfaceType>().
+      /// \tparam InterfaceType
+      ///   The type of interface to look for.
+      /// \return A reference to the InterfaceType of the new plugin instance,
+      /// or nullptr if the plugin does not provide it.
+      public: template <typename InterfaceType>
+      std::shared_ptr<InterfaceType> Factory() const;
+
+      /// \brief Constructor used by Loader::Resolve()
+      /// \param[in] _info The Info of the plugin
+      /// \param[in] _dlHandlePtr The handle of the library of the plugin
+      /// \param[in] _loader The Loader which resolved the plugin
+      private: PluginHandle(
+          ConstInfoPtr _info,
+          std::shared_ptr<void> _dlHandlePtr,
+          std::weak_ptr<const Loader *> _loader);
+
+      /// \brief Create an instance through the Loader which made this handle,
+      /// or directly if that Loader no longer exists.
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage of the instance, or
+      ///   nullptr to use the default heap
+      /// \return The instance, or an empty PluginPtr if this handle does not
+      /// refer to a plugin.
+      private: PluginPtr PrivateInstantiate(
+          std::pmr::memory_resource *_resource) const;
+
+      /// \brief Construct an instance straight from the library, without
+      /// going through any Loader. This is how instances are made once the
+      /// Loader is gone, and in the process of a RemotePlugin.
+      /// \param[in] _resource
+      ///   The memory resource which provides the storage of the instance, or
+      ///   nullptr to use the default heap
+      /// \return The instance, or an empty PluginPtr if this handle does not
+      /// refer to a plugin.
+      private: PluginPtr PrivateConstruct(
+          std::pmr::memory_resource *_resource) const;
+
+      /// \brief Check that the plugin provides every interface that a
+      /// TypedPluginPtr needs. The Loader which made this handle reports the
+      /// ones which it does not provide.
+      /// \param[in] _interfaces The mangled names of the interfaces
+      /// \param[in] _count The number of interfaces
+      /// \return True if the plugin provides all of the interfaces
+      private: bool PrivateProvidesInterfaces(
+          const char *const *_interfaces,
+          std::size_t _count) const;
+
+      IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+      /// \brief A reference counting handle for the shared library that
+      /// provides the plugin.
+      ///
+      /// CRUCIAL DEV NOTE: `dlHandlePtr` MUST come BEFORE `info` in this
+      /// class definition to ensure that `info` gets deleted first (member
+      /// variables get destructed in the reverse order of their appearance in
+      /// the class definition). The Info points into the shared library, so
+      /// the library must remain loaded for as long as the Info exists.
+      ///
+      /// If you change this class definition for ANY reason, be sure to
+      /// maintain the ordering of these member variables.
+      private: std::shared_ptr<void> dlHandlePtr;
+
+      /// \brief The Info of the plugin
+      private: ConstInfoPtr info;
+
+      /// \brief The Loader which made this handle. This expires when the
+      /// Loader is destroyed.
+      private: std::weak_ptr<const Loader *> loader;
+      IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+      friend class Loader;
+      friend class RemotePlugin;
+    };
+  }
+}
+
+#include <ignition/plugin/detail/PluginHandle.hh>
+
+#endif
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_REMOTEPLUGIN_HH_
+#define IGNITION_PLUGIN_REMOTEPLUGIN_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <ignition/utilities/SuppressWarning.hh>
+
+#include <ignition/plugin/loader/Export.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    // Forward declarations
+    class Loader;
+    class PluginHandle;
+
+    /// \brief Options of a plugin which is hosted in a separate process. See
+    /// Loader::InstantiateRemote().
+    struct RemoteOptions
+    {
+      /// \brief The number of calls which can be in flight at once, i.e.
+      /// made with RemotePlugin::Send() but not handled yet. At least one
+      /// slot is used.
+      std::size_t slots = 16;
+
+      /// \brief The largest number of bytes that the arguments of a call, and
+      /// separately its results, may take up
+      std::size_t slotSize = 4096;
+
+      /// \brief How long to wait for the hosting process to handle a call,
+      /// or zero to wait for as long as the process is alive. A process which
+      /// takes longer is considered hung and gets killed.
+      std::chrono::milliseconds timeout{0};
+
+      /// \brief How long to wait for the hosting process to instantiate the
+      /// plugin, or zero to wait for as long as the process is alive. This is
+      /// separate from `timeout`, so that a process which hangs while it
+      /// starts gets killed even when the calls may take forever.
+      std::chrono::milliseconds startTimeout{10000};
+    };
+
+    /// \brief The outcome of a call to a RemotePlugin
+    enum class RemoteStatus
+    {
+      /// \brief The call was handled
+      OK,
+
+      /// \brief The plugin is not running, e.g. because its process has died
+      /// earlier. See RemotePlugin::Restart().
+      NOT_RUNNING,
+
+      /// \brief The arguments or the results of the call do not fit into a
+      /// slot, see RemoteOptions::slotSize
+      TOO_LARGE,
+
+      /// \brief The plugin did not know the method, or reported a failure
+      FAILED,
+
+      /// \brief The process of the plugin died while handling the call
+      DIED,
+
+      /// \brief The process of the plugin did not handle the call within
+      /// RemoteOptions::timeout, and has been killed
+      TIMED_OUT
+    };
+
+    /// \brief A plugin instance which lives in a process of its own, so that
+    /// a crash of the plugin only takes down that process. Create one with
+    /// Loader::InstantiateRemote(). The plugin must implement the
+    /// RemoteCallable interface.
+    ///
+    /// Calls travel through a ring of slots in memory which both processes
+    /// share. The caller writes the arguments straight into a slot, the
+    /// plugin reads them and writes its results in place, and neither side
+    /// makes a system call while the other one keeps up, so a round trip
+    /// costs microseconds. Calls which do not need a result can be queued
+    /// with Send() without waiting for them.
+    ///
+    /// A RemotePlugin can be moved but not copied. Its calls are serialized,
+    /// so it may be shared between threads, but they wait for each other.
+    /// Destroying it stops the process.
+    class IGNITION_PLUGIN_LOADER_VISIBLE RemotePlugin
+    {
+      /// \brief Default constructor. Creates an object which is not running.
+      public: RemotePlugin();
+
+      /// \brief Move constructor
+      /// \param[in] _other The plugin to take over
+      public: RemotePlugin(RemotePlugin &&_other);
+
+      /// \brief Move assignment. The process of this object is stopped first.
+      /// \param[in] _other The plugin to take over
+      /// \return This object
+      public: RemotePlugin &operator=(RemotePlugin &&_other);
+
+      /// \brief Destructor. Asks the process to exit, and kills it if it
+      /// does not.
+      public: ~RemotePlugin();
+
+      /// \brief Check whether the process of the plugin is running
+      /// \return True if calls can be made
+      public: bool IsRunning() const;
+
+      /// \brief Same as IsRunning()
+      public: explicit operator bool() const;
+
+      /// \brief Get the process ID of the process which hosts the plugin
+      /// \return The process ID, or -1 if it is not running
+      public: int ProcessId() const;
+
+      /// \brief Get the largest number of bytes that the arguments or the
+      /// results of a call may take up
+      /// \return The size of a slot
+      public: std::size_t SlotSize() const;
+
+      /// \brief Call the plugin and wait for its results
+      /// \param[in] _method The method number, see RemoteCallable
+      /// \param[in] _input The arguments
+      /// \param[in] _inputSize The number of bytes in _input
+      /// \param[out] _output Receives the results
+      /// \param[in] _outputCapacity The number of bytes that _output can hold
+      /// \param[out] _outputSize If not nullptr, receives the number of
+      /// bytes that were written to _output
+      /// \return The outcome of the call
+      public: RemoteStatus Call(
+          std::uint32_t _method,
+          const void *_input, std::size_t _inputSize,
+          void *_output, std::size_t _outputCapacity,
+          std::size_t *_outputSize = nullptr);
+
+      /// \brief Call the plugin with a plain struct, and receive a plain
+      /// struct back
+      /// \param[in] _method The method number, see RemoteCallable
+      /// \param[in] _input The arguments
+      /// \param[out] _output Receives the results
+      /// \return The outcome of the call. This is FAILED if the plugin wrote
+      /// a different number of bytes than the size of Output.
+      public: template <typename Input, typename Output>
+      RemoteStatus Call(std::uint32_t _method,
+                        const Input &_input, Output &_output)
+      {
+        static_assert(std::is_trivially_copyable<Input>::value &&
+                      std::is_trivially_copyable<Output>::value,
+                      "Only trivially copyable types can cross processes");
+
+        std::size_t size = 0;
+        const RemoteStatus status = this->Call(
+              _method, &_input, sizeof(Input),
+              &_output, sizeof(Output), &size);
+        if (RemoteStatus::OK == status && sizeof(Output) != size)
+          return RemoteStatus::FAILED;
+
+        return status;
+      }
+
+      /// \brief Call the plugin, writing the arguments straight into shared
+      /// memory and reading the results from there, without copying them
+      /// through buffers of the caller. This suits large arrays.
+      /// \param[in] _method The method number, see RemoteCallable
+      /// \param[in] _inputSize The number of bytes of the arguments
+      /// \param[in] _write Writes the arguments to the storage that it is
+      /// given, which holds _inputSize bytes
+      /// \param[in] _read Reads the results from the storage that it is
+      /// given, along with the number of bytes that the plugin wrote. It is
+      /// only called if the call succeeded.
+      /// \return The outcome of the call
+      public: RemoteStatus CallInPlace(
+          std::uint32_t _method, std::size_t _inputSize,
+          const std::function<void(void *_input)> &_write,
+          const std::function<void(const void *_output,
+                                   std::size_t _outputSize)> &_read);
+
+      /// \brief Queue a call to the plugin without waiting for it. The call
+      /// is handled after the calls which were made before it, and its
+      /// results are dropped. This only waits if every slot is taken.
+      /// \param[in] _method The method number, see RemoteCallable
+      /// \param[in] _input The arguments
+      /// \param[in] _inputSize The number of bytes in _input
+      /// \return OK once the call is queued. Whether the plugin handled it
+      /// successfully is not reported.
+      public: RemoteStatus Send(
+          std::uint32_t _method,
+          const void *_input, std::size_t _inputSize);
+
+      /// \brief Start a new process for the plugin, e.g. after the previous
+      /// one has died. The new process gets a fresh instance of the plugin,
+      /// constructed from the library that the plugin was resolved to by
+      /// Loader::InstantiateRemote(). The Loader is not used again.
+      /// \return True if the plugin is running again
+      public: bool Restart();
+
+      /// \brief Constructor, used by Loader. Starts the process.
+      /// \param[in] _handle The resolved plugin
+      /// \param[in] _options The options of the plugin
+      private: RemotePlugin(PluginHandle _handle,
+                            const RemoteOptions &_options);
+
+      /// \brief Private data
+      private: class Implementation;
+      IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+      private: std::unique_ptr<Implementation> dataPtr;
+      IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+      friend class Loader;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_THREADLOCALPLUGIN_HH_
+#define IGNITION_PLUGIN_THREADLOCALPLUGIN_HH_
+
+#include <memory>
+#include <string>
+
+#include <ignition/utilities/SuppressWarning.hh>
+
+#include <ignition/plugin/loader/Export.hh>
+#include <ignition/plugin/PluginHandle.hh>
+#include <ignition/plugin/PluginPtr.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Hands out one instance of a plugin per thread, for plugins
+    /// which keep state and are not thread-safe. Each thread gets its own
+    /// instance the first time that it calls Get(), and the instance is
+    /// deleted when the thread exits. Threads never share an instance, so a
+    /// parallel pipeline can use the plugin without any locking.
+    ///
+    /// Every ThreadLocalPlugin owns a slot in a table that each thread keeps
+    /// for itself, so Get() only needs to index that table, instead of
+    /// looking the plugin up in a map. Copies of a ThreadLocalPlugin share
+    /// the same slot, i.e. they hand out the same instance on a given thread.
+    ///
+    /// When the last copy of a ThreadLocalPlugin is destroyed, the instance
+    /// of the thread which destroys it is deleted right away. The instances
+    /// of other threads are deleted when those threads exit, or when they
+    /// use a newer ThreadLocalPlugin which has taken over the slot. Until
+    /// then they keep the library of the plugin loaded.
+    ///
+    /// \code
+    /// const ThreadLocalPlugin detector = loader.ThreadLocal("MyDetector");
+    ///
+    /// // On any worker thread:
+    /// detector.Get()->QueryInterface<Detector>()->Detect(image);
+    /// \endcode
+    class IGNITION_PLUGIN_LOADER_VISIBLE ThreadLocalPlugin
+    {
+      /// \brief Default constructor. Creates an object which does not refer
+      /// to any plugin.
+      public: ThreadLocalPlugin() = default;
+
+      /// \brief Hand out instances of the plugin of a handle
+      /// \param[in] _handle
+      ///   The plugin to instantiate. If the handle is not valid, this object
+      ///   does not refer to any plugin.
+      public: explicit ThreadLocalPlugin(PluginHandle _handle);
+
+      /// \brief Check whether this object refers to a plugin
+      /// \return True if this object refers to a plugin, otherwise false.
+      public: bool IsValid() const;
+
+      /// \brief Implicitly convert this object to a boolean
+      /// \return The same value as IsValid()
+      public: operator bool() const;
+
+      /// \brief Get the name of the plugin that this object refers to
+      /// \return A pointer to the name of the plugin, or nullptr if this
+      /// object does not refer to a plugin.
+      public: const std::string *Name() const;
+
+      /// \brief Get the instance of the plugin which belongs to the calling
+      /// thread, and instantiate it if the thread does not have one yet.
+      ///
+      /// The reference stays valid until Release() is called on the same
+      /// thread, until the last copy of this object is destroyed, or until
+      /// the thread exits. It must not be handed to other threads.
+      ///
+      /// \return The instance of the calling thread, or an empty PluginPtr
+      /// if this object does not refer to a plugin.
+      public: const PluginPtr &Get() const;
+
+      /// \brief Delete the instance of the calling thread, if it has one.
+      /// The next call to Get() on this thread creates a new instance. The
+      /// instances of other threads are not affected.
+      public: void Release() const;
+
+      /// \brief Check whether the calling thread has an instance already
+      /// \return True if Get() would return an existing instance
+      public: bool HasInstance() const;
+
+      private: class Implementation;
+      IGN_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+      /// \brief PIMPL pointer to the slot of this object. It is shared by
+      /// every copy.
+      private: std::shared_ptr<const Implementation> dataPtr;
+      IGN_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+    };
+  }
+}
+
+#endif
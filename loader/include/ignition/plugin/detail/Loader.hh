@@ -19,45 +19,210 @@
 #ifndef IGNITION_PLUGIN_DETAIL_LOADER_HH_
 #define IGNITION_PLUGIN_DETAIL_LOADER_HH_
 
+#include <iterator>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <typeinfo>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 #include <ignition/plugin/EnablePluginFromThis.hh>
 #include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/Trace.hh>
 
 namespace ignition
 {
   namespace plugin
   {
-    template <typename Interface>
+    template <typename Interface, typename... Interfaces>
     std::unordered_set<std::string> Loader::PluginsImplementing() const
     {
-      return this->PluginsImplementing(typeid(Interface).name(), false);
+      if constexpr (sizeof...(Interfaces) == 0)
+      {
+        return this->PluginsImplementing(typeid(Interface).name(), false);
+      }
+      else
+      {
+        return this->PluginsImplementingAll<Interface, Interfaces...>();
+      }
+    }
+
+    template <typename Interface>
+    NameView Loader::PluginsImplementingView() const
+    {
+      return this->PluginsImplementingView(typeid(Interface).name(), false);
+    }
+
+    template <typename Interface, typename... Interfaces>
+    std::unordered_set<std::string> Loader::PluginsImplementingAll() const
+    {
+      return this->PluginsImplementingAll(
+          {typeid(Interface).name(), typeid(Interfaces).name()...}, false);
+    }
+
+    template <typename Interface, typename... Interfaces>
+    std::unordered_set<std::string> Loader::PluginsImplementingAny() const
+    {
+      return this->PluginsImplementingAny(
+          {typeid(Interface).name(), typeid(Interfaces).name()...}, false);
     }
 
     template <typename PluginPtrType>
     PluginPtrType Loader::Instantiate(
-        const std::string &_pluginNameOrAlias) const
+        std::string_view _pluginNameOrAlias) const
     {
-      const std::string &resolvedName = this->LookupPlugin(_pluginNameOrAlias);
-      if (resolvedName.empty())
+      detail::TraceScope trace("Instantiate", _pluginNameOrAlias);
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _pluginNameOrAlias, info, dlHandle, true))
         return PluginPtr();
 
-       PluginPtrType ptr(this->PrivateGetInfo(resolvedName),
-                         this->PrivateGetPluginDlHandlePtr(resolvedName));
+      return this->PrivateInstantiate<PluginPtrType>(info, dlHandle, nullptr);
+    }
+
+    template <typename PluginPtrType>
+    PluginPtrType Loader::Instantiate(
+        std::string_view _pluginNameOrAlias,
+        std::pmr::memory_resource *_resource) const
+    {
+      detail::TraceScope trace("Instantiate", _pluginNameOrAlias);
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _pluginNameOrAlias, info, dlHandle, true))
+        return PluginPtr();
+
+      return this->PrivateInstantiate<PluginPtrType>(
+            info, dlHandle, _resource);
+    }
+
+    template <typename PluginPtrType>
+    std::size_t Loader::Instantiate(
+        std::string_view _pluginNameOrAlias,
+        const std::size_t _count,
+        std::vector<PluginPtrType> &_plugins,
+        std::pmr::memory_resource *_resource) const
+    {
+      detail::TraceScope trace("Instantiate", _pluginNameOrAlias);
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _pluginNameOrAlias, info, dlHandle, true))
+        return 0;
+
+      _plugins.reserve(_plugins.size() + _count);
+      for (std::size_t i = 0; i < _count; ++i)
+      {
+        _plugins.push_back(this->PrivateInstantiate<PluginPtrType>(
+              info, dlHandle, _resource));
+      }
+
+      return _count;
+    }
+
+    template <typename... Args>
+    PluginPtr Loader::InstantiateWith(
+        std::string_view _pluginNameOrAlias, Args... _args) const
+    {
+      std::tuple<Args&&...> arguments(std::forward<Args>(_args)...);
+      return this->PrivateInstantiateWith(
+            _pluginNameOrAlias, typeid(void(Args...)).name(), &arguments);
+    }
+
+    template <typename Table>
+    std::shared_ptr<const Table> Loader::QueryKernelTable(
+        std::string_view _pluginNameOrAlias) const
+    {
+      return std::static_pointer_cast<const Table>(
+            this->PrivateQueryKernelTable(
+              _pluginNameOrAlias, typeid(Table).name(), Table::kAbiVersion));
+    }
+
+    template <typename PluginPtrType>
+    Loader::LookupStatus Loader::TryInstantiate(
+        std::string_view _pluginNameOrAlias,
+        PluginPtrType &_plugin) const
+    {
+      detail::TraceScope trace("Instantiate", _pluginNameOrAlias);
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      const LookupStatus status = this->PrivateGetInfoAndDlHandle(
+            _pluginNameOrAlias, info, dlHandle, false);
+      if (LookupStatus::FOUND != status)
+        return status;
+
+      _plugin = this->PrivateInstantiate<PluginPtrType>(
+            info, dlHandle, nullptr);
+      return status;
+    }
+
+    template <typename PluginPtrType>
+    PluginPtrType Loader::PrivateInstantiate(
+        const ConstInfoPtr &_info,
+        const std::shared_ptr<void> &_dlHandle,
+        std::pmr::memory_resource *_resource) const
+    {
+      if constexpr (detail::TypedPluginPtrTraits<PluginPtrType>::isTyped)
+      {
+        // Fail before anything gets constructed, so that a plugin which is
+        // missing an interface does not pay for an instance that would be
+        // thrown away.
+        const auto &names =
+            detail::TypedPluginPtrTraits<PluginPtrType>::interfaceNames;
+        if (!this->PrivateProvidesInterfaces(
+              _info, names, std::size(names)))
+          return PluginPtrType();
+
+        return PluginPtrType(
+              this->PrivateInstantiate<PluginPtr>(_info, _dlHandle, _resource));
+      }
+      else
+      {
+        const void *table = nullptr;
+        std::shared_ptr<void> pooled;
+        if (!_resource)
+          pooled = this->PrivateCheckOutPooled(_info, _dlHandle, table);
+
+        std::pmr::memory_resource *const account =
+            this->PrivateAllocationAccount(_dlHandle);
+
+        if (pooled)
+        {
+          // The pooled instance already has its interfaces looked up, so the
+          // new PluginPtr only needs to share them.
+          PluginPtrType ptr;
+          ptr.PrivateUniqueWrapper().PrivateCopyPluginInstance(
+                _info, pooled, table);
+
+          if (auto *enableFromThis = ptr->PrivateGetEnablePluginFromThis())
+          {
+            enableFromThis->PrivateSetPluginFromThis(ptr);
+            enableFromThis->PrivateSetMemoryResource(account);
+          }
+
+          return ptr;
+        }
+
+        PluginPtrType ptr(_info, _dlHandle, _resource ? _resource : account);
 
-       if (auto *enableFromThis =
-              ptr->template QueryInterface<EnablePluginFromThis>())
-         enableFromThis->PrivateSetPluginFromThis(ptr);
+        if (auto *enableFromThis = ptr->PrivateGetEnablePluginFromThis())
+        {
+          enableFromThis->PrivateSetPluginFromThis(ptr);
+          enableFromThis->PrivateSetMemoryResource(account);
+        }
 
-       return ptr;
+        return ptr;
+      }
     }
 
     template <typename InterfaceType>
     std::shared_ptr<InterfaceType> Loader::Factory(
-        const std::string &_pluginNameOrAlias) const
+        std::string_view _pluginNameOrAlias) const
     {
-      return this->Instantiate(_pluginNameOrAlias)
+      return this->PrivateFactoryInstance(_pluginNameOrAlias)
           ->template QueryInterfaceSharedPtr<InterfaceType>();
     }
   }
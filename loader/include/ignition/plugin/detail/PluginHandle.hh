@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_DETAIL_PLUGINHANDLE_HH_
+#define IGNITION_PLUGIN_DETAIL_PLUGINHANDLE_HH_
+
+#include <iterator>
+#include <memory>
+#include <ignition/plugin/PluginHandle.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    template <typename PluginPtrType>
+    PluginPtrType PluginHandle::Instantiate(
+        std::pmr::memory_resource *_resource) const
+    {
+      if (!this->info)
+        return PluginPtrType();
+
+      if constexpr (detail::TypedPluginPtrTraits<PluginPtrType>::isTyped)
+      {
+        const auto &names =
+            detail::TypedPluginPtrTraits<PluginPtrType>::interfaceNames;
+        if (!this->PrivateProvidesInterfaces(names, std::size(names)))
+          return PluginPtrType();
+      }
+
+      return PluginPtrType(this->PrivateInstantiate(_resource));
+    }
+
+    template <typename InterfaceType>
+    std::shared_ptr<InterfaceType> PluginHandle::Factory() const
+    {
+      return this->Instantiate()
+          ->template QueryInterfaceSharedPtr<InterfaceType>();
+    }
+  }
+}
+
+#endif
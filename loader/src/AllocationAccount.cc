@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "AllocationAccount.hh"
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    std::uint64_t AllocationAccount::Allocations() const
+    {
+      return this->allocations.load(std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+    std::uint64_t AllocationAccount::AllocatedBytes() const
+    {
+      return this->allocatedBytes.load(std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+    std::uint64_t AllocationAccount::LiveBytes() const
+    {
+      // The bytes are freed after they were allocated, so reading the freed
+      // bytes first keeps the difference from going below zero.
+      const std::uint64_t freed =
+          this->freedBytes.load(std::memory_order_relaxed);
+      const std::uint64_t allocated =
+          this->allocatedBytes.load(std::memory_order_relaxed);
+      return allocated > freed ? allocated - freed : 0;
+    }
+
+    /////////////////////////////////////////////////
+    void *AllocationAccount::do_allocate(
+        const std::size_t _bytes, const std::size_t _alignment)
+    {
+      void *const p =
+          std::pmr::new_delete_resource()->allocate(_bytes, _alignment);
+      this->allocations.fetch_add(1, std::memory_order_relaxed);
+      this->allocatedBytes.fetch_add(_bytes, std::memory_order_relaxed);
+      return p;
+    }
+
+    /////////////////////////////////////////////////
+    void AllocationAccount::do_deallocate(
+        void *_p, const std::size_t _bytes, const std::size_t _alignment)
+    {
+      std::pmr::new_delete_resource()->deallocate(_p, _bytes, _alignment);
+      this->freedBytes.fetch_add(_bytes, std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+    bool AllocationAccount::do_is_equal(
+        const std::pmr::memory_resource &_other) const noexcept
+    {
+      return this == &_other;
+    }
+
+    /////////////////////////////////////////////////
+    AllocationAccounts &AllocationAccounts::Get()
+    {
+      static AllocationAccounts *accounts = new AllocationAccounts;
+      return *accounts;
+    }
+
+    /////////////////////////////////////////////////
+    AllocationAccount &AllocationAccounts::For(const std::string &_path)
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      std::unique_ptr<AllocationAccount> &account = this->accounts[_path];
+      if (!account)
+        account = std::make_unique<AllocationAccount>();
+
+      return *account;
+    }
+
+    /////////////////////////////////////////////////
+    const AllocationAccount *AllocationAccounts::Find(const std::string &_path)
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      const auto it = this->accounts.find(_path);
+      return this->accounts.end() == it ? nullptr : it->second.get();
+    }
+  }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_SRC_ALLOCATIONACCOUNT_HH_
+#define IGNITION_PLUGIN_SRC_ALLOCATIONACCOUNT_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief A memory resource which counts the memory that is allocated
+    /// on behalf of one plugin library, and gets it from the default heap.
+    /// The counters use relaxed atomic operations, so they are cheap to keep
+    /// but only consistent with each other once the allocations have
+    /// settled.
+    class AllocationAccount : public std::pmr::memory_resource
+    {
+      /// \brief The number of allocations so far
+      /// \return The number of allocations
+      public: std::uint64_t Allocations() const;
+
+      /// \brief The number of bytes that have been allocated so far,
+      /// including the ones which have been freed since
+      /// \return The number of bytes
+      public: std::uint64_t AllocatedBytes() const;
+
+      /// \brief The number of bytes that are currently allocated
+      /// \return The number of bytes
+      public: std::uint64_t LiveBytes() const;
+
+      // Documentation inherited
+      private: void *do_allocate(
+          std::size_t _bytes, std::size_t _alignment) override;
+
+      // Documentation inherited
+      private: void do_deallocate(
+          void *_p, std::size_t _bytes, std::size_t _alignment) override;
+
+      // Documentation inherited
+      private: bool do_is_equal(
+          const std::pmr::memory_resource &_other) const noexcept override;
+
+      /// \brief The number of allocations
+      private: std::atomic<std::uint64_t> allocations{0};
+
+      /// \brief The number of bytes that have been allocated
+      private: std::atomic<std::uint64_t> allocatedBytes{0};
+
+      /// \brief The number of bytes that have been freed
+      private: std::atomic<std::uint64_t> freedBytes{0};
+    };
+
+    /// \brief The allocation accounts of the libraries of this process, keyed
+    /// by the canonical paths of the libraries. An account is never
+    /// destroyed, because the memory that it has handed out may be freed at
+    /// any time, even after its library has been closed. So a library which
+    /// is closed and opened again keeps adding to the same account.
+    ///
+    /// This class is thread-safe.
+    class AllocationAccounts
+    {
+      /// \brief Get the accounts of this process. They are never destroyed.
+      /// \return The accounts
+      public: static AllocationAccounts &Get();
+
+      /// \brief Get the account of a library, creating it if needed
+      /// \param[in] _path The canonical path of the library
+      /// \return The account
+      public: AllocationAccount &For(const std::string &_path);
+
+      /// \brief Get the account of a library, if it has one
+      /// \param[in] _path The canonical path of the library
+      /// \return The account, or nullptr if the library has none
+      public: const AllocationAccount *Find(const std::string &_path);
+
+      /// \brief Guards `accounts`
+      private: std::mutex mutex;
+
+      /// \brief The accounts, by the paths of their libraries
+      private: std::unordered_map<std::string,
+                                  std::unique_ptr<AllocationAccount>> accounts;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#if defined(__ELF__) && __has_include(<elf.h>)
+  #define IGN_PLUGIN_HAVE_ELF_READER
+  #include <elf.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "BuildId.hh"
+
+#ifdef IGN_PLUGIN_HAVE_ELF_READER
+namespace
+{
+  /// \brief The largest note segment that is worth reading. Build-ids are
+  /// tens of bytes, and the notes of a library rarely add up to more than a
+  /// few hundred.
+  constexpr std::size_t kMaxNoteSize = 1u << 16;
+
+  /////////////////////////////////////////////////
+  /// \brief The ELF types of 32-bit files
+  struct Elf32
+  {
+    using Ehdr = Elf32_Ehdr;
+    using Phdr = Elf32_Phdr;
+    using Nhdr = Elf32_Nhdr;
+    static constexpr unsigned char fileClass = ELFCLASS32;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief The ELF types of 64-bit files
+  struct Elf64
+  {
+    using Ehdr = Elf64_Ehdr;
+    using Phdr = Elf64_Phdr;
+    using Nhdr = Elf64_Nhdr;
+    static constexpr unsigned char fileClass = ELFCLASS64;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Read bytes at an offset of a file
+  /// \param[in] _fd The file
+  /// \param[in] _offset The offset to read at
+  /// \param[out] _data Receives the bytes
+  /// \param[in] _size The number of bytes to read
+  /// \return True if all of the bytes were read
+  bool ReadAt(const int _fd, const std::size_t _offset,
+              void *_data, const std::size_t _size)
+  {
+    std::size_t done = 0;
+    while (done < _size)
+    {
+      const ssize_t count = ::pread(_fd, static_cast<char*>(_data) + done,
+                                    _size - done,
+                                    static_cast<off_t>(_offset + done));
+      if (count <= 0)
+        return false;
+
+      done += static_cast<std::size_t>(count);
+    }
+
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Find the build-id among the notes of a note segment
+  /// \param[in] _notes The contents of the segment
+  /// \param[in] _alignment The alignment of the notes in the segment
+  /// \return The build-id in hexadecimal, or an empty string
+  template <typename Elf>
+  std::string FindBuildId(const std::vector<unsigned char> &_notes,
+                          const std::size_t _alignment)
+  {
+    const auto align = [&](const std::size_t _size)
+    {
+      return (_size + _alignment - 1) & ~(_alignment - 1);
+    };
+
+    std::size_t pos = 0;
+    while (pos + sizeof(typename Elf::Nhdr) <= _notes.size())
+    {
+      typename Elf::Nhdr nhdr;
+      std::memcpy(&nhdr, _notes.data() + pos, sizeof(nhdr));
+      pos += sizeof(nhdr);
+
+      const std::size_t nameSize = align(nhdr.n_namesz);
+      const std::size_t descSize = align(nhdr.n_descsz);
+      if (nameSize > _notes.size() - pos ||
+          descSize > _notes.size() - pos - nameSize)
+        break;
+
+      if (NT_GNU_BUILD_ID == nhdr.n_type && sizeof(ELF_NOTE_GNU) ==
+          nhdr.n_namesz && 0 == std::memcmp(
+            _notes.data() + pos, ELF_NOTE_GNU, sizeof(ELF_NOTE_GNU)))
+      {
+        static const char digits[] = "0123456789abcdef";
+        const unsigned char *desc = _notes.data() + pos + nameSize;
+
+        std::string buildId;
+        buildId.reserve(2 * nhdr.n_descsz);
+        for (std::size_t i = 0; i < nhdr.n_descsz; ++i)
+        {
+          buildId.push_back(digits[desc[i] >> 4]);
+          buildId.push_back(digits[desc[i] & 0xf]);
+        }
+
+        return buildId;
+      }
+
+      pos += nameSize + descSize;
+    }
+
+    return std::string();
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Find the build-id in the note segments of an ELF file
+  /// \param[in] _fd The file
+  /// \return The build-id in hexadecimal, or an empty string
+  template <typename Elf>
+  std::string ReadNotes(const int _fd)
+  {
+    typename Elf::Ehdr ehdr;
+    if (!ReadAt(_fd, 0, &ehdr, sizeof(ehdr)) ||
+        ehdr.e_phentsize != sizeof(typename Elf::Phdr) || 0 == ehdr.e_phoff)
+      return std::string();
+
+    std::vector<typename Elf::Phdr> phdrs(ehdr.e_phnum);
+    if (!ReadAt(_fd, ehdr.e_phoff, phdrs.data(),
+                phdrs.size() * sizeof(typename Elf::Phdr)))
+      return std::string();
+
+    std::vector<unsigned char> notes;
+    for (const typename Elf::Phdr &phdr : phdrs)
+    {
+      if (PT_NOTE != phdr.p_type || phdr.p_filesz > kMaxNoteSize)
+        continue;
+
+      notes.resize(phdr.p_filesz);
+      if (!ReadAt(_fd, phdr.p_offset, notes.data(), notes.size()))
+        continue;
+
+      // Notes are padded to 4 bytes, unless their segment asks for 8
+      std::string buildId =
+          FindBuildId<Elf>(notes, 8 == phdr.p_align ? 8 : 4);
+      if (!buildId.empty())
+        return buildId;
+    }
+
+    return std::string();
+  }
+}
+#endif
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    std::string ReadBuildId(const std::string &_pathToLibrary)
+    {
+#ifdef IGN_PLUGIN_HAVE_ELF_READER
+      const int fd = ::open(_pathToLibrary.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+        return std::string();
+
+      unsigned char ident[EI_NIDENT];
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      const unsigned char nativeData = ELFDATA2LSB;
+#else
+      const unsigned char nativeData = ELFDATA2MSB;
+#endif
+
+      std::string buildId;
+      if (ReadAt(fd, 0, ident, sizeof(ident)) &&
+          0 == std::memcmp(ident, ELFMAG, SELFMAG) &&
+          nativeData == ident[EI_DATA])
+      {
+        if (Elf64::fileClass == ident[EI_CLASS])
+          buildId = ReadNotes<Elf64>(fd);
+        else if (Elf32::fileClass == ident[EI_CLASS])
+          buildId = ReadNotes<Elf32>(fd);
+      }
+
+      ::close(fd);
+      return buildId;
+#else
+      (void)_pathToLibrary;
+      return std::string();
+#endif
+    }
+  }
+}
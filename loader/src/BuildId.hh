@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+#ifndef IGNITION_PLUGIN_SRC_BUILDID_HH_
+#define IGNITION_PLUGIN_SRC_BUILDID_HH_
+
+#include <string>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Read the build-id that the linker recorded in a library, i.e.
+    /// the GNU build-id note of an ELF file. Two library files with the same
+    /// build-id were produced by the same build, so the build-id identifies
+    /// the contents of a library no matter where it is installed or when its
+    /// file was last modified. Only the headers and the notes of the file get
+    /// read; the library is not opened.
+    /// \param[in] _pathToLibrary Path to the library
+    /// \return The build-id as a string of lower case hexadecimal digits, or
+    /// an empty string if the file is not an ELF file of the native byte
+    /// order or does not have a build-id.
+    std::string ReadBuildId(const std::string &_pathToLibrary);
+  }
+}
+
+#endif
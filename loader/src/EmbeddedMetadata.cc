@@ -0,0 +1,444 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#if defined(__ELF__) && __has_include(<elf.h>)
+  #define IGN_PLUGIN_HAVE_ELF_READER
+  #include <elf.h>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <ignition/plugin/Descriptor.hh>
+#include <ignition/plugin/EnablePluginFromThis.hh>
+#include <ignition/plugin/utility.hh>
+
+#include "EmbeddedMetadata.hh"
+
+namespace
+{
+  using ignition::plugin::ManifestPlugin;
+
+  /// \brief The plugins which have been described so far, keyed by their
+  /// demangled names
+  using PluginMap = std::map<std::string, ManifestPlugin>;
+
+  /////////////////////////////////////////////////
+  /// \brief Check whether a character may appear in an identifier
+  bool IsIdentifierChar(const char _c)
+  {
+    return ('a' <= _c && _c <= 'z') || ('A' <= _c && _c <= 'Z') ||
+        ('0' <= _c && _c <= '9') || '_' == _c;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief A metadata record which has been parsed
+  struct Record
+  {
+    /// \brief The METADATA_* flags of the record
+    unsigned char flags = 0;
+
+    /// \brief The tag and the text of each entry of the record
+    std::vector<std::pair<char, std::string_view>> entries;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Parse the records in the contents of a metadata section.
+  /// \param[in] _data The contents of the section. The entries of the
+  /// records refer to it.
+  /// \param[in] _size The size of the section
+  /// \param[out] _records Receives the records
+  /// \return True if every record is valid
+  bool ParseRecords(const char *_data, const std::size_t _size,
+                    std::vector<Record> &_records)
+  {
+    using namespace ignition::plugin;
+
+    std::size_t pos = 0;
+    while (pos + METADATA_HEADER_SIZE <= _size)
+    {
+      // The linker may leave zero padding between the records of different
+      // translation units, but every record is aligned to 8 bytes.
+      if (0 != std::memcmp(_data + pos, METADATA_MAGIC, 4))
+      {
+        pos += 8;
+        continue;
+      }
+
+      const unsigned char *header =
+          reinterpret_cast<const unsigned char*>(_data + pos);
+      std::size_t recordSize = 0;
+      for (std::size_t i = 0; i < 4; ++i)
+        recordSize |= static_cast<std::size_t>(header[4 + i]) << (8 * i);
+
+      if (recordSize <= METADATA_HEADER_SIZE || recordSize % 8 != 0 ||
+          recordSize > _size - pos || METADATA_API_VERSION != header[8])
+        return false;
+
+      Record record;
+      record.flags = header[9];
+
+      const char *entry = _data + pos + METADATA_HEADER_SIZE;
+      const char * const end = _data + pos + recordSize;
+      while (entry < end && '\0' != *entry)
+      {
+        const char tag = *entry++;
+        const char *terminator =
+            static_cast<const char*>(std::memchr(entry, '\0', end - entry));
+        if (!terminator)
+          return false;
+
+        record.entries.emplace_back(
+              tag, std::string_view(entry, terminator - entry));
+        entry = terminator + 1;
+      }
+
+      // The plugin always comes first
+      if (record.entries.empty() || 'P' != record.entries.front().first)
+        return false;
+
+      _records.push_back(std::move(record));
+      pos += recordSize;
+    }
+
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Describe the plugins of a library with its metadata records.
+  /// \param[in] _records The records of the library
+  /// \param[out] _plugins Receives the plugins that the records describe
+  /// \return True if the records describe the plugins completely
+  bool DescribePlugins(const std::vector<Record> &_records,
+                       PluginMap &_plugins)
+  {
+    using namespace ignition::plugin;
+
+    const std::string epftName = typeid(EnablePluginFromThis).name();
+
+    for (const Record &record : _records)
+    {
+      if (record.flags & METADATA_INCOMPLETE)
+        return false;
+
+      const std::string_view name = record.entries.front().second;
+      if (MangleClassName(name).empty())
+        return false;
+
+      ManifestPlugin &plugin = _plugins[std::string(name)];
+      plugin.name = name;
+
+      for (std::size_t i = 1; i < record.entries.size(); ++i)
+      {
+        const char tag = record.entries[i].first;
+        const std::string_view text = record.entries[i].second;
+        if ('I' == tag)
+        {
+          const std::string mangled = MangleClassName(text);
+          if (mangled.empty())
+            return false;
+
+          plugin.interfaces.insert(mangled);
+          plugin.demangledInterfaces.insert(std::string(text));
+        }
+        else if ('A' == tag)
+        {
+          plugin.aliases.insert(std::string(text));
+        }
+
+        // Entries with other tags were added by a newer version of the
+        // layout which did not need to change METADATA_API_VERSION, so we
+        // can skip them.
+      }
+
+      if (record.flags & METADATA_ENABLE_PLUGIN_FROM_THIS)
+      {
+        plugin.interfaces.insert(epftName);
+        plugin.demangledInterfaces.insert(CachedDemangleSymbol(epftName));
+      }
+    }
+
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Parse the contents of a metadata section and describe the
+  /// plugins of the library with it.
+  /// \param[in] _data The contents of the section
+  /// \param[in] _size The size of the section
+  /// \param[out] _plugins Receives the plugins that the records describe
+  /// \return True if the records are valid and describe the plugins
+  /// completely
+  bool ParseSection(const char *_data, const std::size_t _size,
+                    PluginMap &_plugins)
+  {
+    std::vector<Record> records;
+    return ParseRecords(_data, _size, records) &&
+        DescribePlugins(records, _plugins);
+  }
+
+#ifdef IGN_PLUGIN_HAVE_ELF_READER
+  /////////////////////////////////////////////////
+  /// \brief The ELF types of 32-bit files
+  struct Elf32
+  {
+    using Ehdr = Elf32_Ehdr;
+    using Shdr = Elf32_Shdr;
+    static constexpr unsigned char fileClass = ELFCLASS32;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief The ELF types of 64-bit files
+  struct Elf64
+  {
+    using Ehdr = Elf64_Ehdr;
+    using Shdr = Elf64_Shdr;
+    static constexpr unsigned char fileClass = ELFCLASS64;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Find the metadata section in the image of an ELF file
+  /// \param[in] _image The contents of the file
+  /// \param[in] _size The size of the file
+  /// \param[out] _plugins Receives the plugins that the section describes
+  /// \return True if the section was found and parsed successfully
+  template <typename Elf>
+  bool ReadSection(const char *_image, const std::size_t _size,
+                   PluginMap &_plugins)
+  {
+    if (_size < sizeof(typename Elf::Ehdr))
+      return false;
+
+    typename Elf::Ehdr ehdr;
+    std::memcpy(&ehdr, _image, sizeof(ehdr));
+
+    if (ehdr.e_shentsize != sizeof(typename Elf::Shdr) ||
+        ehdr.e_shoff == 0 || ehdr.e_shoff > _size)
+      return false;
+
+    const auto section = [&](const std::size_t _index,
+                             typename Elf::Shdr &_shdr)
+    {
+      const std::size_t offset =
+          ehdr.e_shoff + _index * sizeof(typename Elf::Shdr);
+      if (offset + sizeof(_shdr) > _size)
+        return false;
+
+      std::memcpy(&_shdr, _image + offset, sizeof(_shdr));
+      return true;
+    };
+
+    // Files with many sections keep their real counts in the first section
+    // header.
+    typename Elf::Shdr first;
+    if (!section(0, first))
+      return false;
+
+    const std::size_t count = ehdr.e_shnum ? ehdr.e_shnum : first.sh_size;
+    const std::size_t namesIndex =
+        SHN_XINDEX == ehdr.e_shstrndx ? first.sh_link : ehdr.e_shstrndx;
+
+    typename Elf::Shdr names;
+    if (namesIndex >= count || !section(namesIndex, names) ||
+        names.sh_offset > _size || names.sh_size > _size - names.sh_offset)
+      return false;
+
+    const std::string_view wanted = ignition::plugin::METADATA_SECTION;
+    for (std::size_t i = 1; i < count; ++i)
+    {
+      typename Elf::Shdr shdr;
+      if (!section(i, shdr))
+        return false;
+
+      if (SHT_PROGBITS != shdr.sh_type || shdr.sh_name >= names.sh_size)
+        continue;
+
+      const char *name = _image + names.sh_offset + shdr.sh_name;
+      if (std::string_view(name, ::strnlen(
+            name, names.sh_size - shdr.sh_name)) != wanted)
+        continue;
+
+      if (shdr.sh_offset > _size || shdr.sh_size > _size - shdr.sh_offset)
+        return false;
+
+      return ParseSection(_image + shdr.sh_offset, shdr.sh_size, _plugins);
+    }
+
+    // The library was built without metadata
+    return false;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Read the metadata section of an ELF file
+  /// \param[in] _pathToLibrary Path to the file
+  /// \param[out] _plugins Receives the plugins that the section describes
+  /// \return True if the section was found and parsed successfully
+  bool ReadElf(const std::string &_pathToLibrary, PluginMap &_plugins)
+  {
+    const int fd = ::open(_pathToLibrary.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < EI_NIDENT)
+    {
+      ::close(fd);
+      return false;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(info.st_size);
+    void *image = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == image)
+      return false;
+
+    const unsigned char *ident = static_cast<const unsigned char*>(image);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const unsigned char nativeData = ELFDATA2LSB;
+#else
+    const unsigned char nativeData = ELFDATA2MSB;
+#endif
+
+    bool success = false;
+    if (0 == std::memcmp(ident, ELFMAG, SELFMAG) &&
+        nativeData == ident[EI_DATA])
+    {
+      const char *data = static_cast<const char*>(image);
+      if (Elf64::fileClass == ident[EI_CLASS])
+        success = ReadSection<Elf64>(data, size, _plugins);
+      else if (Elf32::fileClass == ident[EI_CLASS])
+        success = ReadSection<Elf32>(data, size, _plugins);
+    }
+
+    ::munmap(image, size);
+    return success;
+  }
+#endif
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    bool ReadEmbeddedMetadata(const std::string &_pathToLibrary,
+                              ManifestLibrary &_library)
+    {
+#ifdef IGN_PLUGIN_HAVE_ELF_READER
+      PluginMap plugins;
+      if (!ReadElf(_pathToLibrary, plugins) || plugins.empty())
+        return false;
+
+      if (!ManifestLibrary::Stat(_pathToLibrary, _library))
+        return false;
+
+      _library.plugins.clear();
+      for (auto &entry : plugins)
+        _library.plugins.push_back(std::move(entry.second));
+
+      return true;
+#else
+      (void)_pathToLibrary;
+      (void)_library;
+      return false;
+#endif
+    }
+
+    /////////////////////////////////////////////////
+    void CollectDemangledNames(const char *_data, const std::size_t _size,
+                               DemangledNameMap &_names)
+    {
+      std::vector<Record> records;
+      if (!ParseRecords(_data, _size, records))
+        return;
+
+      for (const Record &record : records)
+      {
+        if (record.flags & METADATA_ENABLE_PLUGIN_FROM_THIS)
+        {
+          static const std::string epftName =
+              typeid(EnablePluginFromThis).name();
+          _names.emplace(epftName, CachedDemangleSymbol(epftName));
+        }
+
+        for (const auto &entry : record.entries)
+        {
+          if ('P' != entry.first && 'I' != entry.first)
+            continue;
+
+          std::string mangled = MangleClassName(entry.second);
+          if (!mangled.empty())
+            _names.emplace(std::move(mangled), std::string(entry.second));
+        }
+      }
+    }
+
+    /////////////////////////////////////////////////
+    std::string MangleClassName(const std::string_view _demangled)
+    {
+      // Names in the std namespace have an abbreviated encoding which we do
+      // not bother with.
+      if (_demangled.empty() || 0 == _demangled.rfind("std::", 0))
+        return std::string();
+
+      std::string components;
+      std::size_t count = 0;
+      std::size_t begin = 0;
+      while (true)
+      {
+        std::size_t end = _demangled.find("::", begin);
+        if (std::string_view::npos == end)
+          end = _demangled.size();
+
+        const std::string_view identifier =
+            _demangled.substr(begin, end - begin);
+        if (identifier.empty() ||
+            ('0' <= identifier[0] && identifier[0] <= '9'))
+          return std::string();
+
+        for (const char c : identifier)
+        {
+          if (!IsIdentifierChar(c))
+            return std::string();
+        }
+
+        components += std::to_string(identifier.size());
+        components += identifier;
+        ++count;
+
+        if (end == _demangled.size())
+          break;
+
+        begin = end + 2;
+      }
+
+      // A class inside of a namespace or another class has a nested name
+      if (count > 1)
+        return "N" + components + "E";
+
+      return components;
+    }
+  }
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_SRC_EMBEDDEDMETADATA_HH_
+#define IGNITION_PLUGIN_SRC_EMBEDDEDMETADATA_HH_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Manifest.hh"
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Read the metadata records which the registration macros embed
+    /// in the METADATA_SECTION of a library (see METADATA_API_VERSION). The
+    /// library file is only mapped into memory and parsed; it does not get
+    /// opened, so none of its code runs.
+    ///
+    /// This only succeeds when the records describe everything that the
+    /// library provides. That is not the case if the library is not an ELF
+    /// file of the native byte order, if it has no metadata section, if any
+    /// of its plugins is registered by code that runs at load time (see
+    /// METADATA_INCOMPLETE), or if the name of a plugin or an interface is
+    /// not a plain class name whose mangled name can be derived from it
+    /// (see MangleClassName()).
+    /// \param[in] _pathToLibrary Path to the library
+    /// \param[out] _library Receives the description of the library
+    /// \return True if the library is fully described by its metadata
+    bool ReadEmbeddedMetadata(const std::string &_pathToLibrary,
+                              ManifestLibrary &_library);
+
+    /// \brief A map from mangled names to demangled names
+    using DemangledNameMap = std::unordered_map<std::string, std::string>;
+
+    /// \brief Collect the names that a set of metadata records spell out, so
+    /// that they do not need to be demangled at run time. Unlike
+    /// ReadEmbeddedMetadata(), this also uses the records of plugins which
+    /// are registered at load time, and it silently skips any name whose
+    /// mangled name cannot be derived (see MangleClassName()). The name of
+    /// EnablePluginFromThis is included when a record is flagged with
+    /// METADATA_ENABLE_PLUGIN_FROM_THIS.
+    /// \param[in] _data The contents of a metadata section
+    /// \param[in] _size The size of the section, in bytes
+    /// \param[in,out] _names Receives the demangled names, keyed by their
+    /// mangled names
+    void CollectDemangledNames(const char *_data, std::size_t _size,
+                               DemangledNameMap &_names);
+
+    /// \brief Get the mangled name that typeid(~).name() has for a class,
+    /// given its demangled name. This only supports names which consist of
+    /// identifiers separated by "::", i.e. classes which are not templates
+    /// and are not inside of an anonymous namespace or the std namespace.
+    /// \param[in] _demangled The demangled name, e.g. "ns::MyPlugin"
+    /// \return The mangled name, e.g. "N2ns8MyPluginE", or an empty string
+    /// if the name is not supported.
+    std::string MangleClassName(std::string_view _demangled);
+  }
+}
+
+#endif
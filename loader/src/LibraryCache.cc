@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <dlfcn.h>
+
+#include "LibraryCache.hh"
+#include "LibraryMappings.hh"
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    CachedLibrary::CachedLibrary(void *_dlHandle, CloseFunction _close)
+      : dlHandle(_dlHandle),
+        close(_close)
+    {
+      // Do nothing
+    }
+
+    /////////////////////////////////////////////////
+    CachedLibrary::~CachedLibrary()
+    {
+      LibraryCache::Get().Release(this->dlHandle);
+
+      // The Info of the plugins points into the library, so it is dropped
+      // before the library is closed. Closing the library may run the
+      // destructors of its static objects, which may release other
+      // libraries, so this happens without holding the lock of the cache.
+      this->plugins.clear();
+      this->close(this->dlHandle);
+    }
+
+    /////////////////////////////////////////////////
+    void *CachedLibrary::DlHandle() const
+    {
+      return this->dlHandle;
+    }
+
+    /////////////////////////////////////////////////
+    const std::vector<std::shared_ptr<Info>> &CachedLibrary::Plugins(
+        const DescribeFunction &_describe)
+    {
+      std::call_once(this->described, [&]()
+      {
+        this->plugins = _describe();
+      });
+
+      return this->plugins;
+    }
+
+    /////////////////////////////////////////////////
+    LibraryCache &LibraryCache::Get()
+    {
+      static LibraryCache *cache = new LibraryCache;
+      return *cache;
+    }
+
+    /////////////////////////////////////////////////
+    std::shared_ptr<CachedLibrary> LibraryCache::Acquire(
+        void *_dlHandle, CachedLibrary::CloseFunction _close)
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      std::weak_ptr<CachedLibrary> &entry = this->libraries[_dlHandle];
+
+      if (std::shared_ptr<CachedLibrary> library = entry.lock())
+      {
+        // The functions dlopen and dlclose keep their own counter for each
+        // library, which is unloaded once dlclose has been called as many
+        // times as dlopen. The cached library already holds a reference, and
+        // it calls dlclose once when it is destroyed, so the reference that
+        // the caller has just made with dlopen is undone here.
+        dlclose(_dlHandle);
+        return library;
+      }
+
+      // If the library was in the cache before but has expired, its
+      // destructor is about to remove the entry. Release() leaves the entry
+      // alone once it has been replaced here.
+      std::shared_ptr<CachedLibrary> library =
+          std::make_shared<CachedLibrary>(_dlHandle, _close);
+      entry = library;
+      lock.unlock();
+
+      LibraryMappings::Get().Mapped(_dlHandle);
+      return library;
+    }
+
+    /////////////////////////////////////////////////
+    void LibraryCache::Release(void *_dlHandle)
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      const auto it = this->libraries.find(_dlHandle);
+      if (this->libraries.end() != it && it->second.expired())
+        this->libraries.erase(it);
+    }
+  }
+}
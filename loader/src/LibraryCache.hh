@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_SRC_LIBRARYCACHE_HH_
+#define IGNITION_PLUGIN_SRC_LIBRARYCACHE_HH_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/plugin/Info.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief A library which has been opened with dlopen, together with the
+    /// Info of the plugins that it provides. Every Loader which loads the
+    /// library shares the same object, so the library is only inspected and
+    /// its names are only demangled once, no matter how many Loaders use it.
+    /// The library is closed once the last reference to this object is gone.
+    class CachedLibrary
+    {
+      /// \brief A function which closes a library, given its dl handle
+      public: using CloseFunction = void (*)(void *);
+
+      /// \brief A function which extracts and demangles the Info of the
+      /// plugins of a library
+      public: using DescribeFunction =
+          std::function<std::vector<std::shared_ptr<Info>>()>;
+
+      /// \brief Constructor
+      /// \param[in] _dlHandle The dl handle of the library
+      /// \param[in] _close The function which closes the library
+      public: CachedLibrary(void *_dlHandle, CloseFunction _close);
+
+      /// \brief Destructor. This removes the library from the LibraryCache
+      /// and closes it.
+      public: ~CachedLibrary();
+
+      public: CachedLibrary(const CachedLibrary &) = delete;
+      public: CachedLibrary &operator=(const CachedLibrary &) = delete;
+
+      /// \brief Get the dl handle of the library
+      /// \return The dl handle
+      public: void *DlHandle() const;
+
+      /// \brief Get the Info of the plugins of the library. The first call
+      /// describes the library with _describe; every later call, from any
+      /// Loader, gets the same Info. The Info must not be modified.
+      /// \param[in] _describe The function which describes the library
+      /// \return The Info of the plugins of the library
+      public: const std::vector<std::shared_ptr<Info>> &Plugins(
+          const DescribeFunction &_describe);
+
+      /// \brief The dl handle of the library
+      private: void *const dlHandle;
+
+      /// \brief The function which closes the library
+      private: const CloseFunction close;
+
+      /// \brief Makes sure that the library is described exactly once
+      private: std::once_flag described;
+
+      /// \brief The Info of the plugins of the library
+      private: std::vector<std::shared_ptr<Info>> plugins;
+    };
+
+    /// \brief The libraries which are open in this process, keyed by their
+    /// dl handles. The cache only refers to the libraries weakly: each Loader
+    /// keeps its own references to the libraries that it has loaded, and a
+    /// library leaves the cache once no Loader nor plugin instance needs it.
+    ///
+    /// This class is thread-safe.
+    class LibraryCache
+    {
+      /// \brief Get the cache of this process. It is never destroyed, so that
+      /// libraries can still be released while the program exits.
+      /// \return The cache
+      public: static LibraryCache &Get();
+
+      /// \brief Get the library of a dl handle which dlopen has just returned.
+      /// If the library is already in the cache, the reference which that
+      /// dlopen added is given back right away, so that the library only
+      /// needs to be closed once.
+      /// \param[in] _dlHandle The dl handle
+      /// \param[in] _close The function which closes the library, if the
+      /// library is not in the cache yet. Otherwise, the library keeps the
+      /// function that it was first opened with.
+      /// \return The library
+      public: std::shared_ptr<CachedLibrary> Acquire(
+          void *_dlHandle, CachedLibrary::CloseFunction _close);
+
+      /// \brief Remove a library from the cache, unless the dl handle has
+      /// been taken over by a newer entry in the meantime
+      /// \param[in] _dlHandle The dl handle of the library
+      private: void Release(void *_dlHandle);
+
+      /// \brief Guards `libraries`
+      private: std::mutex mutex;
+
+      /// \brief The libraries which are open
+      private: std::unordered_map<void*, std::weak_ptr<CachedLibrary>>
+          libraries;
+
+      friend class CachedLibrary;
+    };
+  }
+}
+
+#endif
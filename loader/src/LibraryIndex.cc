@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+
+#include "LibraryIndex.hh"
+
+namespace
+{
+#if defined(_WIN32)
+  const char kLibraryExtension[] = ".dll";
+#elif defined(__APPLE__)
+  const char kLibraryExtension[] = ".dylib";
+#else
+  const char kLibraryExtension[] = ".so";
+#endif
+
+  /////////////////////////////////////////////////
+  /// \brief Get the modification time of a directory
+  /// \param[in] _directory The directory
+  /// \return The modification time in the units of the file system clock, or
+  /// zero if it cannot be read
+  std::int64_t ModificationTime(const std::string &_directory)
+  {
+    std::error_code ec;
+    const auto time = std::filesystem::last_write_time(_directory, ec);
+    if (ec)
+      return 0;
+
+    return static_cast<std::int64_t>(time.time_since_epoch().count());
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    std::vector<std::string> ListLibraries(const std::string &_directory,
+                                           std::error_code &_ec)
+    {
+      std::vector<std::string> libraries;
+
+      for (std::filesystem::directory_iterator it(_directory, _ec), end;
+           !_ec && it != end; it.increment(_ec))
+      {
+        const std::filesystem::path &path = it->path();
+        std::error_code ec;
+        if (path.extension() == kLibraryExtension &&
+            std::filesystem::is_regular_file(path, ec))
+        {
+          libraries.push_back(path.string());
+        }
+      }
+
+      std::sort(libraries.begin(), libraries.end());
+      return libraries;
+    }
+
+    /////////////////////////////////////////////////
+    LibraryIndex::LibraryIndex()
+    {
+#ifdef __linux__
+      this->notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    /////////////////////////////////////////////////
+    LibraryIndex::~LibraryIndex()
+    {
+#ifdef __linux__
+      if (this->notify >= 0)
+        close(this->notify);
+#endif
+    }
+
+    /////////////////////////////////////////////////
+    bool LibraryIndex::AddDirectory(const std::string &_directory)
+    {
+      std::error_code ec;
+      const std::filesystem::path canonical =
+          std::filesystem::canonical(_directory, ec);
+      if (ec || !std::filesystem::is_directory(canonical, ec))
+        return false;
+
+      Directory directory;
+      directory.path = canonical.string();
+
+      for (const Directory &other : this->directories)
+      {
+        if (other.path == directory.path)
+          return false;
+      }
+
+      this->directories.push_back(std::move(directory));
+      this->Rebuild();
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    std::string LibraryIndex::Find(const std::string_view _name)
+    {
+      this->Refresh();
+
+      const auto it = this->names.find(_name);
+      if (this->names.end() == it)
+        return std::string();
+
+      return this->libraries[it->second];
+    }
+
+    /////////////////////////////////////////////////
+    std::vector<std::string> LibraryIndex::Libraries()
+    {
+      this->Refresh();
+      return this->libraries;
+    }
+
+    /////////////////////////////////////////////////
+    void LibraryIndex::Refresh()
+    {
+#ifdef __linux__
+      if (this->notify >= 0)
+      {
+        // We only need to know whether anything happened, so the events are
+        // drained without being inspected.
+        alignas(inotify_event) char events[4096];
+        while (read(this->notify, events, sizeof(events)) > 0)
+          this->stale = true;
+      }
+#endif
+
+      for (const Directory &directory : this->directories)
+      {
+        if (directory.watch < 0 &&
+            directory.modificationTime != ModificationTime(directory.path))
+        {
+          this->stale = true;
+        }
+      }
+
+      if (this->stale)
+        this->Rebuild();
+    }
+
+    /////////////////////////////////////////////////
+    void LibraryIndex::Rebuild()
+    {
+      this->names.clear();
+      this->libraries.clear();
+
+      for (Directory &directory : this->directories)
+      {
+        directory.modificationTime = ModificationTime(directory.path);
+
+#ifdef __linux__
+        // The directory is watched again every time, in case it has been
+        // replaced. This gives back the same watch if it has not. If the
+        // directory does not exist, its modification time is checked until
+        // it does.
+        if (this->notify >= 0)
+        {
+          directory.watch = inotify_add_watch(
+                this->notify, directory.path.c_str(),
+                IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+        }
+#endif
+
+        std::error_code ec;
+        std::vector<std::string> listed = ListLibraries(directory.path, ec);
+        this->libraries.insert(this->libraries.end(),
+                               std::make_move_iterator(listed.begin()),
+                               std::make_move_iterator(listed.end()));
+      }
+
+      // The keys view the paths, so they can only be created once every path
+      // is in place.
+      const std::size_t extensionSize = sizeof(kLibraryExtension) - 1;
+      for (std::size_t i = 0; i < this->libraries.size(); ++i)
+      {
+        std::string_view name = this->libraries[i];
+        const std::size_t slash = name.find_last_of("/\\");
+        if (std::string_view::npos != slash)
+          name.remove_prefix(slash + 1);
+
+        // Libraries which come earlier take precedence, so existing keys are
+        // never replaced.
+        this->names.emplace(name, i);
+
+        name.remove_suffix(extensionSize);
+        this->names.emplace(name, i);
+
+        if (name.size() > 3 && name.substr(0, 3) == "lib")
+          this->names.emplace(name.substr(3), i);
+      }
+
+      this->stale = false;
+    }
+  }
+}
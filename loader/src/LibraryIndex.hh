@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_SRC_LIBRARYINDEX_HH_
+#define IGNITION_PLUGIN_SRC_LIBRARYINDEX_HH_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief List the libraries in a directory, i.e. the regular files with
+    /// the file extension of shared libraries on this platform.
+    /// \param[in] _directory The directory
+    /// \param[out] _ec Receives the error if the directory cannot be read
+    /// \return The paths to the libraries, sorted so that they do not depend
+    /// on the order of the file system
+    std::vector<std::string> ListLibraries(const std::string &_directory,
+                                           std::error_code &_ec);
+
+    /// \brief An index of the libraries in a list of directories, which maps
+    /// the short names of the libraries to their paths.
+    ///
+    /// The directories are only listed when they are added and when they have
+    /// changed since they were last listed. On Linux, changes are reported
+    /// by inotify, so looking up a name does not touch the file system at all
+    /// until something changes. Elsewhere, and whenever inotify cannot be
+    /// used, the modification time of each directory is checked instead.
+    ///
+    /// This class is not synchronized.
+    class LibraryIndex
+    {
+      /// \brief Constructor
+      public: LibraryIndex();
+
+      /// \brief Destructor
+      public: ~LibraryIndex();
+
+      public: LibraryIndex(const LibraryIndex &) = delete;
+      public: LibraryIndex &operator=(const LibraryIndex &) = delete;
+
+      /// \brief Add a directory to the end of the list. Libraries in the
+      /// directories which were added earlier take precedence.
+      /// \param[in] _directory The directory
+      /// \return True if the directory was added, false if it does not exist
+      /// or was already in the list
+      public: bool AddDirectory(const std::string &_directory);
+
+      /// \brief Find a library. The name can be the file name of the library
+      /// (e.g. "libMyPlugins.so"), the file name without its extension
+      /// ("libMyPlugins"), or the file name without its extension and the
+      /// "lib" prefix ("MyPlugins").
+      /// \param[in] _name The name of the library
+      /// \return The path to the library, or an empty string if none of the
+      /// directories contains a library with that name
+      public: std::string Find(std::string_view _name);
+
+      /// \brief Get the paths of every library in the directories, in the
+      /// order of the directories and sorted within each directory
+      /// \return The paths to the libraries
+      public: std::vector<std::string> Libraries();
+
+      /// \brief List the directories again if any of them has changed
+      private: void Refresh();
+
+      /// \brief List the directories and rebuild `names`
+      private: void Rebuild();
+
+      /// \brief A directory in the list
+      private: struct Directory
+      {
+        /// \brief The path to the directory
+        std::string path;
+
+        /// \brief The modification time of the directory when it was last
+        /// listed, in the units of the file system clock
+        std::int64_t modificationTime = 0;
+
+        /// \brief The inotify watch of the directory, or -1 if it is not
+        /// watched
+        int watch = -1;
+      };
+
+      /// \brief The directories, in the order of precedence
+      private: std::vector<Directory> directories;
+
+      /// \brief The paths of the libraries in the directories
+      private: std::vector<std::string> libraries;
+
+      /// \brief A map from the short names of the libraries to their index in
+      /// `libraries`. The keys view the strings in `libraries`.
+      private: std::unordered_map<std::string_view, std::size_t> names;
+
+      /// \brief The inotify instance, or -1 if inotify is not available
+      private: int notify = -1;
+
+      /// \brief True if the directories need to be listed again
+      private: bool stale = false;
+    };
+  }
+}
+
+#endif
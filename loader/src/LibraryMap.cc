@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <link.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+#include <ignition/plugin/LibraryMap.hh>
+
+#include "LibraryMappings.hh"
+
+namespace
+{
+  /////////////////////////////////////////////////
+  /// \brief Find out where a library is mapped, by looking up the program
+  /// headers of the object that the dynamic linker has loaded for it
+  /// \param[in] _dlHandle The dl handle of the library
+  /// \param[out] _mapping The mapping of the library
+  /// \return True if the library was found
+  bool DescribeMapping(void *_dlHandle,
+                       ignition::plugin::LibraryMapping &_mapping)
+  {
+#ifdef __linux__
+    link_map *map = nullptr;
+    if (0 != dlinfo(_dlHandle, RTLD_DI_LINKMAP, &map) || !map)
+      return false;
+
+    struct Search
+    {
+      const link_map *map;
+      ignition::plugin::LibraryMapping *mapping;
+      bool found;
+    };
+
+    Search search{map, &_mapping, false};
+    dl_iterate_phdr([](dl_phdr_info *_info, std::size_t, void *_data) -> int
+    {
+      Search &s = *static_cast<Search*>(_data);
+      if (_info->dlpi_addr != s.map->l_addr || !_info->dlpi_name ||
+          0 != std::strcmp(_info->dlpi_name, s.map->l_name))
+      {
+        return 0;
+      }
+
+      ignition::plugin::LibraryMapping &m = *s.mapping;
+      m.path = _info->dlpi_name;
+      m.loadBias = _info->dlpi_addr;
+
+      for (ElfW(Half) i = 0; i < _info->dlpi_phnum; ++i)
+      {
+        const ElfW(Phdr) &phdr = _info->dlpi_phdr[i];
+        const std::uintptr_t begin = _info->dlpi_addr + phdr.p_vaddr;
+
+        if (PT_LOAD == phdr.p_type)
+        {
+          ignition::plugin::LibraryMapping::Segment segment;
+          segment.begin = begin;
+          segment.end = begin + phdr.p_memsz;
+          segment.fileOffset = phdr.p_offset;
+          segment.executable = 0 != (phdr.p_flags & PF_X);
+          m.segments.push_back(segment);
+        }
+        else if (PT_NOTE == phdr.p_type && m.buildId.empty())
+        {
+          // Notes are a header followed by a name and a description, each
+          // padded to a multiple of 4 bytes
+          const auto align = [](const std::size_t _size)
+          {
+            return (_size + 3) & ~static_cast<std::size_t>(3);
+          };
+
+          const unsigned char *note =
+              reinterpret_cast<const unsigned char *>(begin);
+          const unsigned char *const notesEnd = note + phdr.p_memsz;
+          while (note + sizeof(ElfW(Nhdr)) <= notesEnd)
+          {
+            const ElfW(Nhdr) *header =
+                reinterpret_cast<const ElfW(Nhdr) *>(note);
+            const unsigned char *name = note + sizeof(ElfW(Nhdr));
+            const unsigned char *desc = name + align(header->n_namesz);
+            const unsigned char *next = desc + align(header->n_descsz);
+            if (next > notesEnd)
+              break;
+
+            if (NT_GNU_BUILD_ID == header->n_type && 4 == header->n_namesz &&
+                0 == std::memcmp(name, "GNU", 4))
+            {
+              std::ostringstream id;
+              id << std::hex << std::setfill('0');
+              for (std::size_t j = 0; j < header->n_descsz; ++j)
+                id << std::setw(2) << static_cast<unsigned int>(desc[j]);
+              m.buildId = id.str();
+              break;
+            }
+
+            note = next;
+          }
+        }
+      }
+
+      s.found = true;
+      return 1;
+    }, &search);
+
+    return search.found;
+#else
+    (void)_dlHandle;
+    (void)_mapping;
+    return false;
+#endif
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    LibraryMappings &LibraryMappings::Get()
+    {
+      static LibraryMappings *mappings = new LibraryMappings;
+      return *mappings;
+    }
+
+    /////////////////////////////////////////////////
+    void LibraryMappings::Mapped(void *_dlHandle)
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        const auto it = this->mappings.find(_dlHandle);
+        if (this->mappings.end() != it)
+        {
+          // The library was opened again before an earlier handle on it has
+          // been closed, e.g. because that close was deferred
+          ++it->second.opens;
+          return;
+        }
+      }
+
+      // The dynamic linker holds its own lock while it lists the libraries,
+      // and libraries may be closed while that lock is held, so the mapping
+      // is looked up without holding ours.
+      LibraryMapping mapping;
+      if (!DescribeMapping(_dlHandle, mapping))
+        return;
+
+      std::lock_guard<std::mutex> lock(this->mutex);
+      const auto inserted = this->mappings.try_emplace(_dlHandle);
+      Entry &entry = inserted.first->second;
+      ++entry.opens;
+      if (!inserted.second)
+        return;
+
+      entry.mapping = std::move(mapping);
+      if (this->observer)
+        this->observer->OnLibraryMapped(entry.mapping);
+    }
+
+    /////////////////////////////////////////////////
+    void LibraryMappings::Unmapped(void *_dlHandle)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      const auto it = this->mappings.find(_dlHandle);
+      if (this->mappings.end() == it || 0 != --it->second.opens)
+        return;
+
+      if (this->observer)
+        this->observer->OnLibraryUnmapped(it->second.mapping);
+      this->mappings.erase(it);
+    }
+
+    /////////////////////////////////////////////////
+    void LibraryMappings::SetObserver(LibraryMapObserver *_observer)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->observer = _observer;
+      if (!this->observer)
+        return;
+
+      for (const auto &entry : this->mappings)
+        this->observer->OnLibraryMapped(entry.second.mapping);
+    }
+
+    /////////////////////////////////////////////////
+    LibraryMapObserver::~LibraryMapObserver() = default;
+
+    /////////////////////////////////////////////////
+    void SetLibraryMapObserver(LibraryMapObserver *_observer)
+    {
+      LibraryMappings::Get().SetObserver(_observer);
+    }
+
+    /////////////////////////////////////////////////
+    class PerfMapWriter::Implementation
+    {
+      /// \brief The path of the file
+      public: std::string path;
+
+      /// \brief The file
+      public: std::ofstream file;
+    };
+
+    /////////////////////////////////////////////////
+    PerfMapWriter::PerfMapWriter(const std::string &_path)
+      : dataPtr(new Implementation)
+    {
+      this->dataPtr->path = _path.empty() ?
+          "/tmp/perf-" + std::to_string(::getpid()) + ".map" : _path;
+      this->dataPtr->file.open(this->dataPtr->path, std::ios::app);
+    }
+
+    /////////////////////////////////////////////////
+    PerfMapWriter::~PerfMapWriter() = default;
+
+    /////////////////////////////////////////////////
+    const std::string &PerfMapWriter::Path() const
+    {
+      return this->dataPtr->path;
+    }
+
+    /////////////////////////////////////////////////
+    bool PerfMapWriter::IsOpen() const
+    {
+      return this->dataPtr->file.is_open();
+    }
+
+    /////////////////////////////////////////////////
+    void PerfMapWriter::OnLibraryMapped(const LibraryMapping &_mapping)
+    {
+      std::ofstream &file = this->dataPtr->file;
+      for (const LibraryMapping::Segment &segment : _mapping.segments)
+      {
+        if (!segment.executable)
+          continue;
+
+        file << std::hex << segment.begin << ' '
+             << (segment.end - segment.begin) << std::dec << ' '
+             << _mapping.path;
+        if (!_mapping.buildId.empty())
+          file << " [build-id " << _mapping.buildId << ']';
+        file << '\n';
+      }
+
+      // The process may never exit cleanly, e.g. when it gets killed at the
+      // end of a profiling session, so every library is written out at once.
+      file.flush();
+    }
+
+    /////////////////////////////////////////////////
+    void PerfMapWriter::OnLibraryUnmapped(const LibraryMapping &)
+    {
+      // The lines of the library are kept for the samples which were taken
+      // while it was mapped.
+    }
+  }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_SRC_LIBRARYMAPPINGS_HH_
+#define IGNITION_PLUGIN_SRC_LIBRARYMAPPINGS_HH_
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+#include <ignition/plugin/LibraryMap.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief The mappings of the libraries which ign-plugin has open, keyed
+    /// by their dl handles, and the observer that they get reported to. See
+    /// SetLibraryMapObserver().
+    ///
+    /// This class is thread-safe.
+    class LibraryMappings
+    {
+      /// \brief Get the mappings of this process. They are never destroyed,
+      /// so that libraries can still be closed while the program exits.
+      /// \return The mappings
+      public: static LibraryMappings &Get();
+
+      /// \brief Record where a library which has just been opened is mapped,
+      /// and report it to the observer
+      /// \param[in] _dlHandle The dl handle of the library
+      public: void Mapped(void *_dlHandle);
+
+      /// \brief Report that a library is about to be closed, and forget its
+      /// mapping. This must be called before the library is closed.
+      /// \param[in] _dlHandle The dl handle of the library
+      public: void Unmapped(void *_dlHandle);
+
+      /// \brief Set the observer, and report every recorded mapping to it
+      /// \param[in] _observer The observer, or nullptr
+      public: void SetObserver(LibraryMapObserver *_observer);
+
+      /// \brief Guards `mappings` and `observer`. It is held while the
+      /// observer is called, so that its calls are serialized.
+      private: std::mutex mutex;
+
+      /// \brief The mapping of a library
+      private: struct Entry
+      {
+        /// \brief Where the library is mapped
+        LibraryMapping mapping;
+
+        /// \brief The number of times that the library has been reported as
+        /// mapped without being reported as unmapped since
+        std::size_t opens = 0;
+      };
+
+      /// \brief The mappings of the libraries, by their dl handles
+      private: std::unordered_map<void*, Entry> mappings;
+
+      /// \brief The observer, or nullptr
+      private: LibraryMapObserver *observer = nullptr;
+    };
+  }
+}
+
+#endif
@@ -16,711 +16,5517 @@
  */
 
 #include <dlfcn.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <link.h>
+#include <sys/mman.h>
+#endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
 #include <locale>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
 #include <sstream>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include <ignition/plugin/AsyncInit.hh>
+#include <ignition/plugin/CpuFeatures.hh>
+#include <ignition/plugin/Descriptor.hh>
+#include <ignition/plugin/EnablePluginFromThis.hh>
+#include <ignition/plugin/Epoch.hh>
 #include <ignition/plugin/Info.hh>
+#include <ignition/plugin/InterfaceId.hh>
 #include <ignition/plugin/Loader.hh>
 #include <ignition/plugin/Plugin.hh>
+#include <ignition/plugin/Recyclable.hh>
+#include <ignition/plugin/Reloadable.hh>
+#include <ignition/plugin/RemoteCallable.hh>
+#include <ignition/plugin/StaticRegistry.hh>
+#include <ignition/plugin/Trace.hh>
+#include <ignition/plugin/Warmup.hh>
 
 #include <ignition/plugin/utility.hh>
 
-namespace ignition
+#include "AllocationAccount.hh"
+#include "BuildId.hh"
+#include "EmbeddedMetadata.hh"
+#include "LibraryCache.hh"
+#include "LibraryIndex.hh"
+#include "LibraryMappings.hh"
+#include "Manifest.hh"
+#include "ReadAhead.hh"
+
+namespace
 {
-  namespace plugin
+  /////////////////////////////////////////////////
+  /// \brief Convert LoadOptions into the flags for dlopen
+  /// \param[in] _options The options to convert
+  /// \return The dlopen flags
+  int DlopenFlags(const ignition::plugin::LoadOptions &_options)
   {
-    /////////////////////////////////////////////////
-    /// \brief PIMPL Implementation of the Loader class
-    class Loader::Implementation
+    using ignition::plugin::LoadOptions;
+
+    int flags =
+        (LoadOptions::Binding::NOW == _options.binding ? RTLD_NOW : RTLD_LAZY)
+      | (LoadOptions::Visibility::GLOBAL == _options.visibility ?
+           RTLD_GLOBAL : RTLD_LOCAL);
+
+#ifdef RTLD_NODELETE
+    if (_options.noDelete)
+      flags |= RTLD_NODELETE;
+#endif
+
+#ifdef RTLD_DEEPBIND
+    if (_options.deepBind)
+      flags |= RTLD_DEEPBIND;
+#endif
+
+    return flags | _options.additionalFlags;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Copy the counters of an allocation account into the statistics
+  /// of its library
+  /// \param[in] _account The account, or nullptr if the library has none
+  /// \param[out] _statistics The statistics of the library
+  void ReadAllocationAccount(
+      const ignition::plugin::AllocationAccount *_account,
+      ignition::plugin::LibraryStatistics &_statistics)
+  {
+    if (!_account)
+      return;
+
+    _statistics.allocations = _account->Allocations();
+    _statistics.allocatedBytes = _account->AllocatedBytes();
+    _statistics.liveBytes = _account->LiveBytes();
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Write a string as a JSON string literal
+  /// \param[out] _out The stream to write to
+  /// \param[in] _text The string
+  void WriteJsonString(std::ostream &_out, const std::string_view _text)
+  {
+    _out << '"';
+    for (const char c : _text)
     {
-      /// \brief Attempt to load a library at the given path.
-      /// \param[in] _pathToLibrary The full path to the desired library
-      /// \return If a library exists at the given path, get a point to its dl
-      /// handle. If the library does not exist, get a nullptr.
-      public: std::shared_ptr<void> LoadLib(
-        const std::string &_pathToLibrary);
+      switch (c)
+      {
+        case '"': _out << "\\\""; break;
+        case '\\': _out << "\\\\"; break;
+        case '\n': _out << "\\n"; break;
+        case '\t': _out << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20)
+          {
+            const char *const digits = "0123456789abcdef";
+            _out << "\\u00" << digits[(c >> 4) & 0xf] << digits[c & 0xf];
+          }
+          else
+          {
+            _out << c;
+          }
+      }
+    }
+    _out << '"';
+  }
 
-      /// \brief Using a dl handle produced by LoadLib, extract the
-      /// Info from the loaded library.
-      /// \param[in] _dlHandle A handle produced by LoadLib
-      /// \param[in] _pathToLibrary The path that the library was loaded from
-      /// (used for debug purposes)
-      /// \return All the Info provided by the loaded library.
-      public: std::vector<Info> LoadPlugins(
-        const std::shared_ptr<void> &_dlHandle,
-        const std::string &_pathToLibrary) const;
+  /////////////////////////////////////////////////
+  /// \brief An idle instance of a plugin in an InstancePool
+  struct PooledInstance
+  {
+    /// \brief The instance, as it was created by Plugin. This owns the
+    /// instance and keeps its library open.
+    std::shared_ptr<void> instance;
 
-      /// \sa Loader::ForgetLibrary()
-      public: bool ForgetLibrary(void *_dlHandle);
+    /// \brief The interface table of the instance, see
+    /// Plugin::PrivateGetSharedInterfaceTable()
+    const void *table = nullptr;
 
-      /// \brief Pass in a plugin name or alias, and this will give back the
-      /// plugin name that corresponds to it. If the name or alias could not be
-      /// found, this returns an empty string.
-      /// \return The demangled symbol name of the desired plugin, or an empty
-      /// string if no matching plugin could be found.
-      public: std::string LookupPlugin(const std::string &_nameOrAlias) const;
+    /// \brief The Recyclable interface of the instance
+    ignition::plugin::Recyclable *recyclable = nullptr;
+  };
 
-      public: using AliasMap = std::map<std::string, std::set<std::string>>;
-      /// \brief A map from known alias names to the plugin names that they
-      /// correspond to. Since an alias might refer to more than one plugin, the
-      /// key of this map is a set.
-      public: AliasMap aliases;
+  /////////////////////////////////////////////////
+  /// \brief The idle instances of a plugin, see Loader::SetInstancePool()
+  struct InstancePool
+  {
+    /// \brief The Info of the plugin that the instances belong to
+    ignition::plugin::ConstInfoPtr info;
 
-      public: using PluginToDlHandleMap =
-          std::unordered_map< std::string, std::shared_ptr<void> >;
-      /// \brief A map from known plugin names to the handle of the library that
-      /// provides it.
-      ///
-      /// CRUCIAL DEV NOTE (MXG): `pluginToDlHandlePtrs` MUST come BEFORE
-      /// `plugins` in this class definition to ensure that `plugins` gets
-      /// deleted first (member variables get destructed in the reverse order of
-      /// their appearance in the class definition). The destructors of the
-      /// `deleter` members of the Info class depend on the shared library
-      /// still being available, so this map of std::shared_ptrs to the library
-      /// handles must be destroyed after the Info.
-      ///
-      /// If you change this class definition for ANY reason, be sure to
-      /// maintain the ordering of these member variables.
-      public: PluginToDlHandleMap pluginToDlHandlePtrs;
+    /// \brief The largest number of idle instances to keep
+    std::size_t capacity = 0;
 
-      public: using PluginMap = std::unordered_map<std::string, ConstInfoPtr>;
-      /// \brief A map from known plugin names to their Info
-      ///
-      /// CRUCIAL DEV NOTE (MXG): `plugins` MUST come AFTER
-      /// `pluginToDlHandlePtrs` in this class definition. See the comment on
-      /// pluginToDlHandlePtrs for an explanation.
-      ///
-      /// If you change this class definition for ANY reason, be sure to
-      /// maintain the ordering of these member variables.
-      public: PluginMap plugins;
+    /// \brief The idle instances
+    std::vector<PooledInstance> idle;
 
-      using DlHandleMap = std::unordered_map< void*, std::weak_ptr<void> >;
-      /// \brief A map which keeps track of which shared libraries have been
-      /// loaded by this Loader.
-      ///
-      /// The key of this map is a pointer to a dl handle, and the values are
-      /// weak_ptrs to the shared_ptr that was constructed for that dl handle.
-      /// Since these are weak_ptrs, they will automatically get cleared
-      /// whenever the library get unloaded. Therefore, if a map entry exists
-      /// for a dl handle and the value of that map entry still points to a
-      /// valid shared_ptr, then the library for that dl handle is currently
-      /// loaded, and we are already managing its reference count.
-      ///
-      /// This is used to ensure that we keep one single authoritative reference
-      /// count of the dl handle per Loader.
-      public: DlHandleMap dlHandlePtrMap;
+    /// \brief Guards every member of this pool
+    std::mutex mutex;
+  };
 
-      public: using DlHandleToPluginMap =
-          std::unordered_map< void*, std::unordered_set<std::string> >;
-      /// \brief A map from the shared library handle to the names of the
-      /// plugins that it provides.
-      public: DlHandleToPluginMap dlHandleToPluginMap;
-    };
+  /////////////////////////////////////////////////
+  /// \brief The deleter of the std::shared_ptr that is handed out for a
+  /// pooled instance. Instead of deleting the instance, it resets the
+  /// instance and puts it back into its pool, unless the pool is gone or full.
+  struct ReturnToPool
+  {
+    /// \brief The pool that the instance came from
+    std::weak_ptr<InstancePool> pool;
 
-    /////////////////////////////////////////////////
-    std::string Loader::PrettyStr() const
+    /// \brief The instance
+    PooledInstance entry;
+
+    void operator()(void *)
     {
-      auto interfaces = this->InterfacesImplemented();
-      std::stringstream pretty;
-      pretty << "Loader State" << std::endl;
-      pretty << "\tKnown Interfaces: " << interfaces.size() << std::endl;
-      for (auto const &interface : interfaces)
-        pretty << "\t\t" << interface << std::endl;
+      const std::shared_ptr<InstancePool> target = this->pool.lock();
+      if (!target)
+        return;
 
-      pretty << "\tKnown Plugins: " << dataPtr->plugins.size() << std::endl;
-      for (const auto &pair : dataPtr->plugins)
-      {
-        const ConstInfoPtr &plugin = pair.second;
-        const std::size_t aSize = plugin->aliases.size();
+      this->entry.recyclable->Reset();
 
-        pretty << "\t\t[" << plugin->name << "]\n";
-        if (0 < aSize)
-        {
-          pretty << "\t\t\thas "
-                 << aSize << (aSize == 1? " alias" : " aliases") << ":\n";
-          for (const auto &alias : plugin->aliases)
-            pretty << "\t\t\t\t[" << alias << "]\n";
-        }
-        else
-        {
-          pretty << "\t\t\thas no aliases\n";
-        }
+      std::unique_lock<std::mutex> lock(target->mutex);
+      if (target->idle.size() < target->capacity)
+        target->idle.push_back(std::move(this->entry));
 
-        const std::size_t iSize = plugin->interfaces.size();
-        pretty << "\t\t\timplements " << iSize
-               << (iSize == 1? " interface" : " interfaces") << ":\n";
-        for (const auto &interface : plugin->demangledInterfaces)
-          pretty << "\t\t\t\t" << interface << "\n";
+      // Otherwise the instance gets deleted along with this deleter
+    }
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief A sorted set of names which is stored in a single contiguous
+  /// array. The sets that this is used for are small, are built while a
+  /// library is loaded and are read on every lookup, so a sorted vector
+  /// keeps them in cache where a std::set would scatter a node per name.
+  class SortedNameSet
+  {
+    /// \brief Iterates over the names in order
+    public: using const_iterator =
+        std::vector<std::string_view>::const_iterator;
+
+    /// \brief Add a name
+    /// \param[in] _name The name, which must outlive this set
+    public: void insert(const std::string_view _name)
+    {
+      const auto it =
+          std::lower_bound(this->names.begin(), this->names.end(), _name);
+      if (this->names.end() == it || *it != _name)
+        this->names.insert(it, _name);
+    }
+
+    /// \brief Remove a name
+    /// \param[in] _name The name
+    public: void erase(const std::string_view _name)
+    {
+      const auto it =
+          std::lower_bound(this->names.begin(), this->names.end(), _name);
+      if (this->names.end() != it && *it == _name)
+        this->names.erase(it);
+    }
+
+    /// \brief The number of names
+    public: std::size_t size() const
+    {
+      return this->names.size();
+    }
+
+    /// \brief Check whether there are no names
+    public: bool empty() const
+    {
+      return this->names.empty();
+    }
+
+    /// \brief The first name
+    public: const_iterator begin() const
+    {
+      return this->names.begin();
+    }
+
+    /// \brief The end of the names
+    public: const_iterator end() const
+    {
+      return this->names.end();
+    }
+
+    /// \brief The names, in order, as one contiguous array
+    public: const std::string_view *data() const
+    {
+      return this->names.data();
+    }
+
+    /// \brief The names, in order
+    private: std::vector<std::string_view> names;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Streams a list of plugin names, one per line. This lets the list
+  /// be passed to Loader::Implementation::Log, which only formats its
+  /// arguments if the message is actually going to be produced.
+  struct PluginNameList
+  {
+    /// \brief The names to list
+    const SortedNameSet &names;
+  };
+
+  /////////////////////////////////////////////////
+  std::ostream &operator<<(std::ostream &_out, const PluginNameList &_list)
+  {
+    for (const std::string_view name : _list.names)
+      _out << " -- [" << name << "]\n";
+
+    return _out;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Streams a list of CPU features, one per line, like
+  /// PluginNameList
+  struct FeatureList
+  {
+    /// \brief The features to list
+    const std::set<std::string> &features;
+  };
+
+  /////////////////////////////////////////////////
+  std::ostream &operator<<(std::ostream &_out, const FeatureList &_list)
+  {
+    for (const std::string &feature : _list.features)
+    {
+      _out << " -- [" << feature << "]";
+      if (!ignition::plugin::CpuSupports(feature))
+        _out << " (unsupported)";
+      _out << "\n";
+    }
+
+    return _out;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Check whether this CPU supports every feature that a plugin
+  /// requires
+  /// \param[in] _info The Info of the plugin
+  /// \return True if the plugin can run on this CPU
+  bool CpuSupportsAll(const ignition::plugin::Info &_info)
+  {
+    for (const std::string &feature : _info.requiredFeatures)
+    {
+      if (!ignition::plugin::CpuSupports(feature))
+        return false;
+    }
+
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Score the features that a plugin requires, for choosing the
+  /// fastest of several plugins. Higher scores are better.
+  /// \param[in] _info The Info of the plugin
+  /// \return The highest rank of the features, and the number of features
+  std::pair<int, std::size_t> FeatureScore(const ignition::plugin::Info &_info)
+  {
+    int rank = 0;
+    for (const std::string &feature : _info.requiredFeatures)
+      rank = std::max(rank, ignition::plugin::CpuFeatureRank(feature));
+
+    return std::make_pair(rank, _info.requiredFeatures.size());
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Stores each distinct plugin or interface name once, so that the
+  /// indexes of a Loader can refer to the names instead of holding copies of
+  /// them. Every name that the table hands out stays valid for as long as
+  /// the table exists, even after the plugins that it came from have been
+  /// forgotten. Two interned names are equal exactly when they have the same
+  /// address, which is what InternedHash and InternedEqual rely on.
+  class NameTable
+  {
+    /// \brief Get the interned copy of a name, adding it to the table if
+    /// necessary.
+    /// \param[in] _name The name
+    /// \return The interned name
+    public: std::string_view Intern(const std::string_view _name)
+    {
+      const auto it = this->views.find(_name);
+      if (this->views.end() != it)
+        return *it;
+
+      // std::deque never moves its elements when it grows at the back, so
+      // the views of the earlier names remain valid.
+      this->storage.emplace_back(_name);
+      return *this->views.insert(this->storage.back()).first;
+    }
+
+    /// \brief Get the interned copy of a name without adding it.
+    /// \param[in] _name The name
+    /// \return The interned name, or a view with a nullptr data() if the name
+    /// has never been interned
+    public: std::string_view Find(const std::string_view _name) const
+    {
+      const auto it = this->views.find(_name);
+      if (this->views.end() == it)
+        return std::string_view();
+
+      return *it;
+    }
+
+    /// \brief The interned names
+    private: std::deque<std::string> storage;
+
+    /// \brief Views of the entries of storage, for looking them up
+    private: std::unordered_set<std::string_view> views;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Hashes an interned name by its address
+  struct InternedHash
+  {
+    std::size_t operator()(const std::string_view _name) const
+    {
+      return std::hash<const char*>()(_name.data());
+    }
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Compares interned names by their addresses
+  struct InternedEqual
+  {
+    bool operator()(const std::string_view _a, const std::string_view _b) const
+    {
+      return _a.data() == _b.data();
+    }
+  };
+
+  /// \brief A set of names which were interned by the same NameTable
+  using InternedNameSet =
+      std::unordered_set<std::string_view, InternedHash, InternedEqual>;
+
+  /////////////////////////////////////////////////
+  /// \brief A set of interned names which are stored in one contiguous array,
+  /// so that the set can be handed out as a NameView. Unlike SortedNameSet,
+  /// adding and removing a name takes constant time, which matters for the
+  /// sets of the interfaces that many plugins implement. Removing a name
+  /// moves the last name into its place, so the names are not in any order.
+  class DenseNameSet
+  {
+    /// \brief Add a name
+    /// \param[in] _name The interned name
+    public: void insert(const std::string_view _name)
+    {
+      if (this->positions.emplace(_name, this->names.size()).second)
+        this->names.push_back(_name);
+    }
+
+    /// \brief Remove a name
+    /// \param[in] _name The interned name
+    public: void erase(const std::string_view _name)
+    {
+      const auto it = this->positions.find(_name);
+      if (this->positions.end() == it)
+        return;
+
+      const std::size_t position = it->second;
+      this->positions.erase(it);
+      if (position + 1 != this->names.size())
+      {
+        this->names[position] = this->names.back();
+        this->positions[this->names[position]] = position;
       }
 
-      Implementation::AliasMap badAliases;
-      for (const auto &entry : this->dataPtr->aliases)
+      this->names.pop_back();
+    }
+
+    /// \brief The number of names
+    public: std::size_t size() const
+    {
+      return this->names.size();
+    }
+
+    /// \brief Check whether there are no names
+    public: bool empty() const
+    {
+      return this->names.empty();
+    }
+
+    /// \brief The first name
+    public: std::vector<std::string_view>::const_iterator begin() const
+    {
+      return this->names.begin();
+    }
+
+    /// \brief The end of the names
+    public: std::vector<std::string_view>::const_iterator end() const
+    {
+      return this->names.end();
+    }
+
+    /// \brief The names as one contiguous array
+    public: const std::string_view *data() const
+    {
+      return this->names.data();
+    }
+
+    /// \brief The names
+    private: std::vector<std::string_view> names;
+
+    /// \brief The position of each name in `names`
+    private: std::unordered_map<std::string_view, std::size_t,
+                                InternedHash, InternedEqual> positions;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Records which interfaces each plugin implements as a bitset, so
+  /// that the plugins which implement several interfaces at once can be
+  /// found by ANDing whole words instead of intersecting sets of names.
+  ///
+  /// Every interface that the table has seen gets a dense ID, which is the
+  /// index of its bit. IDs are never reused, just like the interned names
+  /// that they are assigned to, so the bitsets only ever grow. The rows of
+  /// the plugins are kept in one contiguous array, and a forgotten plugin's
+  /// row is filled by moving the last row into its place.
+  class InterfaceBitTable
+  {
+    /// \brief A set of interface IDs
+    public: using Bits = std::vector<std::uint64_t>;
+
+    /// \brief Set the bits of the interfaces that a plugin implements
+    /// \param[in] _plugin The interned name of the plugin
+    /// \param[in] _interface The interned name of an interface that it
+    /// implements
+    public: void Add(const std::string_view _plugin,
+                     const std::string_view _interface)
+    {
+      const auto id =
+          this->ids.emplace(_interface, this->ids.size()).first->second;
+
+      const auto slot = this->slots.emplace(_plugin, this->rows.size());
+      if (slot.second)
+        this->rows.push_back(Row{_plugin, Bits()});
+
+      Bits &bits = this->rows[slot.first->second].bits;
+      const std::size_t word = id / 64;
+      if (bits.size() <= word)
+        bits.resize(word + 1, 0);
+
+      bits[word] |= std::uint64_t(1) << (id % 64);
+    }
+
+    /// \brief Drop the row of a plugin
+    /// \param[in] _plugin The interned name of the plugin
+    public: void Remove(const std::string_view _plugin)
+    {
+      const auto slot = this->slots.find(_plugin);
+      if (this->slots.end() == slot)
+        return;
+
+      const std::size_t index = slot->second;
+      this->slots.erase(slot);
+
+      if (index + 1 != this->rows.size())
       {
-        if (entry.second.size() > 1)
-        {
-          badAliases.insert(entry);
-        }
+        this->rows[index] = std::move(this->rows.back());
+        this->slots[this->rows[index].plugin] = index;
       }
 
-      if (!badAliases.empty())
+      this->rows.pop_back();
+    }
+
+    /// \brief Make the bitset which has the bits of several interfaces set
+    /// \param[in] _interfaces The interned names of the interfaces
+    /// \param[out] _mask The bitset
+    /// \return The number of the interfaces which are known to the table.
+    /// Interfaces which no plugin that the table has seen implements have no
+    /// bit, so they are left out of the mask.
+    public: std::size_t Mask(const std::vector<std::string_view> &_interfaces,
+                             Bits &_mask) const
+    {
+      _mask.clear();
+      std::size_t known = 0;
+      for (const std::string_view interface : _interfaces)
       {
-        const std::size_t aSize = badAliases.size();
-        pretty << "\tThere " << (aSize == 1? "is " : "are ")  << aSize
-               << (aSize == 1? " alias" : " aliases") << " with a "
-               << "name collision:\n";
-        for (const auto &alias : badAliases)
-        {
-          pretty << "\t\t[" << alias.first << "] collides between:\n";
-          for (const auto &name : alias.second)
-            pretty << "\t\t\t[" << name << "]\n";
-        }
+        const auto it = this->ids.find(interface);
+        if (this->ids.end() == it)
+          continue;
+
+        const std::size_t word = it->second / 64;
+        if (_mask.size() <= word)
+          _mask.resize(word + 1, 0);
+
+        _mask[word] |= std::uint64_t(1) << (it->second % 64);
+        ++known;
       }
 
-      pretty << std::endl;
+      return known;
+    }
 
-      return pretty.str();
+    /// \brief Visit every plugin whose bitset contains all of the bits of a
+    /// mask
+    /// \param[in] _mask The bitset that was made by Mask()
+    /// \param[in] _visit Called with the interned name of each plugin
+    public: template <typename Visitor>
+    void ForEachMatchingAll(const Bits &_mask, Visitor &&_visit) const
+    {
+      for (const Row &row : this->rows)
+      {
+        if (row.bits.size() < _mask.size())
+          continue;
+
+        bool match = true;
+        for (std::size_t i = 0; match && i < _mask.size(); ++i)
+          match = (row.bits[i] & _mask[i]) == _mask[i];
+
+        if (match)
+          _visit(row.plugin);
+      }
     }
 
-    /////////////////////////////////////////////////
-    Loader::Loader()
-      : dataPtr(new Implementation())
+    /// \brief Visit every plugin whose bitset has any of the bits of a mask
+    /// \param[in] _mask The bitset that was made by Mask()
+    /// \param[in] _visit Called with the interned name of each plugin
+    public: template <typename Visitor>
+    void ForEachMatchingAny(const Bits &_mask, Visitor &&_visit) const
     {
-      // Do nothing.
+      for (const Row &row : this->rows)
+      {
+        const std::size_t words = std::min(row.bits.size(), _mask.size());
+
+        bool match = false;
+        for (std::size_t i = 0; !match && i < words; ++i)
+          match = (row.bits[i] & _mask[i]) != 0;
+
+        if (match)
+          _visit(row.plugin);
+      }
     }
 
-    /////////////////////////////////////////////////
-    Loader::~Loader()
+    /// \brief Check whether a plugin implements an interface
+    /// \param[in] _plugin The interned name of the plugin
+    /// \param[in] _interface The interned name of the interface
+    /// \return True if the plugin's bit for the interface is set
+    public: bool Test(const std::string_view _plugin,
+                      const std::string_view _interface) const
     {
-      // Do nothing.
+      const auto slot = this->slots.find(_plugin);
+      const auto id = this->ids.find(_interface);
+      if (this->slots.end() == slot || this->ids.end() == id)
+        return false;
+
+      const Bits &bits = this->rows[slot->second].bits;
+      const std::size_t word = id->second / 64;
+      return word < bits.size() &&
+          (bits[word] & (std::uint64_t(1) << (id->second % 64))) != 0;
     }
 
-    /////////////////////////////////////////////////
-    std::unordered_set<std::string> Loader::LoadLib(
-        const std::string &_pathToLibrary)
+    /// \brief The bitset of one plugin
+    private: struct Row
     {
-      std::unordered_set<std::string> newPlugins;
+      /// \brief The interned name of the plugin
+      std::string_view plugin;
 
-      // Attempt to load the library at this path
-      const std::shared_ptr<void> &dlHandle =
-          this->dataPtr->LoadLib(_pathToLibrary);
+      /// \brief The IDs of the interfaces that the plugin implements
+      Bits bits;
+    };
 
-      // Quit early and return an empty set of plugin names if we did not
-      // actually get a valid dlHandle.
-      if (nullptr == dlHandle)
-        return newPlugins;
+    /// \brief The dense ID of each interface
+    private: std::unordered_map<std::string_view, std::size_t,
+                                InternedHash, InternedEqual> ids;
 
-      // Found a shared library, does it have the symbols we're looking for?
-      std::vector<Info> loadedPlugins = this->dataPtr->LoadPlugins(
-            dlHandle, _pathToLibrary);
+    /// \brief The index of each plugin's row in `rows`
+    private: std::unordered_map<std::string_view, std::size_t,
+                                InternedHash, InternedEqual> slots;
 
-      for (Info &plugin : loadedPlugins)
-      {
-        // Demangle the plugin name before creating an entry for it.
-        plugin.name = DemangleSymbol(plugin.name);
+    /// \brief The bitsets of the plugins
+    private: std::vector<Row> rows;
+  };
 
-        // Add the plugin's aliases to the alias map
-        for (const std::string &alias : plugin.aliases)
-          this->dataPtr->aliases[alias].insert(plugin.name);
+  /////////////////////////////////////////////////
+  /// \brief Build the Info of a plugin from its PluginDescriptor
+  /// \param[in] _descriptor The descriptor of the plugin
+  /// \return The (mangled) Info of the plugin
+  ignition::plugin::Info InfoFromDescriptor(
+      const ignition::plugin::PluginDescriptor &_descriptor)
+  {
+    ignition::plugin::Info info;
+    info.name = _descriptor.name();
 
-        // Make a list of the demangled interface names for later convenience.
-        for (auto const &interface : plugin.interfaces)
-          plugin.demangledInterfaces.insert(DemangleSymbol(interface.first));
+    for (std::size_t i = 0; i < _descriptor.aliasCount; ++i)
+      info.aliases.insert(_descriptor.aliases[i]);
 
-        // Add the plugin to the map
-        this->dataPtr->plugins.insert(
-              std::make_pair(plugin.name, std::make_shared<Info>(plugin)));
+    info.interfaces.reserve(_descriptor.interfaceCount + 1);
+    info.interfaceIds.reserve(_descriptor.interfaceCount + 1);
+    for (std::size_t i = 0; i < _descriptor.interfaceCount; ++i)
+    {
+      const ignition::plugin::InterfaceDescriptor &interface =
+          _descriptor.interfaces[i];
+      info.interfaces.insert(
+            std::make_pair(interface.name(), interface.cast));
+      info.interfaceIds.insert(
+            std::make_pair(interface.name(), interface.id));
+    }
 
-        // Add the plugin's name to the set of newPlugins
-        newPlugins.insert(plugin.name);
+    // This mirrors what IGNITION_ADD_PLUGIN does for plugins that inherit
+    // EnablePluginFromThis.
+    if (_descriptor.enablePluginFromThis)
+    {
+      using ignition::plugin::EnablePluginFromThis;
+      info.interfaces.insert(std::make_pair(
+            typeid(EnablePluginFromThis).name(),
+            _descriptor.enablePluginFromThis));
+      info.interfaceIds.insert(std::make_pair(
+            typeid(EnablePluginFromThis).name(),
+            ignition::plugin::InterfaceId<EnablePluginFromThis>()));
+    }
 
-        // Save the dl handle for this plugin
-        this->dataPtr->pluginToDlHandlePtrs[plugin.name] = dlHandle;
-      }
+    info.factory = _descriptor.factory;
+    info.deleter = _descriptor.deleter;
+    info.instanceSize = _descriptor.instanceSize;
+    info.instanceAlignment = _descriptor.instanceAlignment;
+    info.construct = _descriptor.construct;
+    info.destruct = _descriptor.destruct;
+    info.enablePluginFromThis = _descriptor.enablePluginFromThis;
 
-      dataPtr->dlHandleToPluginMap[dlHandle.get()] = newPlugins;
+    return info;
+  }
 
-      return newPlugins;
+  /////////////////////////////////////////////////
+  /// \brief Get the demangled form of a name, preferring the names that the
+  /// library spelled out in its metadata records over demangling at run time.
+  /// \param[in] _mangled The mangled name
+  /// \param[in] _names The names that the library spelled out
+  /// \return The demangled name
+  std::string DemangledName(
+      const std::string &_mangled,
+      const ignition::plugin::DemangledNameMap &_names)
+  {
+    const auto it = _names.find(_mangled);
+    if (_names.end() != it)
+      return it->second;
+
+    return ignition::plugin::CachedDemangleSymbol(_mangled);
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Demangle the name of a plugin, and list the demangled names of
+  /// its interfaces.
+  /// \param[in,out] _info The Info to demangle
+  /// \param[in] _names Demangled names which the library spelled out in its
+  /// metadata records. Any other name gets demangled at run time.
+  void DemangleInfo(ignition::plugin::Info &_info,
+                    const ignition::plugin::DemangledNameMap &_names = {})
+  {
+    _info.name = DemangledName(_info.name, _names);
+
+    // Make a list of the demangled interface names for later convenience.
+    for (auto const &interface : _info.interfaces)
+    {
+      _info.demangledInterfaces.insert(
+            DemangledName(interface.first, _names));
+    }
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Ask the kernel to read in the pages of the loaded library (or
+  /// program) which contains an address, and optionally lock its executable
+  /// pages into memory. The advice is best effort, so only a failure to lock
+  /// gets reported.
+  /// \param[in] _address An address inside of the library
+  /// \param[in] _lockCode Whether to lock the executable pages with mlock()
+  /// \return 0 on success, otherwise the errno of the lock which failed
+  int PrepareLibraryPages(const void *_address, const bool _lockCode)
+  {
+#ifdef __linux__
+    struct Search
+    {
+      std::uintptr_t address;
+      bool lockCode;
+      int error;
+    };
+
+    Search search{reinterpret_cast<std::uintptr_t>(_address), _lockCode, 0};
+    dl_iterate_phdr([](dl_phdr_info *_info, std::size_t, void *_data) -> int
+    {
+      Search &s = *static_cast<Search*>(_data);
+
+      const auto segmentBegin = [&](const ElfW(Phdr) &_phdr)
+      {
+        return static_cast<std::uintptr_t>(_info->dlpi_addr + _phdr.p_vaddr);
+      };
+
+      bool contains = false;
+      for (ElfW(Half) i = 0; i < _info->dlpi_phnum && !contains; ++i)
+      {
+        const ElfW(Phdr) &phdr = _info->dlpi_phdr[i];
+        contains = PT_LOAD == phdr.p_type
+            && s.address >= segmentBegin(phdr)
+            && s.address < segmentBegin(phdr) + phdr.p_memsz;
+      }
+
+      if (!contains)
+        return 0;
+
+      const std::uintptr_t pageSize =
+          static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+      for (ElfW(Half) i = 0; i < _info->dlpi_phnum; ++i)
+      {
+        const ElfW(Phdr) &phdr = _info->dlpi_phdr[i];
+        if (PT_LOAD != phdr.p_type || 0 == phdr.p_memsz)
+          continue;
+
+        const std::uintptr_t begin = segmentBegin(phdr) & ~(pageSize - 1);
+        const std::size_t length =
+            segmentBegin(phdr) + phdr.p_memsz - begin;
+        void *const pages = reinterpret_cast<void*>(begin);
+
+        madvise(pages, length, MADV_WILLNEED);
+        if (s.lockCode && (phdr.p_flags & PF_X) && 0 != mlock(pages, length))
+          s.error = errno;
+      }
+
+      return 1;
+    }, &search);
+
+    return search.error;
+#else
+    (void)_address;
+    return _lockCode ? ENOSYS : 0;
+#endif
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Get the size of the transparent huge pages of the system
+  /// \return The size in bytes
+  std::uintptr_t HugePageSize()
+  {
+    static const std::uintptr_t size = []()
+    {
+      std::uintptr_t pmdSize = 0;
+      std::ifstream file(
+            "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+      if (!(file >> pmdSize) || 0 == pmdSize || 0 != (pmdSize & (pmdSize - 1)))
+        pmdSize = 2u << 20;
+      return pmdSize;
+    }();
+
+    return size;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Move the code of a library onto transparent huge pages, so that
+  /// calls into it need fewer entries of the instruction TLB. Each code
+  /// segment is copied into anonymous memory which is advised to use huge
+  /// pages, and the copy is then moved over the original pages with a single
+  /// mremap(), so the code stays executable throughout. The addresses of the
+  /// code do not change, so symbols, unwinding and dlclose() keep working.
+  ///
+  /// Only the part of a segment which spans whole huge pages can be moved;
+  /// libraries whose code is smaller than one huge page stay as they are.
+  /// No other thread may be writing to the code while it gets moved, which
+  /// holds for a library that has just been opened for the first time.
+  /// \param[in] _dlHandle The handle of the library
+  /// \return 0 on success, including when nothing could be moved, otherwise
+  /// the errno of the step which failed
+  int RemapTextOntoHugePages(void *_dlHandle)
+  {
+#if defined(__linux__) && defined(MADV_HUGEPAGE) && defined(MREMAP_FIXED)
+    link_map *map = nullptr;
+    if (0 != dlinfo(_dlHandle, RTLD_DI_LINKMAP, &map) || !map)
+      return ENOENT;
+
+    struct Range
+    {
+      std::uintptr_t begin;
+      std::uintptr_t end;
+      int protection;
+    };
+
+    struct Search
+    {
+      const link_map *map;
+      std::uintptr_t hugePage;
+      std::vector<Range> ranges;
+    };
+
+    Search search{map, HugePageSize(), {}};
+    dl_iterate_phdr([](dl_phdr_info *_info, std::size_t, void *_data) -> int
+    {
+      Search &s = *static_cast<Search*>(_data);
+      if (_info->dlpi_addr != s.map->l_addr || !_info->dlpi_name ||
+          0 != std::strcmp(_info->dlpi_name, s.map->l_name))
+      {
+        return 0;
+      }
+
+      for (ElfW(Half) i = 0; i < _info->dlpi_phnum; ++i)
+      {
+        const ElfW(Phdr) &phdr = _info->dlpi_phdr[i];
+        if (PT_LOAD != phdr.p_type || !(phdr.p_flags & PF_X) ||
+            !(phdr.p_flags & PF_R))
+        {
+          continue;
+        }
+
+        const std::uintptr_t begin = _info->dlpi_addr + phdr.p_vaddr;
+        const std::uintptr_t end = begin + phdr.p_memsz;
+        Range range;
+        range.begin = (begin + s.hugePage - 1) & ~(s.hugePage - 1);
+        range.end = end & ~(s.hugePage - 1);
+        range.protection = PROT_READ | PROT_EXEC |
+            ((phdr.p_flags & PF_W) ? PROT_WRITE : 0);
+        if (range.begin < range.end)
+          s.ranges.push_back(range);
+      }
+
+      return 1;
+    }, &search);
+
+    const std::uintptr_t hugePage = search.hugePage;
+    for (const Range &range : search.ranges)
+    {
+      const std::size_t length = range.end - range.begin;
+
+      // Map more than needed, so that a part of it is aligned to a huge
+      // page, and give back the rest
+      void *const area = mmap(nullptr, length + hugePage,
+                              PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (MAP_FAILED == area)
+        return errno;
+
+      const std::uintptr_t raw = reinterpret_cast<std::uintptr_t>(area);
+      const std::uintptr_t aligned = (raw + hugePage - 1) & ~(hugePage - 1);
+      if (aligned > raw)
+        munmap(area, aligned - raw);
+      if (raw + hugePage > aligned)
+      {
+        munmap(reinterpret_cast<void*>(aligned + length),
+               raw + hugePage - aligned);
+      }
+
+      void *const copy = reinterpret_cast<void*>(aligned);
+      void *const code = reinterpret_cast<void*>(range.begin);
+
+      // The advice has to come before the copy touches the pages, so that
+      // they get faulted in as huge pages right away
+      int error = 0;
+      if (0 != madvise(copy, length, MADV_HUGEPAGE))
+        error = errno;
+
+      if (0 == error)
+      {
+        std::memcpy(copy, code, length);
+        if (0 != mprotect(copy, length, range.protection))
+          error = errno;
+      }
+
+      if (0 == error &&
+          MAP_FAILED == mremap(copy, length, length,
+                               MREMAP_MAYMOVE | MREMAP_FIXED, code))
+      {
+        error = errno;
+      }
+
+      if (0 != error)
+      {
+        munmap(copy, length);
+        return error;
+      }
+    }
+
+    return 0;
+#else
+    (void)_dlHandle;
+    return ENOSYS;
+#endif
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Close a library, after reporting it to the observer of
+  /// SetLibraryMapObserver()
+  /// \param[in] _dlHandle The handle of the library
+  void CloseLibrary(void *_dlHandle)
+  {
+    ignition::plugin::LibraryMappings::Get().Unmapped(_dlHandle);
+    dlclose(_dlHandle);
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief The libraries which were loaded with LoadOptions::deferUnload and
+  /// have been released, waiting to be closed. There is one queue for the
+  /// whole process, since a library may outlive the Loader that opened it.
+  class UnloadQueue
+  {
+    /// \brief Get the queue of this process. It is never destroyed, so that
+    /// libraries can still be posted to it while the program exits.
+    public: static UnloadQueue &Get()
+    {
+      static UnloadQueue *queue = new UnloadQueue;
+      return *queue;
+    }
+
+    /// \brief Post a library to be closed later. This only holds a lock for
+    /// as long as it takes to append the handle, and it does not call into
+    /// the dynamic linker.
+    /// \param[in] _dlHandle The handle of the library
+    public: void Post(void *_dlHandle)
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pending.push_back(_dlHandle);
+      }
+      this->posted.notify_one();
+    }
+
+    /// \brief Close every library in the queue
+    /// \return The number of libraries that were closed
+    public: std::size_t Flush()
+    {
+      std::lock_guard<std::mutex> flushLock(this->flushMutex);
+      {
+        // The two buffers trade places, so that neither of them needs to
+        // grow again once they have reached their working size.
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pending.swap(this->closing);
+      }
+
+      for (void *dlHandle : this->closing)
+        CloseLibrary(dlHandle);
+
+      const std::size_t count = this->closing.size();
+      this->closing.clear();
+      return count;
+    }
+
+    /// \brief Start or stop the background thread
+    /// \param[in] _enabled True to start the thread, false to stop it
+    public: void SetBackground(const bool _enabled)
+    {
+      std::lock_guard<std::mutex> control(this->controlMutex);
+      if (_enabled == this->worker.joinable())
+        return;
+
+      if (_enabled)
+      {
+        // Stop the thread before the program exits, so that it does not
+        // close libraries while their static objects are being destroyed.
+        static const struct StopAtExit
+        {
+          ~StopAtExit() { UnloadQueue::Get().SetBackground(false); }
+        } stopAtExit;
+
+        this->stop = false;
+        this->worker = std::thread([this]() { this->Run(); });
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stop = true;
+      }
+      this->posted.notify_all();
+      this->worker.join();
+    }
+
+    /// \brief The loop of the background thread
+    private: void Run()
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      while (!this->stop)
+      {
+        this->posted.wait(lock, [this]()
+        {
+          return this->stop || !this->pending.empty();
+        });
+
+        if (this->stop)
+          break;
+
+        lock.unlock();
+        this->Flush();
+        lock.lock();
+      }
+    }
+
+    /// \brief Constructor. Room for a few handles is reserved up front so
+    /// that posting does not need to allocate.
+    private: UnloadQueue()
+    {
+      this->pending.reserve(16);
+      this->closing.reserve(16);
+
+      pthread_atfork(
+            []() { UnloadQueue::Get().PrepareFork(); },
+            []() { UnloadQueue::Get().ResumeAfterFork(); },
+            []() { UnloadQueue::Get().ResumeInChild(); });
+    }
+
+    /// \brief Take every lock before the process forks, so that none of
+    /// them is copied into the child while another thread holds it
+    private: void PrepareFork()
+    {
+      this->controlMutex.lock();
+      this->flushMutex.lock();
+      this->mutex.lock();
+    }
+
+    /// \brief Release the locks which were taken by PrepareFork
+    private: void ResumeAfterFork()
+    {
+      this->mutex.unlock();
+      this->flushMutex.unlock();
+      this->controlMutex.unlock();
+    }
+
+    /// \brief Release the locks which were taken by PrepareFork in the child
+    /// of a fork. Only the thread which forked exists in the child, so the
+    /// background thread is forgotten without being joined, and it can be
+    /// started again with SetBackground.
+    private: void ResumeInChild()
+    {
+      if (this->worker.joinable())
+      {
+        new (&this->worker) std::thread;
+
+        // The condition variable still counts the background thread of the
+        // parent as a waiter, so it is replaced as well. Nothing else ever
+        // waits on it.
+        new (&this->posted) std::condition_variable;
+      }
+      this->stop = false;
+
+      this->ResumeAfterFork();
+    }
+
+    /// \brief Protects pending and stop
+    private: std::mutex mutex;
+
+    /// \brief Notified whenever a library is posted or the thread should stop
+    private: std::condition_variable posted;
+
+    /// \brief The libraries which are waiting to be closed
+    private: std::vector<void*> pending;
+
+    /// \brief Serializes Flush, and protects closing
+    private: std::mutex flushMutex;
+
+    /// \brief The libraries which are being closed by Flush
+    private: std::vector<void*> closing;
+
+    /// \brief Serializes starting and stopping the background thread
+    private: std::mutex controlMutex;
+
+    /// \brief The background thread, if it is running
+    private: std::thread worker;
+
+    /// \brief Tells the background thread to stop
+    private: bool stop = false;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Plugin instances which have been handed to Loader::Discard(),
+  /// waiting to be destroyed off the thread that dropped them. Each Loader
+  /// has its own queue. See Loader::SetDestructionWorkers().
+  class DestructionQueue
+  {
+    /// \brief The instances of one batch
+    public: using Batch = std::vector<ignition::plugin::PluginPtr>;
+
+    /// \brief The largest number of instances that one thread takes from
+    /// the queue at once, so that several threads can share a large batch
+    public: static constexpr std::size_t ChunkSize = 256;
+
+    /// \brief Destructor. The workers are stopped and every instance that is
+    /// left in the queue is destroyed.
+    public: ~DestructionQueue()
+    {
+      this->SetWorkers(0);
+      this->Flush();
+    }
+
+    /// \brief Post instances to be destroyed. This only holds a lock for as
+    /// long as it takes to append them.
+    /// \param[in] _batch The instances. It is left empty.
+    public: void Post(Batch &&_batch)
+    {
+      if (_batch.empty())
+        return;
+
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->pending.empty())
+        {
+          this->pending.swap(_batch);
+        }
+        else
+        {
+          this->pending.insert(this->pending.end(),
+                               std::make_move_iterator(_batch.begin()),
+                               std::make_move_iterator(_batch.end()));
+          _batch.clear();
+        }
+      }
+      this->posted.notify_all();
+    }
+
+    /// \brief Destroy every instance in the queue, together with the
+    /// workers, and wait until the workers have finished the chunks that
+    /// they had already taken.
+    /// \return The number of instances that were destroyed by this call
+    public: std::size_t Flush()
+    {
+      std::size_t count = 0;
+
+      // Any library which loses its last instance in the meantime stays
+      // open until this guard is left, so the libraries are closed together
+      // once the queue is empty, rather than one by one in between.
+      ignition::plugin::EpochGuard guard;
+
+      std::unique_lock<std::mutex> lock(this->mutex);
+      while (!this->pending.empty())
+        count += this->DestroyChunk(lock);
+
+      this->idle.wait(lock, [this]() { return 0 == this->busy; });
+      return count;
+    }
+
+    /// \brief Set the number of background threads which drain the queue
+    /// \param[in] _count The number of threads, or 0 to stop all of them
+    public: void SetWorkers(const std::size_t _count)
+    {
+      std::lock_guard<std::mutex> control(this->controlMutex);
+      if (_count == this->workers.size())
+        return;
+
+      if (!this->workers.empty())
+      {
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->stop = true;
+        }
+        this->posted.notify_all();
+
+        for (std::thread &worker : this->workers)
+          worker.join();
+        this->workers.clear();
+        this->stop = false;
+      }
+
+      for (std::size_t i = 0; i < _count; ++i)
+        this->workers.emplace_back([this]() { this->Run(); });
+    }
+
+    /// \brief Get the number of background threads
+    /// \return The number of threads
+    public: std::size_t Workers() const
+    {
+      std::lock_guard<std::mutex> control(this->controlMutex);
+      return this->workers.size();
+    }
+
+    /// \brief The loop of a background thread
+    private: void Run()
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      while (true)
+      {
+        this->posted.wait(lock, [this]()
+        {
+          return this->stop || !this->pending.empty();
+        });
+
+        if (this->stop)
+          break;
+
+        // The guard is held for as long as there is work, so that the
+        // libraries which get released by the whole batch are closed once,
+        // by the last thread to run out of work.
+        lock.unlock();
+        {
+          ignition::plugin::EpochGuard guard;
+          lock.lock();
+          while (!this->stop && !this->pending.empty())
+            this->DestroyChunk(lock);
+          lock.unlock();
+        }
+        lock.lock();
+      }
+    }
+
+    /// \brief Take a chunk of instances off the queue and destroy them
+    /// without holding the lock.
+    /// \param[in] _lock A lock on `mutex`, which is held again on return
+    /// \return The number of instances that were destroyed
+    private: std::size_t DestroyChunk(std::unique_lock<std::mutex> &_lock)
+    {
+      const std::size_t size = std::min(ChunkSize, this->pending.size());
+      Batch chunk(std::make_move_iterator(this->pending.end() - size),
+                  std::make_move_iterator(this->pending.end()));
+      this->pending.resize(this->pending.size() - size);
+      ++this->busy;
+
+      _lock.unlock();
+      chunk.clear();
+      _lock.lock();
+
+      if (0 == --this->busy)
+        this->idle.notify_all();
+
+      return size;
+    }
+
+    /// \brief Protects pending, busy and stop
+    private: std::mutex mutex;
+
+    /// \brief Notified whenever instances are posted or the threads should
+    /// stop
+    private: std::condition_variable posted;
+
+    /// \brief Notified whenever no chunk is being destroyed
+    private: std::condition_variable idle;
+
+    /// \brief The instances which are waiting to be destroyed
+    private: Batch pending;
+
+    /// \brief The number of chunks which are being destroyed
+    private: std::size_t busy = 0;
+
+    /// \brief Serializes starting and stopping the background threads
+    private: mutable std::mutex controlMutex;
+
+    /// \brief The background threads
+    private: std::vector<std::thread> workers;
+
+    /// \brief Tells the background threads to stop
+    private: bool stop = false;
+  };
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    /// \brief PIMPL Implementation of the Loader class
+    ///
+    /// Unless stated otherwise, the member functions of this class expect the
+    /// caller to already be holding an appropriate lock on `mutex`: a shared
+    /// lock for functions that only read the registry, and a unique lock for
+    /// functions that modify it.
+    class Loader::Implementation
+    {
+      /// \brief The type of `plugins`. It is declared up here because some of
+      /// the member functions refer to it.
+      public: using PluginMap =
+          std::unordered_map<std::string_view, ConstInfoPtr>;
+
+      /// \brief Attempt to load a library at the given path.
+      ///
+      /// This function does not require `mutex` to be locked. A library which
+      /// is already open, whether by this Loader or by any other, is shared
+      /// through the LibraryCache.
+      ///
+      /// \param[in] _pathToLibrary The full path to the desired library
+      /// \param[in] _options Options for opening the library
+      /// \return If a library exists at the given path, get the library. If
+      /// the library does not exist, get a nullptr.
+      public: std::shared_ptr<CachedLibrary> LoadLib(
+        const std::string &_pathToLibrary,
+        const LoadOptions &_options);
+
+      /// \brief Using a dl handle produced by LoadLib, extract the
+      /// Info from the loaded library. This does not touch the registry, so it
+      /// does not require `mutex` to be locked.
+      /// \param[in] _dlHandle A handle produced by LoadLib
+      /// \param[in] _pathToLibrary The path that the library was loaded from
+      /// (used for debug purposes)
+      /// \return All the Info provided by the loaded library.
+      public: std::vector<std::shared_ptr<Info>> LoadPlugins(
+        const std::shared_ptr<void> &_dlHandle,
+        const std::string &_pathToLibrary) const;
+
+      /// \brief Retrieve the Info that a library provides through
+      /// IgnitionPluginHook.
+      /// \param[in] _infoFuncPtr The IgnitionPluginHook of the library
+      /// \param[in] _pathToLibrary The path that the library was loaded from
+      /// (used for debug purposes)
+      /// \param[out] _plugins The (mangled) Info of the plugins of the library
+      /// gets appended to this.
+      public: void LoadInfoMap(
+        void *_infoFuncPtr,
+        const std::string &_pathToLibrary,
+        std::vector<std::shared_ptr<Info>> &_plugins) const;
+
+      /// \brief Add the plugins that a library described with
+      /// PluginDescriptors (see IGNITION_ADD_STATIC_PLUGIN) to the plugins
+      /// that it provided through IgnitionPluginHook.
+      /// \param[in] _descriptorFuncPtr The IgnitionPluginHookV2 of the library
+      /// \param[in] _pathToLibrary The path that the library was loaded from
+      /// (used for debug purposes)
+      /// \param[in,out] _plugins The (mangled) Info of the plugins of the
+      /// library. Descriptors of plugins that are already listed get merged
+      /// into their Info.
+      public: void LoadDescriptors(
+        void *_descriptorFuncPtr,
+        const std::string &_pathToLibrary,
+        std::vector<std::shared_ptr<Info>> &_plugins) const;
+
+      /// \brief Collect the demangled names that a library spelled out in the
+      /// metadata records which IgnitionPluginMetadataHook hands out. Libraries
+      /// without that hook simply yield no names.
+      /// \param[in] _dlHandle A handle produced by LoadLib
+      /// \param[out] _names Receives the demangled names, keyed by their
+      /// mangled names
+      public: static void LoadDemangledNames(
+        const std::shared_ptr<void> &_dlHandle,
+        DemangledNameMap &_names);
+
+      /// \brief The contents of a library which has been opened but not yet
+      /// committed to the registry.
+      public: struct StagedLibrary
+      {
+        /// \brief The canonical path to the library
+        std::string path;
+
+        /// \brief Handle of the library, or nullptr if it could not be
+        /// opened.
+        std::shared_ptr<void> dlHandle;
+
+        /// \brief The options that the library was opened with
+        LoadOptions options;
+
+        /// \brief The modification time of the library file when it was
+        /// opened, see ManifestLibrary::modificationTime
+        std::int64_t modificationTime = 0;
+
+        /// \brief The size of the library file when it was opened
+        std::uint64_t fileSize = 0;
+
+        /// \brief The Info provided by the library, with its names and
+        /// interfaces already demangled. Each Info is allocated once while
+        /// the library is being staged, and is then shared with the registry
+        /// when the library gets committed.
+        std::vector<std::shared_ptr<Info>> plugins;
+      };
+
+      /// \brief Open a library and extract (and demangle) the Info that it
+      /// provides, without touching the registry. This does not require
+      /// `mutex` to be locked, so it can run while other threads are using
+      /// this Loader, and several libraries can be staged at once.
+      /// \param[in] _pathToLibrary The path to the library
+      /// \param[in] _options Options for opening the library
+      /// \return The staged contents of the library.
+      public: StagedLibrary StageLib(
+        const std::string &_pathToLibrary,
+        const LoadOptions &_options);
+
+      /// \brief Commit a staged library to the registry.
+      /// \param[in] _staged The library that was produced by StageLib
+      /// \return The names of the plugins that the library provides.
+      public: std::unordered_set<std::string> CommitLib(
+        const StagedLibrary &_staged);
+
+      /// \brief Stage a library, record it in the manifest cache, and commit
+      /// it to the registry. This locks `mutex` by itself, so the caller must
+      /// not be holding it.
+      /// \param[in] _pathToLibrary The path to the library
+      /// \param[in] _options Options for opening the library
+      /// \return The names of the plugins that the library provides.
+      public: std::unordered_set<std::string> StageAndCommitLib(
+        const std::string &_pathToLibrary,
+        const LoadOptions &_options);
+
+      /// \brief Register the plugins of a library whose metadata came from a
+      /// manifest, without opening the library. The library will be opened
+      /// the first time that one of its plugins gets instantiated.
+      /// \param[in] _library The manifest entry of the library
+      /// \param[in] _options Options for opening the library once it is
+      /// needed
+      /// \return The names of the plugins that the library provides.
+      public: std::unordered_set<std::string> RegisterDeferredLib(
+        const ManifestLibrary &_library,
+        const LoadOptions &_options);
+
+      /// \brief Register the plugins of the libraries that a manifest
+      /// describes, without opening them. This locks `mutex` by itself.
+      /// \param[in] _manifest The manifest
+      /// \param[in] _pathsToLibraries The libraries to look up in the
+      /// manifest, or an empty list for every library that it records
+      /// \param[out] _outdated Receives the libraries which the manifest does
+      /// not describe as they are on disk, and which need to be opened
+      /// \return The names of the plugins that were registered
+      public: std::unordered_set<std::string> RegisterManifest(
+        const Manifest &_manifest,
+        const std::vector<std::string> &_pathsToLibraries,
+        std::vector<std::string> &_outdated);
+
+      /// \brief Look for an up-to-date entry of a library in the manifest
+      /// cache. This locks `manifestMutex` by itself and does not require
+      /// `mutex` to be locked.
+      /// \param[in] _pathToLibrary The path to the library
+      /// \param[out] _library Receives a copy of the entry, if one was found
+      /// \return True if an entry was found.
+      public: bool FindCachedLib(
+        const std::string &_pathToLibrary,
+        ManifestLibrary &_library);
+
+      /// \brief Describe a staged library as a manifest entry.
+      /// \param[in] _pathToLibrary The path that the library was loaded from
+      /// \param[in] _staged The staged contents of the library
+      /// \param[out] _library Receives the manifest entry
+      /// \return True if the library file could be inspected.
+      public: static bool DescribeLib(
+        const std::string &_pathToLibrary,
+        const StagedLibrary &_staged,
+        ManifestLibrary &_library);
+
+      /// \brief Record a staged library in the manifest cache, if there is
+      /// one. This locks `manifestMutex` by itself and does not require
+      /// `mutex` to be locked.
+      /// \param[in] _pathToLibrary The path that the library was loaded from
+      /// \param[in] _staged The staged contents of the library
+      public: void CacheLib(
+        const std::string &_pathToLibrary,
+        const StagedLibrary &_staged);
+
+      /// \sa Loader::ForgetLibrary()
+      public: bool ForgetLibrary(void *_dlHandle);
+
+      /// \brief Forget the library that was loaded from a path, whether it
+      /// has been opened or is still deferred. `mutex` must be locked.
+      /// \param[in] _path The canonical path to the library
+      /// \return True if the library was known and is now forgotten
+      public: bool ForgetLibraryPath(const std::string &_path);
+
+      /// \brief Check whether an eviction policy has been set
+      /// \return True if the open libraries have a budget
+      public: bool EvictionEnabled() const;
+
+      /// \brief Evict idle libraries, least recently used first, until the
+      /// budget of the eviction policy is met. An evicted library is turned
+      /// into a deferred library, so its plugins remain known. `mutex` must be
+      /// locked uniquely.
+      /// \param[in] _keep A library which must not be evicted, because it has
+      /// just been opened in order to be used
+      /// \return The number of libraries that were evicted
+      public: std::size_t EvictIdleLibraries(const void *_keep);
+
+      /// \brief Forget the plugins of a library that has not been opened yet.
+      /// \param[in] _path The canonical path to the library
+      /// \return True if this Loader knew about the library.
+      public: bool ForgetDeferredLibrary(const std::string &_path);
+
+      /// \brief Remove a single plugin from the registry.
+      /// \param[in] _name The name of the plugin
+      public: void ForgetPlugin(const std::string &_name);
+
+      /// \brief Pass in a plugin name or alias, and this will give back the
+      /// plugin name that corresponds to it. If the name or alias could not be
+      /// found, this returns an empty string.
+      /// \return The demangled symbol name of the desired plugin, or an empty
+      /// string if no matching plugin could be found.
+      public: std::string LookupPlugin(std::string_view _nameOrAlias) const;
+
+      /// \brief Find the entry of `plugins` that a plugin name or alias
+      /// refers to. Unlike LookupPlugin, this does not need to copy the name
+      /// of the plugin, and it never produces a diagnostic message.
+      /// \param[in] _nameOrAlias The name or alias of the plugin
+      /// \param[out] _status Receives FOUND, NOT_FOUND, or AMBIGUOUS_ALIAS
+      /// \return An iterator to the entry of the plugin, or plugins.end() if
+      /// no plugin is uniquely identified by _nameOrAlias.
+      public: PluginMap::const_iterator ResolvePlugin(
+        std::string_view _nameOrAlias,
+        LookupStatus &_status) const;
+
+      /// \brief Same as ResolvePlugin, but without consulting resolvedNames.
+      /// \param[in] _nameOrAlias The name or alias of the plugin
+      /// \param[out] _status Receives FOUND, NOT_FOUND, or AMBIGUOUS_ALIAS
+      /// \return An iterator to the entry of the plugin, or plugins.end() if
+      /// no plugin is uniquely identified by _nameOrAlias.
+      public: PluginMap::const_iterator FindPlugin(
+        std::string_view _nameOrAlias,
+        LookupStatus &_status) const;
+
+      /// \brief Find the entry of `plugins` that a plugin name or alias
+      /// refers to, choosing the fastest plugin that this CPU supports if
+      /// the alias refers to more than one. See Preference::FASTEST.
+      /// \param[in] _nameOrAlias The name or alias of the plugin
+      /// \param[out] _status Receives FOUND, NOT_FOUND, or UNSUPPORTED_CPU
+      /// \return An iterator to the entry of the chosen plugin, or
+      /// plugins.end() if there is no suitable plugin.
+      public: PluginMap::const_iterator ResolveFastestPlugin(
+        std::string_view _nameOrAlias,
+        LookupStatus &_status) const;
+
+      /// \brief Produce the diagnostic message for a name or alias that could
+      /// not be resolved.
+      /// \param[in] _nameOrAlias The name or alias of the plugin
+      /// \param[in] _status The status that ResolvePlugin produced
+      public: void ReportLookupFailure(
+        std::string_view _nameOrAlias,
+        LookupStatus _status) const;
+
+      /// \brief Produce a diagnostic message. The arguments are streamed into
+      /// the message, but only if the rate limit of the logger allows the
+      /// message to be produced. This does not require `mutex` to be locked.
+      /// \param[in] _args The parts of the message
+      public: template <typename... Args>
+      void Log(const Args &... _args) const
+      {
+        std::unique_lock<std::mutex> lock(this->logMutex);
+        if (!this->AdmitLogMessage())
+          return;
+
+        std::stringstream ss;
+        (ss << ... << _args);
+        this->WriteLogMessage(ss.str());
+      }
+
+      /// \brief Apply the rate limit of the logger to a new message. This
+      /// expects `logMutex` to be locked.
+      /// \return True if the message should be produced, false if it should
+      /// be dropped.
+      public: bool AdmitLogMessage() const;
+
+      /// \brief Pass a message to the logger, or to std::cerr if there is no
+      /// logger. This expects `logMutex` to be locked.
+      /// \param[in] _message The message
+      public: void WriteLogMessage(const std::string &_message) const;
+
+      /// \brief Make the mask of the interface bitsets which has the bits of
+      /// several interfaces set.
+      /// \param[in] _interfaces The names of the interfaces
+      /// \param[in] _demangled True if the names are demangled
+      /// \param[out] _mask The mask. This is left empty if any of the
+      /// interfaces is not implemented by a known plugin, unless _partial is
+      /// true, in which case those interfaces are left out of it.
+      /// \param[in] _partial Whether to leave out the unknown interfaces
+      /// \return The table which the mask applies to
+      public: const InterfaceBitTable &InterfaceMask(
+          const std::vector<std::string_view> &_interfaces,
+          bool _demangled,
+          InterfaceBitTable::Bits &_mask,
+          bool _partial = false) const;
+
+      /// \brief Add the interfaces of a plugin to the interface indexes.
+      /// \param[in] _info The Info of the plugin that is being added
+      public: void IndexInterfaces(const Info &_info);
+
+      /// \brief Remove the interfaces of a plugin from the interface indexes.
+      /// Entries which no longer refer to any plugin get erased.
+      /// \param[in] _info The Info of the plugin that is being forgotten
+      public: void UnindexInterfaces(const Info &_info);
+
+      /// \brief Resolve a plugin name or alias and get the Info and library
+      /// handle of the plugin that it refers to.
+      /// \param[in] _nameOrAlias The name or alias of the plugin
+      /// \param[out] _info The Info of the plugin, if it was found
+      /// \param[out] _dlHandle The library handle of the plugin, if it was
+      /// found
+      /// \param[out] _deferredLibrary If the plugin is known, but its library
+      /// has not been opened yet, this receives the path of the library.
+      /// \return FOUND if the plugin was found and its library is open,
+      /// LIBRARY_UNAVAILABLE if its library has not been opened yet,
+      /// UNSUPPORTED_CPU if the plugin cannot run on this CPU, or the status
+      /// produced by ResolvePlugin.
+      public: LookupStatus GetInfoAndDlHandle(
+        std::string_view _nameOrAlias,
+        ConstInfoPtr &_info,
+        std::shared_ptr<void> &_dlHandle,
+        std::string &_deferredLibrary) const;
+
+      /// \brief Drop every entry of resolvedNames. This must be called
+      /// whenever `plugins`, `aliases` or `pluginToDlHandlePtrs` change,
+      /// which only happens while `mutex` is locked uniquely.
+      public: void InvalidateResolvedNames();
+
+      /// \brief Guards every member variable of this class. Functions which
+      /// only read from the registry lock it in shared mode, so any number of
+      /// threads can look up and instantiate plugins at the same time.
+      /// LoadLib and ForgetLibrary lock it uniquely, but only while they merge
+      /// their results into (or remove them from) the registry. Opening the
+      /// library and invoking its hook happens outside of this lock.
+      public: mutable std::shared_mutex mutex;
+
+      /// \brief The number of LoadLibAsync tasks which have not finished yet.
+      /// The destructor of the Loader waits for this to reach zero.
+      public: std::size_t pendingAsyncLoads = 0;
+
+      /// \brief Guards pendingAsyncLoads
+      public: std::mutex asyncMutex;
+
+      /// \brief Notified whenever a LoadLibAsync task finishes
+      public: std::condition_variable asyncFinished;
+
+      /// \brief The manifest cache which is being used by this Loader
+      public: Manifest manifestCache;
+
+      /// \brief Path to the file of the manifest cache. Empty if no cache is
+      /// being used.
+      public: std::string manifestCacheFile;
+
+      /// \brief True if the manifest cache has changed since it was read
+      public: bool manifestCacheDirty = false;
+
+      /// \brief Guards manifestCache, manifestCacheFile and
+      /// manifestCacheDirty. These are not part of the registry, so they are
+      /// not guarded by `mutex`.
+      public: std::mutex manifestMutex;
+
+      /// \brief The directories which FindLib() and LoadSearchPath() look in
+      public: LibraryIndex searchPath;
+
+      /// \brief Guards searchPath, which is not part of the registry
+      public: mutable std::mutex searchPathMutex;
+
+      /// \brief The function which receives diagnostic messages. If this is
+      /// empty, they are written to std::cerr.
+      public: Logger logger;
+
+      /// \brief The maximum number of diagnostic messages per second, or zero
+      /// for no limit
+      public: std::size_t maxLogMessagesPerSecond = 0;
+
+      /// \brief When the current one-second window of the rate limit began
+      public: mutable std::chrono::steady_clock::time_point logWindowStart;
+
+      /// \brief The number of messages produced in the current window
+      public: mutable std::size_t logMessagesInWindow = 0;
+
+      /// \brief The number of messages dropped since the last message that
+      /// was produced
+      public: mutable std::size_t droppedLogMessages = 0;
+
+      /// \brief Guards the logger and the state of its rate limit. Messages
+      /// are produced while this is locked, so the logger never gets called
+      /// by two threads at once.
+      public: mutable std::mutex logMutex;
+
+      /// \brief The names of the plugins and interfaces that the indexes
+      /// below refer to. See NameTable.
+      public: NameTable names;
+
+      public: using AliasMap =
+          std::unordered_map<std::string_view, SortedNameSet>;
+      /// \brief A map from known alias names to the plugin names that they
+      /// correspond to. Since an alias might refer to more than one plugin, the
+      /// value of this map is a sorted set of interned names. The keys are
+      /// interned as well, but they are hashed and compared by their contents,
+      /// so the map can be searched with any std::string_view. The map is not
+      /// ordered, so functions which print it need to sort its entries.
+      public: AliasMap aliases;
+
+      public: using PluginAliasMap = std::unordered_map<
+          std::string_view, SortedNameSet, InternedHash, InternedEqual>;
+      /// \brief The interned aliases of each plugin, keyed by the interned
+      /// name of the plugin, so that AliasesOfPluginView() can hand them out
+      /// without copying the aliases of the Info.
+      public: PluginAliasMap pluginAliases;
+
+      /// \brief The interned aliases which refer to more than one plugin.
+      /// This is kept up to date by AddAlias() and RemoveAlias(), so the
+      /// collisions are found once, when the plugins are registered.
+      public: SortedNameSet aliasCollisions;
+
+      /// \brief The collisions which have not been reported yet, because a
+      /// batch of changes is being committed
+      public: SortedNameSet unreportedCollisions;
+
+      /// \brief True while a batch of changes is being committed, so that
+      /// its collisions are only reported once the batch is complete
+      public: bool deferCollisionReports = false;
+
+      /// \brief Report the collisions of `unreportedCollisions` which still
+      /// exist to the logger, each with the plugins that it refers to now
+      public: void ReportAliasCollisions();
+
+      /// \brief Make an alias refer to a plugin, and report the alias if
+      /// this makes it refer to more than one plugin
+      /// \param[in] _alias The interned alias
+      /// \param[in] _plugin The interned name of the plugin
+      public: void AddAlias(std::string_view _alias, std::string_view _plugin);
+
+      /// \brief Stop an alias from referring to a plugin, and drop the alias
+      /// once it no longer refers to any plugin
+      /// \param[in] _alias The alias
+      /// \param[in] _plugin The name of the plugin
+      public: void RemoveAlias(
+          std::string_view _alias, std::string_view _plugin);
+
+      /// \brief Get the aliases which refer to more than one plugin
+      /// \return The entries of `aliases` for those aliases, sorted by alias
+      public: std::vector<const AliasMap::value_type*> AliasCollisions() const;
+
+      public: using PluginToDlHandleMap =
+          std::unordered_map< std::string, std::shared_ptr<void> >;
+      /// \brief A map from known plugin names to the handle of the library that
+      /// provides it.
+      ///
+      /// CRUCIAL DEV NOTE (MXG): `pluginToDlHandlePtrs` MUST come BEFORE
+      /// `plugins` in this class definition to ensure that `plugins` gets
+      /// deleted first (member variables get destructed in the reverse order of
+      /// their appearance in the class definition). The `factory`, `deleter`
+      /// and interface casters of the Info class point into the shared
+      /// library, so this map of std::shared_ptrs to the library handles must
+      /// be destroyed after the Info.
+      ///
+      /// If you change this class definition for ANY reason, be sure to
+      /// maintain the ordering of these member variables.
+      public: PluginToDlHandleMap pluginToDlHandlePtrs;
+
+      /// \brief A map from known plugin names to their Info
+      ///
+      /// Each key is a view of the `name` of the Info that it maps to, so the
+      /// map can be searched with a std::string_view without allocating a
+      /// std::string. The Info is immutable and is kept alive by the map
+      /// entry, so the key stays valid for as long as the entry exists. When
+      /// the Info of an entry needs to be replaced, the entry must be erased
+      /// and inserted again, so that the key views the name of the new Info.
+      ///
+      /// CRUCIAL DEV NOTE (MXG): `plugins` MUST come AFTER
+      /// `pluginToDlHandlePtrs` in this class definition. See the comment on
+      /// pluginToDlHandlePtrs for an explanation.
+      ///
+      /// If you change this class definition for ANY reason, be sure to
+      /// maintain the ordering of these member variables.
+      public: PluginMap plugins;
+
+      /// \brief What a name or alias which has been looked up before resolved
+      /// to, see resolvedNames.
+      public: struct ResolvedName
+      {
+        /// \brief The status that ResolvePlugin produced
+        LookupStatus status;
+
+        /// \brief The entry of `plugins`, or plugins.end() if the name could
+        /// not be resolved
+        PluginMap::const_iterator plugin;
+
+        /// \brief The entry of `pluginToDlHandlePtrs` for the plugin, or
+        /// nullptr if its library has not been opened yet. The nodes of an
+        /// unordered_map never move, so this stays valid until the entry is
+        /// erased.
+        const std::shared_ptr<void> *dlHandle;
+      };
+
+      /// \brief The names and aliases which have been looked up, along with
+      /// what they resolved to. Names which could not be resolved, because
+      /// they are unknown or ambiguous, get an entry too, so spawners which
+      /// keep asking for the same name only need a single hash lookup. This
+      /// is cleared by InvalidateResolvedNames whenever the registry changes,
+      /// and whenever it reaches maxResolvedNames entries, so that looking up
+      /// arbitrary names cannot grow it without bound. Its keys view the
+      /// strings of resolvedNameStorage.
+      public: mutable std::unordered_map<std::string_view, ResolvedName>
+          resolvedNames;
+
+      /// \brief The strings which the keys of resolvedNames view
+      public: mutable std::deque<std::string> resolvedNameStorage;
+
+      /// \brief The number of entries at which resolvedNames gets cleared
+      public: static constexpr std::size_t maxResolvedNames = 4096;
+
+      /// \brief Guards resolvedNames and resolvedNameStorage, since they are
+      /// filled in by lookups which only lock `mutex` in shared mode.
+      public: mutable std::shared_mutex resolvedNamesMutex;
+
+      /// \brief Get what a name or alias resolves to, from resolvedNames if
+      /// it has been looked up before.
+      /// \param[in] _nameOrAlias The name or alias of the plugin
+      /// \return What the name resolves to
+      public: ResolvedName ResolveName(
+        std::string_view _nameOrAlias) const;
+
+      /// \brief What this Loader knows about a library that it has opened
+      public: struct OpenLibrary
+      {
+        /// \brief The interned names of the plugins that the library provides
+        InternedNameSet plugins;
+
+        /// \brief The canonical paths that the library is recorded under in
+        /// loadedLibraries. This is usually a single path.
+        std::vector<std::string> paths;
+
+        /// \brief The reference to the library which is handed out to
+        /// plugin instances and PluginHandles. It holds a reference of its own
+        /// to the library, so its use count tells how many of those are alive.
+        std::shared_ptr<void> handle;
+
+        /// \brief When one of the plugins of the library was last looked up
+        /// for instantiation, according to `useClock`. This is only kept up
+        /// to date while an eviction policy is set.
+        mutable std::atomic<std::uint64_t> lastUsed{0};
+
+        /// \brief The allocation account of the library, see
+        /// Loader::SetAllocationAccounting()
+        AllocationAccount *account = nullptr;
+      };
+
+      public: using DlHandleToPluginMap =
+          std::unordered_map<void*, OpenLibrary>;
+      /// \brief A map from the shared library handle to the plugins that it
+      /// provides and the paths that it was loaded from, so that forgetting a
+      /// library only needs to visit its own entries.
+      public: DlHandleToPluginMap dlHandleToPluginMap;
+
+      /// \brief Count the references to a library which are held by plugin
+      /// instances and PluginHandles, i.e. outside of this Loader.
+      /// \param[in] _library The library
+      /// \return The number of references
+      public: std::size_t ExternalReferences(
+        const OpenLibrary &_library) const;
+
+      /// \brief Describe a library that has been opened, so that its plugins
+      /// can be deferred to it. `mutex` must be locked.
+      /// \param[in] _library The library
+      /// \param[out] _options The options that the library was opened with
+      /// \return The description of the library
+      public: ManifestLibrary DescribeOpenLib(
+        const OpenLibrary &_library, LoadOptions &_options) const;
+
+      /// \brief A library that has been forgotten while references to it
+      /// were still alive
+      public: struct ForgottenLibrary
+      {
+        /// \brief The canonical path that the library was loaded from
+        std::string path;
+
+        /// \brief The reference which was handed out to plugin instances and
+        /// PluginHandles. This expires once all of them are gone.
+        std::weak_ptr<void> handle;
+      };
+
+      /// \brief The libraries that have been forgotten but are still open.
+      /// Entries are dropped once their handle has expired.
+      public: std::vector<ForgottenLibrary> forgottenLibraries;
+
+      public: using InterfaceIndex = std::unordered_map<
+          std::string_view, DenseNameSet, InternedHash, InternedEqual>;
+      /// \brief A map from the mangled names of interfaces to the names of the
+      /// plugins that implement them. This is kept up to date by LoadLib and
+      /// ForgetLibrary so that PluginsImplementing does not need to scan every
+      /// plugin. Every name in the index is interned by `names`, so a name
+      /// needs to be interned before it can be searched for.
+      public: InterfaceIndex interfaceIndex;
+
+      /// \brief Same as interfaceIndex, but keyed by the demangled names of
+      /// the interfaces.
+      public: InterfaceIndex demangledInterfaceIndex;
+
+      /// \brief The interfaces of each plugin as a bitset, for finding the
+      /// plugins that implement several interfaces at once. This is kept up
+      /// to date together with interfaceIndex.
+      public: InterfaceBitTable interfaceBits;
+
+      /// \brief Same as interfaceBits, but for the demangled names of the
+      /// interfaces.
+      public: InterfaceBitTable demangledInterfaceBits;
+
+      /// \brief The demangled names of every interface that is implemented by
+      /// at least one known plugin. This mirrors the keys of
+      /// demangledInterfaceIndex so that InterfacesImplemented() can return it
+      /// by reference.
+      public: std::unordered_set<std::string> interfacesImplemented;
+
+      /// \brief The names of all known plugins, kept sorted so that
+      /// AllPlugins() can return it by reference.
+      public: std::set<std::string> pluginNames;
+
+      public: using DeferredPluginMap =
+          std::unordered_map<std::string, std::string>;
+      /// \brief A map from the names of plugins whose library has not been
+      /// opened yet to the canonical path of that library. The `plugins` map
+      /// holds an Info for each of these plugins which only contains their
+      /// metadata, so it must not be used for instantiation.
+      public: DeferredPluginMap deferredPlugins;
+
+      /// \brief A library that has not been opened yet
+      public: struct DeferredLibrary
+      {
+        /// \brief The names of the plugins that are deferred to the library
+        std::unordered_set<std::string> plugins;
+
+        /// \brief The options to use when the library gets opened
+        LoadOptions options;
+
+        /// \brief The modification time of the library file when its plugins
+        /// were described
+        std::int64_t modificationTime = 0;
+
+        /// \brief The size of the library file when its plugins were
+        /// described
+        std::uint64_t fileSize = 0;
+
+        /// \brief The build-id of the library, if it is known
+        std::string buildId;
+      };
+
+      public: using DeferredLibraryMap =
+          std::unordered_map<std::string, DeferredLibrary>;
+      /// \brief A map from the canonical paths of libraries that have not been
+      /// opened yet to the plugins that are deferred to them.
+      public: DeferredLibraryMap deferredLibraries;
+
+      /// \brief A library that has been opened and committed to the registry
+      public: struct LoadedLibrary
+      {
+        /// \brief The handle of the library. When the library has been
+        /// reloaded, this is the handle of its newest version.
+        void *dlHandle = nullptr;
+
+        /// \brief The options that the library was opened with
+        LoadOptions options;
+
+        /// \brief The modification time of the library file when it was
+        /// opened
+        std::int64_t modificationTime = 0;
+
+        /// \brief The size of the library file when it was opened
+        std::uint64_t fileSize = 0;
+      };
+
+      public: using LoadedLibraryMap =
+          std::unordered_map<std::string, LoadedLibrary>;
+      /// \brief A map from the canonical paths of the libraries that have been
+      /// committed to the registry to their handles and file stamps. This is
+      /// what ReloadLib uses to tell whether a library has changed.
+      public: LoadedLibraryMap loadedLibraries;
+
+      /// \brief The number of private copies of library files that ReloadLib
+      /// has made, used to give each copy a distinct name
+      public: std::atomic<std::size_t> reloadCount{0};
+
+      /// \brief The options that are used whenever a library is loaded
+      /// without specifying any.
+      public: LoadOptions defaultLoadOptions;
+
+      /// \brief The budget for the libraries that are kept open
+      public: EvictionPolicy evictionPolicy;
+
+      /// \brief Ticks whenever a library is used, to order the libraries from
+      /// least to most recently used
+      public: mutable std::atomic<std::uint64_t> useClock{0};
+
+      /// \brief The instance pools of the plugins which have one, by the
+      /// name of the plugin. See Loader::SetInstancePool().
+      public: std::unordered_map<std::string, std::shared_ptr<InstancePool>>
+          instancePools;
+
+      /// \brief The number of entries in instancePools, so that plugins can
+      /// be instantiated without locking instancePoolsMutex when no plugin
+      /// has a pool.
+      public: std::atomic<std::size_t> instancePoolCount{0};
+
+      /// \brief Guards instancePools. This is separate from `mutex` because
+      /// the pools are used after a plugin has been looked up.
+      public: mutable std::mutex instancePoolsMutex;
+
+      /// \brief True if the memory of plugins is attributed to their
+      /// libraries. See Loader::SetAllocationAccounting().
+      public: std::atomic<bool> allocationAccounting{false};
+
+      /// \brief Refers to the Loader itself. PluginHandles keep a weak
+      /// reference to this, so that they instantiate through the Loader for
+      /// as long as it exists. See Loader::Resolve().
+      public: std::shared_ptr<const Loader *> self;
+
+      /// \brief True if Loader::Factory() caches its instances. See
+      /// Loader::SetFactoryCaching().
+      public: std::atomic<bool> factoryCaching{false};
+
+      /// \brief The instances which Loader::Factory() hands out, by the name
+      /// of their plugin. The keys view the names in the Info of the
+      /// instances, which the instances keep alive.
+      public: mutable std::unordered_map<std::string_view, PluginPtr>
+          factories;
+
+      /// \brief Guards factories. When both are needed, `mutex` must be
+      /// locked first.
+      public: mutable std::shared_mutex factoriesMutex;
+
+      /// \brief The instances which are waiting to be destroyed, see
+      /// Loader::Discard(). This is declared last, so that the instances are
+      /// destroyed while the rest of the Loader still exists.
+      public: mutable DestructionQueue destructionQueue;
+    };
+
+    /////////////////////////////////////////////////
+    std::string Loader::PrettyStr() const
+    {
+      std::stringstream pretty;
+      this->PrettyPrint(pretty);
+      return pretty.str();
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::PrettyPrint(std::ostream &_out) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const auto &interfaces = this->dataPtr->interfacesImplemented;
+      _out << "Loader State\n";
+      _out << "\tKnown Interfaces: " << interfaces.size() << "\n";
+      for (auto const &interface : interfaces)
+        _out << "\t\t" << interface << "\n";
+
+      _out << "\tKnown Plugins: " << dataPtr->plugins.size() << "\n";
+      for (const auto &pair : dataPtr->plugins)
+      {
+        const ConstInfoPtr &plugin = pair.second;
+        const std::size_t aSize = plugin->aliases.size();
+
+        _out << "\t\t[" << plugin->name << "]\n";
+        if (0 < aSize)
+        {
+          _out << "\t\t\thas "
+               << aSize << (aSize == 1? " alias" : " aliases") << ":\n";
+          for (const auto &alias : plugin->aliases)
+            _out << "\t\t\t\t[" << alias << "]\n";
+        }
+        else
+        {
+          _out << "\t\t\thas no aliases\n";
+        }
+
+        const std::size_t fSize = plugin->requiredFeatures.size();
+        if (0 < fSize)
+        {
+          _out << "\t\t\trequires " << fSize
+               << (fSize == 1? " CPU feature" : " CPU features") << ":\n";
+          for (const auto &feature : plugin->requiredFeatures)
+            _out << "\t\t\t\t[" << feature << "]\n";
+        }
+
+        const std::size_t iSize = plugin->interfaces.size();
+        _out << "\t\t\timplements " << iSize
+             << (iSize == 1? " interface" : " interfaces") << ":\n";
+        for (const auto &interface : plugin->demangledInterfaces)
+          _out << "\t\t\t\t" << interface << "\n";
+      }
+
+      const std::vector<const Implementation::AliasMap::value_type*>
+          collisions = this->dataPtr->AliasCollisions();
+      const std::size_t aSize = collisions.size();
+
+      if (0 < aSize)
+      {
+        _out << "\tThere " << (aSize == 1? "is " : "are ")  << aSize
+             << (aSize == 1? " alias" : " aliases") << " with a "
+             << "name collision:\n";
+        for (const auto *alias : collisions)
+        {
+          _out << "\t\t[" << alias->first << "] collides between:\n";
+          for (const auto &name : alias->second)
+            _out << "\t\t\t[" << name << "]\n";
+        }
+      }
+
+      _out << std::endl;
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::WriteJson(std::ostream &_out) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      // Writes the elements of a range as a JSON array of strings
+      const auto writeArray = [&_out](const auto &_range)
+      {
+        _out << '[';
+        bool first = true;
+        for (const auto &element : _range)
+        {
+          if (!first)
+            _out << ',';
+          first = false;
+          WriteJsonString(_out, element);
+        }
+        _out << ']';
+      };
+
+      _out << "{\"interfaces\":";
+      writeArray(this->dataPtr->interfacesImplemented);
+
+      _out << ",\"plugins\":[";
+      bool firstPlugin = true;
+      for (const auto &pair : this->dataPtr->plugins)
+      {
+        const Info &plugin = *pair.second;
+
+        if (!firstPlugin)
+          _out << ',';
+        firstPlugin = false;
+
+        _out << "{\"name\":";
+        WriteJsonString(_out, plugin.name);
+        _out << ",\"aliases\":";
+        writeArray(plugin.aliases);
+        _out << ",\"interfaces\":";
+        writeArray(plugin.demangledInterfaces);
+        _out << ",\"requiredFeatures\":";
+        writeArray(plugin.requiredFeatures);
+
+        // Plugins which are linked into the program, or whose library has
+        // not been opened yet, have no library to report.
+        _out << ",\"library\":";
+        const std::string *path = nullptr;
+        const auto handle =
+            this->dataPtr->pluginToDlHandlePtrs.find(plugin.name);
+        if (handle != this->dataPtr->pluginToDlHandlePtrs.end())
+        {
+          const auto library =
+              this->dataPtr->dlHandleToPluginMap.find(handle->second.get());
+          if (library != this->dataPtr->dlHandleToPluginMap.end() &&
+              !library->second.paths.empty())
+          {
+            path = &library->second.paths.front();
+          }
+        }
+
+        if (path)
+          WriteJsonString(_out, *path);
+        else
+          _out << "null";
+
+        _out << '}';
+      }
+
+      _out << "],\"aliasCollisions\":{";
+      bool firstAlias = true;
+      for (const auto *alias : this->dataPtr->AliasCollisions())
+      {
+        if (!firstAlias)
+          _out << ',';
+        firstAlias = false;
+
+        WriteJsonString(_out, alias->first);
+        _out << ':';
+        writeArray(alias->second);
+      }
+
+      _out << "}}";
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Loader()
+      : dataPtr(new Implementation())
+    {
+      this->dataPtr->self = std::make_shared<const Loader *>(this);
+    }
+
+    /////////////////////////////////////////////////
+    Loader::~Loader()
+    {
+      // Asynchronous loads refer to this Loader, so they must finish before
+      // we can be destroyed.
+      std::unique_lock<std::mutex> lock(this->dataPtr->asyncMutex);
+      this->dataPtr->asyncFinished.wait(
+            lock, [&]() { return 0 == this->dataPtr->pendingAsyncLoads; });
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadLib(
+        const std::string &_pathToLibrary)
+    {
+      return this->LoadLib(_pathToLibrary, this->DefaultLoadOptions());
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadLib(
+        const std::string &_pathToLibrary,
+        const LoadOptions &_options)
+    {
+      detail::TraceScope trace("LoadLib", _pathToLibrary);
+
+      // If the manifest cache already knows what this library provides, we
+      // can skip opening it until one of its plugins is needed.
+      ManifestLibrary cached;
+      if (this->dataPtr->FindCachedLib(_pathToLibrary, cached))
+      {
+        std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+        return this->dataPtr->RegisterDeferredLib(cached, _options);
+      }
+
+      return this->dataPtr->StageAndCommitLib(_pathToLibrary, _options);
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::ScanLib(
+        const std::string &_pathToLibrary)
+    {
+      ManifestLibrary embedded;
+      if (!ReadEmbeddedMetadata(_pathToLibrary, embedded))
+        return this->LoadLib(_pathToLibrary);
+
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->RegisterDeferredLib(
+            embedded, this->dataPtr->defaultLoadOptions);
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::SetDefaultLoadOptions(const LoadOptions &_options)
+    {
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      this->dataPtr->defaultLoadOptions = _options;
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::SetEvictionPolicy(const EvictionPolicy &_policy)
+    {
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      this->dataPtr->evictionPolicy = _policy;
+      this->dataPtr->EvictIdleLibraries(nullptr);
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t Loader::EvictIdleLibraries()
+    {
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->EvictIdleLibraries(nullptr);
+    }
+
+    /////////////////////////////////////////////////
+    LoadOptions Loader::DefaultLoadOptions() const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->defaultLoadOptions;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadManifest(
+        const std::string &_manifestFile)
+    {
+      return this->LoadManifest(_manifestFile, {});
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadManifest(
+        const std::string &_manifestFile,
+        const std::vector<std::string> &_pathsToLibraries)
+    {
+      Manifest manifest;
+      if (!manifest.Read(_manifestFile))
+      {
+        this->dataPtr->Log(
+              "[ignition::plugin::Loader::LoadManifest] Failed to read the "
+              "manifest [", _manifestFile, "]\n");
+        return {};
+      }
+
+      std::vector<std::string> outdated;
+      std::unordered_set<std::string> newPlugins =
+          this->dataPtr->RegisterManifest(
+            manifest, _pathsToLibraries, outdated);
+
+      if (!outdated.empty())
+      {
+        const std::unordered_set<std::string> plugins =
+            this->LoadLibs(outdated);
+        newPlugins.insert(plugins.begin(), plugins.end());
+      }
+
+      return newPlugins;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadManifestData(
+        const std::string &_contents,
+        const std::vector<std::string> &_pathsToLibraries)
+    {
+      std::istringstream in(_contents);
+      Manifest manifest;
+      if (!manifest.Read(in, std::string()))
+      {
+        this->dataPtr->Log(
+              "[ignition::plugin::Loader::LoadManifestData] Failed to read "
+              "the manifest\n");
+        return {};
+      }
+
+      std::vector<std::string> outdated;
+      std::unordered_set<std::string> newPlugins =
+          this->dataPtr->RegisterManifest(
+            manifest, _pathsToLibraries, outdated);
+
+      if (!outdated.empty())
+      {
+        const std::unordered_set<std::string> plugins =
+            this->LoadLibs(outdated);
+        newPlugins.insert(plugins.begin(), plugins.end());
+      }
+
+      return newPlugins;
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t Loader::FlushUnloadQueue()
+    {
+      return UnloadQueue::Get().Flush();
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::SetBackgroundUnloading(const bool _enabled)
+    {
+      UnloadQueue::Get().SetBackground(_enabled);
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Discard(PluginPtr &&_plugin) const
+    {
+      std::vector<PluginPtr> batch;
+      batch.push_back(std::move(_plugin));
+      this->dataPtr->destructionQueue.Post(std::move(batch));
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Discard(std::vector<PluginPtr> &&_plugins) const
+    {
+      this->dataPtr->destructionQueue.Post(std::move(_plugins));
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t Loader::FlushDestructionQueue() const
+    {
+      return this->dataPtr->destructionQueue.Flush();
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::SetDestructionWorkers(const std::size_t _count)
+    {
+      this->dataPtr->destructionQueue.SetWorkers(_count);
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t Loader::DestructionWorkers() const
+    {
+      return this->dataPtr->destructionQueue.Workers();
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::WriteManifest(
+        const std::string &_manifestFile,
+        const std::vector<std::string> &_pathsToLibraries)
+    {
+      // We use a separate Implementation so that this does not interfere with
+      // any Loader. The libraries will be closed again once it is destroyed.
+      Implementation impl;
+
+      Manifest manifest;
+      bool success = true;
+      for (const std::string &path : _pathsToLibraries)
+      {
+        const Implementation::StagedLibrary staged =
+            impl.StageLib(path, LoadOptions());
+
+        ManifestLibrary library;
+        if (nullptr == staged.dlHandle ||
+            !Implementation::DescribeLib(path, staged, library))
+        {
+          success = false;
+          continue;
+        }
+
+        manifest.Insert(std::move(library));
+      }
+
+      return manifest.Write(_manifestFile) && success;
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::MergeManifests(
+        const std::string &_manifestFile,
+        const std::vector<std::string> &_manifestFiles)
+    {
+      Manifest merged;
+      bool success = true;
+      for (const std::string &file : _manifestFiles)
+      {
+        Manifest manifest;
+        if (!manifest.Read(file))
+        {
+          std::cerr << "[ignition::plugin::Loader::MergeManifests] Failed to "
+                    << "read the manifest [" << file << "]\n";
+          success = false;
+          continue;
+        }
+
+        for (auto &entry : manifest.libraries)
+          merged.Insert(std::move(entry.second));
+      }
+
+      return merged.Write(_manifestFile) && success;
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::SaveManifest(const std::string &_manifestFile) const
+    {
+      Manifest manifest;
+      {
+        std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+        for (const auto &entry : this->dataPtr->dlHandleToPluginMap)
+        {
+          // The plugins which are linked into the program do not have a
+          // library to defer to.
+          if (entry.second.paths.empty())
+            continue;
+
+          LoadOptions options;
+          ManifestLibrary described =
+              this->dataPtr->DescribeOpenLib(entry.second, options);
+          described.buildId = ReadBuildId(described.path);
+          manifest.Insert(std::move(described));
+        }
+
+        for (const auto &entry : this->dataPtr->deferredLibraries)
+        {
+          ManifestLibrary described;
+          described.path = entry.first;
+          described.modificationTime = entry.second.modificationTime;
+          described.fileSize = entry.second.fileSize;
+          described.buildId = entry.second.buildId;
+
+          for (const std::string &name : entry.second.plugins)
+          {
+            const auto plugin = this->dataPtr->plugins.find(name);
+            if (this->dataPtr->plugins.end() != plugin)
+              described.plugins.push_back(ManifestPlugin::FromInfo(
+                    *plugin->second));
+          }
+
+          manifest.Insert(std::move(described));
+        }
+      }
+
+      return manifest.Write(_manifestFile);
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::SetManifestCache(const std::string &_cacheFile)
+    {
+      std::unique_lock<std::mutex> lock(this->dataPtr->manifestMutex);
+      this->dataPtr->manifestCacheFile = _cacheFile;
+      this->dataPtr->manifestCacheDirty = false;
+
+      // A missing or unreadable cache simply starts out empty.
+      if (!_cacheFile.empty())
+        this->dataPtr->manifestCache.Read(_cacheFile);
+      else
+        this->dataPtr->manifestCache.Clear();
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::SaveManifestCache() const
+    {
+      std::unique_lock<std::mutex> lock(this->dataPtr->manifestMutex);
+      if (this->dataPtr->manifestCacheFile.empty())
+        return false;
+
+      if (!this->dataPtr->manifestCacheDirty)
+        return true;
+
+      if (!this->dataPtr->manifestCache.Write(
+            this->dataPtr->manifestCacheFile))
+        return false;
+
+      this->dataPtr->manifestCacheDirty = false;
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    std::future<std::unordered_set<std::string>> Loader::LoadLibAsync(
+        const std::string &_pathToLibrary)
+    {
+      {
+        std::unique_lock<std::mutex> lock(this->dataPtr->asyncMutex);
+        ++this->dataPtr->pendingAsyncLoads;
+      }
+
+      return std::async(std::launch::async, [this, _pathToLibrary]()
+      {
+        // Let the destructor of the Loader know when we are done, even if the
+        // load is somehow interrupted by an exception.
+        struct Finished
+        {
+          Implementation *impl;
+          ~Finished()
+          {
+            std::unique_lock<std::mutex> lock(impl->asyncMutex);
+            --impl->pendingAsyncLoads;
+            impl->asyncFinished.notify_all();
+          }
+        } finished{this->dataPtr.get()};
+
+        return this->LoadLib(_pathToLibrary);
+      });
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadLibs(
+        const std::vector<std::string> &_pathsToLibraries)
+    {
+      std::vector<Transaction::Change> changes;
+      changes.reserve(_pathsToLibraries.size());
+      for (const std::string &path : _pathsToLibraries)
+        changes.push_back(Transaction::Change{path, false});
+
+      return this->CommitChanges(changes);
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Transaction Loader::BeginTransaction()
+    {
+      return Transaction(*this);
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Transaction::Transaction(Loader &_loader)
+      : loader(&_loader)
+    {
+      // Do nothing
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Transaction &Loader::Transaction::LoadLib(
+        const std::string &_pathToLibrary)
+    {
+      this->changes.push_back(Change{_pathToLibrary, false});
+      return *this;
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Transaction &Loader::Transaction::ForgetLibrary(
+        const std::string &_pathToLibrary)
+    {
+      this->changes.push_back(Change{_pathToLibrary, true});
+      return *this;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::Transaction::Commit()
+    {
+      const std::vector<Change> committed = std::move(this->changes);
+      this->changes.clear();
+      return this->loader->CommitChanges(committed);
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::CommitChanges(
+        const std::vector<Transaction::Change> &_changes)
+    {
+      std::vector<Implementation::StagedLibrary> staged(_changes.size());
+
+      // Libraries which are described by the manifest cache do not need to be
+      // opened at all.
+      std::vector<bool> isCached(_changes.size(), false);
+      std::vector<ManifestLibrary> cached(_changes.size());
+
+      // Libraries which get forgotten are looked up by their canonical path,
+      // which is worked out here, since that inspects the file system.
+      std::vector<std::string> forgotten(_changes.size());
+
+      const LoadOptions options = this->DefaultLoadOptions();
+
+      // Open the libraries and extract their Info on a set of worker threads.
+      // Each worker keeps taking the next library from the list until there
+      // are none left.
+      std::atomic<std::size_t> next(0);
+      const auto stage = [&]()
+      {
+        for (std::size_t i = next++; i < _changes.size(); i = next++)
+        {
+          const std::string &path = _changes[i].path;
+          if (_changes[i].forget)
+          {
+            forgotten[i] = CanonicalLibraryPath(path);
+            continue;
+          }
+
+          if (this->dataPtr->FindCachedLib(path, cached[i]))
+          {
+            isCached[i] = true;
+            continue;
+          }
+
+          // The dynamic linker opens one library at a time, so the workers
+          // which wait for it can already get their files read in.
+          if (_changes.size() > 1)
+            ReadAheadLibrary(path);
+
+          staged[i] = this->dataPtr->StageLib(path, options);
+          if (staged[i].dlHandle)
+            this->dataPtr->CacheLib(path, staged[i]);
+        }
+      };
+
+      // Meanwhile, another thread asks the operating system to start reading
+      // the files of the libraries which no worker has taken yet, so that
+      // reading them from storage overlaps with opening the libraries before
+      // them, even if there are fewer workers than libraries. Libraries that
+      // the manifest cache describes are skipped, since they are not opened.
+      const auto readAhead = [&]()
+      {
+        ManifestLibrary scratch;
+        for (std::size_t i = next; i < _changes.size();
+             i = std::max(i + 1, next.load()))
+        {
+          const std::string &path = _changes[i].path;
+          if (!_changes[i].forget &&
+              !this->dataPtr->FindCachedLib(path, scratch))
+          {
+            ReadAheadLibrary(path);
+          }
+        }
+      };
+
+      const std::size_t numWorkers = std::min<std::size_t>(
+            _changes.size(),
+            std::max(1u, std::thread::hardware_concurrency()));
+
+      std::thread reader;
+      if (numWorkers < _changes.size())
+        reader = std::thread(readAhead);
+
+      // The current thread acts as one of the workers.
+      std::vector<std::thread> workers;
+      for (std::size_t i = 1; i < numWorkers; ++i)
+        workers.emplace_back(stage);
+
+      stage();
+
+      for (std::thread &worker : workers)
+        worker.join();
+
+      if (reader.joinable())
+        reader.join();
+
+      // Commit all the results to the registry in one step, in the same order
+      // that the changes were listed. The alias collisions are reported once
+      // all of the changes are in, so that each collision is only reported
+      // with the final set of plugins that it refers to.
+      std::unordered_set<std::string> newPlugins;
+
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      this->dataPtr->deferCollisionReports = true;
+      for (std::size_t i = 0; i < _changes.size(); ++i)
+      {
+        std::unordered_set<std::string> plugins;
+        if (_changes[i].forget)
+          this->dataPtr->ForgetLibraryPath(forgotten[i]);
+        else if (isCached[i])
+          plugins = this->dataPtr->RegisterDeferredLib(cached[i], options);
+        else if (staged[i].dlHandle)
+          plugins = this->dataPtr->CommitLib(staged[i]);
+
+        newPlugins.insert(plugins.begin(), plugins.end());
+      }
+
+      this->dataPtr->deferCollisionReports = false;
+      this->dataPtr->ReportAliasCollisions();
+
+      return newPlugins;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadDirectory(
+        const std::string &_directory)
+    {
+      std::error_code ec;
+      const std::vector<std::string> libraries =
+          ListLibraries(_directory, ec);
+
+      if (ec)
+      {
+        this->dataPtr->Log(
+              "[ignition::plugin::Loader::LoadDirectory] Error while reading "
+              "the directory [", _directory, "]: ", ec.message(), "\n");
+      }
+
+      return this->LoadListedLibs(libraries);
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::AddSearchPath(const std::string &_directory)
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->searchPathMutex);
+      return this->dataPtr->searchPath.AddDirectory(_directory);
+    }
+
+    /////////////////////////////////////////////////
+    std::string Loader::FindLib(std::string_view _libraryName) const
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->searchPathMutex);
+      return this->dataPtr->searchPath.Find(_libraryName);
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadSearchPath()
+    {
+      std::vector<std::string> libraries;
+      {
+        std::lock_guard<std::mutex> lock(this->dataPtr->searchPathMutex);
+        libraries = this->dataPtr->searchPath.Libraries();
+      }
+
+      return this->LoadListedLibs(libraries);
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadListedLibs(
+        const std::vector<std::string> &_libraries)
+    {
+      // Libraries which have an up to date sidecar manifest or which describe
+      // themselves with embedded metadata do not need to be opened until one
+      // of their plugins is instantiated.
+      std::unordered_set<std::string> newPlugins;
+      std::vector<std::string> toLoad;
+      for (const std::string &library : _libraries)
+      {
+        Manifest sidecar;
+        ManifestLibrary described;
+        bool isDescribed = false;
+        std::error_code sidecarError;
+        if (std::filesystem::is_regular_file(
+              library + Manifest::kSidecarSuffix, sidecarError) &&
+            sidecar.Read(library + Manifest::kSidecarSuffix))
+        {
+          isDescribed = sidecar.FindCurrent(library, described);
+        }
+
+        if (!isDescribed)
+          isDescribed = ReadEmbeddedMetadata(library, described);
+
+        if (!isDescribed)
+        {
+          toLoad.push_back(library);
+          continue;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+        const std::unordered_set<std::string> plugins =
+            this->dataPtr->RegisterDeferredLib(
+              described, this->dataPtr->defaultLoadOptions);
+        newPlugins.insert(plugins.begin(), plugins.end());
+      }
+
+      const std::unordered_set<std::string> plugins = this->LoadLibs(toLoad);
+      newPlugins.insert(plugins.begin(), plugins.end());
+
+      return newPlugins;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::LoadStaticPlugins()
+    {
+      // The static plugins are not provided by any library, but every plugin
+      // needs a handle that keeps its library alive. This one does nothing.
+      static int staticHandle = 0;
+
+      Implementation::StagedLibrary staged;
+      staged.dlHandle = std::shared_ptr<void>(&staticHandle, [](void *) {});
+
+      for (auto &entry : detail::StaticPlugins())
+      {
+        std::shared_ptr<Info> info =
+            std::make_shared<Info>(std::move(entry.second));
+        DemangleInfo(*info);
+        staged.plugins.push_back(std::move(info));
+      }
+
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->CommitLib(staged);
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::ReloadLib(
+        const std::string &_pathToLibrary)
+    {
+      ManifestLibrary stamp;
+      if (!ManifestLibrary::Stat(_pathToLibrary, stamp))
+      {
+        this->dataPtr->Log("[ignition::plugin::Loader::ReloadLib] Cannot "
+                           "reload the library [", _pathToLibrary, "], "
+                           "because its file cannot be inspected.\n");
+        return {};
+      }
+
+      LoadOptions options;
+      {
+        std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+        const Implementation::LoadedLibraryMap::const_iterator loaded =
+            this->dataPtr->loadedLibraries.find(stamp.path);
+        if (this->dataPtr->loadedLibraries.end() == loaded)
+        {
+          this->dataPtr->Log("[ignition::plugin::Loader::ReloadLib] The "
+                             "library [", _pathToLibrary, "] has not been "
+                             "loaded by this Loader, so it cannot be "
+                             "reloaded.\n");
+          return {};
+        }
+
+        if (loaded->second.modificationTime == stamp.modificationTime &&
+            loaded->second.fileSize == stamp.fileSize)
+          return {};
+
+        options = loaded->second.options;
+      }
+
+      // The dynamic loader would hand out the old version again if the new
+      // one were opened from the same path, so the new version gets opened
+      // from a private copy of the file. The copy can be removed as soon as
+      // it is open.
+      const std::filesystem::path file(stamp.path);
+      const std::filesystem::path copy =
+          std::filesystem::temp_directory_path() /
+          ("ign-plugin-reload-" + std::to_string(::getpid()) + "-" +
+           std::to_string(this->dataPtr->reloadCount++) + "-" +
+           file.filename().string());
+
+      std::error_code ec;
+      std::filesystem::copy_file(
+            file, copy, std::filesystem::copy_options::overwrite_existing, ec);
+      if (ec)
+      {
+        this->dataPtr->Log("[ignition::plugin::Loader::ReloadLib] Failed to "
+                           "copy the library [", _pathToLibrary, "] to [",
+                           copy.string(), "]: ", ec.message(), "\n");
+        return {};
+      }
+
+      Implementation::StagedLibrary staged =
+          this->dataPtr->StageLib(copy.string(), options);
+      std::filesystem::remove(copy, ec);
+
+      if (nullptr == staged.dlHandle)
+        return {};
+
+      staged.path = stamp.path;
+      staged.modificationTime = stamp.modificationTime;
+      staged.fileSize = stamp.fileSize;
+
+      // Swap the plugins of the old version for those of the new one while
+      // holding the lock, so that no lookup can see a mix of the two.
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      const Implementation::LoadedLibraryMap::const_iterator loaded =
+          this->dataPtr->loadedLibraries.find(stamp.path);
+      if (this->dataPtr->loadedLibraries.end() != loaded)
+        this->dataPtr->ForgetLibrary(loaded->second.dlHandle);
+
+      return this->dataPtr->CommitLib(staged);
+    }
+
+    /////////////////////////////////////////////////
+    const std::unordered_set<std::string> &Loader::InterfacesImplemented()
+        const
+    {
+      return this->dataPtr->interfacesImplemented;
+    }
+
+    /////////////////////////////////////////////////
+    std::vector<LibraryStatistics> Loader::Libraries() const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      std::vector<LibraryStatistics> libraries;
+      libraries.reserve(this->dataPtr->dlHandleToPluginMap.size() +
+                        this->dataPtr->forgottenLibraries.size());
+
+      for (const auto &entry : this->dataPtr->dlHandleToPluginMap)
+      {
+        const Implementation::OpenLibrary &library = entry.second;
+
+        LibraryStatistics statistics;
+        if (!library.paths.empty())
+          statistics.path = library.paths.front();
+
+        statistics.plugins = library.plugins.size();
+        statistics.references = this->dataPtr->ExternalReferences(library);
+        ReadAllocationAccount(library.account, statistics);
+        libraries.push_back(std::move(statistics));
+      }
+
+      for (const Implementation::ForgottenLibrary &library :
+           this->dataPtr->forgottenLibraries)
+      {
+        const std::shared_ptr<void> handle = library.handle.lock();
+        if (!handle)
+          continue;
+
+        LibraryStatistics statistics;
+        statistics.path = library.path;
+        statistics.references =
+            static_cast<std::size_t>(handle.use_count()) - 1;
+        statistics.forgotten = true;
+        ReadAllocationAccount(
+              AllocationAccounts::Get().Find(library.path), statistics);
+        libraries.push_back(std::move(statistics));
+      }
+
+      return libraries;
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::SetAllocationAccounting(const bool _enabled)
+    {
+      this->dataPtr->allocationAccounting.store(
+            _enabled, std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::AllocationAccounting() const
+    {
+      return this->dataPtr->allocationAccounting.load(
+            std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+    std::pmr::memory_resource *Loader::PrivateAllocationAccount(
+        const std::shared_ptr<void> &_dlHandle) const
+    {
+      if (!_dlHandle ||
+          !this->dataPtr->allocationAccounting.load(std::memory_order_relaxed))
+      {
+        return nullptr;
+      }
+
+      // A library which has been forgotten is no longer in the map, and
+      // whatever it still instantiates is not accounted for.
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      const auto library =
+          this->dataPtr->dlHandleToPluginMap.find(_dlHandle.get());
+      if (this->dataPtr->dlHandleToPluginMap.end() == library)
+        return nullptr;
+
+      return library->second.account;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::PluginsImplementing(
+        std::string_view _interface,
+        const bool demangled) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const Implementation::InterfaceIndex &index = demangled ?
+            this->dataPtr->demangledInterfaceIndex :
+            this->dataPtr->interfaceIndex;
+
+      const std::string_view interface =
+          this->dataPtr->names.Find(_interface);
+      if (nullptr == interface.data())
+        return {};
+
+      const Implementation::InterfaceIndex::const_iterator it =
+          index.find(interface);
+
+      if (index.end() == it)
+        return {};
+
+      std::unordered_set<std::string> plugins;
+      plugins.reserve(it->second.size());
+      for (const std::string_view plugin : it->second)
+        plugins.emplace(plugin);
+
+      return plugins;
+    }
+
+    /////////////////////////////////////////////////
+    NameView Loader::PluginsImplementingView(
+        std::string_view _interface,
+        const bool _demangled) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const Implementation::InterfaceIndex &index = _demangled ?
+            this->dataPtr->demangledInterfaceIndex :
+            this->dataPtr->interfaceIndex;
+
+      const std::string_view interface =
+          this->dataPtr->names.Find(_interface);
+      if (nullptr == interface.data())
+        return NameView();
+
+      const Implementation::InterfaceIndex::const_iterator it =
+          index.find(interface);
+
+      if (index.end() == it)
+        return NameView();
+
+      return NameView(std::move(lock), it->second.data(), it->second.size());
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::PluginsImplementingAll(
+        const std::vector<std::string_view> &_interfaces,
+        const bool _demangled) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      if (_interfaces.empty())
+      {
+        return std::unordered_set<std::string>(
+              this->dataPtr->pluginNames.begin(),
+              this->dataPtr->pluginNames.end());
+      }
+
+      InterfaceBitTable::Bits mask;
+      const InterfaceBitTable &table =
+          this->dataPtr->InterfaceMask(_interfaces, _demangled, mask);
+
+      // An interface which no plugin implements cannot be matched by all
+      if (mask.empty())
+        return {};
+
+      std::unordered_set<std::string> plugins;
+      table.ForEachMatchingAll(mask, [&](const std::string_view _plugin)
+      {
+        plugins.emplace(_plugin);
+      });
+
+      return plugins;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::PluginsImplementingAny(
+        const std::vector<std::string_view> &_interfaces,
+        const bool _demangled) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      InterfaceBitTable::Bits mask;
+      const InterfaceBitTable &table =
+          this->dataPtr->InterfaceMask(_interfaces, _demangled, mask, true);
+
+      std::unordered_set<std::string> plugins;
+      table.ForEachMatchingAny(mask, [&](const std::string_view _plugin)
+      {
+        plugins.emplace(_plugin);
+      });
+
+      return plugins;
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::PluginImplements(
+        std::string_view _plugin,
+        std::string_view _interface,
+        const bool _demangled) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const std::string_view plugin = this->dataPtr->names.Find(_plugin);
+      const std::string_view interface =
+          this->dataPtr->names.Find(_interface);
+      if (nullptr == plugin.data() || nullptr == interface.data())
+        return false;
+
+      const InterfaceBitTable &table = _demangled ?
+            this->dataPtr->demangledInterfaceBits :
+            this->dataPtr->interfaceBits;
+
+      return table.Test(plugin, interface);
+    }
+
+    /////////////////////////////////////////////////
+    const std::set<std::string> &Loader::AllPlugins() const
+    {
+      return this->dataPtr->pluginNames;
+    }
+
+    /////////////////////////////////////////////////
+    std::set<std::string> Loader::PluginsWithAlias(
+        std::string_view _alias) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      std::set<std::string> result;
+
+      const Implementation::AliasMap::const_iterator names =
+          this->dataPtr->aliases.find(_alias);
+
+      if (names != this->dataPtr->aliases.end())
+        result.insert(names->second.begin(), names->second.end());
+
+      const Implementation::PluginMap::const_iterator plugin =
+          this->dataPtr->plugins.find(_alias);
+
+      if (plugin != this->dataPtr->plugins.end())
+        result.insert(plugin->second->name);
+
+      return result;
+    }
+
+    /////////////////////////////////////////////////
+    std::set<std::string> Loader::AmbiguousAliases() const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      return std::set<std::string>(
+            this->dataPtr->aliasCollisions.begin(),
+            this->dataPtr->aliasCollisions.end());
+    }
+
+    /////////////////////////////////////////////////
+    NameView Loader::PluginsWithAliasView(std::string_view _alias) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const std::string_view *names = nullptr;
+      std::size_t count = 0;
+      const Implementation::AliasMap::const_iterator alias =
+          this->dataPtr->aliases.find(_alias);
+      if (alias != this->dataPtr->aliases.end())
+      {
+        names = alias->second.data();
+        count = alias->second.size();
+      }
+
+      // A plugin whose name matches the alias goes at the end, unless it
+      // also uses its own name as an alias
+      std::string_view namesake;
+      const Implementation::PluginMap::const_iterator plugin =
+          this->dataPtr->plugins.find(_alias);
+      if (plugin != this->dataPtr->plugins.end() &&
+          !std::binary_search(names, names + count, plugin->first))
+      {
+        namesake = plugin->first;
+      }
+
+      if (0 == count && nullptr == namesake.data())
+        return NameView();
+
+      return NameView(std::move(lock), names, count, namesake);
+    }
+
+    /////////////////////////////////////////////////
+    std::set<std::string> Loader::AliasesOfPlugin(
+        std::string_view _pluginName) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const Implementation::PluginMap::const_iterator plugin =
+          this->dataPtr->plugins.find(_pluginName);
+
+      if (plugin != this->dataPtr->plugins.end())
+        return plugin->second->aliases;
+
+      return {};
+    }
+
+    /////////////////////////////////////////////////
+    NameView Loader::AliasesOfPluginView(std::string_view _pluginName) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const std::string_view plugin = this->dataPtr->names.Find(_pluginName);
+      if (nullptr == plugin.data())
+        return NameView();
+
+      const Implementation::PluginAliasMap::const_iterator aliases =
+          this->dataPtr->pluginAliases.find(plugin);
+      if (this->dataPtr->pluginAliases.end() == aliases ||
+          aliases->second.empty())
+      {
+        return NameView();
+      }
+
+      return NameView(
+            std::move(lock), aliases->second.data(), aliases->second.size());
+    }
+
+    /////////////////////////////////////////////////
+    std::string Loader::LookupPlugin(std::string_view _nameOrAlias) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->LookupPlugin(_nameOrAlias);
+    }
+
+    /////////////////////////////////////////////////
+    std::string Loader::LookupPlugin(
+        std::string_view _nameOrAlias,
+        const Preference _preference) const
+    {
+      if (Preference::UNIQUE == _preference)
+        return this->LookupPlugin(_nameOrAlias);
+
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      LookupStatus status;
+      const Implementation::PluginMap::const_iterator plugin =
+          this->dataPtr->ResolveFastestPlugin(_nameOrAlias, status);
+      if (this->dataPtr->plugins.end() == plugin)
+      {
+        this->dataPtr->ReportLookupFailure(_nameOrAlias, status);
+        return "";
+      }
+
+      return plugin->second->name;
+    }
+
+    /////////////////////////////////////////////////
+    std::set<std::string> Loader::RequiredFeatures(
+        std::string_view _pluginName) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const Implementation::PluginMap::const_iterator plugin =
+          this->dataPtr->plugins.find(_pluginName);
+
+      if (plugin != this->dataPtr->plugins.end())
+        return plugin->second->requiredFeatures;
+
+      return {};
+    }
+
+    /////////////////////////////////////////////////
+    std::set<std::string> Loader::Dependencies(
+        std::string_view _pluginName) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const Implementation::PluginMap::const_iterator plugin =
+          this->dataPtr->plugins.find(_pluginName);
+
+      if (plugin != this->dataPtr->plugins.end())
+        return plugin->second->dependencies;
+
+      return {};
+    }
+
+    /////////////////////////////////////////////////
+    Loader::LookupStatus Loader::TryLookupPlugin(
+        std::string_view _nameOrAlias,
+        std::string *_pluginName) const
+    {
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      LookupStatus status;
+      const Implementation::PluginMap::const_iterator plugin =
+          this->dataPtr->ResolvePlugin(_nameOrAlias, status);
+
+      if (_pluginName && this->dataPtr->plugins.end() != plugin)
+        *_pluginName = plugin->second->name;
+
+      return status;
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::SetLogger(
+        Logger _logger,
+        const std::size_t _maxMessagesPerSecond)
+    {
+      std::unique_lock<std::mutex> lock(this->dataPtr->logMutex);
+      this->dataPtr->logger = std::move(_logger);
+      this->dataPtr->maxLogMessagesPerSecond = _maxMessagesPerSecond;
+      this->dataPtr->logWindowStart = std::chrono::steady_clock::time_point();
+      this->dataPtr->logMessagesInWindow = 0;
+      this->dataPtr->droppedLogMessages = 0;
+    }
+
+    /////////////////////////////////////////////////
+    PluginHandle Loader::Resolve(std::string_view _pluginNameOrAlias) const
+    {
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _pluginNameOrAlias, info, dlHandle, true))
+        return PluginHandle();
+
+      return PluginHandle(
+            std::move(info), std::move(dlHandle), this->dataPtr->self);
+    }
+
+    /////////////////////////////////////////////////
+    ThreadLocalPlugin Loader::ThreadLocal(
+        std::string_view _pluginNameOrAlias) const
+    {
+      return ThreadLocalPlugin(this->Resolve(_pluginNameOrAlias));
+    }
+
+    /////////////////////////////////////////////////
+    PluginPtr Loader::Instantiate(std::string_view _pluginNameOrAlias) const
+    {
+      detail::TraceScope trace("Instantiate", _pluginNameOrAlias);
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _pluginNameOrAlias, info, dlHandle, true))
+        return PluginPtr();
+
+      return this->PrivateInstantiate<PluginPtr>(info, dlHandle, nullptr);
+    }
+
+    /////////////////////////////////////////////////
+    PluginPtr Loader::PrivateInstantiateWith(
+        std::string_view _pluginNameOrAlias,
+        const char *_signature,
+        void *_arguments) const
+    {
+      detail::TraceScope trace("Instantiate", _pluginNameOrAlias);
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _pluginNameOrAlias, info, dlHandle, true))
+        return PluginPtr();
+
+      const auto constructor = info->constructors.find(_signature);
+      if (info->constructors.end() == constructor)
+      {
+        this->dataPtr->Log(
+              "[ignition::plugin::Loader::InstantiateWith] The plugin [",
+              info->name, "] has no constructor of the signature [",
+              DemangleSymbol(_signature), "]\n");
+        return PluginPtr();
+      }
+
+      std::pmr::memory_resource *const account =
+          this->PrivateAllocationAccount(dlHandle);
+
+      PluginPtr ptr;
+      ptr.PrivateUniqueWrapper().PrivateAdoptPluginInstance(
+            info, dlHandle, constructor->second(_arguments), account);
+
+      if (auto *enableFromThis = ptr->PrivateGetEnablePluginFromThis())
+      {
+        enableFromThis->PrivateSetPluginFromThis(ptr);
+        enableFromThis->PrivateSetMemoryResource(account);
+      }
+
+      return ptr;
+    }
+
+    /////////////////////////////////////////////////
+    std::shared_ptr<const void> Loader::PrivateQueryKernelTable(
+        std::string_view _pluginNameOrAlias,
+        const char *_table,
+        const std::uint32_t _abiVersion) const
+    {
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _pluginNameOrAlias, info, dlHandle, true))
+        return nullptr;
+
+      const auto table = info->kernelTables.find(_table);
+      if (info->kernelTables.end() == table)
+      {
+        this->dataPtr->Log(
+              "[ignition::plugin::Loader::QueryKernelTable] The plugin [",
+              info->name, "] does not export a kernel table of the type [",
+              DemangleSymbol(_table), "]\n");
+        return nullptr;
+      }
+
+      if (table->second.abiVersion != _abiVersion)
+      {
+        this->dataPtr->Log(
+              "[ignition::plugin::Loader::QueryKernelTable] The plugin [",
+              info->name, "] exports version [", table->second.abiVersion,
+              "] of the kernel table [", DemangleSymbol(_table),
+              "], but version [", _abiVersion, "] was requested\n");
+        return nullptr;
+      }
+
+      // The table lives in the library, so it shares ownership of the handle
+      return std::shared_ptr<const void>(dlHandle, table->second.table);
+    }
+
+    /////////////////////////////////////////////////
+    PluginPtr Loader::Reinstantiate(const PluginPtr &_plugin) const
+    {
+      if (_plugin.IsEmpty())
+        return PluginPtr();
+
+      PluginPtr ptr = this->Instantiate(*_plugin->Name());
+      if (ptr.IsEmpty())
+        return ptr;
+
+      const Reloadable *oldState = _plugin->QueryInterface<Reloadable>();
+      Reloadable *newState = ptr->QueryInterface<Reloadable>();
+      if (oldState && newState)
+        newState->RestoreState(oldState->SaveState());
+
+      return ptr;
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::SetInstancePool(
+        std::string_view _pluginNameOrAlias,
+        const std::size_t _capacity)
+    {
+      std::string name;
+      {
+        std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+        LookupStatus status;
+        const Implementation::PluginMap::const_iterator plugin =
+            this->dataPtr->ResolvePlugin(_pluginNameOrAlias, status);
+        if (this->dataPtr->plugins.end() == plugin)
+        {
+          this->dataPtr->ReportLookupFailure(_pluginNameOrAlias, status);
+          return false;
+        }
+
+        if (0 == plugin->second->interfaces.count(typeid(Recyclable).name()))
+        {
+          this->dataPtr->Log(
+                "[ignition::plugin::Loader::SetInstancePool] The plugin [",
+                plugin->second->name, "] cannot be pooled, because it does "
+                "not provide the ignition::plugin::Recyclable interface\n");
+          return false;
+        }
+
+        name = plugin->second->name;
+      }
+
+      // The instances which no longer fit are deleted once the lock is gone
+      std::vector<PooledInstance> dropped;
+      std::shared_ptr<InstancePool> removed;
+
+      std::unique_lock<std::mutex> lock(this->dataPtr->instancePoolsMutex);
+      const auto entry = this->dataPtr->instancePools.find(name);
+      if (0 == _capacity)
+      {
+        if (this->dataPtr->instancePools.end() != entry)
+        {
+          removed = std::move(entry->second);
+          this->dataPtr->instancePools.erase(entry);
+          --this->dataPtr->instancePoolCount;
+        }
+
+        return true;
+      }
+
+      std::shared_ptr<InstancePool> &pool =
+          this->dataPtr->instancePools[name];
+      if (!pool)
+      {
+        pool = std::make_shared<InstancePool>();
+        ++this->dataPtr->instancePoolCount;
+      }
+
+      std::unique_lock<std::mutex> poolLock(pool->mutex);
+      pool->capacity = _capacity;
+      while (pool->idle.size() > _capacity)
+      {
+        dropped.push_back(std::move(pool->idle.back()));
+        pool->idle.pop_back();
+      }
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t Loader::PooledInstances(std::string_view _pluginName) const
+    {
+      std::unique_lock<std::mutex> lock(this->dataPtr->instancePoolsMutex);
+      const auto entry =
+          this->dataPtr->instancePools.find(std::string(_pluginName));
+      if (this->dataPtr->instancePools.end() == entry)
+        return 0;
+
+      std::unique_lock<std::mutex> poolLock(entry->second->mutex);
+      return entry->second->idle.size();
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::SetFactoryCaching(const bool _enabled)
+    {
+      this->dataPtr->factoryCaching = _enabled;
+      if (_enabled)
+        return;
+
+      // The instances are deleted once the lock is gone
+      std::unordered_map<std::string_view, PluginPtr> dropped;
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->factoriesMutex);
+      dropped.swap(this->dataPtr->factories);
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::FactoryCaching() const
+    {
+      return this->dataPtr->factoryCaching;
+    }
+
+    /////////////////////////////////////////////////
+    PluginPtr Loader::PrivateFactoryInstance(
+        std::string_view _pluginNameOrAlias) const
+    {
+      if (!this->dataPtr->factoryCaching.load(std::memory_order_relaxed))
+        return this->Instantiate(_pluginNameOrAlias);
+
+      {
+        std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+        LookupStatus status;
+        const Implementation::PluginMap::const_iterator plugin =
+            this->dataPtr->ResolvePlugin(_pluginNameOrAlias, status);
+        if (this->dataPtr->plugins.end() != plugin)
+        {
+          std::shared_lock<std::shared_mutex> factoriesLock(
+                this->dataPtr->factoriesMutex);
+          const auto entry =
+              this->dataPtr->factories.find(plugin->second->name);
+          if (this->dataPtr->factories.end() != entry)
+            return entry->second;
+        }
+      }
+
+      // Instantiate() takes care of opening deferred libraries and of
+      // reporting plugins which cannot be found
+      PluginPtr created = this->Instantiate(_pluginNameOrAlias);
+      if (!created)
+        return created;
+
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      const ConstInfoPtr &info = created->PrivateGetInfoPtr();
+
+      // If the plugin was forgotten in the meantime, the instance must not
+      // be cached, or it would keep the forgotten library loaded
+      const Implementation::PluginMap::const_iterator plugin =
+          this->dataPtr->plugins.find(info->name);
+      if (this->dataPtr->plugins.end() == plugin || plugin->second != info)
+        return created;
+
+      std::unique_lock<std::shared_mutex> factoriesLock(
+            this->dataPtr->factoriesMutex);
+      if (!this->dataPtr->factoryCaching.load(std::memory_order_relaxed))
+        return created;
+
+      // Another thread may have cached an instance first, in which case that
+      // one is shared instead
+      return this->dataPtr->factories.emplace(info->name, created)
+          .first->second;
+    }
+
+    /////////////////////////////////////////////////
+    std::vector<PluginPtr> Loader::Prewarm(
+        const std::vector<std::string_view> &_pluginNamesOrAliases,
+        const bool _lockCode) const
+    {
+      std::vector<PluginPtr> plugins;
+      plugins.reserve(_pluginNamesOrAliases.size());
+
+      // Several plugins may share a library, which only needs to be prepared
+      // once
+      std::unordered_set<const void *> preparedLibraries;
+
+      for (const std::string_view name : _pluginNamesOrAliases)
+      {
+        ConstInfoPtr info;
+        std::shared_ptr<void> dlHandle;
+        if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+              name, info, dlHandle, true))
+        {
+          plugins.emplace_back();
+          continue;
+        }
+
+        // The factory of a plugin lives in the library which provides it
+        const void *code = reinterpret_cast<const void *>(info->factory);
+        Dl_info library;
+        if (code && 0 != dladdr(code, &library)
+            && preparedLibraries.insert(library.dli_fbase).second)
+        {
+          const int error = PrepareLibraryPages(code, _lockCode);
+          if (0 != error)
+          {
+            this->dataPtr->Log(
+                  "[ignition::plugin::Loader::Prewarm] Could not lock the "
+                  "code of [", library.dli_fname ? library.dli_fname : "",
+                  "] into memory: ", std::strerror(error), "\n");
+          }
+        }
+
+        PluginPtr plugin =
+            this->PrivateInstantiate<PluginPtr>(info, dlHandle, nullptr);
+        if (!plugin.IsEmpty())
+        {
+          if (Warmup *warmup = plugin->QueryInterface<Warmup>())
+            warmup->WarmUp();
+        }
+
+        plugins.push_back(std::move(plugin));
+      }
+
+      return plugins;
+    }
+
+    /////////////////////////////////////////////////
+    std::future<PluginPtr> Loader::InstantiateAsync(
+        std::string_view _pluginNameOrAlias) const
+    {
+      /// \brief The state which is shared with the completion of InitAsync()
+      struct Pending
+      {
+        std::promise<PluginPtr> promise;
+
+        /// \brief The instance, until its initialization has finished
+        PluginPtr plugin;
+
+        /// \brief Set by the first call to the completion. Later calls are
+        /// ignored, since a promise can only be fulfilled once.
+        std::atomic_flag finished = ATOMIC_FLAG_INIT;
+      };
+
+      const std::shared_ptr<Pending> pending = std::make_shared<Pending>();
+      std::future<PluginPtr> future = pending->promise.get_future();
+
+      AsyncInit *init = nullptr;
+      try
+      {
+        pending->plugin = this->Instantiate(_pluginNameOrAlias);
+        if (pending->plugin)
+          init = pending->plugin->QueryInterface<AsyncInit>();
+      }
+      catch (...)
+      {
+        pending->promise.set_exception(std::current_exception());
+        return future;
+      }
+
+      if (!init)
+      {
+        pending->promise.set_value(std::move(pending->plugin));
+        return future;
+      }
+
+      AsyncInit::Completion done = [pending](std::exception_ptr _error)
+      {
+        if (pending->finished.test_and_set())
+          return;
+
+        // Take the instance out of the shared state, so that a plugin which
+        // keeps the completion does not keep itself alive. If the
+        // initialization failed, the instance is deleted on return.
+        const PluginPtr plugin = std::move(pending->plugin);
+        if (_error)
+          pending->promise.set_exception(_error);
+        else
+          pending->promise.set_value(plugin);
+      };
+
+      try
+      {
+        init->InitAsync(done);
+      }
+      catch (...)
+      {
+        done(std::current_exception());
+      }
+
+      return future;
+    }
+
+    /////////////////////////////////////////////////
+    RemotePlugin Loader::InstantiateRemote(
+        std::string_view _pluginNameOrAlias,
+        const RemoteOptions &_options) const
+    {
+      const std::string name = this->LookupPlugin(_pluginNameOrAlias);
+      if (name.empty())
+        return RemotePlugin();
+
+      {
+        // The view is released before the fork, so that the new process
+        // does not inherit a lock on the registry.
+        const NameView callable =
+            this->PluginsImplementingView<RemoteCallable>();
+        if (!callable.Contains(name))
+        {
+          this->dataPtr->Log(
+                "[ignition::plugin::Loader::InstantiateRemote] The plugin [",
+                name, "] does not implement ignition::plugin::RemoteCallable, "
+                "so it cannot be hosted in a process of its own.\n");
+          return RemotePlugin();
+        }
+      }
+
+      // The plugin is resolved here, so that the new process can construct
+      // it straight from its library without going through this Loader.
+      PluginHandle handle = this->Resolve(name);
+      if (!handle)
+        return RemotePlugin();
+
+      return RemotePlugin(std::move(handle), _options);
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::PrivateProvidesInterfaces(
+        const ConstInfoPtr &_info,
+        const char *const *_interfaces,
+        const std::size_t _count) const
+    {
+      bool providesAll = true;
+      for (std::size_t i = 0; i < _count; ++i)
+      {
+        if (0 != _info->interfaces.count(_interfaces[i]))
+          continue;
+
+        this->dataPtr->Log(
+              "[ignition::plugin::Loader::Instantiate] The plugin [",
+              _info->name, "] does not provide the interface [",
+              CachedDemangleSymbol(_interfaces[i]), "], so it cannot be "
+              "instantiated as a TypedPluginPtr.\n");
+        providesAll = false;
+      }
+
+      return providesAll;
+    }
+
+    /////////////////////////////////////////////////
+    std::shared_ptr<void> Loader::PrivateCheckOutPooled(
+        const ConstInfoPtr &_info,
+        const std::shared_ptr<void> &_dlHandle,
+        const void *&_table) const
+    {
+      if (0 == this->dataPtr->instancePoolCount.load(std::memory_order_relaxed))
+        return nullptr;
+
+      std::shared_ptr<InstancePool> pool;
+      {
+        std::unique_lock<std::mutex> lock(this->dataPtr->instancePoolsMutex);
+        const auto entry = this->dataPtr->instancePools.find(_info->name);
+        if (this->dataPtr->instancePools.end() == entry)
+          return nullptr;
+
+        pool = entry->second;
+      }
+
+      PooledInstance instance;
+      std::vector<PooledInstance> stale;
+      {
+        std::unique_lock<std::mutex> lock(pool->mutex);
+
+        // Instances from an older version of the library are not reused
+        if (pool->info != _info)
+        {
+          stale.swap(pool->idle);
+          pool->info = _info;
+        }
+
+        if (!pool->idle.empty())
+        {
+          instance = std::move(pool->idle.back());
+          pool->idle.pop_back();
+        }
+      }
+
+      if (!instance.instance)
+      {
+        const PluginPtr created(_info, _dlHandle);
+        instance.instance = created->PrivateGetInstancePtr();
+        instance.table = created->PrivateGetSharedInterfaceTable();
+        instance.recyclable = created->QueryInterface<Recyclable>();
+      }
+
+      _table = instance.table;
+
+      // Plugins are only pooled if they provide Recyclable, but a new version
+      // of the library might have dropped it. Such an instance is handed out
+      // like any other.
+      if (!instance.recyclable)
+        return instance.instance;
+
+      void *const address = instance.instance.get();
+      return std::shared_ptr<void>(
+            address, ReturnToPool{pool, std::move(instance)});
+    }
+
+    /////////////////////////////////////////////////
+    PluginPtr Loader::Instantiate(
+        std::string_view _pluginNameOrAlias,
+        std::pmr::memory_resource *_resource) const
+    {
+      return this->Instantiate<PluginPtr>(_pluginNameOrAlias, _resource);
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t Loader::Instantiate(
+        std::string_view _pluginNameOrAlias,
+        const std::size_t _count,
+        std::vector<PluginPtr> &_plugins,
+        std::pmr::memory_resource *_resource) const
+    {
+      return this->Instantiate<PluginPtr>(
+            _pluginNameOrAlias, _count, _plugins, _resource);
+    }
+
+    /////////////////////////////////////////////////
+    std::vector<PluginPtr> Loader::InstantiateAll(
+        const std::vector<std::string_view> &_pluginNamesOrAliases,
+        const std::size_t _threads) const
+    {
+      const std::size_t count = _pluginNamesOrAliases.size();
+      std::vector<PluginPtr> plugins(count);
+
+      // Resolve every plugin up front. This also opens the libraries which
+      // were deferred by the manifest cache, since the dependencies are only
+      // known once a library has been opened.
+      std::vector<ConstInfoPtr> infos(count);
+      std::vector<std::shared_ptr<void>> dlHandles(count);
+      std::unordered_map<std::string_view, std::vector<std::size_t>> listed;
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        if (LookupStatus::FOUND == this->PrivateGetInfoAndDlHandle(
+              _pluginNamesOrAliases[i], infos[i], dlHandles[i], true))
+          listed[infos[i]->name].push_back(i);
+      }
+
+      // Each plugin waits for every listed instance of its dependencies
+      std::vector<std::size_t> waitingFor(count, 0);
+      std::vector<std::vector<std::size_t>> dependents(count);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        if (!infos[i])
+          continue;
+
+        for (const std::string &dependency : infos[i]->dependencies)
+        {
+          std::string name;
+          if (LookupStatus::FOUND != this->TryLookupPlugin(dependency, &name))
+            continue;
+
+          const auto entry = listed.find(name);
+          if (listed.end() == entry)
+            continue;
+
+          for (const std::size_t j : entry->second)
+          {
+            dependents[j].push_back(i);
+            ++waitingFor[i];
+          }
+        }
+      }
+
+      std::mutex mutex;
+      std::condition_variable changed;
+      std::deque<std::size_t> ready;
+      std::size_t running = 0;
+      std::exception_ptr error;
+
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        if (infos[i] && 0 == waitingFor[i])
+          ready.push_back(i);
+      }
+
+      // Each worker keeps constructing plugins whose dependencies are done.
+      // It stops once nothing is ready and nothing is being constructed that
+      // could make more plugins ready, or once a constructor has thrown.
+      const auto work = [&]()
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+          changed.wait(lock, [&]()
+          {
+            return !ready.empty() || 0 == running || error;
+          });
+
+          if (ready.empty() || error)
+            return;
+
+          const std::size_t i = ready.front();
+          ready.pop_front();
+          ++running;
+          lock.unlock();
+
+          PluginPtr plugin;
+          std::exception_ptr thrown;
+          try
+          {
+            plugin = this->PrivateInstantiate<PluginPtr>(
+                  infos[i], dlHandles[i], nullptr);
+          }
+          catch (...)
+          {
+            thrown = std::current_exception();
+          }
+
+          lock.lock();
+          --running;
+          if (thrown)
+          {
+            if (!error)
+              error = thrown;
+          }
+          else
+          {
+            plugins[i] = std::move(plugin);
+            for (const std::size_t dependent : dependents[i])
+            {
+              if (0 == --waitingFor[dependent])
+                ready.push_back(dependent);
+            }
+          }
+
+          changed.notify_all();
+        }
+      };
+
+      const std::size_t numWorkers = std::max<std::size_t>(1, std::min(
+            count,
+            _threads > 0 ? _threads :
+              std::max(1u, std::thread::hardware_concurrency())));
+
+      // The current thread acts as one of the workers.
+      std::vector<std::thread> workers;
+      for (std::size_t i = 1; i < numWorkers; ++i)
+        workers.emplace_back(work);
+
+      work();
+
+      for (std::thread &worker : workers)
+        worker.join();
+
+      if (error)
+        std::rethrow_exception(error);
+
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        if (infos[i] && 0 != waitingFor[i])
+        {
+          this->dataPtr->Log(
+                "[ignition::plugin::Loader::InstantiateAll] The plugin [",
+                infos[i]->name, "] was not instantiated, because it is part "
+                "of a dependency cycle, or depends on one\n");
+        }
+      }
+
+      return plugins;
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::ForgetLibrary(const std::string &_pathToLibrary)
+    {
+      detail::TraceScope trace("ForgetLibrary", _pathToLibrary);
+
+      // Every library that this Loader has opened is recorded under its
+      // canonical path, so there is no need to ask the dynamic loader for its
+      // handle. This also finds libraries which have been reloaded, since
+      // those are no longer open under their own path.
+      const std::string path = CanonicalLibraryPath(_pathToLibrary);
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->ForgetLibraryPath(path);
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::ForgetLibraryOfPlugin(std::string_view _pluginNameOrAlias)
+    {
+      detail::TraceScope trace("ForgetLibrary", _pluginNameOrAlias);
+      std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+      const std::string &resolvedName =
+          this->dataPtr->LookupPlugin(_pluginNameOrAlias);
+
+      const Implementation::DeferredPluginMap::const_iterator deferred =
+          this->dataPtr->deferredPlugins.find(resolvedName);
+      if (this->dataPtr->deferredPlugins.end() != deferred)
+      {
+        // Copy the path, because forgetting the library will erase it
+        const std::string path = deferred->second;
+        return this->dataPtr->ForgetDeferredLibrary(path);
+      }
+
+      Implementation::PluginToDlHandleMap::iterator it =
+          dataPtr->pluginToDlHandlePtrs.find(resolvedName);
+
+      if (dataPtr->pluginToDlHandlePtrs.end() == it)
+        return false;
+
+      return dataPtr->ForgetLibrary(it->second.get());
+    }
+
+    /////////////////////////////////////////////////
+    Loader::LookupStatus Loader::PrivateGetInfoAndDlHandle(
+        std::string_view _pluginNameOrAlias,
+        ConstInfoPtr &_info,
+        std::shared_ptr<void> &_dlHandle,
+        const bool _report) const
+    {
+      std::string deferredLibrary;
+      LoadOptions options;
+      {
+        std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+        const LookupStatus status = this->dataPtr->GetInfoAndDlHandle(
+              _pluginNameOrAlias, _info, _dlHandle, deferredLibrary);
+
+        if (LookupStatus::FOUND == status)
+          return status;
+
+        if (LookupStatus::LIBRARY_UNAVAILABLE != status)
+        {
+          if (_report)
+            this->dataPtr->ReportLookupFailure(_pluginNameOrAlias, status);
+
+          return status;
+        }
+
+        options = this->dataPtr->deferredLibraries.at(deferredLibrary).options;
+      }
+
+      // The plugin is known, but its library has not been opened yet, so we
+      // need to open it now.
+      this->dataPtr->StageAndCommitLib(deferredLibrary, options);
+
+      std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+      const LookupStatus status = this->dataPtr->GetInfoAndDlHandle(
+            _pluginNameOrAlias, _info, _dlHandle, deferredLibrary);
+
+      if (LookupStatus::FOUND == status || !_report)
+        return status;
+
+      if (LookupStatus::LIBRARY_UNAVAILABLE == status)
+      {
+        this->dataPtr->Log(
+              "[ignition::plugin::Loader::Instantiate] Failed to open the "
+              "library [", deferredLibrary, "] which provides [",
+              _pluginNameOrAlias, "]\n");
+      }
+      else
+      {
+        // Another thread forgot the library while we were opening it
+        this->dataPtr->ReportLookupFailure(_pluginNameOrAlias, status);
+      }
+
+      return status;
+    }
+
+    /////////////////////////////////////////////////
+    ConstInfoPtr Loader::PrivateGetInfo(
+        std::string_view _resolvedName) const
+    {
+      // Going through PrivateGetInfoAndDlHandle ensures that a deferred
+      // library gets opened, so that the Info can be used for instantiation.
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _resolvedName, info, dlHandle, true))
+      {
+        // LCOV_EXCL_START
+        std::cerr << "[ignition::Loader::PrivateGetInfo] A resolved name ["
+                  << _resolvedName << "] could not be found in the PluginMap. "
+                  << "This should not be possible! Please report this bug!\n";
+        assert(false);
+        return nullptr;
+        // LCOV_EXCL_STOP
+      }
+
+      return info;
+    }
+
+    /////////////////////////////////////////////////
+    std::shared_ptr<void> Loader::PrivateGetPluginDlHandlePtr(
+        std::string_view _resolvedName) const
+    {
+      // If the library which provides this plugin has not been opened yet,
+      // this will open it.
+      ConstInfoPtr info;
+      std::shared_ptr<void> dlHandle;
+      if (LookupStatus::FOUND != this->PrivateGetInfoAndDlHandle(
+            _resolvedName, info, dlHandle, true))
+      {
+        // LCOV_EXCL_START
+        std::cerr << "[ignition::Loader::PrivateGetInfo] A resolved name ["
+                  << _resolvedName << "] could not be found in the "
+                  << "PluginToDlHandleMap. This should not be possible! Please "
+                  << "report this bug!\n";
+        assert(false);
+        return nullptr;
+        // LCOV_EXCL_STOP
+      }
+
+      return dlHandle;
+    }
+
+    /////////////////////////////////////////////////
+    std::shared_ptr<CachedLibrary> Loader::Implementation::LoadLib(
+        const std::string &_full_path,
+        const LoadOptions &_options)
+    {
+      // Call dlerror() before dlopen(~) to ensure that we get accurate error
+      // reporting afterwards. The function dlerror() is stateful, and that
+      // state gets cleared each time it is called.
+      dlerror();
+
+      // NOTE: By default we open using RTLD_LOCAL instead of RTLD_GLOBAL to
+      // prevent the symbols of different libraries from writing over each
+      // other.
+      void *dlHandle = nullptr;
+      {
+        detail::TraceScope trace("dlopen", _full_path);
+        dlHandle = dlopen(_full_path.c_str(), DlopenFlags(_options));
+      }
+
+      const char *loadError = dlerror();
+      if (nullptr == dlHandle || nullptr != loadError)
+      {
+        this->Log("Error while loading the library [", _full_path, "]: ",
+                  loadError ? loadError : "unknown error", "\n");
+
+        // Just return a nullptr if the library could not be loaded. The
+        // Loader::LoadLib(~) function will handle this gracefully.
+        return nullptr;
+      }
+
+      // The library may already be open, either because this Loader has
+      // loaded it before or because another Loader has. Either way, the
+      // LibraryCache hands out the one object which counts the references to
+      // the library, and which closes it once all of them are gone. The
+      // library is only closed once no thread can be executing its code from
+      // inside an EpochGuard.
+      if (_options.deferUnload)
+      {
+        return LibraryCache::Get().Acquire(dlHandle, [](void *ptr)
+        {
+          RetireAfterEpoch([ptr]() { UnloadQueue::Get().Post(ptr); });
+        });
+      }
+
+      return LibraryCache::Get().Acquire(dlHandle, [](void *ptr)
+      {
+        RetireAfterEpoch([ptr]() { CloseLibrary(ptr); }); // NOLINT
+      });
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Implementation::StagedLibrary Loader::Implementation::StageLib(
+        const std::string &_pathToLibrary,
+        const LoadOptions &_options)
+    {
+      StagedLibrary staged;
+      staged.options = _options;
+
+      // Remember the stamp of the file, so that ReloadLib can tell whether it
+      // has changed since it was opened.
+      ManifestLibrary stamp;
+      if (ManifestLibrary::Stat(_pathToLibrary, stamp))
+      {
+        staged.path = std::move(stamp.path);
+        staged.modificationTime = stamp.modificationTime;
+        staged.fileSize = stamp.fileSize;
+      }
+      else
+      {
+        staged.path = CanonicalLibraryPath(_pathToLibrary);
+      }
+
+      // Attempt to load the library at this path
+      const std::shared_ptr<CachedLibrary> library =
+          this->LoadLib(_pathToLibrary, _options);
+
+      if (nullptr == library)
+        return staged;
+
+      staged.dlHandle = std::shared_ptr<void>(library, library->DlHandle());
+
+      // Only the first Loader to open the library needs to look into it. The
+      // others share the Info that it found.
+      staged.plugins = library->Plugins([&]()
+      {
+        // The code of the library can only be moved before any other thread
+        // may be running it, i.e. before the first Loader looks into it
+        if (_options.hugePageText)
+        {
+          detail::TraceScope trace("RemapHugePages", _pathToLibrary);
+          const int error = RemapTextOntoHugePages(library->DlHandle());
+          if (0 != error)
+          {
+            this->Log("[ignition::plugin::Loader::LoadLib] Could not move the "
+                      "code of [", _pathToLibrary, "] onto huge pages: ",
+                      std::strerror(error), "\n");
+          }
+        }
+
+        // Found a shared library, does it have the symbols we're looking for?
+        std::vector<std::shared_ptr<Info>> found =
+            this->LoadPlugins(staged.dlHandle, _pathToLibrary);
+
+        // Demangle the plugin names before creating entries for them. The
+        // metadata records of the library already spell out most of the
+        // names.
+        detail::TraceScope trace("Demangle", _pathToLibrary);
+        DemangledNameMap demangledNames;
+        if (!found.empty())
+          LoadDemangledNames(staged.dlHandle, demangledNames);
+
+        for (const std::shared_ptr<Info> &plugin : found)
+          DemangleInfo(*plugin, demangledNames);
+
+        return found;
+      });
+
+      return staged;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::Implementation::CommitLib(
+        const StagedLibrary &_staged)
+    {
+      detail::TraceScope trace("CommitLib", _staged.path);
+      std::unordered_set<std::string> newPlugins;
+      this->InvalidateResolvedNames();
+
+      OpenLibrary &library = this->dlHandleToPluginMap[_staged.dlHandle.get()];
+      if (!library.handle)
+      {
+        // Plugin instances get a reference of their own, which keeps the
+        // library open, so that they can be counted by Libraries().
+        library.handle = std::shared_ptr<void>(
+              _staged.dlHandle.get(),
+              [dlHandle = _staged.dlHandle](void *) {});
+        library.account = &AllocationAccounts::Get().For(_staged.path);
+      }
+
+      for (const std::shared_ptr<Info> &info : _staged.plugins)
+      {
+        const Info &plugin = *info;
+
+        // Add the plugin's aliases to the alias map. A deferred plugin gets
+        // the aliases of its real Info instead of those of the manifest.
+        const std::string_view interned = this->names.Intern(plugin.name);
+        SortedNameSet &own = this->pluginAliases[interned];
+        own = SortedNameSet();
+        for (const std::string &alias : plugin.aliases)
+        {
+          const std::string_view internedAlias = this->names.Intern(alias);
+          this->AddAlias(internedAlias, interned);
+          own.insert(internedAlias);
+        }
+
+        // Keep track of which plugins implement each interface
+        this->IndexInterfaces(plugin);
+
+        const DeferredPluginMap::iterator deferred =
+            this->deferredPlugins.find(plugin.name);
+        if (this->deferredPlugins.end() != deferred)
+        {
+          // The plugin was deferred, so replace its metadata-only Info with
+          // the real one. The key of the entry views the name of the old
+          // Info, so the entry needs to be inserted again.
+          this->deferredLibraries[deferred->second].plugins.erase(plugin.name);
+          this->deferredPlugins.erase(deferred);
+          this->plugins.erase(plugin.name);
+        }
+
+        // Add the plugin to the map. The staged Info is shared instead of
+        // copied, since nothing modifies it after it has been staged.
+        const std::string_view key = plugin.name;
+        this->plugins.insert(std::make_pair(key, ConstInfoPtr(info)));
+
+        // Add the plugin's name to the set of newPlugins
+        newPlugins.insert(plugin.name);
+        this->pluginNames.insert(plugin.name);
+
+        // Save the dl handle for this plugin
+        this->pluginToDlHandlePtrs[plugin.name] = library.handle;
+      }
+
+      library.plugins.clear();
+      for (const std::string &name : newPlugins)
+        library.plugins.insert(this->names.Intern(name));
+
+      // Plugins which are linked into the program have no path
+      if (!_staged.path.empty())
+      {
+        if (std::find(library.paths.begin(), library.paths.end(),
+                      _staged.path) == library.paths.end())
+        {
+          library.paths.push_back(_staged.path);
+        }
+
+        LoadedLibrary &loaded = this->loadedLibraries[_staged.path];
+        loaded.dlHandle = _staged.dlHandle.get();
+        loaded.options = _staged.options;
+        loaded.modificationTime = _staged.modificationTime;
+        loaded.fileSize = _staged.fileSize;
+      }
+
+      // If the library had been deferred, any of its plugins which are still
+      // deferred were described by the manifest but are not actually provided
+      // by the library, so we should forget about them.
+      this->ForgetDeferredLibrary(_staged.path);
+
+      if (this->EvictionEnabled())
+      {
+        library.lastUsed.store(++this->useClock, std::memory_order_relaxed);
+        this->EvictIdleLibraries(_staged.dlHandle.get());
+      }
+
+      return newPlugins;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::Implementation::StageAndCommitLib(
+        const std::string &_pathToLibrary,
+        const LoadOptions &_options)
+    {
+      const StagedLibrary staged = this->StageLib(_pathToLibrary, _options);
+
+      // Quit early and return an empty set of plugin names if we did not
+      // actually get a valid dlHandle.
+      if (nullptr == staged.dlHandle)
+        return {};
+
+      this->CacheLib(_pathToLibrary, staged);
+
+      std::unique_lock<std::shared_mutex> lock(this->mutex);
+      return this->CommitLib(staged);
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::Implementation::RegisterDeferredLib(
+        const ManifestLibrary &_library,
+        const LoadOptions &_options)
+    {
+      std::unordered_set<std::string> newPlugins;
+      this->InvalidateResolvedNames();
+
+      for (const ManifestPlugin &plugin : _library.plugins)
+      {
+        newPlugins.insert(plugin.name);
+
+        // If the plugin is already known, either because its library is open
+        // or because it was already deferred, there is nothing to do.
+        if (this->plugins.count(plugin.name) > 0)
+          continue;
+
+        ConstInfoPtr info = std::make_shared<Info>(plugin.ToInfo());
+
+        const std::string_view interned = this->names.Intern(info->name);
+        SortedNameSet &own = this->pluginAliases[interned];
+        for (const std::string &alias : info->aliases)
+        {
+          const std::string_view internedAlias = this->names.Intern(alias);
+          this->AddAlias(internedAlias, interned);
+          own.insert(internedAlias);
+        }
+
+        this->IndexInterfaces(*info);
+        this->pluginNames.insert(info->name);
+        const std::string_view key = info->name;
+        this->plugins.insert(std::make_pair(key, std::move(info)));
+
+        this->deferredPlugins[plugin.name] = _library.path;
+
+        DeferredLibrary &deferred = this->deferredLibraries[_library.path];
+        deferred.plugins.insert(plugin.name);
+        deferred.options = _options;
+        deferred.modificationTime = _library.modificationTime;
+        deferred.fileSize = _library.fileSize;
+        deferred.buildId = _library.buildId;
+      }
+
+      return newPlugins;
+    }
+
+    /////////////////////////////////////////////////
+    std::unordered_set<std::string> Loader::Implementation::RegisterManifest(
+        const Manifest &_manifest,
+        const std::vector<std::string> &_pathsToLibraries,
+        std::vector<std::string> &_outdated)
+    {
+      // Without a list of libraries, every library of the manifest is taken
+      // from the path that the manifest records for it.
+      std::vector<std::string> recorded;
+      if (_pathsToLibraries.empty())
+      {
+        recorded.reserve(_manifest.libraries.size());
+        for (const auto &entry : _manifest.libraries)
+          recorded.push_back(entry.first);
+      }
+
+      const std::vector<std::string> &libraries =
+          _pathsToLibraries.empty() ? recorded : _pathsToLibraries;
+
+      // Look the libraries up before taking the lock, since that inspects
+      // their files.
+      std::vector<ManifestLibrary> described;
+      described.reserve(libraries.size());
+      for (const std::string &library : libraries)
+      {
+        // Only trust the entries which still match the library on disk. The
+        // rest of the libraries will need to be opened.
+        ManifestLibrary current;
+        if (_manifest.FindCurrent(library, current))
+          described.push_back(std::move(current));
+        else
+          _outdated.push_back(library);
+      }
+
+      std::unordered_set<std::string> newPlugins;
+      std::unique_lock<std::shared_mutex> lock(this->mutex);
+      for (const ManifestLibrary &library : described)
+      {
+        const std::unordered_set<std::string> registered =
+            this->RegisterDeferredLib(library, this->defaultLoadOptions);
+        newPlugins.insert(registered.begin(), registered.end());
+      }
+
+      return newPlugins;
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::Implementation::FindCachedLib(
+        const std::string &_pathToLibrary,
+        ManifestLibrary &_library)
+    {
+      std::unique_lock<std::mutex> lock(this->manifestMutex);
+      if (this->manifestCacheFile.empty())
+        return false;
+
+      return this->manifestCache.FindCurrent(_pathToLibrary, _library);
+    }
+
+    /////////////////////////////////////////////////
+    bool Loader::Implementation::DescribeLib(
+        const std::string &_pathToLibrary,
+        const StagedLibrary &_staged,
+        ManifestLibrary &_library)
+    {
+      if (!ManifestLibrary::Stat(_pathToLibrary, _library))
+        return false;
+
+      _library.buildId = ReadBuildId(_pathToLibrary);
+      _library.plugins.clear();
+      for (const std::shared_ptr<Info> &plugin : _staged.plugins)
+        _library.plugins.push_back(ManifestPlugin::FromInfo(*plugin));
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Implementation::CacheLib(
+        const std::string &_pathToLibrary,
+        const StagedLibrary &_staged)
+    {
+      std::unique_lock<std::mutex> lock(this->manifestMutex);
+      if (this->manifestCacheFile.empty())
+        return;
+
+      // This happens when a deferred library finally gets opened
+      ManifestLibrary library;
+      if (this->manifestCache.FindCurrent(_pathToLibrary, library))
+        return;
+
+      if (!DescribeLib(_pathToLibrary, _staged, library))
+        return;
+
+      this->manifestCache.Insert(std::move(library));
+      this->manifestCacheDirty = true;
+    }
+
+    /////////////////////////////////////////////////
+    std::vector<std::shared_ptr<Info>> Loader::Implementation::LoadPlugins(
+        const std::shared_ptr<void> &_dlHandle,
+        const std::string& _pathToLibrary) const
+    {
+      detail::TraceScope trace("LoadPlugins", _pathToLibrary);
+      std::vector<std::shared_ptr<Info>> loadedPlugins;
+
+      // This function should never be called with a nullptr _dlHandle
+      assert(_dlHandle &&
+             "Bug in code: Loader::Implementation::LoadPlugins was called with "
+             "a nullptr value for _dlHandle.");
+
+      const std::string infoSymbol = "IgnitionPluginHook";
+      void *infoFuncPtr = dlsym(_dlHandle.get(), infoSymbol.c_str());
+
+      const std::string descriptorSymbol = "IgnitionPluginHookV2";
+      void *descriptorFuncPtr =
+          dlsym(_dlHandle.get(), descriptorSymbol.c_str());
+
+      // Does the library have the right symbol?
+      if (nullptr == infoFuncPtr && nullptr == descriptorFuncPtr)
+      {
+        this->Log("Library [", _pathToLibrary, "] does not export any "
+                  "plugins. The symbols [", infoSymbol, "] and [",
+                  descriptorSymbol, "] are missing, or they are not "
+                  "externally visible.\n");
+
+        return loadedPlugins;
+      }
+
+      // Libraries that were built before IgnitionPluginHookV2 existed only
+      // have IgnitionPluginHook, while a library might some day provide its
+      // plugins through IgnitionPluginHookV2 alone.
+      if (infoFuncPtr)
+        this->LoadInfoMap(infoFuncPtr, _pathToLibrary, loadedPlugins);
+
+      if (descriptorFuncPtr)
+      {
+        this->LoadDescriptors(
+              descriptorFuncPtr, _pathToLibrary, loadedPlugins);
+      }
+
+      return loadedPlugins;
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Implementation::LoadInfoMap(
+        void *_infoFuncPtr,
+        const std::string &_pathToLibrary,
+        std::vector<std::shared_ptr<Info>> &_plugins) const
+    {
+      using PluginLoadFunctionSignature =
+          void(*)(void * const, const void ** const,
+                  int *, std::size_t *, std::size_t *);
+
+      // Note: InfoHook (below) is a function with a signature that matches
+      // PluginLoadFunctionSignature.
+      auto InfoHook =
+          reinterpret_cast<PluginLoadFunctionSignature>(_infoFuncPtr);
+
+      int version = INFO_API_VERSION;
+      std::size_t size = sizeof(Info);
+      std::size_t alignment = alignof(Info);
+      const InfoMap *allInfo = nullptr;
+
+      // Note: static_cast cannot be used to convert from a T** to a void**
+      // because of the possibility of breaking the type system by assigning a
+      // Non-T pointer to the T* memory location. However, we need to retrieve
+      // a reference to an STL-type using a C-compatible function signature, so
+      // we resort to a reinterpret_cast to achieve this.
+      //
+      // Despite its many dangers, reinterpret_cast is well-defined for casting
+      // between pointer types as of C++11, as explained in bullet point 1 of
+      // the "Explanation" section in this reference:
+      // http://en.cppreference.com/w/cpp/language/reinterpret_cast
+      //
+      // We have a tight grip over the implementation of how the `allInfo`
+      // pointer gets used, so we do not need to worry about its memory address
+      // being filled with a non-compatible type. The only risk would be if a
+      // user decides to implement their own version of
+      // IgnitionPluginHook, but they surely would have no
+      // incentive in doing that.
+      //
+      // Also note that the main reason we jump through these hoops is in order
+      // to safely support plugin libraries on Windows that choose to compile
+      // against the static runtime. Using this pointer-to-a-pointer approach is
+      // the cleanest way to ensure that all dynamically allocated objects are
+      // deleted in the same heap that they were allocated from.
+      {
+        detail::TraceScope trace("IgnitionPluginHook", _pathToLibrary);
+        InfoHook(nullptr, reinterpret_cast<const void**>(&allInfo),
+             &version, &size, &alignment);
+      }
+
+      if (ignition::plugin::INFO_API_VERSION != version)
+      {
+        // TODO(anyone): When we need to support multiple API versions,
+        // put the logic for it into here.
+        // We can call IgnitionPluginHook(~) again with the
+        // API version that it expects.
+
+        this->Log("The library [", _pathToLibrary, "] is using an "
+                  "incompatible version [", version, "] of the "
+                  "ignition::plugin Info API. The version in this library is [",
+                  INFO_API_VERSION, "].\n");
+        return;
+      }
+
+      if (sizeof(Info) != size || alignof(Info) != alignment)
+      {
+        this->Log("The plugin::Info size or alignment are not consistent "
+                  "with the expected values for the library [", _pathToLibrary,
+                  "]:\n -- size: expected ", sizeof(Info),
+                  " | received ", size, "\n -- alignment: expected ",
+                  alignof(Info), " | received ", alignment, "\n"
+                  " -- We will not be able to safely load plugins from that "
+                  "library.\n");
+
+        return;
+      }
+
+      if (!allInfo)
+      {
+        this->Log("The library [", _pathToLibrary, "] failed to provide "
+                  "ignition::plugin Info for unknown reasons. Please report "
+                  "this error as a bug!\n");
+
+        return;
+      }
+
+      // The Info in the map belongs to the library, and the Loader is going
+      // to demangle the names of its copy, so this is the one copy which
+      // cannot be avoided.
+      detail::TraceScope trace("CopyInfo", _pathToLibrary);
+      _plugins.reserve(_plugins.size() + allInfo->size());
+      for (const InfoMap::value_type &info : *allInfo)
+      {
+        _plugins.push_back(std::make_shared<Info>(info.second));
+      }
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Implementation::LoadDescriptors(
+        void *_descriptorFuncPtr,
+        const std::string &_pathToLibrary,
+        std::vector<std::shared_ptr<Info>> &_plugins) const
+    {
+      using DescriptorHookSignature =
+          void(*)(int *, const void * const **, const void * const **);
+
+      detail::TraceScope trace("LoadDescriptors", _pathToLibrary);
+      auto DescriptorHook =
+          reinterpret_cast<DescriptorHookSignature>(_descriptorFuncPtr);
+
+      int version = DESCRIPTOR_API_VERSION;
+      const void * const *begin = nullptr;
+      const void * const *end = nullptr;
+      DescriptorHook(&version, &begin, &end);
+
+      if (DESCRIPTOR_API_VERSION != version)
+      {
+        this->Log("The library [", _pathToLibrary, "] is using an "
+                  "incompatible version [", version, "] of the "
+                  "ignition::plugin PluginDescriptor API. The version in this "
+                  "library is [", DESCRIPTOR_API_VERSION, "].\n");
+        return;
+      }
+
+      if (begin == end)
+        return;
+
+      // A plugin may be described by several descriptors, e.g. when its
+      // aliases are added separately from its interfaces, and it may also
+      // have been registered through IgnitionPluginHook, so merge every
+      // descriptor into the Info that has the same name.
+      std::unordered_map<std::string_view, std::size_t> indices;
+      indices.reserve(_plugins.size() + static_cast<std::size_t>(end - begin));
+
+      _plugins.reserve(_plugins.size() + static_cast<std::size_t>(end - begin));
+      for (std::size_t i = 0; i < _plugins.size(); ++i)
+        indices.emplace(std::string_view(_plugins[i]->name), i);
+
+      for (const void * const *entry = begin; entry != end; ++entry)
+      {
+        // The section holds placeholder entries which are always nullptr.
+        if (nullptr == *entry)
+          continue;
+
+        const PluginDescriptor &descriptor =
+            *static_cast<const PluginDescriptor*>(*entry);
+
+        // A descriptor may be larger than ours if the library was built
+        // against a newer version of ign-plugin, but it must never be smaller.
+        if (descriptor.size < sizeof(PluginDescriptor))
+        {
+          // LCOV_EXCL_START
+          this->Log("The library [", _pathToLibrary, "] provided a plugin "
+                    "descriptor of size [", descriptor.size, "], but at least ",
+                    "[", sizeof(PluginDescriptor), "] is expected. The "
+                    "descriptor will be ignored.\n");
+          continue;
+          // LCOV_EXCL_STOP
+        }
+
+        const auto index = indices.find(descriptor.name());
+        if (indices.end() == index)
+        {
+          _plugins.push_back(
+                std::make_shared<Info>(InfoFromDescriptor(descriptor)));
+          indices.emplace(
+                std::string_view(_plugins.back()->name), _plugins.size() - 1);
+          continue;
+        }
+
+        Info &existing = *_plugins[index->second];
+        for (std::size_t i = 0; i < descriptor.aliasCount; ++i)
+          existing.aliases.insert(descriptor.aliases[i]);
+
+        for (std::size_t i = 0; i < descriptor.interfaceCount; ++i)
+        {
+          const InterfaceDescriptor &interface = descriptor.interfaces[i];
+          existing.interfaces.insert(
+                std::make_pair(interface.name(), interface.cast));
+          existing.interfaceIds.insert(
+                std::make_pair(interface.name(), interface.id));
+        }
+
+        if (descriptor.enablePluginFromThis && !existing.enablePluginFromThis)
+        {
+          existing.interfaces.insert(std::make_pair(
+                typeid(EnablePluginFromThis).name(),
+                descriptor.enablePluginFromThis));
+          existing.interfaceIds.insert(std::make_pair(
+                typeid(EnablePluginFromThis).name(),
+                InterfaceId<EnablePluginFromThis>()));
+          existing.enablePluginFromThis = descriptor.enablePluginFromThis;
+        }
+      }
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Implementation::LoadDemangledNames(
+        const std::shared_ptr<void> &_dlHandle,
+        DemangledNameMap &_names)
+    {
+      void *metadataFuncPtr =
+          dlsym(_dlHandle.get(), "IgnitionPluginMetadataHook");
+      if (nullptr == metadataFuncPtr)
+        return;
+
+      using MetadataHookSignature =
+          void(*)(int *, const char **, const char **);
+
+      auto MetadataHook =
+          reinterpret_cast<MetadataHookSignature>(metadataFuncPtr);
+
+      int version = METADATA_API_VERSION;
+      const char *begin = nullptr;
+      const char *end = nullptr;
+      MetadataHook(&version, &begin, &end);
+
+      if (METADATA_API_VERSION != version || nullptr == begin || end <= begin)
+        return;
+
+      CollectDemangledNames(
+            begin, static_cast<std::size_t>(end - begin), _names);
+    }
+
+    /////////////////////////////////////////////////
+    std::string Loader::Implementation::LookupPlugin(
+        std::string_view _nameOrAlias) const
+    {
+      LookupStatus status;
+      const PluginMap::const_iterator plugin =
+          this->ResolvePlugin(_nameOrAlias, status);
+      if (this->plugins.end() == plugin)
+      {
+        this->ReportLookupFailure(_nameOrAlias, status);
+        return "";
+      }
+
+      return plugin->second->name;
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Implementation::PluginMap::const_iterator
+    Loader::Implementation::ResolvePlugin(
+        std::string_view _nameOrAlias,
+        LookupStatus &_status) const
+    {
+      const ResolvedName resolved = this->ResolveName(_nameOrAlias);
+      _status = resolved.status;
+      return resolved.plugin;
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Implementation::ResolvedName
+    Loader::Implementation::ResolveName(std::string_view _nameOrAlias) const
+    {
+      {
+        std::shared_lock<std::shared_mutex> lock(this->resolvedNamesMutex);
+        const auto it = this->resolvedNames.find(_nameOrAlias);
+        if (this->resolvedNames.end() != it)
+          return it->second;
+      }
+
+      ResolvedName resolved;
+      resolved.plugin = this->FindPlugin(_nameOrAlias, resolved.status);
+      resolved.dlHandle = nullptr;
+      if (this->plugins.end() != resolved.plugin)
+      {
+        const PluginToDlHandleMap::const_iterator dlHandle =
+            this->pluginToDlHandlePtrs.find(resolved.plugin->second->name);
+        if (this->pluginToDlHandlePtrs.end() != dlHandle)
+          resolved.dlHandle = &dlHandle->second;
+      }
+
+      std::unique_lock<std::shared_mutex> lock(this->resolvedNamesMutex);
+      if (this->resolvedNames.count(_nameOrAlias) > 0)
+        return resolved;
+
+      // Nobody holds on to the entries, since they are copied out, so they
+      // can be dropped at any time.
+      if (this->resolvedNames.size() >= maxResolvedNames)
+      {
+        this->resolvedNames.clear();
+        this->resolvedNameStorage.clear();
+      }
+
+      this->resolvedNameStorage.emplace_back(_nameOrAlias);
+      this->resolvedNames.emplace(this->resolvedNameStorage.back(), resolved);
+      return resolved;
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Implementation::AddAlias(
+        const std::string_view _alias,
+        const std::string_view _plugin)
+    {
+      SortedNameSet &aliased = this->aliases[_alias];
+      const std::size_t previous = aliased.size();
+      aliased.insert(_plugin);
+      if (aliased.size() < 2 || aliased.size() == previous)
+        return;
+
+      this->aliasCollisions.insert(_alias);
+      this->unreportedCollisions.insert(_alias);
+      if (!this->deferCollisionReports)
+        this->ReportAliasCollisions();
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Implementation::ReportAliasCollisions()
+    {
+      for (const std::string_view alias : this->unreportedCollisions)
+      {
+        // A later change of the same batch may have resolved the collision
+        if (!std::binary_search(this->aliasCollisions.begin(),
+                                this->aliasCollisions.end(), alias))
+        {
+          continue;
+        }
+
+        this->Log("[ignition::plugin::Loader::LoadLib] The alias [", alias,
+                  "] refers to multiple plugins, so it cannot be used to "
+                  "instantiate any of them:\n",
+                  PluginNameList{this->aliases.at(alias)});
+      }
+
+      this->unreportedCollisions = SortedNameSet();
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Implementation::RemoveAlias(
+        const std::string_view _alias,
+        const std::string_view _plugin)
+    {
+      const AliasMap::iterator entry = this->aliases.find(_alias);
+      if (this->aliases.end() == entry)
+        return;
+
+      entry->second.erase(_plugin);
+      if (entry->second.size() < 2)
+        this->aliasCollisions.erase(_alias);
+
+      if (entry->second.empty())
+        this->aliases.erase(entry);
+    }
+
+    /////////////////////////////////////////////////
+    std::vector<const Loader::Implementation::AliasMap::value_type*>
+    Loader::Implementation::AliasCollisions() const
+    {
+      // The collisions are sorted already
+      std::vector<const AliasMap::value_type*> collisions;
+      collisions.reserve(this->aliasCollisions.size());
+      for (const std::string_view alias : this->aliasCollisions)
+        collisions.push_back(&*this->aliases.find(alias));
+
+      return collisions;
+    }
+
+    /////////////////////////////////////////////////
+    void Loader::Implementation::InvalidateResolvedNames()
+    {
+      std::unique_lock<std::shared_mutex> lock(this->resolvedNamesMutex);
+      this->resolvedNames.clear();
+      this->resolvedNameStorage.clear();
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Implementation::PluginMap::const_iterator
+    Loader::Implementation::FindPlugin(
+        std::string_view _nameOrAlias,
+        LookupStatus &_status) const
+    {
+      const PluginMap::const_iterator name = this->plugins.find(_nameOrAlias);
+
+      if (this->plugins.end() != name)
+      {
+        _status = LookupStatus::FOUND;
+        return name;
+      }
+
+      const AliasMap::const_iterator alias = this->aliases.find(_nameOrAlias);
+      if (this->aliases.end() != alias && !alias->second.empty())
+      {
+        if (alias->second.size() == 1)
+        {
+          _status = LookupStatus::FOUND;
+          return this->plugins.find(*alias->second.begin());
+        }
+
+        _status = LookupStatus::AMBIGUOUS_ALIAS;
+        return this->plugins.end();
+      }
+
+      _status = LookupStatus::NOT_FOUND;
+      return this->plugins.end();
+    }
+
+    /////////////////////////////////////////////////
+    Loader::Implementation::PluginMap::const_iterator
+    Loader::Implementation::ResolveFastestPlugin(
+        std::string_view _nameOrAlias,
+        LookupStatus &_status) const
+    {
+      const PluginMap::const_iterator name = this->plugins.find(_nameOrAlias);
+      if (this->plugins.end() != name)
+      {
+        if (CpuSupportsAll(*name->second))
+        {
+          _status = LookupStatus::FOUND;
+          return name;
+        }
+
+        _status = LookupStatus::UNSUPPORTED_CPU;
+        return this->plugins.end();
+      }
+
+      const AliasMap::const_iterator alias = this->aliases.find(_nameOrAlias);
+      if (this->aliases.end() == alias || alias->second.empty())
+      {
+        _status = LookupStatus::NOT_FOUND;
+        return this->plugins.end();
+      }
+
+      // The names of the alias are sorted, so ties go to the first name
+      PluginMap::const_iterator best = this->plugins.end();
+      std::pair<int, std::size_t> bestScore;
+      for (const std::string_view pluginName : alias->second)
+      {
+        const PluginMap::const_iterator plugin = this->plugins.find(pluginName);
+        if (this->plugins.end() == plugin || !CpuSupportsAll(*plugin->second))
+          continue;
+
+        const std::pair<int, std::size_t> score = FeatureScore(*plugin->second);
+        if (this->plugins.end() == best || bestScore < score)
+        {
+          best = plugin;
+          bestScore = score;
+        }
+      }
+
+      _status = this->plugins.end() == best ?
+            LookupStatus::UNSUPPORTED_CPU : LookupStatus::FOUND;
+      return best;
     }
 
     /////////////////////////////////////////////////
-    std::unordered_set<std::string> Loader::InterfacesImplemented() const
+    void Loader::Implementation::ReportLookupFailure(
+        std::string_view _nameOrAlias,
+        const LookupStatus _status) const
     {
-      std::unordered_set<std::string> interfaces;
-      for (auto const &plugin : this->dataPtr->plugins)
+      if (LookupStatus::AMBIGUOUS_ALIAS == _status)
       {
-        for (auto const &interface : plugin.second->demangledInterfaces)
-          interfaces.insert(interface);
+        this->Log("[ignition::plugin::Loader::LookupPlugin] Failed to resolve "
+                  "the alias [", _nameOrAlias, "] because it refers to "
+                  "multiple plugins:\n",
+                  PluginNameList{this->aliases.find(_nameOrAlias)->second});
+        return;
       }
-      return interfaces;
+
+      if (LookupStatus::UNSUPPORTED_CPU == _status)
+      {
+        const PluginMap::const_iterator plugin =
+            this->plugins.find(_nameOrAlias);
+        if (this->plugins.end() != plugin)
+        {
+          this->Log("[ignition::plugin::Loader::LookupPlugin] The plugin [",
+                    _nameOrAlias, "] requires CPU features which this CPU "
+                    "does not support:\n",
+                    FeatureList{plugin->second->requiredFeatures});
+          return;
+        }
+
+        this->Log("[ignition::plugin::Loader::LookupPlugin] None of the "
+                  "plugins with the alias [", _nameOrAlias, "] can run on "
+                  "this CPU:\n",
+                  PluginNameList{this->aliases.find(_nameOrAlias)->second});
+        return;
+      }
+
+      this->Log("[ignition::plugin::Loader::LookupPlugin] Failed to get info "
+                "for [", _nameOrAlias, "]. Could not find a plugin with that "
+                "name or alias.\n");
     }
 
     /////////////////////////////////////////////////
-    std::unordered_set<std::string> Loader::PluginsImplementing(
-        const std::string &_interface,
-        const bool demangled) const
+    bool Loader::Implementation::AdmitLogMessage() const
     {
-      std::unordered_set<std::string> plugins;
+      if (0 == this->maxLogMessagesPerSecond)
+        return true;
 
-      if (demangled)
+      const std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now();
+      if (now - this->logWindowStart >= std::chrono::seconds(1))
       {
-        for (auto const &plugin : this->dataPtr->plugins)
+        if (this->droppedLogMessages > 0)
         {
-          if (plugin.second->demangledInterfaces.find(_interface) !=
-              plugin.second->demangledInterfaces.end())
-            plugins.insert(plugin.second->name);
+          std::stringstream ss;
+          ss << "[ignition::plugin::Loader] " << this->droppedLogMessages
+             << " diagnostic message"
+             << (this->droppedLogMessages == 1 ? " was" : "s were")
+             << " dropped by the rate limit.\n";
+          this->WriteLogMessage(ss.str());
+          this->droppedLogMessages = 0;
         }
+
+        this->logWindowStart = now;
+        this->logMessagesInWindow = 0;
       }
-      else
+
+      if (this->logMessagesInWindow >= this->maxLogMessagesPerSecond)
       {
-        for (auto const &plugin : this->dataPtr->plugins)
-        {
-          if (plugin.second->interfaces.find(_interface) !=
-              plugin.second->interfaces.end())
-            plugins.insert(plugin.second->name);
-        }
+        ++this->droppedLogMessages;
+        return false;
       }
 
-      return plugins;
+      ++this->logMessagesInWindow;
+      return true;
     }
 
     /////////////////////////////////////////////////
-    std::set<std::string> Loader::AllPlugins() const
+    void Loader::Implementation::WriteLogMessage(
+        const std::string &_message) const
     {
-      std::set<std::string> result;
-
-      for (const auto &entry : this->dataPtr->plugins)
-        result.insert(result.end(), entry.first);
-
-      return result;
+      if (this->logger)
+        this->logger(_message);
+      else
+        std::cerr << _message;
     }
 
     /////////////////////////////////////////////////
-    std::set<std::string> Loader::PluginsWithAlias(
-        const std::string &_alias) const
+    Loader::LookupStatus Loader::Implementation::GetInfoAndDlHandle(
+        std::string_view _nameOrAlias,
+        ConstInfoPtr &_info,
+        std::shared_ptr<void> &_dlHandle,
+        std::string &_deferredLibrary) const
     {
-      std::set<std::string> result;
+      const ResolvedName resolved = this->ResolveName(_nameOrAlias);
+      const PluginMap::const_iterator info = resolved.plugin;
+      if (this->plugins.end() == info)
+        return resolved.status;
 
-      const Implementation::AliasMap::const_iterator names =
-          this->dataPtr->aliases.find(_alias);
+      // Refuse plugins which would crash on this CPU, before their library
+      // gets opened
+      if (!info->second->requiredFeatures.empty() &&
+          !CpuSupportsAll(*info->second))
+      {
+        return LookupStatus::UNSUPPORTED_CPU;
+      }
 
-      if (names != this->dataPtr->aliases.end())
-        result = names->second;
+      const std::string &resolvedName = info->second->name;
 
-      const Implementation::PluginMap::const_iterator plugin =
-          this->dataPtr->plugins.find(_alias);
+      // A deferred plugin has no library handle yet
+      if (!resolved.dlHandle)
+      {
+        const DeferredPluginMap::const_iterator deferred =
+            this->deferredPlugins.find(resolvedName);
+        if (this->deferredPlugins.end() != deferred)
+        {
+          _deferredLibrary = deferred->second;
+          return LookupStatus::LIBRARY_UNAVAILABLE;
+        }
 
-      if (plugin != this->dataPtr->plugins.end())
-        result.insert(_alias);
+        // LCOV_EXCL_START
+        std::cerr << "[ignition::Loader::GetInfoAndDlHandle] A resolved name ["
+                  << resolvedName << "] could not be found in the "
+                  << "PluginToDlHandleMap. This should not be possible! "
+                  << "Please report this bug!\n";
+        assert(false);
+        return LookupStatus::NOT_FOUND;
+        // LCOV_EXCL_STOP
+      }
 
-      return result;
+      if (this->EvictionEnabled())
+      {
+        const DlHandleToPluginMap::const_iterator library =
+            this->dlHandleToPluginMap.find(resolved.dlHandle->get());
+        if (this->dlHandleToPluginMap.end() != library)
+        {
+          library->second.lastUsed.store(
+                ++this->useClock, std::memory_order_relaxed);
+        }
+      }
+
+      _info = info->second;
+      _dlHandle = *resolved.dlHandle;
+      return LookupStatus::FOUND;
     }
 
     /////////////////////////////////////////////////
-    std::set<std::string> Loader::AliasesOfPlugin(
-        const std::string &_pluginName) const
+    const InterfaceBitTable &Loader::Implementation::InterfaceMask(
+        const std::vector<std::string_view> &_interfaces,
+        const bool _demangled,
+        InterfaceBitTable::Bits &_mask,
+        const bool _partial) const
     {
-      const Implementation::PluginMap::const_iterator plugin =
-          this->dataPtr->plugins.find(_pluginName);
+      const InterfaceBitTable &table = _demangled ?
+            this->demangledInterfaceBits : this->interfaceBits;
 
-      if (plugin != this->dataPtr->plugins.end())
-        return plugin->second->aliases;
+      std::vector<std::string_view> interfaces;
+      interfaces.reserve(_interfaces.size());
+      for (const std::string_view name : _interfaces)
+      {
+        // Every interface in the tables has been interned, so a name which
+        // was never interned cannot be in them.
+        const std::string_view interface = this->names.Find(name);
+        if (nullptr != interface.data())
+          interfaces.push_back(interface);
+      }
 
-      return {};
-    }
+      if (table.Mask(interfaces, _mask) != _interfaces.size() && !_partial)
+        _mask.clear();
 
-    /////////////////////////////////////////////////
-    std::string Loader::LookupPlugin(const std::string &_nameOrAlias) const
-    {
-      return this->dataPtr->LookupPlugin(_nameOrAlias);
+      return table;
     }
 
     /////////////////////////////////////////////////
-    PluginPtr Loader::Instantiate(const std::string &_pluginNameOrAlias) const
+    void Loader::Implementation::IndexInterfaces(const Info &_info)
     {
-      const std::string &resolvedName = this->LookupPlugin(_pluginNameOrAlias);
-      if (resolvedName.empty())
-        return PluginPtr();
+      const std::string_view name = this->names.Intern(_info.name);
 
-      PluginPtr ptr(this->PrivateGetInfo(resolvedName),
-                    this->PrivateGetPluginDlHandlePtr(resolvedName));
+      for (const auto &interface : _info.interfaces)
+      {
+        const std::string_view key = this->names.Intern(interface.first);
+        this->interfaceIndex[key].insert(name);
+        this->interfaceBits.Add(name, key);
+      }
 
-      if (auto *enableFromThis = ptr->QueryInterface<EnablePluginFromThis>())
-        enableFromThis->PrivateSetPluginFromThis(ptr);
+      for (const std::string &interface : _info.demangledInterfaces)
+      {
+        const std::string_view key = this->names.Intern(interface);
+        DenseNameSet &implementers = this->demangledInterfaceIndex[key];
+        if (implementers.empty())
+          this->interfacesImplemented.insert(interface);
 
-      return ptr;
+        implementers.insert(name);
+        this->demangledInterfaceBits.Add(name, key);
+      }
     }
 
     /////////////////////////////////////////////////
-    bool Loader::ForgetLibrary(const std::string &_pathToLibrary)
+    void Loader::Implementation::UnindexInterfaces(const Info &_info)
     {
-#ifndef RTLD_NOLOAD
-// This macro is not part of the POSIX standard, and is a custom addition to
-// glibc-2.2, so we need create a no-op stand-in flag for it if we are not
-// using glibc-2.2.
-#define RTLD_NOLOAD 0
-#endif
-
-      void *dlHandle = dlopen(_pathToLibrary.c_str(),
-                              RTLD_NOLOAD | RTLD_LAZY | RTLD_LOCAL);
+      // Every name in the indexes has been interned, so a name which was
+      // never interned cannot be in them.
+      const std::string_view name = this->names.Find(_info.name);
+      if (nullptr == name.data())
+        return;
 
-      if (!dlHandle)
-        return false;
-
-      // We should decrement the reference count because we called dlopen. Even
-      // with the RTLD_NOLOAD flag, the call to dlopen will still (allegedly)
-      // increment the reference count when it returns a valid handle. Note that
-      // this knowledge is according to online discussions and is not explicitly
-      // stated in the manual pages of dlopen (but it is consistent with the
-      // overall behavior of dlopen).
-      dlclose(dlHandle);
+      // Returns true if the interface is no longer implemented by any plugin
+      const auto removeFrom = [&](InterfaceIndex &_index,
+                                  const std::string &_interface)
+      {
+        const InterfaceIndex::iterator it =
+            _index.find(this->names.Find(_interface));
+        if (_index.end() == it)
+          return false;
 
-      return this->dataPtr->ForgetLibrary(dlHandle);
-    }
+        it->second.erase(name);
+        if (!it->second.empty())
+          return false;
 
-    /////////////////////////////////////////////////
-    bool Loader::ForgetLibraryOfPlugin(const std::string &_pluginNameOrAlias)
-    {
-      const std::string &resolvedName = this->LookupPlugin(_pluginNameOrAlias);
+        _index.erase(it);
+        return true;
+      };
 
-      Implementation::PluginToDlHandleMap::iterator it =
-          dataPtr->pluginToDlHandlePtrs.find(resolvedName);
+      for (const auto &interface : _info.interfaces)
+        removeFrom(this->interfaceIndex, interface.first);
 
-      if (dataPtr->pluginToDlHandlePtrs.end() == it)
-        return false;
+      this->interfaceBits.Remove(name);
+      this->demangledInterfaceBits.Remove(name);
 
-      return dataPtr->ForgetLibrary(it->second.get());
+      for (const std::string &interface : _info.demangledInterfaces)
+      {
+        if (removeFrom(this->demangledInterfaceIndex, interface))
+          this->interfacesImplemented.erase(interface);
+      }
     }
 
     /////////////////////////////////////////////////
-    ConstInfoPtr Loader::PrivateGetInfo(
-        const std::string &_resolvedName) const
+    void Loader::Implementation::ForgetPlugin(const std::string &_name)
     {
-      const Implementation::PluginMap::const_iterator it =
-          this->dataPtr->plugins.find(_resolvedName);
+      const PluginMap::iterator it = this->plugins.find(_name);
+      if (this->plugins.end() == it)
+        return;
 
-      if (this->dataPtr->plugins.end() == it)
+      this->InvalidateResolvedNames();
+
+      // The idle instances of a forgotten plugin must not be handed out again
+      std::shared_ptr<InstancePool> pool;
       {
-        // LCOV_EXCL_START
-        std::cerr << "[ignition::Loader::PrivateGetInfo] A resolved name ["
-                  << _resolvedName << "] could not be found in the PluginMap. "
-                  << "This should not be possible! Please report this bug!\n";
-        assert(false);
-        return nullptr;
-        // LCOV_EXCL_STOP
+        std::unique_lock<std::mutex> poolsLock(this->instancePoolsMutex);
+        const auto entry = this->instancePools.find(_name);
+        if (this->instancePools.end() != entry)
+        {
+          pool = std::move(entry->second);
+          this->instancePools.erase(entry);
+          --this->instancePoolCount;
+        }
       }
 
-      return it->second;
+      // The cached factory of a forgotten plugin must not be handed out
+      // again either
+      PluginPtr factory;
+      {
+        std::unique_lock<std::shared_mutex> factoriesLock(
+              this->factoriesMutex);
+        const auto entry = this->factories.find(_name);
+        if (this->factories.end() != entry)
+        {
+          factory = std::move(entry->second);
+          this->factories.erase(entry);
+        }
+      }
+
+      // Erase each alias entry corresponding to this plugin, and drop the
+      // aliases which no longer refer to any plugin
+      const ConstInfoPtr &info = it->second;
+      for (const std::string &alias : info->aliases)
+        this->RemoveAlias(alias, info->name);
+
+      this->pluginAliases.erase(this->names.Find(_name));
+
+      // Erase each interface index entry corresponding to this plugin
+      this->UnindexInterfaces(*info);
+
+      this->pluginNames.erase(_name);
+      this->deferredPlugins.erase(_name);
+
+      // CRUCIAL DEV NOTE (MXG): Be sure to erase the Info from
+      // `plugins` BEFORE erasing the plugin entry in `pluginToDlHandlePtrs`,
+      // because the Info structs must never outlive the library that their
+      // function pointers point into.
+
+      // This erase should come FIRST.
+      this->plugins.erase(it);
+
+      // This erase should come LAST.
+      this->pluginToDlHandlePtrs.erase(_name);
     }
 
     /////////////////////////////////////////////////
-    std::shared_ptr<void> Loader::PrivateGetPluginDlHandlePtr(
-        const std::string &_resolvedName) const
+    bool Loader::Implementation::ForgetDeferredLibrary(const std::string &_path)
     {
-      Implementation::PluginToDlHandleMap::iterator it =
-          dataPtr->pluginToDlHandlePtrs.find(_resolvedName);
+      const DeferredLibraryMap::iterator it =
+          this->deferredLibraries.find(_path);
+      if (this->deferredLibraries.end() == it)
+        return false;
 
-      if (this->dataPtr->pluginToDlHandlePtrs.end() == it)
-      {
-        // LCOV_EXCL_START
-        std::cerr << "[ignition::Loader::PrivateGetInfo] A resolved name ["
-                  << _resolvedName << "] could not be found in the "
-                  << "PluginToDlHandleMap. This should not be possible! Please "
-                  << "report this bug!\n";
-        assert(false);
-        return nullptr;
-        // LCOV_EXCL_STOP
-      }
+      const bool hadPlugins = !it->second.plugins.empty();
+      for (const std::string &forget : it->second.plugins)
+        this->ForgetPlugin(forget);
 
-      return it->second;
+      this->deferredLibraries.erase(it);
+      return hadPlugins;
     }
 
     /////////////////////////////////////////////////
-    std::shared_ptr<void> Loader::Implementation::LoadLib(
-        const std::string &_full_path)
+    bool Loader::Implementation::ForgetLibraryPath(const std::string &_path)
     {
-      std::shared_ptr<void> dlHandlePtr;
-
-      // Call dlerror() before dlopen(~) to ensure that we get accurate error
-      // reporting afterwards. The function dlerror() is stateful, and that
-      // state gets cleared each time it is called.
-      dlerror();
-
-      // NOTE: We open using RTLD_LOCAL instead of RTLD_GLOBAL to prevent the
-      // symbols of different libraries from writing over each other.
-      void *dlHandle = dlopen(_full_path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+      bool forgotten = false;
+      const LoadedLibraryMap::const_iterator loaded =
+          this->loadedLibraries.find(_path);
+      if (this->loadedLibraries.end() != loaded)
+        forgotten = this->ForgetLibrary(loaded->second.dlHandle);
 
-      const char *loadError = dlerror();
-      if (nullptr == dlHandle || nullptr != loadError)
-      {
-        std::cerr << "Error while loading the library [" << _full_path << "]: "
-                  << loadError << std::endl;
+      // The library might also be known to this Loader without having been
+      // opened yet.
+      return this->ForgetDeferredLibrary(_path) || forgotten;
+    }
 
-        // Just return a nullptr if the library could not be loaded. The
-        // Loader::LoadLib(~) function will handle this gracefully.
-        return nullptr;
-      }
+    /////////////////////////////////////////////////
+    bool Loader::Implementation::ForgetLibrary(void *_dlHandle)
+    {
+      DlHandleToPluginMap::iterator it = dlHandleToPluginMap.find(_dlHandle);
+      if (dlHandleToPluginMap.end() == it)
+        return false;
 
-      // The dl library maintains a reference count of how many times dlopen(~)
-      // or dlclose(~) has been called on each loaded library. dlopen(~)
-      // increments the reference count while dlclose(~) decrements the count.
-      // When the count reaches zero, the operating system is free to unload
-      // the library (which it might or might not choose to do; we do not seem
-      // to have control over that, probably for the best).
+      const OpenLibrary &forgotten = it->second;
 
-      // The idea in our implementation here is to first check if the library
-      // has already been loaded by this Loader. If it has been, then we
-      // will see it in the dlHandlePtrMap, and we'll be able to get a shared
-      // reference to its handle. The advantage of this is it allows us to keep
-      // track of how many places the shared library is being used by plugins
-      // that were generated from this Loader. When all of the instances
-      // spawned by this Loader are gone, the destructor of the
-      // std::shared_ptr will call dlclose on the library handle, bringing down
-      // its dl library reference count.
+      for (const std::string_view forget : forgotten.plugins)
+        this->ForgetPlugin(std::string(forget));
 
-      bool inserted;
-      DlHandleMap::iterator it;
-      std::tie(it, inserted) = this->dlHandlePtrMap.insert(
-            std::make_pair(dlHandle, std::weak_ptr<void>()));
+      // Dev note (MXG): We do not need to delete anything from the
+      // LibraryCache because it uses std::weak_ptrs. It will clear itself
+      // automatically.
 
-      if (!inserted)
+      // A path may have been taken over by a newer version of the library, in
+      // which case its entry belongs to that version.
+      for (const std::string &path : forgotten.paths)
       {
-        // This shared library has already been loaded by this Loader in
-        // the past, so we should use the reference counter that already
-        // exists for it.
-        dlHandlePtr = it->second.lock();
-
-        if (dlHandlePtr)
+        const LoadedLibraryMap::iterator loaded =
+            this->loadedLibraries.find(path);
+        if (this->loadedLibraries.end() != loaded &&
+            loaded->second.dlHandle == _dlHandle)
         {
-          // The reference counter of this library is still active.
-
-          // The functions dlopen and dlclose keep their own independent
-          // counters for how many times each of them has been called. The
-          // library is unloaded once dlclose has been called as many times as
-          // dlopen.
-          //
-          // At this line of code, we know that dlopen had been called by this
-          // Loader instance prior to this run of LoadLib. Therefore,
-          // we should undo the dlopen that we did just a moment ago in this
-          // function so that only one dlclose must be performed to finally
-          // close the shared library. That final dlclose will be performed in
-          // the destructor of the std::shared_ptr<void> which stores the
-          // library handle.
-          dlclose(dlHandle);
+          this->loadedLibraries.erase(loaded);
         }
       }
 
-      if (!dlHandlePtr)
-      {
-        // The library was not already loaded (or if it was loaded in the past,
-        // it is no longer active), so we should create a reference counting
-        // handle for it.
-        dlHandlePtr = std::shared_ptr<void>(
-              dlHandle, [](void *ptr) { dlclose(ptr); }); // NOLINT
+      // Remember the library for as long as something keeps it open
+      this->forgottenLibraries.push_back(ForgottenLibrary{
+          forgotten.paths.empty() ? std::string() : forgotten.paths.front(),
+          forgotten.handle});
 
-        it->second = dlHandlePtr;
-      }
+      // Dev note (MXG): This erase call should come at the very end of this
+      // function to ensure that the `forgotten` reference remains valid while
+      // it is being used.
+      dlHandleToPluginMap.erase(it);
 
-      return dlHandlePtr;
+      this->forgottenLibraries.erase(
+            std::remove_if(this->forgottenLibraries.begin(),
+                           this->forgottenLibraries.end(),
+                           [](const ForgottenLibrary &_library)
+                           {
+                             return _library.handle.expired();
+                           }),
+            this->forgottenLibraries.end());
+
+      // Dev note (MXG): We do not need to call dlclose because that will be
+      // taken care of automatically by the std::shared_ptr that manages the
+      // shared library handle.
+
+      return true;
     }
 
     /////////////////////////////////////////////////
-    std::vector<Info> Loader::Implementation::LoadPlugins(
-        const std::shared_ptr<void> &_dlHandle,
-        const std::string& _pathToLibrary) const
+    std::size_t Loader::Implementation::ExternalReferences(
+        const OpenLibrary &_library) const
     {
-      std::vector<Info> loadedPlugins;
-
-      // This function should never be called with a nullptr _dlHandle
-      assert(_dlHandle &&
-             "Bug in code: Loader::Implementation::LoadPlugins was called with "
-             "a nullptr value for _dlHandle.");
-
-      const std::string infoSymbol = "IgnitionPluginHook";
-      void *infoFuncPtr = dlsym(_dlHandle.get(), infoSymbol.c_str());
-
-      // Does the library have the right symbol?
-      if (nullptr == infoFuncPtr)
+      // Besides the references that were handed out, the handle is referenced
+      // by the library entry and by the plugins of the library which this
+      // Loader still maps to it.
+      std::size_t internal = 1;
+      for (const std::string_view name : _library.plugins)
       {
-        std::cerr << "Library [" << _pathToLibrary << "] does not export any "
-                  << "plugins. The symbol [" << infoSymbol << "] is missing, "
-                  << "or it is not externally visible.\n";
-
-        return loadedPlugins;
+        const PluginToDlHandleMap::const_iterator plugin =
+            this->pluginToDlHandlePtrs.find(std::string(name));
+        if (this->pluginToDlHandlePtrs.end() != plugin &&
+            !plugin->second.owner_before(_library.handle) &&
+            !_library.handle.owner_before(plugin->second))
+        {
+          ++internal;
+        }
       }
 
-      using PluginLoadFunctionSignature =
-          void(*)(void * const, const void ** const,
-                  int *, std::size_t *, std::size_t *);
-
-      // Note: InfoHook (below) is a function with a signature that matches
-      // PluginLoadFunctionSignature.
-      auto InfoHook =
-          reinterpret_cast<PluginLoadFunctionSignature>(infoFuncPtr);
+      const std::size_t useCount =
+          static_cast<std::size_t>(_library.handle.use_count());
+      return useCount > internal ? useCount - internal : 0;
+    }
 
-      int version = INFO_API_VERSION;
-      std::size_t size = sizeof(Info);
-      std::size_t alignment = alignof(Info);
-      const InfoMap *allInfo = nullptr;
+    /////////////////////////////////////////////////
+    bool Loader::Implementation::EvictionEnabled() const
+    {
+      return 0 != this->evictionPolicy.maxLibraries
+          || 0 != this->evictionPolicy.maxBytes;
+    }
 
-      // Note: static_cast cannot be used to convert from a T** to a void**
-      // because of the possibility of breaking the type system by assigning a
-      // Non-T pointer to the T* memory location. However, we need to retrieve
-      // a reference to an STL-type using a C-compatible function signature, so
-      // we resort to a reinterpret_cast to achieve this.
-      //
-      // Despite its many dangers, reinterpret_cast is well-defined for casting
-      // between pointer types as of C++11, as explained in bullet point 1 of
-      // the "Explanation" section in this reference:
-      // http://en.cppreference.com/w/cpp/language/reinterpret_cast
-      //
-      // We have a tight grip over the implementation of how the `allInfo`
-      // pointer gets used, so we do not need to worry about its memory address
-      // being filled with a non-compatible type. The only risk would be if a
-      // user decides to implement their own version of
-      // IgnitionPluginHook, but they surely would have no
-      // incentive in doing that.
-      //
-      // Also note that the main reason we jump through these hoops is in order
-      // to safely support plugin libraries on Windows that choose to compile
-      // against the static runtime. Using this pointer-to-a-pointer approach is
-      // the cleanest way to ensure that all dynamically allocated objects are
-      // deleted in the same heap that they were allocated from.
-      InfoHook(nullptr, reinterpret_cast<const void**>(&allInfo),
-           &version, &size, &alignment);
+    /////////////////////////////////////////////////
+    std::size_t Loader::Implementation::EvictIdleLibraries(const void *_keep)
+    {
+      if (!this->EvictionEnabled())
+        return 0;
 
-      if (ignition::plugin::INFO_API_VERSION != version)
-      {
-        // TODO(anyone): When we need to support multiple API versions,
-        // put the logic for it into here.
-        // We can call IgnitionPluginHook(~) again with the
-        // API version that it expects.
+      const EvictionPolicy &policy = this->evictionPolicy;
+      std::size_t openCount = 0;
+      std::uint64_t openBytes = 0;
 
-        std::cerr << "The library [" << _pathToLibrary << "] is using an "
-                  << "incompatible version [" << version << "] of the "
-                  << "ignition::plugin Info API. The version in this library "
-                  << "is [" << INFO_API_VERSION << "].\n";
-        return loadedPlugins;
-      }
+      // The idle libraries, along with when they were last used
+      std::vector<std::pair<std::uint64_t, void*>> candidates;
 
-      if (sizeof(Info) != size || alignof(Info) != alignment)
+      for (const auto &entry : this->dlHandleToPluginMap)
       {
-        std::cerr << "The plugin::Info size or alignment are not consistent "
-               << "with the expected values for the library [" << _pathToLibrary
-               << "]:\n -- size: expected " << sizeof(Info)
-               << " | received " << size << "\n -- alignment: expected "
-               << alignof(Info) << " | received " << alignment << "\n"
-               << " -- We will not be able to safely load plugins from that "
-               << "library.\n";
+        const OpenLibrary &library = entry.second;
 
-        return loadedPlugins;
-      }
+        // Plugins which are linked into the program cannot be opened again
+        if (library.paths.empty())
+          continue;
 
-      if (!allInfo)
-      {
-        std::cerr << "The library [" << _pathToLibrary << "] failed to provide "
-                  << "ignition::plugin Info for unknown reasons. Please report "
-                  << "this error as a bug!\n";
+        ++openCount;
+        const LoadedLibraryMap::const_iterator loaded =
+            this->loadedLibraries.find(library.paths.front());
+        if (this->loadedLibraries.end() != loaded)
+          openBytes += loaded->second.fileSize;
 
-        return loadedPlugins;
+        if (entry.first != _keep && 0 == this->ExternalReferences(library))
+        {
+          candidates.emplace_back(
+                library.lastUsed.load(std::memory_order_relaxed), entry.first);
+        }
       }
 
-      for (const InfoMap::value_type &info : *allInfo)
+      const auto exceeded = [&]()
       {
-        loadedPlugins.push_back(info.second);
-      }
+        return (0 != policy.maxLibraries && openCount > policy.maxLibraries)
+            || (0 != policy.maxBytes && openBytes > policy.maxBytes);
+      };
 
-      return loadedPlugins;
-    }
-
-    /////////////////////////////////////////////////
-    std::string Loader::Implementation::LookupPlugin(
-        const std::string &_nameOrAlias) const
-    {
-      const PluginMap::const_iterator name = this->plugins.find(_nameOrAlias);
+      if (!exceeded())
+        return 0;
 
-      if (this->plugins.end() != name)
-        return _nameOrAlias;
+      std::sort(candidates.begin(), candidates.end());
 
-      const AliasMap::const_iterator alias = this->aliases.find(_nameOrAlias);
-      if (this->aliases.end() != alias && !alias->second.empty())
+      std::size_t evicted = 0;
+      for (const auto &candidate : candidates)
       {
-        if (alias->second.size() == 1)
-          return *alias->second.begin();
-
-        // We use a stringstream because we're going to output to std::cerr, and
-        // we want it all to print at once, but std::cerr does not support
-        // buffering.
-        std::stringstream ss;
+        if (!exceeded())
+          break;
 
-        ss << "[ignition::plugin::Loader::LookupPlugin] Failed to resolve the "
-           << "alias [" << _nameOrAlias << "] because it refers to multiple "
-           << "plugins:\n";
-        for (const std::string &plugin : alias->second)
-          ss << " -- [" << plugin << "]\n";
+        // Describe the library before forgetting it, so that its plugins can
+        // be deferred to it.
+        LoadOptions options;
+        const ManifestLibrary described = this->DescribeOpenLib(
+              this->dlHandleToPluginMap.at(candidate.second), options);
 
-        std::cerr << ss.str();
+        this->ForgetLibrary(candidate.second);
+        this->RegisterDeferredLib(described, options);
 
-        return "";
+        --openCount;
+        openBytes -= described.fileSize;
+        ++evicted;
       }
 
-      std::cerr << "[ignition::plugin::Loader::LookupPlugin] Failed to get "
-                << "info for [" << _nameOrAlias << "]. Could not find a plugin "
-                << "with that name or alias.\n";
-
-      return "";
+      return evicted;
     }
 
     /////////////////////////////////////////////////
-    bool Loader::Implementation::ForgetLibrary(void *_dlHandle)
+    ManifestLibrary Loader::Implementation::DescribeOpenLib(
+        const OpenLibrary &_library, LoadOptions &_options) const
     {
-      DlHandleToPluginMap::iterator it = dlHandleToPluginMap.find(_dlHandle);
-      if (dlHandleToPluginMap.end() == it)
-        return false;
-
-      const std::unordered_set<std::string> &forgottenPlugins = it->second;
+      ManifestLibrary described;
+      described.path = _library.paths.front();
 
-      for (const std::string &forget : forgottenPlugins)
+      _options = this->defaultLoadOptions;
+      const LoadedLibraryMap::const_iterator loaded =
+          this->loadedLibraries.find(described.path);
+      if (this->loadedLibraries.end() != loaded)
       {
-        // Erase each alias entry corresponding to this plugin
-        const ConstInfoPtr &info = plugins.at(forget);
-        for (const std::string &alias : info->aliases)
-          this->aliases.at(alias).erase(info->name);
+        _options = loaded->second.options;
+        described.modificationTime = loaded->second.modificationTime;
+        described.fileSize = loaded->second.fileSize;
       }
 
-      for (const std::string &forget : forgottenPlugins)
+      for (const std::string_view name : _library.plugins)
       {
-        // CRUCIAL DEV NOTE (MXG): Be sure to erase the Info from
-        // `plugins` BEFORE erasing the plugin entry in `pluginToDlHandlePtrs`,
-        // because the Info structs require the library to remain loaded
-        // for the destructors of their `deleter` member variables.
-
-        // This erase should come FIRST.
-        plugins.erase(forget);
-
-        // This erase should come LAST.
-        pluginToDlHandlePtrs.erase(forget);
+        const PluginMap::const_iterator plugin = this->plugins.find(name);
+        if (this->plugins.end() != plugin)
+          described.plugins.push_back(ManifestPlugin::FromInfo(
+                *plugin->second));
       }
 
-      // Dev note (MXG): We do not need to delete anything from `dlHandlePtrMap`
-      // because it uses std::weak_ptrs. It will clear itself automatically.
-
-      // Dev note (MXG): This erase call should come at the very end of this
-      // function to ensure that the `forgottenPlugins` reference remains valid
-      // while it is being used.
-      dlHandleToPluginMap.erase(it);
-
-      // Dev note (MXG): We do not need to call dlclose because that will be
-      // taken care of automatically by the std::shared_ptr that manages the
-      // shared library handle.
-
-      return true;
+      return described;
     }
   }
 }
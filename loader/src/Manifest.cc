@@ -0,0 +1,430 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "BuildId.hh"
+#include "Manifest.hh"
+
+namespace
+{
+  /// \brief Identifies a manifest file. The last character doubles as the
+  /// version of the format, so increment it whenever the layout changes.
+  const char kManifestMagic[8] = {'I', 'G', 'N', 'P', 'L', 'G', 'M', '3'};
+
+  /////////////////////////////////////////////////
+  /// \brief Get a name for a temporary file next to a file, which no other
+  /// process or thread uses at the same time, so that each writer renames
+  /// its own complete file over the target.
+  /// \param[in] _file The file which the temporary file will replace
+  /// \return The path of the temporary file
+  std::string TemporaryPath(const std::string &_file)
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    static const unsigned long long process =
+        static_cast<unsigned long long>(getpid());
+#else
+    static const unsigned long long process = std::random_device()();
+#endif
+    static std::atomic<unsigned long long> counter(0);
+
+    return _file + ".tmp." + std::to_string(process) + "." +
+        std::to_string(counter++);
+  }
+
+  /////////////////////////////////////////////////
+  template <typename T>
+  void WriteValue(std::ostream &_out, const T &_value)
+  {
+    _out.write(reinterpret_cast<const char*>(&_value), sizeof(T));
+  }
+
+  /////////////////////////////////////////////////
+  void WriteString(std::ostream &_out, const std::string &_value)
+  {
+    WriteValue(_out, static_cast<std::uint32_t>(_value.size()));
+    _out.write(_value.data(), static_cast<std::streamsize>(_value.size()));
+  }
+
+  /////////////////////////////////////////////////
+  void WriteStrings(std::ostream &_out, const std::set<std::string> &_values)
+  {
+    WriteValue(_out, static_cast<std::uint32_t>(_values.size()));
+    for (const std::string &value : _values)
+      WriteString(_out, value);
+  }
+
+  /////////////////////////////////////////////////
+  template <typename T>
+  bool ReadValue(std::istream &_in, T &_value)
+  {
+    return static_cast<bool>(
+          _in.read(reinterpret_cast<char*>(&_value), sizeof(T)));
+  }
+
+  /////////////////////////////////////////////////
+  bool ReadString(std::istream &_in, std::string &_value)
+  {
+    std::uint32_t size;
+    if (!ReadValue(_in, size))
+      return false;
+
+    // Names of plugins and interfaces are never anywhere near this long, so
+    // this can only be a corrupted file.
+    if (size > (1u << 20))
+      return false;
+
+    _value.resize(size);
+    return static_cast<bool>(_in.read(&_value[0], size));
+  }
+
+  /////////////////////////////////////////////////
+  bool ReadStrings(std::istream &_in, std::set<std::string> &_values)
+  {
+    std::uint32_t count;
+    if (!ReadValue(_in, count))
+      return false;
+
+    std::string value;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+      if (!ReadString(_in, value))
+        return false;
+
+      _values.insert(_values.end(), value);
+    }
+
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Express the path of a library relative to a directory, as long
+  /// as the library is inside of that directory.
+  /// \param[in] _path The canonical path to a library
+  /// \param[in] _directory The canonical path to a directory
+  /// \return The relative path, or _path if the library is not inside of
+  /// the directory (or if _directory is empty).
+  std::string RelativeLibraryPath(const std::string &_path,
+                                  const std::filesystem::path &_directory)
+  {
+    const std::filesystem::path relative =
+        std::filesystem::path(_path).lexically_relative(_directory);
+
+    if (relative.empty() || *relative.begin() == "..")
+      return _path;
+
+    return relative.string();
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    ManifestPlugin ManifestPlugin::FromInfo(const Info &_info)
+    {
+      ManifestPlugin plugin;
+      plugin.name = _info.name;
+      plugin.aliases = _info.aliases;
+      for (const auto &interface : _info.interfaces)
+        plugin.interfaces.insert(interface.first);
+      plugin.demangledInterfaces.insert(
+            _info.demangledInterfaces.begin(), _info.demangledInterfaces.end());
+      plugin.requiredFeatures = _info.requiredFeatures;
+      return plugin;
+    }
+
+    /////////////////////////////////////////////////
+    Info ManifestPlugin::ToInfo() const
+    {
+      Info info;
+      info.name = this->name;
+      info.aliases = this->aliases;
+      for (const std::string &interface : this->interfaces)
+        info.interfaces.insert(std::make_pair(interface, nullptr));
+      info.demangledInterfaces.insert(
+            this->demangledInterfaces.begin(), this->demangledInterfaces.end());
+      info.requiredFeatures = this->requiredFeatures;
+      return info;
+    }
+
+    /////////////////////////////////////////////////
+    bool ManifestLibrary::Stat(const std::string &_pathToLibrary,
+                               ManifestLibrary &_library)
+    {
+      std::error_code ec;
+      const std::filesystem::file_time_type time =
+          std::filesystem::last_write_time(_pathToLibrary, ec);
+      if (ec)
+        return false;
+
+      const std::uintmax_t size =
+          std::filesystem::file_size(_pathToLibrary, ec);
+      if (ec)
+        return false;
+
+      _library.path = CanonicalLibraryPath(_pathToLibrary);
+      _library.modificationTime =
+          static_cast<std::int64_t>(time.time_since_epoch().count());
+      _library.fileSize = static_cast<std::uint64_t>(size);
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    bool Manifest::Read(const std::string &_file)
+    {
+      this->Clear();
+
+      std::ifstream in(_file, std::ios::binary);
+      if (!in)
+        return false;
+
+      // Relative library paths are relative to the directory of the manifest
+      return this->Read(
+            in, std::filesystem::path(_file).parent_path().string());
+    }
+
+    /////////////////////////////////////////////////
+    bool Manifest::Read(std::istream &_in, const std::string &_directory)
+    {
+      this->Clear();
+
+      const std::filesystem::path directory = _directory;
+
+      char magic[sizeof(kManifestMagic)];
+      if (!_in.read(magic, sizeof(magic)) ||
+          0 != std::memcmp(magic, kManifestMagic, sizeof(magic)))
+      {
+        return false;
+      }
+
+      std::uint32_t libraryCount;
+      if (!ReadValue(_in, libraryCount))
+        return false;
+
+      for (std::uint32_t l = 0; l < libraryCount; ++l)
+      {
+        ManifestLibrary library;
+        std::uint32_t pluginCount;
+        if (!ReadString(_in, library.path) ||
+            !ReadValue(_in, library.modificationTime) ||
+            !ReadValue(_in, library.fileSize) ||
+            !ReadString(_in, library.buildId) ||
+            !ReadValue(_in, pluginCount))
+        {
+          this->Clear();
+          return false;
+        }
+
+        if (std::filesystem::path(library.path).is_relative())
+        {
+          library.path =
+              CanonicalLibraryPath((directory / library.path).string());
+        }
+
+        // A library never registers anywhere near this many plugins, so this
+        // can only be a corrupted file. The entries are added as they are
+        // read, so that a count which is merely wrong does not allocate for
+        // entries that are not there.
+        if (pluginCount > (1u << 20))
+        {
+          this->Clear();
+          return false;
+        }
+
+        for (std::uint32_t p = 0; p < pluginCount; ++p)
+        {
+          ManifestPlugin &plugin = library.plugins.emplace_back();
+          if (!ReadString(_in, plugin.name) ||
+              !ReadStrings(_in, plugin.aliases) ||
+              !ReadStrings(_in, plugin.interfaces) ||
+              !ReadStrings(_in, plugin.demangledInterfaces) ||
+              !ReadStrings(_in, plugin.requiredFeatures))
+          {
+            this->Clear();
+            return false;
+          }
+        }
+
+        this->Insert(std::move(library));
+      }
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    bool Manifest::Write(const std::string &_file) const
+    {
+      // Write to a temporary file first and then rename it, so that another
+      // process reading the manifest never sees a partially written file.
+      // Every writer has a temporary file of its own, so that concurrent
+      // writers cannot rename each other's partially written files.
+      const std::string temporary = TemporaryPath(_file);
+
+      // Libraries inside of the directory of the manifest are recorded
+      // relative to it, so that the directory can be moved or installed
+      // somewhere else (e.g. into a staging directory for packaging) together
+      // with the manifest.
+      std::error_code ec;
+      std::filesystem::path directory =
+          std::filesystem::absolute(_file, ec).parent_path();
+      if (!ec)
+        directory = std::filesystem::weakly_canonical(directory, ec);
+      if (ec)
+        directory.clear();
+
+      {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out)
+          return false;
+
+        out.write(kManifestMagic, sizeof(kManifestMagic));
+        WriteValue(out, static_cast<std::uint32_t>(this->libraries.size()));
+
+        for (const auto &entry : this->libraries)
+        {
+          const ManifestLibrary &library = entry.second;
+          WriteString(out, RelativeLibraryPath(library.path, directory));
+          WriteValue(out, library.modificationTime);
+          WriteValue(out, library.fileSize);
+          WriteString(out, library.buildId);
+          WriteValue(out, static_cast<std::uint32_t>(library.plugins.size()));
+
+          for (const ManifestPlugin &plugin : library.plugins)
+          {
+            WriteString(out, plugin.name);
+            WriteStrings(out, plugin.aliases);
+            WriteStrings(out, plugin.interfaces);
+            WriteStrings(out, plugin.demangledInterfaces);
+            WriteStrings(out, plugin.requiredFeatures);
+          }
+        }
+
+        if (!out.flush())
+        {
+          out.close();
+          std::filesystem::remove(temporary, ec);
+          return false;
+        }
+      }
+
+      std::filesystem::rename(temporary, _file, ec);
+      if (ec)
+      {
+        std::cerr << "[ignition::plugin::Manifest::Write] Failed to write the "
+                  << "manifest [" << _file << "]: " << ec.message() << "\n";
+        std::filesystem::remove(temporary, ec);
+        return false;
+      }
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    bool Manifest::FindCurrent(const std::string &_pathToLibrary,
+                               ManifestLibrary &_library) const
+    {
+      ManifestLibrary current;
+      if (!ManifestLibrary::Stat(_pathToLibrary, current))
+        return false;
+
+      const LibraryMap::const_iterator it = this->libraries.find(current.path);
+      if (this->libraries.end() != it &&
+          it->second.modificationTime == current.modificationTime &&
+          it->second.fileSize == current.fileSize)
+      {
+        _library = it->second;
+        return true;
+      }
+
+      // The file may be a copy of a library which was described somewhere
+      // else, e.g. on another machine. Its build-id tells whether it has the
+      // same contents. This only needs the headers of the file, which is
+      // still much cheaper than opening the library.
+      if (this->buildIds.empty())
+        return false;
+
+      current.buildId = ReadBuildId(_pathToLibrary);
+      if (current.buildId.empty())
+        return false;
+
+      const auto id = this->buildIds.find(current.buildId);
+      if (this->buildIds.end() == id)
+        return false;
+
+      const LibraryMap::const_iterator described =
+          this->libraries.find(id->second);
+      if (this->libraries.end() == described ||
+          described->second.buildId != current.buildId ||
+          described->second.fileSize != current.fileSize)
+        return false;
+
+      _library = described->second;
+      _library.path = std::move(current.path);
+      _library.modificationTime = current.modificationTime;
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    void Manifest::Insert(ManifestLibrary _library)
+    {
+      const std::string path = _library.path;
+      ManifestLibrary &entry = this->libraries[path];
+
+      const auto previous = this->buildIds.find(entry.buildId);
+      if (this->buildIds.end() != previous && previous->second == path)
+        this->buildIds.erase(previous);
+
+      if (!_library.buildId.empty())
+        this->buildIds[_library.buildId] = path;
+
+      entry = std::move(_library);
+    }
+
+    /////////////////////////////////////////////////
+    void Manifest::Clear()
+    {
+      this->libraries.clear();
+      this->buildIds.clear();
+    }
+
+    /////////////////////////////////////////////////
+    std::string CanonicalLibraryPath(const std::string &_path)
+    {
+      std::error_code ec;
+      const std::filesystem::path canonical =
+          std::filesystem::canonical(_path, ec);
+
+      if (ec)
+        return _path;
+
+      return canonical.string();
+    }
+  }
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_SRC_MANIFEST_HH_
+#define IGNITION_PLUGIN_SRC_MANIFEST_HH_
+
+#include <cstdint>
+#include <istream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/plugin/Info.hh>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief The metadata of a single plugin, as recorded in a Manifest.
+    /// This is everything that a Loader needs in order to answer queries
+    /// about a plugin without opening the library that provides it.
+    struct ManifestPlugin
+    {
+      /// \brief The demangled name of the plugin
+      std::string name;
+
+      /// \brief The aliases of the plugin
+      std::set<std::string> aliases;
+
+      /// \brief The mangled names of the interfaces of the plugin
+      std::set<std::string> interfaces;
+
+      /// \brief The demangled names of the interfaces of the plugin
+      std::set<std::string> demangledInterfaces;
+
+      /// \brief The CPU features that the plugin requires
+      std::set<std::string> requiredFeatures;
+
+      /// \brief Record the metadata of a (demangled) Info
+      /// \param[in] _info The Info to describe
+      /// \return The metadata of the plugin
+      static ManifestPlugin FromInfo(const Info &_info);
+
+      /// \brief Create an Info which carries the metadata of this plugin. The
+      /// Info will not have a factory, a deleter, or any interface casters,
+      /// so it must never be used to instantiate the plugin.
+      /// \return An Info with the metadata of the plugin
+      Info ToInfo() const;
+    };
+
+    /// \brief The metadata of a library, as recorded in a Manifest.
+    struct ManifestLibrary
+    {
+      /// \brief The canonical path to the library
+      std::string path;
+
+      /// \brief The last modification time of the library file, in the units
+      /// of the file system clock
+      std::int64_t modificationTime = 0;
+
+      /// \brief The size of the library file, in bytes
+      std::uint64_t fileSize = 0;
+
+      /// \brief The build-id of the library (see ReadBuildId()), or an empty
+      /// string if it has none. An entry with a build-id stays valid on any
+      /// machine that has the same library file, wherever it is installed.
+      std::string buildId;
+
+      /// \brief The plugins that the library provides
+      std::vector<ManifestPlugin> plugins;
+
+      /// \brief Fill in the path, modification time, and size of the library
+      /// file at the given path.
+      /// \param[in] _pathToLibrary Path to the library
+      /// \param[out] _library The library to fill in
+      /// \return True if the file could be inspected, otherwise false.
+      static bool Stat(const std::string &_pathToLibrary,
+                       ManifestLibrary &_library);
+    };
+
+    /// \brief A collection of library metadata which can be saved to and read
+    /// from a compact binary file.
+    ///
+    /// The file is written in the native byte order. An entry is invalidated
+    /// whenever the modification time or size of its library changes, unless
+    /// the entry records the build-id of the library and the file still has
+    /// that build-id. Libraries which are inside of the directory of the file
+    /// are recorded relative to it, so the file stays valid when that
+    /// directory is moved as a whole.
+    ///
+    /// Entries with a build-id are also found by the build-id of a library
+    /// file, so a manifest which was written on one machine can describe the
+    /// same libraries on other machines, even when they are installed at
+    /// other paths.
+    class Manifest
+    {
+      /// \brief Read a manifest file, replacing the current contents of this
+      /// Manifest.
+      /// \param[in] _file Path to the manifest file
+      /// \return True if the file was read successfully. If false is returned,
+      /// this Manifest will be empty.
+      public: bool Read(const std::string &_file);
+
+      /// \brief Read the contents of a manifest file from a stream, replacing
+      /// the current contents of this Manifest.
+      /// \param[in] _in The stream
+      /// \param[in] _directory The directory that relative library paths are
+      /// relative to
+      /// \return True if the manifest was read successfully. If false is
+      /// returned, this Manifest will be empty.
+      public: bool Read(std::istream &_in, const std::string &_directory);
+
+      /// \brief Write this Manifest to a file.
+      /// \param[in] _file Path to the manifest file
+      /// \return True if the file was written successfully.
+      public: bool Write(const std::string &_file) const;
+
+      /// \brief Find the entry of a library, as long as it is still up to
+      /// date with the library file on disk. If the entry at the path of the
+      /// library is missing or out of date, the entry with the same build-id
+      /// as the library file is used instead, if there is one.
+      /// \param[in] _pathToLibrary Path to the library
+      /// \param[out] _library Receives a copy of the entry, stamped with the
+      /// canonical path, modification time, and size of the library file
+      /// \return True if an entry was found, false if there is no entry or
+      /// if the entry is out of date.
+      public: bool FindCurrent(const std::string &_pathToLibrary,
+                               ManifestLibrary &_library) const;
+
+      /// \brief Add an entry, replacing any previous entry with the same path.
+      /// \param[in] _library The library entry
+      public: void Insert(ManifestLibrary _library);
+
+      /// \brief Remove every entry
+      public: void Clear();
+
+      /// \brief The suffix which is appended to the path of a library to get
+      /// the path of its sidecar manifest, i.e. the manifest that describes
+      /// only that library and is installed next to it.
+      public: static constexpr const char *kSidecarSuffix = ".ignplugin";
+
+      public: using LibraryMap =
+          std::unordered_map<std::string, ManifestLibrary>;
+      /// \brief The libraries in this manifest, keyed by their canonical path.
+      /// Use Insert() and Clear() to change them.
+      public: LibraryMap libraries;
+
+      /// \brief The canonical paths of the libraries which have a build-id,
+      /// keyed by their build-ids
+      private: std::unordered_map<std::string, std::string> buildIds;
+    };
+
+    /// \brief Get the canonical form of a path to a library. If the path
+    /// cannot be resolved, it is returned without changes.
+    /// \param[in] _path A path to a file
+    /// \return The canonical path
+    std::string CanonicalLibraryPath(const std::string &_path);
+  }
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "ignition/plugin/EnablePluginFromThis.hh"
+#include "ignition/plugin/Loader.hh"
+#include "ignition/plugin/PluginHandle.hh"
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    bool PluginHandle::IsValid() const
+    {
+      return static_cast<bool>(this->info);
+    }
+
+    /////////////////////////////////////////////////
+    PluginHandle::operator bool() const
+    {
+      return this->IsValid();
+    }
+
+    /////////////////////////////////////////////////
+    const std::string *PluginHandle::Name() const
+    {
+      if (!this->info)
+        return nullptr;
+
+      return &this->info->name;
+    }
+
+    /////////////////////////////////////////////////
+    PluginPtr PluginHandle::Instantiate(
+        std::pmr::memory_resource *_resource) const
+    {
+      return this->Instantiate<PluginPtr>(_resource);
+    }
+
+    /////////////////////////////////////////////////
+    PluginHandle::PluginHandle(
+        ConstInfoPtr _info,
+        std::shared_ptr<void> _dlHandlePtr,
+        std::weak_ptr<const Loader *> _loader)
+      : dlHandlePtr(std::move(_dlHandlePtr)),
+        info(std::move(_info)),
+        loader(std::move(_loader))
+    {
+      // Do nothing
+    }
+
+    /////////////////////////////////////////////////
+    PluginPtr PluginHandle::PrivateInstantiate(
+        std::pmr::memory_resource *_resource) const
+    {
+      if (!this->info)
+        return PluginPtr();
+
+      if (const auto loaderPtr = this->loader.lock())
+      {
+        return (*loaderPtr)->PrivateInstantiate<PluginPtr>(
+              this->info, this->dlHandlePtr, _resource);
+      }
+
+      return this->PrivateConstruct(_resource);
+    }
+
+    /////////////////////////////////////////////////
+    PluginPtr PluginHandle::PrivateConstruct(
+        std::pmr::memory_resource *_resource) const
+    {
+      if (!this->info)
+        return PluginPtr();
+
+      PluginPtr ptr(this->info, this->dlHandlePtr, _resource);
+
+      if (auto *enableFromThis = ptr->PrivateGetEnablePluginFromThis())
+        enableFromThis->PrivateSetPluginFromThis(ptr);
+
+      return ptr;
+    }
+
+    /////////////////////////////////////////////////
+    bool PluginHandle::PrivateProvidesInterfaces(
+        const char *const *_interfaces,
+        const std::size_t _count) const
+    {
+      if (const auto loaderPtr = this->loader.lock())
+      {
+        return (*loaderPtr)->PrivateProvidesInterfaces(
+              this->info, _interfaces, _count);
+      }
+
+      for (std::size_t i = 0; i < _count; ++i)
+      {
+        if (0 == this->info->interfaces.count(_interfaces[i]))
+          return false;
+      }
+
+      return true;
+    }
+  }
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#if defined(__ELF__) && __has_include(<elf.h>)
+  #define IGN_PLUGIN_HAVE_ELF_READER
+  #include <elf.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "ReadAhead.hh"
+
+#if defined(POSIX_FADV_WILLNEED)
+namespace
+{
+  /////////////////////////////////////////////////
+  /// \brief Read bytes at an offset of a file
+  /// \param[in] _fd The file
+  /// \param[in] _offset The offset to read at
+  /// \param[out] _data Receives the bytes
+  /// \param[in] _size The number of bytes to read
+  /// \return True if all of the bytes were read
+  bool ReadAt(const int _fd, const std::size_t _offset,
+              void *_data, const std::size_t _size)
+  {
+    std::size_t done = 0;
+    while (done < _size)
+    {
+      const ssize_t count = ::pread(_fd, static_cast<char*>(_data) + done,
+                                    _size - done,
+                                    static_cast<off_t>(_offset + done));
+      if (count <= 0)
+        return false;
+
+      done += static_cast<std::size_t>(count);
+    }
+
+    return true;
+  }
+
+#ifdef IGN_PLUGIN_HAVE_ELF_READER
+  /////////////////////////////////////////////////
+  /// \brief The ELF types of 32-bit files
+  struct Elf32
+  {
+    using Ehdr = Elf32_Ehdr;
+    using Phdr = Elf32_Phdr;
+    static constexpr unsigned char fileClass = ELFCLASS32;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief The ELF types of 64-bit files
+  struct Elf64
+  {
+    using Ehdr = Elf64_Ehdr;
+    using Phdr = Elf64_Phdr;
+    static constexpr unsigned char fileClass = ELFCLASS64;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Read ahead the loadable segments of an ELF file
+  /// \param[in] _fd The file
+  /// \return True if the segments were found
+  template <typename Elf>
+  bool AdviseSegments(const int _fd)
+  {
+    typename Elf::Ehdr ehdr;
+    if (!ReadAt(_fd, 0, &ehdr, sizeof(ehdr)) ||
+        ehdr.e_phentsize != sizeof(typename Elf::Phdr) || 0 == ehdr.e_phoff)
+      return false;
+
+    std::vector<typename Elf::Phdr> phdrs(ehdr.e_phnum);
+    if (!ReadAt(_fd, ehdr.e_phoff, phdrs.data(),
+                phdrs.size() * sizeof(typename Elf::Phdr)))
+      return false;
+
+    bool found = false;
+    for (const typename Elf::Phdr &phdr : phdrs)
+    {
+      if (PT_LOAD != phdr.p_type || 0 == phdr.p_filesz)
+        continue;
+
+      ::posix_fadvise(_fd, static_cast<off_t>(phdr.p_offset),
+                      static_cast<off_t>(phdr.p_filesz),
+                      POSIX_FADV_WILLNEED);
+      found = true;
+    }
+
+    return found;
+  }
+#endif
+}
+#endif
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    bool ReadAheadLibrary(const std::string &_pathToLibrary)
+    {
+#if defined(POSIX_FADV_WILLNEED)
+      const int fd = ::open(_pathToLibrary.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+        return false;
+
+      bool advised = false;
+#ifdef IGN_PLUGIN_HAVE_ELF_READER
+      unsigned char ident[EI_NIDENT];
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      const unsigned char nativeData = ELFDATA2LSB;
+#else
+      const unsigned char nativeData = ELFDATA2MSB;
+#endif
+
+      if (ReadAt(fd, 0, ident, sizeof(ident)) &&
+          0 == std::memcmp(ident, ELFMAG, SELFMAG) &&
+          nativeData == ident[EI_DATA])
+      {
+        if (Elf64::fileClass == ident[EI_CLASS])
+          advised = AdviseSegments<Elf64>(fd);
+        else if (Elf32::fileClass == ident[EI_CLASS])
+          advised = AdviseSegments<Elf32>(fd);
+      }
+#endif
+
+      if (!advised)
+        advised = 0 == ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+
+      ::close(fd);
+      return advised;
+#else
+      (void)_pathToLibrary;
+      return false;
+#endif
+    }
+  }
+}
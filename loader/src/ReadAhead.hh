@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+#ifndef IGNITION_PLUGIN_SRC_READAHEAD_HH_
+#define IGNITION_PLUGIN_SRC_READAHEAD_HH_
+
+#include <string>
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /// \brief Ask the operating system to start reading the parts of a
+    /// library file which dlopen will map, without waiting for them. If the
+    /// library gets opened a little later, its pages are then already on
+    /// their way into the page cache, instead of being faulted in one by one
+    /// from slow (e.g. network-backed) storage.
+    ///
+    /// For an ELF file of the native byte order, only its loadable segments
+    /// are read ahead, so that debug information is left alone. Any other
+    /// file is read ahead as a whole.
+    /// \param[in] _pathToLibrary Path to the library
+    /// \return True if the hint was given, false if the file could not be
+    /// opened or the platform does not support such hints.
+    bool ReadAheadLibrary(const std::string &_pathToLibrary);
+  }
+}
+
+#endif
@@ -0,0 +1,806 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/RemoteCallable.hh>
+#include <ignition/plugin/RemotePlugin.hh>
+
+#ifdef __linux__
+namespace
+{
+  /// \brief A word of shared memory which the processes wait on. It is
+  /// passed to the futex system call, which works on plain 32-bit integers.
+  using Word = std::atomic<std::uint32_t>;
+  static_assert(sizeof(Word) == sizeof(std::uint32_t) &&
+                Word::is_always_lock_free,
+                "A futex needs a plain 32-bit word");
+
+  /// \brief States of the process which hosts the plugin
+  enum ChildState : std::uint32_t
+  {
+    /// \brief The plugin is being instantiated
+    STARTING,
+
+    /// \brief The plugin is waiting for calls
+    READY,
+
+    /// \brief The plugin could not be instantiated
+    FAILED
+  };
+
+  /// \brief States of a slot
+  enum SlotState : std::uint32_t
+  {
+    /// \brief The slot is free for the next call
+    EMPTY,
+
+    /// \brief The slot holds a call which has not been handled yet
+    REQUEST,
+
+    /// \brief The slot holds the results of a call, which the caller has not
+    /// picked up yet
+    DONE
+  };
+
+  /// \brief Flags of a call
+  enum SlotFlags : std::uint32_t
+  {
+    /// \brief Nobody waits for the results of the call, so its slot is
+    /// emptied by the plugin
+    ONE_WAY = 1,
+
+    /// \brief The process should exit instead of handling a call
+    STOP = 2
+  };
+
+  /// \brief The start of the shared memory
+  struct alignas(64) Header
+  {
+    /// \brief A ChildState
+    Word childState{STARTING};
+
+    /// \brief Nonzero while the plugin may be asleep, waiting for a call
+    Word childSleeping{0};
+
+    /// \brief Nonzero while the caller may be asleep, waiting for a slot
+    Word parentSleeping{0};
+  };
+
+  /// \brief The head of a slot. The arguments follow it, and the results
+  /// follow the arguments, each taking up the size of a slot.
+  struct alignas(64) Slot
+  {
+    /// \brief A SlotState. Whoever changes the state hands the slot over to
+    /// the other process, so nothing else in the slot needs to be atomic.
+    Word state{EMPTY};
+
+    /// \brief The method number
+    std::uint32_t method = 0;
+
+    /// \brief The SlotFlags
+    std::uint32_t flags = 0;
+
+    /// \brief What HandleCall() returned
+    std::int64_t result = 0;
+
+    /// \brief The number of bytes of the arguments
+    std::uint64_t inputSize = 0;
+
+    /// \brief The number of bytes that the results may take up
+    std::uint64_t outputCapacity = 0;
+
+    /// \brief Get the arguments
+    /// \return The arguments
+    unsigned char *Input()
+    {
+      return reinterpret_cast<unsigned char *>(this) + sizeof(Slot);
+    }
+
+    /// \brief Get the results
+    /// \param[in] _slotSize The size of a slot
+    /// \return The results
+    unsigned char *Output(const std::size_t _slotSize)
+    {
+      return this->Input() + _slotSize;
+    }
+  };
+
+  /// \brief How often to check a word before going to sleep. A call which is
+  /// handled within this many checks costs no system call at all.
+  constexpr int kSpins = 4096;
+
+  /// \brief How long the caller sleeps at most before it checks whether the
+  /// process has died
+  constexpr std::chrono::milliseconds kParentNap(10);
+
+  /// \brief How long the plugin sleeps at most before it checks whether the
+  /// caller has died
+  constexpr std::chrono::milliseconds kChildNap(100);
+
+  /// \brief How long a stopped process gets to exit before it is killed
+  constexpr std::chrono::milliseconds kStopGrace(1000);
+
+  /////////////////////////////////////////////////
+  /// \brief Tell the CPU that this is a spin loop
+  void Pause()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Sleep while a word of shared memory holds a value
+  /// \param[in] _word The word
+  /// \param[in] _value Do not sleep unless the word holds this value
+  /// \param[in] _timeout How long to sleep at most
+  void Sleep(Word &_word, const std::uint32_t _value,
+             const std::chrono::milliseconds _timeout)
+  {
+    const timespec timeout{
+      static_cast<std::time_t>(_timeout.count() / 1000),
+      static_cast<long>((_timeout.count() % 1000) * 1000000)};  // NOLINT
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&_word),
+            FUTEX_WAIT, _value, &timeout, nullptr, 0);
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Wake the process which sleeps on a word of shared memory
+  /// \param[in] _word The word
+  void Wake(Word &_word)
+  {
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&_word),
+            FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+  }
+
+  /// \brief The memory which the processes share
+  struct Region
+  {
+    /// \brief The start of the memory
+    Header *header = nullptr;
+
+    /// \brief The number of slots
+    std::size_t slots = 0;
+
+    /// \brief The size of the arguments, and of the results, of a slot
+    std::size_t slotSize = 0;
+
+    /// \brief The distance from one slot to the next
+    std::size_t stride = 0;
+
+    /// \brief Get a slot
+    /// \param[in] _index The number of the call. This wraps around.
+    /// \return The slot of the call
+    Slot &At(const std::size_t _index) const
+    {
+      unsigned char *const first =
+          reinterpret_cast<unsigned char *>(this->header) + sizeof(Header);
+      return *reinterpret_cast<Slot *>(
+            first + (_index % this->slots) * this->stride);
+    }
+
+    /// \brief Get the number of bytes of the memory
+    /// \return The size
+    std::size_t Size() const
+    {
+      return sizeof(Header) + this->slots * this->stride;
+    }
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Serve the calls to a plugin. This runs in the process which
+  /// hosts the plugin, and never returns.
+  /// \param[in] _instantiate Constructs the plugin
+  /// \param[in] _region The memory which the processes share
+  /// \param[in] _parent The process ID of the caller
+  [[noreturn]] void Serve(
+      const std::function<ignition::plugin::PluginPtr()> &_instantiate,
+      const Region &_region,
+      const pid_t _parent)
+  {
+    using ignition::plugin::RemoteCallable;
+    Header &header = *_region.header;
+
+    // The instance is never destroyed: the process exits with _exit, so that
+    // it does not run the exit handlers which it inherited from the caller.
+    ignition::plugin::PluginPtr *plugin = nullptr;
+    RemoteCallable *callable = nullptr;
+    try
+    {
+      plugin = new ignition::plugin::PluginPtr(_instantiate());
+      callable = (*plugin)->QueryInterface<RemoteCallable>();
+    }
+    catch (...)
+    {
+      callable = nullptr;
+    }
+
+    header.childState.store(callable ? READY : FAILED);
+    if (header.parentSleeping.load())
+      Wake(header.childState);
+
+    if (!callable)
+      _exit(1);
+
+    for (std::size_t tail = 0; ; ++tail)
+    {
+      Slot &slot = _region.At(tail);
+
+      // The slot may still hold the results of the previous round, if there
+      // is only one slot, so this waits for a request specifically.
+      for (int spin = 0; REQUEST != slot.state.load(); ++spin)
+      {
+        if (spin < kSpins)
+        {
+          Pause();
+          continue;
+        }
+
+        const std::uint32_t state = slot.state.load();
+        header.childSleeping.store(1);
+        if (REQUEST != state && state == slot.state.load())
+          Sleep(slot.state, state, kChildNap);
+        header.childSleeping.store(0);
+
+        if (getppid() != _parent)
+          _exit(0);
+      }
+
+      if (slot.flags & STOP)
+        _exit(0);
+
+      std::int64_t result = -1;
+      try
+      {
+        result = callable->HandleCall(
+              slot.method, slot.Input(), slot.inputSize,
+              slot.Output(_region.slotSize), slot.outputCapacity);
+      }
+      catch (...)
+      {
+        result = -1;
+      }
+
+      if (result > static_cast<std::int64_t>(slot.outputCapacity))
+        result = -1;
+
+      slot.result = result;
+      slot.state.store((slot.flags & ONE_WAY) ? EMPTY : DONE);
+      if (header.parentSleeping.load())
+        Wake(slot.state);
+    }
+  }
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    class RemotePlugin::Implementation
+    {
+      /// \brief Constructor
+      /// \param[in] _handle The resolved plugin
+      /// \param[in] _options The options of the plugin
+      public: Implementation(PluginHandle _handle,
+                             const RemoteOptions &_options)
+        : handle(std::move(_handle)),
+          options(_options)
+      {
+        this->region.slots = std::max<std::size_t>(1, _options.slots);
+        this->region.slotSize = _options.slotSize;
+        this->region.stride = sizeof(Slot) +
+            (2 * _options.slotSize + alignof(Slot) - 1) /
+            alignof(Slot) * alignof(Slot);
+      }
+
+      /// \brief Destructor. Stops the process.
+      public: ~Implementation()
+      {
+        this->Stop();
+      }
+
+      /// \brief Start the process, which must not be running. This expects
+      /// `mutex` to be locked.
+      /// \return True if the plugin is running
+      public: bool Start();
+
+      /// \brief Stop the process, if it is running, and release the shared
+      /// memory. This expects `mutex` to be locked.
+      public: void Stop();
+
+      /// \brief Wait while a word of shared memory holds a value. This
+      /// expects `mutex` to be locked.
+      /// \param[in] _word The word
+      /// \param[in] _busy The value to wait out
+      /// \param[in] _timeout How long to wait at most, or zero to wait for as
+      /// long as the process is alive
+      /// \return OK once the word has changed, DIED if the process has died
+      /// first, or TIMED_OUT if it took longer than _timeout, in which case
+      /// the process has been killed.
+      public: RemoteStatus Wait(Word &_word, std::uint32_t _busy,
+                                std::chrono::milliseconds _timeout);
+
+      /// \brief Make a call. This expects `mutex` to be locked.
+      /// \param[in] _method The method number
+      /// \param[in] _flags The SlotFlags of the call
+      /// \param[in] _inputSize The number of bytes of the arguments
+      /// \param[in] _outputCapacity The number of bytes that the results may
+      /// take up, which must not exceed the size of a slot
+      /// \param[in] _write Writes the arguments
+      /// \param[in] _read Reads the results, unless the call is one-way
+      /// \return The outcome of the call
+      public: RemoteStatus Transact(
+          std::uint32_t _method, std::uint32_t _flags,
+          std::size_t _inputSize, std::size_t _outputCapacity,
+          const std::function<void(void *)> &_write,
+          const std::function<void(const void *, std::size_t)> &_read);
+
+      /// \brief Check whether the process has exited, without waiting for it
+      /// \return True if it has exited, in which case `pid` is reset
+      public: bool Reap();
+
+      /// \brief Kill the process and wait for it
+      public: void Kill();
+
+      /// \brief The resolved plugin. The process constructs its instance
+      /// from this, without going through the Loader, so that it does not
+      /// need any lock which the Loader might have held during the fork.
+      public: const PluginHandle handle;
+
+      /// \brief The options of the plugin
+      public: const RemoteOptions options;
+
+      /// \brief The memory which the processes share, while one is running
+      public: Region region;
+
+      /// \brief The process ID of the process, or -1 if it is not running
+      public: pid_t pid = -1;
+
+      /// \brief The number of the next call
+      public: std::size_t head = 0;
+
+      /// \brief Serializes the calls
+      public: std::mutex mutex;
+    };
+
+    /////////////////////////////////////////////////
+    bool RemotePlugin::Implementation::Start()
+    {
+      void *const memory = mmap(nullptr, this->region.Size(),
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+      if (MAP_FAILED == memory)
+        return false;
+
+      this->region.header = new (memory) Header;
+      for (std::size_t i = 0; i < this->region.slots; ++i)
+        new (&this->region.At(i)) Slot;
+      this->head = 0;
+
+      const pid_t parent = getpid();
+      const pid_t child = fork();
+      if (0 == child)
+      {
+        Serve([this]() { return this->handle.PrivateConstruct(nullptr); },
+              this->region, parent);
+      }
+
+      if (child < 0)
+      {
+        this->Stop();
+        return false;
+      }
+
+      // The child may hang while it instantiates the plugin, so the start is
+      // bounded even if the calls are not.
+      this->pid = child;
+      if (RemoteStatus::OK != this->Wait(
+            this->region.header->childState, STARTING,
+            this->options.startTimeout) ||
+          READY != this->region.header->childState.load())
+      {
+        this->Stop();
+        return false;
+      }
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    void RemotePlugin::Implementation::Stop()
+    {
+      if (this->pid > 0)
+      {
+        // Ask the process to exit once it has handled the calls that are
+        // queued, as long as the slot that the request needs is free.
+        Slot &slot = this->region.At(this->head);
+        if (REQUEST != slot.state.load())
+        {
+          slot.flags = STOP;
+          slot.state.store(REQUEST);
+          if (this->region.header->childSleeping.load())
+            Wake(slot.state);
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + kStopGrace;
+        while (!this->Reap() && std::chrono::steady_clock::now() < deadline)
+        {
+          const timespec nap{0, 1000000};
+          nanosleep(&nap, nullptr);
+        }
+
+        if (this->pid > 0)
+          this->Kill();
+      }
+
+      if (this->region.header)
+      {
+        munmap(this->region.header, this->region.Size());
+        this->region.header = nullptr;
+      }
+    }
+
+    /////////////////////////////////////////////////
+    RemoteStatus RemotePlugin::Implementation::Wait(
+        Word &_word, const std::uint32_t _busy,
+        const std::chrono::milliseconds _timeout)
+    {
+      for (int spin = 0; spin < kSpins; ++spin)
+      {
+        if (_busy != _word.load(std::memory_order_acquire))
+          return RemoteStatus::OK;
+        Pause();
+      }
+
+      const bool bounded = _timeout.count() > 0;
+      const auto deadline = std::chrono::steady_clock::now() + _timeout;
+
+      Header &header = *this->region.header;
+      while (true)
+      {
+        header.parentSleeping.store(1);
+        if (_busy == _word.load())
+          Sleep(_word, _busy, kParentNap);
+        header.parentSleeping.store(0);
+
+        if (_busy != _word.load())
+          return RemoteStatus::OK;
+
+        if (this->Reap())
+          return RemoteStatus::DIED;
+
+        if (bounded && std::chrono::steady_clock::now() >= deadline)
+        {
+          this->Kill();
+          return RemoteStatus::TIMED_OUT;
+        }
+      }
+    }
+
+    /////////////////////////////////////////////////
+    RemoteStatus RemotePlugin::Implementation::Transact(
+        const std::uint32_t _method, const std::uint32_t _flags,
+        const std::size_t _inputSize, const std::size_t _outputCapacity,
+        const std::function<void(void *)> &_write,
+        const std::function<void(const void *, std::size_t)> &_read)
+    {
+      if (this->pid <= 0)
+        return RemoteStatus::NOT_RUNNING;
+
+      if (_inputSize > this->region.slotSize)
+        return RemoteStatus::TOO_LARGE;
+
+      // The slot may still hold a one-way call from the previous round.
+      Slot &slot = this->region.At(this->head);
+      RemoteStatus status =
+          this->Wait(slot.state, REQUEST, this->options.timeout);
+      if (RemoteStatus::OK != status)
+        return status;
+
+      if (_write)
+        _write(slot.Input());
+      slot.method = _method;
+      slot.flags = _flags;
+      slot.inputSize = _inputSize;
+      slot.outputCapacity = _outputCapacity;
+      slot.state.store(REQUEST);
+      if (this->region.header->childSleeping.load())
+        Wake(slot.state);
+      ++this->head;
+
+      if (_flags & ONE_WAY)
+        return RemoteStatus::OK;
+
+      status = this->Wait(slot.state, REQUEST, this->options.timeout);
+      if (RemoteStatus::OK != status)
+        return status;
+
+      if (slot.result < 0)
+      {
+        status = RemoteStatus::FAILED;
+      }
+      else if (_read)
+      {
+        _read(slot.Output(this->region.slotSize),
+              static_cast<std::size_t>(slot.result));
+      }
+
+      slot.state.store(EMPTY, std::memory_order_release);
+      return status;
+    }
+
+    /////////////////////////////////////////////////
+    bool RemotePlugin::Implementation::Reap()
+    {
+      const pid_t reaped = waitpid(this->pid, nullptr, WNOHANG);
+      if (0 == reaped || (reaped < 0 && ECHILD != errno))
+        return false;
+
+      this->pid = -1;
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    void RemotePlugin::Implementation::Kill()
+    {
+      kill(this->pid, SIGKILL);
+      waitpid(this->pid, nullptr, 0);
+      this->pid = -1;
+    }
+
+    /////////////////////////////////////////////////
+    RemotePlugin::RemotePlugin() = default;
+
+    /////////////////////////////////////////////////
+    RemotePlugin::RemotePlugin(PluginHandle _handle,
+                               const RemoteOptions &_options)
+      : dataPtr(new Implementation(std::move(_handle), _options))
+    {
+      this->dataPtr->Start();
+    }
+
+    /////////////////////////////////////////////////
+    RemotePlugin::RemotePlugin(RemotePlugin &&_other) = default;
+
+    /////////////////////////////////////////////////
+    RemotePlugin &RemotePlugin::operator=(RemotePlugin &&_other) = default;
+
+    /////////////////////////////////////////////////
+    RemotePlugin::~RemotePlugin() = default;
+
+    /////////////////////////////////////////////////
+    bool RemotePlugin::IsRunning() const
+    {
+      if (!this->dataPtr)
+        return false;
+
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->pid > 0 && !this->dataPtr->Reap();
+    }
+
+    /////////////////////////////////////////////////
+    RemotePlugin::operator bool() const
+    {
+      return this->IsRunning();
+    }
+
+    /////////////////////////////////////////////////
+    int RemotePlugin::ProcessId() const
+    {
+      if (!this->dataPtr)
+        return -1;
+
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->pid;
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t RemotePlugin::SlotSize() const
+    {
+      return this->dataPtr ? this->dataPtr->options.slotSize : 0;
+    }
+
+    /////////////////////////////////////////////////
+    RemoteStatus RemotePlugin::Call(
+        const std::uint32_t _method,
+        const void *_input, const std::size_t _inputSize,
+        void *_output, const std::size_t _outputCapacity,
+        std::size_t *_outputSize)
+    {
+      if (_outputSize)
+        *_outputSize = 0;
+
+      if (!this->dataPtr)
+        return RemoteStatus::NOT_RUNNING;
+
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->Transact(
+            _method, 0, _inputSize,
+            std::min(_outputCapacity, this->dataPtr->region.slotSize),
+            [&](void *_slotInput)
+            {
+              if (_inputSize > 0)
+                std::memcpy(_slotInput, _input, _inputSize);
+            },
+            [&](const void *_slotOutput, const std::size_t _size)
+            {
+              if (_size > 0)
+                std::memcpy(_output, _slotOutput, _size);
+              if (_outputSize)
+                *_outputSize = _size;
+            });
+    }
+
+    /////////////////////////////////////////////////
+    RemoteStatus RemotePlugin::CallInPlace(
+        const std::uint32_t _method, const std::size_t _inputSize,
+        const std::function<void(void *_input)> &_write,
+        const std::function<void(const void *_output,
+                                 std::size_t _outputSize)> &_read)
+    {
+      if (!this->dataPtr)
+        return RemoteStatus::NOT_RUNNING;
+
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->Transact(
+            _method, 0, _inputSize, this->dataPtr->region.slotSize,
+            _write, _read);
+    }
+
+    /////////////////////////////////////////////////
+    RemoteStatus RemotePlugin::Send(
+        const std::uint32_t _method,
+        const void *_input, const std::size_t _inputSize)
+    {
+      if (!this->dataPtr)
+        return RemoteStatus::NOT_RUNNING;
+
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      return this->dataPtr->Transact(
+            _method, ONE_WAY, _inputSize, 0,
+            [&](void *_slotInput)
+            {
+              if (_inputSize > 0)
+                std::memcpy(_slotInput, _input, _inputSize);
+            },
+            nullptr);
+    }
+
+    /////////////////////////////////////////////////
+    bool RemotePlugin::Restart()
+    {
+      if (!this->dataPtr)
+        return false;
+
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      this->dataPtr->Stop();
+      return this->dataPtr->Start();
+    }
+  }
+}
+
+#else
+
+namespace ignition
+{
+  namespace plugin
+  {
+    // The processes of remote plugins wait on each other with futexes, which
+    // only Linux provides. Elsewhere a RemotePlugin never runs, so every call
+    // reports NOT_RUNNING.
+    class RemotePlugin::Implementation
+    {
+    };
+
+    /////////////////////////////////////////////////
+    RemotePlugin::RemotePlugin() = default;
+
+    /////////////////////////////////////////////////
+    RemotePlugin::RemotePlugin(PluginHandle, const RemoteOptions &)
+    {
+      // Do nothing
+    }
+
+    /////////////////////////////////////////////////
+    RemotePlugin::RemotePlugin(RemotePlugin &&_other) = default;
+
+    /////////////////////////////////////////////////
+    RemotePlugin &RemotePlugin::operator=(RemotePlugin &&_other) = default;
+
+    /////////////////////////////////////////////////
+    RemotePlugin::~RemotePlugin() = default;
+
+    /////////////////////////////////////////////////
+    bool RemotePlugin::IsRunning() const
+    {
+      return false;
+    }
+
+    /////////////////////////////////////////////////
+    RemotePlugin::operator bool() const
+    {
+      return false;
+    }
+
+    /////////////////////////////////////////////////
+    int RemotePlugin::ProcessId() const
+    {
+      return -1;
+    }
+
+    /////////////////////////////////////////////////
+    std::size_t RemotePlugin::SlotSize() const
+    {
+      return 0;
+    }
+
+    /////////////////////////////////////////////////
+    RemoteStatus RemotePlugin::Call(
+        const std::uint32_t, const void *, const std::size_t,
+        void *, const std::size_t, std::size_t *_outputSize)
+    {
+      if (_outputSize)
+        *_outputSize = 0;
+
+      return RemoteStatus::NOT_RUNNING;
+    }
+
+    /////////////////////////////////////////////////
+    RemoteStatus RemotePlugin::CallInPlace(
+        const std::uint32_t, const std::size_t,
+        const std::function<void(void *_input)> &,
+        const std::function<void(const void *_output,
+                                 std::size_t _outputSize)> &)
+    {
+      return RemoteStatus::NOT_RUNNING;
+    }
+
+    /////////////////////////////////////////////////
+    RemoteStatus RemotePlugin::Send(
+        const std::uint32_t, const void *, const std::size_t)
+    {
+      return RemoteStatus::NOT_RUNNING;
+    }
+
+    /////////////////////////////////////////////////
+    bool RemotePlugin::Restart()
+    {
+      return false;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "ignition/plugin/ThreadLocalPlugin.hh"
+
+namespace
+{
+  /// \brief The instance that a thread has in one slot
+  struct Entry
+  {
+    /// \brief The generation of the ThreadLocalPlugin which created the
+    /// instance, or 0 if the slot is empty. A slot can be reused by a newer
+    /// ThreadLocalPlugin, which has a different generation.
+    std::uint64_t generation = 0;
+
+    /// \brief The instance
+    ignition::plugin::PluginPtr plugin;
+  };
+
+  /// \brief The slots of one thread. A deque is used so that the references
+  /// returned by ThreadLocalPlugin::Get() stay valid when it grows.
+  class ThreadTable
+  {
+    /// \brief Destructor. Deletes the instances of the thread.
+    public: ~ThreadTable();
+
+    /// \brief Find the entry of a slot, if it belongs to a generation
+    /// \param[in] _index The index of the slot
+    /// \param[in] _generation The generation that the entry must have
+    /// \return The entry, or nullptr if the thread has no instance there
+    public: Entry *Find(std::size_t _index, std::uint64_t _generation)
+    {
+      if (_index >= this->entries.size())
+        return nullptr;
+
+      Entry &entry = this->entries[_index];
+      return entry.generation == _generation ? &entry : nullptr;
+    }
+
+    /// \brief The entries, indexed by slot
+    public: std::deque<Entry> entries;
+  };
+
+  /// \brief Set once the table of the current thread has been destroyed,
+  /// since plugins which get deleted at thread exit may destroy a
+  /// ThreadLocalPlugin of their own. This is trivially destructible, so it
+  /// can still be read at that point.
+  thread_local bool threadTableDestroyed = false;
+
+  /////////////////////////////////////////////////
+  ThreadTable::~ThreadTable()
+  {
+    threadTableDestroyed = true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Get the table of the calling thread
+  /// \return The table, or nullptr if the thread is exiting
+  ThreadTable *CurrentThreadTable()
+  {
+    if (threadTableDestroyed)
+      return nullptr;
+
+    thread_local ThreadTable table;
+    return &table;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Hands out the slot indices. There is one allocator for the whole
+  /// process, since every thread indexes its table with the same slots.
+  class SlotAllocator
+  {
+    /// \brief Get the allocator of this process
+    public: static SlotAllocator &Get()
+    {
+      static SlotAllocator allocator;
+      return allocator;
+    }
+
+    /// \brief Take a slot
+    /// \param[out] _index The index of the slot
+    /// \param[out] _generation A generation which no other slot has had
+    public: void Take(std::size_t &_index, std::uint64_t &_generation)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      _generation = ++this->lastGeneration;
+
+      if (this->freeIndices.empty())
+      {
+        _index = this->nextIndex++;
+        return;
+      }
+
+      // Reuse an index that was given back, so that the tables stay short
+      _index = this->freeIndices.back();
+      this->freeIndices.pop_back();
+    }
+
+    /// \brief Give a slot back
+    /// \param[in] _index The index of the slot
+    public: void Give(const std::size_t _index)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->freeIndices.push_back(_index);
+    }
+
+    /// \brief Protects the members below
+    private: std::mutex mutex;
+
+    /// \brief Indices which have been given back
+    private: std::vector<std::size_t> freeIndices;
+
+    /// \brief The index after the highest one that was ever taken
+    private: std::size_t nextIndex = 0;
+
+    /// \brief The generation of the latest slot
+    private: std::uint64_t lastGeneration = 0;
+  };
+}
+
+namespace ignition
+{
+  namespace plugin
+  {
+    /////////////////////////////////////////////////
+    class ThreadLocalPlugin::Implementation
+    {
+      /// \brief Constructor. Takes a slot.
+      /// \param[in] _handle The plugin to instantiate
+      public: explicit Implementation(PluginHandle _handle)
+        : handle(std::move(_handle))
+      {
+        SlotAllocator::Get().Take(this->index, this->generation);
+      }
+
+      /// \brief Destructor. Deletes the instance of the calling thread and
+      /// gives the slot back.
+      public: ~Implementation()
+      {
+        this->Release();
+        SlotAllocator::Get().Give(this->index);
+      }
+
+      /// \brief Delete the instance of the calling thread
+      public: void Release() const
+      {
+        ThreadTable *table = CurrentThreadTable();
+        if (!table)
+          return;
+
+        Entry *entry = table->Find(this->index, this->generation);
+        if (!entry)
+          return;
+
+        // Take the instance out of the entry before deleting it, in case its
+        // destructor uses this thread's table
+        entry->generation = 0;
+        const PluginPtr doomed = std::move(entry->plugin);
+      }
+
+      /// \brief The plugin to instantiate
+      public: const PluginHandle handle;
+
+      /// \brief The index of the slot
+      public: std::size_t index = 0;
+
+      /// \brief The generation of the slot
+      public: std::uint64_t generation = 0;
+    };
+
+    /////////////////////////////////////////////////
+    ThreadLocalPlugin::ThreadLocalPlugin(PluginHandle _handle)
+    {
+      if (_handle)
+        this->dataPtr = std::make_shared<Implementation>(std::move(_handle));
+    }
+
+    /////////////////////////////////////////////////
+    bool ThreadLocalPlugin::IsValid() const
+    {
+      return static_cast<bool>(this->dataPtr);
+    }
+
+    /////////////////////////////////////////////////
+    ThreadLocalPlugin::operator bool() const
+    {
+      return this->IsValid();
+    }
+
+    /////////////////////////////////////////////////
+    const std::string *ThreadLocalPlugin::Name() const
+    {
+      if (!this->dataPtr)
+        return nullptr;
+
+      return this->dataPtr->handle.Name();
+    }
+
+    /////////////////////////////////////////////////
+    const PluginPtr &ThreadLocalPlugin::Get() const
+    {
+      static const PluginPtr empty;
+
+      const Implementation *impl = this->dataPtr.get();
+      if (!impl)
+        return empty;
+
+      ThreadTable *table = CurrentThreadTable();
+      if (!table)
+        return empty;
+
+      if (Entry *entry = table->Find(impl->index, impl->generation))
+        return entry->plugin;
+
+      // Instantiate before touching the table, since the constructor of the
+      // plugin may use a ThreadLocalPlugin of its own
+      PluginPtr plugin = impl->handle.Instantiate();
+
+      if (impl->index >= table->entries.size())
+        table->entries.resize(impl->index + 1);
+
+      Entry &entry = table->entries[impl->index];
+      entry.generation = impl->generation;
+      // Whatever an older ThreadLocalPlugin left in this slot gets deleted now
+      std::swap(entry.plugin, plugin);
+      return entry.plugin;
+    }
+
+    /////////////////////////////////////////////////
+    void ThreadLocalPlugin::Release() const
+    {
+      if (this->dataPtr)
+        this->dataPtr->Release();
+    }
+
+    /////////////////////////////////////////////////
+    bool ThreadLocalPlugin::HasInstance() const
+    {
+      if (!this->dataPtr)
+        return false;
+
+      ThreadTable *table = CurrentThreadTable();
+      return table && table->Find(
+          this->dataPtr->index, this->dataPtr->generation);
+    }
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ignition/plugin/Loader.hh>
+
+/////////////////////////////////////////////////
+void PrintUsage(const char *_program)
+{
+  std::cerr
+    << "Usage:\n"
+    << "  " << _program << " <manifest> <library>...\n"
+    << "      Write a manifest which describes the plugins of the libraries.\n"
+    << "      Every library gets opened in this process.\n"
+    << "  " << _program << " --merge <manifest> <manifest>...\n"
+    << "      Write a manifest which combines the given manifests.\n";
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  int first = 1;
+  bool merge = false;
+  if (argc > 1 && 0 == std::strcmp("--merge", argv[1]))
+  {
+    merge = true;
+    ++first;
+  }
+
+  if (argc - first < 2)
+  {
+    PrintUsage(argv[0]);
+    return 2;
+  }
+
+  const std::string output = argv[first];
+  const std::vector<std::string> inputs(argv + first + 1, argv + argc);
+
+  const bool success = merge ?
+      ignition::plugin::Loader::MergeManifests(output, inputs) :
+      ignition::plugin::Loader::WriteManifest(output, inputs);
+
+  if (!success)
+  {
+    std::cerr << "[" << argv[0] << "] Failed to write the manifest ["
+              << output << "]\n";
+    return 1;
+  }
+
+  return 0;
+}
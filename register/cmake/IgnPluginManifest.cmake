@@ -0,0 +1,86 @@
+# Copyright (C) 2019 Open Source Robotics Foundation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#################################################
+# ign_plugin_add_manifest(<target> [INSTALL_DESTINATION <dir>])
+#
+# Write the sidecar manifest of the plugin library <target> every time that it
+# gets built. The manifest is placed next to the library, and is named like the
+# library file followed by ".ignplugin". Loader::LoadDirectory() uses the
+# sidecar manifests that it finds to register plugins without opening their
+# libraries, and the ign-plugin-manifest tool can merge many of them into one
+# index for Loader::LoadManifest().
+#
+# Installing a library changes its modification time (and possibly its
+# RPATH), which invalidates its manifest, so pass the directory that <target>
+# gets installed into as INSTALL_DESTINATION to write the manifest again for
+# the installed library. A relative <dir> is relative to the install prefix.
+# Writing the manifest opens the library, so this fails (with a warning) if
+# the dependencies of the installed library cannot be found at install time.
+# Call this after the install() rule of <target>, since install rules run in
+# the order that they are declared.
+function(ign_plugin_add_manifest target)
+
+  cmake_parse_arguments(ign_plugin_add_manifest
+    "" "INSTALL_DESTINATION" "" ${ARGN})
+
+  if(TARGET ign-plugin-manifest)
+    # We are being used from within the ign-plugin source tree
+    set(tool $<TARGET_FILE:ign-plugin-manifest>)
+  else()
+    find_program(IGN_PLUGIN_MANIFEST_EXECUTABLE ign-plugin-manifest)
+    if(NOT IGN_PLUGIN_MANIFEST_EXECUTABLE)
+      message(WARNING "ign_plugin_add_manifest: Could not find the "
+        "ign-plugin-manifest tool, so no manifest will be written for "
+        "[${target}]")
+      return()
+    endif()
+    set(tool ${IGN_PLUGIN_MANIFEST_EXECUTABLE})
+  endif()
+
+  add_custom_command(TARGET ${target} POST_BUILD
+    COMMAND ${tool}
+      $<TARGET_FILE:${target}>.ignplugin
+      $<TARGET_FILE:${target}>
+    COMMENT "Writing the plugin manifest of ${target}"
+    VERBATIM)
+
+  set(destination ${ign_plugin_add_manifest_INSTALL_DESTINATION})
+  if(NOT destination)
+    return()
+  endif()
+
+  # install(CODE) only expands generator expressions since CMake 3.14
+  if(CMAKE_VERSION VERSION_LESS 3.14)
+    message(WARNING "ign_plugin_add_manifest: INSTALL_DESTINATION requires "
+      "CMake 3.14 or newer, so no manifest will be installed for [${target}]")
+    return()
+  endif()
+
+  if(NOT IS_ABSOLUTE "${destination}")
+    set(destination "\${CMAKE_INSTALL_PREFIX}/${destination}")
+  endif()
+
+  install(CODE "
+    set(library \"\$ENV{DESTDIR}${destination}/$<TARGET_FILE_NAME:${target}>\")
+    message(STATUS \"Writing the plugin manifest of: \${library}\")
+    execute_process(
+      COMMAND \"${tool}\" \"\${library}.ignplugin\" \"\${library}\"
+      RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+      message(WARNING \"Failed to write the plugin manifest of \${library}\")
+    endif()
+  ")
+
+endfunction()
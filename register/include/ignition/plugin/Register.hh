@@ -74,6 +74,101 @@
 #define IGNITION_ADD_PLUGIN_ALIAS(PluginClass, ...) \
   DETAIL_IGNITION_ADD_PLUGIN_ALIAS(PluginClass, __VA_ARGS__)
 
+/// \brief Declare the CPU features that one of your plugins needs in order
+/// to run, e.g. because it was compiled with -mavx2.
+///
+/// This is meant for plugins which implement the same thing for different
+/// CPUs and share an alias, e.g.:
+///
+/// \code
+/// IGNITION_ADD_PLUGIN_ALIAS(KernelAVX512, "Kernel")
+/// IGNITION_ADD_PLUGIN_FEATURES(KernelAVX512, "avx512f", "avx512vl")
+/// IGNITION_ADD_PLUGIN_ALIAS(KernelAVX2, "Kernel")
+/// IGNITION_ADD_PLUGIN_FEATURES(KernelAVX2, "avx2", "fma")
+/// IGNITION_ADD_PLUGIN_ALIAS(KernelGeneric, "Kernel")
+/// \endcode
+///
+/// The plugins may also be provided by different libraries. Looking up
+/// "Kernel" with ignition::plugin::Loader::Preference::FASTEST then gives
+/// the plugin with the fastest features that the CPU supports, and the
+/// Loader refuses to instantiate a plugin whose features are not all
+/// supported. See ignition::plugin::CpuSupports() for the names of the
+/// features.
+///
+/// Like IGNITION_ADD_PLUGIN_ALIAS(), this macro may be called any number of
+/// times, and its features are not recorded in the metadata that
+/// ignition::plugin::Loader::ScanLib() reads, so the library gets opened
+/// when it is scanned. Only the registration code of the library runs then,
+/// so it must not use any of the features itself.
+#define IGNITION_ADD_PLUGIN_FEATURES(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_FEATURES(PluginClass, __VA_ARGS__)
+
+/// \brief Declare the plugins which need to be constructed before one of
+/// your plugins, when they are instantiated together by
+/// ignition::plugin::Loader::InstantiateAll(). The dependencies are names or
+/// aliases of plugins, e.g.:
+///
+/// \code
+/// IGNITION_ADD_PLUGIN_DEPENDENCIES(Planner, "Map", "Localizer")
+/// \endcode
+///
+/// A dependency only affects the order of construction. It does not make
+/// the Loader instantiate a plugin that was not asked for.
+///
+/// Like IGNITION_ADD_PLUGIN_ALIAS(), this macro may be called any number of
+/// times, and its dependencies are not recorded in the metadata that
+/// ignition::plugin::Loader::ScanLib() reads, so the library gets opened
+/// when it is scanned.
+#define IGNITION_ADD_PLUGIN_DEPENDENCIES(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_DEPENDENCIES(PluginClass, __VA_ARGS__)
+
+/// \brief Register a constructor of one of your plugins which takes
+/// arguments, so that ignition::plugin::Loader::InstantiateWith() can pass
+/// them straight to it, e.g.:
+///
+/// \code
+/// IGNITION_ADD_PLUGIN_CONSTRUCTOR(Camera, int, const std::string&)
+/// \endcode
+///
+/// The argument types must be listed exactly as the Loader is asked for
+/// them, because the signature is looked up by its type. A plugin may have
+/// any number of constructors, but it still needs a default constructor to
+/// be registered with IGNITION_ADD_PLUGIN().
+///
+/// Like IGNITION_ADD_PLUGIN_ALIAS(), this macro may be called any number of
+/// times, and its constructors are not recorded in the metadata that
+/// ignition::plugin::Loader::ScanLib() reads, so the library gets opened
+/// when it is scanned.
+#define IGNITION_ADD_PLUGIN_CONSTRUCTOR(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_CONSTRUCTOR(PluginClass, __VA_ARGS__)
+
+/// \brief Export a table of plain functions, e.g. batched compute kernels,
+/// alongside the interfaces of one of your plugins. A host gets the table
+/// from ignition::plugin::Loader::QueryKernelTable() without instantiating
+/// the plugin, and calls the functions directly, so there is no virtual
+/// dispatch between the host and the kernels, e.g.:
+///
+/// \code
+/// struct VectorKernels
+/// {
+///   static constexpr std::uint32_t kAbiVersion = 1;
+///   void (*add)(const float *a, const float *b, float *out, std::size_t n);
+///   void (*scale)(float *data, float factor, std::size_t n);
+/// };
+///
+/// const VectorKernels avx2Kernels{&AddAvx2, &ScaleAvx2};
+/// IGNITION_ADD_PLUGIN_KERNELS(Avx2Math, avx2Kernels)
+/// \endcode
+///
+/// The type of the table must be a plain struct with a static kAbiVersion
+/// member, which should be increased whenever its layout changes, and the
+/// table itself must have static storage duration. A plugin may export any
+/// number of tables, as long as their types differ. Like
+/// IGNITION_ADD_PLUGIN_ALIAS(), the tables are not recorded in the metadata
+/// that ignition::plugin::Loader::ScanLib() reads.
+#define IGNITION_ADD_PLUGIN_KERNELS(PluginClass, Table) \
+  DETAIL_IGNITION_ADD_PLUGIN_KERNELS(PluginClass, Table)
+
 
 /// \brief Add a plugin factory.
 ///
@@ -137,4 +232,53 @@
   DETAIL_IGNITION_ADD_FACTORY_ALIAS(ProductType, FactoryType, __VA_ARGS__)
 
 
+// ------------- Add plugins without running code at load time ----------------
+
+/// \brief Add a plugin and interface from this shared library, the same way
+/// as IGNITION_ADD_PLUGIN().
+///
+/// IGNITION_ADD_PLUGIN() registers a plugin by running a static constructor
+/// when the library gets loaded, which builds the Info of the plugin. This
+/// macro instead emits a constant initialized PluginDescriptor which the
+/// linker collects into a table, so loading the library does not run any code
+/// or allocate any memory for the plugin. The Loader builds the Info of the
+/// plugin from its descriptor once it loads the library. This makes a
+/// difference for libraries that provide a large number of plugins.
+///
+/// Plugins and interfaces that are added with this macro are merged with the
+/// ones that are added by IGNITION_ADD_PLUGIN(), and the two macros can be
+/// used in the same library. The descriptor table is only available for ELF
+/// platforms. On other platforms this macro does the same as
+/// IGNITION_ADD_PLUGIN().
+#define IGNITION_ADD_STATIC_PLUGIN(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_STATIC_PLUGIN(PluginClass, __VA_ARGS__)
+
+/// \brief Add an alias for one of your plugins, the same way as
+/// IGNITION_ADD_PLUGIN_ALIAS(), but with a constant initialized
+/// PluginDescriptor like IGNITION_ADD_STATIC_PLUGIN(). Every alias must be a
+/// string literal.
+///
+/// Since the aliases are known at compile time, they are also recorded in the
+/// metadata that ignition::plugin::Loader::ScanLib() reads without opening
+/// the library. The aliases of IGNITION_ADD_PLUGIN_ALIAS() are not, so a
+/// library which uses that macro always needs to be opened.
+#define IGNITION_ADD_STATIC_PLUGIN_ALIAS(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_STATIC_PLUGIN_ALIAS(PluginClass, __VA_ARGS__)
+
+
+// ------------- Link plugins into a program statically -----------------------
+
+// Plugins are normally provided by shared libraries, and each library hands
+// its plugins to the Loader through a hook function that it defines once.
+// To link the plugins of one or more libraries into a program statically
+// (e.g. from static archives), compile every translation unit that registers
+// plugins with IGN_PLUGIN_STATIC_REGISTRY defined. The registration macros
+// then add the plugins to a registry which is shared by the whole program,
+// and ignition::plugin::Loader::LoadStaticPlugins() makes them available for
+// instantiation. Note that the linker drops any object file of a static
+// archive which nothing refers to, so a static archive of plugins needs to
+// be linked in whole (e.g. with -Wl,--whole-archive, or as a CMake OBJECT
+// library).
+
+
 #endif
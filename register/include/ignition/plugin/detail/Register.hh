@@ -19,17 +19,26 @@
 #ifndef IGNITION_PLUGIN_DETAIL_REGISTER_HH_
 #define IGNITION_PLUGIN_DETAIL_REGISTER_HH_
 
+#include <array>
+#include <cstddef>
+#include <new>
 #include <set>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <typeinfo>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <ignition/utilities/SuppressWarning.hh>
 
+#include <ignition/plugin/Descriptor.hh>
 #include <ignition/plugin/EnablePluginFromThis.hh>
 #include <ignition/plugin/Info.hh>
+#include <ignition/plugin/InterfaceId.hh>
 #include <ignition/plugin/utility.hh>
+#include <ignition/plugin/Warmup.hh>
 
 
 #if defined _WIN32 || defined __CYGWIN__
@@ -46,6 +55,46 @@
   #endif
 #endif
 
+// PluginDescriptors are collected by placing a pointer to each of them in a
+// dedicated section of the library. The linker gathers the contents of that
+// section from every translation unit into one array, and defines the
+// __start_ and __stop_ symbols that mark its bounds. This is only available
+// for ELF targets, and it is not used for plugins that are linked into a
+// program statically (IGN_PLUGIN_STATIC_REGISTRY). Elsewhere,
+// IGNITION_ADD_STATIC_PLUGIN falls back to registering plugins the same way
+// that IGNITION_ADD_PLUGIN does.
+#if defined(__ELF__) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(IGN_PLUGIN_STATIC_REGISTRY)
+  #define DETAIL_IGN_PLUGIN_HAS_DESCRIPTOR_SECTION
+  #define DETAIL_IGN_PLUGIN_DESCRIPTOR_ENTRY \
+    __attribute__ ((section ("ign_plugin_descriptors"), used))
+
+  // Every registration also places a metadata record into a second section
+  // (see METADATA_API_VERSION). Nothing in the library refers to that
+  // section, so we ask the linker to retain it when unused sections are being
+  // garbage collected. Without that support, the section may get dropped and
+  // the Loader simply opens the library instead.
+  #if defined(__has_attribute)
+    #if __has_attribute(retain)
+      #define DETAIL_IGN_PLUGIN_METADATA_RETAIN retain,
+    #endif
+  #endif
+  #ifndef DETAIL_IGN_PLUGIN_METADATA_RETAIN
+    #define DETAIL_IGN_PLUGIN_METADATA_RETAIN
+  #endif
+  #define DETAIL_IGN_PLUGIN_METADATA_ENTRY \
+    __attribute__ ((section ("ign_plugin_metadata"), used, \
+                    DETAIL_IGN_PLUGIN_METADATA_RETAIN aligned (8)))
+#endif
+
+// When IGN_PLUGIN_STATIC_REGISTRY is defined, the plugins are meant to be
+// linked into the program statically, possibly together with the plugins of
+// other libraries. In that case the plugins are registered with the
+// process-wide registry of ignition/plugin/StaticRegistry.hh, and there is no
+// IgnitionPluginHook, which could only be defined once per program.
+#ifdef IGN_PLUGIN_STATIC_REGISTRY
+#include <ignition/plugin/StaticRegistry.hh>
+#else
 // extern "C" ensures that the symbol name of IgnitionPluginHook
 // does not get mangled by the compiler, so we can easily use dlsym(~) to
 // retrieve it.
@@ -129,38 +178,18 @@ extern "C"
     // single hook.
     static InfoMap pluginMap;
 
+    // The Info of every registration call is set aside until a Loader asks
+    // for it. A plugin may be registered by several macros in different
+    // translation units, and its fragments only get merged once, by moving
+    // their interfaces and aliases into the first Info of the plugin.
+    static std::vector<ignition::plugin::Info> fragments;
+
     if (_inputSingleInfo)
     {
       // When _inputSingleInfo is not a nullptr, it means that one of the plugin
       // registration macros is providing us with some Info.
-      const ignition::plugin::Info *input =
-          static_cast<const ignition::plugin::Info*>(_inputSingleInfo);
-
-      InfoMap::iterator it;
-      bool inserted;
-
-      // We use insert(~) to ensure that we do not accidentally overwrite some
-      // existing information for the plugin that has this name.
-      std::tie(it, inserted) =
-          pluginMap.insert(std::make_pair(input->name, *input));
-
-      if (!inserted)
-      {
-        // If the object was not inserted, then an entry already existed for
-        // this plugin type. We should still insert each of the interface map
-        // entries and aliases provided by the input info, just in case any of
-        // them are missing from the currently existing entry. This allows the
-        // user to specify different interfaces and aliases for the same plugin
-        // type using different macros in different locations or across multiple
-        // translation units.
-        ignition::plugin::Info &entry = it->second;
-
-        for (const auto &interfaceMapEntry : input->interfaces)
-          entry.interfaces.insert(interfaceMapEntry);
-
-        for (const auto &aliasSetEntry : input->aliases)
-          entry.aliases.insert(aliasSetEntry);
-      }
+      fragments.push_back(
+            *static_cast<const ignition::plugin::Info*>(_inputSingleInfo));
     }
 
     if (_outputAllInfo)
@@ -230,11 +259,178 @@ extern "C"
         // LCOV_EXCL_STOP
       }
 
+      // Merge the fragments which have been registered since the last time
+      // that a Loader asked for the Info. Inserting the interfaces and
+      // aliases of a fragment never overwrites the entries that the plugin
+      // already has. This allows the user to specify different interfaces
+      // and aliases for the same plugin type using different macros in
+      // different locations or across multiple translation units.
+      for (ignition::plugin::Info &fragment : fragments)
+      {
+        const InfoMap::iterator it = pluginMap.find(fragment.name);
+        if (pluginMap.end() == it)
+        {
+          std::string name = fragment.name;
+          pluginMap.emplace(std::move(name), std::move(fragment));
+          continue;
+        }
+
+        ignition::plugin::Info &entry = it->second;
+        entry.interfaces.merge(fragment.interfaces);
+        entry.interfaceIds.merge(fragment.interfaceIds);
+        entry.aliases.merge(fragment.aliases);
+        entry.requiredFeatures.merge(fragment.requiredFeatures);
+        entry.dependencies.merge(fragment.dependencies);
+        entry.constructors.merge(fragment.constructors);
+        entry.kernelTables.merge(fragment.kernelTables);
+
+        if (!entry.enablePluginFromThis)
+          entry.enablePluginFromThis = fragment.enablePluginFromThis;
+      }
+      fragments.clear();
+
       *_outputAllInfo = &pluginMap;
     }
   }
 #endif
 }
+#endif
+
+#ifdef DETAIL_IGN_PLUGIN_HAS_DESCRIPTOR_SECTION
+extern "C"
+{
+  /// \private IgnitionPluginHookV2 is the hook that's used by the Loader to
+  /// retrieve the PluginDescriptors which were registered with
+  /// IGNITION_ADD_STATIC_PLUGIN in a shared library. Unlike
+  /// IgnitionPluginHook, everything that it hands out is plain data which the
+  /// Loader reads in place, so the Loader and the library only need to agree
+  /// on DESCRIPTOR_API_VERSION.
+  ///
+  /// DO NOT CALL THIS FUNCTION DIRECTLY OR CREATE YOUR OWN IMPLEMENTATION OF IT
+  ///
+  /// \param[in,out] _inputAndOutputAPIVersion
+  ///   Loader will pass in a pointer to the DESCRIPTOR_API_VERSION that it
+  ///   knows. IgnitionPluginHookV2 overwrites it with its own version. If the
+  ///   two versions differ, then _begin and _end are not modified.
+  ///
+  /// \param[out] _begin
+  ///   Receives a pointer to the first entry of the array of pointers to
+  ///   PluginDescriptors. Entries of the array may be nullptr, and they must be
+  ///   skipped.
+  ///
+  /// \param[out] _end
+  ///   Receives a pointer to one past the last entry of the array.
+  DETAIL_IGN_PLUGIN_VISIBLE void IgnitionPluginHookV2(
+      int *_inputAndOutputAPIVersion,
+      const void * const ** _begin,
+      const void * const ** _end)
+#ifdef IGN_PLUGIN_REGISTER_MORE_TRANS_UNITS
+  ; /* NOLINT */
+#else
+  {
+    // These are defined by the linker. They are hidden so that every library
+    // refers to its own section instead of the section of whichever library
+    // happened to be loaded first.
+    extern const void * const __start_ign_plugin_descriptors[]
+        __attribute__ ((visibility ("hidden")));
+    extern const void * const __stop_ign_plugin_descriptors[]
+        __attribute__ ((visibility ("hidden")));
+
+    // Make sure that the section exists even if no plugin in this library
+    // has been registered with IGNITION_ADD_STATIC_PLUGIN. Otherwise the
+    // linker would not define the symbols above.
+    DETAIL_IGN_PLUGIN_DESCRIPTOR_ENTRY
+    static const void * const placeholder = nullptr;
+    (void)placeholder;
+
+    if (nullptr == _inputAndOutputAPIVersion)
+    {
+      // This should never happen, or else the function is being misused.
+      // LCOV_EXCL_START
+      return;
+      // LCOV_EXCL_STOP
+    }
+
+    const bool agreement = (ignition::plugin::DESCRIPTOR_API_VERSION
+                            == *_inputAndOutputAPIVersion);
+    *_inputAndOutputAPIVersion = ignition::plugin::DESCRIPTOR_API_VERSION;
+
+    if (!agreement)
+    {
+      // LCOV_EXCL_START
+      return;
+      // LCOV_EXCL_STOP
+    }
+
+    if (_begin)
+      *_begin = __start_ign_plugin_descriptors;
+
+    if (_end)
+      *_end = __stop_ign_plugin_descriptors;
+  }
+#endif
+
+  /// \private IgnitionPluginMetadataHook is the hook that's used by the Loader
+  /// to read the metadata records of a shared library after it has been
+  /// loaded. The records spell out the demangled names of the plugins and
+  /// their interfaces, which spares the Loader from demangling them.
+  ///
+  /// DO NOT CALL THIS FUNCTION DIRECTLY OR CREATE YOUR OWN IMPLEMENTATION OF IT
+  ///
+  /// \param[in,out] _inputAndOutputAPIVersion
+  ///   Loader will pass in a pointer to the METADATA_API_VERSION that it
+  ///   knows. IgnitionPluginMetadataHook overwrites it with its own version.
+  ///   If the two versions differ, then _begin and _end are not modified.
+  ///
+  /// \param[out] _begin
+  ///   Receives a pointer to the start of the metadata section, or nullptr if
+  ///   the library has no metadata records.
+  ///
+  /// \param[out] _end
+  ///   Receives a pointer to the end of the metadata section.
+  DETAIL_IGN_PLUGIN_VISIBLE void IgnitionPluginMetadataHook(
+      int *_inputAndOutputAPIVersion,
+      const char ** _begin,
+      const char ** _end)
+#ifdef IGN_PLUGIN_REGISTER_MORE_TRANS_UNITS
+  ; /* NOLINT */
+#else
+  {
+    // These are defined by the linker if any plugin has been registered. They
+    // are weak so that they resolve to nullptr otherwise.
+    extern const char __start_ign_plugin_metadata[]
+        __attribute__ ((weak, visibility ("hidden")));
+    extern const char __stop_ign_plugin_metadata[]
+        __attribute__ ((weak, visibility ("hidden")));
+
+    if (nullptr == _inputAndOutputAPIVersion)
+    {
+      // This should never happen, or else the function is being misused.
+      // LCOV_EXCL_START
+      return;
+      // LCOV_EXCL_STOP
+    }
+
+    const bool agreement = (ignition::plugin::METADATA_API_VERSION
+                            == *_inputAndOutputAPIVersion);
+    *_inputAndOutputAPIVersion = ignition::plugin::METADATA_API_VERSION;
+
+    if (!agreement)
+    {
+      // LCOV_EXCL_START
+      return;
+      // LCOV_EXCL_STOP
+    }
+
+    if (_begin)
+      *_begin = __start_ign_plugin_metadata;
+
+    if (_end)
+      *_end = __stop_ign_plugin_metadata;
+  }
+#endif
+}
+#endif
 
 namespace ignition
 {
@@ -242,6 +438,34 @@ namespace ignition
   {
     namespace detail
     {
+      //////////////////////////////////////////////////
+      /// \brief Get the mangled name of a type
+      template <typename T>
+      const char *TypeName()
+      {
+        return typeid(T).name();
+      }
+
+      //////////////////////////////////////////////////
+      /// \brief Casts a void pointer to an instance of PluginClass to a void
+      /// pointer to its Interface base.
+      template <typename PluginClass, typename Interface>
+      void *CastToInterface(void *v_ptr)
+      {
+        // READ ME: If you get a compilation error here, then one of the
+        // interfaces that you tried to register for your plugin is not
+        // actually a base class of the plugin class. This is not allowed. A
+        // plugin class must inherit every interface class that you want it to
+        // provide.
+        static_assert(std::is_base_of<Interface, PluginClass>::value,
+                      "YOU ARE ATTEMPTING TO REGISTER AN INTERFACE FOR A "
+                      "PLUGIN, BUT THE INTERFACE IS NOT A BASE CLASS OF THE "
+                      "PLUGIN.");
+
+        PluginClass *d_ptr = static_cast<PluginClass*>(v_ptr);
+        return static_cast<Interface*>(d_ptr);
+      }
+
       //////////////////////////////////////////////////
       /// \brief This default will be called when NoMoreInterfaces is an empty
       /// parameter pack. When one or more Interfaces are provided, the other
@@ -249,7 +473,7 @@ namespace ignition
       template <typename PluginClass, typename... NoMoreInterfaces>
       struct InterfaceHelper
       {
-        public: static void InsertInterfaces(Info::InterfaceCastingMap &)
+        public: static void InsertInterfaces(Info &)
         {
           // Do nothing. This is the terminal specialization of the variadic
           // template class member function.
@@ -263,32 +487,354 @@ namespace ignition
                 typename... RemainingInterfaces>
       struct InterfaceHelper<PluginClass, Interface, RemainingInterfaces...>
       {
-        public: static void InsertInterfaces(
-          Info::InterfaceCastingMap &interfaces)
+        public: static void InsertInterfaces(Info &_info)
         {
-          // READ ME: If you get a compilation error here, then one of the
-          // interfaces that you tried to register for your plugin is not
-          // actually a base class of the plugin class. This is not allowed. A
-          // plugin class must inherit every interface class that you want it to
-          // provide.
-          static_assert(std::is_base_of<Interface, PluginClass>::value,
-                        "YOU ARE ATTEMPTING TO REGISTER AN INTERFACE FOR A "
-                        "PLUGIN, BUT THE INTERFACE IS NOT A BASE CLASS OF THE "
-                        "PLUGIN.");
-
-          interfaces.insert(std::make_pair(
+          _info.interfaces.insert(std::make_pair(
                 typeid(Interface).name(),
-                [=](void* v_ptr)
-                {
-                    PluginClass *d_ptr = static_cast<PluginClass*>(v_ptr);
-                    return static_cast<Interface*>(d_ptr);
-                }));
+                &CastToInterface<PluginClass, Interface>));
+          _info.interfaceIds.insert(std::make_pair(
+                typeid(Interface).name(), InterfaceId<Interface>()));
 
           InterfaceHelper<PluginClass, RemainingInterfaces...>
-              ::InsertInterfaces(interfaces);
+              ::InsertInterfaces(_info);
         }
       };
 
+      //////////////////////////////////////////////////
+      /// \brief The functions that create and destroy instances of a plugin
+      template <typename PluginClass>
+      struct PluginFunctions
+      {
+        /// \brief Create a new instance of the plugin
+        public: static void *Factory()
+        {
+          // vvvvvvvvvvvvvvvvvvvvvvvvv  READ ME  vvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+          // If you get a compilation error here, then you are trying to
+          // register an abstract class as a plugin, which is not allowed. To
+          // register a plugin class, every one if its virtual functions must
+          // have a definition.
+          //
+          // Read through the error produced by your compiler to see which
+          // pure virtual functions you are neglecting to provide overrides
+          // for.
+          // ^^^^^^^^^^^^^^^ READ ABOVE FOR COMPILATION ERRORS ^^^^^^^^^^^^^^^^^
+          return static_cast<void*>(new PluginClass);
+        }
+
+IGN_UTILS_WARN_IGNORE__NON_VIRTUAL_DESTRUCTOR
+        /// \brief Clean up an instance that was made by Factory()
+        public: static void Deleter(void *ptr)
+        {
+          delete static_cast<PluginClass*>(ptr);
+        }
+IGN_UTILS_WARN_RESUME__NON_VIRTUAL_DESTRUCTOR
+
+        /// \brief Construct a new instance of the plugin in the given storage
+        public: static void *Construct(void *storage)
+        {
+          return static_cast<void*>(new (storage) PluginClass);
+        }
+
+        /// \brief Create a new instance of the plugin by forwarding the
+        /// arguments in a std::tuple<Args&&...> to its constructor
+        public: template <typename... Args>
+        static void *ConstructWith(void *_arguments)
+        {
+          return static_cast<void*>(std::apply(
+                [](auto&&... _args)
+                {
+                  return new PluginClass(
+                        std::forward<decltype(_args)>(_args)...);
+                },
+                std::move(*static_cast<std::tuple<Args&&...>*>(_arguments))));
+        }
+
+        /// \brief Destruct an instance that was made by Construct(~)
+        public: static void Destruct(void *ptr)
+        {
+          static_cast<PluginClass*>(ptr)->~PluginClass();
+        }
+
+        /// \brief The EnablePluginFromThis caster of the plugin, or nullptr if
+        /// the plugin does not inherit EnablePluginFromThis
+        public: static constexpr Info::InterfaceCaster EnablePluginFromThis()
+        {
+          if constexpr (std::is_base_of<
+              ::ignition::plugin::EnablePluginFromThis, PluginClass>::value)
+          {
+            return &CastToInterface<PluginClass,
+                ::ignition::plugin::EnablePluginFromThis>;
+          }
+          else
+          {
+            return nullptr;
+          }
+        }
+      };
+
+      //////////////////////////////////////////////////
+      /// \brief Whether the registration of a plugin needs to add the Warmup
+      /// interface, i.e. whether the plugin inherits Warmup without listing it
+      /// among its Interfaces
+      template <typename PluginClass, typename... Interfaces>
+      constexpr bool AddsWarmup =
+          std::is_base_of<::ignition::plugin::Warmup, PluginClass>::value
+          && !(std::is_same<::ignition::plugin::Warmup, Interfaces>::value
+               || ...);
+
+      //////////////////////////////////////////////////
+      /// \brief Builds the constant initialized PluginDescriptor of a plugin
+      /// which provides the given Interfaces.
+      ///
+      /// The descriptor and its interfaces are returned by value, so that the
+      /// registration macros can store them in variables of their own
+      /// translation unit. Static data members of this template would be
+      /// emitted as unique global symbols by GCC, which prevents the library
+      /// from ever being unloaded.
+      template <typename PluginClass, typename... Interfaces>
+      struct Descriptor
+      {
+        /// \brief The number of interfaces of the plugin, including Warmup
+        /// if the plugin inherits it without listing it
+        public: static constexpr std::size_t interfaceCount =
+            sizeof...(Interfaces) + (AddsWarmup<PluginClass, Interfaces...>);
+
+        /// \brief The interfaces of the plugin. There is one extra entry,
+        /// which describes Warmup if the plugin inherits it without listing
+        /// it, so that the array is never empty.
+        public: using InterfaceArray =
+            std::array<InterfaceDescriptor, sizeof...(Interfaces) + 1>;
+
+        /// \brief Describe the interfaces of the plugin
+        /// \return The interfaces
+        public: static constexpr InterfaceArray MakeInterfaces()
+        {
+          if constexpr (AddsWarmup<PluginClass, Interfaces...>)
+          {
+            return {{
+              {&TypeName<Interfaces>,
+               &CastToInterface<PluginClass, Interfaces>,
+               InterfaceId<Interfaces>()}...,
+              {&TypeName<::ignition::plugin::Warmup>,
+               &CastToInterface<PluginClass, ::ignition::plugin::Warmup>,
+               InterfaceId<::ignition::plugin::Warmup>()}
+            }};
+          }
+          else
+          {
+            return {{
+              {&TypeName<Interfaces>,
+               &CastToInterface<PluginClass, Interfaces>,
+               InterfaceId<Interfaces>()}...,
+              {nullptr, nullptr, 0}
+            }};
+          }
+        }
+
+        /// \brief Describe the plugin
+        /// \param[in] _interfaces The interfaces from MakeInterfaces(), or
+        /// nullptr if Interfaces is empty
+        /// \param[in] _aliases The aliases of the plugin
+        /// \param[in] _aliasCount The number of entries in _aliases
+        /// \return The descriptor of the plugin
+        public: static constexpr PluginDescriptor Make(
+          const InterfaceDescriptor *_interfaces,
+          const char * const *_aliases = nullptr,
+          const std::size_t _aliasCount = 0)
+        {
+          return {
+            sizeof(PluginDescriptor),
+            &TypeName<PluginClass>,
+            _interfaces,
+            _interfaces ? interfaceCount : 0,
+            _aliases,
+            _aliasCount,
+            &PluginFunctions<PluginClass>::Factory,
+            &PluginFunctions<PluginClass>::Deleter,
+            sizeof(PluginClass),
+            alignof(PluginClass),
+            &PluginFunctions<PluginClass>::Construct,
+            &PluginFunctions<PluginClass>::Destruct,
+            PluginFunctions<PluginClass>::EnablePluginFromThis()
+          };
+        }
+      };
+
+#ifdef DETAIL_IGN_PLUGIN_HAS_DESCRIPTOR_SECTION
+      //////////////////////////////////////////////////
+      /// \brief A metadata record of the given size, in bytes. See
+      /// METADATA_API_VERSION for its layout.
+      template <std::size_t Size>
+      struct MetadataRecord
+      {
+        char data[Size];
+      };
+
+      //////////////////////////////////////////////////
+      /// \brief Get the size of the metadata record of a plugin
+      /// \param[in] _plugin The name of the plugin
+      /// \param[in] _interfaces The names of the interfaces of the plugin
+      /// \param[in] _interfaceCount The number of entries in _interfaces
+      /// \param[in] _aliases The aliases of the plugin
+      /// \param[in] _aliasCount The number of entries in _aliases
+      /// \return The size of the record, including its padding
+      constexpr std::size_t MetadataSize(
+        const std::string_view _plugin,
+        const std::string_view *_interfaces,
+        const std::size_t _interfaceCount,
+        const std::string_view *_aliases,
+        const std::size_t _aliasCount)
+      {
+        // Every entry has a tag and a null terminator, and the entries are
+        // followed by a 0 tag.
+        std::size_t size = METADATA_HEADER_SIZE + _plugin.size() + 2;
+        for (std::size_t i = 0; i < _interfaceCount; ++i)
+          size += _interfaces[i].size() + 2;
+        for (std::size_t i = 0; i < _aliasCount; ++i)
+          size += _aliases[i].size() + 2;
+        size += 1;
+
+        return (size + 7) / 8 * 8;
+      }
+
+      //////////////////////////////////////////////////
+      /// \brief Append a tagged entry to a metadata record
+      /// \param[in,out] _data The contents of the record
+      /// \param[in,out] _pos The position to write the entry to. It is moved
+      /// past the entry.
+      /// \param[in] _tag The tag of the entry
+      /// \param[in] _text The text of the entry
+      constexpr void AppendMetadataEntry(
+        char *_data, std::size_t &_pos,
+        const char _tag, const std::string_view _text)
+      {
+        _data[_pos++] = _tag;
+        for (const char c : _text)
+          _data[_pos++] = c;
+        _data[_pos++] = '\0';
+      }
+
+      //////////////////////////////////////////////////
+      /// \brief Write the metadata record of a plugin. The parameters are
+      /// the same as for MetadataSize(~).
+      /// \param[in] _flags The METADATA_* flags of the record
+      /// \return The record
+      template <std::size_t Size>
+      constexpr MetadataRecord<Size> MakeMetadata(
+        const std::string_view _plugin,
+        const std::string_view *_interfaces,
+        const std::size_t _interfaceCount,
+        const std::string_view *_aliases,
+        const std::size_t _aliasCount,
+        const unsigned char _flags)
+      {
+        MetadataRecord<Size> record = {};
+        for (std::size_t i = 0; i < 4; ++i)
+          record.data[i] = METADATA_MAGIC[i];
+
+        for (std::size_t i = 0; i < 4; ++i)
+          record.data[4 + i] = static_cast<char>((Size >> (8 * i)) & 0xff);
+
+        record.data[8] = static_cast<char>(METADATA_API_VERSION);
+        record.data[9] = static_cast<char>(_flags);
+
+        std::size_t pos = METADATA_HEADER_SIZE;
+        AppendMetadataEntry(record.data, pos, 'P', _plugin);
+        for (std::size_t i = 0; i < _interfaceCount; ++i)
+          AppendMetadataEntry(record.data, pos, 'I', _interfaces[i]);
+        for (std::size_t i = 0; i < _aliasCount; ++i)
+          AppendMetadataEntry(record.data, pos, 'A', _aliases[i]);
+
+        // The rest of the record, starting with the 0 tag, is already zero
+        return record;
+      }
+
+      //////////////////////////////////////////////////
+      /// \brief The metadata of a plugin which provides the given Interfaces
+      template <typename PluginClass, typename... Interfaces>
+      struct Metadata
+      {
+        /// \brief The demangled name of the plugin
+        public: static constexpr std::string_view name =
+            PrettyTypeName<PluginClass>();
+
+        /// \brief Whether the record lists Warmup, which the plugin inherits
+        /// without listing it
+        public: static constexpr bool addsWarmup =
+            AddsWarmup<PluginClass, Interfaces...>;
+
+        /// \brief The number of entries of `interfaces` that get recorded
+        public: static constexpr std::size_t interfaceCount =
+            sizeof...(Interfaces) + addsWarmup;
+
+        /// \brief The demangled names of the interfaces. There is one extra
+        /// entry, which names Warmup if `addsWarmup` is true, so that the
+        /// array is never empty.
+        public: static constexpr std::string_view
+        interfaces[sizeof...(Interfaces) + 1] = {
+          PrettyTypeName<Interfaces>()...,
+          addsWarmup ? PrettyTypeName<::ignition::plugin::Warmup>()
+                     : std::string_view()
+        };
+
+        /// \brief The flags which describe the plugin class
+        public: static constexpr unsigned char flags =
+            std::is_base_of<::ignition::plugin::EnablePluginFromThis,
+                            PluginClass>::value ?
+              METADATA_ENABLE_PLUGIN_FROM_THIS : 0;
+
+        /// \brief The size of the record without any aliases
+        public: static constexpr std::size_t size = MetadataSize(
+              name, interfaces, interfaceCount, nullptr, 0);
+
+        /// \brief Write the record of the plugin and its interfaces
+        /// \param[in] _extraFlags Flags to add to the record
+        /// \return The record
+        public: static constexpr MetadataRecord<size> Make(
+          const unsigned char _extraFlags = 0)
+        {
+          return MakeMetadata<size>(
+                name, interfaces, interfaceCount, nullptr, 0,
+                flags | _extraFlags);
+        }
+
+        /// \brief Get the size of the record of the plugin with the given
+        /// aliases, but without any interfaces
+        /// \param[in] _aliases The aliases
+        /// \return The size of the record
+        public: template <std::size_t N>
+        static constexpr std::size_t AliasSize(
+          const std::string_view (&_aliases)[N])
+        {
+          return MetadataSize(name, nullptr, 0, _aliases, N);
+        }
+
+        /// \brief Write the record of the plugin with the given aliases, but
+        /// without any interfaces
+        /// \param[in] _aliases The aliases
+        /// \return The record
+        public: template <std::size_t Size, std::size_t N>
+        static constexpr MetadataRecord<Size> WithAliases(
+          const std::string_view (&_aliases)[N])
+        {
+          return MakeMetadata<Size>(name, nullptr, 0, _aliases, N, flags);
+        }
+      };
+#endif
+
+      //////////////////////////////////////////////////
+      /// \brief Send the Info of a plugin to the repository that the Loader
+      /// retrieves it from: the IgnitionPluginHook of this library, or the
+      /// process-wide registry when the plugins are linked statically.
+      inline void SendInfo(const Info &_info)
+      {
+#ifdef IGN_PLUGIN_STATIC_REGISTRY
+        RegisterStaticPlugin(_info);
+#else
+        IgnitionPluginHook(&_info, nullptr, nullptr, nullptr, nullptr);
+#endif
+      }
+
       //////////////////////////////////////////////////
       /// \brief This overload will be called when no more aliases remain to be
       /// inserted. If one or more aliases still need to be inserted, then the
@@ -312,15 +858,18 @@ namespace ignition
       template <typename PluginClass, bool DoEnablePluginFromThis>
       struct IfEnablePluginFromThisImpl
       {
-        public: static void AddIt(Info::InterfaceCastingMap &_interfaces)
+        public: static void AddIt(Info &_info)
         {
-          _interfaces.insert(std::make_pair(
+          const Info::InterfaceCaster caster =
+              PluginFunctions<PluginClass>::EnablePluginFromThis();
+
+          _info.interfaces.insert(std::make_pair(
+                  typeid(EnablePluginFromThis).name(), caster));
+          _info.interfaceIds.insert(std::make_pair(
                   typeid(EnablePluginFromThis).name(),
-                  [=](void *v_ptr)
-                  {
-                    PluginClass *d_ptr = static_cast<PluginClass*>(v_ptr);
-                    return static_cast<EnablePluginFromThis*>(d_ptr);
-                  }));
+                  InterfaceId<EnablePluginFromThis>()));
+
+          _info.enablePluginFromThis = caster;
         }
       };
 
@@ -328,7 +877,7 @@ namespace ignition
       template <typename PluginClass>
       struct IfEnablePluginFromThisImpl<PluginClass, false>
       {
-        public: static void AddIt(Info::InterfaceCastingMap &)
+        public: static void AddIt(Info &)
         {
           // Do nothing, because the plugin does not inherit
           // the EnablePluginFromThis interface.
@@ -358,32 +907,21 @@ namespace ignition
           info.name = typeid(PluginClass).name();
 
           // Create a factory for generating new plugin instances
-          info.factory = [=]()
-          {
-            // vvvvvvvvvvvvvvvvvvvvvvvv  READ ME  vvvvvvvvvvvvvvvvvvvvvvvvvvvvv
-            // If you get a compilation error here, then you are trying to
-            // register an abstract class as a plugin, which is not allowed. To
-            // register a plugin class, every one if its virtual functions must
-            // have a definition.
-            //
-            // Read through the error produced by your compiler to see which
-            // pure virtual functions you are neglecting to provide overrides
-            // for.
-            // ^^^^^^^^^^^^^ READ ABOVE FOR COMPILATION ERRORS ^^^^^^^^^^^^^^^^
-            return static_cast<void*>(new PluginClass);
-          };
+          info.factory = &PluginFunctions<PluginClass>::Factory;
 
-IGN_UTILS_WARN_IGNORE__NON_VIRTUAL_DESTRUCTOR
           // Create a deleter to clean up destroyed instances
-          info.deleter = [=](void *ptr)
-          {
-            delete static_cast<PluginClass*>(ptr);
-          };
-IGN_UTILS_WARN_RESUME__NON_VIRTUAL_DESTRUCTOR
+          info.deleter = &PluginFunctions<PluginClass>::Deleter;
+
+          // Let the Loader place new instances into storage that it provides,
+          // so an instance can share an allocation with its reference count.
+          info.instanceSize = sizeof(PluginClass);
+          info.instanceAlignment = alignof(PluginClass);
+          info.construct = &PluginFunctions<PluginClass>::Construct;
+          info.destruct = &PluginFunctions<PluginClass>::Destruct;
 
           // Construct a map from the plugin to its interfaces
           InterfaceHelper<PluginClass, Interfaces...>
-              ::InsertInterfaces(info.interfaces);
+              ::InsertInterfaces(info);
 
           return info;
         }
@@ -397,11 +935,22 @@ IGN_UTILS_WARN_RESUME__NON_VIRTUAL_DESTRUCTOR
 
           // Add the EnablePluginFromThis interface automatically if it is
           // inherited by PluginClass.
-          IfEnablePluginFromThis<PluginClass>::AddIt(info.interfaces);
+          IfEnablePluginFromThis<PluginClass>::AddIt(info);
+
+          // Likewise for the Warmup interface, which Loader::Prewarm() looks
+          // for. This does nothing if the plugin has listed it already.
+          if constexpr (std::is_base_of<Warmup, PluginClass>::value)
+          {
+            info.interfaces.insert(std::make_pair(
+                  typeid(Warmup).name(),
+                  &CastToInterface<PluginClass, Warmup>));
+            info.interfaceIds.insert(std::make_pair(
+                  typeid(Warmup).name(), InterfaceId<Warmup>()));
+          }
 
           // Send this information as input to this library's global repository
           // of plugins.
-          IgnitionPluginHook(&info, nullptr, nullptr, nullptr, nullptr);
+          SendInfo(info);
         }
 
 
@@ -428,13 +977,114 @@ IGN_UTILS_WARN_RESUME__NON_VIRTUAL_DESTRUCTOR
 
           // Send this information as input to this library's global repository
           // of plugins.
-          IgnitionPluginHook(&info, nullptr, nullptr, nullptr, nullptr);
+          SendInfo(info);
+        }
+
+        /// \brief This function registers the CPU features that a plugin
+        /// requires. Like RegisterAlias, it is only called by a macro which
+        /// never contains any interfaces.
+        public: template <typename... Features>
+        static void RegisterFeatures(Features&&... features)
+        {
+          static_assert(sizeof...(Interfaces) == 0,
+                        "THERE IS A BUG IN THE FEATURE REGISTRATION "
+                        "IMPLEMENTATION! PLEASE REPORT THIS!");
+
+          Info info = MakeInfo();
+
+          // The features are a set of strings, just like the aliases
+          InsertAlias(info.requiredFeatures,
+                      std::forward<Features>(features)...);
+
+          SendInfo(info);
+        }
+
+        /// \brief This function registers the plugins that a plugin depends
+        /// on. Like RegisterAlias, it is only called by a macro which never
+        /// contains any interfaces.
+        public: template <typename... Dependencies>
+        static void RegisterDependencies(Dependencies&&... dependencies)
+        {
+          static_assert(sizeof...(Interfaces) == 0,
+                        "THERE IS A BUG IN THE DEPENDENCY REGISTRATION "
+                        "IMPLEMENTATION! PLEASE REPORT THIS!");
+
+          Info info = MakeInfo();
+
+          InsertAlias(info.dependencies,
+                      std::forward<Dependencies>(dependencies)...);
+
+          SendInfo(info);
+        }
+
+        /// \brief This function registers a constructor of a plugin which
+        /// takes the arguments Args. Like RegisterAlias, it is only called by
+        /// a macro which never contains any interfaces.
+        public: template <typename... Args>
+        static void RegisterConstructor()
+        {
+          static_assert(sizeof...(Interfaces) == 0,
+                        "THERE IS A BUG IN THE CONSTRUCTOR REGISTRATION "
+                        "IMPLEMENTATION! PLEASE REPORT THIS!");
+
+          static_assert(std::is_constructible<PluginClass, Args...>::value,
+                        "The plugin cannot be constructed from the arguments "
+                        "given to IGNITION_ADD_PLUGIN_CONSTRUCTOR");
+
+          Info info = MakeInfo();
+
+          info.constructors.insert(std::make_pair(
+                typeid(void(Args...)).name(),
+                &PluginFunctions<PluginClass>::
+                    template ConstructWith<Args...>));
+
+          SendInfo(info);
+        }
+
+        /// \brief This function registers a table of kernels which the
+        /// plugin exports. Like RegisterAlias, it is only called by a macro
+        /// which never contains any interfaces.
+        /// \param[in] _table The table, which must have static storage
+        /// duration
+        public: template <typename Table>
+        static void RegisterKernels(const Table &_table)
+        {
+          static_assert(sizeof...(Interfaces) == 0,
+                        "THERE IS A BUG IN THE KERNEL REGISTRATION "
+                        "IMPLEMENTATION! PLEASE REPORT THIS!");
+
+          static_assert(std::is_standard_layout<Table>::value &&
+                        std::is_trivially_copyable<Table>::value,
+                        "A kernel table given to IGNITION_ADD_PLUGIN_KERNELS "
+                        "must be a plain struct, e.g. of function pointers");
+
+          Info info = MakeInfo();
+
+          info.kernelTables.insert(std::make_pair(
+                typeid(Table).name(),
+                Info::KernelTable{static_cast<const void*>(&_table),
+                                  Table::kAbiVersion}));
+
+          SendInfo(info);
         }
       };
     }
   }
 }
 
+#ifdef DETAIL_IGN_PLUGIN_HAS_DESCRIPTOR_SECTION
+//////////////////////////////////////////////////
+/// This macro places a constant initialized metadata record into the
+/// metadata section of the library, where the Loader can read it without
+/// opening the library.
+#define DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, ...) \
+  DETAIL_IGN_PLUGIN_METADATA_ENTRY \
+  constexpr auto metadata##UniqueID = __VA_ARGS__;
+#else
+#define DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, ...)
+#endif
+
+
 //////////////////////////////////////////////////
 /// This macro creates a uniquely-named class whose constructor calls the
 /// ignition::plugin::detail::Registrar::Register function. It then declares a
@@ -458,6 +1108,9 @@ IGN_UTILS_WARN_RESUME__NON_VIRTUAL_DESTRUCTOR
         }; \
   \
         static ExecuteWhenLoadingLibrary##UniqueID execute##UniqueID; \
+  \
+        DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, \
+            ::ignition::plugin::detail::Metadata<__VA_ARGS__>::Make()) \
       } /* namespace */ \
     } \
   }
@@ -501,6 +1154,11 @@ IGN_UTILS_WARN_RESUME__NON_VIRTUAL_DESTRUCTOR
         }; \
   \
         static ExecuteWhenLoadingLibrary##UniqueID execute##UniqueID; \
+  \
+        /* The aliases are only known once the code above runs */ \
+        DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, \
+            ::ignition::plugin::detail::Metadata<PluginClass>::Make( \
+                ::ignition::plugin::METADATA_INCOMPLETE)) \
       } /* namespace */ \
     } \
   }
@@ -522,6 +1180,195 @@ IGN_UTILS_WARN_RESUME__NON_VIRTUAL_DESTRUCTOR
   __COUNTER__, PluginClass, __VA_ARGS__)
 
 
+//////////////////////////////////////////////////
+/// This macro works like DETAIL_IGNITION_ADD_PLUGIN_ALIAS_HELPER, except that
+/// it calls the ignition::plugin::detail::Registrar::RegisterFeatures
+/// function.
+#define DETAIL_IGNITION_ADD_PLUGIN_FEATURES_HELPER(UniqueID, PluginClass, ...) \
+  namespace ignition \
+  { \
+    namespace plugin \
+    { \
+      namespace \
+      { \
+        struct ExecuteWhenLoadingLibrary##UniqueID \
+        { \
+          ExecuteWhenLoadingLibrary##UniqueID() \
+          { \
+            ::ignition::plugin::detail::Registrar<PluginClass>:: \
+                RegisterFeatures(__VA_ARGS__); \
+          } \
+        }; \
+  \
+        static ExecuteWhenLoadingLibrary##UniqueID execute##UniqueID; \
+  \
+        /* The features are only known once the code above runs */ \
+        DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, \
+            ::ignition::plugin::detail::Metadata<PluginClass>::Make( \
+                ::ignition::plugin::METADATA_INCOMPLETE)) \
+      } /* namespace */ \
+    } \
+  }
+
+
+//////////////////////////////////////////////////
+/// This macro is needed to force the __COUNTER__ macro to expand to a value
+/// before being passed to the *_HELPER macro.
+#define DETAIL_IGNITION_ADD_PLUGIN_FEATURES_WITH_COUNTER( \
+  UniqueID, PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_FEATURES_HELPER(UniqueID, PluginClass, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+/// We use the __COUNTER__ here to give each registration its own unique name.
+#define DETAIL_IGNITION_ADD_PLUGIN_FEATURES(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_FEATURES_WITH_COUNTER( \
+  __COUNTER__, PluginClass, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+/// This macro works like DETAIL_IGNITION_ADD_PLUGIN_FEATURES_HELPER, except
+/// that it calls the
+/// ignition::plugin::detail::Registrar::RegisterDependencies function.
+#define DETAIL_IGNITION_ADD_PLUGIN_DEPENDENCIES_HELPER( \
+  UniqueID, PluginClass, ...) \
+  namespace ignition \
+  { \
+    namespace plugin \
+    { \
+      namespace \
+      { \
+        struct ExecuteWhenLoadingLibrary##UniqueID \
+        { \
+          ExecuteWhenLoadingLibrary##UniqueID() \
+          { \
+            ::ignition::plugin::detail::Registrar<PluginClass>:: \
+                RegisterDependencies(__VA_ARGS__); \
+          } \
+        }; \
+  \
+        static ExecuteWhenLoadingLibrary##UniqueID execute##UniqueID; \
+  \
+        /* The dependencies are only known once the code above runs */ \
+        DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, \
+            ::ignition::plugin::detail::Metadata<PluginClass>::Make( \
+                ::ignition::plugin::METADATA_INCOMPLETE)) \
+      } /* namespace */ \
+    } \
+  }
+
+
+//////////////////////////////////////////////////
+/// This macro is needed to force the __COUNTER__ macro to expand to a value
+/// before being passed to the *_HELPER macro.
+#define DETAIL_IGNITION_ADD_PLUGIN_DEPENDENCIES_WITH_COUNTER( \
+  UniqueID, PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_DEPENDENCIES_HELPER( \
+      UniqueID, PluginClass, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+/// We use the __COUNTER__ here to give each registration its own unique name.
+#define DETAIL_IGNITION_ADD_PLUGIN_DEPENDENCIES(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_DEPENDENCIES_WITH_COUNTER( \
+  __COUNTER__, PluginClass, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+/// This macro works like DETAIL_IGNITION_ADD_PLUGIN_FEATURES_HELPER, except
+/// that it calls the
+/// ignition::plugin::detail::Registrar::RegisterConstructor function.
+#define DETAIL_IGNITION_ADD_PLUGIN_CONSTRUCTOR_HELPER( \
+  UniqueID, PluginClass, ...) \
+  namespace ignition \
+  { \
+    namespace plugin \
+    { \
+      namespace \
+      { \
+        struct ExecuteWhenLoadingLibrary##UniqueID \
+        { \
+          ExecuteWhenLoadingLibrary##UniqueID() \
+          { \
+            ::ignition::plugin::detail::Registrar<PluginClass>:: \
+                RegisterConstructor<__VA_ARGS__>(); \
+          } \
+        }; \
+  \
+        static ExecuteWhenLoadingLibrary##UniqueID execute##UniqueID; \
+  \
+        /* The constructors only exist once the code above runs */ \
+        DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, \
+            ::ignition::plugin::detail::Metadata<PluginClass>::Make( \
+                ::ignition::plugin::METADATA_INCOMPLETE)) \
+      } /* namespace */ \
+    } \
+  }
+
+
+//////////////////////////////////////////////////
+/// This macro is needed to force the __COUNTER__ macro to expand to a value
+/// before being passed to the *_HELPER macro.
+#define DETAIL_IGNITION_ADD_PLUGIN_CONSTRUCTOR_WITH_COUNTER( \
+  UniqueID, PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_CONSTRUCTOR_HELPER( \
+      UniqueID, PluginClass, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+/// We use the __COUNTER__ here to give each registration its own unique name.
+#define DETAIL_IGNITION_ADD_PLUGIN_CONSTRUCTOR(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_CONSTRUCTOR_WITH_COUNTER( \
+  __COUNTER__, PluginClass, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+/// This macro works like DETAIL_IGNITION_ADD_PLUGIN_FEATURES_HELPER, except
+/// that it calls the
+/// ignition::plugin::detail::Registrar::RegisterKernels function.
+#define DETAIL_IGNITION_ADD_PLUGIN_KERNELS_HELPER( \
+  UniqueID, PluginClass, Table) \
+  namespace ignition \
+  { \
+    namespace plugin \
+    { \
+      namespace \
+      { \
+        struct ExecuteWhenLoadingLibrary##UniqueID \
+        { \
+          ExecuteWhenLoadingLibrary##UniqueID() \
+          { \
+            ::ignition::plugin::detail::Registrar<PluginClass>:: \
+                RegisterKernels(Table); \
+          } \
+        }; \
+  \
+        static ExecuteWhenLoadingLibrary##UniqueID execute##UniqueID; \
+  \
+        /* The kernel tables only exist once the code above runs */ \
+        DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, \
+            ::ignition::plugin::detail::Metadata<PluginClass>::Make( \
+                ::ignition::plugin::METADATA_INCOMPLETE)) \
+      } /* namespace */ \
+    } \
+  }
+
+
+//////////////////////////////////////////////////
+/// This macro is needed to force the __COUNTER__ macro to expand to a value
+/// before being passed to the *_HELPER macro.
+#define DETAIL_IGNITION_ADD_PLUGIN_KERNELS_WITH_COUNTER( \
+  UniqueID, PluginClass, Table) \
+  DETAIL_IGNITION_ADD_PLUGIN_KERNELS_HELPER(UniqueID, PluginClass, Table)
+
+
+//////////////////////////////////////////////////
+/// We use the __COUNTER__ here to give each registration its own unique name.
+#define DETAIL_IGNITION_ADD_PLUGIN_KERNELS(PluginClass, Table) \
+  DETAIL_IGNITION_ADD_PLUGIN_KERNELS_WITH_COUNTER( \
+  __COUNTER__, PluginClass, Table)
+
+
 //////////////////////////////////////////////////
 #define DETAIL_IGNITION_ADD_FACTORY(ProductType, FactoryType) \
   DETAIL_IGNITION_ADD_PLUGIN(FactoryType::Producing<ProductType>, FactoryType) \
@@ -536,4 +1383,106 @@ IGN_UTILS_WARN_RESUME__NON_VIRTUAL_DESTRUCTOR
   DETAIL_IGNITION_ADD_PLUGIN_ALIAS(FactoryType::Producing<ProductType>, \
       __VA_ARGS__)
 
+
+#ifdef DETAIL_IGN_PLUGIN_HAS_DESCRIPTOR_SECTION
+//////////////////////////////////////////////////
+/// This macro places a pointer to the constant initialized PluginDescriptor
+/// of a plugin into the descriptor section of the library, where
+/// IgnitionPluginHookV2 will find it. Unlike
+/// DETAIL_IGNITION_ADD_PLUGIN_HELPER, nothing gets executed when the library
+/// is loaded.
+#define DETAIL_IGNITION_ADD_STATIC_PLUGIN_HELPER(UniqueID, ...) \
+  namespace ignition \
+  { \
+    namespace plugin \
+    { \
+      namespace \
+      { \
+        constexpr auto interfaces##UniqueID = \
+            ::ignition::plugin::detail::Descriptor<__VA_ARGS__> \
+                ::MakeInterfaces(); \
+  \
+        constexpr ::ignition::plugin::PluginDescriptor \
+        pluginDescriptor##UniqueID = \
+            ::ignition::plugin::detail::Descriptor<__VA_ARGS__>::Make( \
+                interfaces##UniqueID.data()); \
+  \
+        DETAIL_IGN_PLUGIN_DESCRIPTOR_ENTRY \
+        const void * const descriptor##UniqueID = &pluginDescriptor##UniqueID; \
+  \
+        DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, \
+            ::ignition::plugin::detail::Metadata<__VA_ARGS__>::Make()) \
+      } /* namespace */ \
+    } \
+  }
+
+
+//////////////////////////////////////////////////
+/// This macro emits a PluginDescriptor which carries the given aliases. The
+/// aliases must be string literals, since they are stored in a constant
+/// initialized array.
+#define DETAIL_IGNITION_ADD_STATIC_PLUGIN_ALIAS_HELPER( \
+  UniqueID, PluginClass, ...) \
+  namespace ignition \
+  { \
+    namespace plugin \
+    { \
+      namespace \
+      { \
+        constexpr const char *aliases##UniqueID[] = {__VA_ARGS__}; \
+  \
+        constexpr ::ignition::plugin::PluginDescriptor \
+        aliasDescriptor##UniqueID = \
+            ::ignition::plugin::detail::Descriptor<PluginClass>::Make( \
+                nullptr, aliases##UniqueID, \
+                sizeof(aliases##UniqueID) / sizeof(aliases##UniqueID[0])); \
+  \
+        DETAIL_IGN_PLUGIN_DESCRIPTOR_ENTRY \
+        const void * const descriptor##UniqueID = &aliasDescriptor##UniqueID; \
+  \
+        constexpr std::string_view aliasNames##UniqueID[] = {__VA_ARGS__}; \
+  \
+        DETAIL_IGN_PLUGIN_ADD_METADATA(UniqueID, \
+            ::ignition::plugin::detail::Metadata<PluginClass>::WithAliases< \
+                ::ignition::plugin::detail::Metadata<PluginClass>::AliasSize( \
+                    aliasNames##UniqueID)>(aliasNames##UniqueID)) \
+      } /* namespace */ \
+    } \
+  }
+#else
+#define DETAIL_IGNITION_ADD_STATIC_PLUGIN_HELPER(UniqueID, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_HELPER(UniqueID, __VA_ARGS__)
+
+#define DETAIL_IGNITION_ADD_STATIC_PLUGIN_ALIAS_HELPER( \
+  UniqueID, PluginClass, ...) \
+  DETAIL_IGNITION_ADD_PLUGIN_ALIAS_HELPER(UniqueID, PluginClass, __VA_ARGS__)
+#endif
+
+
+//////////////////////////////////////////////////
+/// This macro is needed to force the __COUNTER__ macro to expand to a value
+/// before being passed to the *_HELPER macro.
+#define DETAIL_IGNITION_ADD_STATIC_PLUGIN_WITH_COUNTER(UniqueID, ...) \
+  DETAIL_IGNITION_ADD_STATIC_PLUGIN_HELPER(UniqueID, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+#define DETAIL_IGNITION_ADD_STATIC_PLUGIN(...) \
+  DETAIL_IGNITION_ADD_STATIC_PLUGIN_WITH_COUNTER(__COUNTER__, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+/// This macro is needed to force the __COUNTER__ macro to expand to a value
+/// before being passed to the *_HELPER macro.
+#define DETAIL_IGNITION_ADD_STATIC_PLUGIN_ALIAS_WITH_COUNTER( \
+  UniqueID, PluginClass, ...) \
+  DETAIL_IGNITION_ADD_STATIC_PLUGIN_ALIAS_HELPER( \
+      UniqueID, PluginClass, __VA_ARGS__)
+
+
+//////////////////////////////////////////////////
+#define DETAIL_IGNITION_ADD_STATIC_PLUGIN_ALIAS(PluginClass, ...) \
+  DETAIL_IGNITION_ADD_STATIC_PLUGIN_ALIAS_WITH_COUNTER( \
+  __COUNTER__, PluginClass, __VA_ARGS__)
+
 #endif
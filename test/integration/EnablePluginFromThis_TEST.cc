@@ -17,6 +17,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include <ignition/plugin/EnablePluginFromThis.hh>
 #include <ignition/plugin/Loader.hh>
 #include <ignition/plugin/SpecializedPluginPtr.hh>
@@ -53,6 +55,19 @@ TEST(EnablePluginFromThis, BasicInstantiate)
   std::shared_ptr<void> ptr = getInstance->PluginInstancePtr();
   EXPECT_NE(nullptr, ptr);
 
+  // The plugin which is recovered from the instance shares its interfaces
+  EXPECT_EQ(plugin->QueryInterface<test::util::DummyIntBase>(),
+            fromThis->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_EQ(getInstance,
+            fromThis->QueryInterface<test::util::DummyGetPluginInstancePtr>());
+
+  // A plugin which was recovered that way can be locked again
+  const ignition::plugin::WeakPluginPtr weakFromThis = fromThis;
+  const ignition::plugin::PluginPtr relocked = weakFromThis.Lock();
+  EXPECT_EQ(plugin, relocked);
+  EXPECT_EQ(plugin->QueryInterface<test::util::DummyDoubleBase>(),
+            relocked->QueryInterface<test::util::DummyDoubleBase>());
+
 
   // Note: the DummySinglePlugin class does not inherit EnablePluginFromThis
   plugin = pl.Instantiate("test::util::DummySinglePlugin");
@@ -63,6 +78,33 @@ TEST(EnablePluginFromThis, BasicInstantiate)
   EXPECT_EQ(nullptr, fromThisInterface);
 }
 
+/////////////////////////////////////////////////
+TEST(EnablePluginFromThis, InstantiateMany)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  std::vector<ignition::plugin::PluginPtr> plugins;
+  ASSERT_EQ(3u, pl.Instantiate("test::util::DummyMultiPlugin", 3, plugins));
+
+  for (const ignition::plugin::PluginPtr &plugin : plugins)
+  {
+    auto *fromThisInterface =
+        plugin->QueryInterface<ignition::plugin::EnablePluginFromThis>();
+    ASSERT_TRUE(fromThisInterface);
+    EXPECT_EQ(plugin, fromThisInterface->PluginFromThis());
+  }
+
+  // Plugins which do not inherit EnablePluginFromThis are unaffected
+  plugins.clear();
+  ASSERT_EQ(2u, pl.Instantiate("test::util::DummySinglePlugin", 2, plugins));
+  for (const ignition::plugin::PluginPtr &plugin : plugins)
+  {
+    EXPECT_EQ(nullptr,
+              plugin->QueryInterface<ignition::plugin::EnablePluginFromThis>());
+  }
+}
+
 /////////////////////////////////////////////////
 using MySpecializedPluginPtr = ignition::plugin::SpecializedPluginPtr<
   test::util::DummyNameBase,
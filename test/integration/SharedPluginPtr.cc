@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ignition/plugin/SharedPluginPtr.hh>
+#include <ignition/plugin/WeakPluginPtr.hh>
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/DummyPlugins.hh"
+#include "utils.hh"
+
+using ignition::plugin::SharedPluginPtr;
+
+/////////////////////////////////////////////////
+TEST(SharedPluginPtr, Lifecycle)
+{
+  const std::string &libraryPath = IGNDummyPlugins_LIB;
+
+  ignition::plugin::WeakPluginPtr weak;
+
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  {
+    SharedPluginPtr shared;
+
+    {
+      ignition::plugin::Loader pl;
+      pl.LoadLib(libraryPath);
+
+      shared = pl.Instantiate("test::util::DummyMultiPlugin");
+      ASSERT_TRUE(shared);
+      weak = shared.Get();
+    }
+
+    CHECK_FOR_LIBRARY(libraryPath, true);
+    EXPECT_FALSE(weak.IsExpired());
+
+    test::util::DummyIntBase *base =
+        shared->QueryInterface<test::util::DummyIntBase>();
+    ASSERT_NE(nullptr, base);
+    EXPECT_EQ(5, base->MyIntegerValueIs());
+    EXPECT_EQ("test::util::DummyMultiPlugin", *(*shared).Name());
+
+    SharedPluginPtr copy = shared;
+    shared.Clear();
+    EXPECT_TRUE(shared.IsEmpty());
+    EXPECT_FALSE(weak.IsExpired());
+    EXPECT_EQ(base, copy->QueryInterface<test::util::DummyIntBase>());
+  }
+
+  EXPECT_TRUE(weak.IsExpired());
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+TEST(SharedPluginPtr, CopyMove)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  const ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::util::DummyMultiPlugin");
+
+  SharedPluginPtr fromPlugin(plugin);
+  EXPECT_EQ(plugin, fromPlugin.Get());
+
+  SharedPluginPtr copied(fromPlugin);
+  EXPECT_EQ(plugin, copied.Get());
+
+  SharedPluginPtr copyAssigned;
+  copyAssigned = fromPlugin;
+  EXPECT_EQ(plugin, copyAssigned.Get());
+
+  const SharedPluginPtr &self = copyAssigned;
+  copyAssigned = self;
+  EXPECT_EQ(plugin, copyAssigned.Get());
+
+  SharedPluginPtr moved(std::move(copied));
+  EXPECT_EQ(plugin, moved.Get());
+  EXPECT_TRUE(copied.IsEmpty());
+  EXPECT_TRUE(copied.Get().IsEmpty());
+
+  SharedPluginPtr moveAssigned;
+  moveAssigned = std::move(moved);
+  EXPECT_EQ(plugin, moveAssigned.Get());
+  EXPECT_TRUE(moved.IsEmpty());
+
+  // An instance which is shared again gets a block of its own, and both
+  // keep the instance alive
+  SharedPluginPtr other(plugin);
+  ignition::plugin::WeakPluginPtr weak(plugin);
+  fromPlugin.Clear();
+  copyAssigned.Clear();
+  moveAssigned.Clear();
+  EXPECT_FALSE(weak.IsExpired());
+  EXPECT_EQ(plugin, other.Get());
+}
+
+/////////////////////////////////////////////////
+TEST(SharedPluginPtr, Empty)
+{
+  SharedPluginPtr empty;
+  EXPECT_TRUE(empty.IsEmpty());
+  EXPECT_FALSE(empty);
+  EXPECT_TRUE(empty.Get().IsEmpty());
+  EXPECT_EQ(nullptr, empty->QueryInterface<test::util::DummyIntBase>());
+
+  SharedPluginPtr fromEmpty{ignition::plugin::PluginPtr()};
+  EXPECT_TRUE(fromEmpty.IsEmpty());
+
+  SharedPluginPtr copy = empty;
+  EXPECT_TRUE(copy.IsEmpty());
+
+  EXPECT_LE(1u, SharedPluginPtr::ShardCount());
+  EXPECT_EQ(0u, SharedPluginPtr::ShardCount()
+            & (SharedPluginPtr::ShardCount() - 1));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedPluginPtr, ManyThreads)
+{
+  const std::string &libraryPath = IGNDummyPlugins_LIB;
+  ignition::plugin::WeakPluginPtr weak;
+
+  {
+    ignition::plugin::Loader pl;
+    pl.LoadLib(libraryPath);
+
+    SharedPluginPtr shared = pl.Instantiate("test::util::DummyMultiPlugin");
+    weak = shared.Get();
+
+    // Hand copies from one thread to others, which drop them, while every
+    // thread also keeps copying the instance for itself.
+    const std::size_t threadCount = 16;
+    std::vector<std::vector<SharedPluginPtr>> handed(threadCount);
+    for (std::vector<SharedPluginPtr> &copies : handed)
+      copies.assign(100, shared);
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threadCount; ++t)
+    {
+      threads.emplace_back([&shared, &copies = handed[t]]()
+      {
+        for (int i = 0; i < 10000; ++i)
+        {
+          const SharedPluginPtr local = shared;
+          const SharedPluginPtr copy = local;
+          EXPECT_EQ(5, copy->QueryInterface<test::util::DummyIntBase>()
+                    ->MyIntegerValueIs());
+        }
+
+        copies.clear();
+      });
+    }
+
+    for (std::thread &thread : threads)
+      thread.join();
+
+    EXPECT_FALSE(weak.IsExpired());
+
+    // The last reference is dropped by a thread which did not create it
+    std::thread([moved = std::move(shared)]() mutable
+    {
+      moved.Clear();
+    }).join();
+  }
+
+  EXPECT_TRUE(weak.IsExpired());
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -98,6 +98,37 @@ TEST(WeakPluginPtr, CopyMove)
   EXPECT_EQ(plugin, weakAssignFromPlugin.Lock());
 }
 
+/////////////////////////////////////////////////
+TEST(WeakPluginPtr, MovedFromIsExpired)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::util::DummyMultiPlugin");
+
+  ignition::plugin::WeakPluginPtr weak(plugin);
+  ignition::plugin::WeakPluginPtr moved(std::move(weak));
+  EXPECT_TRUE(weak.IsExpired());
+  EXPECT_TRUE(weak.Lock().IsEmpty());
+  EXPECT_FALSE(moved.IsExpired());
+
+  ignition::plugin::WeakPluginPtr moveAssigned;
+  moveAssigned = std::move(moved);
+  EXPECT_TRUE(moved.IsExpired());
+  EXPECT_FALSE(moveAssigned.IsExpired());
+
+  // A locked PluginPtr keeps the Info of the plugin alive along with its
+  // instance, even after every other reference is gone.
+  ignition::plugin::PluginPtr locked = moveAssigned.Lock();
+  plugin = ignition::plugin::PluginPtr();
+  EXPECT_FALSE(moveAssigned.IsExpired());
+  EXPECT_EQ("test::util::DummyMultiPlugin", *locked->Name());
+
+  locked = ignition::plugin::PluginPtr();
+  EXPECT_TRUE(moveAssigned.IsExpired());
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
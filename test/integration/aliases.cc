@@ -17,6 +17,11 @@
 
 #include <gtest/gtest.h>
 
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include <ignition/plugin/Loader.hh>
 
 #include "../plugins/DummyPlugins.hh"
@@ -86,6 +91,129 @@ TEST(Alias, ConflictingAlias)
   EXPECT_TRUE(attempt.IsEmpty());
 }
 
+/////////////////////////////////////////////////
+TEST(Alias, ForgetAliases)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+  ASSERT_EQ(2u, pl.PluginsWithAlias("Bar").size());
+
+  EXPECT_TRUE(pl.ForgetLibrary(IGNDummyPlugins_LIB));
+  EXPECT_TRUE(pl.PluginsWithAlias("Bar").empty());
+  EXPECT_TRUE(pl.PluginsWithAlias("Foo").empty());
+
+  // Aliases which no longer refer to any plugin are dropped entirely
+  EXPECT_EQ(std::string::npos, pl.PrettyStr().find("Alternative name"));
+
+  // Cycling the library does not leave anything behind
+  pl.LoadLib(IGNDummyPlugins_LIB);
+  EXPECT_EQ(2u, pl.PluginsWithAlias("Bar").size());
+  EXPECT_TRUE(pl.ForgetLibrary(IGNDummyPlugins_LIB));
+  EXPECT_EQ(std::string::npos, pl.PrettyStr().find("Alternative name"));
+}
+
+/////////////////////////////////////////////////
+TEST(Alias, AmbiguousAliases)
+{
+  ignition::plugin::Loader pl;
+  EXPECT_TRUE(pl.AmbiguousAliases().empty());
+
+  std::vector<std::string> messages;
+  pl.SetLogger([&](const std::string &_message)
+  {
+    messages.push_back(_message);
+  });
+
+  // Each collision is reported once, while the library is loaded
+  pl.LoadLib(IGNDummyPlugins_LIB);
+  EXPECT_EQ((std::set<std::string>{"Bar", "Baz"}), pl.AmbiguousAliases());
+  ASSERT_EQ(2u, messages.size());
+  EXPECT_NE(std::string::npos, messages[0].find("multiple plugins"));
+
+  // Loading the same library again does not add any collisions
+  pl.LoadLib(IGNDummyPlugins_LIB);
+  EXPECT_EQ(2u, messages.size());
+
+  // Ambiguous lookups still say why they failed
+  EXPECT_TRUE(pl.Instantiate("Bar").IsEmpty());
+  EXPECT_EQ(3u, messages.size());
+
+  // The collisions go away along with the plugins
+  EXPECT_TRUE(pl.ForgetLibrary(IGNDummyPlugins_LIB));
+  EXPECT_TRUE(pl.AmbiguousAliases().empty());
+
+  pl.SetLogger(nullptr);
+  pl.LoadLib(IGNDummyPlugins_LIB);
+  EXPECT_EQ(2u, pl.AmbiguousAliases().size());
+}
+
+/////////////////////////////////////////////////
+TEST(Alias, RepeatedLookups)
+{
+  using ignition::plugin::Loader;
+  Loader pl;
+
+  // Looking a name up before its library is loaded must not stop it from
+  // being found afterwards
+  EXPECT_EQ(Loader::LookupStatus::NOT_FOUND, pl.TryLookupPlugin("Foo"));
+  EXPECT_TRUE(pl.Instantiate("Foo").IsEmpty());
+
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  std::string name;
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(Loader::LookupStatus::FOUND, pl.TryLookupPlugin("Foo", &name));
+    EXPECT_EQ("test::util::DummyMultiPlugin", name);
+    EXPECT_FALSE(pl.Instantiate("Foo").IsEmpty());
+
+    EXPECT_EQ(Loader::LookupStatus::AMBIGUOUS_ALIAS,
+              pl.TryLookupPlugin("Bar"));
+    EXPECT_EQ(Loader::LookupStatus::NOT_FOUND,
+              pl.TryLookupPlugin("not a plugin"));
+  }
+
+  // Forgetting the library must not leave stale entries behind
+  EXPECT_TRUE(pl.ForgetLibrary(IGNDummyPlugins_LIB));
+  EXPECT_EQ(Loader::LookupStatus::NOT_FOUND, pl.TryLookupPlugin("Foo"));
+  EXPECT_TRUE(pl.Instantiate("Foo").IsEmpty());
+
+  pl.LoadLib(IGNDummyPlugins_LIB);
+  EXPECT_FALSE(pl.Instantiate("Foo").IsEmpty());
+  EXPECT_FALSE(pl.Instantiate("test::util::DummyNoAliasPlugin").IsEmpty());
+}
+
+/////////////////////////////////////////////////
+TEST(Alias, WriteJson)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  std::stringstream json;
+  pl.WriteJson(json);
+  const std::string registry = json.str();
+
+  EXPECT_EQ(0u, registry.find("{\"interfaces\":["));
+  EXPECT_EQ('}', registry.back());
+  EXPECT_NE(std::string::npos, registry.find(
+      "{\"name\":\"test::util::DummyNoAliasPlugin\",\"aliases\":[],"));
+  EXPECT_NE(std::string::npos, registry.find("\"Alternative name\""));
+  EXPECT_NE(std::string::npos, registry.find("DummyPlugins"));
+
+  // Both aliases which are shared by two plugins are reported
+  const std::size_t collisions = registry.find("\"aliasCollisions\":{");
+  ASSERT_NE(std::string::npos, collisions);
+  EXPECT_NE(std::string::npos, registry.find("\"Bar\":[", collisions));
+  EXPECT_NE(std::string::npos, registry.find("\"Baz\":[", collisions));
+  EXPECT_EQ(std::string::npos, registry.find("\"Foo\":[", collisions));
+
+  // PrettyStr() is written the same way as PrettyPrint()
+  std::stringstream pretty;
+  pl.PrettyPrint(pretty);
+  EXPECT_EQ(pl.PrettyStr(), pretty.str());
+  EXPECT_NE(std::string::npos,
+            pretty.str().find("There are 2 aliases with a name collision"));
+}
 
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
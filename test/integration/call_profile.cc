@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/plugin/CallProfile.hh>
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/DummyPlugins.hh"
+#include "utils.hh"
+
+using ignition::plugin::Loader;
+using ignition::plugin::MethodProfile;
+using ignition::plugin::PluginPtr;
+
+/////////////////////////////////////////////////
+class ProfiledDummyInt
+    : public ignition::plugin::ProfiledInterface<test::util::DummyIntBase>
+{
+  public: using ProfiledInterface::ProfiledInterface;
+
+  public: int MyIntegerValueIs() const override
+  {
+    return this->Profile(0, [&]{ return this->Target()->MyIntegerValueIs(); });
+  }
+};
+
+IGNITION_PLUGIN_PROFILE_INTERFACE(
+    test::util::DummyIntBase, ProfiledDummyInt, "MyIntegerValueIs")
+
+/////////////////////////////////////////////////
+class ProfiledDummySetter
+    : public ignition::plugin::ProfiledInterface<test::util::DummySetterBase>
+{
+  public: using ProfiledInterface::ProfiledInterface;
+
+  public: void SetName(const std::string &_name) override
+  {
+    this->Profile(0, [&]{ this->Target()->SetName(_name); });
+  }
+
+  public: void SetDoubleValue(const double _val) override
+  {
+    this->Profile(1, [&]{ this->Target()->SetDoubleValue(_val); });
+  }
+
+  public: void SetIntegerValue(const int _val) override
+  {
+    this->Profile(2, [&]{ this->Target()->SetIntegerValue(_val); });
+  }
+};
+
+IGNITION_PLUGIN_PROFILE_INTERFACE(
+    test::util::DummySetterBase, ProfiledDummySetter,
+    "SetName", "SetDoubleValue", "SetIntegerValue")
+
+/////////////////////////////////////////////////
+const MethodProfile *FindMethod(const std::vector<MethodProfile> &_profile,
+                                const std::string &_method)
+{
+  for (const MethodProfile &method : _profile)
+  {
+    if (method.method == _method)
+      return &method;
+  }
+
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+TEST(CallProfile, ProxiesCountCalls)
+{
+  const std::string &libraryPath = IGNDummyPlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  Loader loader;
+  loader.LoadLib(libraryPath);
+  ignition::plugin::ResetCallProfile();
+
+  // Instances made while profiling is off are not profiled
+  PluginPtr unprofiled = loader.Instantiate("test::util::DummyMultiPlugin");
+  ASSERT_TRUE(unprofiled);
+  EXPECT_FALSE(ignition::plugin::CallProfiling());
+
+  ignition::plugin::SetCallProfiling(true);
+  EXPECT_TRUE(ignition::plugin::CallProfiling());
+  EXPECT_EQ(5, unprofiled->QueryInterface<test::util::DummyIntBase>()
+            ->MyIntegerValueIs());
+  EXPECT_TRUE(ignition::plugin::CallProfile().empty());
+
+  PluginPtr plugin = loader.Instantiate("test::util::DummyMultiPlugin");
+  ASSERT_TRUE(plugin);
+  auto *setter = plugin->QueryInterface<test::util::DummySetterBase>();
+  auto *integer = plugin->QueryInterface<test::util::DummyIntBase>();
+  ASSERT_NE(nullptr, setter);
+  ASSERT_NE(nullptr, integer);
+  EXPECT_NE(nullptr, dynamic_cast<ProfiledDummyInt*>(integer));
+  EXPECT_EQ(integer, plugin->QueryInterface<test::util::DummyIntBase>());
+
+  // The proxies pass the calls on to the same instance
+  setter->SetIntegerValue(42);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(42, integer->MyIntegerValueIs());
+
+  // Copies of the plugin share its proxies, and the counters of other
+  // threads are collected too
+  PluginPtr copy = plugin;
+  std::thread other([&copy]()
+  {
+    auto *otherInteger = copy->QueryInterface<test::util::DummyIntBase>();
+    for (int i = 0; i < 5; ++i)
+      EXPECT_EQ(42, otherInteger->MyIntegerValueIs());
+  });
+  other.join();
+
+  std::vector<MethodProfile> profile = ignition::plugin::CallProfile();
+  ASSERT_EQ(2u, profile.size());
+
+  const MethodProfile *get = FindMethod(profile, "MyIntegerValueIs");
+  ASSERT_NE(nullptr, get);
+  EXPECT_EQ("test::util::DummyMultiPlugin", get->plugin);
+  EXPECT_EQ("test::util::DummyIntBase", get->interface);
+  EXPECT_EQ(15u, get->calls);
+  EXPECT_LE(get->maxNanoseconds, get->totalNanoseconds);
+  EXPECT_EQ(15u, std::accumulate(get->histogram.begin(),
+                                 get->histogram.end(), std::uint64_t(0)));
+
+  const MethodProfile *set = FindMethod(profile, "SetIntegerValue");
+  ASSERT_NE(nullptr, set);
+  EXPECT_EQ("test::util::DummySetterBase", set->interface);
+  EXPECT_EQ(1u, set->calls);
+  EXPECT_EQ(nullptr, FindMethod(profile, "SetName"));
+
+  // Stopping the profiling keeps the proxies but stops the counting
+  ignition::plugin::SetCallProfiling(false);
+  EXPECT_EQ(42, integer->MyIntegerValueIs());
+  profile = ignition::plugin::CallProfile();
+  ASSERT_NE(nullptr, FindMethod(profile, "MyIntegerValueIs"));
+  EXPECT_EQ(15u, FindMethod(profile, "MyIntegerValueIs")->calls);
+
+  ignition::plugin::ResetCallProfile();
+  EXPECT_TRUE(ignition::plugin::CallProfile().empty());
+
+  ignition::plugin::SetCallProfiling(true);
+  setter->SetName("profiled");
+  profile = ignition::plugin::CallProfile();
+  ASSERT_EQ(1u, profile.size());
+  EXPECT_EQ("SetName", profile[0].method);
+  EXPECT_EQ(1u, profile[0].calls);
+  ignition::plugin::SetCallProfiling(false);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/ConstructiblePlugins.hh"
+
+using ignition::plugin::Loader;
+using ignition::plugin::PluginPtr;
+using test::plugins::Configured;
+
+/////////////////////////////////////////////////
+TEST(ConstructorArgs, ForwardedToConstructor)
+{
+  Loader pl;
+  pl.LoadLib(IGNConstructiblePlugins_LIB);
+
+  // The default constructor is still used by Instantiate()
+  PluginPtr plugin = pl.Instantiate("Camera");
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ("default", plugin->QueryInterface<Configured>()->Label());
+
+  // References are passed on as they are
+  const std::string label = "front";
+  plugin = pl.InstantiateWith<int, const std::string&>("Camera", 3, label);
+  ASSERT_TRUE(plugin);
+  Configured *configured = plugin->QueryInterface<Configured>();
+  ASSERT_NE(nullptr, configured);
+  EXPECT_EQ(3, configured->Number());
+  EXPECT_EQ("front", configured->Label());
+  EXPECT_EQ(&label, configured->LabelAddress());
+  EXPECT_EQ("test::plugins::Camera", *plugin->Name());
+
+  // Arguments which are taken by value are moved, so move-only types work
+  plugin = pl.InstantiateWith("Camera", std::make_unique<int>(7));
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ(7, plugin->QueryInterface<Configured>()->Number());
+  EXPECT_EQ("owned", plugin->QueryInterface<Configured>()->Label());
+
+  plugin = pl.InstantiateWith(
+        "test::plugins::Camera", std::string("rear"), 5);
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ(5, plugin->QueryInterface<Configured>()->Number());
+  EXPECT_EQ("rear", plugin->QueryInterface<Configured>()->Label());
+}
+
+/////////////////////////////////////////////////
+TEST(ConstructorArgs, UnknownSignature)
+{
+  Loader pl;
+  pl.LoadLib(IGNConstructiblePlugins_LIB);
+
+  // The deduced signature is (int, std::string), which is not registered
+  EXPECT_FALSE(pl.InstantiateWith("Camera", 3, std::string("front")));
+  EXPECT_FALSE(pl.InstantiateWith("Camera", 1.5));
+  EXPECT_FALSE(pl.InstantiateWith("not a plugin", 3));
+
+  // A failed lookup does not affect the plugin
+  const PluginPtr plugin =
+      pl.InstantiateWith<std::string, int>("Camera", "side", 1);
+  EXPECT_TRUE(plugin);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ignition/plugin/CpuFeatures.hh>
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/CpuVariantPlugins.hh"
+
+using ignition::plugin::CpuSupports;
+using ignition::plugin::Loader;
+
+/////////////////////////////////////////////////
+/// \brief The variant of the kernel that should be chosen for this CPU
+std::string ExpectedVariant()
+{
+  if (CpuSupports("sse2"))
+    return "sse2";
+
+  if (CpuSupports("neon"))
+    return "neon";
+
+  return "generic";
+}
+
+/////////////////////////////////////////////////
+TEST(CpuFeatures, RequiredFeatures)
+{
+  Loader pl;
+  pl.LoadLib(IGNCpuVariantPlugins_LIB);
+
+  const std::string future = pl.LookupPlugin("FutureKernel");
+  ASSERT_FALSE(future.empty());
+  EXPECT_EQ((std::set<std::string>{"neon", "not-a-real-feature", "sse2"}),
+            pl.RequiredFeatures(future));
+
+  const std::string generic = pl.LookupPlugin("GenericKernel");
+  ASSERT_FALSE(generic.empty());
+  EXPECT_TRUE(pl.RequiredFeatures(generic).empty());
+  EXPECT_TRUE(pl.RequiredFeatures("not a plugin").empty());
+
+  std::stringstream json;
+  pl.WriteJson(json);
+  EXPECT_NE(std::string::npos, json.str().find(
+      "\"requiredFeatures\":[\"neon\",\"not-a-real-feature\",\"sse2\"]"));
+}
+
+/////////////////////////////////////////////////
+TEST(CpuFeatures, Fastest)
+{
+  Loader pl;
+  pl.LoadLib(IGNCpuVariantPlugins_LIB);
+
+  // The alias refers to every variant, so it is not unique
+  EXPECT_EQ(4u, pl.PluginsWithAlias("Kernel").size());
+  EXPECT_TRUE(pl.LookupPlugin("Kernel").empty());
+  EXPECT_TRUE(pl.LookupPlugin("Kernel", Loader::Preference::UNIQUE).empty());
+
+  const std::string fastest =
+      pl.LookupPlugin("Kernel", Loader::Preference::FASTEST);
+  ASSERT_FALSE(fastest.empty());
+
+  ignition::plugin::PluginPtr plugin = pl.Instantiate(fastest);
+  ASSERT_FALSE(plugin.IsEmpty());
+  test::plugins::Kernel *kernel =
+      plugin->QueryInterface<test::plugins::Kernel>();
+  ASSERT_NE(nullptr, kernel);
+  EXPECT_EQ(ExpectedVariant(), kernel->Variant());
+
+  // A name only ever refers to its own plugin
+  const std::string generic = pl.LookupPlugin("GenericKernel");
+  EXPECT_EQ(generic,
+            pl.LookupPlugin(generic, Loader::Preference::FASTEST));
+  EXPECT_TRUE(pl.LookupPlugin("not a plugin",
+                              Loader::Preference::FASTEST).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(CpuFeatures, Unsupported)
+{
+  Loader pl;
+  pl.LoadLib(IGNCpuVariantPlugins_LIB);
+
+  // The plugin can be named, but it can neither be chosen nor instantiated
+  const std::string future = pl.LookupPlugin("FutureKernel");
+  ASSERT_FALSE(future.empty());
+  EXPECT_TRUE(pl.LookupPlugin(future, Loader::Preference::FASTEST).empty());
+  EXPECT_TRUE(pl.LookupPlugin("FutureKernel",
+                              Loader::Preference::FASTEST).empty());
+  EXPECT_TRUE(pl.Instantiate(future).IsEmpty());
+  EXPECT_TRUE(pl.Instantiate("FutureKernel").IsEmpty());
+
+  // The plugins which the CPU does support can still be instantiated
+  EXPECT_FALSE(pl.Instantiate("GenericKernel").IsEmpty());
+}
+
+/////////////////////////////////////////////////
+namespace test
+{
+namespace plugins
+{
+/// \brief The plugin library exports version 1 of this table, as if the test
+/// had been built against a newer version of its layout
+struct OutdatedKernels
+{
+  static constexpr std::uint32_t kAbiVersion = 2;
+  const char *variant;
+};
+}
+}
+
+/////////////////////////////////////////////////
+TEST(CpuFeatures, KernelTables)
+{
+  using test::plugins::VectorKernels;
+
+  std::shared_ptr<const VectorKernels> kernels;
+  {
+    Loader pl;
+    pl.LoadLib(IGNCpuVariantPlugins_LIB);
+
+    kernels = pl.QueryKernelTable<VectorKernels>("GenericKernel");
+    ASSERT_NE(nullptr, kernels);
+    EXPECT_EQ(std::string("generic"), kernels->variant);
+
+    // Each plugin exports its own table
+    const std::shared_ptr<const VectorKernels> sse2 =
+        pl.QueryKernelTable<VectorKernels>("test::plugins::KernelVariant<1>");
+    ASSERT_NE(nullptr, sse2);
+    EXPECT_EQ(std::string("sse2"), sse2->variant);
+
+    // Plugins which export no table of the type, tables of another ABI
+    // version, and unknown plugins give nothing
+    EXPECT_EQ(nullptr, pl.QueryKernelTable<VectorKernels>("FutureKernel"));
+    EXPECT_EQ(nullptr, pl.QueryKernelTable<test::plugins::OutdatedKernels>(
+                "GenericKernel"));
+    EXPECT_EQ(nullptr, pl.QueryKernelTable<VectorKernels>("not a plugin"));
+    EXPECT_EQ(nullptr, pl.QueryKernelTable<VectorKernels>("Kernel"));
+  }
+
+  // The table keeps the library open after the Loader is gone
+  std::vector<float> data(1000, 2.0f);
+  kernels->scale(data.data(), 1.5f, data.size());
+  for (const float value : data)
+    EXPECT_FLOAT_EQ(3.0f, value);
+}
+
+/////////////////////////////////////////////////
+TEST(CpuFeatures, Manifest)
+{
+  const std::string path = IGNCpuVariantPlugins_LIB;
+  const std::string manifest = "ign_plugin_cpu_features.manifest";
+  std::remove(manifest.c_str());
+
+  ASSERT_TRUE(Loader::WriteManifest(manifest, {path}));
+
+  // The features are recorded in the manifest, so the fastest variant can
+  // be chosen before the library gets opened
+  Loader pl;
+  EXPECT_FALSE(pl.LoadManifest(manifest).empty());
+  EXPECT_TRUE(pl.Libraries().empty());
+
+  const std::string future = pl.LookupPlugin("FutureKernel");
+  EXPECT_EQ(3u, pl.RequiredFeatures(future).size());
+
+  const std::string fastest =
+      pl.LookupPlugin("Kernel", Loader::Preference::FASTEST);
+  EXPECT_EQ(ExpectedVariant(), pl.Instantiate(fastest)
+            ->QueryInterface<test::plugins::Kernel>()->Variant());
+
+  std::remove(manifest.c_str());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
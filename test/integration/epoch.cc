@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <ignition/plugin/Epoch.hh>
+#include <ignition/plugin/Factory.hh>
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/DummyPlugins.hh"
+#include "../plugins/FactoryPlugins.hh"
+#include "utils.hh"
+
+/////////////////////////////////////////////////
+TEST(Epoch, UnloadWaitsForGuards)
+{
+  const std::string &libraryPath = IGNDummyPlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  {
+    ignition::plugin::EpochGuard guard;
+
+    {
+      ignition::plugin::Loader pl;
+      pl.LoadLib(libraryPath);
+
+      ignition::plugin::PluginPtr plugin =
+          pl.Instantiate("test::util::DummyMultiPlugin");
+      ASSERT_TRUE(plugin);
+      EXPECT_EQ(5, plugin->QueryInterface<test::util::DummyIntBase>()
+                ->MyIntegerValueIs());
+    }
+
+    // Every reference to the library is gone, but this thread might still
+    // be running its code
+    CHECK_FOR_LIBRARY(libraryPath, true);
+    EXPECT_EQ(1u, ignition::plugin::RetiredCount());
+  }
+
+  EXPECT_EQ(0u, ignition::plugin::RetiredCount());
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+TEST(Epoch, LostProductsWaitForGuards)
+{
+  const std::string &libraryPath = IGNFactoryPlugins_LIB;
+
+  ignition::plugin::CleanupLostProducts();
+  ASSERT_EQ(0u, ignition::plugin::LostProductCount());
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool deleted = false;
+  bool leave = false;
+
+  std::thread deleter;
+  {
+    ignition::plugin::Loader pl;
+    pl.LoadLib(libraryPath);
+
+    auto factory = pl.Factory<test::util::SomeObjectFactory>(
+          "test::util::SomeObjectAddTwo");
+    ASSERT_NE(nullptr, factory);
+
+    test::util::SomeObject *product = factory->Construct(1, 2.0).release();
+
+    // This thread deletes the product inside a guard, and stays there as if
+    // it were still on its way out of the destructor of the product
+    deleter = std::thread([&]()
+    {
+      ignition::plugin::EpochGuard guard;
+      delete product;
+
+      std::unique_lock<std::mutex> lock(mutex);
+      deleted = true;
+      condition.notify_all();
+      condition.wait(lock, [&]() { return leave; });
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]() { return deleted; });
+  }
+
+  EXPECT_EQ(1u, ignition::plugin::LostProductCount());
+
+  ignition::plugin::CleanupLostProducts();
+  EXPECT_EQ(0u, ignition::plugin::LostProductCount());
+  CHECK_FOR_LIBRARY(libraryPath, true);
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    leave = true;
+  }
+  condition.notify_all();
+  deleter.join();
+
+  EXPECT_EQ(0u, ignition::plugin::RetiredCount());
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
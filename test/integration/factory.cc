@@ -17,8 +17,17 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
 #include <ignition/plugin/Factory.hh>
 #include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/Trace.hh>
 
 #include "../plugins/FactoryPlugins.hh"
 #include "utils.hh"
@@ -134,6 +143,126 @@ TEST(Factory, Alias)
   }
 }
 
+/////////////////////////////////////////////////
+TEST(Factory, CachedInstances)
+{
+  const std::string &libraryPath = IGNFactoryPlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  ignition::plugin::Loader pl;
+  pl.LoadLib(libraryPath);
+  EXPECT_FALSE(pl.FactoryCaching());
+
+  // Without caching, every call makes a new instance
+  EXPECT_NE(pl.Factory<SomeObjectFactory>("test::util::SomeObjectAddTwo"),
+            pl.Factory<SomeObjectFactory>("test::util::SomeObjectAddTwo"));
+
+  pl.SetFactoryCaching(true);
+  EXPECT_TRUE(pl.FactoryCaching());
+
+  // The names and the aliases of a plugin share one instance
+  std::shared_ptr<SomeObjectFactory> factory =
+      pl.Factory<SomeObjectFactory>("test::util::SomeObjectAddTwo");
+  ASSERT_NE(nullptr, factory);
+  EXPECT_EQ(factory,
+            pl.Factory<SomeObjectFactory>("test::util::SomeObjectAddTwo"));
+  EXPECT_EQ(factory,
+            pl.Factory<SomeObjectFactory>("This factory has an alias"));
+
+  auto object = pl.Factory<SomeObjectFactory>("and also a second alias")
+      ->Construct(110, 2.25);
+  ASSERT_NE(nullptr, object);
+  EXPECT_EQ(112, object->someInt);
+
+  EXPECT_EQ(nullptr, pl.Factory<SomeObjectFactory>("not a real factory"));
+
+  // Forgetting the plugin drops its cached instance, so the cache does not
+  // keep the library loaded
+  object.reset();
+  factory.reset();
+  pl.ForgetLibrary(libraryPath);
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  // Once the library is loaded again, the cache fills up again
+  pl.LoadLib(libraryPath);
+  factory = pl.Factory<SomeObjectFactory>("test::util::SomeObjectAddTwo");
+  ASSERT_NE(nullptr, factory);
+  EXPECT_EQ(factory,
+            pl.Factory<SomeObjectFactory>("This factory has an alias"));
+  factory.reset();
+
+  // Turning the cache off drops the cached instances
+  pl.SetFactoryCaching(false);
+  EXPECT_FALSE(pl.FactoryCaching());
+  pl.ForgetLibrary(libraryPath);
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, AllocationAccounting)
+{
+  const std::string &libraryPath = IGNFactoryPlugins_LIB;
+
+  ignition::plugin::Loader pl;
+  pl.LoadLib(libraryPath);
+  EXPECT_FALSE(pl.AllocationAccounting());
+
+  const auto statistics = [&pl]()
+  {
+    const std::vector<ignition::plugin::LibraryStatistics> libraries =
+        pl.Libraries();
+    EXPECT_EQ(1u, libraries.size());
+    return libraries.empty() ?
+          ignition::plugin::LibraryStatistics() : libraries.front();
+  };
+
+  // Nothing is attributed to the library until accounting is turned on
+  const ignition::plugin::LibraryStatistics before = statistics();
+  pl.Factory<SomeObjectFactory>("test::util::SomeObjectAddTwo")
+      ->Construct(1, 2.0);
+  EXPECT_EQ(before.allocations, statistics().allocations);
+  EXPECT_EQ(before.liveBytes, statistics().liveBytes);
+
+  // The factory and its products are attributed to the library
+  pl.SetAllocationAccounting(true);
+  EXPECT_TRUE(pl.AllocationAccounting());
+  {
+    std::shared_ptr<SomeObjectFactory> factory =
+        pl.Factory<SomeObjectFactory>("test::util::SomeObjectAddTwo");
+    ASSERT_NE(nullptr, factory);
+
+    const ignition::plugin::LibraryStatistics instantiated = statistics();
+    EXPECT_LT(before.allocations, instantiated.allocations);
+    EXPECT_LT(before.liveBytes, instantiated.liveBytes);
+
+    std::vector<SomeObjectFactory::ProductPtrType> products;
+    for (int i = 0; i < 10; ++i)
+      products.push_back(factory->Construct(7, 6.5));
+    EXPECT_EQ(9, products.back()->someInt);
+
+    const ignition::plugin::LibraryStatistics constructed = statistics();
+    EXPECT_EQ(instantiated.allocations + 10, constructed.allocations);
+    EXPECT_LT(instantiated.liveBytes, constructed.liveBytes);
+    EXPECT_LT(instantiated.allocatedBytes, constructed.allocatedBytes);
+
+    // Products whose memory resource is chosen by the caller are not
+    // attributed to the library
+    std::pmr::monotonic_buffer_resource arena;
+    factory->Construct(&arena, 7, 6.5);
+    EXPECT_EQ(constructed.allocations, statistics().allocations);
+  }
+
+  // Freeing the memory takes it off the live bytes, but the totals stay
+  const ignition::plugin::LibraryStatistics freed = statistics();
+  EXPECT_EQ(before.liveBytes, freed.liveBytes);
+  EXPECT_LT(before.allocatedBytes, freed.allocatedBytes);
+
+  pl.SetAllocationAccounting(false);
+  pl.Factory<SomeObjectFactory>("test::util::SomeObjectAddTwo")
+      ->Construct(1, 2.0);
+  EXPECT_EQ(freed.allocations, statistics().allocations);
+}
+
 /////////////////////////////////////////////////
 TEST(Factory, LibraryManagement)
 {
@@ -243,6 +372,490 @@ TEST(Factory, LibraryManagement)
   CHECK_FOR_LIBRARY(libraryPath, false);
 }
 
+/////////////////////////////////////////////////
+TEST(Factory, ResetProductPtr)
+{
+  ignition::plugin::CleanupLostProducts();
+
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNFactoryPlugins_LIB);
+
+  auto factory = pl.Factory<SomeObjectFactory>(
+        "test::util::SomeObjectAddTwo");
+  ASSERT_NE(nullptr, factory);
+
+  SomeObjectFactory::ProductPtrType obj = factory->Construct(1, 2.0);
+  ASSERT_NE(nullptr, obj);
+
+  // The deleter of obj was generated for its original product. Resetting it
+  // to a different product must still delete both of them correctly.
+  obj.reset(factory->Construct(3, 4.0).release());
+  ASSERT_NE(nullptr, obj);
+  EXPECT_EQ(5, obj->someInt);
+
+  obj.reset();
+  EXPECT_EQ(0u, ignition::plugin::LostProductCount());
+
+  // Once obj has deleted the product that its deleter was generated for, a
+  // product of another factory may be placed at the same address. It must not
+  // be mistaken for the original product.
+  auto other = pl.Factory<SomeObjectFactory>("test::util::SomeObjectForward");
+  ASSERT_NE(nullptr, other);
+
+  obj = factory->Construct(1, 2.0);
+  obj.reset();
+
+  obj.reset(other->Construct(5, 6.0).release());
+  EXPECT_EQ(5, obj->someInt);
+
+  obj.reset();
+  EXPECT_EQ(1u, other->Statistics().destroyed);
+  EXPECT_EQ(0u, other->Statistics().live);
+  EXPECT_EQ(0u, ignition::plugin::LostProductCount());
+
+  // The same goes for a product that was released from obj and then deleted
+  // somewhere else.
+  obj = factory->Construct(1, 2.0);
+  ignition::plugin::ProductDeleter<SomeObject>()(obj.release());
+
+  obj.reset(other->Construct(5, 6.0).release());
+  EXPECT_EQ(5, obj->someInt);
+
+  obj.reset();
+  EXPECT_EQ(2u, other->Statistics().destroyed);
+  EXPECT_EQ(0u, other->Statistics().live);
+  EXPECT_EQ(0u, ignition::plugin::LostProductCount());
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, ConstructFromMemoryResource)
+{
+  ignition::plugin::CleanupLostProducts();
+
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNFactoryPlugins_LIB);
+
+  auto factory = pl.Factory<SomeObjectFactory>(
+        "test::util::SomeObjectAddTwo");
+  ASSERT_NE(nullptr, factory);
+
+  CountingResource resource;
+  {
+    SomeObjectFactory::ProductPtrType obj =
+        factory->Construct(&resource, 1, 2.0);
+    ASSERT_NE(nullptr, obj);
+    EXPECT_EQ(3, obj->someInt);
+    EXPECT_DOUBLE_EQ(4.0, obj->someDouble);
+    EXPECT_NE(0u, resource.outstanding);
+  }
+
+  // The storage goes back to the resource when the product is deleted
+  EXPECT_NE(0u, resource.allocated);
+  EXPECT_EQ(0u, resource.outstanding);
+
+  // ... even when the product is not deleted by a ProductDeleter
+  delete factory->Construct(&resource, 1, 2.0).release();
+  EXPECT_EQ(0u, resource.outstanding);
+  ignition::plugin::CleanupLostProducts();
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, ConstructShared)
+{
+  ignition::plugin::CleanupLostProducts();
+  const std::string libraryPath = IGNFactoryPlugins_LIB;
+
+  CountingResource resource;
+  std::shared_ptr<SomeObject> obj;
+  std::shared_ptr<SomeObject> pooled;
+  {
+    ignition::plugin::Loader pl;
+    pl.LoadLib(libraryPath);
+
+    auto factory = pl.Factory<SomeObjectFactory>(
+          "test::util::SomeObjectAddTwo");
+    ASSERT_NE(nullptr, factory);
+
+    obj = factory->ConstructShared(1, 2.0);
+    ASSERT_NE(nullptr, obj);
+    EXPECT_EQ(3, obj->someInt);
+    EXPECT_DOUBLE_EQ(4.0, obj->someDouble);
+
+    // The product and its control block come from one allocation
+    std::shared_ptr<SomeObject> counted =
+        factory->ConstructShared(&resource, 3, 4.0);
+    ASSERT_NE(nullptr, counted);
+    EXPECT_EQ(5, counted->someInt);
+    EXPECT_EQ(1u, resource.count);
+    EXPECT_LE(factory->ProductSize(), resource.outstanding);
+
+    // Products which outlive the product pool of their factory keep it alive
+    factory->UseProductPool();
+    pooled = factory->ConstructShared(5, 6.0);
+    ASSERT_NE(nullptr, pooled);
+    EXPECT_EQ(7, pooled->someInt);
+
+    EXPECT_EQ(3u, factory->Statistics().live);
+  }
+
+  EXPECT_EQ(0u, resource.outstanding);
+
+  // The products keep the library loaded, and they are never lost
+  obj.reset();
+  CHECK_FOR_LIBRARY(libraryPath, true);
+
+  pooled.reset();
+  EXPECT_EQ(0u, ignition::plugin::LostProductCount());
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, ConstructMany)
+{
+  const std::string libraryPath = IGNFactoryPlugins_LIB;
+
+  std::vector<SomeObjectFactory::ProductPtrType> products;
+  {
+    ignition::plugin::Loader pl;
+    pl.LoadLib(libraryPath);
+
+    auto factory = pl.Factory<SomeObjectFactory>(
+          "test::util::SomeObjectAddTwo");
+    ASSERT_NE(nullptr, factory);
+
+    EXPECT_TRUE(factory->ConstructMany(0, 1, 2.0).empty());
+
+    products = factory->ConstructMany(10, 1, 2.0);
+  }
+
+  ASSERT_EQ(10u, products.size());
+  for (const auto &product : products)
+  {
+    ASSERT_NE(nullptr, product);
+    EXPECT_EQ(3, product->someInt);
+    EXPECT_DOUBLE_EQ(4.0, product->someDouble);
+  }
+
+  // The products share one block of storage, so they are laid out in order
+  for (std::size_t i = 1; i < products.size(); ++i)
+  {
+    EXPECT_LT(reinterpret_cast<std::uintptr_t>(products[i-1].get()),
+              reinterpret_cast<std::uintptr_t>(products[i].get()));
+  }
+
+  // The library stays loaded until the last product of the block is gone
+  products.erase(products.begin(), products.begin() + 9);
+  CHECK_FOR_LIBRARY(libraryPath, true);
+
+  products.clear();
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, ConstructAt)
+{
+  ignition::plugin::CleanupLostProducts();
+
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNFactoryPlugins_LIB);
+
+  auto factory = pl.Factory<SomeObjectFactory>(
+        "test::util::SomeObjectAddTwo");
+  ASSERT_NE(nullptr, factory);
+
+  const std::size_t size = factory->ProductSize();
+  const std::size_t alignment = factory->ProductAlignment();
+  ASSERT_LE(sizeof(SomeObject), size);
+  ASSERT_NE(0u, alignment);
+
+  // Lay out an array of products in our own buffer
+  const std::size_t count = 4;
+  const std::size_t stride = (size + alignment - 1) / alignment * alignment;
+  void *const buffer =
+      ::operator new(stride * count, std::align_val_t(alignment));
+
+  std::vector<SomeObject*> products;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    void *const storage = static_cast<unsigned char*>(buffer) + i * stride;
+    SomeObject *const product =
+        factory->ConstructAt(storage, static_cast<int>(i), 2.0);
+    ASSERT_NE(nullptr, product);
+    products.push_back(product);
+  }
+
+  for (std::size_t i = 0; i < count; ++i)
+    EXPECT_EQ(static_cast<int>(i) + 2, products[i]->someInt);
+
+  for (SomeObject *product : products)
+    SomeObjectFactory::DestroyAt(product);
+
+  // In-place products are not tracked, so nothing is ever lost
+  EXPECT_EQ(0u, ignition::plugin::LostProductCount());
+
+  // Storage which is not aligned is refused
+  if (alignment > 1)
+  {
+    EXPECT_EQ(nullptr, factory->ConstructAt(
+                static_cast<unsigned char*>(buffer) + 1, 0, 0.0));
+  }
+  EXPECT_EQ(nullptr, factory->ConstructAt(nullptr, 0, 0.0));
+
+  ::operator delete(buffer, std::align_val_t(alignment));
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, ProductPool)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNFactoryPlugins_LIB);
+
+  auto factory = pl.Factory<SomeObjectFactory>(
+        "test::util::SomeObjectAddTwo");
+  ASSERT_NE(nullptr, factory);
+
+  EXPECT_FALSE(factory->UsesProductPool());
+  factory->UseProductPool();
+  EXPECT_TRUE(factory->UsesProductPool());
+
+  for (std::size_t i = 0; i < 100; ++i)
+  {
+    SomeObjectFactory::ProductPtrType obj = factory->Construct(1, 2.0);
+    ASSERT_NE(nullptr, obj);
+    EXPECT_EQ(3, obj->someInt);
+  }
+
+  SomeObjectFactory::ProductPtrType obj = factory->Construct(1, 2.0);
+  ASSERT_NE(nullptr, obj);
+
+  // Products from the pool stay valid after the pool is switched off
+  factory->UseProductPool(false);
+  EXPECT_FALSE(factory->UsesProductPool());
+  SomeObjectFactory::ProductPtrType other = factory->Construct(3, 4.0);
+  EXPECT_EQ(3, obj->someInt);
+  EXPECT_EQ(5, other->someInt);
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, ShareProductReferences)
+{
+  const std::string libraryPath = IGNFactoryPlugins_LIB;
+  const std::size_t numThreads = 4;
+  const std::size_t productsPerThread = 50;
+
+  std::vector<SomeObjectFactory::ProductPtrType> products(
+        numThreads * productsPerThread);
+  {
+    ignition::plugin::Loader pl;
+    pl.LoadLib(libraryPath);
+
+    auto factory = pl.Factory<SomeObjectFactory>(
+          "test::util::SomeObjectAddTwo");
+    ASSERT_NE(nullptr, factory);
+
+    EXPECT_FALSE(factory->SharesProductReferences());
+    factory->ShareProductReferences();
+    EXPECT_TRUE(factory->SharesProductReferences());
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < numThreads; ++t)
+    {
+      threads.emplace_back([&, t]()
+      {
+        for (std::size_t i = 0; i < productsPerThread; ++i)
+          products[t * productsPerThread + i] = factory->Construct(1, 2.0);
+      });
+    }
+
+    for (std::thread &thread : threads)
+      thread.join();
+  }
+
+  for (const auto &product : products)
+  {
+    ASSERT_NE(nullptr, product);
+    EXPECT_EQ(3, product->someInt);
+  }
+
+  // The shared references keep the library loaded until every product that
+  // uses them is gone
+  products.resize(1);
+  CHECK_FOR_LIBRARY(libraryPath, true);
+
+  products.clear();
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, Statistics)
+{
+  ignition::plugin::CleanupLostProducts();
+
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNFactoryPlugins_LIB);
+
+  auto factory = pl.Factory<SomeObjectFactory>(
+        "test::util::SomeObjectAddTwo");
+  ASSERT_NE(nullptr, factory);
+
+  {
+    SomeObjectFactory::ProductPtrType kept = factory->Construct(1, 2.0);
+    auto batch = factory->ConstructMany(3, 1, 2.0);
+
+    // Deleting a released product without a ProductDeleter loses it
+    delete factory->Construct(1, 2.0).release();
+
+    const ignition::plugin::FactoryStatistics statistics =
+        factory->Statistics();
+    EXPECT_EQ(5u, statistics.constructed);
+    EXPECT_EQ(1u, statistics.destroyed);
+    EXPECT_EQ(4u, statistics.live);
+    EXPECT_EQ(1u, statistics.lost);
+  }
+
+  const ignition::plugin::FactoryStatistics statistics = factory->Statistics();
+  EXPECT_EQ(5u, statistics.constructed);
+  EXPECT_EQ(5u, statistics.destroyed);
+  EXPECT_EQ(0u, statistics.live);
+  EXPECT_EQ(1u, statistics.lost);
+
+  ignition::plugin::CleanupLostProducts();
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, ConstructLatency)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNFactoryPlugins_LIB);
+
+  auto factory = pl.Factory<SomeObjectFactory>(
+        "test::util::SomeObjectAddTwo");
+  ASSERT_NE(nullptr, factory);
+
+  std::size_t slow = 0;
+  ignition::plugin::LatencyMonitor monitor(
+        [&](const ignition::plugin::TraceEvent &_event)
+        {
+          EXPECT_EQ(typeid(*factory).name(), _event.detail);
+          ++slow;
+        });
+  monitor.SetThreshold("Construct", std::chrono::nanoseconds(1));
+
+  // Each product is measured, whether it is shared or not
+  ignition::plugin::SetTraceObserver(&monitor);
+  factory->Construct(1, 2.0);
+  factory->ConstructShared(1, 2.0);
+  ignition::plugin::SetTraceObserver(nullptr);
+
+  EXPECT_EQ(2u, monitor.Summary("Construct").count);
+  EXPECT_EQ(2u, slow);
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, LoseProductsConcurrently)
+{
+  const std::size_t numThreads = 8;
+  const std::size_t productsPerThread = 100;
+
+  ignition::plugin::CleanupLostProducts();
+  ASSERT_EQ(0u, ignition::plugin::LostProductCount());
+
+  {
+    ignition::plugin::Loader pl;
+    pl.LoadLib(IGNFactoryPlugins_LIB);
+
+    auto factory = pl.Factory<SomeObjectFactory>(
+          "test::util::SomeObjectAddTwo");
+    ASSERT_NE(nullptr, factory);
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < numThreads; ++t)
+    {
+      threads.emplace_back([&]()
+      {
+        for (std::size_t i = 0; i < productsPerThread; ++i)
+        {
+          // Deleting a released product without a ProductDeleter hands its
+          // factory reference off to the lost product manager.
+          delete factory->Construct(1, 2.0).release();
+        }
+      });
+    }
+
+    for (std::thread &thread : threads)
+      thread.join();
+  }
+
+  EXPECT_EQ(numThreads * productsPerThread,
+            ignition::plugin::LostProductCount());
+
+  ignition::plugin::CleanupLostProducts();
+  EXPECT_EQ(0u, ignition::plugin::LostProductCount());
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, LostProductReaper)
+{
+  ignition::plugin::CleanupLostProducts();
+  ASSERT_EQ(0u, ignition::plugin::LostProductCount());
+
+  ignition::plugin::StartLostProductReaper(std::chrono::milliseconds(1));
+
+  {
+    ignition::plugin::Loader pl;
+    pl.LoadLib(IGNFactoryPlugins_LIB);
+
+    auto factory = pl.Factory<SomeObjectFactory>(
+          "test::util::SomeObjectAddTwo");
+    ASSERT_NE(nullptr, factory);
+
+    delete factory->Construct(1, 2.0).release();
+  }
+
+  // The reaper should clean up the lost product without our help
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (ignition::plugin::LostProductCount() > 0
+         && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  EXPECT_EQ(0u, ignition::plugin::LostProductCount());
+
+  ignition::plugin::StopLostProductReaper();
+
+  // Stopping a reaper which is not running does nothing
+  ignition::plugin::StopLostProductReaper();
+}
+
+/////////////////////////////////////////////////
+TEST(Factory, RestartLostProductReaperConcurrently)
+{
+  // Each start replaces the reaper of another, without any of them being
+  // overwritten while it is still running
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < 8; ++i)
+  {
+    threads.emplace_back([i]()
+    {
+      for (std::size_t j = 0; j < 20; ++j)
+      {
+        if ((i + j) % 3 == 0)
+          ignition::plugin::StopLostProductReaper();
+        else
+          ignition::plugin::StartLostProductReaper(
+                std::chrono::milliseconds(1));
+      }
+    });
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  ignition::plugin::StopLostProductReaper();
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <vector>
+
+#include <ignition/plugin/EnablePluginFromThis.hh>
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/SpecializedPluginPtr.hh>
+
+#include "../plugins/RecyclablePlugins.hh"
+
+using ignition::plugin::Loader;
+using ignition::plugin::PluginPtr;
+using test::plugins::Scratchpad;
+
+const char *const recyclable = "test::plugins::RecyclableScratchpad";
+const char *const disposable = "test::plugins::DisposableScratchpad";
+
+/////////////////////////////////////////////////
+TEST(InstancePool, Recycle)
+{
+  Loader pl;
+  pl.LoadLib(IGNRecyclablePlugins_LIB);
+  ASSERT_TRUE(pl.SetInstancePool(recyclable, 2));
+  EXPECT_EQ(0u, pl.PooledInstances(recyclable));
+
+  std::size_t serial = 0;
+  {
+    PluginPtr plugin = pl.Instantiate(recyclable);
+    ASSERT_TRUE(plugin);
+    Scratchpad *scratchpad = plugin->QueryInterface<Scratchpad>();
+    ASSERT_NE(nullptr, scratchpad);
+    serial = scratchpad->Serial();
+    scratchpad->Write(42);
+    EXPECT_EQ(0u, scratchpad->Resets());
+
+    // Copies of the PluginPtr keep the instance out of the pool
+    PluginPtr copy = plugin;
+    plugin = PluginPtr();
+    EXPECT_EQ(0u, pl.PooledInstances(recyclable));
+  }
+
+  EXPECT_EQ(1u, pl.PooledInstances(recyclable));
+
+  // The same instance is handed out again, after being reset
+  PluginPtr plugin = pl.Instantiate(recyclable);
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ(0u, pl.PooledInstances(recyclable));
+  Scratchpad *scratchpad = plugin->QueryInterface<Scratchpad>();
+  ASSERT_NE(nullptr, scratchpad);
+  EXPECT_EQ(serial, scratchpad->Serial());
+  EXPECT_EQ(1u, scratchpad->Resets());
+  EXPECT_EQ(0, scratchpad->Read());
+
+  // EnablePluginFromThis refers to the PluginPtr of the current checkout
+  auto *fromThis =
+      plugin->QueryInterface<ignition::plugin::EnablePluginFromThis>();
+  ASSERT_NE(nullptr, fromThis);
+  EXPECT_EQ(plugin, fromThis->PluginFromThis());
+
+  // Specialized PluginPtrs can be pooled as well
+  plugin = PluginPtr();
+  using ScratchpadPtr = ignition::plugin::SpecializedPluginPtr<Scratchpad>;
+  ScratchpadPtr specialized = pl.Instantiate<ScratchpadPtr>(recyclable);
+  ASSERT_TRUE(specialized);
+  EXPECT_EQ(serial, specialized->QueryInterface<Scratchpad>()->Serial());
+}
+
+/////////////////////////////////////////////////
+TEST(InstancePool, Capacity)
+{
+  Loader pl;
+  pl.LoadLib(IGNRecyclablePlugins_LIB);
+  ASSERT_TRUE(pl.SetInstancePool(recyclable, 2));
+
+  std::vector<PluginPtr> plugins;
+  ASSERT_EQ(3u, pl.Instantiate(recyclable, 3, plugins));
+  plugins.clear();
+
+  // Only as many instances as the capacity allows are kept
+  EXPECT_EQ(2u, pl.PooledInstances(recyclable));
+
+  ASSERT_TRUE(pl.SetInstancePool(recyclable, 1));
+  EXPECT_EQ(1u, pl.PooledInstances(recyclable));
+
+  // Removing the pool deletes the instances, and the plugin is instantiated
+  // normally again
+  ASSERT_TRUE(pl.SetInstancePool(recyclable, 0));
+  EXPECT_EQ(0u, pl.PooledInstances(recyclable));
+  {
+    PluginPtr plugin = pl.Instantiate(recyclable);
+    ASSERT_TRUE(plugin);
+  }
+  EXPECT_EQ(0u, pl.PooledInstances(recyclable));
+}
+
+/////////////////////////////////////////////////
+TEST(InstancePool, Unpoolable)
+{
+  Loader pl;
+  pl.LoadLib(IGNRecyclablePlugins_LIB);
+
+  // Only plugins which provide Recyclable can be pooled
+  EXPECT_FALSE(pl.SetInstancePool(disposable, 2));
+  EXPECT_FALSE(pl.SetInstancePool("not a plugin", 2));
+
+  std::size_t serial = 0;
+  {
+    PluginPtr plugin = pl.Instantiate(disposable);
+    ASSERT_TRUE(plugin);
+    serial = plugin->QueryInterface<Scratchpad>()->Serial();
+  }
+
+  PluginPtr plugin = pl.Instantiate(disposable);
+  ASSERT_TRUE(plugin);
+  EXPECT_NE(serial, plugin->QueryInterface<Scratchpad>()->Serial());
+  EXPECT_EQ(0u, pl.PooledInstances(disposable));
+}
+
+/////////////////////////////////////////////////
+TEST(InstancePool, Lifetime)
+{
+  PluginPtr plugin;
+  {
+    Loader pl;
+    pl.LoadLib(IGNRecyclablePlugins_LIB);
+    ASSERT_TRUE(pl.SetInstancePool(recyclable, 2));
+    plugin = pl.Instantiate(recyclable);
+    ASSERT_TRUE(plugin);
+
+    {
+      PluginPtr other = pl.Instantiate(recyclable);
+    }
+    EXPECT_EQ(1u, pl.PooledInstances(recyclable));
+
+    // Forgetting the plugin drops its pool
+    EXPECT_TRUE(pl.ForgetLibrary(IGNRecyclablePlugins_LIB));
+    EXPECT_EQ(0u, pl.PooledInstances(recyclable));
+  }
+
+  // An instance which outlives its Loader is simply deleted
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ(0, plugin->QueryInterface<Scratchpad>()->Read());
+  plugin = PluginPtr();
+}
+
+/////////////////////////////////////////////////
+TEST(InstancePool, PluginHandle)
+{
+  ignition::plugin::PluginHandle handle;
+  {
+    Loader pl;
+    pl.LoadLib(IGNRecyclablePlugins_LIB);
+    ASSERT_TRUE(pl.SetInstancePool(recyclable, 2));
+    pl.SetAllocationAccounting(true);
+
+    handle = pl.Resolve(recyclable);
+    ASSERT_TRUE(handle);
+
+    // Instances made through a handle go back to the pool of their plugin
+    std::size_t serial = 0;
+    {
+      PluginPtr plugin = handle.Instantiate();
+      ASSERT_TRUE(plugin);
+      serial = plugin->QueryInterface<Scratchpad>()->Serial();
+    }
+    EXPECT_EQ(1u, pl.PooledInstances(recyclable));
+
+    PluginPtr plugin = handle.Instantiate();
+    ASSERT_TRUE(plugin);
+    EXPECT_EQ(0u, pl.PooledInstances(recyclable));
+    EXPECT_EQ(serial, plugin->QueryInterface<Scratchpad>()->Serial());
+    EXPECT_EQ(1u, plugin->QueryInterface<Scratchpad>()->Resets());
+
+    // Unpooled instances made through a handle are accounted to their
+    // library
+    const ignition::plugin::PluginHandle disposableHandle =
+        pl.Resolve(disposable);
+    ASSERT_TRUE(disposableHandle);
+
+    const std::vector<ignition::plugin::LibraryStatistics> before =
+        pl.Libraries();
+    ASSERT_EQ(1u, before.size());
+
+    PluginPtr other = disposableHandle.Instantiate();
+    ASSERT_TRUE(other);
+
+    const std::vector<ignition::plugin::LibraryStatistics> after =
+        pl.Libraries();
+    ASSERT_EQ(1u, after.size());
+    EXPECT_LT(before.front().allocations, after.front().allocations);
+    EXPECT_LT(before.front().liveBytes, after.front().liveBytes);
+  }
+
+  // Once the Loader is gone, the handle constructs its instances directly
+  PluginPtr plugin = handle.Instantiate();
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ(0u, plugin->QueryInterface<Scratchpad>()->Resets());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
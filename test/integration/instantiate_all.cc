@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/DependentPlugins.hh"
+
+using ignition::plugin::Loader;
+using ignition::plugin::PluginPtr;
+using test::plugins::Stage;
+
+/////////////////////////////////////////////////
+std::size_t Sequence(const PluginPtr &_plugin)
+{
+  return _plugin->QueryInterface<Stage>()->Sequence();
+}
+
+/////////////////////////////////////////////////
+TEST(InstantiateAll, Dependencies)
+{
+  Loader pl;
+  pl.LoadLib(IGNDependentPlugins_LIB);
+
+  EXPECT_EQ((std::set<std::string>{"Left", "test::plugins::Right"}),
+            pl.Dependencies("test::plugins::Top"));
+  EXPECT_TRUE(pl.Dependencies("test::plugins::Base").empty());
+
+  // The plugins are listed against the order of their dependencies
+  const std::vector<PluginPtr> plugins = pl.InstantiateAll(
+      {"test::plugins::Top", "Left", "test::plugins::Right",
+       "test::plugins::Base", "not a plugin"}, 4);
+  ASSERT_EQ(5u, plugins.size());
+  for (std::size_t i = 0; i < 4; ++i)
+    ASSERT_TRUE(plugins[i]) << i;
+  EXPECT_FALSE(plugins[4]);
+
+  EXPECT_EQ("test::plugins::Left", *plugins[1]->Name());
+
+  const std::size_t top = Sequence(plugins[0]);
+  const std::size_t left = Sequence(plugins[1]);
+  const std::size_t right = Sequence(plugins[2]);
+  const std::size_t base = Sequence(plugins[3]);
+  EXPECT_LT(base, left);
+  EXPECT_LT(base, right);
+  EXPECT_LT(left, top);
+  EXPECT_LT(right, top);
+
+  // Left and Right were constructed at the same time
+  EXPECT_EQ(2u, plugins[0]->QueryInterface<Stage>()->PeakConcurrency());
+}
+
+/////////////////////////////////////////////////
+TEST(InstantiateAll, Cycle)
+{
+  Loader pl;
+  pl.LoadLib(IGNDependentPlugins_LIB);
+
+  const std::vector<PluginPtr> plugins = pl.InstantiateAll(
+      {"test::plugins::CycleA", "test::plugins::AfterCycle",
+       "test::plugins::CycleB", "test::plugins::Base"});
+  ASSERT_EQ(4u, plugins.size());
+  EXPECT_FALSE(plugins[0]);
+  EXPECT_FALSE(plugins[1]);
+  EXPECT_FALSE(plugins[2]);
+  EXPECT_TRUE(plugins[3]);
+
+  // A dependency that is not listed does not hold a plugin back
+  const std::vector<PluginPtr> afterCycle =
+      pl.InstantiateAll({"test::plugins::AfterCycle"});
+  ASSERT_EQ(1u, afterCycle.size());
+  EXPECT_TRUE(afterCycle[0]);
+}
+
+/////////////////////////////////////////////////
+TEST(InstantiateAll, Duplicates)
+{
+  Loader pl;
+  pl.LoadLib(IGNDependentPlugins_LIB);
+
+  // Right waits for both instances of Base, and runs on the calling thread
+  const std::vector<PluginPtr> plugins = pl.InstantiateAll(
+      {"test::plugins::Right", "test::plugins::Base", "test::plugins::Base"},
+      1);
+  ASSERT_EQ(3u, plugins.size());
+  for (const PluginPtr &plugin : plugins)
+    ASSERT_TRUE(plugin);
+
+  EXPECT_NE(plugins[1], plugins[2]);
+  EXPECT_LT(Sequence(plugins[1]), Sequence(plugins[0]));
+  EXPECT_LT(Sequence(plugins[2]), Sequence(plugins[0]));
+
+  EXPECT_TRUE(pl.InstantiateAll({}).empty());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
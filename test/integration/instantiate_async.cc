@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// The plugins of this translation unit are linked into the test program, so
+// they need to be registered with the process-wide registry.
+#define IGN_PLUGIN_STATIC_REGISTRY
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <ignition/plugin/AsyncInit.hh>
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/Register.hh>
+
+using ignition::plugin::AsyncInit;
+using ignition::plugin::Loader;
+using ignition::plugin::PluginPtr;
+
+namespace test
+{
+namespace async
+{
+
+/// \brief The interface of the plugins of this test
+class Connection
+{
+  public: virtual ~Connection() = default;
+
+  /// \brief Whether the initialization of the plugin has finished
+  public: virtual bool IsOpen() const = 0;
+};
+
+/// \brief Stands in for an event loop: the completions of the plugins wait
+/// here until the test runs them.
+class EventLoop
+{
+  public: static void Post(AsyncInit::Completion _done)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(std::move(_done));
+  }
+
+  /// \brief Take the completions which have been posted so far
+  public: static std::vector<AsyncInit::Completion> Take()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<AsyncInit::Completion> taken;
+    taken.swap(queue);
+    return taken;
+  }
+
+  private: static inline std::mutex mutex;
+
+  private: static inline std::vector<AsyncInit::Completion> queue;
+};
+
+/// \brief Finishes its initialization when the event loop gets to it
+class DeferredConnection : public Connection, public AsyncInit
+{
+  public: bool IsOpen() const override
+  {
+    return this->open;
+  }
+
+  public: void InitAsync(Completion _done) override
+  {
+    EventLoop::Post([this, _done](std::exception_ptr _error)
+    {
+      this->open = !_error;
+      _done(_error);
+    });
+  }
+
+  private: bool open = false;
+};
+
+/// \brief Reports a failure through its completion
+class RefusedConnection : public Connection, public AsyncInit
+{
+  public: bool IsOpen() const override
+  {
+    return false;
+  }
+
+  public: void InitAsync(Completion _done) override
+  {
+    _done(std::make_exception_ptr(std::runtime_error("refused")));
+
+    // Only the first call counts
+    _done(nullptr);
+  }
+};
+
+/// \brief Throws from InitAsync()
+class ThrowingConnection : public Connection, public AsyncInit
+{
+  public: bool IsOpen() const override
+  {
+    return false;
+  }
+
+  public: void InitAsync(Completion) override
+  {
+    throw std::runtime_error("unreachable");
+  }
+};
+
+/// \brief Does not need any initialization
+class PlainConnection : public Connection
+{
+  public: bool IsOpen() const override
+  {
+    return true;
+  }
+};
+
+}
+}
+
+IGNITION_ADD_PLUGIN(test::async::DeferredConnection,
+                    test::async::Connection, ignition::plugin::AsyncInit)
+IGNITION_ADD_PLUGIN_ALIAS(test::async::DeferredConnection, "Deferred")
+IGNITION_ADD_PLUGIN(test::async::RefusedConnection,
+                    test::async::Connection, ignition::plugin::AsyncInit)
+IGNITION_ADD_PLUGIN(test::async::ThrowingConnection,
+                    test::async::Connection, ignition::plugin::AsyncInit)
+IGNITION_ADD_PLUGIN(test::async::PlainConnection, test::async::Connection)
+
+using test::async::Connection;
+using test::async::EventLoop;
+
+/////////////////////////////////////////////////
+bool IsReady(const std::future<PluginPtr> &_future)
+{
+  return std::future_status::ready ==
+      _future.wait_for(std::chrono::seconds(0));
+}
+
+/////////////////////////////////////////////////
+TEST(InstantiateAsync, Deferred)
+{
+  Loader pl;
+  pl.LoadStaticPlugins();
+
+  std::future<PluginPtr> future = pl.InstantiateAsync("Deferred");
+  ASSERT_TRUE(future.valid());
+  EXPECT_FALSE(IsReady(future));
+
+  std::vector<AsyncInit::Completion> completions = EventLoop::Take();
+  ASSERT_EQ(1u, completions.size());
+  completions.front()(nullptr);
+
+  ASSERT_TRUE(IsReady(future));
+  const PluginPtr plugin = future.get();
+  ASSERT_TRUE(plugin);
+  EXPECT_TRUE(plugin->QueryInterface<Connection>()->IsOpen());
+}
+
+/////////////////////////////////////////////////
+TEST(InstantiateAsync, Immediate)
+{
+  Loader pl;
+  pl.LoadStaticPlugins();
+
+  // Plugins without AsyncInit are ready right away
+  std::future<PluginPtr> plain =
+      pl.InstantiateAsync("test::async::PlainConnection");
+  ASSERT_TRUE(IsReady(plain));
+  const PluginPtr plugin = plain.get();
+  ASSERT_TRUE(plugin);
+  EXPECT_TRUE(plugin->QueryInterface<Connection>()->IsOpen());
+
+  // So are plugins which cannot be found
+  std::future<PluginPtr> missing = pl.InstantiateAsync("not a plugin");
+  ASSERT_TRUE(IsReady(missing));
+  EXPECT_FALSE(missing.get());
+}
+
+/////////////////////////////////////////////////
+TEST(InstantiateAsync, Failures)
+{
+  Loader pl;
+  pl.LoadStaticPlugins();
+
+  std::future<PluginPtr> refused =
+      pl.InstantiateAsync("test::async::RefusedConnection");
+  ASSERT_TRUE(IsReady(refused));
+  EXPECT_THROW(refused.get(), std::runtime_error);
+
+  std::future<PluginPtr> throwing =
+      pl.InstantiateAsync("test::async::ThrowingConnection");
+  ASSERT_TRUE(IsReady(throwing));
+  EXPECT_THROW(throwing.get(), std::runtime_error);
+
+  // A failed initialization deletes the instance
+  std::future<PluginPtr> deferred = pl.InstantiateAsync("Deferred");
+  std::vector<AsyncInit::Completion> completions = EventLoop::Take();
+  ASSERT_EQ(1u, completions.size());
+  completions.front()(std::make_exception_ptr(std::runtime_error("lost")));
+  EXPECT_THROW(deferred.get(), std::runtime_error);
+}
+
+/////////////////////////////////////////////////
+TEST(InstantiateAsync, Many)
+{
+  Loader pl;
+  pl.LoadStaticPlugins();
+
+  // Start many plugins from one thread, and finish them from others
+  const std::size_t count = 200;
+  std::vector<std::future<PluginPtr>> futures;
+  for (std::size_t i = 0; i < count; ++i)
+    futures.push_back(pl.InstantiateAsync("Deferred"));
+
+  std::vector<AsyncInit::Completion> completions = EventLoop::Take();
+  ASSERT_EQ(count, completions.size());
+
+  std::vector<std::thread> threads;
+  const std::size_t threadCount = 4;
+  for (std::size_t t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for (std::size_t i = t; i < count; i += threadCount)
+        completions[i](nullptr);
+    });
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (std::future<PluginPtr> &future : futures)
+  {
+    ASSERT_TRUE(IsReady(future));
+    const PluginPtr plugin = future.get();
+    ASSERT_TRUE(plugin);
+    EXPECT_TRUE(plugin->QueryInterface<Connection>()->IsOpen());
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ignition/plugin/LibraryMap.hh>
+#include <ignition/plugin/Loader.hh>
+
+#include "utils.hh"
+
+using ignition::plugin::LibraryMapObserver;
+using ignition::plugin::LibraryMapping;
+using ignition::plugin::Loader;
+
+/////////////////////////////////////////////////
+class MappingRecorder : public LibraryMapObserver
+{
+  public: void OnLibraryMapped(const LibraryMapping &_mapping) override
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->mapped.push_back(_mapping);
+  }
+
+  public: void OnLibraryUnmapped(const LibraryMapping &_mapping) override
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->unmapped.push_back(_mapping);
+  }
+
+  public: std::mutex mutex;
+  public: std::vector<LibraryMapping> mapped;
+  public: std::vector<LibraryMapping> unmapped;
+};
+
+/////////////////////////////////////////////////
+bool EndsWith(const std::string &_text, const std::string &_suffix)
+{
+  return _text.size() >= _suffix.size() &&
+      0 == _text.compare(_text.size() - _suffix.size(), _suffix.size(),
+                         _suffix);
+}
+
+/////////////////////////////////////////////////
+TEST(LibraryMap, MappedAndUnmapped)
+{
+  const std::string &libraryPath = IGNDummyPlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  MappingRecorder recorder;
+  ignition::plugin::SetLibraryMapObserver(&recorder);
+  {
+    Loader first;
+    EXPECT_FALSE(first.LoadLib(libraryPath).empty());
+    ASSERT_EQ(1u, recorder.mapped.size());
+
+    const LibraryMapping &mapping = recorder.mapped.front();
+    EXPECT_TRUE(EndsWith(mapping.path, "libIGNDummyPlugins.so"))
+        << mapping.path;
+
+    std::size_t executable = 0;
+    for (const LibraryMapping::Segment &segment : mapping.segments)
+    {
+      EXPECT_LT(segment.begin, segment.end);
+      EXPECT_LE(mapping.loadBias, segment.begin);
+      if (segment.executable)
+        ++executable;
+    }
+    EXPECT_LE(1u, executable);
+
+    // The registration hook of the library lies in one of its code segments
+    void *dlHandle = dlopen(libraryPath.c_str(), RTLD_NOLOAD | RTLD_LAZY);
+    ASSERT_NE(nullptr, dlHandle);
+    const auto hook = reinterpret_cast<std::uintptr_t>(
+          dlsym(dlHandle, "IgnitionPluginHook"));
+    dlclose(dlHandle);
+    ASSERT_NE(0u, hook);
+
+    bool found = false;
+    for (const LibraryMapping::Segment &segment : mapping.segments)
+    {
+      found |= segment.executable &&
+          segment.begin <= hook && hook < segment.end;
+    }
+    EXPECT_TRUE(found);
+
+    // A library which is already open is not reported again
+    Loader second;
+    EXPECT_FALSE(second.LoadLib(libraryPath).empty());
+    EXPECT_EQ(1u, recorder.mapped.size());
+    EXPECT_TRUE(first.ForgetLibrary(libraryPath));
+    EXPECT_TRUE(recorder.unmapped.empty());
+  }
+
+  // The last Loader to let go of the library reports it before closing it
+  CHECK_FOR_LIBRARY(libraryPath, false);
+  ASSERT_EQ(1u, recorder.unmapped.size());
+  EXPECT_EQ(recorder.mapped.front().path, recorder.unmapped.front().path);
+  EXPECT_EQ(recorder.mapped.front().buildId,
+            recorder.unmapped.front().buildId);
+
+  ignition::plugin::SetLibraryMapObserver(nullptr);
+
+  // Once the observer is gone, nothing gets reported anymore
+  {
+    Loader pl;
+    EXPECT_FALSE(pl.LoadLib(libraryPath).empty());
+  }
+  EXPECT_EQ(1u, recorder.mapped.size());
+  EXPECT_EQ(1u, recorder.unmapped.size());
+}
+
+/////////////////////////////////////////////////
+TEST(LibraryMap, NewObserverLearnsOpenLibraries)
+{
+  Loader pl;
+  EXPECT_FALSE(pl.LoadLib(IGNDummyPlugins_LIB).empty());
+
+  MappingRecorder recorder;
+  ignition::plugin::SetLibraryMapObserver(&recorder);
+  ASSERT_EQ(1u, recorder.mapped.size());
+  EXPECT_TRUE(EndsWith(recorder.mapped.front().path, "libIGNDummyPlugins.so"));
+
+  EXPECT_TRUE(pl.ForgetLibrary(IGNDummyPlugins_LIB));
+  EXPECT_EQ(1u, recorder.unmapped.size());
+  ignition::plugin::SetLibraryMapObserver(nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST(LibraryMap, PerfMapWriter)
+{
+  const std::string path = "/tmp/ign-plugin-library-map-" +
+      std::to_string(::getpid()) + ".map";
+  std::remove(path.c_str());
+
+  EXPECT_EQ("/tmp/perf-" + std::to_string(::getpid()) + ".map",
+            ignition::plugin::PerfMapWriter("").Path());
+  std::remove(ignition::plugin::PerfMapWriter("").Path().c_str());
+
+  MappingRecorder recorder;
+  {
+    ignition::plugin::PerfMapWriter writer(path);
+    EXPECT_EQ(path, writer.Path());
+    ASSERT_TRUE(writer.IsOpen());
+
+    ignition::plugin::SetLibraryMapObserver(&writer);
+    {
+      Loader pl;
+      EXPECT_FALSE(pl.LoadLib(IGNDummyPlugins_LIB).empty());
+    }
+    ignition::plugin::SetLibraryMapObserver(&recorder);
+    ignition::plugin::SetLibraryMapObserver(nullptr);
+  }
+
+  // Only the libraries which were open when the recorder was set are told
+  EXPECT_TRUE(recorder.mapped.empty());
+
+  // Each code segment is one line, which stays after the library is closed
+  std::ifstream file(path);
+  std::string line;
+  std::size_t lines = 0;
+  while (std::getline(file, line))
+  {
+    std::istringstream fields(line);
+    std::uintptr_t start = 0;
+    std::size_t size = 0;
+    std::string name;
+    fields >> std::hex >> start >> size;
+    std::getline(fields >> std::ws, name);
+
+    EXPECT_NE(0u, start);
+    EXPECT_NE(0u, size);
+    EXPECT_NE(std::string::npos, name.find("libIGNDummyPlugins.so")) << name;
+    ++lines;
+  }
+  EXPECT_LE(1u, lines);
+
+  std::remove(path.c_str());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
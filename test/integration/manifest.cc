@@ -0,0 +1,471 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ignition/plugin/Loader.hh"
+
+#include "ignition/plugin/Factory.hh"
+
+#include "../plugins/DummyPlugins.hh"
+#include "../plugins/FactoryPlugins.hh"
+#include "utils.hh"
+
+/////////////////////////////////////////////////
+/// \brief Get a path in the temporary directory for a manifest cache file
+/// which does not exist yet
+std::string TemporaryCacheFile(const std::string &_name)
+{
+  const std::string file = (std::filesystem::temp_directory_path()
+      / ("ign_plugin_manifest_" + _name + ".cache")).string();
+  std::remove(file.c_str());
+  return file;
+}
+
+/////////////////////////////////////////////////
+TEST(ManifestCache, DeferredLoading)
+{
+  const std::string path = IGNDummyPlugins_LIB;
+  const std::string cache = TemporaryCacheFile("deferred");
+
+  std::unordered_set<std::string> loadedPlugins;
+  {
+    ignition::plugin::Loader pl;
+    pl.SetManifestCache(cache);
+
+    // The first time around, the library needs to be opened to learn what it
+    // provides.
+    loadedPlugins = pl.LoadLib(path);
+    EXPECT_FALSE(loadedPlugins.empty());
+    CHECK_FOR_LIBRARY(path, true);
+
+    EXPECT_TRUE(pl.SaveManifestCache());
+  }
+
+  CHECK_FOR_LIBRARY(path, false);
+
+  {
+    ignition::plugin::Loader pl;
+    pl.SetManifestCache(cache);
+
+    // Now the cache knows about the library, so it does not get opened
+    EXPECT_EQ(loadedPlugins, pl.LoadLib(path));
+    CHECK_FOR_LIBRARY(path, false);
+
+    // ... but we can still ask about its plugins
+    EXPECT_EQ(loadedPlugins.size(), pl.AllPlugins().size());
+    EXPECT_EQ(3u, pl.PluginsImplementing<test::util::DummyNameBase>().size());
+    EXPECT_EQ(1u, pl.InterfacesImplemented().count(
+                "test::util::DummySetterBase"));
+    EXPECT_EQ("test::util::DummyMultiPlugin", pl.LookupPlugin("Foo"));
+    EXPECT_EQ(2u, pl.PluginsWithAlias("Bar").size());
+    CHECK_FOR_LIBRARY(path, false);
+
+    // The library gets opened on the first instantiation
+    ignition::plugin::PluginPtr plugin =
+        pl.Instantiate("test::util::DummyMultiPlugin");
+    ASSERT_TRUE(plugin);
+    CHECK_FOR_LIBRARY(path, true);
+
+    test::util::DummyNameBase *nameBase =
+        plugin->QueryInterface<test::util::DummyNameBase>();
+    ASSERT_NE(nullptr, nameBase);
+    EXPECT_EQ("DummyMultiPlugin", nameBase->MyNameIs());
+
+    // The other plugins of the library should be usable right away
+    EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+    EXPECT_EQ(loadedPlugins.size(), pl.AllPlugins().size());
+  }
+
+  CHECK_FOR_LIBRARY(path, false);
+
+  {
+    ignition::plugin::Loader pl;
+    pl.SetManifestCache(cache);
+    pl.LoadLib(path);
+
+    // Libraries that have not been opened can still be forgotten
+    EXPECT_TRUE(pl.ForgetLibrary(path));
+    EXPECT_TRUE(pl.AllPlugins().empty());
+    EXPECT_TRUE(pl.PluginsImplementing<test::util::DummyNameBase>().empty());
+    EXPECT_FALSE(pl.ForgetLibrary(path));
+
+    pl.LoadLib(path);
+    EXPECT_TRUE(pl.ForgetLibraryOfPlugin("test::util::DummyMultiPlugin"));
+    EXPECT_TRUE(pl.AllPlugins().empty());
+    CHECK_FOR_LIBRARY(path, false);
+  }
+
+  std::remove(cache.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(ManifestCache, CorruptCache)
+{
+  const std::string path = IGNDummyPlugins_LIB;
+  const std::string cache = TemporaryCacheFile("corrupt");
+
+  {
+    std::ofstream out(cache);
+    out << "this is not a manifest";
+  }
+
+  ignition::plugin::Loader pl;
+  pl.SetManifestCache(cache);
+
+  // A corrupt cache is ignored, and the library gets opened as usual
+  EXPECT_FALSE(pl.LoadLib(path).empty());
+  CHECK_FOR_LIBRARY(path, true);
+  EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+
+  // Saving the cache fixes it
+  EXPECT_TRUE(pl.SaveManifestCache());
+
+  ignition::plugin::Loader other;
+  other.SetManifestCache(cache);
+  EXPECT_EQ(pl.AllPlugins().size(), other.LoadLib(path).size());
+
+  // A cache which claims an absurd number of plugins is just as corrupt, and
+  // does not make the Loader try to allocate room for all of them
+  {
+    const auto writeValue = [](std::ofstream &_out, const auto &_value)
+    {
+      _out.write(reinterpret_cast<const char *>(&_value), sizeof(_value));
+    };
+
+    std::ofstream out(cache, std::ios::binary);
+    out.write("IGNPLGM3", 8);
+    writeValue(out, std::uint32_t{1});
+    writeValue(out, static_cast<std::uint32_t>(path.size()));
+    out.write(path.data(), static_cast<std::streamsize>(path.size()));
+    writeValue(out, std::int64_t{0});
+    writeValue(out, std::uint64_t{0});
+    writeValue(out, std::uint32_t{0});
+    writeValue(out, std::uint32_t{0xFFFFFFFF});
+  }
+
+  ignition::plugin::Loader huge;
+  huge.SetManifestCache(cache);
+  EXPECT_EQ(pl.AllPlugins().size(), huge.LoadLib(path).size());
+
+  std::remove(cache.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(Manifest, WriteAndLoad)
+{
+  const std::string dummyPath = IGNDummyPlugins_LIB;
+  const std::string factoryPath = IGNFactoryPlugins_LIB;
+  const std::string manifest = TemporaryCacheFile("sidecar");
+
+  EXPECT_TRUE(ignition::plugin::Loader::WriteManifest(
+                manifest, {dummyPath, factoryPath}));
+
+  // Writing the manifest does not leave the libraries loaded
+  CHECK_FOR_LIBRARY(dummyPath, false);
+  CHECK_FOR_LIBRARY(factoryPath, false);
+
+  {
+    ignition::plugin::Loader pl;
+    const std::unordered_set<std::string> plugins = pl.LoadManifest(manifest);
+    EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+    EXPECT_FALSE(pl.LookupPlugin("test::util::DummyNameForward").empty());
+    EXPECT_EQ(2u, pl.PluginsImplementing<test::util::NameFactory>().size());
+
+    CHECK_FOR_LIBRARY(dummyPath, false);
+    CHECK_FOR_LIBRARY(factoryPath, false);
+
+    // Only the library of the plugin that we use gets opened
+    auto nameFactory =
+        pl.Factory<test::util::NameFactory>("test::util::DummyNameForward");
+    ASSERT_NE(nullptr, nameFactory);
+    EXPECT_EQ("John Doe", nameFactory->Construct("John Doe")->MyNameIs());
+
+    CHECK_FOR_LIBRARY(dummyPath, false);
+    CHECK_FOR_LIBRARY(factoryPath, true);
+  }
+
+  // A library that cannot be loaded is reported, but the rest still get
+  // written.
+  EXPECT_FALSE(ignition::plugin::Loader::WriteManifest(
+                 manifest, {"/not/a/library.so", dummyPath}));
+
+  ignition::plugin::Loader pl;
+  EXPECT_EQ(1u, pl.LoadManifest(manifest).count(
+              "test::util::DummySinglePlugin"));
+  EXPECT_TRUE(pl.PluginsImplementing<test::util::NameFactory>().empty());
+
+  EXPECT_TRUE(pl.LoadManifest("/not/a/manifest").empty());
+
+  std::remove(manifest.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(Manifest, ConcurrentWriters)
+{
+  const std::string dummyPath = IGNDummyPlugins_LIB;
+  const std::string manifest = TemporaryCacheFile("concurrent");
+
+  // Every writer renames its own complete file over the manifest
+  std::vector<std::thread> writers;
+  for (std::size_t i = 0; i < 8; ++i)
+  {
+    writers.emplace_back([&]()
+    {
+      EXPECT_TRUE(ignition::plugin::Loader::WriteManifest(
+                    manifest, {dummyPath}));
+    });
+  }
+
+  for (std::thread &writer : writers)
+    writer.join();
+
+  ignition::plugin::Loader pl;
+  EXPECT_EQ(1u, pl.LoadManifest(manifest).count(
+              "test::util::DummySinglePlugin"));
+
+  // No temporary files are left behind
+  for (const auto &entry : std::filesystem::directory_iterator(
+         std::filesystem::path(manifest).parent_path()))
+  {
+    EXPECT_NE(0u, entry.path().string().rfind(manifest + ".tmp", 0))
+        << entry.path();
+  }
+
+  std::remove(manifest.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(Manifest, Sidecar)
+{
+  namespace fs = std::filesystem;
+
+  // Work on copies of the libraries, so that we can move them around
+  const fs::path directory =
+      fs::temp_directory_path() / "ign_plugin_sidecar_test";
+  const fs::path moved = fs::temp_directory_path() / "ign_plugin_sidecar_moved";
+  fs::remove_all(directory);
+  fs::remove_all(moved);
+  ASSERT_TRUE(fs::create_directory(directory));
+
+  const std::string dummyName = fs::path(IGNDummyPlugins_LIB).filename();
+  const std::string factoryName = fs::path(IGNFactoryPlugins_LIB).filename();
+  fs::copy_file(IGNDummyPlugins_LIB, directory / dummyName);
+  fs::copy_file(IGNFactoryPlugins_LIB, directory / factoryName);
+
+  // Only the dummy library gets a sidecar manifest
+  std::string dummyPath = (directory / dummyName).string();
+  std::string factoryPath = (directory / factoryName).string();
+  ASSERT_TRUE(ignition::plugin::Loader::WriteManifest(
+                dummyPath + ".ignplugin", {dummyPath}));
+
+  {
+    ignition::plugin::Loader pl;
+    const std::unordered_set<std::string> plugins =
+        pl.LoadDirectory(directory.string());
+    EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+    EXPECT_FALSE(pl.LookupPlugin("test::util::DummyNameForward").empty());
+
+    CHECK_FOR_LIBRARY(dummyPath, false);
+    CHECK_FOR_LIBRARY(factoryPath, true);
+  }
+
+  // The manifest refers to the library relative to its own location, so it
+  // is still valid once the directory has been moved.
+  fs::rename(directory, moved);
+  dummyPath = (moved / dummyName).string();
+  factoryPath = (moved / factoryName).string();
+
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_EQ(1u, pl.LoadDirectory(moved.string()).count(
+                "test::util::DummySinglePlugin"));
+    CHECK_FOR_LIBRARY(dummyPath, false);
+
+    EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+    CHECK_FOR_LIBRARY(dummyPath, true);
+  }
+
+  // Sidecar manifests can be merged into an index
+  const std::string index = (moved / "index.ignplugin").string();
+  EXPECT_TRUE(ignition::plugin::Loader::MergeManifests(
+                index, {dummyPath + ".ignplugin"}));
+  EXPECT_FALSE(ignition::plugin::Loader::MergeManifests(
+                 index, {dummyPath + ".ignplugin", "/not/a/manifest"}));
+
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_EQ(1u, pl.LoadManifest(index).count(
+                "test::util::DummySinglePlugin"));
+    CHECK_FOR_LIBRARY(dummyPath, false);
+  }
+
+  fs::remove_all(moved);
+}
+
+/////////////////////////////////////////////////
+TEST(Manifest, SaveLoaderState)
+{
+  const std::string dummyPath = IGNDummyPlugins_LIB;
+  const std::string factoryPath = IGNFactoryPlugins_LIB;
+  const std::string sidecar = TemporaryCacheFile("factory");
+  const std::string state = TemporaryCacheFile("state");
+
+  ASSERT_TRUE(ignition::plugin::Loader::WriteManifest(
+                sidecar, {factoryPath}));
+
+  {
+    // One library is open and the other one is only known from a manifest
+    ignition::plugin::Loader pl;
+    EXPECT_FALSE(pl.LoadLib(dummyPath).empty());
+    EXPECT_FALSE(pl.LoadManifest(sidecar).empty());
+    CHECK_FOR_LIBRARY(factoryPath, false);
+
+    EXPECT_TRUE(pl.SaveManifest(state));
+    CHECK_FOR_LIBRARY(factoryPath, false);
+  }
+  CHECK_FOR_LIBRARY(dummyPath, false);
+
+  ignition::plugin::Loader pl;
+  const std::unordered_set<std::string> plugins = pl.LoadManifest(state);
+  EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+  EXPECT_FALSE(pl.LookupPlugin("test::util::DummyNameForward").empty());
+  EXPECT_EQ(2u, pl.PluginsWithAlias("Bar").size());
+  EXPECT_EQ(2u, pl.PluginsImplementing<test::util::NameFactory>().size());
+
+  // Neither of the libraries is opened until it is needed
+  CHECK_FOR_LIBRARY(dummyPath, false);
+  CHECK_FOR_LIBRARY(factoryPath, false);
+  EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+  CHECK_FOR_LIBRARY(factoryPath, false);
+
+  EXPECT_FALSE(pl.SaveManifest("/not/a/directory/state"));
+
+  std::remove(sidecar.c_str());
+  std::remove(state.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(Manifest, SharedByBuildId)
+{
+  namespace fs = std::filesystem;
+
+  // One directory plays the machine that writes the manifest, and the other
+  // one plays a machine which has the same libraries installed somewhere else
+  const fs::path writer = fs::temp_directory_path() / "ign_plugin_shared_a";
+  const fs::path node = fs::temp_directory_path() / "ign_plugin_shared_b";
+  fs::remove_all(writer);
+  fs::remove_all(node);
+  ASSERT_TRUE(fs::create_directory(writer));
+  ASSERT_TRUE(fs::create_directory(node));
+
+  const std::string dummyName = fs::path(IGNDummyPlugins_LIB).filename();
+  const std::string factoryName = fs::path(IGNFactoryPlugins_LIB).filename();
+  fs::copy_file(IGNDummyPlugins_LIB, writer / dummyName);
+  fs::copy_file(IGNDummyPlugins_LIB, node / dummyName);
+  fs::copy_file(IGNFactoryPlugins_LIB, node / factoryName);
+
+  const std::string dummyPath = (node / dummyName).string();
+  const std::string factoryPath = (node / factoryName).string();
+
+  // The manifest lives outside of both directories, so it records the
+  // library at its absolute path on the writer
+  const std::string manifest = TemporaryCacheFile("shared");
+  ASSERT_TRUE(ignition::plugin::Loader::WriteManifest(
+                manifest, {(writer / dummyName).string()}));
+
+  // The copies on the node were not written at the same time as the library
+  // that was described
+  fs::last_write_time(dummyPath,
+                      fs::last_write_time(dummyPath) + std::chrono::hours(1));
+
+  {
+    ignition::plugin::Loader pl;
+    const std::unordered_set<std::string> plugins =
+        pl.LoadManifest(manifest, {dummyPath, factoryPath});
+    EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+    EXPECT_FALSE(pl.LookupPlugin("test::util::DummyNameForward").empty());
+
+    // The library with the same build-id is not opened
+    CHECK_FOR_LIBRARY(dummyPath, false);
+
+    // The plugin comes from the library of the node
+    EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+    CHECK_FOR_LIBRARY(dummyPath, true);
+    CHECK_FOR_LIBRARY((writer / dummyName).string(), false);
+
+    // The library which the manifest does not describe had to be opened
+    CHECK_FOR_LIBRARY(factoryPath, true);
+  }
+
+  // The manifest can also come from memory
+  std::string contents;
+  {
+    std::ifstream in(manifest, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+  }
+
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_EQ(1u, pl.LoadManifestData(contents, {dummyPath}).count(
+                "test::util::DummySinglePlugin"));
+    CHECK_FOR_LIBRARY(dummyPath, false);
+
+    EXPECT_TRUE(pl.LoadManifestData("not a manifest").empty());
+  }
+
+  // A library at the recorded path is still found by its build-id once its
+  // modification time has changed
+  fs::last_write_time(writer / dummyName,
+                      fs::last_write_time(writer / dummyName)
+                      + std::chrono::hours(1));
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_EQ(1u, pl.LoadManifest(manifest).count(
+                "test::util::DummySinglePlugin"));
+    CHECK_FOR_LIBRARY((writer / dummyName).string(), false);
+  }
+
+  std::remove(manifest.c_str());
+  fs::remove_all(writer);
+  fs::remove_all(node);
+}
+
+/////////////////////////////////////////////////
+TEST(ManifestCache, NoCache)
+{
+  ignition::plugin::Loader pl;
+  EXPECT_FALSE(pl.SaveManifestCache());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
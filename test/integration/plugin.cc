@@ -21,12 +21,25 @@
 #define IGNITION_UNITTEST_SPECIALIZED_PLUGIN_ACCESS
 
 #include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory_resource>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
 #include <vector>
 #include <iostream>
 #include "ignition/plugin/Loader.hh"
 #include "ignition/plugin/PluginPtr.hh"
 #include "ignition/plugin/SpecializedPluginPtr.hh"
+#include "ignition/plugin/Trace.hh"
 
 #include "../plugins/DummyPlugins.hh"
 #include "utils.hh"
@@ -38,6 +51,7 @@ TEST(Loader, LoadBadPlugins)
     IGNBadPluginAPIVersionOld_LIB,
     IGNBadPluginAPIVersionNew_LIB,
     IGNBadPluginAlign_LIB,
+    IGNBadPluginDescriptorVersion_LIB,
     IGNBadPluginNoInfo_LIB,
     IGNBadPluginSize_LIB};
   for (auto const & library : libraries)
@@ -92,6 +106,44 @@ TEST(Loader, LoadExistingLibrary)
   EXPECT_EQ(1u, pl.PluginsImplementing(
                     typeid(test::util::DummyDoubleBase).name(), false).size());
 
+  // Only DummyMultiPlugin implements both of these interfaces
+  const std::unordered_set<std::string> nameAndDouble =
+      pl.PluginsImplementing<test::util::DummyNameBase,
+                             test::util::DummyDoubleBase>();
+  EXPECT_EQ(1u, nameAndDouble.size());
+  EXPECT_EQ(1u, nameAndDouble.count("test::util::DummyMultiPlugin"));
+  EXPECT_EQ(nameAndDouble, pl.PluginsImplementingAll(
+                {"test::util::DummyNameBase", "test::util::DummyDoubleBase",
+                 "test::util::DummyIntBase"}));
+  EXPECT_EQ(3u, pl.PluginsImplementingAll(
+                {"test::util::DummyNameBase"}).size());
+  EXPECT_EQ(3u, pl.PluginsImplementingAll({}).size());
+  EXPECT_EQ(nameAndDouble, (pl.PluginsImplementingAll<
+                test::util::DummyDoubleBase, test::util::DummyNameBase>()));
+  EXPECT_EQ(1u, pl.PluginsImplementingAll<test::util::DummyIntBase>().size());
+
+  EXPECT_EQ(3u, (pl.PluginsImplementingAny<
+                test::util::DummyDoubleBase, test::util::DummyNameBase>()
+                  .size()));
+  EXPECT_EQ(nameAndDouble, (pl.PluginsImplementingAny<
+                test::util::DummyDoubleBase, test::util::DummyIntBase>()));
+  EXPECT_EQ(nameAndDouble, pl.PluginsImplementingAny(
+                {"test::util::DummyIntBase", "not::an::Interface"}));
+  EXPECT_TRUE(pl.PluginsImplementingAny({"not::an::Interface"}).empty());
+  EXPECT_TRUE(pl.PluginsImplementingAny({}).empty());
+  EXPECT_TRUE(pl.PluginsImplementingAll(
+                {"test::util::DummyNameBase", "not::an::Interface"}).empty());
+
+  EXPECT_TRUE(pl.PluginImplements(
+                "test::util::DummyMultiPlugin", "test::util::DummyIntBase"));
+  EXPECT_TRUE(pl.PluginImplements(
+                "test::util::DummySinglePlugin",
+                typeid(test::util::DummyNameBase).name(), false));
+  EXPECT_FALSE(pl.PluginImplements(
+                "test::util::DummySinglePlugin", "test::util::DummyIntBase"));
+  EXPECT_FALSE(pl.PluginImplements(
+                "not::a::Plugin", "test::util::DummyNameBase"));
+
   EXPECT_EQ(3u, pl.AllPlugins().size());
 
   // Check DummySinglePlugin.
@@ -238,6 +290,129 @@ TEST(SpecializedPluginPtr, Construction)
   EXPECT_EQ(nullptr, someInterface);
 }
 
+/////////////////////////////////////////////////
+TEST(SpecializedPluginPtr, ConvertBetweenSpecializations)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  SomeSpecializedPluginPtr plugin(
+      pl.Instantiate("test::util::DummyMultiPlugin"));
+  ASSERT_FALSE(plugin.IsEmpty());
+
+  test::util::DummyIntBase *const fooBase =
+      plugin->QueryInterface<test::util::DummyIntBase>();
+  ASSERT_NE(nullptr, fooBase);
+
+  // The slots that both types have in common are taken from the source, and
+  // the others are looked up
+  using OtherPluginPtr = ignition::plugin::SpecializedPluginPtr<
+      test::util::DummyDoubleBase, test::util::DummyIntBase, SomeInterface>;
+  OtherPluginPtr other(plugin);
+  ASSERT_FALSE(other.IsEmpty());
+
+  usedSpecializedInterfaceAccess = false;
+  EXPECT_EQ(fooBase, other->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_TRUE(usedSpecializedInterfaceAccess);
+
+  usedSpecializedInterfaceAccess = false;
+  test::util::DummyDoubleBase *doubleBase =
+      other->QueryInterface<test::util::DummyDoubleBase>();
+  EXPECT_TRUE(usedSpecializedInterfaceAccess);
+  ASSERT_NE(nullptr, doubleBase);
+  EXPECT_NEAR(3.14159, doubleBase->MyDoubleValueIs(), 1e-8);
+  EXPECT_EQ(nullptr, other->QueryInterface<SomeInterface>());
+
+  // Assigning over an existing specialization refreshes every slot
+  other = ignition::plugin::PluginPtr();
+  EXPECT_TRUE(other.IsEmpty());
+  EXPECT_EQ(nullptr, other->QueryInterface<test::util::DummyIntBase>());
+
+  other = plugin;
+  EXPECT_EQ(fooBase, other->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_EQ(doubleBase, other->QueryInterface<test::util::DummyDoubleBase>());
+
+  // The slots of a flat specialization can be reused just the same
+  ignition::plugin::FlatSpecializedPluginPtr<
+      test::util::DummyIntBase, test::util::DummySetterBase> flat(other);
+  SomeSpecializedPluginPtr back(flat);
+  EXPECT_EQ(fooBase, back->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_NE(nullptr, back->QueryInterface<test::util::DummySetterBase>());
+  EXPECT_EQ(nullptr, back->QueryInterface<SomeInterface>());
+}
+
+/////////////////////////////////////////////////
+using SomeFlatSpecializedPluginPtr =
+    ignition::plugin::FlatSpecializedPluginPtr<
+        SomeInterface,
+        test::util::DummyIntBase,
+        test::util::DummySetterBase>;
+
+/////////////////////////////////////////////////
+TEST(FlatSpecializedPluginPtr, Construction)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  SomeFlatSpecializedPluginPtr plugin;
+  EXPECT_TRUE(plugin.IsEmpty());
+  EXPECT_EQ(nullptr, plugin->QueryInterface<test::util::DummyIntBase>());
+
+  plugin = pl.Instantiate("test::util::DummyMultiPlugin");
+  EXPECT_FALSE(plugin.IsEmpty());
+  EXPECT_EQ(std::string("test::util::DummyMultiPlugin"), *plugin->Name());
+
+  // The specialized interfaces are accessed using the specialized access
+  usedSpecializedInterfaceAccess = false;
+  test::util::DummyIntBase *fooBase =
+      plugin->QueryInterface<test::util::DummyIntBase>();
+  EXPECT_TRUE(usedSpecializedInterfaceAccess);
+  ASSERT_NE(nullptr, fooBase);
+  EXPECT_EQ(5, fooBase->MyIntegerValueIs());
+
+  usedSpecializedInterfaceAccess = false;
+  test::util::DummySetterBase *setterBase =
+      plugin->QueryInterface<test::util::DummySetterBase>();
+  EXPECT_TRUE(usedSpecializedInterfaceAccess);
+  ASSERT_NE(nullptr, setterBase);
+
+  setterBase->SetIntegerValue(54321);
+  EXPECT_EQ(54321, fooBase->MyIntegerValueIs());
+
+  // Other interfaces are found through the normal access
+  usedSpecializedInterfaceAccess = false;
+  test::util::DummyDoubleBase *doubleBase =
+      plugin->QueryInterface<test::util::DummyDoubleBase>();
+  EXPECT_FALSE(usedSpecializedInterfaceAccess);
+  EXPECT_NE(nullptr, doubleBase);
+
+  // A specialized interface which the plugin does not provide is null
+  usedSpecializedInterfaceAccess = false;
+  EXPECT_FALSE(plugin->HasInterface<SomeInterface>());
+  EXPECT_EQ(nullptr, plugin->QueryInterface<SomeInterface>());
+  EXPECT_TRUE(usedSpecializedInterfaceAccess);
+  EXPECT_TRUE(plugin->HasInterface<test::util::DummyIntBase>());
+
+  std::shared_ptr<test::util::DummyIntBase> sharedBase =
+      plugin->QueryInterfaceSharedPtr<test::util::DummyIntBase>();
+  EXPECT_EQ(fooBase, sharedBase.get());
+
+  ignition::plugin::ConstFlatSpecializedPluginPtr<
+      test::util::DummyIntBase> constPlugin = plugin;
+  usedSpecializedInterfaceAccess = false;
+  EXPECT_EQ(fooBase, constPlugin->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_TRUE(usedSpecializedInterfaceAccess);
+
+  // The slots follow the instance whenever it changes
+  plugin = pl.Instantiate("test::util::DummySinglePlugin");
+  EXPECT_EQ(nullptr, plugin->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_FALSE(plugin->HasInterface<test::util::DummySetterBase>());
+
+  plugin = nullptr;
+  EXPECT_EQ(nullptr, plugin->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_EQ(fooBase, constPlugin->QueryInterface<test::util::DummyIntBase>());
+}
+
 TEST(PluginPtr, Empty)
 {
   ignition::plugin::PluginPtr empty;
@@ -388,6 +563,294 @@ TEST(PluginPtr, CopyMoveSemantics)
   EXPECT_TRUE(c_plugin == otherPlugin);
 }
 
+/////////////////////////////////////////////////
+TEST(PluginPtr, CopiesShareInterfaces)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::util::DummyMultiPlugin");
+  ASSERT_TRUE(plugin);
+
+  test::util::DummyIntBase *intBase =
+      plugin->QueryInterface<test::util::DummyIntBase>();
+  ASSERT_NE(nullptr, intBase);
+
+  // Copies refer to the same interfaces as the original
+  ignition::plugin::PluginPtr copy = plugin;
+  EXPECT_EQ(intBase, copy->QueryInterface<test::util::DummyIntBase>());
+
+  // Specialized interfaces get updated whenever a different instance is
+  // assigned
+  SomeSpecializedPluginPtr specialized;
+  EXPECT_EQ(nullptr, specialized->QueryInterface<test::util::DummyIntBase>());
+
+  specialized = copy;
+  EXPECT_EQ(intBase, specialized->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_NE(nullptr,
+            specialized->QueryInterface<test::util::DummySetterBase>());
+  EXPECT_EQ(nullptr, specialized->QueryInterface<SomeInterface>());
+
+  specialized = pl.Instantiate("test::util::DummySinglePlugin");
+  EXPECT_FALSE(specialized->HasInterface<test::util::DummyIntBase>());
+  EXPECT_EQ(nullptr, specialized->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_TRUE(specialized->HasInterface<test::util::DummyNameBase>());
+
+  // The interface is not reported after the plugin has been released
+  copy = nullptr;
+  EXPECT_FALSE(copy->HasInterface<test::util::DummyIntBase>());
+  EXPECT_FALSE(copy->HasInterface(typeid(test::util::DummyIntBase).name(),
+                                  false));
+  EXPECT_EQ(intBase, plugin->QueryInterface<test::util::DummyIntBase>());
+}
+
+/////////////////////////////////////////////////
+TEST(PluginPtr, CopiesShareWrapper)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::util::DummyMultiPlugin");
+  ASSERT_TRUE(plugin);
+
+  // Copies of the same type share the wrapper of the original
+  ignition::plugin::PluginPtr copy = plugin;
+  EXPECT_EQ(plugin.operator->(), copy.operator->());
+
+  ignition::plugin::PluginPtr assigned;
+  assigned = copy;
+  EXPECT_EQ(plugin.operator->(), assigned.operator->());
+
+  // Changing one copy does not affect the others
+  copy = nullptr;
+  EXPECT_FALSE(copy);
+  EXPECT_NE(plugin.operator->(), copy.operator->());
+  EXPECT_TRUE(plugin);
+  EXPECT_TRUE(assigned);
+  EXPECT_EQ(plugin, assigned);
+
+  assigned = pl.Instantiate("test::util::DummySinglePlugin");
+  EXPECT_NE(plugin, assigned);
+  EXPECT_EQ("test::util::DummyMultiPlugin", *plugin->Name());
+  EXPECT_EQ("test::util::DummySinglePlugin", *assigned->Name());
+
+  // A cast to another type gets its own wrapper, and a wrapper that is not
+  // shared is reused when it is given a different instance
+  SomeSpecializedPluginPtr specialized = plugin;
+  const auto *wrapper = specialized.operator->();
+  EXPECT_EQ(plugin, specialized);
+  specialized = assigned;
+  EXPECT_EQ(wrapper, specialized.operator->());
+  EXPECT_EQ(assigned, specialized);
+  EXPECT_EQ("test::util::DummyMultiPlugin", *plugin->Name());
+
+  ignition::plugin::ConstPluginPtr constCopy = plugin;
+  EXPECT_EQ("test::util::DummyMultiPlugin", *constCopy->Name());
+}
+
+/////////////////////////////////////////////////
+TEST(PluginPtr, MovedFromIsEmpty)
+{
+  static_assert(std::is_nothrow_move_constructible<
+                  ignition::plugin::PluginPtr>::value,
+                "Containers must be able to move PluginPtrs");
+  static_assert(std::is_nothrow_move_assignable<
+                  SomeSpecializedPluginPtr>::value,
+                "Containers must be able to move SpecializedPluginPtrs");
+
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::util::DummyMultiPlugin");
+  ASSERT_TRUE(plugin);
+  const std::size_t hash = plugin.Hash();
+
+  ignition::plugin::PluginPtr moved = std::move(plugin);
+  EXPECT_TRUE(moved);
+  EXPECT_EQ(hash, moved.Hash());
+
+  // The moved-from PluginPtr can still be used like any other empty one
+  EXPECT_FALSE(plugin);
+  EXPECT_TRUE(plugin.IsEmpty());
+  EXPECT_EQ(ignition::plugin::PluginPtr().Hash(), plugin.Hash());
+  EXPECT_EQ(nullptr, plugin->Name());
+  EXPECT_FALSE(plugin->HasInterface<test::util::DummyIntBase>());
+  EXPECT_NE(plugin, moved);
+
+  SomeSpecializedPluginPtr specialized = moved;
+  SomeSpecializedPluginPtr movedSpecialized;
+  movedSpecialized = std::move(specialized);
+  EXPECT_FALSE(specialized);
+  EXPECT_EQ(nullptr, specialized->QueryInterface<test::util::DummyIntBase>());
+  EXPECT_NE(nullptr,
+            movedSpecialized->QueryInterface<test::util::DummyIntBase>());
+
+  // A moved-from PluginPtr can be given a new instance
+  plugin = moved;
+  EXPECT_EQ(moved, plugin);
+  specialized = moved;
+  EXPECT_NE(nullptr, specialized->QueryInterface<test::util::DummyIntBase>());
+
+  // Growing a vector moves its PluginPtrs
+  std::vector<ignition::plugin::PluginPtr> plugins;
+  for (std::size_t i = 0; i < 20; ++i)
+    plugins.push_back(pl.Instantiate("test::util::DummySinglePlugin"));
+  for (const ignition::plugin::PluginPtr &element : plugins)
+    EXPECT_EQ("test::util::DummySinglePlugin", *element->Name());
+
+  std::sort(plugins.begin(), plugins.end());
+  EXPECT_TRUE(std::is_sorted(plugins.begin(), plugins.end()));
+  EXPECT_EQ(20u, std::unordered_set<ignition::plugin::PluginPtr>(
+              plugins.begin(), plugins.end()).size());
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, InstantiateFromMemoryResource)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  CountingResource resource;
+
+  ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::util::DummyMultiPlugin", &resource);
+  ASSERT_TRUE(plugin);
+  EXPECT_NE(0u, resource.outstanding);
+
+  // The instance lives inside the storage from the resource, so it works
+  // just like any other instance
+  test::util::DummySetterBase *setter =
+      plugin->QueryInterface<test::util::DummySetterBase>();
+  ASSERT_NE(nullptr, setter);
+  setter->SetIntegerValue(42);
+  EXPECT_EQ(42, plugin->QueryInterface<test::util::DummyIntBase>()
+            ->MyIntegerValueIs());
+
+  SomeSpecializedPluginPtr specialized =
+      pl.Instantiate<SomeSpecializedPluginPtr>("Foo", &resource);
+  ASSERT_TRUE(specialized);
+  EXPECT_TRUE(specialized->HasInterface<test::util::DummyIntBase>());
+
+  // Copies and interface pointers keep the storage alive
+  std::shared_ptr<test::util::DummyIntBase> intBase =
+      plugin->QueryInterfaceSharedPtr<test::util::DummyIntBase>();
+  const std::size_t allocated = resource.allocated;
+  plugin = nullptr;
+  specialized = nullptr;
+  EXPECT_EQ(allocated, resource.allocated);
+  EXPECT_NE(0u, resource.outstanding);
+  EXPECT_EQ(42, intBase->MyIntegerValueIs());
+
+  intBase.reset();
+  EXPECT_EQ(0u, resource.outstanding);
+
+  EXPECT_FALSE(pl.Instantiate("Nope", &resource));
+  EXPECT_EQ(0u, resource.outstanding);
+
+  // A null resource falls back to the default heap
+  EXPECT_TRUE(pl.Instantiate("Foo", nullptr));
+  EXPECT_EQ(allocated, resource.allocated);
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, InstantiateMany)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  std::vector<ignition::plugin::PluginPtr> plugins;
+  EXPECT_EQ(0u, pl.Instantiate("Nope", 3, plugins));
+  EXPECT_EQ(0u, pl.Instantiate("Bar", 3, plugins));
+  EXPECT_TRUE(plugins.empty());
+
+  EXPECT_EQ(3u, pl.Instantiate("Foo", 3, plugins));
+  EXPECT_EQ(2u, pl.Instantiate("test::util::DummySinglePlugin", 2, plugins));
+  ASSERT_EQ(5u, plugins.size());
+
+  std::unordered_set<ignition::plugin::PluginPtr> unique(
+        plugins.begin(), plugins.end());
+  EXPECT_EQ(5u, unique.size());
+
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ("test::util::DummyMultiPlugin", *plugins[i]->Name());
+
+    // EnablePluginFromThis is set up for every instance of the batch
+    auto *fromThis =
+        plugins[i]->QueryInterface<ignition::plugin::EnablePluginFromThis>();
+    ASSERT_NE(nullptr, fromThis);
+    EXPECT_EQ(plugins[i], fromThis->PluginFromThis());
+  }
+
+  for (std::size_t i = 3; i < 5; ++i)
+    EXPECT_EQ("test::util::DummySinglePlugin", *plugins[i]->Name());
+
+  // A batch of specialized plugins can come from an arena
+  std::pmr::monotonic_buffer_resource arena;
+  std::vector<SomeSpecializedPluginPtr> specialized;
+  EXPECT_EQ(4u, pl.Instantiate("Foo", 4, specialized, &arena));
+  ASSERT_EQ(4u, specialized.size());
+  for (const SomeSpecializedPluginPtr &plugin : specialized)
+  {
+    EXPECT_NE(nullptr,
+              plugin->QueryInterface<test::util::DummySetterBase>());
+  }
+
+  EXPECT_EQ(0u, pl.Instantiate("Foo", 0, specialized));
+  EXPECT_EQ(4u, specialized.size());
+  specialized.clear();
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, Resolve)
+{
+  ignition::plugin::PluginHandle handle;
+  EXPECT_FALSE(handle);
+  EXPECT_EQ(nullptr, handle.Name());
+  EXPECT_FALSE(handle.Instantiate());
+  EXPECT_EQ(nullptr, handle.Factory<test::util::DummyIntBase>());
+
+  {
+    ignition::plugin::Loader pl;
+    pl.LoadLib(IGNDummyPlugins_LIB);
+
+    EXPECT_FALSE(pl.Resolve("Nope"));
+    EXPECT_FALSE(pl.Resolve("Bar"));
+
+    handle = pl.Resolve("Foo");
+    ASSERT_TRUE(handle.IsValid());
+    ASSERT_NE(nullptr, handle.Name());
+    EXPECT_EQ("test::util::DummyMultiPlugin", *handle.Name());
+
+    // The handle keeps the library loaded after the Loader forgets it
+    EXPECT_TRUE(pl.ForgetLibrary(IGNDummyPlugins_LIB));
+    EXPECT_FALSE(pl.Instantiate("Foo"));
+  }
+
+  ignition::plugin::PluginPtr first = handle.Instantiate();
+  ignition::plugin::PluginPtr second = handle.Instantiate();
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second);
+
+  auto *fromThis =
+      first->QueryInterface<ignition::plugin::EnablePluginFromThis>();
+  ASSERT_NE(nullptr, fromThis);
+  EXPECT_EQ(first, fromThis->PluginFromThis());
+
+  SomeSpecializedPluginPtr specialized =
+      handle.Instantiate<SomeSpecializedPluginPtr>();
+  EXPECT_TRUE(specialized->HasInterface<test::util::DummyIntBase>());
+
+  std::shared_ptr<test::util::DummyIntBase> intBase =
+      handle.Factory<test::util::DummyIntBase>();
+  ASSERT_NE(nullptr, intBase);
+  EXPECT_EQ(5, intBase->MyIntegerValueIs());
+}
+
 /////////////////////////////////////////////////
 void SetSomeValues(std::shared_ptr<test::util::DummySetterBase> setter)
 {
@@ -480,6 +943,113 @@ TEST(PluginPtr, QueryInterfaceSharedPtr)
   CheckSomeValues(getInt, getDouble, getName);
 }
 
+/////////////////////////////////////////////////
+TEST(PluginPtr, QueryInterfaceRef)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  ignition::plugin::InterfaceRef<test::util::DummyIntBase> intRef;
+  EXPECT_FALSE(intRef);
+  EXPECT_EQ(nullptr, intRef.Get());
+  EXPECT_TRUE(intRef.Expired());
+
+  {
+    SomeSpecializedPluginPtr plugin =
+        pl.Instantiate("test::util::DummyMultiPlugin");
+    ASSERT_FALSE(plugin.IsEmpty());
+
+    intRef = plugin->QueryInterfaceRef<test::util::DummyIntBase>();
+    ASSERT_TRUE(intRef);
+    EXPECT_FALSE(intRef.Expired());
+    EXPECT_EQ(plugin->QueryInterface<test::util::DummyIntBase>(),
+              intRef.Get());
+    EXPECT_EQ(5, intRef->MyIntegerValueIs());
+
+    ignition::plugin::InterfaceRef<test::util::DummySetterBase> setter =
+        plugin->QueryInterfaceRef<test::util::DummySetterBase>();
+    ASSERT_TRUE(setter);
+    setter->SetIntegerValue(42);
+    EXPECT_EQ(42, (*intRef).MyIntegerValueIs());
+
+    const ignition::plugin::ConstPluginPtr constPlugin = plugin;
+    ignition::plugin::InterfaceRef<const test::util::DummyIntBase> constRef =
+        constPlugin->QueryInterfaceRef<test::util::DummyIntBase>();
+    ASSERT_TRUE(constRef);
+    EXPECT_EQ(42, constRef->MyIntegerValueIs());
+
+    EXPECT_FALSE(plugin->QueryInterfaceRef<SomeInterface>());
+  }
+
+  // The reference does not keep the instance alive, so once the last
+  // PluginPtr is gone, the reference knows that it must no longer be used
+  EXPECT_TRUE(intRef);
+  EXPECT_TRUE(intRef.Expired());
+}
+
+/////////////////////////////////////////////////
+/// \brief Detects whether an interface can be borrowed from a PluginPtr of
+/// type P, which is an rvalue unless P is an lvalue reference type
+template <typename P, typename = void>
+struct CanBorrow : std::false_type { };
+
+template <typename P>
+struct CanBorrow<P, std::void_t<decltype(
+    std::declval<P>().template Borrow<test::util::DummyIntBase>())>>
+  : std::true_type { };
+
+/////////////////////////////////////////////////
+TEST(PluginPtr, Borrow)
+{
+  using Borrowed =
+      ignition::plugin::PluginPtr::Borrowed<test::util::DummyIntBase>;
+  static_assert(!std::is_copy_constructible<Borrowed>::value,
+                "Borrowed interfaces must not be copied");
+  static_assert(!std::is_move_constructible<Borrowed>::value,
+                "Borrowed interfaces must not be moved");
+  static_assert(CanBorrow<const ignition::plugin::PluginPtr&>::value,
+                "Interfaces must be borrowed from lvalues");
+  static_assert(!CanBorrow<ignition::plugin::PluginPtr>::value,
+                "Interfaces must not be borrowed from temporaries");
+  static_assert(std::is_same<
+      ignition::plugin::ConstPluginPtr::Borrowed<test::util::DummyIntBase>,
+      ignition::plugin::BorrowedInterface<const test::util::DummyIntBase>
+      >::value, "A ConstPluginPtr lends const interfaces");
+
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  SomeSpecializedPluginPtr plugin =
+      pl.Instantiate("test::util::DummyMultiPlugin");
+  ASSERT_FALSE(plugin.IsEmpty());
+
+  {
+    // The specialized interfaces are borrowed through their fast path
+    usedSpecializedInterfaceAccess = false;
+    const auto setter = plugin.Borrow<test::util::DummySetterBase>();
+    EXPECT_TRUE(usedSpecializedInterfaceAccess);
+    ASSERT_TRUE(setter);
+    setter->SetIntegerValue(7);
+
+    const auto getter = plugin.Borrow<test::util::DummyIntBase>();
+    ASSERT_TRUE(getter);
+    EXPECT_EQ(plugin->QueryInterface<test::util::DummyIntBase>(),
+              getter.Get());
+    EXPECT_EQ(7, (*getter).MyIntegerValueIs());
+
+    EXPECT_FALSE(plugin.Borrow<SomeInterface>());
+  }
+
+  const ignition::plugin::ConstPluginPtr constPlugin = plugin;
+  const auto constGetter = constPlugin.Borrow<test::util::DummyIntBase>();
+  ASSERT_TRUE(constGetter);
+  EXPECT_EQ(7, constGetter->MyIntegerValueIs());
+
+  // Borrowing from an empty PluginPtr gives nothing
+  const ignition::plugin::PluginPtr empty;
+  EXPECT_FALSE(empty.Borrow<test::util::DummyIntBase>());
+}
+
 /////////////////////////////////////////////////
 ignition::plugin::PluginPtr GetSomePlugin(const std::string &path)
 {
@@ -526,10 +1096,21 @@ TEST(PluginPtr, LibraryManagement)
     pl.LoadLib(path);
 
     CHECK_FOR_LIBRARY(path, true);
+    EXPECT_EQ(3u, pl.PluginsImplementing<test::util::DummyNameBase>().size());
 
     EXPECT_TRUE(pl.ForgetLibrary(path));
 
     CHECK_FOR_LIBRARY(path, false);
+
+    // The interface index should be cleared along with the library
+    EXPECT_TRUE(pl.PluginsImplementing<test::util::DummyNameBase>().empty());
+    EXPECT_TRUE(pl.PluginsImplementing("test::util::DummyNameBase").empty());
+    EXPECT_TRUE((pl.PluginsImplementing<test::util::DummyNameBase,
+                                        test::util::DummyIntBase>().empty()));
+    EXPECT_FALSE(pl.PluginImplements(
+                   "test::util::DummyMultiPlugin", "test::util::DummyIntBase"));
+    EXPECT_TRUE(pl.AllPlugins().empty());
+    EXPECT_TRUE(pl.InterfacesImplemented().empty());
   }
 
   // Test that we can forget libraries, but the library will remain loaded if
@@ -606,6 +1187,804 @@ TEST(PluginPtr, LibraryManagement)
   CHECK_FOR_LIBRARY(path, false);
 }
 
+/////////////////////////////////////////////////
+TEST(Loader, LoadOptions)
+{
+  ignition::plugin::Loader pl;
+
+  // The defaults match the traditional behavior
+  const ignition::plugin::LoadOptions defaults = pl.DefaultLoadOptions();
+  EXPECT_EQ(ignition::plugin::LoadOptions::Binding::LAZY, defaults.binding);
+  EXPECT_EQ(ignition::plugin::LoadOptions::Visibility::LOCAL,
+            defaults.visibility);
+  EXPECT_FALSE(defaults.noDelete);
+  EXPECT_FALSE(defaults.deepBind);
+
+  ignition::plugin::LoadOptions eager;
+  eager.binding = ignition::plugin::LoadOptions::Binding::NOW;
+  pl.SetDefaultLoadOptions(eager);
+  EXPECT_EQ(ignition::plugin::LoadOptions::Binding::NOW,
+            pl.DefaultLoadOptions().binding);
+
+  const std::string path = IGNDummyPlugins_LIB;
+  EXPECT_FALSE(pl.LoadLib(path).empty());
+  CHECK_FOR_LIBRARY(path, true);
+  EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+
+  EXPECT_TRUE(pl.ForgetLibrary(path));
+  CHECK_FOR_LIBRARY(path, false);
+
+  // Options can also be given to a single call
+  EXPECT_FALSE(pl.LoadLib(path, defaults).empty());
+  EXPECT_TRUE(pl.Instantiate("test::util::DummyMultiPlugin"));
+  EXPECT_TRUE(pl.ForgetLibrary(path));
+  CHECK_FOR_LIBRARY(path, false);
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, LibraryStatistics)
+{
+  const std::string path = IGNDummyPlugins_LIB;
+  ignition::plugin::Loader pl;
+  EXPECT_TRUE(pl.Libraries().empty());
+
+  const std::size_t pluginCount = pl.LoadLib(path).size();
+  std::vector<ignition::plugin::LibraryStatistics> libraries = pl.Libraries();
+  ASSERT_EQ(1u, libraries.size());
+  EXPECT_EQ(pluginCount, libraries[0].plugins);
+  EXPECT_EQ(0u, libraries[0].references);
+  EXPECT_FALSE(libraries[0].forgotten);
+  EXPECT_FALSE(libraries[0].path.empty());
+
+  ignition::plugin::PluginPtr first =
+      pl.Instantiate("test::util::DummySinglePlugin");
+  ignition::plugin::PluginPtr second =
+      pl.Instantiate("test::util::DummyMultiPlugin");
+  ignition::plugin::PluginPtr copy = first;
+  const ignition::plugin::PluginHandle handle =
+      pl.Resolve("test::util::DummyMultiPlugin");
+
+  libraries = pl.Libraries();
+  ASSERT_EQ(1u, libraries.size());
+  EXPECT_EQ(3u, libraries[0].references);
+
+  // The instances keep the forgotten library open
+  EXPECT_TRUE(pl.ForgetLibrary(path));
+  libraries = pl.Libraries();
+  ASSERT_EQ(1u, libraries.size());
+  EXPECT_TRUE(libraries[0].forgotten);
+  EXPECT_EQ(0u, libraries[0].plugins);
+  EXPECT_EQ(3u, libraries[0].references);
+
+  first.Clear();
+  copy.Clear();
+  second.Clear();
+  libraries = pl.Libraries();
+  ASSERT_EQ(1u, libraries.size());
+  EXPECT_EQ(1u, libraries[0].references);
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, EvictIdleLibraries)
+{
+  const std::string dummyPath = IGNDummyPlugins_LIB;
+  const std::string factoryPath = IGNFactoryPlugins_LIB;
+
+  ignition::plugin::Loader pl;
+  ignition::plugin::EvictionPolicy policy;
+  policy.maxLibraries = 1;
+  pl.SetEvictionPolicy(policy);
+
+  EXPECT_FALSE(pl.LoadLib(dummyPath).empty());
+  ignition::plugin::PluginPtr instance =
+      pl.Instantiate("test::util::DummySinglePlugin");
+  ASSERT_TRUE(instance);
+
+  // The dummy library is in use, so it cannot make room for the other one,
+  // and the other one is kept because it has just been loaded
+  const std::unordered_set<std::string> factoryPlugins =
+      pl.LoadLib(factoryPath);
+  ASSERT_FALSE(factoryPlugins.empty());
+  EXPECT_EQ(2u, pl.Libraries().size());
+  const std::size_t pluginCount = pl.AllPlugins().size();
+
+  // Only the factory library is idle
+  EXPECT_EQ(1u, pl.EvictIdleLibraries());
+  CHECK_FOR_LIBRARY(factoryPath, false);
+  std::vector<ignition::plugin::LibraryStatistics> libraries =
+      pl.Libraries();
+  ASSERT_EQ(1u, libraries.size());
+  EXPECT_NE(std::string::npos, libraries[0].path.find("DummyPlugins"));
+
+  // The plugins of the evicted library are still known
+  EXPECT_EQ(pluginCount, pl.AllPlugins().size());
+  EXPECT_EQ(0u, pl.EvictIdleLibraries());
+
+  // Instantiating one of them opens the library again, which evicts the
+  // dummy library once it is idle
+  instance.Clear();
+  instance = pl.Instantiate(*factoryPlugins.begin());
+  ASSERT_TRUE(instance);
+  CHECK_FOR_LIBRARY(dummyPath, false);
+
+  libraries = pl.Libraries();
+  ASSERT_EQ(1u, libraries.size());
+  EXPECT_NE(std::string::npos, libraries[0].path.find("FactoryPlugins"));
+  EXPECT_EQ(1u, libraries[0].references);
+
+  // Turning the policy off stops the eviction
+  pl.SetEvictionPolicy(ignition::plugin::EvictionPolicy());
+  EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+  instance.Clear();
+  EXPECT_EQ(0u, pl.EvictIdleLibraries());
+  EXPECT_EQ(2u, pl.Libraries().size());
+
+  EXPECT_TRUE(pl.ForgetLibrary(dummyPath));
+  EXPECT_TRUE(pl.ForgetLibrary(factoryPath));
+  EXPECT_TRUE(pl.AllPlugins().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, DeferUnload)
+{
+  const std::string path = IGNDummyPlugins_LIB;
+  ignition::plugin::LoadOptions options;
+  options.deferUnload = true;
+
+  ignition::plugin::Loader::FlushUnloadQueue();
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_FALSE(pl.LoadLib(path, options).empty());
+    EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+  }
+
+  // Releasing the last reference only posts the library to the queue
+  CHECK_FOR_LIBRARY(path, true);
+  EXPECT_EQ(1u, ignition::plugin::Loader::FlushUnloadQueue());
+  CHECK_FOR_LIBRARY(path, false);
+  EXPECT_EQ(0u, ignition::plugin::Loader::FlushUnloadQueue());
+
+  // A background thread closes the library without being asked
+  ignition::plugin::Loader::SetBackgroundUnloading(true);
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_FALSE(pl.LoadLib(path, options).empty());
+  }
+
+#ifdef RTLD_NOLOAD
+  for (int i = 0; i < 100; ++i)
+  {
+    void *dlHandle = dlopen(path.c_str(), RTLD_NOLOAD | RTLD_LAZY);
+    if (!dlHandle)
+      break;
+
+    dlclose(dlHandle);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+#endif
+
+  CHECK_FOR_LIBRARY(path, false);
+  ignition::plugin::Loader::SetBackgroundUnloading(false);
+  EXPECT_EQ(0u, ignition::plugin::Loader::FlushUnloadQueue());
+}
+
+/////////////////////////////////////////////////
+class StepRecorder : public ignition::plugin::TraceObserver
+{
+  public: void OnTraceEvent(
+      const ignition::plugin::TraceEvent &_event) override
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->steps.insert(_event.name);
+    EXPECT_GE(_event.duration, 0);
+  }
+
+  public: std::mutex mutex;
+  public: std::unordered_set<std::string> steps;
+};
+
+/////////////////////////////////////////////////
+TEST(Loader, Trace)
+{
+  StepRecorder recorder;
+  ignition::plugin::SetTraceObserver(&recorder);
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_FALSE(pl.LoadLib(IGNDummyPlugins_LIB).empty());
+    EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+    EXPECT_TRUE(pl.ForgetLibrary(IGNDummyPlugins_LIB));
+  }
+  ignition::plugin::SetTraceObserver(nullptr);
+
+  for (const char *step : {"LoadLib", "dlopen", "LoadPlugins",
+       "IgnitionPluginHook", "CopyInfo", "Demangle", "CommitLib",
+       "Instantiate", "Create", "ForgetLibrary"})
+  {
+    EXPECT_EQ(1u, recorder.steps.count(step)) << step;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, LatencyMonitor)
+{
+  using ignition::plugin::LatencySummary;
+
+  std::vector<std::string> slow;
+  StepRecorder recorder;
+  ignition::plugin::LatencyMonitor monitor(
+        [&](const ignition::plugin::TraceEvent &_event)
+        {
+          slow.push_back(std::string(_event.name) + " " +
+                         std::string(_event.detail));
+        }, &recorder);
+
+  // Every instantiation takes longer than a nanosecond, but no library is
+  // loaded in an hour
+  EXPECT_TRUE(monitor.SetThreshold("Instantiate", std::chrono::nanoseconds(1)));
+  EXPECT_TRUE(monitor.SetThreshold("LoadLib", std::chrono::hours(1)));
+  EXPECT_FALSE(monitor.SetThreshold("dlopen", std::chrono::hours(1)));
+
+  ignition::plugin::SetTraceObserver(&monitor);
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_FALSE(pl.LoadLib(IGNDummyPlugins_LIB).empty());
+    for (std::size_t i = 0; i < 3; ++i)
+      EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+    EXPECT_TRUE(pl.ForgetLibrary(IGNDummyPlugins_LIB));
+  }
+  ignition::plugin::SetTraceObserver(nullptr);
+
+  const LatencySummary loadLib = monitor.Summary("LoadLib");
+  EXPECT_EQ(1u, loadLib.count);
+  EXPECT_GT(loadLib.max, 0);
+  EXPECT_EQ(loadLib.max, loadLib.p99);
+
+  const LatencySummary instantiate = monitor.Summary("Instantiate");
+  EXPECT_EQ(3u, instantiate.count);
+  EXPECT_LE(instantiate.p50, instantiate.p99);
+  EXPECT_LE(instantiate.p99, instantiate.max);
+  EXPECT_EQ(1u, monitor.Summary("ForgetLibrary").count);
+  EXPECT_EQ(0u, monitor.Summary("dlopen").count);
+
+  // Only the slow steps are reported, along with what they worked on
+  ASSERT_EQ(3u, slow.size());
+  for (const std::string &step : slow)
+    EXPECT_EQ("Instantiate test::util::DummySinglePlugin", step);
+
+  // The events are passed on to the next observer
+  EXPECT_EQ(1u, recorder.steps.count("dlopen"));
+
+  monitor.Reset();
+  EXPECT_EQ(0u, monitor.Summary("Instantiate").count);
+  EXPECT_EQ(0, monitor.Summary("Instantiate").max);
+
+  // The percentiles are accurate to within 1/8 of their value
+  for (std::int64_t duration = 1000; duration >= 1; --duration)
+    monitor.OnTraceEvent({"ForgetLibrary", "", 0, duration});
+
+  const LatencySummary forget = monitor.Summary("ForgetLibrary");
+  EXPECT_EQ(1000u, forget.count);
+  EXPECT_GE(forget.p50, 500);
+  EXPECT_LE(forget.p50, 500 + 500 / 8);
+  EXPECT_GE(forget.p99, 990);
+  EXPECT_LE(forget.p99, 1000);
+  EXPECT_EQ(1000, forget.max);
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, SharedLibraryCache)
+{
+  const std::string &libraryPath = IGNDummyPlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  {
+    ignition::plugin::Loader first;
+    EXPECT_FALSE(first.LoadLib(libraryPath).empty());
+
+    // A second Loader opens the library for itself, but it does not need to
+    // look into it again
+    StepRecorder recorder;
+    ignition::plugin::SetTraceObserver(&recorder);
+    ignition::plugin::Loader second;
+    EXPECT_FALSE(second.LoadLib(libraryPath).empty());
+    ignition::plugin::SetTraceObserver(nullptr);
+
+    EXPECT_EQ(1u, recorder.steps.count("dlopen"));
+    EXPECT_EQ(1u, recorder.steps.count("CommitLib"));
+    EXPECT_EQ(0u, recorder.steps.count("LoadPlugins"));
+    EXPECT_EQ(0u, recorder.steps.count("Demangle"));
+
+    // Each Loader still has its own view of the libraries that it loaded
+    EXPECT_TRUE(first.ForgetLibrary(libraryPath));
+    EXPECT_FALSE(first.Instantiate("test::util::DummySinglePlugin"));
+    EXPECT_EQ(1u, second.AllPlugins().count("test::util::DummySinglePlugin"));
+
+    ignition::plugin::PluginPtr plugin =
+        second.Instantiate("test::util::DummySinglePlugin");
+    ASSERT_TRUE(plugin);
+    EXPECT_EQ(std::string("DummySinglePlugin"),
+              plugin->QueryInterface<test::util::DummyNameBase>()
+              ->MyNameIs());
+
+    // The first Loader can take the library back from the second one
+    EXPECT_FALSE(first.LoadLib(libraryPath).empty());
+    EXPECT_TRUE(first.Instantiate("test::util::DummySinglePlugin"));
+  }
+
+  // The library is closed once no Loader needs it anymore, and the next
+  // Loader to open it looks into it again
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  StepRecorder recorder;
+  ignition::plugin::SetTraceObserver(&recorder);
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_FALSE(pl.LoadLib(libraryPath).empty());
+  }
+  ignition::plugin::SetTraceObserver(nullptr);
+  EXPECT_EQ(1u, recorder.steps.count("LoadPlugins"));
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, HugePageText)
+{
+  const std::string &libraryPath = IGNDummyPlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  ignition::plugin::LoadOptions options;
+  EXPECT_FALSE(options.hugePageText);
+  options.hugePageText = true;
+
+  {
+    StepRecorder recorder;
+    ignition::plugin::SetTraceObserver(&recorder);
+    ignition::plugin::Loader first;
+    EXPECT_FALSE(first.LoadLib(libraryPath, options).empty());
+    ignition::plugin::SetTraceObserver(nullptr);
+    EXPECT_EQ(1u, recorder.steps.count("RemapHugePages"));
+
+    // Whether or not the code could be moved, the plugins keep working
+    ignition::plugin::PluginPtr plugin =
+        first.Instantiate("test::util::DummySinglePlugin");
+    ASSERT_TRUE(plugin);
+    EXPECT_EQ(std::string("DummySinglePlugin"),
+              plugin->QueryInterface<test::util::DummyNameBase>()
+              ->MyNameIs());
+
+    // The code of a library which is already open is left alone
+    recorder.steps.clear();
+    ignition::plugin::SetTraceObserver(&recorder);
+    ignition::plugin::Loader second;
+    EXPECT_FALSE(second.LoadLib(libraryPath, options).empty());
+    ignition::plugin::SetTraceObserver(nullptr);
+    EXPECT_EQ(0u, recorder.steps.count("RemapHugePages"));
+  }
+
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, Fork)
+{
+  ignition::plugin::Loader::SetBackgroundUnloading(true);
+
+  ignition::plugin::LoadOptions options;
+  options.deferUnload = true;
+
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_FALSE(pl.LoadLib(IGNDummyPlugins_LIB, options).empty());
+
+    const pid_t child = fork();
+    ASSERT_NE(-1, child);
+    if (0 == child)
+    {
+      // The child inherits the registry, and it can run a background thread of
+      // its own
+      ignition::plugin::Loader::SetBackgroundUnloading(true);
+      const bool instantiated =
+          !pl.Instantiate("test::util::DummySinglePlugin").IsEmpty();
+      const bool forgotten = pl.ForgetLibrary(IGNDummyPlugins_LIB);
+
+      // The library gets closed by the thread of the child
+      bool closed = false;
+      for (int i = 0; i < 200 && !closed; ++i)
+      {
+        void *dlHandle =
+            dlopen(IGNDummyPlugins_LIB, RTLD_NOLOAD | RTLD_LAZY);
+        closed = (nullptr == dlHandle);
+        if (dlHandle)
+        {
+          dlclose(dlHandle);
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+      }
+
+      ignition::plugin::Loader::SetBackgroundUnloading(false);
+      _exit(instantiated && forgotten && closed ? 0 : 1);
+    }
+
+    int status = 0;
+    ASSERT_EQ(child, waitpid(child, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status));
+
+    // The parent still has its registry and its own thread
+    EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+  }
+  ignition::plugin::Loader::SetBackgroundUnloading(false);
+  ignition::plugin::Loader::FlushUnloadQueue();
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, LoadLibs)
+{
+  ignition::plugin::Loader pl;
+  const std::unordered_set<std::string> plugins = pl.LoadLibs(
+        {IGNDummyPlugins_LIB, IGNFactoryPlugins_LIB, IGNTemplatedPlugins_LIB});
+
+  EXPECT_EQ(plugins.size(), pl.AllPlugins().size());
+  EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+  EXPECT_EQ(3u, pl.PluginsImplementing<test::util::DummyNameBase>().size());
+  EXPECT_TRUE(pl.Instantiate("test::util::DummyMultiPlugin"));
+
+  // Libraries that cannot be loaded are skipped
+  EXPECT_TRUE(pl.LoadLibs({"/not/a/library.so"}).empty());
+  EXPECT_TRUE(pl.LoadLibs({}).empty());
+
+  EXPECT_TRUE(pl.ForgetLibrary(IGNFactoryPlugins_LIB));
+  EXPECT_EQ(1u, pl.AllPlugins().count("test::util::DummySinglePlugin"));
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, Transaction)
+{
+  ignition::plugin::Loader pl;
+  std::vector<std::string> messages;
+  pl.SetLogger([&](const std::string &_message)
+  {
+    messages.push_back(_message);
+  });
+
+  ignition::plugin::Loader::Transaction transaction = pl.BeginTransaction();
+  transaction.LoadLib(IGNDummyPlugins_LIB).LoadLib(IGNFactoryPlugins_LIB);
+
+  // Nothing changes until the transaction is committed
+  EXPECT_TRUE(pl.AllPlugins().empty());
+
+  std::unordered_set<std::string> plugins = transaction.Commit();
+  EXPECT_EQ(plugins.size(), pl.AllPlugins().size());
+  EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+  EXPECT_TRUE(pl.Instantiate("test::util::DummyMultiPlugin"));
+
+  // Each alias collision is reported once, for the whole transaction
+  EXPECT_EQ(pl.AmbiguousAliases().size(), messages.size());
+
+  // The changes are applied in order, and a committed transaction can be
+  // used again
+  messages.clear();
+  plugins = transaction.ForgetLibrary(IGNFactoryPlugins_LIB)
+      .LoadLib(IGNTemplatedPlugins_LIB)
+      .ForgetLibrary(IGNDummyPlugins_LIB)
+      .LoadLib(IGNDummyPlugins_LIB)
+      .Commit();
+  EXPECT_EQ(plugins.size(), pl.AllPlugins().size());
+  EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+  EXPECT_EQ(3u, pl.PluginsImplementing<test::util::DummyNameBase>().size());
+  EXPECT_EQ(pl.AmbiguousAliases().size(), messages.size());
+  EXPECT_TRUE(transaction.Commit().empty());
+
+  // A transaction which is not committed is discarded
+  const std::size_t numPlugins = pl.AllPlugins().size();
+  pl.BeginTransaction().ForgetLibrary(IGNDummyPlugins_LIB);
+  EXPECT_EQ(numPlugins, pl.AllPlugins().size());
+
+  pl.SetLogger(nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, LoadLibAsync)
+{
+  ignition::plugin::Loader pl;
+  std::future<std::unordered_set<std::string>> loading =
+      pl.LoadLibAsync(IGNDummyPlugins_LIB);
+
+  const std::unordered_set<std::string> plugins = loading.get();
+  EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+  EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+
+  EXPECT_TRUE(pl.LoadLibAsync("/not/a/library.so").get().empty());
+
+  // Destroying a Loader while it is still loading should wait for the load
+  // to finish instead of crashing.
+  std::future<std::unordered_set<std::string>> abandoned;
+  {
+    ignition::plugin::Loader temporary;
+    abandoned = temporary.LoadLibAsync(IGNFactoryPlugins_LIB);
+  }
+  EXPECT_FALSE(abandoned.get().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, LoadDirectory)
+{
+  const std::string path = IGNDummyPlugins_LIB;
+  const std::string directory = path.substr(0, path.find_last_of("/\\"));
+
+  ignition::plugin::Loader pl;
+  const std::unordered_set<std::string> plugins = pl.LoadDirectory(directory);
+  EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+  EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+
+  EXPECT_TRUE(pl.LoadDirectory("/this/directory/does/not/exist").empty());
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, StringViewLookup)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  // Names are often slices of a larger buffer, which are not null-terminated
+  const std::string buffer =
+      "plugin=test::util::DummySinglePlugin;alias=Foo;alias=Bar;"
+      "interface=test::util::DummyNameBase;";
+  const std::string_view view = buffer;
+  const std::string_view name = view.substr(7, 29);
+  const std::string_view foo = view.substr(43, 3);
+  const std::string_view bar = view.substr(53, 3);
+  const std::string_view interface = view.substr(67, 25);
+
+  EXPECT_EQ("test::util::DummySinglePlugin", pl.LookupPlugin(name));
+  EXPECT_EQ("test::util::DummyMultiPlugin", pl.LookupPlugin(foo));
+  EXPECT_TRUE(pl.LookupPlugin(bar).empty());
+  EXPECT_TRUE(pl.LookupPlugin(name.substr(0, 10)).empty());
+
+  EXPECT_EQ(2u, pl.PluginsWithAlias(bar).size());
+  EXPECT_EQ(1u, pl.PluginsWithAlias(name).count(std::string(name)));
+  EXPECT_EQ(3u, pl.AliasesOfPlugin(name).size());
+  EXPECT_EQ(3u, pl.PluginsImplementing(interface).size());
+
+  ignition::plugin::PluginPtr plugin = pl.Instantiate(name);
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ(std::string(name), *plugin->Name());
+  EXPECT_TRUE(plugin->HasInterface(interface));
+  EXPECT_FALSE(plugin->HasInterface(interface.substr(0, 12)));
+  EXPECT_TRUE(plugin->HasInterface(
+                typeid(test::util::DummyNameBase).name(), false));
+
+  EXPECT_TRUE(pl.Instantiate(foo));
+  EXPECT_FALSE(pl.Instantiate(bar));
+  EXPECT_TRUE(pl.ForgetLibraryOfPlugin(name));
+  EXPECT_FALSE(pl.Instantiate(name));
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, TryLookupPlugin)
+{
+  using LookupStatus = ignition::plugin::Loader::LookupStatus;
+
+  ignition::plugin::Loader pl;
+  std::vector<std::string> messages;
+  pl.SetLogger([&](const std::string &_message)
+  {
+    messages.push_back(_message);
+  });
+
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  // Loading the library reports its ambiguous aliases once
+  EXPECT_FALSE(messages.empty());
+  messages.clear();
+
+  std::string name;
+  EXPECT_EQ(LookupStatus::FOUND, pl.TryLookupPlugin("Foo", &name));
+  EXPECT_EQ("test::util::DummyMultiPlugin", name);
+  EXPECT_EQ(LookupStatus::FOUND,
+            pl.TryLookupPlugin("test::util::DummySinglePlugin"));
+  EXPECT_EQ(LookupStatus::AMBIGUOUS_ALIAS, pl.TryLookupPlugin("Bar", &name));
+  EXPECT_EQ(LookupStatus::NOT_FOUND, pl.TryLookupPlugin("Nope", &name));
+  EXPECT_EQ("test::util::DummyMultiPlugin", name);
+
+  ignition::plugin::PluginPtr plugin;
+  EXPECT_EQ(LookupStatus::NOT_FOUND, pl.TryInstantiate("Nope", plugin));
+  EXPECT_EQ(LookupStatus::AMBIGUOUS_ALIAS, pl.TryInstantiate("Bar", plugin));
+  EXPECT_FALSE(plugin);
+  EXPECT_EQ(LookupStatus::FOUND, pl.TryInstantiate("Foo", plugin));
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ("test::util::DummyMultiPlugin", *plugin->Name());
+
+  SomeSpecializedPluginPtr specialized;
+  EXPECT_EQ(LookupStatus::FOUND, pl.TryInstantiate("Foo", specialized));
+  EXPECT_TRUE(specialized->HasInterface<test::util::DummyIntBase>());
+
+  // None of the Try functions produce any messages
+  EXPECT_TRUE(messages.empty());
+
+  // The other lookup functions report their failures to the logger
+  EXPECT_TRUE(pl.LookupPlugin("Nope").empty());
+  EXPECT_FALSE(pl.Instantiate("Bar"));
+  ASSERT_EQ(2u, messages.size());
+  EXPECT_NE(std::string::npos, messages[0].find("[Nope]"));
+  EXPECT_NE(std::string::npos,
+            messages[1].find("[test::util::DummySinglePlugin]"));
+
+  // A rate limit drops the messages which exceed it
+  messages.clear();
+  pl.SetLogger([&](const std::string &_message)
+  {
+    messages.push_back(_message);
+  }, 2);
+
+  for (std::size_t i = 0; i < 10; ++i)
+    EXPECT_TRUE(pl.LookupPlugin("Nope").empty());
+  EXPECT_EQ(2u, messages.size());
+
+  pl.SetLogger(nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, ConcurrentAccess)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  std::atomic<bool> running(true);
+
+  // Threads that keep instantiating a plugin while another thread loads and
+  // forgets a different library.
+  std::vector<std::thread> readers;
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    readers.emplace_back([&]()
+    {
+      while (running)
+      {
+        ignition::plugin::PluginPtr plugin =
+            pl.Instantiate("test::util::DummySinglePlugin");
+        ASSERT_TRUE(plugin);
+        EXPECT_TRUE(plugin->HasInterface<test::util::DummyNameBase>());
+        EXPECT_EQ(3u, pl.PluginsImplementing<
+                  test::util::DummyNameBase>().size());
+      }
+    });
+  }
+
+  for (std::size_t i = 0; i < 20; ++i)
+  {
+    EXPECT_FALSE(pl.LoadLib(IGNFactoryPlugins_LIB).empty());
+    EXPECT_TRUE(pl.ForgetLibrary(IGNFactoryPlugins_LIB));
+  }
+
+  running = false;
+  for (std::thread &reader : readers)
+    reader.join();
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, NameViews)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNDummyPlugins_LIB);
+
+  // Every view has the same names as the set which the Loader would copy
+  const auto expectSame = [](const ignition::plugin::NameView &_view,
+                             const auto &_set)
+  {
+    EXPECT_EQ(_set.size(), _view.size());
+    EXPECT_EQ(_set.empty(), _view.empty());
+    std::size_t visited = 0;
+    for (const std::string_view name : _view)
+    {
+      EXPECT_EQ(1u, _set.count(std::string(name))) << name;
+      ++visited;
+    }
+    EXPECT_EQ(_set.size(), visited);
+  };
+
+  expectSame(pl.PluginsImplementingView("test::util::DummyNameBase"),
+             pl.PluginsImplementing("test::util::DummyNameBase"));
+  expectSame(pl.PluginsImplementingView<test::util::DummyNameBase>(),
+             pl.PluginsImplementing<test::util::DummyNameBase>());
+  expectSame(pl.PluginsImplementingView("not an interface"),
+             pl.PluginsImplementing("not an interface"));
+
+  for (const char *alias : {"Bar", "Foo", "fake alias",
+                            "test::util::DummySinglePlugin"})
+    expectSame(pl.PluginsWithAliasView(alias), pl.PluginsWithAlias(alias));
+
+  for (const char *plugin : {"test::util::DummySinglePlugin",
+                             "test::util::DummyNoAliasPlugin", "fake::plugin"})
+    expectSame(pl.AliasesOfPluginView(plugin), pl.AliasesOfPlugin(plugin));
+
+  EXPECT_TRUE(pl.AliasesOfPluginView("test::util::DummyMultiPlugin")
+              .Contains("Foo"));
+  EXPECT_FALSE(pl.AliasesOfPluginView("test::util::DummyMultiPlugin")
+               .Contains("Alternative name"));
+
+  // A view is a snapshot, so the registry does not change until it is gone
+  std::future<bool> forgotten;
+  {
+    ignition::plugin::NameView view =
+        pl.PluginsImplementingView("test::util::DummyNameBase");
+    ASSERT_EQ(3u, view.size());
+
+    forgotten = std::async(std::launch::async, [&pl]()
+    {
+      return pl.ForgetLibrary(IGNDummyPlugins_LIB);
+    });
+
+    EXPECT_EQ(std::future_status::timeout,
+              forgotten.wait_for(std::chrono::milliseconds(50)));
+    EXPECT_EQ(3u, view.size());
+    for (const std::string_view name : view)
+      EXPECT_FALSE(name.empty());
+  }
+
+  EXPECT_TRUE(forgotten.get());
+  EXPECT_TRUE(pl.PluginsImplementingView("test::util::DummyNameBase").empty());
+  EXPECT_TRUE(pl.PluginsWithAliasView("Bar").empty());
+  EXPECT_TRUE(pl.AliasesOfPluginView("test::util::DummySinglePlugin").empty());
+}
+
+/////////////////////////////////////////////////
+TEST(Loader, DestructionQueue)
+{
+  const std::string &libraryPath = IGNDummyPlugins_LIB;
+  const std::string name = "test::util::DummySinglePlugin";
+
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_FALSE(pl.LoadLib(libraryPath).empty());
+    EXPECT_EQ(0u, pl.DestructionWorkers());
+    EXPECT_EQ(0u, pl.FlushDestructionQueue());
+
+    std::vector<ignition::plugin::PluginPtr> plugins;
+    for (std::size_t i = 0; i < 1000; ++i)
+      plugins.push_back(pl.Instantiate(name));
+
+    // Without workers, the instances wait until the queue is flushed
+    ignition::plugin::PluginPtr kept = plugins.front();
+    ignition::plugin::PluginPtr single = pl.Instantiate(name);
+    pl.Discard(std::move(plugins));
+    pl.Discard(std::move(single));
+    EXPECT_TRUE(plugins.empty());
+    EXPECT_FALSE(single);
+
+    EXPECT_EQ(1001u, pl.FlushDestructionQueue());
+    EXPECT_EQ(0u, pl.FlushDestructionQueue());
+
+    // The queue only drops its own reference
+    ASSERT_TRUE(kept);
+    EXPECT_EQ(std::string("DummySinglePlugin"),
+              kept->QueryInterface<test::util::DummyNameBase>()->MyNameIs());
+
+    // Workers drain the queue on their own, and a flush waits for them
+    pl.SetDestructionWorkers(4);
+    EXPECT_EQ(4u, pl.DestructionWorkers());
+    for (int round = 0; round < 10; ++round)
+    {
+      for (std::size_t i = 0; i < 1000; ++i)
+        plugins.push_back(pl.Instantiate(name));
+      pl.Discard(std::move(plugins));
+    }
+    EXPECT_LE(pl.FlushDestructionQueue(), 10000u);
+    EXPECT_EQ(0u, pl.FlushDestructionQueue());
+
+    pl.SetDestructionWorkers(0);
+    EXPECT_EQ(0u, pl.DestructionWorkers());
+
+    // Instances which are still queued are destroyed with the Loader
+    kept = ignition::plugin::PluginPtr();
+    for (std::size_t i = 0; i < 100; ++i)
+      plugins.push_back(pl.Instantiate(name));
+    pl.Discard(std::move(plugins));
+    pl.SetDestructionWorkers(2);
+  }
+
+  CHECK_FOR_LIBRARY(libraryPath, false);
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/Warmup.hh>
+
+#include "../plugins/RecyclablePlugins.hh"
+
+using ignition::plugin::Loader;
+using ignition::plugin::PluginPtr;
+using test::plugins::Scratchpad;
+
+const char *const warm = "test::plugins::WarmScratchpad";
+const char *const warmStatic = "test::plugins::WarmStaticScratchpad";
+const char *const disposable = "test::plugins::DisposableScratchpad";
+
+/////////////////////////////////////////////////
+TEST(Prewarm, DetectWarmup)
+{
+  Loader pl;
+  pl.LoadLib(IGNRecyclablePlugins_LIB);
+
+  // Plugins which inherit Warmup provide it without listing it, whether
+  // they are registered with an Info or with a descriptor
+  const std::unordered_set<std::string> warmable =
+      pl.PluginsImplementing<ignition::plugin::Warmup>();
+  EXPECT_EQ(2u, warmable.size());
+  EXPECT_EQ(1u, warmable.count(warm));
+  EXPECT_EQ(1u, warmable.count(warmStatic));
+
+  PluginPtr plugin = pl.Instantiate(warmStatic);
+  ASSERT_TRUE(plugin);
+  EXPECT_TRUE(plugin->HasInterface<ignition::plugin::Warmup>());
+  EXPECT_TRUE(plugin->HasInterface<Scratchpad>());
+}
+
+/////////////////////////////////////////////////
+TEST(Prewarm, Instances)
+{
+  Loader pl;
+  pl.LoadLib(IGNRecyclablePlugins_LIB);
+
+  for (const bool lockCode : {false, true})
+  {
+    const std::vector<PluginPtr> plugins =
+        pl.Prewarm({warm, warmStatic, disposable, "not a plugin"}, lockCode);
+    ASSERT_EQ(4u, plugins.size());
+
+    // Every instance is warmed up exactly once
+    ASSERT_TRUE(plugins[0]);
+    EXPECT_EQ(1u, plugins[0]->QueryInterface<Scratchpad>()->WarmUps());
+    ASSERT_TRUE(plugins[1]);
+    EXPECT_EQ(1u, plugins[1]->QueryInterface<Scratchpad>()->WarmUps());
+
+    // Plugins without Warmup are still instantiated
+    ASSERT_TRUE(plugins[2]);
+    EXPECT_EQ(0u, plugins[2]->QueryInterface<Scratchpad>()->WarmUps());
+
+    EXPECT_FALSE(plugins[3]);
+  }
+
+  // Regular instances are not warmed up
+  PluginPtr plugin = pl.Instantiate(warm);
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ(0u, plugin->QueryInterface<Scratchpad>()->WarmUps());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/DummyPlugins.hh"
+
+/////////////////////////////////////////////////
+/// \brief Replace a library file with another one. The file is replaced
+/// instead of overwritten, the way that linkers do it, because the old
+/// version is still mapped into memory.
+void ReplaceLibrary(const std::string &_from, const std::string &_to)
+{
+  namespace fs = std::filesystem;
+
+  const fs::file_time_type time = fs::last_write_time(_to);
+  fs::remove(_to);
+  fs::copy_file(_from, _to);
+
+  // Make sure that the change can be detected even on file systems with a
+  // coarse clock.
+  fs::last_write_time(_to, time + std::chrono::seconds(1));
+}
+
+/////////////////////////////////////////////////
+TEST(Reload, HandOverState)
+{
+  namespace fs = std::filesystem;
+
+  const fs::path directory =
+      fs::temp_directory_path() / "ign_plugin_reload_test";
+  fs::remove_all(directory);
+  ASSERT_TRUE(fs::create_directory(directory));
+
+  const std::string path =
+      (directory / fs::path(IGNReloadablePluginV1_LIB).filename()).string();
+  fs::copy_file(IGNReloadablePluginV1_LIB, path);
+
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_EQ(1u, pl.LoadLib(path).count("test::util::ReloadablePlugin"));
+
+    ignition::plugin::PluginPtr old =
+        pl.Instantiate("test::util::ReloadablePlugin");
+    ASSERT_TRUE(old);
+    old->QueryInterface<test::util::DummySetterBase>()->SetIntegerValue(42);
+
+    // The file has not changed yet
+    EXPECT_TRUE(pl.ReloadLib(path).empty());
+
+    ReplaceLibrary(IGNReloadablePluginV2_LIB, path);
+    EXPECT_EQ(1u, pl.ReloadLib(path).count("test::util::ReloadablePlugin"));
+
+    ignition::plugin::PluginPtr fresh = pl.Reinstantiate(old);
+    ASSERT_TRUE(fresh);
+    EXPECT_DOUBLE_EQ(2.0, fresh->QueryInterface<test::util::DummyDoubleBase>()
+                     ->MyDoubleValueIs());
+    EXPECT_EQ(42, fresh->QueryInterface<test::util::DummyIntBase>()
+              ->MyIntegerValueIs());
+
+    // The old instance still uses the old version
+    EXPECT_DOUBLE_EQ(1.0, old->QueryInterface<test::util::DummyDoubleBase>()
+                     ->MyDoubleValueIs());
+
+    // New instances come from the new version
+    ignition::plugin::PluginPtr other =
+        pl.Instantiate("test::util::ReloadablePlugin");
+    ASSERT_TRUE(other);
+    EXPECT_DOUBLE_EQ(2.0, other->QueryInterface<test::util::DummyDoubleBase>()
+                     ->MyDoubleValueIs());
+
+    // The reloaded library is forgotten by its original path
+    EXPECT_TRUE(pl.ForgetLibrary(path));
+    EXPECT_TRUE(pl.LookupPlugin("test::util::ReloadablePlugin").empty());
+  }
+
+  fs::remove_all(directory);
+}
+
+/////////////////////////////////////////////////
+TEST(Reload, UnknownLibrary)
+{
+  ignition::plugin::Loader pl;
+  EXPECT_TRUE(pl.ReloadLib(IGNReloadablePluginV1_LIB).empty());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/RemotePlugin.hh>
+
+#include "../plugins/RemotePlugins.hh"
+#include "utils.hh"
+
+using ignition::plugin::Loader;
+using ignition::plugin::RemoteOptions;
+using ignition::plugin::RemotePlugin;
+using ignition::plugin::RemoteStatus;
+
+using namespace test::plugins;
+
+/////////////////////////////////////////////////
+TEST(RemotePlugin, NotRemoteCallable)
+{
+  const std::string &libraryPath = IGNRemotePlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  Loader loader;
+  loader.LoadLib(libraryPath);
+
+  RemotePlugin missing = loader.InstantiateRemote("no::such::Plugin");
+  EXPECT_FALSE(missing);
+  EXPECT_EQ(-1, missing.ProcessId());
+
+  RemotePlugin abacus = loader.InstantiateRemote("test::plugins::Abacus");
+  EXPECT_FALSE(abacus);
+
+  double result = 0.0;
+  EXPECT_EQ(RemoteStatus::NOT_RUNNING,
+            abacus.Call(CALCULATOR_ADD, Operands{1.0, 2.0}, result));
+  EXPECT_FALSE(abacus.Restart());
+}
+
+// Remote plugins only run on Linux
+#ifdef __linux__
+/////////////////////////////////////////////////
+TEST(RemotePlugin, Calls)
+{
+  const std::string &libraryPath = IGNRemotePlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  Loader loader;
+  loader.LoadLib(libraryPath);
+
+  RemotePlugin calculator =
+      loader.InstantiateRemote("test::plugins::Calculator");
+  ASSERT_TRUE(calculator);
+  EXPECT_NE(getpid(), calculator.ProcessId());
+
+  int pid = 0;
+  ASSERT_EQ(RemoteStatus::OK, calculator.Call(CALCULATOR_PID, 0, pid));
+  EXPECT_EQ(calculator.ProcessId(), pid);
+
+  double result = 0.0;
+  EXPECT_EQ(RemoteStatus::OK,
+            calculator.Call(CALCULATOR_ADD, Operands{1.5, 2.0}, result));
+  EXPECT_DOUBLE_EQ(3.5, result);
+
+  // The arguments are written straight into the shared memory
+  const std::size_t count = calculator.SlotSize() / sizeof(double);
+  result = 0.0;
+  EXPECT_EQ(RemoteStatus::OK, calculator.CallInPlace(
+        CALCULATOR_SUM, count * sizeof(double),
+        [&](void *_input)
+        {
+          double *values = static_cast<double *>(_input);
+          for (std::size_t i = 0; i < count; ++i)
+            values[i] = static_cast<double>(i);
+        },
+        [&](const void *_output, const std::size_t _size)
+        {
+          ASSERT_EQ(sizeof(double), _size);
+          std::memcpy(&result, _output, sizeof(result));
+        }));
+  EXPECT_DOUBLE_EQ(count * (count - 1) / 2.0, result);
+
+  // One-way calls are handled in order, and more of them can be queued than
+  // there are slots
+  for (int i = 1; i <= 100; ++i)
+  {
+    const double value = i;
+    EXPECT_EQ(RemoteStatus::OK, calculator.Send(
+          CALCULATOR_ACCUMULATE, &value, sizeof(value)));
+  }
+  EXPECT_EQ(RemoteStatus::OK, calculator.Call(CALCULATOR_TOTAL, 0, result));
+  EXPECT_DOUBLE_EQ(5050.0, result);
+
+  // Failures of single calls leave the plugin running
+  const std::vector<char> tooLarge(calculator.SlotSize() + 1);
+  EXPECT_EQ(RemoteStatus::TOO_LARGE, calculator.Call(
+        CALCULATOR_SUM, tooLarge.data(), tooLarge.size(),
+        &result, sizeof(result)));
+  EXPECT_EQ(RemoteStatus::FAILED, calculator.Call(999, 0, result));
+
+  char small = 0;
+  EXPECT_EQ(RemoteStatus::FAILED,
+            calculator.Call(CALCULATOR_ADD, Operands{1.0, 1.0}, small));
+  EXPECT_TRUE(calculator);
+
+  // The process stops along with the plugin
+  RemotePlugin moved(std::move(calculator));
+  EXPECT_FALSE(calculator);
+  ASSERT_TRUE(moved);
+  const int movedPid = moved.ProcessId();
+  moved = RemotePlugin();
+  EXPECT_FALSE(moved);
+  EXPECT_NE(0, kill(movedPid, 0));
+}
+
+/////////////////////////////////////////////////
+TEST(RemotePlugin, Crash)
+{
+  const std::string &libraryPath = IGNRemotePlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  Loader loader;
+  loader.LoadLib(libraryPath);
+
+  RemotePlugin calculator =
+      loader.InstantiateRemote("test::plugins::Calculator");
+  ASSERT_TRUE(calculator);
+  const int firstPid = calculator.ProcessId();
+
+  int pid = 0;
+  EXPECT_EQ(RemoteStatus::DIED, calculator.Call(CALCULATOR_CRASH, 0, pid));
+  EXPECT_FALSE(calculator);
+  EXPECT_EQ(-1, calculator.ProcessId());
+
+  double result = 0.0;
+  EXPECT_EQ(RemoteStatus::NOT_RUNNING,
+            calculator.Call(CALCULATOR_ADD, Operands{1.0, 2.0}, result));
+
+  // A new process gets a fresh instance
+  ASSERT_TRUE(calculator.Restart());
+  EXPECT_NE(firstPid, calculator.ProcessId());
+  EXPECT_EQ(RemoteStatus::OK,
+            calculator.Call(CALCULATOR_ADD, Operands{1.0, 2.0}, result));
+  EXPECT_DOUBLE_EQ(3.0, result);
+  EXPECT_EQ(RemoteStatus::OK, calculator.Call(CALCULATOR_TOTAL, 0, result));
+  EXPECT_DOUBLE_EQ(0.0, result);
+}
+
+/////////////////////////////////////////////////
+TEST(RemotePlugin, OutlivesLoader)
+{
+  const std::string &libraryPath = IGNRemotePlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  RemotePlugin calculator;
+  {
+    Loader loader;
+    loader.LoadLib(libraryPath);
+    calculator = loader.InstantiateRemote("test::plugins::Calculator");
+    ASSERT_TRUE(calculator);
+  }
+
+  // The plugin was resolved before the fork, so restarting it does not need
+  // the Loader
+  int pid = 0;
+  EXPECT_EQ(RemoteStatus::DIED, calculator.Call(CALCULATOR_CRASH, 0, pid));
+  ASSERT_TRUE(calculator.Restart());
+
+  double result = 0.0;
+  EXPECT_EQ(RemoteStatus::OK,
+            calculator.Call(CALCULATOR_ADD, Operands{1.0, 2.0}, result));
+  EXPECT_DOUBLE_EQ(3.0, result);
+}
+
+/////////////////////////////////////////////////
+TEST(RemotePlugin, Timeout)
+{
+  const std::string &libraryPath = IGNRemotePlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  Loader loader;
+  loader.LoadLib(libraryPath);
+
+  RemoteOptions options;
+  options.timeout = std::chrono::milliseconds(1000);
+  RemotePlugin calculator =
+      loader.InstantiateRemote("test::plugins::Calculator", options);
+  ASSERT_TRUE(calculator);
+
+  // A call which is far shorter than the timeout, even on a loaded machine
+  int sleep = 1;
+  int none = 0;
+  std::size_t size = 1;
+  EXPECT_EQ(RemoteStatus::OK, calculator.Call(
+        CALCULATOR_SLEEP, &sleep, sizeof(sleep), &none, sizeof(none), &size));
+  EXPECT_EQ(0u, size);
+
+  // A call which is far longer than the timeout
+  sleep = 60000;
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(RemoteStatus::TIMED_OUT, calculator.Call(
+        CALCULATOR_SLEEP, &sleep, sizeof(sleep), &none, sizeof(none)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::seconds(30));
+  EXPECT_FALSE(calculator);
+}
+
+/////////////////////////////////////////////////
+TEST(RemotePlugin, StartTimeout)
+{
+  const std::string &libraryPath = IGNRemotePlugins_LIB;
+  CHECK_FOR_LIBRARY(libraryPath, false);
+
+  Loader loader;
+  loader.LoadLib(libraryPath);
+
+  // The calls may take forever, but the start may not
+  RemoteOptions options;
+  options.timeout = std::chrono::milliseconds(0);
+  options.startTimeout = std::chrono::milliseconds(100);
+
+  const auto start = std::chrono::steady_clock::now();
+  RemotePlugin stalled =
+      loader.InstantiateRemote("test::plugins::Stalled", options);
+  EXPECT_FALSE(stalled);
+  EXPECT_EQ(-1, stalled.ProcessId());
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::seconds(2));
+}
+#endif
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+
+#include "ignition/plugin/Loader.hh"
+
+/////////////////////////////////////////////////
+TEST(SearchPath, FindLib)
+{
+  namespace fs = std::filesystem;
+
+  const fs::path first = fs::temp_directory_path() / "ign_plugin_search_1";
+  const fs::path second = fs::temp_directory_path() / "ign_plugin_search_2";
+  fs::remove_all(first);
+  fs::remove_all(second);
+  ASSERT_TRUE(fs::create_directory(first));
+  ASSERT_TRUE(fs::create_directory(second));
+
+  const std::string dummyName = fs::path(IGNDummyPlugins_LIB).filename();
+  const std::string factoryName = fs::path(IGNFactoryPlugins_LIB).filename();
+  fs::copy_file(IGNDummyPlugins_LIB, first / dummyName);
+  fs::copy_file(IGNDummyPlugins_LIB, second / dummyName);
+  fs::copy_file(IGNFactoryPlugins_LIB, second / factoryName);
+
+  ignition::plugin::Loader pl;
+  EXPECT_TRUE(pl.AddSearchPath(first.string()));
+  EXPECT_TRUE(pl.AddSearchPath(second.string()));
+  EXPECT_FALSE(pl.AddSearchPath(first.string()));
+  EXPECT_FALSE(pl.AddSearchPath((first / "missing").string()));
+
+  // A library can be found by any of its short names, and the directory
+  // which was added first takes precedence
+  const std::string dummyPath = fs::canonical(first / dummyName).string();
+  EXPECT_EQ(dummyPath, pl.FindLib(dummyName));
+  EXPECT_EQ(dummyPath, pl.FindLib("libIGNDummyPlugins"));
+  EXPECT_EQ(dummyPath, pl.FindLib("IGNDummyPlugins"));
+  EXPECT_EQ(fs::canonical(second / factoryName).string(),
+            pl.FindLib("IGNFactoryPlugins"));
+  EXPECT_TRUE(pl.FindLib("IGNTemplatedPlugins").empty());
+  EXPECT_TRUE(pl.FindLib("").empty());
+
+  // Changes to the directories are picked up
+  fs::copy_file(IGNTemplatedPlugins_LIB, second / "libRenamed.so");
+  EXPECT_EQ(fs::canonical(second / "libRenamed.so").string(),
+            pl.FindLib("Renamed"));
+
+  fs::remove(first / dummyName);
+  EXPECT_EQ(fs::canonical(second / dummyName).string(),
+            pl.FindLib("IGNDummyPlugins"));
+
+  fs::remove(second / "libRenamed.so");
+  EXPECT_TRUE(pl.FindLib("Renamed").empty());
+
+  fs::remove_all(first);
+  fs::remove_all(second);
+}
+
+/////////////////////////////////////////////////
+TEST(SearchPath, LoadSearchPath)
+{
+  namespace fs = std::filesystem;
+
+  const fs::path directory = fs::temp_directory_path() / "ign_plugin_search";
+  fs::remove_all(directory);
+  ASSERT_TRUE(fs::create_directory(directory));
+
+  const std::string dummyName = fs::path(IGNDummyPlugins_LIB).filename();
+  const std::string factoryName = fs::path(IGNFactoryPlugins_LIB).filename();
+  fs::copy_file(IGNDummyPlugins_LIB, directory / dummyName);
+  fs::copy_file(IGNFactoryPlugins_LIB, directory / factoryName);
+
+  {
+    ignition::plugin::Loader pl;
+    EXPECT_TRUE(pl.LoadSearchPath().empty());
+
+    ASSERT_TRUE(pl.AddSearchPath(directory.string()));
+    const std::unordered_set<std::string> plugins = pl.LoadSearchPath();
+    EXPECT_EQ(1u, plugins.count("test::util::DummySinglePlugin"));
+    EXPECT_FALSE(pl.LookupPlugin("test::util::DummyNameForward").empty());
+
+    EXPECT_TRUE(pl.Instantiate("test::util::DummySinglePlugin"));
+  }
+
+  fs::remove_all(directory);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
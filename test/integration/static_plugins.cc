@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/plugin/EnablePluginFromThis.hh>
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/DummyPlugins.hh"
+#include "utils.hh"
+
+/////////////////////////////////////////////////
+TEST(StaticPlugins, LoadDescriptors)
+{
+  ignition::plugin::Loader pl;
+
+  const std::unordered_set<std::string> pluginNames =
+      pl.LoadLib(IGNStaticPlugins_LIB);
+  EXPECT_EQ(2u, pluginNames.size());
+  ASSERT_EQ(1u, pluginNames.count("test::util::StaticNamePlugin"));
+  ASSERT_EQ(1u, pluginNames.count("test::util::StaticMixedPlugin"));
+
+  // The interfaces of every descriptor of a plugin are merged
+  const std::unordered_set<std::string> &interfaces =
+      pl.InterfacesImplemented();
+  EXPECT_EQ(1u, interfaces.count("test::util::DummyNameBase"));
+  EXPECT_EQ(1u, interfaces.count("test::util::DummyIntBase"));
+  EXPECT_EQ(1u, interfaces.count("test::util::DummyDoubleBase"));
+
+  EXPECT_EQ(2u, pl.AliasesOfPlugin("test::util::StaticNamePlugin").size());
+  EXPECT_EQ(1u, pl.PluginsWithAlias("StaticName").size());
+  EXPECT_EQ(1u, pl.PluginsWithAlias("Another static name").size());
+}
+
+/////////////////////////////////////////////////
+TEST(StaticPlugins, Instantiate)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNStaticPlugins_LIB);
+
+  ignition::plugin::PluginPtr plugin = pl.Instantiate("StaticName");
+  ASSERT_TRUE(plugin);
+
+  auto *nameBase = plugin->QueryInterface<test::util::DummyNameBase>();
+  ASSERT_NE(nullptr, nameBase);
+  EXPECT_EQ("StaticNamePlugin", nameBase->MyNameIs());
+
+  auto *intBase = plugin->QueryInterface<test::util::DummyIntBase>();
+  ASSERT_NE(nullptr, intBase);
+  EXPECT_EQ(7, intBase->MyIntegerValueIs());
+
+  EXPECT_EQ(nullptr,
+            plugin->QueryInterface<ignition::plugin::EnablePluginFromThis>());
+}
+
+/////////////////////////////////////////////////
+TEST(StaticPlugins, MixedRegistration)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNStaticPlugins_LIB);
+
+  ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::util::StaticMixedPlugin");
+  ASSERT_TRUE(plugin);
+
+  // This interface was added by IGNITION_ADD_PLUGIN
+  auto *nameBase = plugin->QueryInterface<test::util::DummyNameBase>();
+  ASSERT_NE(nullptr, nameBase);
+  EXPECT_EQ("StaticMixedPlugin", nameBase->MyNameIs());
+
+  // This interface was added by IGNITION_ADD_STATIC_PLUGIN
+  auto *doubleBase = plugin->QueryInterface<test::util::DummyDoubleBase>();
+  ASSERT_NE(nullptr, doubleBase);
+  EXPECT_DOUBLE_EQ(2.5, doubleBase->MyDoubleValueIs());
+
+  auto *fromThis =
+      plugin->QueryInterface<ignition::plugin::EnablePluginFromThis>();
+  ASSERT_NE(nullptr, fromThis);
+  EXPECT_EQ(plugin, fromThis->PluginFromThis());
+}
+
+/////////////////////////////////////////////////
+TEST(StaticPlugins, ScanLib)
+{
+  const std::string path = IGNStaticPlugins_LIB;
+  CHECK_FOR_LIBRARY(path, false);
+
+  {
+    ignition::plugin::Loader pl;
+
+    // The embedded metadata tells us everything without opening the library
+    const std::unordered_set<std::string> pluginNames = pl.ScanLib(path);
+    EXPECT_EQ(2u, pluginNames.size());
+    EXPECT_EQ(1u, pluginNames.count("test::util::StaticNamePlugin"));
+    EXPECT_EQ(1u, pluginNames.count("test::util::StaticMixedPlugin"));
+    CHECK_FOR_LIBRARY(path, false);
+
+    // Mangled interface names are derived from the metadata
+    EXPECT_EQ(2u, pl.PluginsImplementing<test::util::DummyNameBase>().size());
+    EXPECT_EQ(1u, pl.PluginsImplementing<test::util::DummyIntBase>().size());
+    EXPECT_EQ(1u, pl.PluginsImplementing<
+                ignition::plugin::EnablePluginFromThis>().count(
+                  "test::util::StaticMixedPlugin"));
+    EXPECT_EQ("test::util::StaticNamePlugin",
+              pl.LookupPlugin("Another static name"));
+    CHECK_FOR_LIBRARY(path, false);
+
+    ignition::plugin::PluginPtr plugin = pl.Instantiate("StaticName");
+    ASSERT_TRUE(plugin);
+    CHECK_FOR_LIBRARY(path, true);
+
+    auto *intBase = plugin->QueryInterface<test::util::DummyIntBase>();
+    ASSERT_NE(nullptr, intBase);
+    EXPECT_EQ(7, intBase->MyIntegerValueIs());
+  }
+
+  CHECK_FOR_LIBRARY(path, false);
+
+  {
+    // The aliases of this library are registered at load time, so it needs
+    // to be opened.
+    const std::string dummyPath = IGNDummyPlugins_LIB;
+    ignition::plugin::Loader pl;
+    EXPECT_EQ(1u, pl.ScanLib(dummyPath).count(
+                "test::util::DummySinglePlugin"));
+    CHECK_FOR_LIBRARY(dummyPath, true);
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
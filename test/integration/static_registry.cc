@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// The plugins of this translation unit are linked into the test program, so
+// they need to be registered with the process-wide registry.
+#define IGN_PLUGIN_STATIC_REGISTRY
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <typeinfo>
+
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/plugin/StaticRegistry.hh>
+#include <ignition/plugin/WeakPluginPtr.hh>
+
+#include "../plugins/FactoryPlugins.hh"
+
+namespace test
+{
+namespace registry
+{
+
+/// \brief A plugin which is linked into the test program
+class LinkedPlugin
+    : public util::DummyNameBase,
+      public util::DummyIntBase
+{
+  public: std::string MyNameIs() const override
+  {
+    return "LinkedPlugin";
+  }
+
+  public: int MyIntegerValueIs() const override
+  {
+    return 42;
+  }
+};
+
+/// \brief A product of a factory which is linked into the test program
+class LinkedProduct : public util::DummyNameBase
+{
+  public: explicit LinkedProduct(const std::string &_name)
+    : name(_name)
+  {
+  }
+
+  public: std::string MyNameIs() const override
+  {
+    return this->name;
+  }
+
+  private: std::string name;
+};
+
+/// \brief A plugin whose Info is filled in by hand, without interface IDs,
+/// like the Info of a library which was built before the IDs existed
+class UnidentifiedPlugin : public util::DummyNameBase
+{
+  public: std::string MyNameIs() const override
+  {
+    return "UnidentifiedPlugin";
+  }
+};
+
+/// \brief A plugin whose Info counts how often it is cast to its interfaces
+class CountedPlugin
+    : public util::DummyNameBase,
+      public util::DummyIntBase
+{
+  public: std::string MyNameIs() const override
+  {
+    return "CountedPlugin";
+  }
+
+  public: int MyIntegerValueIs() const override
+  {
+    return 7;
+  }
+
+  /// \brief The number of casts to DummyNameBase
+  public: static int nameCasts;
+
+  /// \brief The number of casts to DummyIntBase
+  public: static int intCasts;
+};
+
+int CountedPlugin::nameCasts = 0;
+int CountedPlugin::intCasts = 0;
+
+}
+}
+
+IGNITION_ADD_PLUGIN(test::registry::LinkedPlugin, test::util::DummyNameBase)
+IGNITION_ADD_PLUGIN(test::registry::LinkedPlugin, test::util::DummyIntBase)
+IGNITION_ADD_PLUGIN_ALIAS(test::registry::LinkedPlugin, "Linked")
+IGNITION_ADD_STATIC_PLUGIN_ALIAS(test::registry::LinkedPlugin, "Also linked")
+
+IGNITION_ADD_FACTORY(test::registry::LinkedProduct, test::util::NameFactory)
+
+/////////////////////////////////////////////////
+TEST(StaticRegistry, LoadStaticPlugins)
+{
+  ignition::plugin::Loader pl;
+
+  const std::unordered_set<std::string> pluginNames = pl.LoadStaticPlugins();
+  EXPECT_EQ(1u, pluginNames.count("test::registry::LinkedPlugin"));
+
+  EXPECT_EQ("test::registry::LinkedPlugin", pl.LookupPlugin("Linked"));
+  EXPECT_EQ("test::registry::LinkedPlugin", pl.LookupPlugin("Also linked"));
+  EXPECT_EQ(1u, pl.PluginsImplementing<test::util::DummyIntBase>().size());
+
+  ignition::plugin::PluginPtr plugin = pl.Instantiate("Linked");
+  ASSERT_TRUE(plugin);
+
+  auto *nameBase = plugin->QueryInterface<test::util::DummyNameBase>();
+  ASSERT_NE(nullptr, nameBase);
+  EXPECT_EQ("LinkedPlugin", nameBase->MyNameIs());
+
+  auto *intBase = plugin->QueryInterface<test::util::DummyIntBase>();
+  ASSERT_NE(nullptr, intBase);
+  EXPECT_EQ(42, intBase->MyIntegerValueIs());
+
+  // Loading them again does not change anything
+  EXPECT_EQ(pluginNames, pl.LoadStaticPlugins());
+  EXPECT_EQ(pluginNames.size(), pl.AllPlugins().size());
+
+  EXPECT_TRUE(pl.ForgetLibraryOfPlugin("Linked"));
+  EXPECT_TRUE(pl.AllPlugins().empty());
+
+  // The instance outlives the registration in the Loader
+  EXPECT_EQ("LinkedPlugin", nameBase->MyNameIs());
+}
+
+/////////////////////////////////////////////////
+TEST(StaticRegistry, Factory)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadStaticPlugins();
+
+  auto factory = pl.Factory<test::util::NameFactory>(
+        "test::registry::LinkedProduct");
+  ASSERT_NE(nullptr, factory);
+
+  auto product = factory->Construct("Linked product");
+  ASSERT_NE(nullptr, product);
+  EXPECT_EQ("Linked product", product->MyNameIs());
+}
+
+/////////////////////////////////////////////////
+TEST(StaticRegistry, InterfacesWithoutIds)
+{
+  using test::registry::UnidentifiedPlugin;
+  using test::util::DummyNameBase;
+
+  ignition::plugin::Info info;
+  info.name = typeid(UnidentifiedPlugin).name();
+  info.factory = []() -> void* { return new UnidentifiedPlugin; };
+  info.deleter = [](void *_ptr)
+  {
+    delete static_cast<UnidentifiedPlugin*>(_ptr);
+  };
+  info.interfaces.insert(std::make_pair(
+        typeid(DummyNameBase).name(), [](void *_ptr) -> void*
+  {
+    return static_cast<DummyNameBase*>(
+          static_cast<UnidentifiedPlugin*>(_ptr));
+  }));
+  ignition::plugin::detail::RegisterStaticPlugin(info);
+
+  ignition::plugin::Loader pl;
+  pl.LoadStaticPlugins();
+
+  ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::registry::UnidentifiedPlugin");
+  ASSERT_TRUE(plugin);
+
+  // The interface is still found through its mangled name
+  auto *nameBase = plugin->QueryInterface<DummyNameBase>();
+  ASSERT_NE(nullptr, nameBase);
+  EXPECT_EQ("UnidentifiedPlugin", nameBase->MyNameIs());
+  EXPECT_TRUE(plugin->HasInterface(typeid(DummyNameBase).name(), false));
+  EXPECT_FALSE(plugin->HasInterface<test::util::DummyIntBase>());
+
+  // Plugins that were registered by the macros are found by their IDs
+  plugin = pl.Instantiate("Linked");
+  ASSERT_TRUE(plugin);
+  EXPECT_TRUE(plugin->HasInterface<DummyNameBase>());
+  EXPECT_TRUE(plugin->HasInterface(typeid(DummyNameBase).name(), false));
+}
+
+/////////////////////////////////////////////////
+TEST(StaticRegistry, InterfacesAreCastOnDemand)
+{
+  using test::registry::CountedPlugin;
+  using test::util::DummyIntBase;
+  using test::util::DummyNameBase;
+
+  ignition::plugin::Info info;
+  info.name = typeid(CountedPlugin).name();
+  info.factory = []() -> void* { return new CountedPlugin; };
+  info.deleter = [](void *_ptr)
+  {
+    delete static_cast<CountedPlugin*>(_ptr);
+  };
+  info.interfaces.insert(std::make_pair(
+        typeid(DummyNameBase).name(), [](void *_ptr) -> void*
+  {
+    ++CountedPlugin::nameCasts;
+    return static_cast<DummyNameBase*>(static_cast<CountedPlugin*>(_ptr));
+  }));
+  info.interfaces.insert(std::make_pair(
+        typeid(DummyIntBase).name(), [](void *_ptr) -> void*
+  {
+    ++CountedPlugin::intCasts;
+    return static_cast<DummyIntBase*>(static_cast<CountedPlugin*>(_ptr));
+  }));
+  ignition::plugin::detail::RegisterStaticPlugin(info);
+
+  ignition::plugin::Loader pl;
+  pl.LoadStaticPlugins();
+
+  // Instantiating the plugin does not cast it to anything
+  ignition::plugin::PluginPtr plugin =
+      pl.Instantiate("test::registry::CountedPlugin");
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ(0, CountedPlugin::nameCasts);
+  EXPECT_EQ(0, CountedPlugin::intCasts);
+
+  // Each interface is cast once, when it is first needed
+  auto *nameBase = plugin->QueryInterface<DummyNameBase>();
+  ASSERT_NE(nullptr, nameBase);
+  EXPECT_EQ("CountedPlugin", nameBase->MyNameIs());
+  EXPECT_EQ(nameBase, plugin->QueryInterface<DummyNameBase>());
+  EXPECT_EQ(1, CountedPlugin::nameCasts);
+  EXPECT_EQ(0, CountedPlugin::intCasts);
+
+  // Copies of the plugin share what has been cast so far
+  ignition::plugin::PluginPtr copy = plugin;
+  EXPECT_EQ(nameBase, copy->QueryInterface<DummyNameBase>());
+  ignition::plugin::WeakPluginPtr weak = plugin;
+  EXPECT_EQ(nameBase, weak.Lock()->QueryInterface<DummyNameBase>());
+  EXPECT_EQ(1, CountedPlugin::nameCasts);
+
+  EXPECT_EQ(7, copy->QueryInterface<DummyIntBase>()->MyIntegerValueIs());
+  EXPECT_EQ(7, plugin->QueryInterface<DummyIntBase>()->MyIntegerValueIs());
+  EXPECT_EQ(1, CountedPlugin::intCasts);
+
+  // Another instance has locations of its own
+  ignition::plugin::PluginPtr other =
+      pl.Instantiate("test::registry::CountedPlugin");
+  ASSERT_TRUE(other);
+  EXPECT_NE(nameBase, other->QueryInterface<DummyNameBase>());
+  EXPECT_EQ(2, CountedPlugin::nameCasts);
+  EXPECT_EQ(1, CountedPlugin::intCasts);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -24,6 +24,7 @@
 
 #include <ignition/plugin/Loader.hh>
 #include <ignition/plugin/SpecializedPluginPtr.hh>
+#include <ignition/plugin/TypedPluginPtr.hh>
 
 #include "../plugins/TemplatedPlugins.hh"
 
@@ -113,6 +114,51 @@ TEST(TemplatedPlugins, SetAndGet)
   TestSetAndGet<std::string>(pl, "some amazing string");
 }
 
+/////////////////////////////////////////////////
+TEST(TemplatedPlugins, TypedPluginPtr)
+{
+  ignition::plugin::Loader pl;
+  pl.LoadLib(IGNTemplatedPlugins_LIB);
+
+  using IntPlugin = ignition::plugin::TypedPluginPtr<
+      TemplatedGetInterface<int>, TemplatedSetInterface<int>>;
+
+  EXPECT_FALSE(IntPlugin());
+  EXPECT_TRUE(IntPlugin().IsEmpty());
+  EXPECT_FALSE(pl.Instantiate<IntPlugin>("not a plugin"));
+
+  const std::string intName = "test::plugins::GenericTemplatePlugin<int>";
+  const IntPlugin plugin = pl.Instantiate<IntPlugin>(intName);
+  ASSERT_TRUE(plugin);
+  ASSERT_TRUE(plugin.Untyped());
+  EXPECT_EQ(intName, *plugin.Untyped()->Name());
+
+  plugin.Get<TemplatedSetInterface<int>>().Set(42);
+  EXPECT_EQ(42, plugin.Get<TemplatedGetInterface<int>>().Get());
+  EXPECT_EQ(plugin.Untyped()->QueryInterface<TemplatedSetInterface<int>>(),
+            &plugin.Get<TemplatedSetInterface<int>>());
+
+  // A plugin which is missing an interface is not instantiated at all
+  using MixedPlugin = ignition::plugin::TypedPluginPtr<
+      TemplatedGetInterface<int>, TemplatedSetInterface<std::string>>;
+  EXPECT_FALSE(pl.Instantiate<MixedPlugin>(intName));
+
+  ignition::plugin::PluginPtr untyped;
+  EXPECT_EQ(ignition::plugin::Loader::LookupStatus::FOUND,
+            pl.TryInstantiate(intName, untyped));
+
+  // Converting a PluginPtr checks the interfaces of the instance
+  const MixedPlugin mixed = untyped;
+  EXPECT_FALSE(mixed);
+  EXPECT_FALSE(mixed.Untyped());
+
+  IntPlugin converted = untyped;
+  ASSERT_TRUE(converted);
+  EXPECT_EQ(untyped, converted.Untyped());
+
+  converted.Clear();
+  EXPECT_TRUE(converted.IsEmpty());
+}
 
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/ThreadLocalPlugin.hh>
+
+#include "../plugins/RecyclablePlugins.hh"
+
+using ignition::plugin::Loader;
+using ignition::plugin::PluginPtr;
+using ignition::plugin::ThreadLocalPlugin;
+using test::plugins::Scratchpad;
+
+const char *const disposable = "test::plugins::DisposableScratchpad";
+
+/////////////////////////////////////////////////
+TEST(ThreadLocalPlugin, SameThread)
+{
+  Loader pl;
+  pl.LoadLib(IGNRecyclablePlugins_LIB);
+
+  EXPECT_FALSE(ThreadLocalPlugin());
+  EXPECT_FALSE(ThreadLocalPlugin().Get());
+  EXPECT_FALSE(pl.ThreadLocal("not a plugin"));
+
+  const ThreadLocalPlugin scratchpads = pl.ThreadLocal(disposable);
+  ASSERT_TRUE(scratchpads);
+  ASSERT_NE(nullptr, scratchpads.Name());
+  EXPECT_EQ(disposable, *scratchpads.Name());
+
+  // The instance is created on first access and then kept
+  EXPECT_FALSE(scratchpads.HasInstance());
+  const PluginPtr &plugin = scratchpads.Get();
+  ASSERT_TRUE(plugin);
+  EXPECT_TRUE(scratchpads.HasInstance());
+  plugin->QueryInterface<Scratchpad>()->Write(7);
+  const std::size_t serial = plugin->QueryInterface<Scratchpad>()->Serial();
+
+  // Copies share the instance, other ThreadLocalPlugins do not
+  const ThreadLocalPlugin copy = scratchpads;
+  EXPECT_EQ(plugin, copy.Get());
+  const ThreadLocalPlugin other = pl.ThreadLocal(disposable);
+  EXPECT_NE(plugin, other.Get());
+
+  // References stay valid while other slots get filled
+  std::vector<ThreadLocalPlugin> more(20, pl.ThreadLocal(disposable));
+  for (std::size_t i = 0; i < more.size(); ++i)
+    more[i] = pl.ThreadLocal(disposable);
+  for (const ThreadLocalPlugin &tl : more)
+    ASSERT_TRUE(tl.Get());
+  EXPECT_EQ(7, plugin->QueryInterface<Scratchpad>()->Read());
+  EXPECT_EQ(&plugin, &scratchpads.Get());
+
+  // Releasing the instance makes the next access create a new one
+  std::weak_ptr<Scratchpad> weak =
+      plugin->QueryInterfaceSharedPtr<Scratchpad>();
+  scratchpads.Release();
+  EXPECT_TRUE(weak.expired());
+  EXPECT_FALSE(scratchpads.HasInstance());
+  EXPECT_NE(serial,
+            scratchpads.Get()->QueryInterface<Scratchpad>()->Serial());
+}
+
+/////////////////////////////////////////////////
+TEST(ThreadLocalPlugin, Threads)
+{
+  Loader pl;
+  pl.LoadLib(IGNRecyclablePlugins_LIB);
+  const ThreadLocalPlugin scratchpads = pl.ThreadLocal(disposable);
+  ASSERT_TRUE(scratchpads);
+
+  const std::size_t threadCount = 4;
+  std::vector<std::size_t> serials(threadCount);
+  std::vector<std::weak_ptr<Scratchpad>> weak(threadCount);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      Scratchpad *scratchpad =
+          scratchpads.Get()->QueryInterface<Scratchpad>();
+      serials[t] = scratchpad->Serial();
+      weak[t] = scratchpads.Get()->QueryInterfaceSharedPtr<Scratchpad>();
+
+      // Nothing else writes into the instance of this thread
+      for (int i = 0; i < 1000; ++i)
+      {
+        scratchpad->Write(i);
+        ASSERT_EQ(i, scratchpads.Get()->QueryInterface<Scratchpad>()->Read());
+      }
+    });
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  // Every thread had its own instance, which was deleted when it exited
+  EXPECT_EQ(threadCount,
+            std::set<std::size_t>(serials.begin(), serials.end()).size());
+  for (const std::weak_ptr<Scratchpad> &w : weak)
+    EXPECT_TRUE(w.expired());
+
+  EXPECT_FALSE(scratchpads.HasInstance());
+}
+
+/////////////////////////////////////////////////
+TEST(ThreadLocalPlugin, ReusedSlot)
+{
+  Loader pl;
+  pl.LoadLib(IGNRecyclablePlugins_LIB);
+
+  std::size_t serial = 0;
+  std::weak_ptr<Scratchpad> weak;
+  {
+    const ThreadLocalPlugin first = pl.ThreadLocal(disposable);
+    serial = first.Get()->QueryInterface<Scratchpad>()->Serial();
+    weak = first.Get()->QueryInterfaceSharedPtr<Scratchpad>();
+  }
+
+  // The instance of the destroying thread goes away with its slot
+  EXPECT_TRUE(weak.expired());
+
+  // A new ThreadLocalPlugin which reuses the slot does not see the old
+  // instance
+  const ThreadLocalPlugin second = pl.ThreadLocal(disposable);
+  EXPECT_FALSE(second.HasInstance());
+  EXPECT_NE(serial, second.Get()->QueryInterface<Scratchpad>()->Serial());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -20,6 +20,8 @@
 
 #include <dlfcn.h>
 
+#include <memory_resource>
+
 /////////////////////////////////////////////////
 // The macro RTLD_NOLOAD is not part of the POSIX standard, and is a custom
 // addition to glibc-2.2, so the unloading test can only work when we are using
@@ -59,4 +61,34 @@
 
 #endif
 
+/////////////////////////////////////////////////
+/// \brief A memory resource which counts the bytes that it has handed out
+class CountingResource : public std::pmr::memory_resource
+{
+  public: std::size_t allocated = 0;
+  public: std::size_t outstanding = 0;
+  public: std::size_t count = 0;
+
+  private: void *do_allocate(std::size_t _bytes, std::size_t _align) override
+  {
+    this->allocated += _bytes;
+    this->outstanding += _bytes;
+    ++this->count;
+    return std::pmr::new_delete_resource()->allocate(_bytes, _align);
+  }
+
+  private: void do_deallocate(
+    void *_p, std::size_t _bytes, std::size_t _align) override
+  {
+    this->outstanding -= _bytes;
+    std::pmr::new_delete_resource()->deallocate(_p, _bytes, _align);
+  }
+
+  private: bool do_is_equal(
+    const std::pmr::memory_resource &_other) const noexcept override
+  {
+    return this == &_other;
+  }
+};
+
 #endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.hh"
+
+namespace
+{
+  /// \brief The number of heap allocations which have been made so far
+  std::atomic<std::size_t> allocations{0};
+
+  /// \brief The number of bytes which have been allocated so far
+  std::atomic<std::size_t> allocatedBytes{0};
+
+  /// \brief The number of bytes which are currently allocated
+  std::atomic<std::size_t> liveBytes{0};
+
+  /// \brief Each allocation is preceded by its size, padded so that the
+  /// allocation keeps the alignment that malloc provides
+  constexpr std::size_t kHeaderSize = alignof(std::max_align_t);
+}
+
+/////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  char *memory = static_cast<char*>(std::malloc(kHeaderSize + _size));
+  if (!memory)
+    throw std::bad_alloc();
+
+  *reinterpret_cast<std::size_t*>(memory) = _size;
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(_size, std::memory_order_relaxed);
+  liveBytes.fetch_add(_size, std::memory_order_relaxed);
+  return memory + kHeaderSize;
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_memory) noexcept
+{
+  if (!_memory)
+    return;
+
+  char *memory = static_cast<char*>(_memory) - kHeaderSize;
+  liveBytes.fetch_sub(*reinterpret_cast<std::size_t*>(memory),
+                      std::memory_order_relaxed);
+  std::free(memory);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_memory, std::size_t) noexcept
+{
+  operator delete(_memory);
+}
+
+namespace test
+{
+namespace performance
+{
+/////////////////////////////////////////////////
+std::size_t Allocations()
+{
+  return allocations.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+std::size_t AllocatedBytes()
+{
+  return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+std::size_t LiveBytes()
+{
+  return liveBytes.load(std::memory_order_relaxed);
+}
+}
+}
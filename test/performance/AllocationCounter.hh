@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_PLUGIN_TEST_PERFORMANCE_ALLOCATIONCOUNTER_HH_
+#define IGNITION_PLUGIN_TEST_PERFORMANCE_ALLOCATIONCOUNTER_HH_
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+namespace test
+{
+namespace performance
+{
+/// \brief Get the number of heap allocations which have been made so far by
+/// the process. AllocationCounter.cc replaces the global operator new of the
+/// benchmark program in order to count them.
+/// \return The number of allocations
+std::size_t Allocations();
+
+/// \brief Get the number of bytes which have been allocated on the heap so
+/// far through operator new
+/// \return The number of bytes
+std::size_t AllocatedBytes();
+
+/// \brief Get the number of bytes which are currently allocated on the heap
+/// through operator new
+/// \return The number of bytes
+std::size_t LiveBytes();
+
+/// \brief Reports the heap allocations per iteration of a benchmark as
+/// "allocs/op", and the bytes that they requested as "bytes/op"
+class AllocationCounter
+{
+  /// \brief Constructor. Starts counting.
+  /// \param[in] _state The state of the benchmark
+  public: explicit AllocationCounter(benchmark::State &_state)
+    : state(_state),
+      start(Allocations()),
+      startBytes(AllocatedBytes())
+  {
+  }
+
+  /// \brief Destructor. Reports the allocations since construction.
+  public: ~AllocationCounter()
+  {
+    this->state.counters["allocs/op"] = benchmark::Counter(
+          static_cast<double>(Allocations() - this->start),
+          benchmark::Counter::kAvgIterations);
+    this->state.counters["bytes/op"] = benchmark::Counter(
+          static_cast<double>(AllocatedBytes() - this->startBytes),
+          benchmark::Counter::kAvgIterations);
+  }
+
+  /// \brief The state of the benchmark
+  private: benchmark::State &state;
+
+  /// \brief The number of allocations at construction
+  private: const std::size_t start;
+
+  /// \brief The number of allocated bytes at construction
+  private: const std::size_t startBytes;
+};
+}
+}
+
+#endif
@@ -0,0 +1,54 @@
+#################################################
+# Run a benchmark program, keep its results as JSON, and compare them against
+# a baseline if there is one. This is a script for "cmake -P", which takes:
+#
+#   BENCHMARK      The benchmark program to run
+#   OUTPUT         Where to write the results
+#   BASELINE       The results to compare against (optional). If the file
+#                  does not exist, nothing gets compared.
+#   PYTHON         The Python interpreter which runs COMPARE_SCRIPT
+#   COMPARE_SCRIPT The path to tools/compare_benchmarks.py
+#   TOLERANCE      The largest relative increase which is not a regression
+#   FAIL           If true, fail when anything regressed
+
+foreach(required BENCHMARK OUTPUT)
+  if(NOT DEFINED ${required})
+    message(FATAL_ERROR "[RunBenchmark] ${required} must be defined")
+  endif()
+endforeach()
+
+set(benchmark_args
+  --benchmark_out=${OUTPUT}
+  --benchmark_out_format=json)
+
+execute_process(
+  COMMAND ${BENCHMARK} ${benchmark_args}
+  RESULT_VARIABLE benchmark_result)
+
+if(NOT benchmark_result EQUAL 0)
+  message(FATAL_ERROR "[RunBenchmark] ${BENCHMARK} failed: ${benchmark_result}")
+endif()
+
+if(NOT BASELINE OR NOT EXISTS "${BASELINE}")
+  message(STATUS "No baseline to compare ${OUTPUT} against")
+  return()
+endif()
+
+if(NOT PYTHON)
+  message(STATUS "Python was not found, so ${OUTPUT} is not compared")
+  return()
+endif()
+
+set(compare_args ${BASELINE} ${OUTPUT} --tolerance ${TOLERANCE})
+if(FAIL)
+  list(APPEND compare_args --fail-on-regression)
+endif()
+
+execute_process(
+  COMMAND ${PYTHON} ${COMPARE_SCRIPT} ${compare_args}
+  RESULT_VARIABLE compare_result)
+
+if(NOT compare_result EQUAL 0)
+  message(FATAL_ERROR "[RunBenchmark] ${BENCHMARK} regressed against "
+    "${BASELINE}")
+endif()
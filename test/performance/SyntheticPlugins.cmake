@@ -0,0 +1,140 @@
+#################################################
+# write_synthetic_plugin_sources(<sources_var>
+#                                DIRECTORY <directory>
+#                                NAMESPACE <namespace>
+#                                PLUGINS <count>
+#                                INTERFACES <count>
+#                                INTERFACES_PER_PLUGIN <count>
+#                                ALIASES <count>
+#                                TRANSLATION_UNITS <count>)
+#
+# Write the sources of a synthetic plugin library into <directory>, and put
+# the list of its translation units into <sources_var>. The library is meant
+# for benchmarking the Loader at scale:
+#
+#   - INTERFACES interfaces named <namespace>::Interface<i>
+#   - PLUGINS plugins named <namespace>::Plugin<p>, where plugin p implements
+#     INTERFACES_PER_PLUGIN consecutive interfaces, starting at interface
+#     p modulo INTERFACES
+#   - ALIASES aliases for each plugin, named "<namespace>/Plugin<p>/<a>"
+#   - the plugins are spread over TRANSLATION_UNITS translation units. The
+#     first one includes Register.hh and the others include RegisterMore.hh.
+#
+# Files are only rewritten when their contents change, so reconfiguring does
+# not cause the library to be rebuilt.
+function(write_synthetic_plugin_sources sources_var)
+
+  set(oneValueArgs DIRECTORY NAMESPACE PLUGINS INTERFACES
+                   INTERFACES_PER_PLUGIN ALIASES TRANSLATION_UNITS)
+  cmake_parse_arguments(synthetic "" "${oneValueArgs}" "" ${ARGN})
+
+  if(synthetic_INTERFACES_PER_PLUGIN GREATER synthetic_INTERFACES)
+    message(FATAL_ERROR "[write_synthetic_plugin_sources] A plugin cannot "
+      "implement more than the ${synthetic_INTERFACES} interfaces")
+  endif()
+
+  if(synthetic_TRANSLATION_UNITS GREATER synthetic_PLUGINS)
+    message(FATAL_ERROR "[write_synthetic_plugin_sources] Every translation "
+      "unit needs at least one of the ${synthetic_PLUGINS} plugins")
+  endif()
+
+  set(ns ${synthetic_NAMESPACE})
+  math(EXPR last_interface "${synthetic_INTERFACES} - 1")
+  math(EXPR last_plugin "${synthetic_PLUGINS} - 1")
+  math(EXPR last_unit "${synthetic_TRANSLATION_UNITS} - 1")
+
+  # The header declares every interface and every plugin
+  set(header "// Generated by write_synthetic_plugin_sources(). Do not edit.\n")
+  string(APPEND header "\nnamespace ${ns}\n{\n")
+
+  foreach(i RANGE ${last_interface})
+    string(APPEND header
+      "class Interface${i}\n"
+      "{\n"
+      "  public: virtual ~Interface${i}() = default;\n"
+      "  public: virtual int Value${i}() const = 0;\n"
+      "};\n\n")
+  endforeach()
+
+  foreach(p RANGE ${last_plugin})
+    set(bases)
+    set(overrides)
+    foreach(j RANGE 1 ${synthetic_INTERFACES_PER_PLUGIN})
+      math(EXPR i "(${p} + ${j} - 1) % ${synthetic_INTERFACES}")
+      list(APPEND bases "public Interface${i}")
+      string(APPEND overrides
+        "  public: int Value${i}() const override { return ${p}; }\n")
+    endforeach()
+
+    string(REPLACE ";" ", " bases "${bases}")
+    string(APPEND header
+      "class Plugin${p} : ${bases}\n"
+      "{\n"
+      "${overrides}"
+      "};\n\n")
+  endforeach()
+
+  string(APPEND header "}\n")
+
+  set(header_file "${synthetic_DIRECTORY}/${ns}.hh")
+  _write_synthetic_file("${header_file}" "${header}")
+
+  set(sources)
+  foreach(unit RANGE ${last_unit})
+    if(unit EQUAL 0)
+      set(register "Register.hh")
+    else()
+      set(register "RegisterMore.hh")
+    endif()
+
+    string(CONCAT source
+      "// Generated by write_synthetic_plugin_sources(). Do not edit.\n"
+      "#include <ignition/plugin/${register}>\n"
+      "#include \"${ns}.hh\"\n\n")
+
+    foreach(p RANGE ${unit} ${last_plugin} ${synthetic_TRANSLATION_UNITS})
+      set(interfaces)
+      foreach(j RANGE 1 ${synthetic_INTERFACES_PER_PLUGIN})
+        math(EXPR i "(${p} + ${j} - 1) % ${synthetic_INTERFACES}")
+        list(APPEND interfaces "${ns}::Interface${i}")
+      endforeach()
+      string(REPLACE ";" ", " interfaces "${interfaces}")
+
+      string(APPEND source
+        "IGNITION_ADD_PLUGIN(${ns}::Plugin${p}, ${interfaces})\n")
+
+      if(synthetic_ALIASES GREATER 0)
+        set(aliases)
+        math(EXPR last_alias "${synthetic_ALIASES} - 1")
+        foreach(a RANGE ${last_alias})
+          list(APPEND aliases "\"${ns}/Plugin${p}/${a}\"")
+        endforeach()
+        string(REPLACE ";" ", " aliases "${aliases}")
+        string(APPEND source
+          "IGNITION_ADD_PLUGIN_ALIAS(${ns}::Plugin${p}, ${aliases})\n")
+      endif()
+    endforeach()
+
+    set(source_file "${synthetic_DIRECTORY}/${ns}_${unit}.cc")
+    _write_synthetic_file("${source_file}" "${source}")
+    list(APPEND sources "${source_file}")
+  endforeach()
+
+  set(${sources_var} ${sources} PARENT_SCOPE)
+
+endfunction()
+
+#################################################
+# Write a file unless it already has the given contents
+function(_write_synthetic_file file contents)
+
+  if(EXISTS "${file}")
+    file(READ "${file}" existing)
+    if(existing STREQUAL contents)
+      return()
+    endif()
+  endif()
+
+  file(WRITE "${file}" "${contents}")
+
+endfunction()
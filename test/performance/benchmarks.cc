@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Micro-benchmarks of the hot paths of ign-plugin. Besides the time per
+// operation, each benchmark reports the number of heap allocations per
+// operation as "allocs/op" and the bytes that they requested as "bytes/op".
+// The BM_Footprint benchmarks also report how much memory an object holds
+// while it is alive: "sizeof" is its inline size, and "held bytes" is the
+// heap memory which stays allocated because of it. Use --benchmark_format=json or
+// --benchmark_out=<file> to keep the results for comparing releases, e.g. with
+// the compare.py tool of Google Benchmark.
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/SpecializedPluginPtr.hh>
+#include <ignition/plugin/WeakPluginPtr.hh>
+
+#include "../plugins/DummyPlugins.hh"
+#include "../plugins/FactoryPlugins.hh"
+#include "AllocationCounter.hh"
+
+using test::performance::AllocationCounter;
+using test::performance::LiveBytes;
+
+namespace
+{
+  /// \brief Get a Loader which has loaded the test plugins. It is shared by
+  /// every benchmark, so that loading does not get measured.
+  /// \return The Loader
+  ignition::plugin::Loader &TestLoader()
+  {
+    static ignition::plugin::Loader *loader = []()
+    {
+      auto *pl = new ignition::plugin::Loader;
+      pl->LoadLib(IGNDummyPlugins_LIB);
+      pl->LoadLib(IGNFactoryPlugins_LIB);
+      return pl;
+    }();
+
+    return *loader;
+  }
+
+  /// \brief Get an instance of the plugin which implements the most
+  /// interfaces
+  /// \return The instance
+  ignition::plugin::PluginPtr TestPlugin()
+  {
+    return TestLoader().Instantiate("test::util::DummyMultiPlugin");
+  }
+
+  /// \brief An interface which no plugin implements
+  class UnusedInterface { };
+
+  /// \brief Specialized for the interface that we query
+  using Specialize1Type =
+      ignition::plugin::SpecializedPluginPtr<test::util::DummySetterBase>;
+
+  /// \brief Specialized for several interfaces, with the one that we query
+  /// last, and with one interface that the plugin does not implement
+  using Specialize3Types =
+      ignition::plugin::SpecializedPluginPtr<
+          UnusedInterface,
+          test::util::DummyNameBase,
+          test::util::DummySetterBase>;
+
+  /// \brief Same as Specialize3Types, but with the flat specialization
+  using FlatSpecialize3Types =
+      ignition::plugin::FlatSpecializedPluginPtr<
+          UnusedInterface,
+          test::util::DummyNameBase,
+          test::util::DummySetterBase>;
+}
+
+/////////////////////////////////////////////////
+template <typename PluginPtrType, typename Interface>
+void BM_QueryInterface(benchmark::State &_state)
+{
+  const PluginPtrType plugin = TestPlugin();
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(plugin->template QueryInterface<Interface>());
+  }
+}
+BENCHMARK_TEMPLATE(BM_QueryInterface,
+                   ignition::plugin::PluginPtr, test::util::DummySetterBase);
+BENCHMARK_TEMPLATE(BM_QueryInterface,
+                   ignition::plugin::PluginPtr, UnusedInterface);
+BENCHMARK_TEMPLATE(BM_QueryInterface,
+                   Specialize1Type, test::util::DummySetterBase);
+BENCHMARK_TEMPLATE(BM_QueryInterface,
+                   Specialize3Types, test::util::DummySetterBase);
+BENCHMARK_TEMPLATE(BM_QueryInterface,
+                   Specialize3Types, UnusedInterface);
+BENCHMARK_TEMPLATE(BM_QueryInterface,
+                   FlatSpecialize3Types, test::util::DummySetterBase);
+BENCHMARK_TEMPLATE(BM_QueryInterface,
+                   FlatSpecialize3Types, UnusedInterface);
+
+/////////////////////////////////////////////////
+template <typename PluginPtrType, typename Interface>
+void BM_HasInterface(benchmark::State &_state)
+{
+  const PluginPtrType plugin = TestPlugin();
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(plugin->template HasInterface<Interface>());
+  }
+}
+BENCHMARK_TEMPLATE(BM_HasInterface,
+                   ignition::plugin::PluginPtr, test::util::DummySetterBase);
+BENCHMARK_TEMPLATE(BM_HasInterface,
+                   ignition::plugin::PluginPtr, UnusedInterface);
+BENCHMARK_TEMPLATE(BM_HasInterface,
+                   Specialize3Types, test::util::DummySetterBase);
+
+/////////////////////////////////////////////////
+static void BM_HasInterfaceByName(benchmark::State &_state)
+{
+  const ignition::plugin::PluginPtr plugin = TestPlugin();
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(
+          plugin->HasInterface("test::util::DummySetterBase"));
+  }
+}
+BENCHMARK(BM_HasInterfaceByName);
+
+/////////////////////////////////////////////////
+static void BM_PluginPtrCopy(benchmark::State &_state)
+{
+  const ignition::plugin::PluginPtr plugin = TestPlugin();
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    ignition::plugin::PluginPtr copy(plugin);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_PluginPtrCopy);
+
+/////////////////////////////////////////////////
+static void BM_PluginPtrMove(benchmark::State &_state)
+{
+  ignition::plugin::PluginPtr plugin = TestPlugin();
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    ignition::plugin::PluginPtr moved(std::move(plugin));
+    plugin = std::move(moved);
+    benchmark::DoNotOptimize(plugin);
+  }
+}
+BENCHMARK(BM_PluginPtrMove);
+
+/////////////////////////////////////////////////
+static void BM_PluginPtrAssign(benchmark::State &_state)
+{
+  const ignition::plugin::PluginPtr plugin = TestPlugin();
+  ignition::plugin::PluginPtr other = TestPlugin();
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    other = plugin;
+    benchmark::DoNotOptimize(other);
+  }
+}
+BENCHMARK(BM_PluginPtrAssign);
+
+/////////////////////////////////////////////////
+static void BM_WeakPluginPtrLock(benchmark::State &_state)
+{
+  const ignition::plugin::PluginPtr plugin = TestPlugin();
+  const ignition::plugin::WeakPluginPtr weak(plugin);
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(weak.Lock());
+  }
+}
+BENCHMARK(BM_WeakPluginPtrLock);
+
+/////////////////////////////////////////////////
+static void BM_Instantiate(benchmark::State &_state)
+{
+  ignition::plugin::Loader &loader = TestLoader();
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(
+          loader.Instantiate("test::util::DummySinglePlugin"));
+  }
+}
+BENCHMARK(BM_Instantiate);
+
+/////////////////////////////////////////////////
+static void BM_InstantiateByAlias(benchmark::State &_state)
+{
+  ignition::plugin::Loader &loader = TestLoader();
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(loader.Instantiate("Alternative name"));
+  }
+}
+BENCHMARK(BM_InstantiateByAlias);
+
+/////////////////////////////////////////////////
+static void BM_FactoryConstruct(benchmark::State &_state)
+{
+  const auto factory = TestLoader().Factory<test::util::NameFactory>(
+        "test::util::DummyNameForward");
+  const std::string name = "John Doe";
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(factory->Construct(name));
+  }
+}
+BENCHMARK(BM_FactoryConstruct);
+
+/////////////////////////////////////////////////
+template <typename PluginPtrType>
+void BM_FootprintInstance(benchmark::State &_state)
+{
+  ignition::plugin::Loader &loader = TestLoader();
+  std::size_t heldBytes = 0;
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    const std::size_t before = LiveBytes();
+    const PluginPtrType plugin =
+        loader.Instantiate("test::util::DummyMultiPlugin");
+    heldBytes += LiveBytes() - before;
+    benchmark::DoNotOptimize(plugin);
+  }
+
+  _state.counters["sizeof"] = sizeof(PluginPtrType);
+  _state.counters["held bytes"] = benchmark::Counter(
+        static_cast<double>(heldBytes), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_TEMPLATE(BM_FootprintInstance, ignition::plugin::PluginPtr);
+BENCHMARK_TEMPLATE(BM_FootprintInstance, Specialize1Type);
+BENCHMARK_TEMPLATE(BM_FootprintInstance, Specialize3Types);
+BENCHMARK_TEMPLATE(BM_FootprintInstance, FlatSpecialize3Types);
+
+/////////////////////////////////////////////////
+static void BM_FootprintWeakPluginPtr(benchmark::State &_state)
+{
+  const ignition::plugin::PluginPtr plugin = TestPlugin();
+  std::size_t heldBytes = 0;
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    const std::size_t before = LiveBytes();
+    const ignition::plugin::WeakPluginPtr weak(plugin);
+    heldBytes += LiveBytes() - before;
+    benchmark::DoNotOptimize(weak);
+  }
+
+  _state.counters["sizeof"] = sizeof(ignition::plugin::WeakPluginPtr);
+  _state.counters["held bytes"] = benchmark::Counter(
+        static_cast<double>(heldBytes), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FootprintWeakPluginPtr);
+
+/////////////////////////////////////////////////
+// The registry entries of a library, i.e. the Info of its plugins along with
+// their names, aliases and interfaces. The library stays open in the shared
+// Loader, so this does not include the memory of the library itself.
+static void BM_FootprintLoadLib(benchmark::State &_state)
+{
+  TestLoader();
+  std::size_t heldBytes = 0;
+  std::size_t plugins = 0;
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    ignition::plugin::Loader pl;
+    const std::size_t before = LiveBytes();
+    pl.LoadLib(IGNDummyPlugins_LIB);
+    heldBytes += LiveBytes() - before;
+    plugins = pl.AllPlugins().size();
+  }
+
+  _state.counters["plugins"] = static_cast<double>(plugins);
+  _state.counters["held bytes"] = benchmark::Counter(
+        static_cast<double>(heldBytes), benchmark::Counter::kAvgIterations);
+  _state.counters["held bytes/plugin"] = benchmark::Counter(
+        static_cast<double>(heldBytes) / static_cast<double>(plugins),
+        benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FootprintLoadLib);
+
+BENCHMARK_MAIN();
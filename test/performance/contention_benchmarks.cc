@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Benchmarks of the operations that get contended when many threads share a
+// Loader, a plugin instance or a factory. Each benchmark runs with 1 thread
+// up to twice the number of hardware threads, and reports the throughput of
+// all of its threads together as "items_per_second". Comparing the
+// throughput across thread counts gives the scaling curve of the operation.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <ignition/plugin/EnablePluginFromThis.hh>
+#include <ignition/plugin/Loader.hh>
+
+#include "../plugins/DummyPlugins.hh"
+#include "../plugins/FactoryPlugins.hh"
+
+namespace
+{
+  /// \brief Get a Loader which has loaded the test plugins. It is shared by
+  /// every thread of every benchmark.
+  /// \return The Loader
+  ignition::plugin::Loader &TestLoader()
+  {
+    static ignition::plugin::Loader *loader = []()
+    {
+      auto *pl = new ignition::plugin::Loader;
+      pl->LoadLib(IGNDummyPlugins_LIB);
+      pl->LoadLib(IGNFactoryPlugins_LIB);
+      return pl;
+    }();
+
+    return *loader;
+  }
+
+  /// \brief Get the instance which every thread shares
+  /// \return The instance
+  const ignition::plugin::PluginPtr &SharedPlugin()
+  {
+    static const ignition::plugin::PluginPtr plugin =
+        TestLoader().Instantiate("test::util::DummyMultiPlugin");
+
+    return plugin;
+  }
+
+  /// \brief Get the factory which every thread shares
+  /// \return The factory
+  const std::shared_ptr<test::util::NameFactory> &SharedFactory()
+  {
+    static const auto factory = TestLoader().Factory<test::util::NameFactory>(
+          "test::util::DummyNameForward");
+
+    return factory;
+  }
+
+  /// \brief The largest number of threads to run a benchmark with
+  /// \return The number of threads
+  int MaxThreads()
+  {
+    return 2 * std::max(1, static_cast<int>(
+                            std::thread::hardware_concurrency()));
+  }
+
+  /// \brief Report the throughput of the calling thread. Google Benchmark
+  /// adds up the throughput of every thread.
+  /// \param[in] _state The state of the benchmark
+  void ReportThroughput(benchmark::State &_state)
+  {
+    _state.SetItemsProcessed(static_cast<int64_t>(_state.iterations()));
+  }
+}
+
+/////////////////////////////////////////////////
+// Copying a PluginPtr to the same instance from every thread bounces the
+// reference count of the instance between the cores.
+static void BM_SharedPluginPtrCopy(benchmark::State &_state)
+{
+  const ignition::plugin::PluginPtr &plugin = SharedPlugin();
+  for (auto _ : _state)
+  {
+    ignition::plugin::PluginPtr copy(plugin);
+    benchmark::DoNotOptimize(copy);
+  }
+
+  ReportThroughput(_state);
+}
+BENCHMARK(BM_SharedPluginPtrCopy)->ThreadRange(1, MaxThreads())->UseRealTime();
+
+/////////////////////////////////////////////////
+// EnablePluginFromThis locks a weak reference to the instance
+static void BM_SharedPluginFromThis(benchmark::State &_state)
+{
+  auto *fromThis = SharedPlugin()->QueryInterface<
+      ignition::plugin::EnablePluginFromThis>();
+
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(fromThis->PluginFromThis());
+  }
+
+  ReportThroughput(_state);
+}
+BENCHMARK(BM_SharedPluginFromThis)
+    ->ThreadRange(1, MaxThreads())->UseRealTime();
+
+/////////////////////////////////////////////////
+// Every thread constructs products of the same factory, and destroys them
+// with their ProductDeleter
+static void BM_SharedFactoryConstruct(benchmark::State &_state)
+{
+  const auto &factory = SharedFactory();
+  const std::string name = "John Doe";
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(factory->Construct(name));
+  }
+
+  ReportThroughput(_state);
+}
+BENCHMARK(BM_SharedFactoryConstruct)
+    ->ThreadRange(1, MaxThreads())->UseRealTime();
+
+/////////////////////////////////////////////////
+// Every thread destroys its products without their ProductDeleter, so that
+// they get handed to the lost product manager
+static void BM_SharedFactoryLostProduct(benchmark::State &_state)
+{
+  const auto &factory = SharedFactory();
+  const std::string name = "John Doe";
+  for (auto _ : _state)
+  {
+    delete factory->Construct(name).release();
+  }
+
+  ReportThroughput(_state);
+
+  // The loop is over, so this is not measured
+  if (_state.thread_index() == 0)
+    ignition::plugin::CleanupLostProducts();
+}
+BENCHMARK(BM_SharedFactoryLostProduct)
+    ->ThreadRange(1, MaxThreads())->UseRealTime();
+
+/////////////////////////////////////////////////
+// Every thread instantiates plugins from the same Loader
+static void BM_SharedLoaderInstantiate(benchmark::State &_state)
+{
+  ignition::plugin::Loader &loader = TestLoader();
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(
+          loader.Instantiate("test::util::DummySinglePlugin"));
+  }
+
+  ReportThroughput(_state);
+}
+BENCHMARK(BM_SharedLoaderInstantiate)
+    ->ThreadRange(1, MaxThreads())->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Benchmarks of how the Loader scales with the size of its registry. They use
+// the synthetic plugin libraries which SyntheticPlugins.cmake generates, from
+// the smallest to the largest:
+//
+//   - BM_LoadLibCold and BM_LoadLibWarm load one library into a new Loader,
+//     with the library being closed in between, or kept open by another
+//     Loader. They report the heap memory that the registry of the Loader
+//     holds afterwards as "registry bytes".
+//   - The lookup benchmarks load the first N libraries into a Loader, and then
+//     query the plugins of the last one.
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <ignition/plugin/Loader.hh>
+
+#include "AllocationCounter.hh"
+
+using test::performance::AllocationCounter;
+using test::performance::LiveBytes;
+
+namespace
+{
+  /// \brief A synthetic plugin library
+  struct SyntheticLibrary
+  {
+    /// \brief Path to the library
+    std::string path;
+
+    /// \brief The namespace of its interfaces and plugins
+    std::string ns;
+
+    /// \brief The number of plugins in the library
+    std::size_t plugins;
+
+    /// \brief The number of interfaces in the library
+    std::size_t interfaces;
+  };
+
+  /// \brief The synthetic libraries, from the smallest to the largest
+  const std::vector<SyntheticLibrary> &SyntheticLibraries()
+  {
+    static const std::vector<SyntheticLibrary> libraries = {
+      {IGNSyntheticPlugins16_LIB, "synthetic16", 16, 8},
+      {IGNSyntheticPlugins128_LIB, "synthetic128", 128, 32},
+      {IGNSyntheticPlugins512_LIB, "synthetic512", 512, 64}
+    };
+
+    return libraries;
+  }
+
+  /// \brief Load the first _count synthetic libraries into _loader
+  /// \param[in] _loader The loader
+  /// \param[in] _count The number of libraries to load
+  /// \return The last library that was loaded
+  const SyntheticLibrary &LoadSynthetic(
+      ignition::plugin::Loader &_loader, const std::size_t _count)
+  {
+    const auto &libraries = SyntheticLibraries();
+    for (std::size_t i = 0; i < _count; ++i)
+      _loader.LoadLib(libraries[i].path);
+
+    return libraries[_count - 1];
+  }
+
+  /// \brief Set the counters which describe the registry that a benchmark ran
+  /// against
+  /// \param[in] _state The state of the benchmark
+  /// \param[in] _loader The loader
+  void ReportRegistrySize(
+      benchmark::State &_state, const ignition::plugin::Loader &_loader)
+  {
+    _state.counters["plugins"] =
+        static_cast<double>(_loader.AllPlugins().size());
+    _state.counters["interfaces"] =
+        static_cast<double>(_loader.InterfacesImplemented().size());
+  }
+
+  /// \brief The names of plugins to look up from a library, so that a
+  /// benchmark spreads its lookups over the whole library
+  /// \param[in] _library The library
+  /// \param[in] _alias True for the aliases of the plugins, false for their
+  /// names
+  /// \return The names
+  std::vector<std::string> NamesOf(
+      const SyntheticLibrary &_library, const bool _alias)
+  {
+    std::vector<std::string> names;
+    names.reserve(_library.plugins);
+    for (std::size_t p = 0; p < _library.plugins; ++p)
+    {
+      names.push_back(_alias ?
+            _library.ns + "/Plugin" + std::to_string(p) + "/0" :
+            _library.ns + "::Plugin" + std::to_string(p));
+    }
+
+    return names;
+  }
+}
+
+/////////////////////////////////////////////////
+static void BM_LoadLibCold(benchmark::State &_state)
+{
+  const SyntheticLibrary &library =
+      SyntheticLibraries()[static_cast<std::size_t>(_state.range(0))];
+
+  std::size_t registryBytes = 0;
+  for (auto _ : _state)
+  {
+    const std::size_t before = LiveBytes();
+    {
+      ignition::plugin::Loader pl;
+      benchmark::DoNotOptimize(pl.LoadLib(library.path));
+
+      _state.PauseTiming();
+      registryBytes += LiveBytes() - before;
+      // Closing the library is not part of what we measure
+    }
+    _state.ResumeTiming();
+  }
+
+  _state.counters["plugins"] = static_cast<double>(library.plugins);
+  _state.counters["registry bytes"] = benchmark::Counter(
+        static_cast<double>(registryBytes),
+        benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LoadLibCold)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+/////////////////////////////////////////////////
+static void BM_LoadLibWarm(benchmark::State &_state)
+{
+  const SyntheticLibrary &library =
+      SyntheticLibraries()[static_cast<std::size_t>(_state.range(0))];
+
+  // Keeps the library open, so that only the registration gets measured
+  ignition::plugin::Loader keeper;
+  keeper.LoadLib(library.path);
+
+  std::size_t registryBytes = 0;
+  for (auto _ : _state)
+  {
+    const std::size_t before = LiveBytes();
+    {
+      ignition::plugin::Loader pl;
+      benchmark::DoNotOptimize(pl.LoadLib(library.path));
+
+      _state.PauseTiming();
+      registryBytes += LiveBytes() - before;
+    }
+    _state.ResumeTiming();
+  }
+
+  _state.counters["plugins"] = static_cast<double>(library.plugins);
+  _state.counters["registry bytes"] = benchmark::Counter(
+        static_cast<double>(registryBytes),
+        benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LoadLibWarm)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+/////////////////////////////////////////////////
+static void BM_LookupPlugin(benchmark::State &_state)
+{
+  ignition::plugin::Loader pl;
+  const SyntheticLibrary &library =
+      LoadSynthetic(pl, static_cast<std::size_t>(_state.range(0)));
+  const std::vector<std::string> names =
+      NamesOf(library, _state.range(1) != 0);
+
+  std::size_t next = 0;
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(pl.LookupPlugin(names[next]));
+    next = (next + 1) % names.size();
+  }
+
+  ReportRegistrySize(_state, pl);
+}
+BENCHMARK(BM_LookupPlugin)
+    ->ArgNames({"libraries", "alias"})
+    ->ArgsProduct({{1, 2, 3}, {0, 1}});
+
+/////////////////////////////////////////////////
+static void BM_PluginsImplementing(benchmark::State &_state)
+{
+  ignition::plugin::Loader pl;
+  const SyntheticLibrary &library =
+      LoadSynthetic(pl, static_cast<std::size_t>(_state.range(0)));
+
+  std::vector<std::string> interfaces;
+  for (std::size_t i = 0; i < library.interfaces; ++i)
+    interfaces.push_back(library.ns + "::Interface" + std::to_string(i));
+
+  std::size_t next = 0;
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(pl.PluginsImplementing(interfaces[next]));
+    next = (next + 1) % interfaces.size();
+  }
+
+  ReportRegistrySize(_state, pl);
+}
+BENCHMARK(BM_PluginsImplementing)->ArgName("libraries")->DenseRange(1, 3);
+
+/////////////////////////////////////////////////
+static void BM_InstantiateByAlias(benchmark::State &_state)
+{
+  ignition::plugin::Loader pl;
+  const SyntheticLibrary &library =
+      LoadSynthetic(pl, static_cast<std::size_t>(_state.range(0)));
+  const std::vector<std::string> aliases = NamesOf(library, true);
+
+  std::size_t next = 0;
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(pl.Instantiate(aliases[next]));
+    next = (next + 1) % aliases.size();
+  }
+
+  ReportRegistrySize(_state, pl);
+}
+BENCHMARK(BM_InstantiateByAlias)->ArgName("libraries")->DenseRange(1, 3);
+
+BENCHMARK_MAIN();
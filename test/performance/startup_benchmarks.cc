@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// End-to-end benchmarks of the startup of an application which loads every
+// synthetic plugin library that SyntheticPlugins.cmake generates. Every
+// iteration loads the libraries into a new Loader, after the libraries of the
+// previous iteration have been closed.
+//
+// Besides the total time, the benchmarks report the time per iteration that
+// was spent on each step of loading, as measured by the trace points of the
+// Loader (see ignition/plugin/Trace.hh):
+//
+//   - dlopen: opening the libraries
+//   - IgnitionPluginHook: running their registration hooks
+//   - CopyInfo: copying the Info that the hooks provided
+//   - Demangle: demangling the names of the plugins and interfaces
+//   - CommitLib: inserting the plugins into the registry
+//
+// BM_StartupCold drops the page cache before every iteration, so that the
+// libraries have to be read from disk. This needs permission to write to
+// /proc/sys/vm/drop_caches, i.e. root. Without it, the benchmark still runs,
+// and reports "page cache dropped" as 0.
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include <ignition/plugin/Loader.hh>
+#include <ignition/plugin/Trace.hh>
+
+namespace
+{
+  /// \brief The libraries which get loaded at startup
+  const std::array<const char*, 3> kLibraries = {
+    IGNSyntheticPlugins16_LIB,
+    IGNSyntheticPlugins128_LIB,
+    IGNSyntheticPlugins512_LIB
+  };
+
+  /// \brief The steps of loading which are reported, by the names of their
+  /// trace events
+  const std::array<const char*, 5> kSteps = {
+    "dlopen",
+    "IgnitionPluginHook",
+    "CopyInfo",
+    "Demangle",
+    "CommitLib"
+  };
+
+  /// \brief Adds up the time that is spent on each step of loading
+  class StepTimer : public ignition::plugin::TraceObserver
+  {
+    // Documentation inherited
+    public: void OnTraceEvent(
+        const ignition::plugin::TraceEvent &_event) override
+    {
+      for (std::size_t i = 0; i < kSteps.size(); ++i)
+      {
+        if (std::strcmp(_event.name, kSteps[i]) == 0)
+        {
+          this->nanoseconds[i] += _event.duration;
+          return;
+        }
+      }
+    }
+
+    /// \brief Report the time of each step per iteration of a benchmark
+    /// \param[in] _state The state of the benchmark
+    public: void Report(benchmark::State &_state) const
+    {
+      for (std::size_t i = 0; i < kSteps.size(); ++i)
+      {
+        // Counters are reported in the unit of the benchmark, i.e. ms
+        _state.counters[std::string(kSteps[i]) + " ms"] = benchmark::Counter(
+              static_cast<double>(this->nanoseconds[i]) * 1e-6,
+              benchmark::Counter::kAvgIterations);
+      }
+    }
+
+    /// \brief The time spent on each step
+    private: std::array<std::int64_t, kSteps.size()> nanoseconds = {};
+  };
+
+  /// \brief Drop the page cache, so that the libraries have to be read from
+  /// disk again
+  /// \return True if the page cache was dropped
+  bool DropPageCache()
+  {
+    ::sync();
+    std::ofstream dropCaches("/proc/sys/vm/drop_caches");
+    dropCaches << "1" << std::endl;
+    return dropCaches.good();
+  }
+
+  /// \brief Load every library into a new Loader, while measuring the steps
+  /// of loading
+  /// \param[in] _state The state of the benchmark
+  /// \param[in] _dropPageCache Whether to drop the page cache before each
+  /// iteration
+  void RunStartup(benchmark::State &_state, const bool _dropPageCache)
+  {
+    StepTimer timer;
+    ignition::plugin::SetTraceObserver(&timer);
+
+    bool dropped = _dropPageCache;
+    std::optional<ignition::plugin::Loader> pl;
+    for (auto _ : _state)
+    {
+      // Closing the libraries of the previous iteration is not part of
+      // startup
+      _state.PauseTiming();
+      pl.reset();
+      if (_dropPageCache)
+        dropped = DropPageCache() && dropped;
+      _state.ResumeTiming();
+
+      pl.emplace();
+      for (const char *library : kLibraries)
+        pl->LoadLib(library);
+    }
+
+    const std::size_t plugins = pl ? pl->AllPlugins().size() : 0;
+    pl.reset();
+
+    ignition::plugin::SetTraceObserver(nullptr);
+
+    timer.Report(_state);
+    _state.counters["plugins"] = static_cast<double>(plugins);
+    if (_dropPageCache)
+      _state.counters["page cache dropped"] = dropped ? 1 : 0;
+  }
+}
+
+/////////////////////////////////////////////////
+static void BM_StartupCold(benchmark::State &_state)
+{
+  RunStartup(_state, true);
+}
+BENCHMARK(BM_StartupCold)->Unit(benchmark::kMillisecond)->Iterations(10);
+
+/////////////////////////////////////////////////
+static void BM_StartupWarm(benchmark::State &_state)
+{
+  RunStartup(_state, false);
+}
+BENCHMARK(BM_StartupWarm)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <ignition/plugin/Descriptor.hh>
+
+#include "GenericExport.hh"
+
+extern "C" void EXPORT IgnitionPluginHookV2(
+    int *_inputAndOutputAPIVersion,
+    const void * const **,
+    const void * const **)
+{
+  *_inputAndOutputAPIVersion = ignition::plugin::DESCRIPTOR_API_VERSION + 1;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "ConstructiblePlugins.hh"
+
+#include <ignition/plugin/Register.hh>
+
+namespace test
+{
+namespace plugins
+{
+
+/////////////////////////////////////////////////
+/// \brief A plugin which can be default constructed, or constructed with
+/// its settings
+class Camera : public Configured
+{
+  public: Camera() = default;
+
+  public: Camera(int _number, const std::string &_label)
+    : number(_number),
+      label(_label),
+      labelAddress(&_label)
+  {
+  }
+
+  public: explicit Camera(std::unique_ptr<int> _number)
+    : number(*_number),
+      label("owned")
+  {
+  }
+
+  public: Camera(std::string _label, int _number)
+    : number(_number),
+      label(std::move(_label))
+  {
+  }
+
+  public: int Number() const override { return this->number; }
+
+  public: std::string Label() const override { return this->label; }
+
+  public: const std::string *LabelAddress() const override
+  {
+    return this->labelAddress;
+  }
+
+  private: int number = 0;
+  private: std::string label = "default";
+  private: const std::string *labelAddress = nullptr;
+};
+
+}
+}
+
+/////////////////////////////////////////////////
+IGNITION_ADD_PLUGIN(test::plugins::Camera, test::plugins::Configured)
+IGNITION_ADD_PLUGIN_ALIAS(test::plugins::Camera, "Camera")
+
+IGNITION_ADD_PLUGIN_CONSTRUCTOR(test::plugins::Camera, int, const std::string&)
+IGNITION_ADD_PLUGIN_CONSTRUCTOR(test::plugins::Camera, std::unique_ptr<int>)
+IGNITION_ADD_PLUGIN_CONSTRUCTOR(test::plugins::Camera, std::string, int)
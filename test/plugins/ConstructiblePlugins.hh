@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+#ifndef IGNITION_PLUGIN_TEST_PLUGINS_CONSTRUCTIBLEPLUGINS_HH_
+#define IGNITION_PLUGIN_TEST_PLUGINS_CONSTRUCTIBLEPLUGINS_HH_
+
+#include <string>
+
+namespace test
+{
+namespace plugins
+{
+
+// Interface of plugins which get their settings from their constructors
+class Configured
+{
+  public: virtual ~Configured() = default;
+
+  /// \brief The number that was given to the constructor
+  public: virtual int Number() const = 0;
+
+  /// \brief The label that was given to the constructor
+  public: virtual std::string Label() const = 0;
+
+  /// \brief The address of the label that was given to the constructor, if
+  /// it was passed by reference
+  public: virtual const std::string *LabelAddress() const = 0;
+};
+
+}
+}
+
+#endif
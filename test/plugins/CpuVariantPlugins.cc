@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "CpuVariantPlugins.hh"
+
+#include <ignition/plugin/Register.hh>
+
+namespace test
+{
+namespace plugins
+{
+
+/////////////////////////////////////////////////
+/// \brief Every variant is the same class, but each one is a plugin of its
+/// own
+template <int Id>
+class KernelVariant : public Kernel
+{
+  public: std::string Variant() const override;
+};
+
+/// \brief Runs on any CPU
+using GenericKernel = KernelVariant<0>;
+
+/// \brief Runs on x86 CPUs with SSE2
+using Sse2Kernel = KernelVariant<1>;
+
+/// \brief Runs on ARM CPUs with NEON
+using NeonKernel = KernelVariant<2>;
+
+/// \brief Requires a feature which no CPU has
+using FutureKernel = KernelVariant<3>;
+
+template <> std::string GenericKernel::Variant() const { return "generic"; }
+template <> std::string Sse2Kernel::Variant() const { return "sse2"; }
+template <> std::string NeonKernel::Variant() const { return "neon"; }
+template <> std::string FutureKernel::Variant() const { return "future"; }
+
+/////////////////////////////////////////////////
+void Scale(float *_data, const float _factor, const std::size_t _count)
+{
+  for (std::size_t i = 0; i < _count; ++i)
+    _data[i] *= _factor;
+}
+
+const VectorKernels genericKernels{&Scale, "generic"};
+const VectorKernels sse2Kernels{&Scale, "sse2"};
+
+/// \brief A table whose layout the host expects to be newer, see the
+/// CpuFeatures.KernelTables test
+struct OutdatedKernels
+{
+  static constexpr std::uint32_t kAbiVersion = 1;
+  const char *variant;
+};
+
+const OutdatedKernels outdatedKernels{"generic"};
+
+/////////////////////////////////////////////////
+IGNITION_ADD_PLUGIN(GenericKernel, Kernel)
+IGNITION_ADD_PLUGIN_ALIAS(GenericKernel, "Kernel", "GenericKernel")
+IGNITION_ADD_PLUGIN_KERNELS(GenericKernel, genericKernels)
+IGNITION_ADD_PLUGIN_KERNELS(GenericKernel, outdatedKernels)
+
+IGNITION_ADD_PLUGIN(Sse2Kernel, Kernel)
+IGNITION_ADD_PLUGIN_ALIAS(Sse2Kernel, "Kernel")
+IGNITION_ADD_PLUGIN_FEATURES(Sse2Kernel, "sse2")
+IGNITION_ADD_PLUGIN_KERNELS(Sse2Kernel, sse2Kernels)
+
+IGNITION_ADD_PLUGIN(NeonKernel, Kernel)
+IGNITION_ADD_PLUGIN_ALIAS(NeonKernel, "Kernel")
+IGNITION_ADD_PLUGIN_FEATURES(NeonKernel, "neon")
+
+IGNITION_ADD_PLUGIN(FutureKernel, Kernel)
+IGNITION_ADD_PLUGIN_ALIAS(FutureKernel, "Kernel", "FutureKernel")
+IGNITION_ADD_PLUGIN_FEATURES(FutureKernel, "sse2", "neon")
+IGNITION_ADD_PLUGIN_FEATURES(FutureKernel, "not-a-real-feature")
+
+}
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_PLUGIN_TEST_PLUGINS_CPUVARIANTPLUGINS_HH_
+#define IGNITION_PLUGIN_TEST_PLUGINS_CPUVARIANTPLUGINS_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace test
+{
+namespace plugins
+{
+
+// Interface of plugins which implement the same kernel for different CPUs
+class Kernel
+{
+  public: virtual ~Kernel() = default;
+
+  /// \brief The name of the variant of the kernel
+  public: virtual std::string Variant() const = 0;
+};
+
+// Table of batched kernels which some of the variants export, so that they
+// can be called without going through the Kernel interface
+struct VectorKernels
+{
+  static constexpr std::uint32_t kAbiVersion = 1;
+
+  /// \brief Multiply each of the _count values of _data by _factor
+  void (*scale)(float *_data, float _factor, std::size_t _count);
+
+  /// \brief The name of the variant which provides the kernels
+  const char *variant;
+};
+
+}
+}
+
+#endif
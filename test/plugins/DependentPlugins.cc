@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#include "DependentPlugins.hh"
+
+#include <ignition/plugin/Register.hh>
+
+namespace test
+{
+namespace plugins
+{
+
+/////////////////////////////////////////////////
+/// \brief The number of constructors which are running
+std::atomic<std::size_t> running{0};
+
+/////////////////////////////////////////////////
+/// \brief The largest value that `running` has had
+std::atomic<std::size_t> peak{0};
+
+/////////////////////////////////////////////////
+/// \brief The number of constructors which have finished
+std::atomic<std::size_t> finished{0};
+
+/////////////////////////////////////////////////
+/// \brief A stage whose constructor takes a while
+class SlowStage : public Stage
+{
+  public: SlowStage()
+  {
+    const std::size_t now = ++running;
+    std::size_t previous = peak.load();
+    while (previous < now && !peak.compare_exchange_weak(previous, now))
+    {
+      // Try again
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    this->peakConcurrency = peak.load();
+    this->sequence = finished++;
+    --running;
+  }
+
+  public: std::size_t Sequence() const override { return this->sequence; }
+
+  public: std::size_t PeakConcurrency() const override
+  {
+    return this->peakConcurrency;
+  }
+
+  private: std::size_t sequence = 0;
+  private: std::size_t peakConcurrency = 0;
+};
+
+// The stages are distinct types, so that each one is its own plugin
+class Base : public SlowStage { };
+class Left : public SlowStage { };
+class Right : public SlowStage { };
+class Top : public SlowStage { };
+class CycleA : public SlowStage { };
+class CycleB : public SlowStage { };
+class AfterCycle : public SlowStage { };
+
+}
+}
+
+/////////////////////////////////////////////////
+IGNITION_ADD_PLUGIN(test::plugins::Base, test::plugins::Stage)
+IGNITION_ADD_PLUGIN(test::plugins::Left, test::plugins::Stage)
+IGNITION_ADD_PLUGIN(test::plugins::Right, test::plugins::Stage)
+IGNITION_ADD_PLUGIN(test::plugins::Top, test::plugins::Stage)
+IGNITION_ADD_PLUGIN(test::plugins::CycleA, test::plugins::Stage)
+IGNITION_ADD_PLUGIN(test::plugins::CycleB, test::plugins::Stage)
+IGNITION_ADD_PLUGIN(test::plugins::AfterCycle, test::plugins::Stage)
+
+IGNITION_ADD_PLUGIN_ALIAS(test::plugins::Left, "Left")
+
+// Left and Right only need Base, so they can be constructed at once. Top
+// needs both of them, and is listed by name and by alias.
+IGNITION_ADD_PLUGIN_DEPENDENCIES(test::plugins::Left, "test::plugins::Base")
+IGNITION_ADD_PLUGIN_DEPENDENCIES(test::plugins::Right, "test::plugins::Base")
+IGNITION_ADD_PLUGIN_DEPENDENCIES(test::plugins::Top, "Left")
+IGNITION_ADD_PLUGIN_DEPENDENCIES(test::plugins::Top, "test::plugins::Right")
+
+IGNITION_ADD_PLUGIN_DEPENDENCIES(test::plugins::CycleA, "test::plugins::CycleB")
+IGNITION_ADD_PLUGIN_DEPENDENCIES(test::plugins::CycleB, "test::plugins::CycleA")
+IGNITION_ADD_PLUGIN_DEPENDENCIES(
+    test::plugins::AfterCycle, "test::plugins::CycleA")
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef IGNITION_PLUGIN_TEST_PLUGINS_DEPENDENTPLUGINS_HH_
+#define IGNITION_PLUGIN_TEST_PLUGINS_DEPENDENTPLUGINS_HH_
+
+#include <cstddef>
+
+namespace test
+{
+namespace plugins
+{
+
+// Interface of plugins which record when they were constructed
+class Stage
+{
+  public: virtual ~Stage() = default;
+
+  /// \brief The position of this instance among all the instances of the
+  /// library, in the order in which their constructors finished
+  public: virtual std::size_t Sequence() const = 0;
+
+  /// \brief The largest number of constructors of the library that were
+  /// running at once, up until this instance was constructed
+  public: virtual std::size_t PeakConcurrency() const = 0;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <atomic>
+#include <cstddef>
+
+#include "RecyclablePlugins.hh"
+
+#include <ignition/plugin/EnablePluginFromThis.hh>
+#include <ignition/plugin/Recyclable.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/plugin/Warmup.hh>
+
+namespace test
+{
+namespace plugins
+{
+
+/////////////////////////////////////////////////
+/// \brief Counts the instances which have been constructed
+std::atomic<std::size_t> constructed{0};
+
+/////////////////////////////////////////////////
+/// \brief A scratchpad which can be reused
+class RecyclableScratchpad
+    : public Scratchpad,
+      public ignition::plugin::Recyclable,
+      public ignition::plugin::EnablePluginFromThis
+{
+  public: std::size_t Serial() const override { return this->serial; }
+  public: std::size_t Resets() const override { return this->resets; }
+  public: void Write(const int _value) override { this->value = _value; }
+  public: int Read() const override { return this->value; }
+
+  public: void Reset() override
+  {
+    this->value = 0;
+    ++this->resets;
+  }
+
+  private: const std::size_t serial = ++constructed;
+  private: std::size_t resets = 0;
+  private: int value = 0;
+};
+
+/////////////////////////////////////////////////
+/// \brief A scratchpad which cannot be reused
+class DisposableScratchpad : public Scratchpad
+{
+  public: std::size_t Serial() const override { return this->serial; }
+  public: std::size_t Resets() const override { return 0; }
+  public: void Write(const int _value) override { this->value = _value; }
+  public: int Read() const override { return this->value; }
+
+  private: const std::size_t serial = ++constructed;
+  private: int value = 0;
+};
+
+/////////////////////////////////////////////////
+/// \brief A scratchpad which can be warmed up. It does not list the Warmup
+/// interface when it gets registered.
+class WarmScratchpad
+    : public DisposableScratchpad,
+      public ignition::plugin::Warmup
+{
+  public: std::size_t WarmUps() const override { return this->warmUps; }
+  public: void WarmUp() override { ++this->warmUps; }
+
+  private: std::size_t warmUps = 0;
+};
+
+/////////////////////////////////////////////////
+/// \brief The same as WarmScratchpad, but registered with a descriptor
+class WarmStaticScratchpad : public WarmScratchpad
+{
+};
+
+}
+}
+
+/////////////////////////////////////////////////
+IGNITION_ADD_PLUGIN(test::plugins::RecyclableScratchpad,
+                    test::plugins::Scratchpad,
+                    ignition::plugin::Recyclable)
+IGNITION_ADD_PLUGIN(test::plugins::DisposableScratchpad,
+                    test::plugins::Scratchpad)
+IGNITION_ADD_PLUGIN(test::plugins::WarmScratchpad,
+                    test::plugins::Scratchpad)
+IGNITION_ADD_STATIC_PLUGIN(test::plugins::WarmStaticScratchpad,
+                           test::plugins::Scratchpad)
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef IGNITION_PLUGIN_TEST_PLUGINS_RECYCLABLEPLUGINS_HH_
+#define IGNITION_PLUGIN_TEST_PLUGINS_RECYCLABLEPLUGINS_HH_
+
+#include <cstddef>
+
+namespace test
+{
+namespace plugins
+{
+
+// Interface of plugins which tell apart their instances
+class Scratchpad
+{
+  public: virtual ~Scratchpad() = default;
+
+  /// \brief A number which is unique to each constructed instance
+  public: virtual std::size_t Serial() const = 0;
+
+  /// \brief The number of times that this instance has been reset
+  public: virtual std::size_t Resets() const = 0;
+
+  /// \brief The number of times that this instance has been warmed up
+  public: virtual std::size_t WarmUps() const { return 0; }
+
+  /// \brief Write into the scratchpad
+  public: virtual void Write(int _value) = 0;
+
+  /// \brief Read what was written since the last reset
+  public: virtual int Read() const = 0;
+};
+
+}
+}
+
+#endif
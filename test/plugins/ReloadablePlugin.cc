@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <string>
+
+#include <ignition/plugin/Register.hh>
+#include <ignition/plugin/Reloadable.hh>
+
+#include "DummyPlugins.hh"
+
+// This file is built into two libraries with different values of
+// RELOADABLE_PLUGIN_VERSION, which act as two versions of the same library.
+#ifndef RELOADABLE_PLUGIN_VERSION
+#define RELOADABLE_PLUGIN_VERSION 1
+#endif
+
+namespace test
+{
+namespace util
+{
+
+/// \brief A plugin whose integer value survives reloading its library
+class ReloadablePlugin
+    : public DummyDoubleBase,
+      public DummyIntBase,
+      public DummySetterBase,
+      public ignition::plugin::Reloadable
+{
+  public: double MyDoubleValueIs() const override
+  {
+    return RELOADABLE_PLUGIN_VERSION;
+  }
+
+  public: int MyIntegerValueIs() const override
+  {
+    return this->value;
+  }
+
+  public: void SetName(const std::string &) override
+  {
+  }
+
+  public: void SetDoubleValue(const double) override
+  {
+  }
+
+  public: void SetIntegerValue(const int _val) override
+  {
+    this->value = _val;
+  }
+
+  public: std::string SaveState() const override
+  {
+    return std::to_string(this->value);
+  }
+
+  public: void RestoreState(const std::string &_state) override
+  {
+    this->value = std::stoi(_state);
+  }
+
+  private: int value = 0;
+};
+
+}
+}
+
+IGNITION_ADD_PLUGIN(test::util::ReloadablePlugin,
+                    test::util::DummyDoubleBase,
+                    test::util::DummyIntBase,
+                    test::util::DummySetterBase,
+                    ignition::plugin::Reloadable)
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "RemotePlugins.hh"
+
+#include <ignition/plugin/Register.hh>
+#include <ignition/plugin/RemoteCallable.hh>
+
+namespace test
+{
+namespace plugins
+{
+
+/////////////////////////////////////////////////
+/// \brief A plugin which can be hosted in a process of its own
+class Calculator : public ignition::plugin::RemoteCallable
+{
+  public: std::int64_t HandleCall(
+      const std::uint32_t _method,
+      const void *_input, const std::size_t _inputSize,
+      void *_output, const std::size_t _outputCapacity) override
+  {
+    switch (_method)
+    {
+      case CALCULATOR_ADD:
+      {
+        if (sizeof(Operands) != _inputSize)
+          return -1;
+        Operands operands;
+        std::memcpy(&operands, _input, sizeof(operands));
+        return Write(operands.a + operands.b, _output, _outputCapacity);
+      }
+
+      case CALCULATOR_SUM:
+      {
+        const double *const values = static_cast<const double *>(_input);
+        double sum = 0.0;
+        for (std::size_t i = 0; i < _inputSize / sizeof(double); ++i)
+          sum += values[i];
+        return Write(sum, _output, _outputCapacity);
+      }
+
+      case CALCULATOR_ACCUMULATE:
+      {
+        double value;
+        std::memcpy(&value, _input, sizeof(value));
+        this->total += value;
+        return 0;
+      }
+
+      case CALCULATOR_TOTAL:
+        return Write(this->total, _output, _outputCapacity);
+
+      case CALCULATOR_PID:
+        return Write(static_cast<int>(getpid()), _output, _outputCapacity);
+
+      case CALCULATOR_CRASH:
+        std::abort();
+
+      case CALCULATOR_SLEEP:
+      {
+        int milliseconds;
+        std::memcpy(&milliseconds, _input, sizeof(milliseconds));
+        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+        return 0;
+      }
+
+      default:
+        return -1;
+    }
+  }
+
+  /// \brief Write a result
+  /// \param[in] _value The result
+  /// \param[out] _output Where the result goes
+  /// \param[in] _capacity The number of bytes that _output can hold
+  /// \return The number of bytes written, or -1 if they do not fit
+  private: template <typename T>
+  static std::int64_t Write(const T &_value, void *_output,
+                            const std::size_t _capacity)
+  {
+    if (sizeof(T) > _capacity)
+      return -1;
+    std::memcpy(_output, &_value, sizeof(T));
+    return sizeof(T);
+  }
+
+  private: double total = 0.0;
+};
+
+/////////////////////////////////////////////////
+/// \brief A plugin which hangs while it is being instantiated
+class Stalled : public ignition::plugin::RemoteCallable
+{
+  public: Stalled()
+  {
+    std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+
+  public: std::int64_t HandleCall(
+      const std::uint32_t, const void *, const std::size_t,
+      void *, const std::size_t) override
+  {
+    return -1;
+  }
+};
+
+/////////////////////////////////////////////////
+/// \brief A plugin which cannot be hosted in a process of its own
+class Abacus
+{
+  public: virtual ~Abacus() = default;
+};
+
+}
+}
+
+/////////////////////////////////////////////////
+IGNITION_ADD_PLUGIN(test::plugins::Calculator,
+                    ignition::plugin::RemoteCallable)
+IGNITION_ADD_PLUGIN(test::plugins::Stalled,
+                    ignition::plugin::RemoteCallable)
+IGNITION_ADD_PLUGIN(test::plugins::Abacus, test::plugins::Abacus)
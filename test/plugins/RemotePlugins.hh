@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IGNITION_PLUGIN_TEST_PLUGINS_REMOTEPLUGINS_HH_
+#define IGNITION_PLUGIN_TEST_PLUGINS_REMOTEPLUGINS_HH_
+
+#include <cstdint>
+
+namespace test
+{
+namespace plugins
+{
+
+// The method numbers of the Calculator plugin, see
+// ignition::plugin::RemoteCallable
+enum CalculatorMethod : std::uint32_t
+{
+  /// \brief Add an Operands, returning a double
+  CALCULATOR_ADD = 1,
+
+  /// \brief Sum an array of doubles, returning a double
+  CALCULATOR_SUM,
+
+  /// \brief Add a double to the total, one-way
+  CALCULATOR_ACCUMULATE,
+
+  /// \brief Return the total as a double
+  CALCULATOR_TOTAL,
+
+  /// \brief Return the process ID of the plugin as an int
+  CALCULATOR_PID,
+
+  /// \brief Crash the process of the plugin
+  CALCULATOR_CRASH,
+
+  /// \brief Sleep for the given number of milliseconds, as an int
+  CALCULATOR_SLEEP
+};
+
+// The arguments of CALCULATOR_ADD
+struct Operands
+{
+  double a;
+  double b;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include <ignition/plugin/EnablePluginFromThis.hh>
+#include <ignition/plugin/Register.hh>
+
+#include "DummyPlugins.hh"
+
+namespace test
+{
+namespace util
+{
+
+/// \brief A plugin which is only registered with descriptors
+class StaticNamePlugin
+    : public DummyNameBase,
+      public DummyIntBase
+{
+  public: std::string MyNameIs() const override
+  {
+    return "StaticNamePlugin";
+  }
+
+  public: int MyIntegerValueIs() const override
+  {
+    return 7;
+  }
+};
+
+/// \brief A plugin which is registered both with descriptors and with
+/// IGNITION_ADD_PLUGIN, and inherits EnablePluginFromThis
+class StaticMixedPlugin
+    : public DummyNameBase,
+      public DummyDoubleBase,
+      public ignition::plugin::EnablePluginFromThis
+{
+  public: std::string MyNameIs() const override
+  {
+    return "StaticMixedPlugin";
+  }
+
+  public: double MyDoubleValueIs() const override
+  {
+    return 2.5;
+  }
+};
+
+}
+}
+
+IGNITION_ADD_STATIC_PLUGIN(test::util::StaticNamePlugin,
+                           test::util::DummyNameBase)
+IGNITION_ADD_STATIC_PLUGIN(test::util::StaticNamePlugin,
+                           test::util::DummyIntBase)
+IGNITION_ADD_STATIC_PLUGIN_ALIAS(test::util::StaticNamePlugin,
+                                 "StaticName", "Another static name")
+
+IGNITION_ADD_PLUGIN(test::util::StaticMixedPlugin,
+                    test::util::DummyNameBase)
+IGNITION_ADD_STATIC_PLUGIN(test::util::StaticMixedPlugin,
+                           test::util::DummyDoubleBase)
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2019 Open Source Robotics Foundation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Compares the JSON results of a Google Benchmark program against a baseline.
+
+Every benchmark which is in both files is compared on its real time, and on
+the counters given with --counter (by default allocs/op and bytes/op). A
+measurement regresses when it is larger than the baseline by more than the
+tolerance. Counters like allocs/op hardly vary between runs, so they get a
+tolerance of their own. Regressions are always reported, and they only make
+the script fail when --fail-on-regression is given.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_results(path):
+    """Map the name of each benchmark to its measurements."""
+    with open(path) as results_file:
+        results = json.load(results_file)
+
+    benchmarks = {}
+    for benchmark in results.get('benchmarks', []):
+        # Skip the mean, median and stddev of repeated runs, and compare the
+        # runs themselves. With repetitions, the last run of a name wins.
+        if benchmark.get('run_type') == 'aggregate':
+            continue
+        benchmarks[benchmark['name']] = benchmark
+    return benchmarks
+
+
+def to_nanoseconds(benchmark):
+    """Get the real time of a benchmark in nanoseconds."""
+    scale = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+    return benchmark['real_time'] * scale[benchmark.get('time_unit', 'ns')]
+
+
+def compare(baseline, results, counters, tolerance, counter_tolerance):
+    """Print the comparison, and return the number of regressions."""
+    regressions = 0
+    missing = sorted(set(baseline) - set(results))
+    for name in missing:
+        print('MISSING     %s' % name)
+
+    for name in sorted(set(baseline) & set(results)):
+        measurements = [('time', to_nanoseconds(baseline[name]),
+                         to_nanoseconds(results[name]), tolerance, 0.0)]
+        for counter in counters:
+            if counter in baseline[name] and counter in results[name]:
+                # Allocations which a benchmark makes once are averaged over
+                # its iterations, which leaves tiny fractions that vary with
+                # the number of iterations. Only an increase of at least half
+                # an allocation (or byte) per iteration is a regression.
+                measurements.append(
+                    (counter, baseline[name][counter], results[name][counter],
+                     counter_tolerance, 0.5))
+
+        for what, old, new, allowed, slack in measurements:
+            if old > 0:
+                change = (new - old) / old
+            else:
+                change = 0.0 if new <= 0 else float('inf')
+
+            regressed = change > allowed and new - old >= slack
+            if regressed:
+                regressions += 1
+            print('%-11s %s [%s] %.4g -> %.4g (%+.1f%%)' % (
+                'REGRESSION' if regressed else 'ok', name, what, old, new,
+                100.0 * change))
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('baseline', help='JSON results to compare against')
+    parser.add_argument('results', help='JSON results to check')
+    parser.add_argument(
+        '--tolerance', type=float, default=0.1,
+        help='Largest relative increase of the time which is not a '
+             'regression (default: 0.1)')
+    parser.add_argument(
+        '--counter-tolerance', type=float, default=0.01,
+        help='Largest relative increase of a counter which is not a '
+             'regression (default: 0.01)')
+    parser.add_argument(
+        '--counter', action='append', dest='counters',
+        help='A counter to compare besides the time. May be repeated '
+             '(default: allocs/op and bytes/op)')
+    parser.add_argument(
+        '--fail-on-regression', action='store_true',
+        help='Exit with an error if anything regressed')
+    args = parser.parse_args()
+
+    counters = args.counters or ['allocs/op', 'bytes/op']
+    regressions = compare(load_results(args.baseline),
+                          load_results(args.results),
+                          counters, args.tolerance, args.counter_tolerance)
+
+    print('%d regression(s)' % regressions)
+    if regressions and args.fail_on_regression:
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())